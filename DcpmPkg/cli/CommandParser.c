@@ -9,6 +9,7 @@
 #include <Library/PrintLib.h>
 #include <Library/UefiShellLib/UefiShellLib.h>
 #include <Utility.h>
+#include <Arena.h>
 #include "Common.h"
 #include <NvmHealth.h>
 
@@ -1919,15 +1920,18 @@ ExecuteCmd(COMMAND *pCommand) {
   if (NULL == pCommand)
     return EFI_INVALID_PARAMETER;
 
+  // printer, data set and string scratch memory lives until the end of the command
+  ArenaBegin();
+
   //Here to support migration path from legacy print handling and new printer module
   if (pCommand->PrinterCtrlSupported) {
     // create Printer Context if not given one to use
     if (pCommand->pPrintCtx == NULL)
     {
-      CreatedPrintCtx = TRUE;
       if (EFI_SUCCESS != (Rc = PrinterCreateCtx(&pCommand->pPrintCtx))) {
-        return Rc;
+        goto Finish;
       }
+      CreatedPrintCtx = TRUE;
 
       if (EFI_SUCCESS != (Rc = ReadCmdLinePrintOptions(&pCommand->pPrintCtx->FormatType, pCommand))) {
         goto Finish;
@@ -1953,7 +1957,13 @@ Finish:
   // clean up Printer context only if created in this routine call
   if (CreatedPrintCtx == TRUE) {
     PrinterDestroyCtx(pCommand->pPrintCtx);
+    pCommand->pPrintCtx = NULL;
   }
+#ifdef OS_BUILD
+  // command boundary, write out the buffered console output
+  PrintFlush();
+#endif
+  ArenaEnd();
   return Rc;
 }
 
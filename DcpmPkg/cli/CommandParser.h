@@ -82,7 +82,12 @@
 #define OUTPUT_OPTION_NVMXML            L"nvmxml"                              //!< 'output' option value for nvmxml
 #define OUTPUT_OPTION_ESX_XML           L"esx"                                 //!< 'output' option value for esx xml
 #define OUTPUT_OPTION_ESX_TABLE_XML     L"esxtable"                            //!< 'output' option value for esx xml
-#define OUTPUT_OPTION_HELP              L"text|nvmxml"                         //!< 'output' option help text
+#define OUTPUT_OPTION_JSON              L"json"                                //!< 'output' option value for json
+#define OUTPUT_OPTION_CSV               L"csv"                                 //!< 'output' option value for csv
+#define OUTPUT_OPTION_HELP              L"text|nvmxml|json|csv"                //!< 'output' option help text
+#define OUTPUT_OPTION_LINE              L"line"                                //!< 'output' option value for one line per record
+#define OUTPUT_OPTION_STREAM            L"stream"                              //!< 'output' option value for printing records as they are retrieved
+#define OUTPUT_OPTION_STREAM_HELP       L"text|nvmxml|json|csv|line[,stream]"  //!< 'output' option help text for commands that stream records
 #define VERBOSE_OPTION_SHORT            L"-v"                                  //!< 'verbose' option short form
 #define VERBOSE_OPTION                  L"-verbose"                            //!< 'verbose' option name
 #define MASTER_OPTION                   L"-master"                             //!< 'master' option name
@@ -93,6 +98,12 @@
 #define LARGE_PAYLOAD_OPTION            L"-lpmb"                               //!< 'large payload mailbox' option name
 #define SMALL_PAYLOAD_OPTION            L"-spmb"                               //!< 'small payload mailbox' option name
 #define NFIT_OPTION                     L"-nfit"                               //!< 'nfit' option name
+#define INTERVAL_OPTION                 L"-interval"                           //!< 'interval' option name
+#define INTERVAL_OPTION_HELP            L"ms"                                  //!< 'interval' option help text
+#define COUNT_OPTION                    L"-count"                              //!< 'count' option name
+#define COUNT_OPTION_HELP               L"samples"                             //!< 'count' option help text
+#define HISTORY_OPTION                  L"-history"                            //!< 'history' option name
+#define HISTORY_OPTION_HELP             L"hours"                               //!< 'history' option help text
 
 /** command targets **/
 #define DIMM_TARGET                          L"-dimm"                    //!< 'dimm' target name
@@ -111,6 +122,7 @@
 #define ERROR_TARGET                         L"-error"                   //!< 'error' target name
 #define CEL_TARGET                         L"-cel"                   //!< 'cel' target name
 #define DEBUG_TARGET                         L"-debug"                   //!< 'debug' target name
+#define DICTIONARY_TARGET                    L"-dictionary"              //!< 'dictionary' target name
 #define REGISTER_TARGET                      L"-register"                //!< 'register' target name
 #define FIRMWARE_TARGET                      L"-firmware"                //!< 'firmware' target name
 #define PCD_TARGET                           L"-pcd"                     //!< 'pcd' target name
@@ -147,6 +159,9 @@
 #define PBR_PLAYBACK_MODE_VAL                L"playback"                 //!< 'mode' target value
 #define PBR_PLAYBACK_MANUAL_MODE_VAL         L"playback_manual"          //!< 'mode' target value
 #define PBR_MODE_TAG                         L"-tag"                     //!< 'tag' target value
+#define PBR_ORDER_TARGET                     L"-order"                   //!< 'order' target value
+#define PBR_ORDER_SEQUENTIAL_VAL             L"sequential"               //!< 'order' target value
+#define PBR_ORDER_KEYED_VAL                  L"keyed"                    //!< 'order' target value
 /** Persistent memory type **/
 #define PERSISTENT_MEM_TYPE_AD_STR        L"AppDirect"
 #define PERSISTENT_MEM_TYPE_AD_NI_STR     L"AppDirectNotInterleaved"
@@ -228,6 +243,7 @@
 #define APP_DIRECT_SETTINGS_PROPERTY      L"APPDIRECT_SETTINGS"
 #define LABEL_VERSION_PROPERTY            L"LabelVersion"
 #define NS_LABEL_VERSION_PROPERTY         L"NamespaceLabelVersion"
+#define COMPRESS_PROPERTY                 L"Compress"                 //!< 'Compress' property name
 #define SEVERITY_PROPERTY                 L"Severity"
 #define PROPERTY_VALUE_UID                L"UID"
 #define PROPERTY_VALUE_HANDLE             L"HANDLE"
@@ -258,6 +274,10 @@
 #define DCPMM_PERFORMANCE_TOTAL_MEDIA_WRITES      L"TotalMediaWrites"
 #define DCPMM_PERFORMANCE_TOTAL_READ_REQUESTS     L"TotalReadRequests"
 #define DCPMM_PERFORMANCE_TOTAL_WRITE_REQUESTS    L"TotalWriteRequests"
+#define DCPMM_PERFORMANCE_SAMPLE                  L"Sample"
+#define DCPMM_PERFORMANCE_INTERVAL_MS             L"IntervalMs"
+#define DCPMM_PERFORMANCE_RATE_SUFFIX             L"PerSec"
+#define HISTORY_TIME_STR                          L"Time"
 
 /** Sensor Detail Messages **/
 #define DIMM_HEALTH_STR_DETAIL                       L"Health - The current " PMEM_MODULE_STR L" health as reported in the SMART log"
@@ -16,9 +16,11 @@
 #include <NvmTypes.h>
 #include <Printer.h>
 #include <ReadRunTimePreferences.h>
+#include <PbrDcpmm.h>
 #ifdef OS_BUILD
 #include <stdio.h>
 #include <errno.h>
+#include <nvm_history.h>
 #endif
 
 CONST CHAR16 *mpImcSize[] = {
@@ -195,6 +197,348 @@ Finish:
 }
 
 
+/**
+  Compare DimmID field in DIMM_INFO_CORE Struct
+
+  @param[in] pFirst First item to compare
+  @param[in] pSecond Second item to compare
+
+  @retval -1 if first is less than second
+  @retval  0 if first is equal to second
+  @retval  1 if first is greater than second
+**/
+STATIC
+INT32
+CompareDimmIdInDimmCore(
+  IN     VOID *pFirst,
+  IN     VOID *pSecond
+)
+{
+  DIMM_INFO_CORE *pDimmCore = NULL;
+  DIMM_INFO_CORE *pDimmCore2 = NULL;
+
+  if (pFirst == NULL || pSecond == NULL) {
+    NVDIMM_DBG("NULL pointer found.");
+    return 0;
+  }
+
+  pDimmCore = (DIMM_INFO_CORE*)pFirst;
+  pDimmCore2 = (DIMM_INFO_CORE*)pSecond;
+
+  if (pDimmCore->DimmID < pDimmCore2->DimmID) {
+    return -1;
+  }
+  else if (pDimmCore->DimmID > pDimmCore2->DimmID) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
+
+/**
+  Retrieve a populated array and count of the identities of the DIMMs in the
+  system, for callers that need no DIMM_INFO category. The caller is
+  responsible for freeing the returned array
+
+  @param[in] pNvmDimmConfigProtocol A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[out] ppDimmCores A pointer to the dimm identity list found in NFIT.
+  @param[out] pDimmCount A pointer to the number of DIMMs found in NFIT.
+
+  @retval EFI_SUCCESS  the dimm list was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmCoreList(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     struct Command *pCmd,
+     OUT DIMM_INFO_CORE **ppDimmCores,
+     OUT UINT32 *pDimmCount
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  NVDIMM_ENTRY();
+
+  if (pNvmDimmConfigProtocol == NULL || ppDimmCores == NULL || pDimmCount == NULL || pCmd == NULL) {
+    NVDIMM_CRIT("NULL input parameter.\n");
+    ReturnCode = EFI_INVALID_PARAMETER;
+    goto Finish;
+  }
+
+  ReturnCode = pNvmDimmConfigProtocol->GetDimmCount(pNvmDimmConfigProtocol, pDimmCount);
+  if (EFI_ERROR(ReturnCode)) {
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_INTERNAL_ERROR);
+    NVDIMM_DBG("Failed on GetDimmCount.");
+    goto Finish;
+  }
+
+  if (*pDimmCount == 0) {
+    ReturnCode = EFI_NOT_FOUND;
+    goto Finish;
+  }
+
+  *ppDimmCores = AllocateZeroPool(sizeof(**ppDimmCores) * (*pDimmCount));
+
+  if (*ppDimmCores == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+
+  ReturnCode = pNvmDimmConfigProtocol->GetDimmCores(pNvmDimmConfigProtocol, *pDimmCount, *ppDimmCores);
+  if (EFI_ERROR(ReturnCode)) {
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_INTERNAL_ERROR);
+    NVDIMM_DBG("Failed to retrieve the DIMM identities");
+    goto FinishError;
+  }
+
+  ReturnCode = BubbleSort((VOID*)*ppDimmCores, *pDimmCount, sizeof(**ppDimmCores), CompareDimmIdInDimmCore);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_DBG("Dimms list may not be sorted");
+    goto FinishError;
+  }
+
+  goto Finish;
+
+FinishError:
+  FREE_POOL_SAFE(*ppDimmCores);
+Finish:
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Copy the identity of a PMem module out of its DIMM_INFO
+
+  @param[in] pDimmInfo The PMem module info
+  @param[out] pDimmCore The PMem module identity
+**/
+VOID
+DimmInfoToCore(
+  IN     DIMM_INFO *pDimmInfo,
+     OUT DIMM_INFO_CORE *pDimmCore
+)
+{
+  if (pDimmInfo == NULL || pDimmCore == NULL) {
+    return;
+  }
+
+  ZeroMem(pDimmCore, sizeof(*pDimmCore));
+  pDimmCore->DimmID = pDimmInfo->DimmID;
+  pDimmCore->DimmHandle = pDimmInfo->DimmHandle;
+  StrnCpyS(pDimmCore->DimmUid, MAX_DIMM_UID_LENGTH, pDimmInfo->DimmUid, MAX_DIMM_UID_LENGTH - 1);
+  pDimmCore->SocketId = pDimmInfo->SocketId;
+  pDimmCore->ImcId = pDimmInfo->ImcId;
+  pDimmCore->ChannelId = pDimmInfo->ChannelId;
+  pDimmCore->ChannelPos = pDimmInfo->ChannelPos;
+  pDimmCore->NodeControllerID = pDimmInfo->NodeControllerID;
+  pDimmCore->ManageabilityState = pDimmInfo->ManageabilityState;
+  pDimmCore->IsInPopulationViolation = pDimmInfo->IsInPopulationViolation;
+  pDimmCore->ErrorMask = pDimmInfo->ErrorMask & DIMM_INFO_ERROR_UID;
+}
+
+/**
+  Retrieve the PMem modules in the system as a set of identities, the
+  DIMM_INFO of a module is only fetched when GetDimmInfoFromSet asks for it.
+  The caller is responsible for freeing the set with FreeDimmInfoSet
+
+  @param[in] pNvmDimmConfigProtocol A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[out] ppDimmSet A pointer to the set of the PMem modules found in NFIT.
+
+  @retval EFI_SUCCESS  the set was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmInfoSet(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     struct Command *pCmd,
+     OUT DIMM_INFO_SET **ppDimmSet
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  DIMM_INFO_SET *pDimmSet = NULL;
+  NVDIMM_ENTRY();
+
+  if (pNvmDimmConfigProtocol == NULL || ppDimmSet == NULL || pCmd == NULL) {
+    NVDIMM_CRIT("NULL input parameter.\n");
+    goto Finish;
+  }
+
+  pDimmSet = AllocateZeroPool(sizeof(*pDimmSet));
+  if (pDimmSet == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+  pDimmSet->pNvmDimmConfigProtocol = pNvmDimmConfigProtocol;
+
+  ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimmSet->pDimmCores, &pDimmSet->DimmCount);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+
+  pDimmSet->ppDimmInfos = AllocateZeroPool(sizeof(*pDimmSet->ppDimmInfos) * pDimmSet->DimmCount);
+  pDimmSet->pCategories = AllocateZeroPool(sizeof(*pDimmSet->pCategories) * pDimmSet->DimmCount);
+  if (pDimmSet->ppDimmInfos == NULL || pDimmSet->pCategories == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+
+  *ppDimmSet = pDimmSet;
+  pDimmSet = NULL;
+
+Finish:
+  FreeDimmInfoSet(&pDimmSet);
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Get the DIMM_INFO of a PMem module of a set, with at least the requested
+  categories populated. It is fetched on the first request and fetched again
+  when categories not populated yet are requested. The DIMM_INFO belongs to
+  the set.
+
+  @param[in] pDimmSet The set from GetDimmInfoSet
+  @param[in] Index Index of the PMem module in pDimmSet->pDimmCores
+  @param[in] DimmInfoCategories Categories that will be populated in the DIMM_INFO struct.
+  @param[out] ppDimmInfo A pointer to the DIMM_INFO of the PMem module.
+
+  @retval EFI_SUCCESS  the DIMM_INFO was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL or Index is out of range
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  Other return codes from GetDimm
+**/
+EFI_STATUS
+GetDimmInfoFromSet(
+  IN     DIMM_INFO_SET *pDimmSet,
+  IN     UINT32 Index,
+  IN     DIMM_INFO_CATEGORIES DimmInfoCategories,
+     OUT DIMM_INFO **ppDimmInfo
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  DIMM_INFO_CATEGORIES Categories = DIMM_INFO_CATEGORY_NONE;
+  NVDIMM_ENTRY();
+
+  if (pDimmSet == NULL || ppDimmInfo == NULL || Index >= pDimmSet->DimmCount) {
+    NVDIMM_CRIT("Invalid input parameter.\n");
+    goto Finish;
+  }
+
+  if (pDimmSet->ppDimmInfos[Index] != NULL &&
+      (DimmInfoCategories & pDimmSet->pCategories[Index]) == DimmInfoCategories) {
+    *ppDimmInfo = pDimmSet->ppDimmInfos[Index];
+    ReturnCode = EFI_SUCCESS;
+    goto Finish;
+  }
+
+  if (pDimmSet->ppDimmInfos[Index] == NULL) {
+    pDimmSet->ppDimmInfos[Index] = AllocateZeroPool(sizeof(*pDimmSet->ppDimmInfos[Index]));
+    if (pDimmSet->ppDimmInfos[Index] == NULL) {
+      ReturnCode = EFI_OUT_OF_RESOURCES;
+      goto Finish;
+    }
+  } else {
+    Categories = pDimmSet->pCategories[Index];
+  }
+  Categories |= DimmInfoCategories;
+
+  ReturnCode = pDimmSet->pNvmDimmConfigProtocol->GetDimm(pDimmSet->pNvmDimmConfigProtocol,
+    pDimmSet->pDimmCores[Index].DimmID, Categories, pDimmSet->ppDimmInfos[Index]);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_DBG("Failed to retrieve the DIMM_INFO of DIMM 0x%x", pDimmSet->pDimmCores[Index].DimmHandle);
+    FREE_POOL_SAFE(pDimmSet->ppDimmInfos[Index]);
+    pDimmSet->pCategories[Index] = DIMM_INFO_CATEGORY_NONE;
+    goto Finish;
+  }
+  pDimmSet->pCategories[Index] = Categories;
+  *ppDimmInfo = pDimmSet->ppDimmInfos[Index];
+
+Finish:
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Get the DIMM_INFO of the PMem module of a set with the given DimmID, see
+  GetDimmInfoFromSet
+
+  @param[in] pDimmSet The set from GetDimmInfoSet
+  @param[in] DimmId SMBIOS DimmID of the PMem module
+  @param[in] DimmInfoCategories Categories that will be populated in the DIMM_INFO struct.
+  @param[out] ppDimmInfo A pointer to the DIMM_INFO of the PMem module.
+
+  @retval EFI_SUCCESS  the DIMM_INFO was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_NOT_FOUND the PMem module is not in the set
+  Other return codes from GetDimmInfoFromSet
+**/
+EFI_STATUS
+GetDimmInfoFromSetById(
+  IN     DIMM_INFO_SET *pDimmSet,
+  IN     UINT16 DimmId,
+  IN     DIMM_INFO_CATEGORIES DimmInfoCategories,
+     OUT DIMM_INFO **ppDimmInfo
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  UINT32 DimmHandle = 0;
+  UINT32 Index = 0;
+  NVDIMM_ENTRY();
+
+  if (pDimmSet == NULL || ppDimmInfo == NULL) {
+    NVDIMM_CRIT("NULL input parameter.\n");
+    goto Finish;
+  }
+
+  ReturnCode = GetDimmHandleByCorePid(DimmId, pDimmSet->pDimmCores, pDimmSet->DimmCount, &DimmHandle, &Index);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_DBG("DimmID: 0x%04x not found.", DimmId);
+    goto Finish;
+  }
+
+  ReturnCode = GetDimmInfoFromSet(pDimmSet, Index, DimmInfoCategories, ppDimmInfo);
+
+Finish:
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Free a set from GetDimmInfoSet together with the DIMM_INFO fetched into it
+
+  @param[in, out] ppDimmSet A pointer to the set, set to NULL
+**/
+VOID
+FreeDimmInfoSet(
+  IN OUT DIMM_INFO_SET **ppDimmSet
+)
+{
+  UINT32 Index = 0;
+
+  if (ppDimmSet == NULL || *ppDimmSet == NULL) {
+    return;
+  }
+
+  if ((*ppDimmSet)->ppDimmInfos != NULL) {
+    for (Index = 0; Index < (*ppDimmSet)->DimmCount; Index++) {
+      FREE_POOL_SAFE((*ppDimmSet)->ppDimmInfos[Index]);
+    }
+  }
+  FREE_POOL_SAFE((*ppDimmSet)->ppDimmInfos);
+  FREE_POOL_SAFE((*ppDimmSet)->pCategories);
+  FREE_POOL_SAFE((*ppDimmSet)->pDimmCores);
+  FREE_POOL_SAFE(*ppDimmSet);
+}
+
 /**
   Retrieve a populated array and count of all DCPMMs (functional and non-functional)
   in the system. The caller is responsible for freeing the returned array
@@ -384,6 +728,15 @@ Finish:
   return Rc;
 }
 
+/**
+  Read a field that DIMM_INFO and DIMM_INFO_CORE both have from a PMem module
+  list given as either of them, pDimmCores is used when it is not NULL. The
+  list helpers below take both so that DIMM_INFO and DIMM_INFO_CORE lists share
+  a single implementation.
+**/
+#define DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index, Field) \
+  ((pDimmCores) != NULL ? (pDimmCores)[Index].Field : (pDimmInfos)[Index].Field)
+
 /**
   Parses the dimm target string (which can contain DimmIDs as NFIT handles and/or DimmUIDs),
   and returns an array of DimmIDs in the SMBIOS physical-id forms.
@@ -397,8 +750,9 @@ Finish:
 
   @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
   @param[in] pDimmString The dimm target string to parse.
-  @param[in] pDimmInfo The dimm list found in NFIT.
-  @param[in] DimmCount Size of the pDimmInfo array.
+  @param[in] pDimmInfos The dimm list found in NFIT, used when pDimmCores is NULL.
+  @param[in] pDimmCores The dimm identities found in NFIT.
+  @param[in] DimmCount Size of the pDimmInfos or pDimmCores array.
   @param[out] ppDimmIds Pointer to the array allocated and filled with the SMBIOS DimmIDs.
   @param[out] pDimmIdsCount Size of the pDimmIds array.
 
@@ -407,11 +761,13 @@ Finish:
   @retval EFI_INVALID_PARAMETER inputs are null, the format of string is not proper, duplicated Dimm IDs
   @retval EFI_NOT_FOUND dimm not found
 **/
+STATIC
 EFI_STATUS
-GetDimmIdsFromString(
+GetDimmIdsFromDimmList(
   IN     struct Command *pCmd,
   IN     CHAR16 *pDimmString,
-  IN     DIMM_INFO *pDimmInfo,
+  IN     DIMM_INFO *pDimmInfos,
+  IN     DIMM_INFO_CORE *pDimmCores,
   IN     UINT32 DimmCount,
   OUT UINT16 **ppDimmIds,
   OUT UINT32 *pDimmIdsCount
@@ -428,7 +784,7 @@ GetDimmIdsFromString(
 
   NVDIMM_ENTRY();
 
-  if ((pDimmString == NULL) || (pDimmInfo == NULL) || (ppDimmIds == NULL) || (pDimmIdsCount == NULL) || (pCmd == NULL)) {
+  if ((pDimmString == NULL) || (pDimmInfos == NULL && pDimmCores == NULL && DimmCount > 0) || (ppDimmIds == NULL) || (pDimmIdsCount == NULL) || (pCmd == NULL)) {
     NVDIMM_CRIT("NULL input parameter.\n");
     Rc = EFI_INVALID_PARAMETER;
     goto Finish;
@@ -479,14 +835,14 @@ GetDimmIdsFromString(
       Checking if the specified DIMMs exist
     **/
     for (Index2 = 0; Index2 < DimmCount; Index2++) {
-      if ((!pIsDimmIdNumber[Index] && StrICmp(ppDimmIdTokensStr[Index], pDimmInfo[Index2].DimmUid) == 0) ||
-        (pIsDimmIdNumber[Index] && pDimmInfo[Index2].DimmHandle == pParsedDimmIdNumber[Index]))
+      if ((!pIsDimmIdNumber[Index] && StrICmp(ppDimmIdTokensStr[Index], DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index2, DimmUid)) == 0) ||
+        (pIsDimmIdNumber[Index] && DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index2, DimmHandle) == pParsedDimmIdNumber[Index]))
       {
         // This DimmID is unique for all dimms on the platform regardless of
         // state and is assigned by UEFI FW. We use it for all our APIs.
         // Handle seems to be a better identifier since it corresponds to the
         // position on the board, but this is good enough and cheap to look up.
-        (*ppDimmIds)[Index] = pDimmInfo[Index2].DimmID;
+        (*ppDimmIds)[Index] = DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index2, DimmID);
         DimmIdFound = TRUE;
         break;
       }
@@ -524,6 +880,67 @@ Finish:
   return Rc;
 }
 
+/**
+  Parses the dimm target string (which can contain DimmIDs as NFIT handles and/or DimmUIDs),
+  and returns an array of DimmIDs in the SMBIOS physical-id forms, see GetDimmIdsFromDimmList
+
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[in] pDimmString The dimm target string to parse.
+  @param[in] pDimmCores The dimm identities found in NFIT.
+  @param[in] DimmCount Size of the pDimmCores array.
+  @param[out] ppDimmIds Pointer to the array allocated and filled with the SMBIOS DimmIDs.
+  @param[out] pDimmIdsCount Size of the pDimmIds array.
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_INVALID_PARAMETER inputs are null, the format of string is not proper, duplicated Dimm IDs
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmIdsFromCoreList(
+  IN     struct Command *pCmd,
+  IN     CHAR16 *pDimmString,
+  IN     DIMM_INFO_CORE *pDimmCores,
+  IN     UINT32 DimmCount,
+  OUT UINT16 **ppDimmIds,
+  OUT UINT32 *pDimmIdsCount
+)
+{
+  return GetDimmIdsFromDimmList(pCmd, pDimmString, NULL, pDimmCores, DimmCount, ppDimmIds, pDimmIdsCount);
+}
+
+/**
+  Parses the dimm target string (which can contain DimmIDs as SMBIOS type-17 handles and/or DimmUIDs),
+  and returns an array of DimmIDs in the SMBIOS table format, see GetDimmIdsFromDimmList
+
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[in] pDimmString The dimm target string to parse.
+  @param[in] pDimmInfo The dimm list found in NFIT.
+  @param[in] DimmCount Size of the pDimmInfo array.
+  @param[out] ppDimmIds Pointer to the array allocated and filled with the SMBIOS DimmIDs.
+  @param[out] pDimmIdsCount Size of the pDimmIds array.
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_INVALID_PARAMETER inputs are null, the format of string is not proper, duplicated Dimm IDs
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmIdsFromString(
+  IN     struct Command *pCmd,
+  IN     CHAR16 *pDimmString,
+  IN     DIMM_INFO *pDimmInfo,
+  IN     UINT32 DimmCount,
+  OUT UINT16 **ppDimmIds,
+  OUT UINT32 *pDimmIdsCount
+)
+{
+  if (pDimmInfo == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  return GetDimmIdsFromDimmList(pCmd, pDimmString, pDimmInfo, NULL, DimmCount, ppDimmIds, pDimmIdsCount);
+}
+
 /**
 Parses the dimm target string (which can contain DimmIDs as SMBIOS type-17 handles and/or DimmUIDs),
 and returns a DimmUid.
@@ -707,7 +1124,7 @@ GetManageableDimmsNumberAndId(
 )
 {
   EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT16 Index = 0;
   UINT16 NewListIndex = 0;
 
@@ -733,7 +1150,7 @@ GetManageableDimmsNumberAndId(
     goto Finish;
   }
 
-  ReturnCode = pNvmDimmConfigProtocol->GetDimms(pNvmDimmConfigProtocol, *pDimmIdsCount, DIMM_INFO_CATEGORY_NONE, pDimms);
+  ReturnCode = pNvmDimmConfigProtocol->GetDimmCores(pNvmDimmConfigProtocol, *pDimmIdsCount, pDimms);
   if (EFI_ERROR(ReturnCode)) {
     NVDIMM_ERR("Failed to retrieve the DIMM inventory found in NFIT");
     goto Finish;
@@ -1635,40 +2052,275 @@ DumpToFile(
     if (Overwrite) {
       ReturnCode = pFileHandle->Delete(pFileHandle);
 
-      if (EFI_ERROR(ReturnCode)) {
-        NVDIMM_WARN("Failed deleting old dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
-        goto Finish;
-      }
+      if (EFI_ERROR(ReturnCode)) {
+        NVDIMM_WARN("Failed deleting old dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
+        goto Finish;
+      }
+
+      // Create new file for dump
+      ReturnCode = OpenFileByDevice(pDumpFilePath, pDevicePathProtocol, TRUE, &pFileHandle);
+      if (EFI_ERROR(ReturnCode)) {
+        NVDIMM_WARN("Failed to create dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
+        goto Finish;
+      }
+    }
+    else {
+      NVDIMM_WARN("File exists and we're not allowed to overwrite (%s)", pDumpFilePath);
+      ReturnCode = EFI_INVALID_PARAMETER;
+      goto Finish;
+    }
+  }
+  SizeToWrite = BufferSize;
+  ReturnCode = pFileHandle->Write(pFileHandle, &SizeToWrite, pBuffer);
+
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_WARN("Error occurred during write (%s)", pDumpFilePath);
+    goto FinishCloseFile;
+  }
+
+FinishCloseFile:
+  ReturnCode = pFileHandle->Close(pFileHandle);
+
+Finish:
+  FREE_POOL_SAFE(pDumpFilePath);
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+#endif
+}
+
+/**
+  Create or truncate a file for streamed dumping
+
+  @param[in] pDumpUserPath - destination file path
+  @param[out] ppDumpFile - the opened file, to be closed with CloseDumpFile
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+OpenDumpFile(
+  IN     CHAR16* pDumpUserPath,
+     OUT DUMP_FILE** ppDumpFile
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  DUMP_FILE *pDumpFile = NULL;
+#ifdef OS_BUILD
+  CHAR8 *path = NULL;
+#else
+  EFI_DEVICE_PATH_PROTOCOL *pDevicePathProtocol = NULL;
+  EFI_FILE_HANDLE pFileHandle = NULL;
+  CHAR16 *pDumpFilePath = NULL;
+  UINT64 FileSize = 0;
+#endif
+  NVDIMM_ENTRY();
+
+  if (pDumpUserPath == NULL || ppDumpFile == NULL) {
+    goto Finish;
+  }
+
+  pDumpFile = AllocateZeroPool(sizeof(*pDumpFile));
+  if (pDumpFile == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  pDumpFile->pBuffer = AllocatePool(DUMP_FILE_BUFFER_SIZE);
+  if (pDumpFile->pBuffer == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+#ifdef OS_BUILD
+  path = (CHAR8 *)AllocatePool(StrLen(pDumpUserPath) + 1);
+  if (NULL == path) {
+    NVDIMM_WARN("Failed to allocate enough memory.");
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+  UnicodeStrToAsciiStrS(pDumpUserPath, path, StrLen(pDumpUserPath) + 1);
+  pDumpFile->pFile = fopen(path, "wb+");
+  if (NULL == pDumpFile->pFile) {
+    NVDIMM_WARN("Failed to open file (%s) errno: (%d)", path, errno);
+    ReturnCode = EFI_INVALID_PARAMETER;
+    goto Finish;
+  }
+#else
+  pDumpFilePath = AllocateZeroPool(OPTION_VALUE_LEN * sizeof(*pDumpFilePath));
+  if (pDumpFilePath == NULL) {
+    NVDIMM_CRIT("Out of memory\n");
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  ReturnCode = GetDeviceAndFilePath(pDumpUserPath, pDumpFilePath, &pDevicePathProtocol);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_WARN("Failed to get file path (" FORMAT_EFI_STATUS ")", ReturnCode);
+    goto Finish;
+  }
+
+  ReturnCode = OpenFileByDevice(pDumpFilePath, pDevicePathProtocol, TRUE, &pFileHandle);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_WARN("Failed to open file (" FORMAT_EFI_STATUS ") (%s)", ReturnCode, pDumpFilePath);
+    goto Finish;
+  }
+
+  // Start from an empty file, as DumpToFile does when overwriting
+  ReturnCode = GetFileSize(pFileHandle, &FileSize);
+  if (FileSize != 0) {
+    ReturnCode = pFileHandle->Delete(pFileHandle);
+    if (EFI_ERROR(ReturnCode)) {
+      NVDIMM_WARN("Failed deleting old dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
+      goto Finish;
+    }
+
+    ReturnCode = OpenFileByDevice(pDumpFilePath, pDevicePathProtocol, TRUE, &pFileHandle);
+    if (EFI_ERROR(ReturnCode)) {
+      NVDIMM_WARN("Failed to create dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
+      goto Finish;
+    }
+  }
+  pDumpFile->pFile = pFileHandle;
+#endif
+
+  *ppDumpFile = pDumpFile;
+  pDumpFile = NULL;
+  ReturnCode = EFI_SUCCESS;
+
+Finish:
+  if (pDumpFile != NULL) {
+    FREE_POOL_SAFE(pDumpFile->pBuffer);
+    FREE_POOL_SAFE(pDumpFile);
+  }
+#ifdef OS_BUILD
+  FREE_POOL_SAFE(path);
+#else
+  FREE_POOL_SAFE(pDumpFilePath);
+#endif
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Write out the data buffered by a DUMP_FILE
+
+  @param[in] pDumpFile - the file to flush
+
+  @retval - Appropriate EFI return code
+**/
+STATIC
+EFI_STATUS
+FlushDumpFile(
+  IN     DUMP_FILE* pDumpFile
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+#ifndef OS_BUILD
+  EFI_FILE_HANDLE pFileHandle = (EFI_FILE_HANDLE)pDumpFile->pFile;
+  UINTN SizeToWrite = (UINTN)pDumpFile->BufferUsed;
+#endif
+
+  if (pDumpFile->BufferUsed == 0) {
+    return ReturnCode;
+  }
+
+#ifdef OS_BUILD
+  if (fwrite(pDumpFile->pBuffer, 1, (size_t)pDumpFile->BufferUsed, (FILE *)pDumpFile->pFile) != pDumpFile->BufferUsed) {
+    NVDIMM_WARN("Failed to write file errno: (%d)", errno);
+    ReturnCode = EFI_INVALID_PARAMETER;
+  }
+#else
+  ReturnCode = pFileHandle->Write(pFileHandle, &SizeToWrite, pDumpFile->pBuffer);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_WARN("Error occurred during write (" FORMAT_EFI_STATUS ")", ReturnCode);
+  }
+#endif
+
+  pDumpFile->BufferUsed = 0;
+  return ReturnCode;
+}
+
+/**
+  Append data to a file opened with OpenDumpFile
+
+  @param[in] pDumpFile - the file to write to
+  @param[in] BufferSize - data size to write
+  @param[in] pBuffer - pointer to buffer
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+WriteDumpFile(
+  IN     DUMP_FILE* pDumpFile,
+  IN     UINT64 BufferSize,
+  IN     VOID* pBuffer
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  UINT8 *pData = (UINT8 *)pBuffer;
+  UINT64 Chunk = 0;
+
+  if (pDumpFile == NULL || (pBuffer == NULL && BufferSize > 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
 
-      // Create new file for dump
-      ReturnCode = OpenFileByDevice(pDumpFilePath, pDevicePathProtocol, TRUE, &pFileHandle);
+  while (BufferSize > 0) {
+    if (pDumpFile->BufferUsed == DUMP_FILE_BUFFER_SIZE) {
+      ReturnCode = FlushDumpFile(pDumpFile);
       if (EFI_ERROR(ReturnCode)) {
-        NVDIMM_WARN("Failed to create dump file (" FORMAT_EFI_STATUS ")", ReturnCode);
-        goto Finish;
+        return ReturnCode;
       }
     }
-    else {
-      NVDIMM_WARN("File exists and we're not allowed to overwrite (%s)", pDumpFilePath);
-      ReturnCode = EFI_INVALID_PARAMETER;
-      goto Finish;
-    }
+
+    Chunk = MIN(BufferSize, DUMP_FILE_BUFFER_SIZE - pDumpFile->BufferUsed);
+    CopyMem(pDumpFile->pBuffer + pDumpFile->BufferUsed, pData, (UINTN)Chunk);
+    pDumpFile->BufferUsed += Chunk;
+    pData += Chunk;
+    BufferSize -= Chunk;
   }
-  SizeToWrite = BufferSize;
-  ReturnCode = pFileHandle->Write(pFileHandle, &SizeToWrite, pBuffer);
 
-  if (EFI_ERROR(ReturnCode)) {
-    NVDIMM_WARN("Error occurred during write (%s)", pDumpFilePath);
-    goto FinishCloseFile;
+  return ReturnCode;
+}
+
+/**
+  Write out buffered data and close a file opened with OpenDumpFile
+
+  @param[in] pDumpFile - the file to close, may be NULL
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+CloseDumpFile(
+  IN     DUMP_FILE* pDumpFile
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  EFI_STATUS CloseReturnCode = EFI_SUCCESS;
+#ifndef OS_BUILD
+  EFI_FILE_HANDLE pFileHandle = NULL;
+#endif
+
+  if (pDumpFile == NULL) {
+    return ReturnCode;
   }
 
-FinishCloseFile:
-  ReturnCode = pFileHandle->Close(pFileHandle);
+  ReturnCode = FlushDumpFile(pDumpFile);
 
-Finish:
-  FREE_POOL_SAFE(pDumpFilePath);
-  NVDIMM_EXIT_I64(ReturnCode);
-  return ReturnCode;
+#ifdef OS_BUILD
+  if (fclose((FILE *)pDumpFile->pFile) != 0) {
+    CloseReturnCode = EFI_INVALID_PARAMETER;
+  }
+#else
+  pFileHandle = (EFI_FILE_HANDLE)pDumpFile->pFile;
+  CloseReturnCode = pFileHandle->Close(pFileHandle);
 #endif
+
+  if (!EFI_ERROR(ReturnCode)) {
+    ReturnCode = CloseReturnCode;
+  }
+
+  FREE_POOL_SAFE(pDumpFile->pBuffer);
+  FREE_POOL_SAFE(pDumpFile);
+  return ReturnCode;
 }
 
 /**
@@ -2308,17 +2960,20 @@ Finish:
   This helper method assumes all the dimms in the list exist.
   This helper method also assumes the parameters are non-null.
 
-  @param[in] pAllDimms The dimm list found in NFIT
-  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pAllDimmInfos The dimm list found in NFIT, used when pAllDimmCores is NULL
+  @param[in] pAllDimmCores The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimmInfos or pAllDimmCores array
   @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
   @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
 
   @retval TRUE if all Dimms in pDimmsListToCheck array are manageable
   @retval FALSE if at least one DIMM is not manageable
 **/
+STATIC
 BOOLEAN
-AllDimmsInListAreManageable(
-  IN     DIMM_INFO *pAllDimms,
+AllDimmsInDimmListAreManageable(
+  IN     DIMM_INFO *pAllDimmInfos,
+  IN     DIMM_INFO_CORE *pAllDimmCores,
   IN     UINT32 AllDimmCount,
   IN     UINT16 *pDimmsListToCheck,
   IN     UINT32 DimmsToCheckCount
@@ -2331,8 +2986,8 @@ AllDimmsInListAreManageable(
 
   for (DimmsToCheckIndex = 0; DimmsToCheckIndex < DimmsToCheckCount; DimmsToCheckIndex++) {
     for (AllDimmListIndex = 0; AllDimmListIndex < AllDimmCount; AllDimmListIndex++) {
-      if (pAllDimms[AllDimmListIndex].DimmID == pDimmsListToCheck[DimmsToCheckIndex]) {
-        if (pAllDimms[AllDimmListIndex].ManageabilityState != MANAGEMENT_VALID_CONFIG) {
+      if (DIMM_LIST_FIELD(pAllDimmInfos, pAllDimmCores, AllDimmListIndex, DimmID) == pDimmsListToCheck[DimmsToCheckIndex]) {
+        if (DIMM_LIST_FIELD(pAllDimmInfos, pAllDimmCores, AllDimmListIndex, ManageabilityState) != MANAGEMENT_VALID_CONFIG) {
           Manageable = FALSE;
           break;
         }
@@ -2345,8 +3000,8 @@ AllDimmsInListAreManageable(
 }
 
 /**
-  Check if all dimms in the specified pDimmIds list are in supported
-  config. This helper method assumes all the dimms in the list exist.
+  Check if all dimms in the specified pDimmIds list are manageable.
+  This helper method assumes all the dimms in the list exist.
   This helper method also assumes the parameters are non-null.
 
   @param[in] pAllDimms The dimm list found in NFIT
@@ -2354,12 +3009,63 @@ AllDimmsInListAreManageable(
   @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
   @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
 
+  @retval TRUE if all Dimms in pDimmsListToCheck array are manageable
+  @retval FALSE if at least one DIMM is not manageable
+**/
+BOOLEAN
+AllDimmsInListAreManageable(
+  IN     DIMM_INFO *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+)
+{
+  return AllDimmsInDimmListAreManageable(pAllDimms, NULL, AllDimmCount, pDimmsListToCheck, DimmsToCheckCount);
+}
+
+/**
+  Check if all dimms in the specified pDimmIds list are manageable.
+  This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimms The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
+  @retval TRUE if all Dimms in pDimmsListToCheck array are manageable
+  @retval FALSE if at least one DIMM is not manageable
+**/
+BOOLEAN
+AllDimmCoresInListAreManageable(
+  IN     DIMM_INFO_CORE *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+)
+{
+  return AllDimmsInDimmListAreManageable(NULL, pAllDimms, AllDimmCount, pDimmsListToCheck, DimmsToCheckCount);
+}
+
+/**
+  Check if all dimms in the specified pDimmIds list are in supported
+  config. This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimmInfos The dimm list found in NFIT, used when pAllDimmCores is NULL
+  @param[in] pAllDimmCores The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimmInfos or pAllDimmCores array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
   @retval TRUE if all Dimms in pDimmsListToCheck array are in supported config
   @retval FALSE if at least one DIMM is not in supported config
 **/
+STATIC
 BOOLEAN
-AllDimmsInListInSupportedConfig(
-  IN     DIMM_INFO *pAllDimms,
+AllDimmsInDimmListInSupportedConfig(
+  IN     DIMM_INFO *pAllDimmInfos,
+  IN     DIMM_INFO_CORE *pAllDimmCores,
   IN     UINT32 AllDimmCount,
   IN     UINT16 *pDimmsListToCheck,
   IN     UINT32 DimmsToCheckCount
@@ -2372,8 +3078,8 @@ AllDimmsInListInSupportedConfig(
 
   for (DimmsToCheckIndex = 0; DimmsToCheckIndex < DimmsToCheckCount; DimmsToCheckIndex++) {
     for (AllDimmListIndex = 0; AllDimmListIndex < AllDimmCount; AllDimmListIndex++) {
-      if (pAllDimms[AllDimmListIndex].DimmID == pDimmsListToCheck[DimmsToCheckIndex]) {
-        if (pAllDimms[AllDimmListIndex].IsInPopulationViolation == TRUE) {
+      if (DIMM_LIST_FIELD(pAllDimmInfos, pAllDimmCores, AllDimmListIndex, DimmID) == pDimmsListToCheck[DimmsToCheckIndex]) {
+        if (DIMM_LIST_FIELD(pAllDimmInfos, pAllDimmCores, AllDimmListIndex, IsInPopulationViolation) == TRUE) {
           InSupportedConfig = FALSE;
           break;
         }
@@ -2385,6 +3091,54 @@ AllDimmsInListInSupportedConfig(
   return InSupportedConfig;
 }
 
+/**
+  Check if all dimms in the specified pDimmIds list are in supported
+  config. This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimms The dimm list found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
+  @retval TRUE if all Dimms in pDimmsListToCheck array are in supported config
+  @retval FALSE if at least one DIMM is not in supported config
+**/
+BOOLEAN
+AllDimmsInListInSupportedConfig(
+  IN     DIMM_INFO *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+)
+{
+  return AllDimmsInDimmListInSupportedConfig(pAllDimms, NULL, AllDimmCount, pDimmsListToCheck, DimmsToCheckCount);
+}
+
+/**
+  Check if all dimms in the specified pDimmIds list are in supported
+  config. This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimms The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
+  @retval TRUE if all Dimms in pDimmsListToCheck array are in supported config
+  @retval FALSE if at least one DIMM is not in supported config
+**/
+BOOLEAN
+AllDimmCoresInListInSupportedConfig(
+  IN     DIMM_INFO_CORE *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+)
+{
+  return AllDimmsInDimmListInSupportedConfig(NULL, pAllDimms, AllDimmCount, pDimmsListToCheck, DimmsToCheckCount);
+}
+
 /**
   Check if all dimms in the specified pDimmIds list have master passphrase enabled.
   This helper method assumes all the dimms in the list exist.
@@ -2498,6 +3252,12 @@ ReadCmdLinePrintOptions(
       else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_NVMXML)) {
         *pFormatType = XML;
       }
+      else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_JSON)) {
+        *pFormatType = JSON;
+      }
+      else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_CSV)) {
+        *pFormatType = CSV;
+      }
       else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_ESX_XML)) {
         *pFormatType = XML;
         PRINTER_ENABLE_ESX_XML_FORMAT(pCmd->pPrintCtx);
@@ -2506,6 +3266,13 @@ ReadCmdLinePrintOptions(
         *pFormatType = XML;
         PRINTER_ENABLE_ESX_TABLE_XML_FORMAT(pCmd->pPrintCtx);
       }
+      else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_LINE)) {
+        *pFormatType = TEXT;
+        PRINTER_ENABLE_LINE_FORMAT(pCmd->pPrintCtx);
+      }
+      else if (0 == StrICmp(Toks[Index], OUTPUT_OPTION_STREAM)) {
+        PRINTER_ENABLE_STREAM_FORMAT(pCmd->pPrintCtx);
+      }
       else {
         // Print out syntax specific help message for invalid -output option
         CHAR16 * pHelpStr = getCommandHelp(pCmd, TRUE);
@@ -2551,14 +3318,20 @@ CreateCmdLineOutputStr(
     return EFI_INVALID_PARAMETER;
   }
 
-  if (XML != pCmd->pPrintCtx->FormatType) {
+  if (TEXT == pCmd->pPrintCtx->FormatType) {
     *ppOutputStr = CatSPrint(NULL, L"");
     return EFI_SUCCESS;
   }
 
   *ppOutputStr = CatSPrint(*ppOutputStr, OUTPUT_OPTION_SHORT L" ");
 
-  if (pCmd->pPrintCtx->FormatTypeFlags.Flags.EsxCustom) {
+  if (JSON == pCmd->pPrintCtx->FormatType) {
+    *ppOutputStr = CatSPrintClean(*ppOutputStr, OUTPUT_OPTION_JSON L" ");
+  }
+  else if (CSV == pCmd->pPrintCtx->FormatType) {
+    *ppOutputStr = CatSPrintClean(*ppOutputStr, OUTPUT_OPTION_CSV L" ");
+  }
+  else if (pCmd->pPrintCtx->FormatTypeFlags.Flags.EsxCustom) {
     *ppOutputStr = CatSPrintClean(*ppOutputStr, OUTPUT_OPTION_ESX_TABLE_XML L" ");
   }
   else if (pCmd->pPrintCtx->FormatTypeFlags.Flags.EsxKeyVal) {
@@ -2763,7 +3536,8 @@ RegionTypeToString(
   Gets the DIMM handle corresponding to Dimm PID and also the index
 
   @param[in] DimmId - DIMM ID
-  @param[in] pDimms - List of DIMMs
+  @param[in] pDimmInfos - List of DIMMs, used when pDimmCores is NULL
+  @param[in] pDimmCores - List of DIMM identities
   @param[in] DimmsNum - Number of DIMMs
   @param[out] pDimmHandle - The Dimm Handle corresponding to the DIMM ID
   @param[out] pDimmIndex - The Index of the found DIMM
@@ -2772,39 +3546,39 @@ RegionTypeToString(
   @retval - EFI_INVALID_PARAMETER Invalid parameter
   @retval - EFI_NOT_FOUND Dimm not found
 **/
+STATIC
 EFI_STATUS
-GetDimmHandleByPid(
+GetDimmHandleByPidFromDimmList(
   IN     UINT16 DimmId,
-  IN     DIMM_INFO *pDimms,
+  IN     DIMM_INFO *pDimmInfos,
+  IN     DIMM_INFO_CORE *pDimmCores,
   IN     UINT32 DimmsNum,
   OUT UINT32 *pDimmHandle,
   OUT UINT32 *pDimmIndex
 )
 {
   EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
-  DIMM_INFO *pFoundDimm = NULL;
   UINT32 Index = 0;
 
   NVDIMM_ENTRY();
 
-  if (pDimms == NULL || pDimmHandle == NULL || pDimmIndex == NULL) {
+  if ((pDimmInfos == NULL && pDimmCores == NULL) || pDimmHandle == NULL || pDimmIndex == NULL) {
     goto Finish;
   }
 
   for (Index = 0; Index < DimmsNum; Index++) {
-    if (pDimms[Index].DimmID == DimmId) {
-      pFoundDimm = &pDimms[Index];
-      *pDimmIndex = Index;
+    if (DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index, DimmID) == DimmId) {
       break;
     }
   }
 
-  if (pFoundDimm == NULL) {
+  if (Index == DimmsNum) {
     ReturnCode = EFI_NOT_FOUND;
     goto Finish;
   }
 
-  *pDimmHandle = pFoundDimm->DimmHandle;
+  *pDimmHandle = DIMM_LIST_FIELD(pDimmInfos, pDimmCores, Index, DimmHandle);
+  *pDimmIndex = Index;
 
   ReturnCode = EFI_SUCCESS;
 
@@ -2813,6 +3587,62 @@ Finish:
   return ReturnCode;
 }
 
+/**
+  Gets the DIMM handle corresponding to Dimm PID and also the index
+
+  @param[in] DimmId - DIMM ID
+  @param[in] pDimms - List of DIMMs
+  @param[in] DimmsNum - Number of DIMMs
+  @param[out] pDimmHandle - The Dimm Handle corresponding to the DIMM ID
+  @param[out] pDimmIndex - The Index of the found DIMM
+
+  @retval - EFI_STATUS Success
+  @retval - EFI_INVALID_PARAMETER Invalid parameter
+  @retval - EFI_NOT_FOUND Dimm not found
+**/
+EFI_STATUS
+GetDimmHandleByPid(
+  IN     UINT16 DimmId,
+  IN     DIMM_INFO *pDimms,
+  IN     UINT32 DimmsNum,
+  OUT UINT32 *pDimmHandle,
+  OUT UINT32 *pDimmIndex
+)
+{
+  if (pDimms == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  return GetDimmHandleByPidFromDimmList(DimmId, pDimms, NULL, DimmsNum, pDimmHandle, pDimmIndex);
+}
+
+/**
+  Gets the DIMM handle corresponding to Dimm PID and also the index
+
+  @param[in] DimmId - DIMM ID
+  @param[in] pDimms - List of DIMM identities
+  @param[in] DimmsNum - Number of DIMMs
+  @param[out] pDimmHandle - The Dimm Handle corresponding to the DIMM ID
+  @param[out] pDimmIndex - The Index of the found DIMM
+
+  @retval - EFI_STATUS Success
+  @retval - EFI_INVALID_PARAMETER Invalid parameter
+  @retval - EFI_NOT_FOUND Dimm not found
+**/
+EFI_STATUS
+GetDimmHandleByCorePid(
+  IN     UINT16 DimmId,
+  IN     DIMM_INFO_CORE *pDimms,
+  IN     UINT32 DimmsNum,
+  OUT UINT32 *pDimmHandle,
+  OUT UINT32 *pDimmIndex
+)
+{
+  if (pDimms == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  return GetDimmHandleByPidFromDimmList(DimmId, NULL, pDimms, DimmsNum, pDimmHandle, pDimmIndex);
+}
+
 /**
   Convert UEFI return codes to legacy OS return codes
 
@@ -3083,4 +3913,72 @@ BOOLEAN IsDefaultMasterPassphraseRestricted(
   else {
     return FALSE;
   }
-}
\ No newline at end of file
+}
+
+/**
+  Check whether FW commands to different PMem modules may be sent concurrently
+
+  Recording and playback sessions need the commands in order.
+
+  @retval TRUE if the session is in normal mode
+**/
+BOOLEAN
+IsConcurrentFetchAllowed(
+  )
+{
+  EFI_DCPMM_PBR_PROTOCOL *pNvmDimmPbrProtocol = NULL;
+  UINT32 PbrMode = PBR_NORMAL_MODE;
+
+  if (EFI_ERROR(OpenNvmDimmProtocol(gNvmDimmPbrProtocolGuid, (VOID **)&pNvmDimmPbrProtocol, NULL))) {
+    return TRUE;
+  }
+  if (EFI_ERROR(pNvmDimmPbrProtocol->PbrGetMode(&PbrMode))) {
+    return FALSE;
+  }
+  return PBR_NORMAL_MODE == PbrMode;
+}
+
+#ifdef OS_BUILD
+/**
+  Get the time range selected by the -history option, its number of hours up to now
+
+  @param[in] pCmd command from CLI
+  @param[out] pFrom start of the range in seconds since the epoch
+  @param[out] pTo end of the range in seconds since the epoch
+
+  @retval EFI_SUCCESS success
+  @retval EFI_INVALID_PARAMETER the value is not a number of hours from 1 to HISTORY_MAX_HOURS
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+EFI_STATUS
+GetHistoryRange(
+  IN     struct Command *pCmd,
+     OUT UINT64 *pFrom,
+     OUT UINT64 *pTo
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  CHAR16 *pOptionValue = NULL;
+  UINT64 Hours = 0;
+
+  if (NULL == pCmd || NULL == pFrom || NULL == pTo) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (NULL == (pOptionValue = getOptionValue(pCmd, HISTORY_OPTION))) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+  if (!GetU64FromString(pOptionValue, &Hours) || 0 == Hours || Hours > HISTORY_MAX_HOURS) {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_INCORRECT_VALUE_OPTION_HISTORY);
+    goto Finish;
+  }
+  *pTo = history_now();
+  *pFrom = (*pTo > Hours * HISTORY_SECONDS_PER_HOUR) ? *pTo - Hours * HISTORY_SECONDS_PER_HOUR : 0;
+
+Finish:
+  FREE_POOL_SAFE(pOptionValue);
+  return ReturnCode;
+}
+#endif
@@ -21,6 +21,18 @@ typedef struct _CMD_DISPLAY_OPTIONS {
   CHAR16 *pDisplayValues;
 }CMD_DISPLAY_OPTIONS;
 
+/**
+  The PMem modules of the system as identities, with the DIMM_INFO of a
+  module fetched only when a command asks for it, see GetDimmInfoSet
+**/
+typedef struct _DIMM_INFO_SET {
+  EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol;
+  UINT32 DimmCount;
+  DIMM_INFO_CORE *pDimmCores;               //!< Sorted by DimmID
+  DIMM_INFO **ppDimmInfos;                  //!< NULL until requested with GetDimmInfoFromSet
+  DIMM_INFO_CATEGORIES *pCategories;        //!< Categories populated in ppDimmInfos
+}DIMM_INFO_SET;
+
 /** common display options **/
 #define SOCKET_ID_STR               L"SocketID"
 #define DIE_ID_STR                  L"DieID"
@@ -82,6 +94,9 @@ typedef struct _CMD_DISPLAY_OPTIONS {
 #define CLI_ERR_OUT_OF_MEMORY                 L"Error: There is not enough memory to complete the requested operation."
 #define CLI_ERR_WRONG_FILE_PATH               L"Error: Wrong file path."
 #define CLI_ERR_WRONG_FILE_DATA               L"Error: Wrong data in the file."
+#define CLI_ERR_BATCH_FILE_OPEN               L"Error: Unable to open the batch file."
+#define CLI_ERR_BATCH_FILE_READ               L"Error: Unable to read line %d of the batch file."
+#define CLI_ERR_BATCH_STOPPED                 L"Error: Batch execution stopped at line %d."
 #define CLI_ERR_INTERNAL_ERROR                L"Error: Internal function error."
 #define CLI_ERR_PROMPT_INVALID                L"Error: Invalid data input."
 #define CLI_ERR_WRONG_DIAGNOSTIC_TARGETS      L"Error: Invalid diagnostics target, valid values are: " FORMAT_STR
@@ -103,6 +118,10 @@ typedef struct _CMD_DISPLAY_OPTIONS {
 #define CLI_ERR_INCORRECT_VALUE_OPTION_DISPLAY                L"Syntax Error: Incorrect value for option -d|-display."
 #define CLI_ERR_INCORRECT_VALUE_OPTION_UNITS                  L"Syntax Error: Incorrect value for option -units."
 #define CLI_ERR_INCORRECT_VALUE_OPTION_RECOVER                L"Syntax Error: Incorrect value for option -recover."
+#define CLI_ERR_INCORRECT_VALUE_OPTION_INTERVAL               L"Syntax Error: Incorrect value for option -interval."
+#define CLI_ERR_INCORRECT_VALUE_OPTION_COUNT                  L"Syntax Error: Incorrect value for option -count."
+#define CLI_ERR_INCORRECT_VALUE_OPTION_HISTORY                L"Syntax Error: Incorrect value for option -history."
+#define CLI_ERR_NO_HISTORY                                    L"Error: No history could be read. The history is recorded by ipmctld."
 #define CLI_ERR_INCORRECT_VALUE_TARGET_REGISTER               L"Syntax Error: Incorrect value for target -register."
 #define CLI_ERR_INCORRECT_VALUE_TARGET_DIMM                   L"Syntax Error: Incorrect value for target -dimm."
 #define CLI_ERR_INCORRECT_VALUE_TARGET_SOCKET                 L"Syntax Error: Incorrect value for target -socket."
@@ -135,6 +154,7 @@ typedef struct _CMD_DISPLAY_OPTIONS {
 #define CLI_ERR_INCORRECT_VALUE_PROPERTY_ENABLED_STATE        L"Syntax Error: Incorrect value for property AlarmThreshold."
 #define CLI_ERR_INCORRECT_VALUE_PROPERTY_NS_LABEL_VERSION     L"Syntax Error: Incorrect value for property NamespaceLabelVersion."
 #define CLI_ERR_INCORRECT_VALUE_PROPERTY_CONFIG               L"Syntax Error: Incorrect value for property Config."
+#define CLI_ERR_INCORRECT_VALUE_PROPERTY_COMPRESS             L"Syntax Error: Incorrect value for property Compress."
 #define CLI_ERR_INCORRECT_VALUE_TARGET_TOKEN_ID               L"Syntax Error: Incorrect value for target -tokens."
 #define CLI_ERROR_POISON_TYPE_WITHOUT_ADDRESS                 L"Syntax Error: Poison type property should be followed by poison address."
 #define CLI_ERROR_CLEAR_PROPERTY_NOT_COMBINED                 L"Syntax Error: Clear property should be given in combination with other error injection properties."
@@ -156,6 +176,7 @@ typedef struct _CMD_DISPLAY_OPTIONS {
 #define CLI_INFO_NO_REGIONS                                   L"There are no Regions defined in the system."
 #define CLI_INFO_NO_MANAGEABLE_DIMMS                          L"No manageable " PMEM_MODULES_STR L" in the system."
 #define CLI_INFO_NO_NON_FUNCTIONAL_DIMMS                      L"No non-functional " PMEM_MODULES_STR L" in the system."
+#define CLI_INFO_STARTUP_PROFILE                              L"Startup profile (" PMEM_MODULES_STR L": %d)\n"
 #define CLI_INFO_SHOW_REGION                                  L"Show Region"
 #define CLI_INFO_NO_NAMESPACES_DEFINED                        L"No Namespaces defined in the system."
 #define CLI_INFO_SHOW_NAMESPACE                               L"Show Namespace"
@@ -250,6 +271,8 @@ typedef struct _CMD_DISPLAY_OPTIONS {
 #define CLI_ERR_FAILED_DURING_DRIVER_UNINIT                   L"Driver binding stop failed."
 #define CLI_ERR_FAILED_DURING_CMD_EXECUTION                   L"Executing CMD during playback failed."
 #define CLI_ERR_UNKNOWN_MODE                                  L"Unknown PBR mode."
+#define CLI_ERR_UNKNOWN_PLAYBACK_ORDER                        L"Unknown PBR playback order."
+#define CLI_ERR_FAILED_TO_SET_PLAYBACK_ORDER                  L"Failed to configure the playback order to: " FORMAT_STR
 #define CLI_ERR_FAILED_TO_GET_SESSION_BUFFER                  L"Failed to get the current session buffer."
 #define CLI_ERR_FAILED_TO_DUMP_SESSION_TO_FILE                L"Failed to dump contents of session buffer to a file."
 #define CLI_ERR_FAILED_TO_GET_FILE_PATH                       L"Failed to get file path " FORMAT_EFI_STATUS
@@ -302,6 +325,118 @@ GetDimmList(
      OUT UINT32 *pDimmCount
   );
 
+/**
+  Retrieve a populated array and count of the identities of the DIMMs in the
+  system, for callers that need no DIMM_INFO category. The caller is
+  responsible for freeing the returned array
+
+  @param[in] pNvmDimmConfigProtocol A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[out] ppDimmCores A pointer to the dimm identity list found in NFIT.
+  @param[out] pDimmCount A pointer to the number of DIMMs found in NFIT.
+
+  @retval EFI_SUCCESS  the dimm list was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmCoreList(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     struct Command *pCmd,
+     OUT DIMM_INFO_CORE **ppDimmCores,
+     OUT UINT32 *pDimmCount
+  );
+
+/**
+  Copy the identity of a PMem module out of its DIMM_INFO
+
+  @param[in] pDimmInfo The PMem module info
+  @param[out] pDimmCore The PMem module identity
+**/
+VOID
+DimmInfoToCore(
+  IN     DIMM_INFO *pDimmInfo,
+     OUT DIMM_INFO_CORE *pDimmCore
+  );
+
+/**
+  Retrieve the PMem modules in the system as a set of identities, the
+  DIMM_INFO of a module is only fetched when GetDimmInfoFromSet asks for it.
+  The caller is responsible for freeing the set with FreeDimmInfoSet
+
+  @param[in] pNvmDimmConfigProtocol A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[out] ppDimmSet A pointer to the set of the PMem modules found in NFIT.
+
+  @retval EFI_SUCCESS  the set was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmInfoSet(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     struct Command *pCmd,
+     OUT DIMM_INFO_SET **ppDimmSet
+  );
+
+/**
+  Get the DIMM_INFO of a PMem module of a set, with at least the requested
+  categories populated. It is fetched on the first request and fetched again
+  when categories not populated yet are requested. The DIMM_INFO belongs to
+  the set.
+
+  @param[in] pDimmSet The set from GetDimmInfoSet
+  @param[in] Index Index of the PMem module in pDimmSet->pDimmCores
+  @param[in] DimmInfoCategories Categories that will be populated in the DIMM_INFO struct.
+  @param[out] ppDimmInfo A pointer to the DIMM_INFO of the PMem module.
+
+  @retval EFI_SUCCESS  the DIMM_INFO was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL or Index is out of range
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  Other return codes from GetDimm
+**/
+EFI_STATUS
+GetDimmInfoFromSet(
+  IN     DIMM_INFO_SET *pDimmSet,
+  IN     UINT32 Index,
+  IN     DIMM_INFO_CATEGORIES DimmInfoCategories,
+     OUT DIMM_INFO **ppDimmInfo
+  );
+
+/**
+  Get the DIMM_INFO of the PMem module of a set with the given DimmID, see
+  GetDimmInfoFromSet
+
+  @param[in] pDimmSet The set from GetDimmInfoSet
+  @param[in] DimmId SMBIOS DimmID of the PMem module
+  @param[in] DimmInfoCategories Categories that will be populated in the DIMM_INFO struct.
+  @param[out] ppDimmInfo A pointer to the DIMM_INFO of the PMem module.
+
+  @retval EFI_SUCCESS  the DIMM_INFO was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL
+  @retval EFI_NOT_FOUND the PMem module is not in the set
+  Other return codes from GetDimmInfoFromSet
+**/
+EFI_STATUS
+GetDimmInfoFromSetById(
+  IN     DIMM_INFO_SET *pDimmSet,
+  IN     UINT16 DimmId,
+  IN     DIMM_INFO_CATEGORIES DimmInfoCategories,
+     OUT DIMM_INFO **ppDimmInfo
+  );
+
+/**
+  Free a set from GetDimmInfoSet together with the DIMM_INFO fetched into it
+
+  @param[in, out] ppDimmSet A pointer to the set, set to NULL
+**/
+VOID
+FreeDimmInfoSet(
+  IN OUT DIMM_INFO_SET **ppDimmSet
+  );
+
 /**
   Retrieve a populated array and count of all DCPMMs (functional and non-functional)
   in the system. The caller is responsible for freeing the returned array
@@ -387,6 +522,32 @@ GetDimmIdsFromString(
      OUT UINT32 *pDimmIdsCount
  );
 
+/**
+  Parses the dimm target string like GetDimmIdsFromString, matching the
+  targets against the dimm identities
+
+  @param[in] pCmd A pointer to a COMMAND struct.  Used to obtain the Printer context.
+  @param[in] pDimmString The dimm target string to parse.
+  @param[in] pDimmCores The dimm identities found in NFIT.
+  @param[in] DimmCount Size of the pDimmCores array.
+  @param[out] ppDimmIds Pointer to the array allocated and filled with the SMBIOS DimmIDs.
+  @param[out] pDimmIdsCount Size of the pDimmIds array.
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_INVALID_PARAMETER the format of string is not proper
+  @retval EFI_NOT_FOUND dimm not found
+**/
+EFI_STATUS
+GetDimmIdsFromCoreList(
+  IN     struct Command *pCmd,
+  IN     CHAR16 *pDimmString,
+  IN     DIMM_INFO_CORE *pDimmCores,
+  IN     UINT32 DimmCount,
+     OUT UINT16 **ppDimmIds,
+     OUT UINT32 *pDimmIdsCount
+ );
+
 /**
 Parses the dimm target string (which can contain DimmIDs as SMBIOS type-17 handles and/or DimmUIDs),
 and returns a DimmUid.
@@ -672,6 +833,59 @@ DumpToFile (
   IN     BOOLEAN Overwrite
   );
 
+#define DUMP_FILE_BUFFER_SIZE         (64 * 1024)     //!< bytes buffered by a DUMP_FILE between writes
+
+/**
+  File opened for streamed dumping, writes are buffered
+**/
+typedef struct _DUMP_FILE {
+  VOID *pFile;                                      //!< FILE in the OS build, EFI_FILE_HANDLE otherwise
+  UINT8 *pBuffer;                                   //!< DUMP_FILE_BUFFER_SIZE bytes
+  UINT64 BufferUsed;                                //!< bytes of pBuffer not yet written
+} DUMP_FILE;
+
+/**
+  Create or truncate a file for streamed dumping
+
+  @param[in] pDumpUserPath - destination file path
+  @param[out] ppDumpFile - the opened file, to be closed with CloseDumpFile
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+OpenDumpFile (
+  IN     CHAR16* pDumpUserPath,
+     OUT DUMP_FILE** ppDumpFile
+  );
+
+/**
+  Append data to a file opened with OpenDumpFile
+
+  @param[in] pDumpFile - the file to write to
+  @param[in] BufferSize - data size to write
+  @param[in] pBuffer - pointer to buffer
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+WriteDumpFile (
+  IN     DUMP_FILE* pDumpFile,
+  IN     UINT64 BufferSize,
+  IN     VOID* pBuffer
+  );
+
+/**
+  Write out buffered data and close a file opened with OpenDumpFile
+
+  @param[in] pDumpFile - the file to close, may be NULL
+
+  @retval - Appropriate EFI return code
+**/
+EFI_STATUS
+CloseDumpFile (
+  IN     DUMP_FILE* pDumpFile
+  );
+
 /**
   Prints supported or recommended appdirect settings
 
@@ -815,6 +1029,27 @@ AllDimmsInListAreManageable(
   IN     UINT32 DimmsToCheckCount
  );
 
+/**
+  Check if all dimms in the specified pDimmIds list are manageable.
+  This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimms The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
+  @retval TRUE if all Dimms in pDimmsListToCheck array are manageable
+  @retval FALSE if at least one DIMM is not manageable
+**/
+BOOLEAN
+AllDimmCoresInListAreManageable(
+  IN     DIMM_INFO_CORE *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+ );
+
 /**
   Check if all dimms in the specified pDimmIds list are in supported
   config. This helper method assumes all the dimms in the list exist.
@@ -836,6 +1071,27 @@ AllDimmsInListInSupportedConfig(
   IN     UINT32 DimmsToCheckCount
 );
 
+/**
+  Check if all dimms in the specified pDimmIds list are in supported
+  config. This helper method assumes all the dimms in the list exist.
+  This helper method also assumes the parameters are non-null.
+
+  @param[in] pAllDimms The dimm identities found in NFIT
+  @param[in] AllDimmCount Size of the pAllDimms array
+  @param[in] pDimmsListToCheck Pointer to the array of DimmIDs to check
+  @param[in] DimmsToCheckCount Size of the pDimmsListToCheck array
+
+  @retval TRUE if all Dimms in pDimmsListToCheck array are in supported config
+  @retval FALSE if at least one DIMM is not in supported config
+**/
+BOOLEAN
+AllDimmCoresInListInSupportedConfig(
+  IN     DIMM_INFO_CORE *pAllDimms,
+  IN     UINT32 AllDimmCount,
+  IN     UINT16 *pDimmsListToCheck,
+  IN     UINT32 DimmsToCheckCount
+);
+
 /**
   Check if all dimms in the specified pDimmIds list have master passphrase enabled.
   This helper method assumes all the dimms in the list exist.
@@ -973,6 +1229,28 @@ GetDimmHandleByPid(
      OUT UINT32 *pDimmIndex
   );
 
+/**
+  Gets the DIMM handle corresponding to Dimm PID and also the index
+
+  @param[in] DimmId - DIMM ID
+  @param[in] pDimms - List of DIMM identities
+  @param[in] DimmsNum - Number of DIMMs
+  @param[out] pDimmHandle - The Dimm Handle corresponding to the DIMM ID
+  @param[out] pDimmIndex - The Index of the found DIMM
+
+  @retval - EFI_STATUS Success
+  @retval - EFI_INVALID_PARAMETER Invalid parameter
+  @retval - EFI_NOT_FOUND Dimm not found
+**/
+EFI_STATUS
+GetDimmHandleByCorePid(
+  IN     UINT16 DimmId,
+  IN     DIMM_INFO_CORE *pDimms,
+  IN     UINT32 DimmsNum,
+     OUT UINT32 *pDimmHandle,
+     OUT UINT32 *pDimmIndex
+  );
+
 /**
 Retrieve the User Cli Display Preferences CMD line arguments.
 
@@ -1075,4 +1353,38 @@ EFI_STATUS AddElement(
 BOOLEAN IsDefaultMasterPassphraseRestricted(
   IN DIMM_INFO DimmInfo);
 
+/**
+  Check whether FW commands to different PMem modules may be sent concurrently
+
+  Recording and playback sessions need the commands in order.
+
+  @retval TRUE if the session is in normal mode
+**/
+BOOLEAN
+IsConcurrentFetchAllowed(
+  );
+
+#ifdef OS_BUILD
+#define HISTORY_SECONDS_PER_HOUR    3600
+#define HISTORY_MAX_HOURS           (10 * 366 * 24)   //!< Longest -history accepted, ten years
+
+/**
+  Get the time range selected by the -history option, its number of hours up to now
+
+  @param[in] pCmd command from CLI
+  @param[out] pFrom start of the range in seconds since the epoch
+  @param[out] pTo end of the range in seconds since the epoch
+
+  @retval EFI_SUCCESS success
+  @retval EFI_INVALID_PARAMETER the value is not a number of hours from 1 to HISTORY_MAX_HOURS
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+EFI_STATUS
+GetHistoryRange(
+  IN     struct Command *pCmd,
+     OUT UINT64 *pFrom,
+     OUT UINT64 *pTo
+  );
+#endif
+
 #endif /** _COMMON_H_ **/
@@ -464,7 +464,7 @@ CreateGoal(
     goto Finish;
   }
 
-  if (containsOption(pCmd, FORCE_OPTION) || containsOption(pCmd, FORCE_OPTION_SHORT) || XML == pPrinterCtx->FormatType) {
+  if (containsOption(pCmd, FORCE_OPTION) || containsOption(pCmd, FORCE_OPTION_SHORT) || TEXT != pPrinterCtx->FormatType) {
     Force = TRUE;
   }
 
@@ -67,14 +67,13 @@ DeleteDimm(
   COMMAND_STATUS *pCommandStatus = NULL;
   BOOLEAN Force = FALSE;
   BOOLEAN Confirmation = FALSE;
-  DIMM_INFO *pDimms = NULL;
-  UINT32 DimmCount = 0;
+  DIMM_INFO_SET *pDimmSet = NULL;
+  DIMM_INFO *pDimmInfo = NULL;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
   PRINT_CONTEXT *pPrinterCtx = NULL;
   BOOLEAN MasterOptionSpecified = FALSE;
   BOOLEAN DefaultOptionSpecified = FALSE;
   UINT16 SecurityOperation = SECURITY_OPERATION_UNDEFINED;
-  DIMM_INFO DimmInfo;
 
   NVDIMM_ENTRY();
 
@@ -95,8 +94,8 @@ DeleteDimm(
     goto Finish;
   }
 
- // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_SECURITY, &pDimms, &DimmCount);
+ // Populate the set of DIMM identities, the security state is only fetched for the targeted DIMMs
+  ReturnCode = GetDimmInfoSet(pNvmDimmConfigProtocol, pCmd, &pDimmSet);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -115,12 +114,12 @@ DeleteDimm(
   // check targets
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pTargetValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pTargetValue, pDimmSet->pDimmCores, pDimmSet->DimmCount, &pDimmIds, &DimmIdsCount);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_DBG("Failed on GetDimmIdsFromString");
       goto Finish;
     }
-    if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
+    if (!AllDimmCoresInListAreManageable(pDimmSet->pDimmCores, pDimmSet->DimmCount, pDimmIds, DimmIdsCount)){
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_UNMANAGEABLE_DIMM);
       goto Finish;
@@ -150,8 +149,8 @@ DeleteDimm(
   /** Check if default option is supported on selected modules **/
   if (DefaultOptionSpecified) {
     for (Index = 0; Index < DimmIdsCount; Index++) {
-      CHECK_RESULT((pNvmDimmConfigProtocol->GetDimm(pNvmDimmConfigProtocol, pDimmIds[Index], DIMM_INFO_CATEGORY_NONE, &DimmInfo)), Finish);
-      if (IsDefaultMasterPassphraseRestricted(DimmInfo)) {
+      CHECK_RESULT(GetDimmInfoFromSetById(pDimmSet, pDimmIds[Index], DIMM_INFO_CATEGORY_SECURITY, &pDimmInfo), Finish);
+      if (IsDefaultMasterPassphraseRestricted(*pDimmInfo)) {
         ReturnCode = EFI_INVALID_PARAMETER;
         PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_DEFAULT_NOT_SUPPORTED_FIRMWARE_REV);
         goto Finish;
@@ -165,11 +164,14 @@ DeleteDimm(
   }
 
   if (MasterOptionSpecified) {
-    // FALSE = Master passphrase must be enabled for FIS >= 3.2 PMem modules as well
-    if (!AllDimmsInListHaveMasterPassphraseEnabled(pDimms, DimmCount, pDimmIds, DimmIdsCount, FALSE)) {
-      ReturnCode = EFI_INVALID_PARAMETER;
-      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_MASTER_PASSPHRASE_NOT_ENABLED);
-      goto Finish;
+    for (Index = 0; Index < DimmIdsCount; Index++) {
+      CHECK_RESULT(GetDimmInfoFromSetById(pDimmSet, pDimmIds[Index], DIMM_INFO_CATEGORY_SECURITY, &pDimmInfo), Finish);
+      // FALSE = Master passphrase must be enabled for FIS >= 3.2 PMem modules as well
+      if (!AllDimmsInListHaveMasterPassphraseEnabled(pDimmInfo, 1, &pDimmIds[Index], 1, FALSE)) {
+        ReturnCode = EFI_INVALID_PARAMETER;
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_MASTER_PASSPHRASE_NOT_ENABLED);
+        goto Finish;
+      }
     }
   }
 
@@ -286,11 +288,11 @@ DeleteDimm(
   /** Ask for prompt when Force option is not given **/
   if (!Force) {
     for (Index = 0; Index < DimmIdsCount; Index++) {
-      ReturnCode = GetDimmHandleByPid(pDimmIds[Index], pDimms, DimmCount, &DimmHandle, &DimmIndex);
+      ReturnCode = GetDimmHandleByCorePid(pDimmIds[Index], pDimmSet->pDimmCores, pDimmSet->DimmCount, &DimmHandle, &DimmIndex);
       if (EFI_ERROR(ReturnCode)) {
         goto Finish;
       }
-      ReturnCode = GetPreferredDimmIdAsString(DimmHandle, pDimms[DimmIndex].DimmUid,
+      ReturnCode = GetPreferredDimmIdAsString(DimmHandle, pDimmSet->pDimmCores[DimmIndex].DimmUid,
           DimmStr, MAX_DIMM_UID_LENGTH);
       if (EFI_ERROR(ReturnCode)) {
         goto Finish;
@@ -328,7 +330,7 @@ Finish:
   FREE_POOL_SAFE(pLoadFilePath);
   FREE_POOL_SAFE(pLoadUserPath);
   FREE_POOL_SAFE(pDimmIds);
-  FREE_POOL_SAFE(pDimms);
+  FreeDimmInfoSet(&pDimmSet);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
 }
@@ -64,7 +64,7 @@ DeleteGoal(
   UINT32 DimmIdsCount = 0;
   UINT16 *pSocketIds = NULL;
   UINT32 SocketIdsCount = 0;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT32 DimmCount = 0;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   NVDIMM_ENTRY();
@@ -86,8 +86,8 @@ DeleteGoal(
     goto Finish;
   }
 
-  // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  // Populate the list of DIMM identities, no DIMM_INFO category is needed
+  ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimms, &DimmCount);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -97,12 +97,12 @@ DeleteGoal(
 
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pTargetValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_DBG("Failed on GetDimmIdsFromString");
       goto Finish;
     }
-    if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
+    if (!AllDimmCoresInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_UNMANAGEABLE_DIMM);
       goto Finish;
@@ -11,6 +11,32 @@
 #include "Debug.h"
 #include "Convert.h"
 #include "Nlog.h"
+#ifdef OS_BUILD
+#include "os.h"
+#endif
+
+/** Number of PMem modules whose logs are fetched ahead of the one being decoded **/
+#define DUMP_DEBUG_FETCH_WINDOW               8
+/** Maximum in-flight debug log transfers sharing the memory bus of one socket **/
+#define DUMP_DEBUG_MAX_TRANSFERS_PER_SOCKET   2
+
+/** Debug log fetched from one source of a PMem module **/
+typedef struct _DUMP_DEBUG_LOG {
+  EFI_STATUS ReturnCode;              //!< Result of GetFwDebugLog
+  COMMAND_STATUS *pCommandStatus;     //!< Detailed status, NULL if it could not be allocated
+  VOID *pBuffer;                      //!< Raw debug log, owned by the job
+  UINT64 BufferSize;                  //!< Size of the raw debug log in bytes
+} DUMP_DEBUG_LOG;
+
+/** Fetch of every debug log source of one PMem module **/
+typedef struct _DUMP_DEBUG_JOB {
+  EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol; //!< Config protocol used for the transfers
+  UINT32 DimmIndex;                                   //!< Index of the PMem module in the DIMM_INFO list
+  UINT16 DimmID;                                      //!< PMem module to fetch from
+  VOID *pSocketGate;                                  //!< Limits transfers on the socket, NULL if unlimited
+  VOID *pThread;                                      //!< Fetching thread, NULL when fetched inline
+  DUMP_DEBUG_LOG Logs[NUM_FW_DEBUG_LOG_SOURCES];      //!< Result per debug log source
+} DUMP_DEBUG_JOB;
 
  /**
    Get FW debug log syntax definition
@@ -55,6 +81,111 @@ RegisterDumpDebugCommand(
   return ReturnCode;
 }
 
+/**
+  Fetch every debug log source of one PMem module
+
+  Transfers are admitted through the socket gate so that no more than
+  DUMP_DEBUG_MAX_TRANSFERS_PER_SOCKET large payloads share a memory bus.
+
+  @param[in,out] pArg DUMP_DEBUG_JOB to fill in
+**/
+STATIC
+VOID
+FetchDimmDebugLogs(
+  IN OUT VOID *pArg
+  )
+{
+  DUMP_DEBUG_JOB *pJob = (DUMP_DEBUG_JOB *)pArg;
+  DUMP_DEBUG_LOG *pLog = NULL;
+  UINT8 IndexSource = 0;
+
+  for (IndexSource = 0; IndexSource < NUM_FW_DEBUG_LOG_SOURCES; IndexSource++) {
+    pLog = &pJob->Logs[IndexSource];
+
+    pLog->ReturnCode = InitializeCommandStatus(&pLog->pCommandStatus);
+    if (EFI_ERROR(pLog->ReturnCode)) {
+      continue;
+    }
+
+#ifdef OS_BUILD
+    if (pJob->pSocketGate != NULL) {
+      os_sem_wait(pJob->pSocketGate);
+    }
+#endif
+    pLog->ReturnCode = pJob->pNvmDimmConfigProtocol->GetFwDebugLog(pJob->pNvmDimmConfigProtocol,
+        pJob->DimmID, IndexSource, 0, &pLog->pBuffer, &pLog->BufferSize, pLog->pCommandStatus);
+#ifdef OS_BUILD
+    if (pJob->pSocketGate != NULL) {
+      os_sem_post(pJob->pSocketGate);
+    }
+#endif
+  }
+}
+
+/**
+  Start fetching the debug logs of one PMem module
+
+  Falls back to fetching inline when the fetch cannot run on its own thread.
+
+  @param[in,out] pJob Job to start
+  @param[in] Concurrent Whether the fetch may run on its own thread
+**/
+STATIC
+VOID
+StartDumpDebugJob(
+  IN OUT DUMP_DEBUG_JOB *pJob,
+  IN     BOOLEAN Concurrent
+  )
+{
+#ifdef OS_BUILD
+  if (Concurrent) {
+    pJob->pThread = os_thread_create(FetchDimmDebugLogs, pJob);
+    if (pJob->pThread != NULL) {
+      return;
+    }
+  }
+#endif
+  FetchDimmDebugLogs(pJob);
+}
+
+/**
+  Wait until the debug logs of one PMem module are fetched
+
+  @param[in,out] pJob Job started by StartDumpDebugJob
+**/
+STATIC
+VOID
+WaitDumpDebugJob(
+  IN OUT DUMP_DEBUG_JOB *pJob
+  )
+{
+#ifdef OS_BUILD
+  if (pJob->pThread != NULL) {
+    os_thread_join(pJob->pThread);
+    pJob->pThread = NULL;
+  }
+#endif
+}
+
+/**
+  Release the debug logs and statuses held by a job
+
+  @param[in,out] pJob Job to release
+**/
+STATIC
+VOID
+FreeDumpDebugJob(
+  IN OUT DUMP_DEBUG_JOB *pJob
+  )
+{
+  UINT8 IndexSource = 0;
+
+  for (IndexSource = 0; IndexSource < NUM_FW_DEBUG_LOG_SOURCES; IndexSource++) {
+    FREE_POOL_SAFE(pJob->Logs[IndexSource].pBuffer);
+    FreeCommandStatus(&pJob->Logs[IndexSource].pCommandStatus);
+  }
+}
+
 /**
  Dump debug log command
 
@@ -71,7 +202,6 @@ DumpDebugCommand(
 )
 {
   EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol = NULL;
-  COMMAND_STATUS *pCommandStatus = NULL;
   EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
   UINT32 DimmCount = 0;
   UINT16 *pDimmIds = NULL;
@@ -80,21 +210,26 @@ DumpDebugCommand(
   CHAR16 *pDumpUserPath = NULL;
   DIMM_INFO *pDimms = NULL;
   UINT32 Index = 0;
-  nlog_dict_entry * next;
   BOOLEAN dictExists = FALSE;
   CHAR16 *pDictUserPath = NULL;
   CHAR16 *raw_file_name = NULL;
   CHAR16 *decoded_file_name = NULL;
-  nlog_dict_entry* dict_head = NULL;
+  nlog_dict* dict = NULL;
   UINT32 dict_version;
   UINT64 dict_entries;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   CHAR16 *SourceNames[NUM_FW_DEBUG_LOG_SOURCES] = {L"media", L"sram", L"spi"};
   UINT8 IndexSource = 0;
-  VOID *RawLogBuffer = NULL;
-  UINT64 RawLogBufferSizeBytes = 0;
   INT8 SuccessesPerDimm[MAX_DIMMS];
-  UINT32 Reserved = 0;
+  DUMP_DEBUG_JOB *pJobs = NULL;
+  DUMP_DEBUG_LOG *pLog = NULL;
+  UINT32 JobCount = 0;
+  UINT32 JobIndex = 0;
+  BOOLEAN Concurrent = FALSE;
+#ifdef OS_BUILD
+  OS_SEMAPHORE *pSocketGates[MAX_SOCKETS];
+  UINT16 SocketId = 0;
+#endif
 
   NVDIMM_ENTRY();
 
@@ -102,6 +237,9 @@ DumpDebugCommand(
   // -1 indicates a dimm that ends up to not be specified
   // so we don't care about its number of successes
   SetMem(SuccessesPerDimm, MAX_DIMMS * sizeof(SuccessesPerDimm[0]), (UINT8)(-1));
+#ifdef OS_BUILD
+  ZeroMem(pSocketGates, sizeof(pSocketGates));
+#endif
 
   if (pCmd == NULL) {
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_NO_COMMAND);
@@ -180,8 +318,8 @@ DumpDebugCommand(
   // Only load the dictionary once
   if (dictExists)
   {
-    dict_head = load_nlog_dict(pCmd, pDictUserPath, &dict_version, &dict_entries);
-    if (!dict_head)
+    dict = load_nlog_dict(pCmd, pDictUserPath, &dict_version, &dict_entries);
+    if (!dict)
     {
       ReturnCode = EFI_LOAD_ERROR;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to load the dictionary file " FORMAT_STR L"\n", pDictUserPath);
@@ -191,6 +329,13 @@ DumpDebugCommand(
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Loaded %d dictionary entries\n", dict_entries);
   }
 
+  pJobs = AllocateZeroPool(sizeof(*pJobs) * DimmCount);
+  if (pJobs == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+
   for (Index = 0; Index < DimmCount; Index++) {
     // Initialize to -1 so we can ignore dimms that aren't specified
     SuccessesPerDimm[Index] = -1;
@@ -200,6 +345,41 @@ DumpDebugCommand(
       continue;
     }
 
+    pJobs[JobCount].pNvmDimmConfigProtocol = pNvmDimmConfigProtocol;
+    pJobs[JobCount].DimmIndex = Index;
+    pJobs[JobCount].DimmID = pDimms[Index].DimmID;
+    JobCount++;
+  }
+
+  // Fetch the logs of the next modules while the current one is decoded,
+  // letting a bounded number of transfers share each socket
+  Concurrent = JobCount > 1 && IsConcurrentFetchAllowed();
+#ifdef OS_BUILD
+  for (Index = 0; Concurrent && Index < JobCount; Index++) {
+    SocketId = pDimms[pJobs[Index].DimmIndex].SocketId % MAX_SOCKETS;
+    if (pSocketGates[SocketId] == NULL) {
+      pSocketGates[SocketId] = os_sem_create(DUMP_DEBUG_MAX_TRANSFERS_PER_SOCKET);
+      if (pSocketGates[SocketId] == NULL) {
+        NVDIMM_WARN("Failed to create the socket transfer gate, fetching sequentially");
+        Concurrent = FALSE;
+      }
+    }
+    pJobs[Index].pSocketGate = pSocketGates[SocketId];
+  }
+#endif
+
+  for (Index = 0; Index < JobCount && Index < DUMP_DEBUG_FETCH_WINDOW; Index++) {
+    StartDumpDebugJob(&pJobs[Index], Concurrent);
+  }
+
+  for (JobIndex = 0; JobIndex < JobCount; JobIndex++) {
+    WaitDumpDebugJob(&pJobs[JobIndex]);
+    if (JobIndex + DUMP_DEBUG_FETCH_WINDOW < JobCount) {
+      StartDumpDebugJob(&pJobs[JobIndex + DUMP_DEBUG_FETCH_WINDOW], Concurrent);
+    }
+
+    Index = pJobs[JobIndex].DimmIndex;
+
     // Initialize the successes of the specified dimm to 0
     // Used to calculate if we return an error or not to CLI
     SuccessesPerDimm[Index] = 0;
@@ -207,12 +387,11 @@ DumpDebugCommand(
     // For easier reading
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"\n");
 
-    // Collect logs from every debug log source on each dimm
+    // Report logs from every debug log source on each dimm
     for (IndexSource = 0; IndexSource < NUM_FW_DEBUG_LOG_SOURCES; IndexSource++) {
+      pLog = &pJobs[JobIndex].Logs[IndexSource];
 
-      // Re-initialize pCommandStatus messages for each dimm and debug log source
-      ReturnCode = InitializeCommandStatus(&pCommandStatus);
-      if (EFI_ERROR(ReturnCode)) {
+      if (pLog->pCommandStatus == NULL) {
         ReturnCode = EFI_DEVICE_ERROR;
         PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_INTERNAL_ERROR);
         goto FreeAndContinue;
@@ -229,10 +408,7 @@ DumpDebugCommand(
         goto FreeAndContinue;
       }
 
-
-      ReturnCode = pNvmDimmConfigProtocol->GetFwDebugLog(pNvmDimmConfigProtocol,
-          pDimms[Index].DimmID, IndexSource, Reserved, &RawLogBuffer, &RawLogBufferSizeBytes, pCommandStatus);
-
+      ReturnCode = pLog->ReturnCode;
       if (EFI_ERROR(ReturnCode)) {
         if (ReturnCode == EFI_NOT_STARTED) {
           PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
@@ -240,23 +416,23 @@ DumpDebugCommand(
             SourceNames[IndexSource]);
           goto FreeAndContinue;
         }
-        if (pCommandStatus->GeneralStatus != NVM_SUCCESS) {
-          ReturnCode = MatchCliReturnCode(pCommandStatus->GeneralStatus);
+        if (pLog->pCommandStatus->GeneralStatus != NVM_SUCCESS) {
+          ReturnCode = MatchCliReturnCode(pLog->pCommandStatus->GeneralStatus);
           PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
             L"Unexpected error in retrieving " FORMAT_STR L" FW debug logs\n",
             SourceNames[IndexSource]);
-          PRINTER_SET_COMMAND_STATUS(pPrinterCtx, ReturnCode, CLI_INFO_DUMP_DEBUG_LOG, L" ", pCommandStatus);
+          PRINTER_SET_COMMAND_STATUS(pPrinterCtx, ReturnCode, CLI_INFO_DUMP_DEBUG_LOG, L" ", pLog->pCommandStatus);
           goto FreeAndContinue;
         }
       }
 
       /** Get FW debug log  **/
-      ReturnCode = DumpToFile(raw_file_name, RawLogBufferSizeBytes, RawLogBuffer, TRUE);
+      ReturnCode = DumpToFile(raw_file_name, pLog->BufferSize, pLog->pBuffer, TRUE);
       if (EFI_ERROR(ReturnCode)) {
         if (ReturnCode == EFI_VOLUME_FULL) {
           PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
               L"Not enough space to save file " FORMAT_STR L" with size %lu MiB\n",
-              raw_file_name, BYTES_TO_MIB(RawLogBufferSizeBytes));
+              raw_file_name, BYTES_TO_MIB(pLog->BufferSize));
         }
         else {
           PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
@@ -271,8 +447,8 @@ DumpDebugCommand(
 
       /** Decode FW debug log **/
       if (dictExists) {
-        decode_nlog_binary(pCmd, decoded_file_name, RawLogBuffer, RawLogBufferSizeBytes,
-            dict_version, dict_head);
+        decode_nlog_binary(pCmd, decoded_file_name, pLog->pBuffer, pLog->BufferSize,
+            dict_version, dict);
       }
 
       SuccessesPerDimm[Index]++;
@@ -281,8 +457,9 @@ FreeAndContinue:
 
       FREE_POOL_SAFE(raw_file_name);
       FREE_POOL_SAFE(decoded_file_name);
-      FREE_POOL_SAFE(RawLogBuffer);
-      FreeCommandStatus(&pCommandStatus);
+      // Release each log as soon as it is written so only the fetch window stays resident
+      FREE_POOL_SAFE(pLog->pBuffer);
+      FreeCommandStatus(&pLog->pCommandStatus);
     }
   }
   // Return success if any of 3 logs were retrieved on every specified dimm
@@ -298,16 +475,20 @@ FreeAndContinue:
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
 
-  while (dict_head)
-  {
-    next = dict_head->next;
-    FREE_POOL_SAFE(dict_head->LogLevel);
-    FREE_POOL_SAFE(dict_head->LogString);
-    FREE_POOL_SAFE(dict_head->FileName);
-    FREE_POOL_SAFE(dict_head);
-    dict_head = next;
+  free_nlog_dict(dict);
+
+  if (pJobs != NULL) {
+    for (JobIndex = 0; JobIndex < JobCount; JobIndex++) {
+      FreeDumpDebugJob(&pJobs[JobIndex]);
+    }
   }
+#ifdef OS_BUILD
+  for (SocketId = 0; SocketId < MAX_SOCKETS; SocketId++) {
+    os_sem_delete(pSocketGates[SocketId]);
+  }
+#endif
 
+  FREE_POOL_SAFE(pJobs);
   FREE_POOL_SAFE(pDimms);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDictUserPath);
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <Library/BaseMemoryLib.h>
+#include "DumpDictionaryCommand.h"
+#include "NvmDimmCli.h"
+#include "NvmInterface.h"
+#include "Debug.h"
+#include "Nlog.h"
+
+ /**
+   Compile nlog dictionary syntax definition
+ **/
+struct Command DumpDictionaryCommandSyntax =
+{
+  DUMP_VERB,                                                        //!< verb
+  {                                                                 //!< options
+    {L"", DESTINATION_OPTION, L"", DESTINATION_OPTION_HELP, L"Destination of the precompiled dictionary", FALSE, ValueRequired },
+#ifdef OS_BUILD
+    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT,FALSE, ValueRequired },
+#endif
+    { L"", DICTIONARY_OPTION, L"", DICTIONARY_OPTION_HELP, L"Dictionary to compile", TRUE, ValueRequired }
+  },
+  {
+    {DICTIONARY_TARGET, L"", L"", TRUE, ValueEmpty}
+  },
+  {{L"", L"", L"", FALSE, ValueOptional}},                          //!< properties
+  L"Compile a firmware debug log dictionary.",                      //!< help
+  DumpDictionaryCommand, TRUE                                       //!< run function
+};
+
+/**
+  Register syntax of dump -dictionary
+**/
+EFI_STATUS
+RegisterDumpDictionaryCommand(
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  NVDIMM_ENTRY();
+
+  ReturnCode = RegisterCommand(&DumpDictionaryCommandSyntax);
+
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+ Compile nlog dictionary command
+
+ @param[in] pCmd command from CLI
+
+ @retval EFI_SUCCESS on success
+ @retval EFI_INVALID_PARAMETER pCmd is NULL or invalid command line parameters
+ @retval EFI_OUT_OF_RESOURCES memory allocation failure
+ @retval EFI_LOAD_ERROR the dictionary could not be loaded
+**/
+EFI_STATUS
+DumpDictionaryCommand(
+  IN    struct Command *pCmd
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  CHAR16 *pDumpUserPath = NULL;
+  CHAR16 *pDictUserPath = NULL;
+  BOOLEAN dictExists = FALSE;
+  nlog_dict* dict = NULL;
+  UINT32 dict_version = 0;
+  UINT64 dict_entries = 0;
+  VOID *pImage = NULL;
+  UINT64 ImageSize = 0;
+  PRINT_CONTEXT *pPrinterCtx = NULL;
+
+  NVDIMM_ENTRY();
+
+  if (pCmd == NULL) {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_NO_COMMAND);
+    goto Finish;
+  }
+
+  pPrinterCtx = pCmd->pPrintCtx;
+
+  // Check -destination option
+  if (containsOption(pCmd, DESTINATION_OPTION)) {
+    pDumpUserPath = getOptionValue(pCmd, DESTINATION_OPTION);
+    if (pDumpUserPath == NULL) {
+      ReturnCode = EFI_OUT_OF_RESOURCES;
+      NVDIMM_ERR("Could not get -destination value. Out of memory");
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_OUT_OF_MEMORY);
+      goto Finish;
+    }
+  }
+  else {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_PARSER_DETAILED_ERR_OPTION_REQUIRED, DESTINATION_OPTION);
+    goto Finish;
+  }
+
+  pDictUserPath = getOptionValue(pCmd, DICTIONARY_OPTION);
+  if (pDictUserPath == NULL) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    NVDIMM_ERR("Could not get -dict value. Out of memory");
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+
+  if (EFI_ERROR(FileExists(pDictUserPath, &dictExists))) {
+    ReturnCode = EFI_END_OF_FILE;
+    NVDIMM_ERR("Could not check for existence of the dictionary file");
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_INTERNAL_ERROR);
+    goto Finish;
+  }
+
+  if (!dictExists) {
+    ReturnCode = EFI_LOAD_ERROR;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"The passed dictionary file doesn't exist\n");
+    goto Finish;
+  }
+
+  dict = load_nlog_dict(pCmd, pDictUserPath, &dict_version, &dict_entries);
+  if (!dict) {
+    ReturnCode = EFI_LOAD_ERROR;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to load the dictionary file " FORMAT_STR L"\n", pDictUserPath);
+    goto Finish;
+  }
+
+  ReturnCode = compile_nlog_dict(dict, dict_version, &pImage, &ImageSize);
+  if (EFI_ERROR(ReturnCode)) {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to compile the dictionary file " FORMAT_STR L"\n", pDictUserPath);
+    goto Finish;
+  }
+
+  ReturnCode = DumpToFile(pDumpUserPath, ImageSize, pImage, TRUE);
+  if (EFI_ERROR(ReturnCode)) {
+    if (ReturnCode == EFI_VOLUME_FULL) {
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
+          L"Not enough space to save file " FORMAT_STR L" with size %lu MiB\n",
+          pDumpUserPath, BYTES_TO_MIB(ImageSize));
+    }
+    else {
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode,
+          L"Failed to dump the precompiled dictionary to file " FORMAT_STR L"\n", pDumpUserPath);
+    }
+    goto Finish;
+  }
+
+  PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Compiled %d dictionary entries to file " FORMAT_STR L"\n",
+      dict_entries, pDumpUserPath);
+
+Finish:
+  PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
+
+  free_nlog_dict(dict);
+
+  FREE_POOL_SAFE(pImage);
+  FREE_POOL_SAFE(pDictUserPath);
+  FREE_POOL_SAFE(pDumpUserPath);
+
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _DUMP_DICTIONARY_COMMAND_H_
+#define _DUMP_DICTIONARY_COMMAND_H_
+
+#include <Uefi.h>
+#include "NvmInterface.h"
+#include "Common.h"
+
+/**
+  Register dump -dictionary command
+
+  @retval EFI_SUCCESS success
+  @retval EFI_ABORTED registering failure
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+EFI_STATUS
+RegisterDumpDictionaryCommand(
+  );
+
+/**
+  Compile an nlog dictionary into its precompiled binary form
+
+  @param[in] pCmd command from CLI
+
+  @retval EFI_SUCCESS on success
+  @retval EFI_INVALID_PARAMETER pCmd is NULL or invalid command line parameters
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_LOAD_ERROR the dictionary could not be loaded
+**/
+EFI_STATUS
+DumpDictionaryCommand(
+  IN    struct Command *pCmd
+  );
+
+#endif
@@ -36,7 +36,9 @@ struct Command DumpSessionCommand =
   {                                                                               //!< targets
     {SESSION_TARGET, L"", L"", TRUE, ValueEmpty}
   },
-  {{L"", L"", L"", FALSE, ValueOptional}},                                        //!< properties
+  {                                                                               //!< properties
+    {COMPRESS_PROPERTY, L"", PROPERTY_VALUE_0 L"|" PROPERTY_VALUE_1, FALSE, ValueRequired}
+  },
   L"Dump the current recording (PBR) session buffer to a file.",                   //!< help
   DumpSession,
   TRUE
@@ -59,6 +61,8 @@ DumpSession(
   VOID *pBuffer = NULL;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   PbrHeader *pHeader = NULL;
+  CHAR16 *pPropertyValue = NULL;
+  BOOLEAN Compress = TRUE;
 
   NVDIMM_ENTRY();
 
@@ -97,8 +101,25 @@ DumpSession(
     goto Finish;
   }
 
+  //partitions are block compressed unless Compress=0 is requested
+  if (!EFI_ERROR(ContainsProperty(pCmd, COMPRESS_PROPERTY))) {
+    ReturnCode = GetPropertyValue(pCmd, COMPRESS_PROPERTY, &pPropertyValue);
+    if (EFI_ERROR(ReturnCode)) {
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_INTERNAL_ERROR);
+      goto Finish;
+    }
+    if (StrICmp(pPropertyValue, PROPERTY_VALUE_0) == 0) {
+      Compress = FALSE;
+    }
+    else if (StrICmp(pPropertyValue, PROPERTY_VALUE_1) != 0) {
+      ReturnCode = EFI_INVALID_PARAMETER;
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_INCORRECT_VALUE_PROPERTY_COMPRESS);
+      goto Finish;
+    }
+  }
+
   //get the contents of the pbr session buffer
-  ReturnCode = pNvmDimmPbrProtocol->PbrGetSession(&pBuffer, &BufferSz);
+  ReturnCode = pNvmDimmPbrProtocol->PbrGetSession(Compress, &pBuffer, &BufferSz);
   if (EFI_ERROR(ReturnCode) || pBuffer == NULL) {
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_FAILED_TO_GET_SESSION_BUFFER);
     goto Finish;
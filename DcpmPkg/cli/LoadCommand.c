@@ -117,7 +117,7 @@ Load(
 #endif
 
   if ((NULL != pCmd) && (NULL != pCmd->pPrintCtx)) {
-    if (pCmd->pPrintCtx->FormatType == XML) {
+    if (pCmd->pPrintCtx->FormatType != TEXT) {
       PRINTER_CONFIGURE_BUFFERING(pCmd->pPrintCtx, ON);
     }
     else {
@@ -77,8 +77,9 @@ LoadGoal(
   BOOLEAN Force = FALSE;
   COMMAND_INPUT ShowGoalCmdInput;
   COMMAND ShowGoalCmd;
-  DIMM_INFO *pDimms = NULL;
-  UINT32 DimmCount = 0;
+  DIMM_INFO_SET *pDimmSet = NULL;
+  DIMM_INFO *pDimmInfo = NULL;
+  UINT32 Index = 0;
   UINT16 UnitsOption = DISPLAY_SIZE_UNIT_UNKNOWN;
   UINT16 UnitsToDisplay = FixedPcdGet16(PcdDcpmmCliDefaultCapacityUnit);
   CHAR16 *pUnitsStr = NULL;
@@ -112,8 +113,8 @@ LoadGoal(
     goto Finish;
   }
 
-  // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_SECURITY, &pDimms, &DimmCount);
+  // Populate the set of DIMM identities, the security state is only fetched before prompting
+  ReturnCode = GetDimmInfoSet(pNvmDimmConfigProtocol, pCmd, &pDimmSet);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
       PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -140,7 +141,7 @@ LoadGoal(
     UnitsToDisplay = UnitsOption;
   }
 
-  if (containsOption(pCmd, FORCE_OPTION) || containsOption(pCmd, FORCE_OPTION_SHORT) || XML == pPrinterCtx->FormatType) {
+  if (containsOption(pCmd, FORCE_OPTION) || containsOption(pCmd, FORCE_OPTION_SHORT) || TEXT != pPrinterCtx->FormatType) {
     Force = TRUE;
   }
 
@@ -184,17 +185,17 @@ LoadGoal(
   // Check targets
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pTargetValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pTargetValue, pDimmSet->pDimmCores, pDimmSet->DimmCount, &pDimmIds, &DimmIdsCount);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_DBG("Failed on GetDimmIdsFromString");
       goto Finish;
     }
-    if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
+    if (!AllDimmCoresInListAreManageable(pDimmSet->pDimmCores, pDimmSet->DimmCount, pDimmIds, DimmIdsCount)){
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_UNMANAGEABLE_DIMM);
       goto Finish;
     }
-    if (!AllDimmsInListInSupportedConfig(pDimms, DimmCount, pDimmIds, DimmIdsCount)) {
+    if (!AllDimmCoresInListInSupportedConfig(pDimmSet->pDimmCores, pDimmSet->DimmCount, pDimmIds, DimmIdsCount)) {
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_POPULATION_VIOLATION);
       goto Finish;
@@ -230,9 +231,19 @@ LoadGoal(
   if (!Force) {
     PRINTER_PROMPT_MSG(pPrinterCtx, ReturnCode, CLI_INFO_LOAD_GOAL_CONFIRM_PROMPT, pLoadFilePath);
 
-    ReturnCode = AreRequestedDimmsSecurityUnlocked(pDimms, DimmCount, pDimmIds, DimmIdsCount, &isDimmUnlocked);
-    if (EFI_ERROR(ReturnCode)) {
-      goto Finish;
+    // Check the targeted DIMMs, or all of them when none are targeted
+    for (Index = 0; Index < pDimmSet->DimmCount && !isDimmUnlocked; Index++) {
+      if (DimmIdsCount > 0 && !ContainUint(pDimmIds, DimmIdsCount, pDimmSet->pDimmCores[Index].DimmID)) {
+        continue;
+      }
+      ReturnCode = GetDimmInfoFromSet(pDimmSet, Index, DIMM_INFO_CATEGORY_SECURITY, &pDimmInfo);
+      if (EFI_ERROR(ReturnCode)) {
+        goto Finish;
+      }
+      ReturnCode = AreRequestedDimmsSecurityUnlocked(pDimmInfo, 1, NULL, 0, &isDimmUnlocked);
+      if (EFI_ERROR(ReturnCode)) {
+        goto Finish;
+      }
     }
 
     // send warning if security unlocked for target dimms
@@ -318,7 +329,7 @@ FinishSkipPrinterProcess:
   FREE_POOL_SAFE(pFileString);
   FREE_POOL_SAFE(pSocketIds);
   FREE_POOL_SAFE(pDimmIds);
-  FREE_POOL_SAFE(pDimms);
+  FreeDimmInfoSet(&pDimmSet);
   FREE_POOL_SAFE(pLoadUserPath);
   FREE_POOL_SAFE(pUnitsStr);
   FREE_POOL_SAFE(pShowGoalOutputArgs);
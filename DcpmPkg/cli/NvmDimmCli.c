@@ -45,6 +45,7 @@
 #include "ShowCelCommand.h"
 #include "ShowTopologyCommand.h"
 #include "DumpDebugCommand.h"
+#include "DumpDictionaryCommand.h"
 #include "ShowMemoryResourcesCommand.h"
 #include "ShowSystemCapabilitiesCommand.h"
 #include "ShowRegisterCommand.h"
@@ -65,6 +66,7 @@
 #include "LoadSessionCommand.h"
 #ifdef OS_BUILD
 #include "os_efi_shell_parameters_protocol.h"
+#include <StartupProfile.h>
 #include <Protocol/Driver/DriverBinding.h>
 #else
 #include <Protocol/DriverBinding.h>
@@ -120,6 +122,10 @@ static EFI_STATUS GetPbrMode(UINT32 *Mode);
 static EFI_STATUS SetPbrTag(CHAR16 *pName, CHAR16 *pDescription);
 static EFI_STATUS ResetPbrSession(UINT32 TagId);
 static EFI_STATUS SetDefaultProtocolAndPayloadSizeOptions();
+#ifdef OS_BUILD
+static BOOLEAN IsReadOnlyCommand(struct Command *pCmd);
+static VOID PrintStartupProfile();
+#endif
 #ifndef OS_BUILD
 #ifndef MDEPKG_NDEBUG
 static EFI_STATUS GetDriverDebugPrintVerbosity(UINT32 *pErrorLevel);
@@ -343,6 +349,10 @@ UefiMain(
   UINT32 NextId = 0;
 #ifdef OS_BUILD
   BOOLEAN IsVersionCommand = FALSE;
+  BOOLEAN BatchMode = FALSE;
+  BOOLEAN DriverBound = FALSE;
+  BOOLEAN DriverStale = FALSE;
+  UINT32 BatchLine = 0;
 #else
   SHELL_FILE_HANDLE StdIn = NULL;
 #ifndef MDEPKG_NDEBUG
@@ -410,16 +420,21 @@ UefiMain(
     }
   }
 
+#ifdef OS_BUILD
+  BatchMode = is_batch_mode_requested();
+#endif
+
   if (Argc == 1) {
 #ifndef OS_BUILD
     /* Verify input was not redirected from a file */
     if (ShellGetFileInfo(StdIn) == NULL) {
+#else
+    /* Verify the commands are not read from a batch file */
+    if (!BatchMode) {
 #endif
       HelpRequested = TRUE;
       FullHelpRequested = TRUE;
-#ifndef OS_BUILD
     }
-#endif
   }
 
 #ifndef OS_BUILD
@@ -530,8 +545,44 @@ UefiMain(
       goto Finish;
     }
   }
+#ifdef OS_BUILD
+  if (BatchMode) {
+    Rc = batch_input_open();
+    if (EFI_ERROR(Rc)) {
+      Print(FORMAT_STR_NL, CLI_ERR_BATCH_FILE_OPEN);
+      goto FinishAfterRegCmds;
+    }
+  }
+#endif
   while (MoreInput) {
     Input.TokenCount = 0;
+#ifdef OS_BUILD
+    if (BatchMode) {
+      /* commands are read from the batch file, one per line */
+      FREE_POOL_SAFE(pLine);
+      Rc = batch_input_read_line(&pLine);
+      if (EFI_END_OF_FILE == Rc) {
+        Rc = EFI_SUCCESS;
+        break;
+      }
+      BatchLine++;
+      if (EFI_ERROR(Rc)) {
+        Print(CLI_ERR_BATCH_FILE_READ FORMAT_NL, BatchLine);
+        goto FinishAfterRegCmds;
+      }
+      if (StrLen(pLine) == 0) {
+        /* blank or comment line, go to next pLine */
+        continue;
+      }
+
+      FillCommandInput(pLine, &Input);
+      if (Input.ppTokens == NULL) {
+        Print(FORMAT_STR_NL, CLI_ERR_OUT_OF_MEMORY);
+        Rc = EFI_OUT_OF_RESOURCES;
+        goto FinishAfterRegCmds;
+      }
+    } else
+#endif
 #ifndef OS_BUILD
     /* user entered a command on the command pLine */
     if (ShellGetFileInfo(StdIn) == NULL) {
@@ -638,7 +689,19 @@ UefiMain(
         IsVersionCommand = (StrnCmp(Command.verb, VERSION_VERB, VERB_LEN) == 0);
 
         if (!Command.ExcludeDriverBinding && !g_fast_path) {
-          Rc = NvmDimmDriverDriverBindingStart(&gNvmDimmDriverDriverBinding, FakeBindHandle, NULL);
+          /**
+            The driver stays bound across the commands of a batch, it is only
+            re-initialized when a previous command may have changed its state.
+          **/
+          if (DriverBound && DriverStale) {
+            NvmDimmDriverDriverBindingStop(&gNvmDimmDriverDriverBinding, FakeBindHandle, 0, NULL);
+            DriverBound = FALSE;
+          }
+          if (!DriverBound) {
+            Rc = NvmDimmDriverDriverBindingStart(&gNvmDimmDriverDriverBinding, FakeBindHandle, NULL);
+            DriverBound = TRUE;
+            DriverStale = EFI_ERROR(Rc);
+          }
           if (EFI_ERROR(Rc) && !IsVersionCommand) {
             NVDIMM_ERR("Issue with driver initialization");
             Print(GetSingleNvmStatusCodeMessage(gNvmDimmCliHiiHandle,GuessNvmStatusFromReturnCode(Rc)));
@@ -653,18 +716,29 @@ UefiMain(
           Rc = ExecuteCmd(&Command);
         }
 #ifdef OS_BUILD
-        if (!Command.ExcludeDriverBinding && !g_fast_path) {
-          NvmDimmDriverDriverBindingStop(&gNvmDimmDriverDriverBinding, FakeBindHandle, 0, NULL);
+        if (!IsReadOnlyCommand(&Command)) {
+          DriverStale = TRUE;
+        }
+        if (is_verbose_debug_print_enabled() && !Command.ExcludeDriverBinding) {
+          PrintStartupProfile();
         }
 #endif
       }
       if (EFI_ERROR(Rc)) {
         MoreInput = FALSE; /* stop on failures */
+#ifdef OS_BUILD
+        if (BatchMode) {
+          Print(CLI_ERR_BATCH_STOPPED FORMAT_NL, BatchLine);
+        }
+#endif
       }
     }
     else { /* syntax error */
 #ifdef OS_BUILD
       PrintErrorMsg(getSyntaxError(), is_ESX_output_requested());
+      if (BatchMode) {
+        Print(CLI_ERR_BATCH_STOPPED FORMAT_NL, BatchLine);
+      }
 #else
       PrintErrorMsg(getSyntaxError(), FALSE);
 #endif
@@ -678,6 +752,14 @@ UefiMain(
   } /* end while more input */
 FinishAfterRegCmds:
   /* clean up */
+#ifdef OS_BUILD
+  if (DriverBound) {
+    NvmDimmDriverDriverBindingStop(&gNvmDimmDriverDriverBinding, FakeBindHandle, 0, NULL);
+  }
+  if (BatchMode) {
+    batch_input_close();
+  }
+#endif
   FreeCommands();
 
 Finish:
@@ -909,6 +991,11 @@ RegisterCommands(
     goto done;
   }
 
+  Rc = RegisterDumpDictionaryCommand();
+  if (EFI_ERROR(Rc)) {
+    goto done;
+  }
+
   Rc = RegisterShowAcpiCommand();
   if (EFI_ERROR(Rc)) {
     goto done;
@@ -1275,7 +1362,7 @@ EFI_STATUS showVersion(struct Command *pCmd)
   PRINTER_ENABLE_LIST_TABLE_FORMAT(pPrinterCtx);
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pDimms);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
@@ -1364,3 +1451,47 @@ Finish:
 }
 #endif //MDEPKG_NDEBUG
 #endif //OS_BUILD
+
+#ifdef OS_BUILD
+/*
+ * Check if a command leaves the driver state untouched, so the driver
+ * doesn't need to be re-initialized before the next command of a batch
+ */
+BOOLEAN IsReadOnlyCommand(struct Command *pCmd) {
+  if (pCmd == NULL) {
+    return FALSE;
+  }
+
+  if (StrICmp(pCmd->verb, SHOW_VERB) == 0 ||
+      StrICmp(pCmd->verb, HELP_VERB) == 0 ||
+      StrICmp(pCmd->verb, VERSION_VERB) == 0 ||
+      StrICmp(pCmd->verb, DUMP_VERB) == 0) {
+    return TRUE;
+  }
+
+  return StrICmp(pCmd->verb, START_VERB) == 0 && ContainTarget(pCmd, DIAGNOSTIC_TARGET);
+}
+
+/*
+ * Print where bringing up the library and the driver spent its time since the
+ * last print, so each command of a batch shows what it paid for itself
+ */
+VOID PrintStartupProfile() {
+  STARTUP_PROFILE Profile;
+  STARTUP_PHASE_TIME *pPhase = NULL;
+  UINT32 Index = 0;
+
+  StartupProfileGet(&Profile);
+  StartupProfileReset();
+  Print(CLI_INFO_STARTUP_PROFILE, Profile.DimmCount);
+  Print(FORMAT_SHOW_STARTUP_HEADER, L"Phase", L"Runs", L"Time(ms)");
+  for (Index = 0; Index < StartupPhaseMax; Index++) {
+    pPhase = &Profile.Phases[Index];
+    if (0 == pPhase->Runs) {
+      continue;
+    }
+    Print(FORMAT_SHOW_STARTUP_PHASE, GetStartupPhaseName((STARTUP_PHASE)Index), pPhase->Runs,
+      pPhase->TimeUs / 1000, pPhase->TimeUs % 1000);
+  }
+}
+#endif //OS_BUILD
@@ -31,7 +31,7 @@ struct Command ShowCelCommandSyntax =
     {L"", LARGE_PAYLOAD_OPTION, L"", L"", HELP_LPAYLOAD_DETAILS_TEXT, FALSE, ValueEmpty},
     {L"", SMALL_PAYLOAD_OPTION, L"", L"", HELP_SPAYLOAD_DETAILS_TEXT, FALSE, ValueEmpty},
 #ifdef OS_BUILD
-    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT,FALSE, ValueRequired }
+    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_STREAM_HELP, HELP_OPTIONS_DETAILS_TEXT,FALSE, ValueRequired }
 #else
     {L"", L"", L"", L"", L"",FALSE, ValueOptional}
 #endif
@@ -92,6 +92,7 @@ PRINTER_DATA_SET_ATTRIBS ShowCmdEffectLogDataSetAttribs =
 
 /**
   Create the string from Command Effect Bits.
+  The string is built for every log entry, so it is allocated from the arena.
 
   param[in] Value is the value to be printed.
   param[in] SensorType - type of sensor
@@ -106,71 +107,71 @@ GetCommandEffectDescriptionStr(
 
   // Return immediately if opcode not supported
   if (0 == CelEntry.EffectName.AsUint32) {
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, OPCODE_NOT_SUPPORTED);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, OPCODE_NOT_SUPPORTED);
     return pReturnBuffer;
   }
 
   if (1 == CelEntry.EffectName.Separated.NoEffects) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, NO_EFFECTS);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, NO_EFFECTS);
   }
 
   if (1 == CelEntry.EffectName.Separated.SecurityStateChange) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, SECURITY_STATE_CHANGE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, SECURITY_STATE_CHANGE);
   }
 
   if (1 == CelEntry.EffectName.Separated.DimmConfigChangeAfterReboot) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, DIMM_CONFIGURATION_CHANGE_AFTER_REBOOT);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, DIMM_CONFIGURATION_CHANGE_AFTER_REBOOT);
   }
 
   if (1 == CelEntry.EffectName.Separated.ImmediateDimmConfigChange) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_CONFIGURATION_CHANGE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_CONFIGURATION_CHANGE);
   }
 
   if (1 == CelEntry.EffectName.Separated.QuiesceAllIo) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, QUIESCE_ALL_IO);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, QUIESCE_ALL_IO);
   }
 
   if (1 == CelEntry.EffectName.Separated.ImmediateDimmDataChange) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_DATA_CHANGE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_DATA_CHANGE);
   }
 
   if (1 == CelEntry.EffectName.Separated.TestMode) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, TEST_MODE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, TEST_MODE);
   }
 
   if (1 == CelEntry.EffectName.Separated.DebugMode) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, DEBUG_MODE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, DEBUG_MODE);
   }
 
   if (1 == CelEntry.EffectName.Separated.ImmediateDimmPolicyChange) {
     if (NULL != pReturnBuffer) {
-      pReturnBuffer = CatSPrintClean(pReturnBuffer, L", ");
+      pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, L", ");
     }
-    pReturnBuffer = CatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_POLICY_CHANGE);
+    pReturnBuffer = ArenaCatSPrintClean(pReturnBuffer, IMMEDIATE_DIMM_POLICY_CHANGE);
   }
 
   return pReturnBuffer;
@@ -213,7 +214,7 @@ ShowCelCommand(
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol = NULL;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT32 DimmCount = 0;
   CHAR16 *pDimmsValue = NULL;
   UINT16 *pDimmIds = NULL;
@@ -246,8 +247,8 @@ ShowCelCommand(
     goto Finish;
   }
 
-  // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  // Populate the list of DIMM identities, no DIMM_INFO category is needed
+  ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimms, &DimmCount);
   if (EFI_ERROR(ReturnCode)) {
     if (ReturnCode == EFI_NOT_FOUND) {
       PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -258,17 +259,17 @@ ShowCelCommand(
   // check targets
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pDimmsValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pDimmsValue, pDimms, DimmCount, &pDimmIds, &DimmIdsNum);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pDimmsValue, pDimms, DimmCount, &pDimmIds, &DimmIdsNum);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_WARN("Target value is not a valid Dimm ID");
       goto Finish;
     }
-    if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsNum)) {
+    if (!AllDimmCoresInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsNum)) {
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_UNMANAGEABLE_DIMM);
       goto Finish;
     }
-    if (!AllDimmsInListInSupportedConfig(pDimms, DimmCount, pDimmIds, DimmIdsNum)) {
+    if (!AllDimmCoresInListInSupportedConfig(pDimms, DimmCount, pDimmIds, DimmIdsNum)) {
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_POPULATION_VIOLATION);
       goto Finish;
@@ -290,6 +291,9 @@ ShowCelCommand(
     }
   }
 
+  //Switch text output type to display as a table
+  PRINTER_ENABLE_TEXT_TABLE_FORMAT(pPrinterCtx);
+
   // Traverse each DIMM
   for (DimmIndex = 0; DimmIndex < DimmCount; DimmIndex++) {
     if (!ContainUint(pDimmIds, DimmIdsNum, pDimms[DimmIndex].DimmID)) {
@@ -309,7 +313,7 @@ ShowCelCommand(
     }
 
     // Retrieve DimmHandle and DimmIdIndex for given DimmId
-    ReturnCode = GetDimmHandleByPid(pDimms[DimmIndex].DimmID, pDimms, DimmCount, &DimmHandle, &DimmIdIndex);
+    ReturnCode = GetDimmHandleByCorePid(pDimms[DimmIndex].DimmID, pDimms, DimmCount, &DimmHandle, &DimmIdIndex);
     if (EFI_ERROR(ReturnCode)) {
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_INTERNAL_ERROR);
       goto Finish;
@@ -330,19 +334,19 @@ ShowCelCommand(
       PRINTER_SET_KEY_VAL_UINT8(pPrinterCtx, pPath, SUBOPCODE_STR, (UINT8)pCelEntry[CelEntryIndex].Opcode.Separated.SubOpcode, HEX);
       pCommandEffectDescription = GetCommandEffectDescriptionStr(pCelEntry[CelEntryIndex]);
       PRINTER_APPEND_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, CE_DESCRIPTION_STR, pCommandEffectDescription);
-      FREE_POOL_SAFE(pCommandEffectDescription);
+      ARENA_FREE_POOL_SAFE(pCommandEffectDescription);
     }
     FREE_POOL_SAFE(pCelEntry);
+    //In stream mode print this DIMM's entries before retrieving the next log
+    PRINTER_STREAM_FLUSH(pPrinterCtx, DS_ROOT_PATH, &ShowCmdEffectLogDataSetAttribs);
   }
 
-  //Switch text output type to display as a table
-  PRINTER_ENABLE_TEXT_TABLE_FORMAT(pPrinterCtx);
   //Specify table attributes
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_ROOT_PATH, &ShowCmdEffectLogDataSetAttribs);
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
-  FREE_POOL_SAFE(pCommandEffectDescription);
+  ARENA_FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pCommandEffectDescription);
   FREE_POOL_SAFE(pDimms);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pCelEntry);
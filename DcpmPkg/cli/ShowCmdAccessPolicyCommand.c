@@ -152,7 +152,7 @@ ShowCmdAccessPolicy(
   UINT32 DimmHandle = 0;
   UINT32 DimmIdIndex = 0;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
-  CHAR16 *RestrictionStr = NULL;
+  CONST CHAR16 *RestrictionStr = NULL;
   UINT32 CapCount = 0;
 
   NVDIMM_ENTRY();
@@ -266,38 +266,37 @@ ShowCmdAccessPolicy(
       PRINTER_SET_KEY_VAL_UINT8(pPrinterCtx, pPath, SUBOPCODE_STR, pCapEntry->SubOpcode, HEX);
       switch (pCapEntry->Restriction) {
       case COMMAND_ACCESS_POLICY_RESTRICTION_NONE:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_NONE), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_NONE));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_BIOSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_BIOS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_BIOS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_SMBUSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_SMBUS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_SMBUS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_BIOSSMBUSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_BIOS_SMBUS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_BIOS_SMBUS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_MGMTONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_MGMTBIOSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_BIOS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_BIOS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_MGMTSMBUSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_SMBUS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_SMBUS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_MGMTBIOSSMBUSONLY:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_BIOS_SMBUS_ONLY), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_MGMT_BIOS_SMBUS_ONLY));
         break;
       case COMMAND_ACCESS_POLICY_RESTRICTION_UNSUPPORTED:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_UNSUPPORTED), NULL);;
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_UNSUPPORTED));
         break;
       default:
-        RestrictionStr = HiiGetString(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_INVALID), NULL);
+        RestrictionStr = HiiGetStringConst(gNvmDimmCliHiiHandle, STRING_TOKEN(STR_DCPMM_RESTRICTION_INVALID));
         break;
       }
       PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, RESTRICTION_STR, RestrictionStr);
-      FREE_POOL_SAFE(RestrictionStr);
     }
   }
 
@@ -307,8 +306,7 @@ ShowCmdAccessPolicy(
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_ROOT_PATH, &ShowCmdAccessPolicyDataSetAttribs);
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(RestrictionStr);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDimms);
   FREE_POOL_SAFE(pCapEntries);
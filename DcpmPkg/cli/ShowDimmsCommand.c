@@ -427,11 +427,11 @@ ShowDimms(
   UINT32 DimmIdsNum = 0;
   CHAR16 *pSocketsValue = NULL;
   CHAR16 *pSecurityStr = NULL;
-  CHAR16 *pSVNDowngradeStr = NULL;
-  CHAR16 *pSecureErasePolicyStr = NULL;
-  CHAR16 *pS3ResumeStr = NULL;
-  CHAR16 *pFwActivateStr = NULL;
-  CHAR16 *pHealthStr = NULL;
+  CONST CHAR16 *pSVNDowngradeStr = NULL;
+  CONST CHAR16 *pSecureErasePolicyStr = NULL;
+  CONST CHAR16 *pS3ResumeStr = NULL;
+  CONST CHAR16 *pFwActivateStr = NULL;
+  CONST CHAR16 *pHealthStr = NULL;
   CHAR16 *pHealthStateReasonStr = NULL;
   CHAR16 *pManageabilityStr = NULL;
   CHAR16 *pPopulationViolationStr = NULL;
@@ -450,6 +450,7 @@ ShowDimms(
   BOOLEAN ContainSocketTarget = FALSE;
   COMMAND_STATUS *pCommandStatus = NULL;
   CHAR16 *pAttributeStr = NULL;
+  CONST CHAR16 *pConstAttributeStr = NULL;
   CHAR16 *pCapacityStr = NULL;
   CHAR16 *pDimmErrStr = NULL;
   CHAR16 *pOriginalNullVal = NULL;
@@ -683,7 +684,6 @@ ShowDimms(
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, DIMM_ID_STR, DimmStr);
       }
       FREE_POOL_SAFE(pDimmErrStr);
-      FREE_POOL_SAFE(pHealthStr);
       FREE_POOL_SAFE(pSecurityStr);
       FREE_POOL_SAFE(pCapacityStr);
     }
@@ -750,55 +750,50 @@ ShowDimms(
       /** SVN Downgrade Opt-In **/
       if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, SVN_DOWNGRADE_OPT_IN_STR))) {
         if (pDimms[DimmIndex].ErrorMask & DIMM_INFO_ERROR_SVN_DOWNGRADE) {
-          pSVNDowngradeStr = CatSPrint(NULL, FORMAT_STR, UNKNOWN_ATTRIB_VAL);
+          pSVNDowngradeStr = UNKNOWN_ATTRIB_VAL;
         }
         else {
           pSVNDowngradeStr = SVNDowngradeOptInToString(gNvmDimmCliHiiHandle, pDimms[DimmIndex].SVNDowngradeOptIn);
         }
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, SVN_DOWNGRADE_OPT_IN_STR, pSVNDowngradeStr);
-        FREE_POOL_SAFE(pSVNDowngradeStr);
       }
 
       /** Secure Erase Policy Opt-In **/
       if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, SEP_OPT_IN_STR))) {
         if (pDimms[DimmIndex].ErrorMask & DIMM_INFO_ERROR_SECURE_ERASE_POLICY) {
-          pSecureErasePolicyStr = CatSPrint(NULL, FORMAT_STR, UNKNOWN_ATTRIB_VAL);
+          pSecureErasePolicyStr = UNKNOWN_ATTRIB_VAL;
         }
         else {
           pSecureErasePolicyStr = SecureErasePolicyOptInToString(gNvmDimmCliHiiHandle, pDimms[DimmIndex].SecureErasePolicyOptIn);
         }
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, SEP_OPT_IN_STR, pSecureErasePolicyStr);
-        FREE_POOL_SAFE(pSecureErasePolicyStr);
       }
 
       /** S3 Resume Opt-In **/
       if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, S3_RESUME_OPT_IN_STR))) {
         if (pDimms[DimmIndex].ErrorMask & DIMM_INFO_ERROR_S3RESUME) {
-          pS3ResumeStr = CatSPrint(NULL, FORMAT_STR, UNKNOWN_ATTRIB_VAL);
+          pS3ResumeStr = UNKNOWN_ATTRIB_VAL;
         } else {
           pS3ResumeStr = S3ResumeOptInToString(gNvmDimmCliHiiHandle, pDimms[DimmIndex].S3ResumeOptIn);
         }
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, S3_RESUME_OPT_IN_STR, pS3ResumeStr);
-        FREE_POOL_SAFE(pS3ResumeStr);
       }
 
       /** FW Activate Opt-In **/
       if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, FW_ACTIVATE_OPT_IN_STR))) {
         if (pDimms[DimmIndex].ErrorMask & DIMM_INFO_ERROR_FW_ACTIVATE) {
-          pFwActivateStr = CatSPrint(NULL, FORMAT_STR, UNKNOWN_ATTRIB_VAL);
+          pFwActivateStr = UNKNOWN_ATTRIB_VAL;
         }
         else {
           pFwActivateStr = FwActivateOptInToString(gNvmDimmCliHiiHandle, pDimms[DimmIndex].FwActivateOptIn);
         }
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, FW_ACTIVATE_OPT_IN_STR, pFwActivateStr);
-        FREE_POOL_SAFE(pFwActivateStr);
       }
       /** Health State **/
       if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, HEALTH_STR))) {
         pHealthStr = HealthToString(gNvmDimmCliHiiHandle, pDimms[DimmIndex].HealthState);
 
         PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, HEALTH_STR, pHealthStr);
-        FREE_POOL_SAFE(pHealthStr);
       }
 
       /** Health State Reason**/
@@ -1351,21 +1346,19 @@ ShowDimms(
 
         /** ARSStatus **/
         if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, ARS_STATUS_STR))) {
-          pAttributeStr = LongOpStatusToStr(gNvmDimmCliHiiHandle, pDimms[DimmIndex].ARSStatus);
-          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, ARS_STATUS_STR, pAttributeStr);
-          FREE_POOL_SAFE(pAttributeStr);
+          pConstAttributeStr = LongOpStatusToStr(gNvmDimmCliHiiHandle, pDimms[DimmIndex].ARSStatus);
+          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, ARS_STATUS_STR, pConstAttributeStr);
         }
 
         /** OverwriteDimmStatus **/
         if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, OVERWRITE_STATUS_STR))) {
           if (pDimms[DimmIndex].ErrorMask & DIMM_INFO_ERROR_OVERWRITE_STATUS) {
-            pAttributeStr = CatSPrint(NULL, FORMAT_STR, UNKNOWN_ATTRIB_VAL);
+            pConstAttributeStr = UNKNOWN_ATTRIB_VAL;
           }
           else {
-            pAttributeStr = LongOpStatusToStr(gNvmDimmCliHiiHandle, pDimms[DimmIndex].OverwriteDimmStatus);
+            pConstAttributeStr = LongOpStatusToStr(gNvmDimmCliHiiHandle, pDimms[DimmIndex].OverwriteDimmStatus);
           }
-          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, OVERWRITE_STATUS_STR, pAttributeStr);
-          FREE_POOL_SAFE(pAttributeStr);
+          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, OVERWRITE_STATUS_STR, pConstAttributeStr);
         }
 
         /** AitDramEnabled **/
@@ -1561,11 +1554,10 @@ ShowDimms(
         if (ShowAll || (pDispOptions->DisplayOptionSet && ContainsValue(pDispOptions->pDisplayValues, FIPS_MODE_STATUS_STR))) {
           // Get FIPS status
           ReturnCode = pNvmDimmConfigProtocol->GetFIPSMode(pNvmDimmConfigProtocol, pDimms[DimmIndex].DimmID, &FIPSMode, pCommandStatus);
-          pStr = ConvertFIPSModeToString(gNvmDimmCliHiiHandle, FIPSMode, pDimms[DimmIndex].FwVer, ReturnCode);
+          pConstAttributeStr = ConvertFIPSModeToString(gNvmDimmCliHiiHandle, FIPSMode, pDimms[DimmIndex].FwVer, ReturnCode);
           // Overwrite ReturnCode since we don't care if it failed
           ReturnCode = EFI_SUCCESS;
-          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, FIPS_MODE_STATUS_STR, pStr);
-          FREE_POOL_SAFE(pStr);
+          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, FIPS_MODE_STATUS_STR, pConstAttributeStr);
         }
       }
       else {
@@ -1595,7 +1587,7 @@ Finish:
   gNullValuesEncounteredForDisplay = 0;
   gNullValueToDisplay = pOriginalNullVal;
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_CMD_DISPLAY_OPTIONS_SAFE(pDispOptions);
   FREE_POOL_SAFE(pDimms);
   FREE_POOL_SAFE(pAllDimms);
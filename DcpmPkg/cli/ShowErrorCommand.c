@@ -26,7 +26,7 @@ struct Command ShowErrorCommandSyntax =
     {L"", LARGE_PAYLOAD_OPTION, L"", L"", HELP_LPAYLOAD_DETAILS_TEXT, FALSE, ValueEmpty},
     {L"", SMALL_PAYLOAD_OPTION, L"", L"", HELP_SPAYLOAD_DETAILS_TEXT, FALSE, ValueEmpty},
 #ifdef OS_BUILD
-    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT,FALSE, ValueRequired }
+    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_STREAM_HELP, HELP_OPTIONS_DETAILS_TEXT,FALSE, ValueRequired }
 #else
     {L"", L"", L"", L"", L"",FALSE, ValueOptional}
 #endif
@@ -707,6 +707,9 @@ ShowErrorCommand(
         }
       }
     }
+    //In stream mode print this DIMM's errors before retrieving the next log
+    PRINTER_STREAM_FLUSH(pPrinterCtx, DS_ROOT_PATH,
+      ThermalError ? &ShowThermalErrorDataSetAttribs : &ShowMediaErrorDataSetAttribs);
   }
 
   if (ThermalError == FALSE) {
@@ -718,7 +721,7 @@ ShowErrorCommand(
 Finish:
   PRINTER_SET_COMMAND_STATUS(pCmd->pPrintCtx, ReturnCode, L"Show Error", CLI_INFO_ON, pCommandStatus);
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FreeCommandStatus(&pCommandStatus);
   FREE_CMD_DISPLAY_OPTIONS_SAFE(pDispOptions);
   FREE_POOL_SAFE(pDimmIds);
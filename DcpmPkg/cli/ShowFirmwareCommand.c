@@ -151,9 +151,9 @@ ShowFirmware(
   UINT16 *pDimmIds = NULL;
   UINT32 DimmIdsCount = 0;
   UINT32 Index = 0;
-  CHAR16 *pFwUpdateStatusString = NULL;
-  CHAR16 *pQuiesceRequiredString = NULL;
-  CHAR16 *pStagedFwActivatableString = NULL;
+  CONST CHAR16 *pFwUpdateStatusString = NULL;
+  CONST CHAR16 *pQuiesceRequiredString = NULL;
+  CONST CHAR16 *pStagedFwActivatableString = NULL;
   DIMM_INFO *pDimms = NULL;
   UINT32 DimmCount = 0;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
@@ -274,7 +274,6 @@ ShowFirmware(
         goto Finish;
       }
       PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, STAGED_FW_ACTIVATABLE_STR, pStagedFwActivatableString);
-      FREE_POOL_SAFE(pStagedFwActivatableString);
     }
 
     /** FwUpdateStatus **/
@@ -286,7 +285,6 @@ ShowFirmware(
         goto Finish;
       }
       PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, FW_UPDATE_STATUS_STR, pFwUpdateStatusString);
-      FREE_POOL_SAFE(pFwUpdateStatusString);
     }
 
     /** FwImageMaxSize **/
@@ -303,7 +301,6 @@ ShowFirmware(
         goto Finish;
       }
       PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, QUIESCE_REQUIRED_STR, pQuiesceRequiredString);
-      FREE_POOL_SAFE(pQuiesceRequiredString);
     }
 
     /** Activation Time **/
@@ -324,7 +321,7 @@ ShowFirmware(
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_ROOT_PATH, &ShowFirmwareDataSetAttribs);
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_CMD_DISPLAY_OPTIONS_SAFE(pDispOptions);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDimms);
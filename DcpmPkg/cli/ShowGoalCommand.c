@@ -201,7 +201,7 @@ ShowGoalPrintTableView(
 Finish:
   //Specify table attributes
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pCmd->pPrintCtx, DS_ROOT_PATH, &ShowGoalDataSetAttribs);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   return ReturnCode;
 }
 
@@ -235,7 +235,7 @@ ShowGoalPrintDetailedView(
   UINT32 Index = 0;
   REGION_GOAL_PER_DIMM_INFO *pCurrentGoal = NULL;
   CHAR16 *pSettingsString = NULL;
-  CHAR16 *pStatusString = NULL;
+  CONST CHAR16 *pStatusString = NULL;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
   CHAR16 *pCapacityStr = NULL;
   CHAR16 *pPath = NULL;
@@ -319,13 +319,12 @@ ShowGoalPrintDetailedView(
     if (AllOptionSet || (DisplayOptionSet && ContainsValue(pDisplayValues, STATUS_STR))) {
       pStatusString = GoalStatusToString(gNvmDimmCliHiiHandle, pCurrentGoal->Status);
       PRINTER_SET_KEY_VAL_WIDE_STR(pCmd->pPrintCtx, pPath, STATUS_STR, pStatusString);
-      FREE_POOL_SAFE(pStatusString);
     }
   }
 Finish:
   //Specify table attributes
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pCmd->pPrintCtx, DS_ROOT_PATH, &ShowGoalDataSetAttribs);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   return ReturnCode;
 }
 /**
@@ -358,7 +357,7 @@ ShowGoal(
   COMMAND_STATUS *pCommandStatus = NULL;
   REGION_GOAL_PER_DIMM_INFO RegionConfigsInfo[MAX_DIMMS];
   EFI_STATUS ReturnCode = EFI_SUCCESS;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT32 DimmCount = 0;
   DISPLAY_PREFERENCES DisplayPreferences;
   PRINT_CONTEXT *pPrinterCtx = NULL;
@@ -410,8 +409,8 @@ ShowGoal(
     goto Finish;
   }
 
-  // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  // Populate the list of DIMM identities, no DIMM_INFO category is needed
+  ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimms, &DimmCount);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -422,12 +421,12 @@ ShowGoal(
   // check targets
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pTargetValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_DBG("Failed on GetDimmIdsFromString");
       goto Finish;
     }
-    if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
+    if (!AllDimmCoresInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
       ReturnCode = EFI_INVALID_PARAMETER;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_UNMANAGEABLE_DIMM);
       goto Finish;
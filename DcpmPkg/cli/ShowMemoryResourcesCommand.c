@@ -298,7 +298,7 @@ Finish:
   PRINTER_ENABLE_TEXT_TABLE_FORMAT(pPrinterCtx);
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_MEMORY_RESOURCES_PATH, &ShowMemoryResourcesDataSetAttribsPmtt3);
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pPcdMissingStr);
   NVDIMM_EXIT_I64(ReturnCode);
 
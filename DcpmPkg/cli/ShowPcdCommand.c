@@ -299,7 +299,7 @@ Finish:
   pDimmPcdInfo = NULL;
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDimms);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
 }
@@ -508,7 +508,7 @@ PrintPcdInterleaveInformation(
       pCurrentIdentInfo++;
     }
   }
-  FREE_POOL_SAFE(pPathPcdIdentificationInfo);
+  ARENA_FREE_POOL_SAFE(pPathPcdIdentificationInfo);
 }
 
 VOID
@@ -624,7 +624,7 @@ PrintPcdCurrentConfig(
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Error: wrong PCAT table type");
       break;
     }
-    FREE_POOL_SAFE(pPathPcdPcatTable);
+    ARENA_FREE_POOL_SAFE(pPathPcdPcatTable);
   }
 }
 
@@ -711,7 +711,7 @@ PrintPcdConfInput(
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Error: wrong PCAT table type");
       break;
     }
-    FREE_POOL_SAFE(pPathPcdPcatTable);
+    ARENA_FREE_POOL_SAFE(pPathPcdPcatTable);
   }
 }
 
@@ -793,7 +793,7 @@ PrintPcdConfOutput(
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Error: wrong PCAT table type");
       break;
     }
-    FREE_POOL_SAFE(pPathPcdPcatTable);
+    ARENA_FREE_POOL_SAFE(pPathPcdPcatTable);
   }
 }
 
@@ -839,7 +839,7 @@ PrintPcdConfigurationHeader(
     PrintPcdConfOutput(GET_NVDIMM_PLATFORM_CONFIG_OUTPUT(pConfHeader), pPrinterCtx, pPathPcdTable);
     ConfigIndex++;
   }
-  FREE_POOL_SAFE(pPathPcdTable);
+  ARENA_FREE_POOL_SAFE(pPathPcdTable);
 }
 
 /**
@@ -981,7 +981,7 @@ PrintLabelStorageArea(
     PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtxNsLabel, pPathNsLabel, PCD_TABLE_STR, L"Namespace Label Info");
     PrintNamespaceLabel(&pLba->pLabels[Index], pPrinterCtxNsLabel, pPathNsLabel);
   }
-  FREE_POOL_SAFE(pPathNsLabel);
+  ARENA_FREE_POOL_SAFE(pPathNsLabel);
 }
 
 /**
@@ -12,6 +12,10 @@
 #include "Common.h"
 #include "Convert.h"
 #include "NvmTypes.h"
+#include "PerformanceSampler.h"
+#ifdef OS_BUILD
+#include <nvm_history.h>
+#endif
 
 #define DS_ROOT_PATH                        L"/DimmPerformanceList"
 #define DS_SOCKET_PATH                      L"/DimmPerformanceList/DimmPerformance"
@@ -56,8 +60,11 @@ struct Command ShowPerformanceCommand =
     {VERBOSE_OPTION_SHORT, VERBOSE_OPTION, L"", L"", HELP_VERBOSE_DETAILS_TEXT, FALSE, ValueEmpty},
     {L"", PROTOCOL_OPTION_DDRT, L"", L"",HELP_DDRT_DETAILS_TEXT, FALSE, ValueEmpty},
     {L"", PROTOCOL_OPTION_SMBUS, L"", L"",HELP_SMBUS_DETAILS_TEXT, FALSE, ValueEmpty},
+    {L"", INTERVAL_OPTION, L"", INTERVAL_OPTION_HELP, L"Sample the counters at this period in milliseconds", FALSE, ValueRequired},
+    {L"", COUNT_OPTION, L"", COUNT_OPTION_HELP, L"Number of intervals to sample", FALSE, ValueRequired},
 #ifdef OS_BUILD
-    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT, FALSE, ValueRequired }
+    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT, FALSE, ValueRequired },
+    {L"", HISTORY_OPTION, L"", HISTORY_OPTION_HELP, L"Show the counters recorded by ipmctld over this many hours", FALSE, ValueRequired}
 #else
     {L"", L"", L"", L"", L"",FALSE, ValueOptional}
 #endif
@@ -88,6 +95,10 @@ CHAR16 *mppAllowedShowPerformanceDisplayValues[] =
 
 #define PERFORMANCE_DATA_FORMAT    L"0x"FORMAT_UINT64_HEX FORMAT_UINT64_HEX
 
+#define PERFORMANCE_DEFAULT_INTERVAL_MS   1000
+#define PERFORMANCE_MAX_INTERVAL_MS       (24 * 60 * 60 * 1000)
+#define PERFORMANCE_DEFAULT_COUNT         1
+
 
 EFI_STATUS GetDimmIdOrDimmHandleToPrint(UINT16 DimmId, DIMM_INFO *AllDimmInfos,
     UINT32 DimmCount, UINT32 *HandleToPrint)
@@ -208,9 +219,406 @@ PrintPerformanceData(PRINT_CONTEXT *pPrinterCtx, UINT16 *DimmId, UINT32 DimmIdsN
     ++DimmIndex;
   }
 
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
 }
 
+/**
+  Get the value of a numeric sampling option
+
+  @param[in] pCmd command from CLI
+  @param[in] pOption option to read
+  @param[in] DefaultValue value when the option is not given
+  @param[in] MaxValue largest value accepted
+  @param[in] pErrorMessage message printed on an incorrect value
+  @param[out] pValue the value
+
+  @retval EFI_SUCCESS success
+  @retval EFI_INVALID_PARAMETER the value is not a number from 1 to MaxValue
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+STATIC
+EFI_STATUS
+GetSamplingOption(
+  IN     struct Command *pCmd,
+  IN     CHAR16 *pOption,
+  IN     UINT32 DefaultValue,
+  IN     UINT32 MaxValue,
+  IN     CHAR16 *pErrorMessage,
+     OUT UINT32 *pValue
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  CHAR16 *pOptionValue = NULL;
+  UINT64 Value = 0;
+
+  *pValue = DefaultValue;
+  if (!containsOption(pCmd, pOption)) {
+    goto Finish;
+  }
+  if (NULL == (pOptionValue = getOptionValue(pCmd, pOption))) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+  if (!GetU64FromString(pOptionValue, &Value) || 0 == Value || Value > MaxValue) {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, pErrorMessage);
+    goto Finish;
+  }
+  *pValue = (UINT32)Value;
+
+Finish:
+  FREE_POOL_SAFE(pOptionValue);
+  return ReturnCode;
+}
+
+/**
+  Check whether a sampled counter is to be displayed. The sampled counters are
+  the lifetime ones, so either name of a counter selects its delta.
+**/
+STATIC
+BOOLEAN
+IsSampledCounterDisplayed(
+  IN     BOOLEAN AllOptionSet,
+  IN     BOOLEAN DisplayOptionSet,
+  IN     CHAR16 *pDisplayOptionValue,
+  IN     CHAR16 *pCounter,
+  IN     CHAR16 *pTotalCounter
+  )
+{
+  return AllOptionSet || (DisplayOptionSet &&
+    (ContainsValue(pDisplayOptionValue, pCounter) || ContainsValue(pDisplayOptionValue, pTotalCounter)));
+}
+
+/**
+  Print the delta and the rate of one sampled counter
+**/
+STATIC
+VOID
+PrintSampledCounter(
+  IN     PRINT_CONTEXT *pPrinterCtx,
+  IN     CHAR16 *pPath,
+  IN     CHAR16 *pCounter,
+  IN     CHAR16 *pRateCounter,
+  IN     PERFORMANCE_DELTA *pDelta,
+  IN     UINT64 Delta,
+  IN     UINT64 Rate
+  )
+{
+  if (EFI_ERROR(pDelta->ReturnCode)) {
+    PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, pCounter, NA_STR);
+    PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, pRateCounter, NA_STR);
+    return;
+  }
+  PRINTER_SET_KEY_VAL_UINT64(pPrinterCtx, pPath, pCounter, Delta, DECIMAL);
+  PRINTER_SET_KEY_VAL_UINT64(pPrinterCtx, pPath, pRateCounter, Rate, DECIMAL);
+}
+
+/**
+  Sample the performance counters on a fixed schedule and print the change
+  over every interval as soon as it is known.
+
+  @param[in] pCmd command from CLI
+  @param[in] pNvmDimmConfigProtocol config protocol
+  @param[in] pDimms all PMem modules
+  @param[in] DimmsCount number of entries in pDimms
+  @param[in] pDimmIds PMem modules to sample, all manageable ones if DimmIdsNum is 0
+  @param[in] DimmIdsNum number of entries in pDimmIds
+  @param[in] IntervalMs sampling period
+  @param[in] Count number of intervals to print
+  @param[in] AllOptionSet print every counter
+  @param[in] DisplayOptionSet print the counters in pDisplayOptionValue
+  @param[in] pDisplayOptionValue counters to print
+
+  @retval EFI_SUCCESS success
+  @retval EFI_NOT_FOUND no manageable PMem module to sample
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+STATIC
+EFI_STATUS
+ShowPerformanceSamples(
+  IN     struct Command *pCmd,
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     DIMM_INFO *pDimms,
+  IN     UINT32 DimmsCount,
+  IN     UINT16 *pDimmIds,
+  IN     UINT32 DimmIdsNum,
+  IN     UINT32 IntervalMs,
+  IN     UINT32 Count,
+  IN     BOOLEAN AllOptionSet,
+  IN     BOOLEAN DisplayOptionSet,
+  IN     CHAR16 *pDisplayOptionValue
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PRINT_CONTEXT *pPrinterCtx = pCmd->pPrintCtx;
+  PERFORMANCE_SAMPLER *pSampler = NULL;
+  PERFORMANCE_DELTA *pDeltas = NULL;
+  UINT16 *pSampledIds = NULL;
+  UINT32 SampledCount = 0;
+  UINT32 Sample = 0;
+  UINT32 Index = 0;
+  UINT32 InfoIndex = 0;
+  UINT32 RecordIndex = 0;
+  CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
+  CHAR16 *pPath = NULL;
+
+  if (NULL == (pSampledIds = AllocateZeroPool(sizeof(*pSampledIds) * DimmsCount))) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+  for (Index = 0; Index < DimmsCount; Index++) {
+    if (pDimms[Index].ManageabilityState == MANAGEMENT_VALID_CONFIG &&
+        (0 == DimmIdsNum || ContainUint(pDimmIds, DimmIdsNum, pDimms[Index].DimmID))) {
+      pSampledIds[SampledCount++] = pDimms[Index].DimmID;
+    }
+  }
+  if (0 == SampledCount) {
+    ReturnCode = EFI_NOT_FOUND;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_INFO_NO_MANAGEABLE_DIMMS);
+    goto Finish;
+  }
+
+  ReturnCode = PerformanceSamplerCreate(pNvmDimmConfigProtocol, pSampledIds, SampledCount, IntervalMs,
+    PERFORMANCE_SAMPLER_MIN_DEPTH, IsConcurrentFetchAllowed(), &pSampler);
+  if (EFI_ERROR(ReturnCode) ||
+      NULL == (pDeltas = AllocateZeroPool(sizeof(*pDeltas) * SampledCount))) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+    goto Finish;
+  }
+
+  // every interval is printed when it ends rather than after the last one
+  PRINTER_ENABLE_STREAM_FORMAT(pPrinterCtx);
+  PerformanceSamplerTake(pSampler);
+  for (Sample = 1; Sample <= Count; Sample++) {
+    PerformanceSamplerWait(pSampler);
+    PerformanceSamplerTake(pSampler);
+    PerformanceSamplerGetDeltas(pSampler, 0, pDeltas);
+
+    for (Index = 0; Index < SampledCount; Index++) {
+      for (InfoIndex = 0; InfoIndex < DimmsCount; InfoIndex++) {
+        if (pDimms[InfoIndex].DimmID == pDeltas[Index].DimmId) {
+          break;
+        }
+      }
+      if (InfoIndex == DimmsCount || EFI_ERROR(GetPreferredDimmIdAsString(pDimms[InfoIndex].DimmHandle,
+          pDimms[InfoIndex].DimmUid, DimmStr, MAX_DIMM_UID_LENGTH))) {
+        continue;
+      }
+      if (EFI_ERROR(pDeltas[Index].ReturnCode)) {
+        NVDIMM_WARN("Could not sample DIMM 0x%04x; Return code 0x%08x", pDeltas[Index].DimmId, pDeltas[Index].ReturnCode);
+      }
+
+      PRINTER_BUILD_KEY_PATH(pPath, DS_SOCKET_INDEX_PATH, RecordIndex++);
+      PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, DIMM_ID_STR, DimmStr);
+      PRINTER_SET_KEY_VAL_UINT64(pPrinterCtx, pPath, DCPMM_PERFORMANCE_SAMPLE, Sample, DECIMAL);
+      PRINTER_SET_KEY_VAL_UINT64(pPrinterCtx, pPath, DCPMM_PERFORMANCE_INTERVAL_MS, pDeltas[Index].IntervalMs, DECIMAL);
+
+      if (IsSampledCounterDisplayed(AllOptionSet, DisplayOptionSet, pDisplayOptionValue,
+          DCPMM_PERFORMANCE_MEDIA_READS, DCPMM_PERFORMANCE_TOTAL_MEDIA_READS)) {
+        PrintSampledCounter(pPrinterCtx, pPath, DCPMM_PERFORMANCE_MEDIA_READS,
+          DCPMM_PERFORMANCE_MEDIA_READS DCPMM_PERFORMANCE_RATE_SUFFIX, &pDeltas[Index],
+          pDeltas[Index].Delta.MediaReads, pDeltas[Index].Rate.MediaReads);
+      }
+      if (IsSampledCounterDisplayed(AllOptionSet, DisplayOptionSet, pDisplayOptionValue,
+          DCPMM_PERFORMANCE_MEDIA_WRITES, DCPMM_PERFORMANCE_TOTAL_MEDIA_WRITES)) {
+        PrintSampledCounter(pPrinterCtx, pPath, DCPMM_PERFORMANCE_MEDIA_WRITES,
+          DCPMM_PERFORMANCE_MEDIA_WRITES DCPMM_PERFORMANCE_RATE_SUFFIX, &pDeltas[Index],
+          pDeltas[Index].Delta.MediaWrites, pDeltas[Index].Rate.MediaWrites);
+      }
+      if (IsSampledCounterDisplayed(AllOptionSet, DisplayOptionSet, pDisplayOptionValue,
+          DCPMM_PERFORMANCE_READ_REQUESTS, DCPMM_PERFORMANCE_TOTAL_READ_REQUESTS)) {
+        PrintSampledCounter(pPrinterCtx, pPath, DCPMM_PERFORMANCE_READ_REQUESTS,
+          DCPMM_PERFORMANCE_READ_REQUESTS DCPMM_PERFORMANCE_RATE_SUFFIX, &pDeltas[Index],
+          pDeltas[Index].Delta.ReadRequests, pDeltas[Index].Rate.ReadRequests);
+      }
+      if (IsSampledCounterDisplayed(AllOptionSet, DisplayOptionSet, pDisplayOptionValue,
+          DCPMM_PERFORMANCE_WRITE_REQUESTS, DCPMM_PERFORMANCE_TOTAL_WRITE_REQUESTS)) {
+        PrintSampledCounter(pPrinterCtx, pPath, DCPMM_PERFORMANCE_WRITE_REQUESTS,
+          DCPMM_PERFORMANCE_WRITE_REQUESTS DCPMM_PERFORMANCE_RATE_SUFFIX, &pDeltas[Index],
+          pDeltas[Index].Delta.WriteRequests, pDeltas[Index].Rate.WriteRequests);
+      }
+    }
+    PRINTER_STREAM_FLUSH(pPrinterCtx, DS_ROOT_PATH, &ShowPerformanceDataSetAttribs);
+  }
+  PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_ROOT_PATH, &ShowPerformanceDataSetAttribs);
+
+Finish:
+  PerformanceSamplerFree(&pSampler);
+  FREE_POOL_SAFE(pDeltas);
+  FREE_POOL_SAFE(pSampledIds);
+  ARENA_FREE_POOL_SAFE(pPath);
+  return ReturnCode;
+}
+
+#ifdef OS_BUILD
+/**
+  Column of the history each counter is recorded in
+**/
+STATIC CONST struct {
+  CHAR16 *pCounter;
+  CHAR16 *pTotalCounter;
+  UINT32 Field;
+} mPerformanceHistoryFields[] = {
+  {DCPMM_PERFORMANCE_MEDIA_READS, DCPMM_PERFORMANCE_TOTAL_MEDIA_READS, HISTORY_MEDIA_READS},
+  {DCPMM_PERFORMANCE_MEDIA_WRITES, DCPMM_PERFORMANCE_TOTAL_MEDIA_WRITES, HISTORY_MEDIA_WRITES},
+  {DCPMM_PERFORMANCE_READ_REQUESTS, DCPMM_PERFORMANCE_TOTAL_READ_REQUESTS, HISTORY_READ_REQUESTS},
+  {DCPMM_PERFORMANCE_WRITE_REQUESTS, DCPMM_PERFORMANCE_TOTAL_WRITE_REQUESTS, HISTORY_WRITE_REQUESTS},
+};
+
+/**
+  State of printing the history of one PMem module
+**/
+typedef struct _PERFORMANCE_HISTORY_CONTEXT {
+  PRINT_CONTEXT *pPrinterCtx;
+  CHAR16 *pPath;
+  CHAR16 *pDimmStr;                         //!< PMem module being printed
+  UINT32 RecordIndex;
+  BOOLEAN HasPrevious;                      //!< Previous holds the last sample with counters
+  UINT64 Previous[HISTORY_FIELD_COUNT];
+  BOOLEAN AllOptionSet;
+  BOOLEAN DisplayOptionSet;
+  CHAR16 *pDisplayOptionValue;
+} PERFORMANCE_HISTORY_CONTEXT;
+
+/**
+  Print one recorded sample of the counters with their change since the
+  sample before it, called by history_query
+
+  @param[in] pUid PMem module the sample belongs to
+  @param[in] pValues the sample, indexed by enum history_field
+  @param[in] pContext PERFORMANCE_HISTORY_CONTEXT of the PMem module
+
+  @retval 1 to go on with the query
+**/
+STATIC
+int
+PrintPerformanceHistorySample(
+  IN     CONST CHAR8 *pUid,
+  IN     CONST UINT64 *pValues,
+  IN     VOID *pContext
+  )
+{
+  PERFORMANCE_HISTORY_CONTEXT *pHistory = (PERFORMANCE_HISTORY_CONTEXT *)pContext;
+  BOOLEAN Valid = (0 != (pValues[HISTORY_VALID] & HISTORY_VALID_PERFORMANCE));
+  CHAR16 *pTimeStr = NULL;
+  UINT32 Index = 0;
+  UINT32 Field = 0;
+
+  PRINTER_BUILD_KEY_PATH(pHistory->pPath, DS_SOCKET_INDEX_PATH, pHistory->RecordIndex++);
+  PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, DIMM_ID_STR, pHistory->pDimmStr);
+  pTimeStr = GetTimeFormatString(pValues[HISTORY_TIME], FALSE);
+  PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, HISTORY_TIME_STR, pTimeStr);
+  FREE_POOL_SAFE(pTimeStr);
+  if (Valid && pHistory->HasPrevious) {
+    PRINTER_SET_KEY_VAL_UINT64(pHistory->pPrinterCtx, pHistory->pPath, DCPMM_PERFORMANCE_INTERVAL_MS,
+      (pValues[HISTORY_TIME] - pHistory->Previous[HISTORY_TIME]) * PERFORMANCE_SAMPLER_MS_PER_SEC, DECIMAL);
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE(mPerformanceHistoryFields); Index++) {
+    if (!IsSampledCounterDisplayed(pHistory->AllOptionSet, pHistory->DisplayOptionSet, pHistory->pDisplayOptionValue,
+        mPerformanceHistoryFields[Index].pCounter, mPerformanceHistoryFields[Index].pTotalCounter)) {
+      continue;
+    }
+    Field = mPerformanceHistoryFields[Index].Field;
+    if (!Valid) {
+      PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, mPerformanceHistoryFields[Index].pCounter, NA_STR);
+      PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, mPerformanceHistoryFields[Index].pTotalCounter, NA_STR);
+      continue;
+    }
+    // the first sample of the range has nothing to take a change from
+    if (pHistory->HasPrevious) {
+      PRINTER_SET_KEY_VAL_UINT64(pHistory->pPrinterCtx, pHistory->pPath, mPerformanceHistoryFields[Index].pCounter,
+        pValues[Field] - pHistory->Previous[Field], DECIMAL);
+    }
+    PRINTER_SET_KEY_VAL_UINT64(pHistory->pPrinterCtx, pHistory->pPath, mPerformanceHistoryFields[Index].pTotalCounter,
+      pValues[Field], DECIMAL);
+  }
+
+  if (Valid) {
+    CopyMem(pHistory->Previous, pValues, sizeof(pHistory->Previous));
+    pHistory->HasPrevious = TRUE;
+  }
+  return 1;
+}
+
+/**
+  Print the performance counters ipmctld recorded over the range of the -history option
+
+  @param[in] pCmd command from CLI
+  @param[in] pDimms all PMem modules
+  @param[in] DimmsCount number of entries in pDimms
+  @param[in] pDimmIds PMem modules to print, all of them if DimmIdsNum is 0
+  @param[in] DimmIdsNum number of entries in pDimmIds
+  @param[in] AllOptionSet print every counter
+  @param[in] DisplayOptionSet print the counters in pDisplayOptionValue
+  @param[in] pDisplayOptionValue counters to print
+
+  @retval EFI_SUCCESS success
+  @retval EFI_INVALID_PARAMETER invalid -history value
+  @retval EFI_NOT_FOUND nothing was recorded
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+STATIC
+EFI_STATUS
+ShowPerformanceHistory(
+  IN     struct Command *pCmd,
+  IN     DIMM_INFO *pDimms,
+  IN     UINT32 DimmsCount,
+  IN     UINT16 *pDimmIds,
+  IN     UINT32 DimmIdsNum,
+  IN     BOOLEAN AllOptionSet,
+  IN     BOOLEAN DisplayOptionSet,
+  IN     CHAR16 *pDisplayOptionValue
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PERFORMANCE_HISTORY_CONTEXT History;
+  CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
+  CHAR8 DimmUid[MAX_DIMM_UID_LENGTH];
+  UINT64 From = 0;
+  UINT64 To = 0;
+  UINT32 Index = 0;
+
+  ZeroMem(&History, sizeof(History));
+  History.pPrinterCtx = pCmd->pPrintCtx;
+  History.pDimmStr = DimmStr;
+  History.AllOptionSet = AllOptionSet;
+  History.DisplayOptionSet = DisplayOptionSet;
+  History.pDisplayOptionValue = pDisplayOptionValue;
+
+  ReturnCode = GetHistoryRange(pCmd, &From, &To);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+
+  for (Index = 0; Index < DimmsCount; Index++) {
+    if (DimmIdsNum > 0 && !ContainUint(pDimmIds, DimmIdsNum, pDimms[Index].DimmID)) {
+      continue;
+    }
+    if (EFI_ERROR(GetPreferredDimmIdAsString(pDimms[Index].DimmHandle, pDimms[Index].DimmUid,
+        DimmStr, MAX_DIMM_UID_LENGTH))) {
+      continue;
+    }
+    UnicodeStrToAsciiStrS(pDimms[Index].DimmUid, DimmUid, MAX_DIMM_UID_LENGTH);
+
+    History.HasPrevious = FALSE;
+    if (0 != history_query(NVM_HISTORY_FILE, DimmUid, From, To, PrintPerformanceHistorySample, &History)) {
+      ReturnCode = EFI_NOT_FOUND;
+      PRINTER_SET_MSG(History.pPrinterCtx, ReturnCode, CLI_ERR_NO_HISTORY);
+      goto Finish;
+    }
+  }
+  PRINTER_CONFIGURE_DATA_ATTRIBUTES(History.pPrinterCtx, DS_ROOT_PATH, &ShowPerformanceDataSetAttribs);
+
+Finish:
+  ARENA_FREE_POOL_SAFE(History.pPath);
+  return ReturnCode;
+}
+#endif
+
 /**
 Execute the Show Performance command
 
@@ -240,6 +648,8 @@ ShowPerformance(
   CHAR16 *pPerformanceValueStr = NULL;
   UINT16 Index;
   PRINT_CONTEXT *pPrinterCtx = NULL;
+  UINT32 IntervalMs = PERFORMANCE_DEFAULT_INTERVAL_MS;
+  UINT32 Count = PERFORMANCE_DEFAULT_COUNT;
 
   if (pCmd == NULL) {
     ReturnCode = EFI_INVALID_PARAMETER;
@@ -298,6 +708,32 @@ ShowPerformance(
     }
   }
 
+#ifdef OS_BUILD
+  // -history reads what ipmctld recorded instead of the PMem modules
+  if (containsOption(pCmd, HISTORY_OPTION)) {
+    ReturnCode = ShowPerformanceHistory(pCmd, pDimms, DimmsCount, pDimmIds, DimmIdsNum,
+      AllOptionSet, DisplayOptionSet, pPerformanceValueStr);
+    goto Finish;
+  }
+#endif
+
+  // -interval and -count sample the counters instead of showing them once
+  if (containsOption(pCmd, INTERVAL_OPTION) || containsOption(pCmd, COUNT_OPTION)) {
+    ReturnCode = GetSamplingOption(pCmd, INTERVAL_OPTION, PERFORMANCE_DEFAULT_INTERVAL_MS,
+      PERFORMANCE_MAX_INTERVAL_MS, CLI_ERR_INCORRECT_VALUE_OPTION_INTERVAL, &IntervalMs);
+    if (EFI_ERROR(ReturnCode)) {
+      goto Finish;
+    }
+    ReturnCode = GetSamplingOption(pCmd, COUNT_OPTION, PERFORMANCE_DEFAULT_COUNT,
+      MAX_UINT32, CLI_ERR_INCORRECT_VALUE_OPTION_COUNT, &Count);
+    if (EFI_ERROR(ReturnCode)) {
+      goto Finish;
+    }
+    ReturnCode = ShowPerformanceSamples(pCmd, pNvmDimmConfigProtocol, pDimms, DimmsCount, pDimmIds, DimmIdsNum,
+      IntervalMs, Count, AllOptionSet, DisplayOptionSet, pPerformanceValueStr);
+    goto Finish;
+  }
+
   // Get the performance data
   ReturnCode = pNvmDimmConfigProtocol->GetDimmsPerformanceData(pNvmDimmConfigProtocol,
       &DimmCount, &pDimmsPerformanceData);
@@ -610,7 +610,7 @@ Finish:
     }
   }
   FREE_CMD_DISPLAY_OPTIONS_SAFE(pDispOptions);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pRegions);
   FREE_POOL_SAFE(pRegionsIds);
   FREE_POOL_SAFE(pSocketIds);
@@ -66,7 +66,7 @@ struct Command ShowRegisterCommand =
     {L"", PROTOCOL_OPTION_DDRT, L"", L"",HELP_DDRT_DETAILS_TEXT, FALSE, ValueEmpty},
     {L"", PROTOCOL_OPTION_SMBUS, L"", L"",HELP_SMBUS_DETAILS_TEXT, FALSE, ValueEmpty},
 #ifdef OS_BUILD
-    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT, FALSE, ValueRequired }
+    { OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_STREAM_HELP, HELP_OPTIONS_DETAILS_TEXT, FALSE, ValueRequired }
 #else
     {L"", L"", L"", L"",L"", FALSE, ValueOptional}
 #endif
@@ -132,7 +132,8 @@ ShowRegister(
   BOOLEAN ShowAllRegisters = FALSE;
   DIMM_BSR Bsr;
   UINT32 DimmCount = 0;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_SET *pDimmSet = NULL;
+  DIMM_INFO *pDimmInfo = NULL;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
   PRINT_CONTEXT *pPrinterCtx = NULL;
   CHAR16 *pPath = NULL;
@@ -161,20 +162,21 @@ ShowRegister(
     goto Finish;
   }
 
-  // Populate the list of DIMM_INFO structures with relevant information
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  // Populate the set of DIMM identities, a DIMM_INFO is only fetched for the printed DIMMs
+  ReturnCode = GetDimmInfoSet(pNvmDimmConfigProtocol, pCmd, &pDimmSet);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
     }
     goto Finish;
   }
+  DimmCount = pDimmSet->DimmCount;
 
   /** if a specific DIMM pid was passed in, set it **/
   pDimmValues = GetTargetValue(pCmd, DIMM_TARGET);
   if (pDimmValues != NULL) {
     if (StrLen(pDimmValues) > 0) {
-      ReturnCode = GetDimmIdsFromString(pCmd, pDimmValues, pDimms, DimmCount, &pDimmIds, &DimmIdsNum);
+      ReturnCode = GetDimmIdsFromCoreList(pCmd, pDimmValues, pDimmSet->pDimmCores, DimmCount, &pDimmIds, &DimmIdsNum);
       if (EFI_ERROR(ReturnCode)) {
         NVDIMM_WARN("Target value is not a valid DIMM ID");
         goto Finish;
@@ -214,26 +216,36 @@ ShowRegister(
     }
   }
 
+  //Force as list
+  PRINTER_ENABLE_LIST_TABLE_FORMAT(pPrinterCtx);
+
   /** Get and print registers for each requested dimm **/
   for (Index = 0; Index < DimmCount; Index++) {
-    if (DimmIdsNum > 0 && !ContainUint(pDimmIds, DimmIdsNum, pDimms[Index].DimmID)) {
-      NVDIMM_WARN("Dimm 0x%x not found", pDimms[Index].DimmHandle);
+    if (DimmIdsNum > 0 && !ContainUint(pDimmIds, DimmIdsNum, pDimmSet->pDimmCores[Index].DimmID)) {
+      NVDIMM_WARN("Dimm 0x%x not found", pDimmSet->pDimmCores[Index].DimmHandle);
       continue;
     }
 
     ReturnCode = pNvmDimmConfigProtocol->RetrieveDimmRegisters(pNvmDimmConfigProtocol,
-        pDimms[Index].DimmID, &Bsr.AsUint64, NULL, pCommandStatus);
+        pDimmSet->pDimmCores[Index].DimmID, &Bsr.AsUint64, NULL, pCommandStatus);
     if (EFI_ERROR(ReturnCode)) {
         NVDIMM_WARN("Failed to retrieve Dimm Registers");
         goto Finish;
     }
 
-    ReturnCode = GetPreferredDimmIdAsString(pDimms[Index].DimmHandle, pDimms[Index].DimmUid,
+    ReturnCode = GetPreferredDimmIdAsString(pDimmSet->pDimmCores[Index].DimmHandle, pDimmSet->pDimmCores[Index].DimmUid,
           DimmStr, MAX_DIMM_UID_LENGTH);
     if (EFI_ERROR(ReturnCode)) {
         goto Finish;
     }
 
+    // The FIS version selects the BSR layout
+    ReturnCode = GetDimmInfoFromSet(pDimmSet, Index, DIMM_INFO_CATEGORY_NONE, &pDimmInfo);
+    if (EFI_ERROR(ReturnCode)) {
+        NVDIMM_WARN("Failed to retrieve the DIMM info");
+        goto Finish;
+    }
+
     PRINTER_BUILD_KEY_PATH(pPath, DS_DIMM_INDEX_PATH, DimmIndex);
     PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, DIMM_ID_STR, DimmStr);
     if (ContainsValue(pRegisterValues, REGISTER_BSR_STR) || ShowAllRegisters) {
@@ -259,7 +271,7 @@ ShowRegister(
       PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [31:31] SVNWC ------------------------------------", FORMAT_HEX_NOWIDTH L" (0:The SVN Opt-In Window is open; 1:The SVN Opt-In Window is closed)", Bsr.Separated_Current_FIS.SVNWC);
       PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [33:32] Rsvd -------------------------------------", FORMAT_HEX_NOWIDTH L" (Rsvd)", Bsr.Separated_Current_FIS.Rsvd);
       PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [35:34] DTS --------------------------------------", FORMAT_HEX_NOWIDTH L" (00:Training Not Complete; 1:Training Complete; 2:Training Failure; 3:S3 Complete)", Bsr.Separated_Current_FIS.DTS);
-      if ((pDimms[DimmIndex].FwVer.FwApiMajor > 2) || (pDimms[DimmIndex].FwVer.FwApiMajor == 2 && pDimms[DimmIndex].FwVer.FwApiMinor >= 3)) { // Current FIS version
+      if ((pDimmInfo->FwVer.FwApiMajor > 2) || (pDimmInfo->FwVer.FwApiMajor == 2 && pDimmInfo->FwVer.FwApiMinor >= 3)) { // Current FIS version
         PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [36:36] FAC --------------------------------------", FORMAT_HEX_NOWIDTH L" (0:FW Activate has not completed; 1:FW Activate has completed)\n", Bsr.Separated_Current_FIS.FAC);
         PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [63:37] Rsvd1 ------------------------------------", FORMAT_HEX_NOWIDTH L" (Rsvd1)\n", Bsr.Separated_Current_FIS.Rsvd1);
       }
@@ -267,6 +279,8 @@ ShowRegister(
         PRINTER_SET_KEY_VAL_WIDE_STR_FORMAT(pPrinterCtx, pPath, L"  [63:36] Rsvd1 ------------------------------------", FORMAT_HEX_NOWIDTH L" (Rsvd1)\n", Bsr.Separated_FIS_1_15.Rsvd1);
       }
     }
+    //In stream mode print this DIMM's registers before reading the next one
+    PRINTER_STREAM_FLUSH(pPrinterCtx, DS_ROOT_PATH, &ShowRegisterDataSetAttribs);
     DimmIndex++;
   }
 
@@ -275,14 +289,11 @@ ShowRegister(
 
   //Specify DataSet attributes
   PRINTER_CONFIGURE_DATA_ATTRIBUTES(pPrinterCtx, DS_ROOT_PATH, &ShowRegisterDataSetAttribs);
-
-  //Force as list
-  PRINTER_ENABLE_LIST_TABLE_FORMAT(pPrinterCtx);
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FreeCommandStatus(&pCommandStatus);
-  FREE_POOL_SAFE(pDimms);
+  FreeDimmInfoSet(&pDimmSet);
   FREE_POOL_SAFE(pDimmIds);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
@@ -15,6 +15,9 @@
 #include <NvmHealth.h>
 #include <DataSet.h>
 #include <Printer.h>
+#ifdef OS_BUILD
+#include <nvm_history.h>
+#endif
 
 #define DIMM_ID_STR                       L"DimmID"
 #define SENSOR_TYPE_STR                   L"Type"
@@ -103,6 +106,7 @@ struct Command ShowSensorCommand =
     {DISPLAY_OPTION_SHORT, DISPLAY_OPTION, L"", HELP_TEXT_ATTRIBUTES, HELP_DISPLAY_DETAILS_TEXT, FALSE, ValueRequired}
 #ifdef OS_BUILD
     ,{ OUTPUT_OPTION_SHORT, OUTPUT_OPTION, L"", OUTPUT_OPTION_HELP, HELP_OPTIONS_DETAILS_TEXT, FALSE, ValueRequired }
+    ,{L"", HISTORY_OPTION, L"", HISTORY_OPTION_HELP, L"Show the values recorded by ipmctld over this many hours", FALSE, ValueRequired}
 #endif
   },
   {
@@ -151,6 +155,206 @@ GetSensorValue(
   return pReturnBuffer;
 }
 
+#ifdef OS_BUILD
+#define DS_HISTORY_ROOT_PATH              L"/SensorHistoryList"
+#define DS_HISTORY_DIMM_INDEX_PATH        L"/SensorHistoryList/Dimm[%d]"
+#define DS_HISTORY_SAMPLE_INDEX_PATH      L"/SensorHistoryList/Dimm[%d]/Sample[%d]"
+
+/*
+ *  PRINT LIST ATTRIBUTES (2 levels: Dimm-->Sample)
+ *  ---DimmId=0x0001---
+ *     ---Time=...
+ *        MediaTemperature=30C
+ *        ...
+ */
+PRINTER_LIST_ATTRIB ShowSensorHistoryListAttributes =
+{
+ {
+    {
+      DIMM_NODE_STR,                                                        //GROUP LEVEL TYPE
+      L"---" DIMM_ID_STR L"=$(" DIMM_ID_STR L")---",                        //NULL or GROUP LEVEL HEADER
+      SHOW_LIST_IDENT FORMAT_STR L"=" FORMAT_STR,                           //NULL or KEY VAL FORMAT STR
+      DIMM_ID_STR                                                           //NULL or IGNORE KEY LIST (K1;K2)
+    },
+    {
+      L"Sample",                                                            //GROUP LEVEL TYPE
+      SHOW_LIST_IDENT L"---" HISTORY_TIME_STR L"=$(" HISTORY_TIME_STR L")", //NULL or GROUP LEVEL HEADER
+      SHOW_LIST_IDENT SHOW_LIST_IDENT FORMAT_STR L"=" FORMAT_STR,           //NULL or KEY VAL FORMAT STR
+      HISTORY_TIME_STR                                                      //NULL or IGNORE KEY LIST (K1;K2)
+    }
+  }
+};
+
+PRINTER_DATA_SET_ATTRIBS ShowSensorHistoryDataSetAttribs =
+{
+  &ShowSensorHistoryListAttributes,
+  NULL
+};
+
+/**
+  Column of the history each sensor is recorded in
+**/
+STATIC CONST struct {
+  UINT8 SensorType;
+  UINT32 Field;
+} mSensorHistoryFields[] = {
+  {SENSOR_TYPE_DIMM_HEALTH, HISTORY_HEALTH},
+  {SENSOR_TYPE_MEDIA_TEMPERATURE, HISTORY_MEDIA_TEMPERATURE},
+  {SENSOR_TYPE_CONTROLLER_TEMPERATURE, HISTORY_CONTROLLER_TEMPERATURE},
+  {SENSOR_TYPE_PERCENTAGE_REMAINING, HISTORY_PERCENTAGE_REMAINING},
+  {SENSOR_TYPE_LATCHED_DIRTY_SHUTDOWN_COUNT, HISTORY_LATCHED_DIRTY_SHUTDOWNS},
+  {SENSOR_TYPE_POWER_ON_TIME, HISTORY_POWER_ON_TIME},
+  {SENSOR_TYPE_UP_TIME, HISTORY_UPTIME},
+  {SENSOR_TYPE_POWER_CYCLES, HISTORY_POWER_CYCLES},
+  {SENSOR_TYPE_FW_ERROR_COUNT, HISTORY_FW_ERROR_LOG_ENTRIES},
+  {SENSOR_TYPE_UNLATCHED_DIRTY_SHUTDOWN_COUNT, HISTORY_UNLATCHED_DIRTY_SHUTDOWNS},
+};
+
+/**
+  State of printing the history of one PMem module
+**/
+typedef struct _SENSOR_HISTORY_CONTEXT {
+  PRINT_CONTEXT *pPrinterCtx;
+  CHAR16 *pPath;
+  UINT32 DimmIndex;
+  UINT32 SampleIndex;
+  UINT32 SensorToDisplay;
+  EFI_STATUS ReturnCode;
+} SENSOR_HISTORY_CONTEXT;
+
+/**
+  Print one recorded sample of the sensors, called by history_query
+
+  @param[in] pUid PMem module the sample belongs to
+  @param[in] pValues the sample, indexed by enum history_field
+  @param[in] pContext SENSOR_HISTORY_CONTEXT of the PMem module
+
+  @retval 0 to stop the query on an error, 1 otherwise
+**/
+STATIC
+int
+PrintSensorHistorySample(
+  IN     CONST CHAR8 *pUid,
+  IN     CONST UINT64 *pValues,
+  IN     VOID *pContext
+  )
+{
+  SENSOR_HISTORY_CONTEXT *pHistory = (SENSOR_HISTORY_CONTEXT *)pContext;
+  CONST CHAR16 *pHealthStr = NULL;
+  CHAR16 *pTimeStr = NULL;
+  CHAR16 *pValueStr = NULL;
+  UINT32 Index = 0;
+
+  PRINTER_BUILD_KEY_PATH(pHistory->pPath, DS_HISTORY_SAMPLE_INDEX_PATH, pHistory->DimmIndex, pHistory->SampleIndex++);
+  pTimeStr = GetTimeFormatString(pValues[HISTORY_TIME], FALSE);
+  PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, HISTORY_TIME_STR, pTimeStr);
+  FREE_POOL_SAFE(pTimeStr);
+
+  for (Index = 0; Index < ARRAY_SIZE(mSensorHistoryFields); Index++) {
+    if (pHistory->SensorToDisplay != SENSOR_TYPE_ALL && pHistory->SensorToDisplay != mSensorHistoryFields[Index].SensorType) {
+      continue;
+    }
+    // the daemon records the sample even when the sensors could not be read
+    if (0 == (pValues[HISTORY_VALID] & HISTORY_VALID_SENSORS)) {
+      PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath,
+        SensorTypeToString(mSensorHistoryFields[Index].SensorType), NA_STR);
+      continue;
+    }
+    if (SENSOR_TYPE_DIMM_HEALTH == mSensorHistoryFields[Index].SensorType) {
+      pHealthStr = HealthToString(gNvmDimmCliHiiHandle, (UINT8)pValues[HISTORY_HEALTH]);
+      if (pHealthStr == NULL) {
+        pHistory->ReturnCode = EFI_OUT_OF_RESOURCES;
+        return 0;
+      }
+      PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath, DIMM_HEALTH_STR, pHealthStr);
+      continue;
+    }
+    pValueStr = GetSensorValue((INT64)pValues[mSensorHistoryFields[Index].Field], mSensorHistoryFields[Index].SensorType);
+    PRINTER_SET_KEY_VAL_WIDE_STR(pHistory->pPrinterCtx, pHistory->pPath,
+      SensorTypeToString(mSensorHistoryFields[Index].SensorType), pValueStr);
+    FREE_POOL_SAFE(pValueStr);
+  }
+  return 1;
+}
+
+/**
+  Print the sensor values ipmctld recorded over the range of the -history option
+
+  @param[in] pCmd command from CLI
+  @param[in] pDimms all PMem modules
+  @param[in] DimmsCount number of entries in pDimms
+  @param[in] pDimmIds PMem modules to print, all of them if DimmIdsNum is 0
+  @param[in] DimmIdsNum number of entries in pDimmIds
+  @param[in] SensorToDisplay sensor to print, SENSOR_TYPE_ALL for every one
+
+  @retval EFI_SUCCESS success
+  @retval EFI_INVALID_PARAMETER invalid -history value
+  @retval EFI_NOT_FOUND nothing was recorded
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+STATIC
+EFI_STATUS
+ShowSensorHistory(
+  IN     struct Command *pCmd,
+  IN     DIMM_INFO *pDimms,
+  IN     UINT32 DimmsCount,
+  IN     UINT16 *pDimmIds,
+  IN     UINT32 DimmIdsNum,
+  IN     UINT32 SensorToDisplay
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  SENSOR_HISTORY_CONTEXT History;
+  CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
+  CHAR8 DimmUid[MAX_DIMM_UID_LENGTH];
+  UINT64 From = 0;
+  UINT64 To = 0;
+  UINT32 DimmIndex = 0;
+
+  ZeroMem(&History, sizeof(History));
+  History.pPrinterCtx = pCmd->pPrintCtx;
+  History.SensorToDisplay = SensorToDisplay;
+
+  ReturnCode = GetHistoryRange(pCmd, &From, &To);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+
+  for (DimmIndex = 0; DimmIndex < DimmsCount; DimmIndex++) {
+    if (DimmIdsNum > 0 && !ContainUint(pDimmIds, DimmIdsNum, pDimms[DimmIndex].DimmID)) {
+      continue;
+    }
+    ReturnCode = GetPreferredDimmIdAsString(pDimms[DimmIndex].DimmHandle, pDimms[DimmIndex].DimmUid,
+      DimmStr, MAX_DIMM_UID_LENGTH);
+    if (EFI_ERROR(ReturnCode)) {
+      PRINTER_SET_MSG(History.pPrinterCtx, ReturnCode, L"Failed to translate " PMEM_MODULE_STR L" identifier to string\n");
+      goto Finish;
+    }
+    UnicodeStrToAsciiStrS(pDimms[DimmIndex].DimmUid, DimmUid, MAX_DIMM_UID_LENGTH);
+
+    PRINTER_BUILD_KEY_PATH(History.pPath, DS_HISTORY_DIMM_INDEX_PATH, History.DimmIndex);
+    PRINTER_SET_KEY_VAL_WIDE_STR(History.pPrinterCtx, History.pPath, DIMM_ID_STR, DimmStr);
+    History.SampleIndex = 0;
+    if (0 != history_query(NVM_HISTORY_FILE, DimmUid, From, To, PrintSensorHistorySample, &History)) {
+      ReturnCode = EFI_NOT_FOUND;
+      PRINTER_SET_MSG(History.pPrinterCtx, ReturnCode, CLI_ERR_NO_HISTORY);
+      goto Finish;
+    }
+    if (EFI_ERROR(History.ReturnCode)) {
+      ReturnCode = History.ReturnCode;
+      PRINTER_SET_MSG(History.pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+      goto Finish;
+    }
+    History.DimmIndex++;
+  }
+  PRINTER_CONFIGURE_DATA_ATTRIBUTES(History.pPrinterCtx, DS_HISTORY_ROOT_PATH, &ShowSensorHistoryDataSetAttribs);
+
+Finish:
+  ARENA_FREE_POOL_SAFE(History.pPath);
+  return ReturnCode;
+}
+#endif
+
 /**
   Execute the show sensor command
 
@@ -175,6 +379,7 @@ ShowSensor(
   BOOLEAN Found = FALSE;
   UINT32 SensorIndex = 0;
   CHAR16 *pTempBuff = NULL;
+  CONST CHAR16 *pHealthStr = NULL;
   UINT32 SensorToDisplay = SENSOR_TYPE_ALL;
   COMMAND_STATUS *pCommandStatus = NULL;
   DIMM_SENSOR DimmSensorsSet[SENSOR_TYPE_COUNT];
@@ -286,6 +491,14 @@ ShowSensor(
     }
   }
 
+#ifdef OS_BUILD
+  // -history reads what ipmctld recorded instead of the PMem modules
+  if (containsOption(pCmd, HISTORY_OPTION)) {
+    ReturnCode = ShowSensorHistory(pCmd, pDimms, DimmsCount, pDimmIds, DimmIdsNum, SensorToDisplay);
+    goto Finish;
+  }
+#endif
+
   for (DimmIndex = 0; DimmIndex < DimmsCount; DimmIndex++) {
     if (DimmIdsNum > 0 && !ContainUint(pDimmIds, DimmIdsNum, pDimms[DimmIndex].DimmID)) {
       continue;
@@ -342,19 +555,19 @@ ShowSensor(
           Only for Health State
         **/
         if (ContainsValue(SensorTypeToString(DimmSensorsSet[SensorIndex].Type), DIMM_HEALTH_STR)) {
-          pTempBuff = HealthToString(gNvmDimmCliHiiHandle, (UINT8)DimmSensorsSet[SensorIndex].Value);
-          if (pTempBuff == NULL) {
+          pHealthStr = HealthToString(gNvmDimmCliHiiHandle, (UINT8)DimmSensorsSet[SensorIndex].Value);
+          if (pHealthStr == NULL) {
             ReturnCode = EFI_OUT_OF_RESOURCES;
             PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
             goto Finish;
           }
+          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, CURRENT_VALUE_STR, pHealthStr);
         }
         else {
           pTempBuff = GetSensorValue(DimmSensorsSet[SensorIndex].Value, DimmSensorsSet[SensorIndex].Type);
+          PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, CURRENT_VALUE_STR, pTempBuff);
+          FREE_POOL_SAFE(pTempBuff);
         }
-
-        PRINTER_SET_KEY_VAL_WIDE_STR(pPrinterCtx, pPath, CURRENT_VALUE_STR, pTempBuff);
-        FREE_POOL_SAFE(pTempBuff);
       }
 
       /**
@@ -491,7 +704,7 @@ ShowSensor(
 
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_CMD_DISPLAY_OPTIONS_SAFE(pDispOptions);
   FreeCommandStatus(&pCommandStatus);
   FREE_POOL_SAFE(pDimms);
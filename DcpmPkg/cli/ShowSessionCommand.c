@@ -196,7 +196,7 @@ ShowSession(
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
   NVDIMM_EXIT_I64(ReturnCode);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pTagId);
   FREE_POOL_SAFE(pName);
   FREE_POOL_SAFE(pDescription);
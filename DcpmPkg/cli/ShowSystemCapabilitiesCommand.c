@@ -436,7 +436,7 @@ Finish:
   FREE_HII_POINTER(SystemCapabilitiesInfo.PtrInterleaveFormatsSupported);
   FREE_HII_POINTER(SystemCapabilitiesInfo.PtrInterleaveSize);
   FREE_POOL_SAFE(pDisplayValues);
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   NVDIMM_EXIT_I64(ReturnCode);
   return  ReturnCode;
 }
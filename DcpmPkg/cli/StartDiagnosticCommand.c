@@ -308,7 +308,7 @@ StartDiagnosticCmd(
 Finish:
   PRINTER_PROCESS_SET_BUFFER(pPrinterCtx);
   // free all memory structures
-  FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pPath);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDimms);
   NVDIMM_EXIT_I64(ReturnCode);
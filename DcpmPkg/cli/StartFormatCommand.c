@@ -51,7 +51,8 @@ StartFormat(
   EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
   BOOLEAN Force = FALSE;
   BOOLEAN Confirmation = FALSE;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
+  DIMM_INFO *pUninitializedDimms = NULL;
   UINT32 DimmCount = 0;
   UINT32 Index = 0;
   CHAR16 DimmStr[MAX_DIMM_UID_LENGTH];
@@ -92,7 +93,7 @@ StartFormat(
 
   if (containsOption(pCmd, RECOVER_OPTION)) {
     Recovery = TRUE;
-    // Populate the list of DIMM_INFO structures with the DIMMs NOT found in NFIT
+    // Populate the list of DIMM identities with the DIMMs NOT found in NFIT
     ReturnCode = pNvmDimmConfigProtocol->GetUninitializedDimmCount(pNvmDimmConfigProtocol, &DimmCount);
     if (EFI_ERROR(ReturnCode)) {
       goto Finish;
@@ -104,19 +105,25 @@ StartFormat(
       goto Finish;
     }
 
+    pUninitializedDimms = AllocateZeroPool(sizeof(*pUninitializedDimms) * DimmCount);
     pDimms = AllocateZeroPool(sizeof(*pDimms) * DimmCount);
-    if (pDimms == NULL) {
+    if (pUninitializedDimms == NULL || pDimms == NULL) {
       ReturnCode = EFI_OUT_OF_RESOURCES;
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
       goto Finish;
     }
 
-    ReturnCode = pNvmDimmConfigProtocol->GetUninitializedDimms(pNvmDimmConfigProtocol, DimmCount, pDimms);
+    ReturnCode = pNvmDimmConfigProtocol->GetUninitializedDimms(pNvmDimmConfigProtocol, DimmCount, pUninitializedDimms);
     if (EFI_ERROR(ReturnCode)) {
       goto Finish;
     }
+
+    for (Index = 0; Index < DimmCount; Index++) {
+      DimmInfoToCore(&pUninitializedDimms[Index], &pDimms[Index]);
+    }
+    FREE_POOL_SAFE(pUninitializedDimms);
   } else {
-    ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+    ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimms, &DimmCount);
     if (EFI_ERROR(ReturnCode)) {
       if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -128,14 +135,14 @@ StartFormat(
   // check targets
   if (ContainTarget(pCmd, DIMM_TARGET)) {
     pTargetValue = GetTargetValue(pCmd, DIMM_TARGET);
-    ReturnCode = GetDimmIdsFromString(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
+    ReturnCode = GetDimmIdsFromCoreList(pCmd, pTargetValue, pDimms, DimmCount, &pDimmIds, &DimmIdsCount);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_DBG("Failed on GetDimmIdsFromString");
       goto Finish;
     }
 
     if (!Recovery) {
-      if (!AllDimmsInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
+      if (!AllDimmCoresInListAreManageable(pDimms, DimmCount, pDimmIds, DimmIdsCount)){
         ReturnCode = EFI_INVALID_PARAMETER;
         PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_UNMANAGEABLE_DIMM);
         goto Finish;
@@ -168,7 +175,7 @@ StartFormat(
 
   if (!Force) {
     for (Index = 0; Index < DimmIdsCount; Index++) {
-      ReturnCode = GetDimmHandleByPid(pDimmIds[Index], pDimms, DimmCount, &DimmHandle, &DimmIndex);
+      ReturnCode = GetDimmHandleByCorePid(pDimmIds[Index], pDimms, DimmCount, &DimmHandle, &DimmIndex);
       if (EFI_ERROR(ReturnCode)) {
         goto Finish;
        }
@@ -203,6 +210,7 @@ Finish:
   FreeCommandStatus(&pCommandStatus);
   FREE_POOL_SAFE(pDimmIds);
   FREE_POOL_SAFE(pDimms);
+  FREE_POOL_SAFE(pUninitializedDimms);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
 }
@@ -55,7 +55,8 @@ struct Command StartSessionCommand =
   {                                                                      //!< targets
     {SESSION_TARGET, L"", L"", TRUE, ValueEmpty},
     {PBR_MODE_TARGET, L"", L"", TRUE, ValueRequired},
-    {PBR_MODE_TAG, L"", L"", FALSE, ValueRequired}
+    {PBR_MODE_TAG, L"", L"", FALSE, ValueRequired},
+    {PBR_ORDER_TARGET, L"", PBR_ORDER_SEQUENTIAL_VAL L"|" PBR_ORDER_KEYED_VAL, FALSE, ValueRequired}
   },
   {{L"", L"", L"", FALSE, ValueOptional}},                               //!< properties
   L"Start a playback or record (PBR) session.",                          //!< help
@@ -76,11 +77,13 @@ StartSession(
   EFI_DCPMM_PBR_PROTOCOL *pNvmDimmPbrProtocol = NULL;
   CHAR16 *pModeValue = NULL;
   CHAR16 *pTagValue = NULL;
+  CHAR16 *pOrderValue = NULL;
   UINT64 TagId64 = 0;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   BOOLEAN Force = FALSE;
   BOOLEAN Confirmation = FALSE;
   UINT32 PbrMode;
+  UINT32 PlaybackOrder = PBR_PLAYBACK_ORDER_SEQUENTIAL;
 
   pPrinterCtx = pCmd->pPrintCtx;
 
@@ -156,6 +159,26 @@ StartSession(
   else if (StrICmp(pModeValue, PBR_PLAYBACK_MANUAL_MODE_VAL) == 0 ||
     StrICmp(pModeValue, PBR_PLAYBACK_MODE_VAL) == 0) {
 
+    //recorded requests are replayed in recorded order unless keyed order is requested
+    pOrderValue = GetTargetValue(pCmd, PBR_ORDER_TARGET);
+    if (NULL != pOrderValue) {
+      if (0 == StrICmp(pOrderValue, PBR_ORDER_KEYED_VAL)) {
+        PlaybackOrder = PBR_PLAYBACK_ORDER_KEYED;
+      }
+      else if (0 != StrICmp(pOrderValue, PBR_ORDER_SEQUENTIAL_VAL)) {
+        ReturnCode = EFI_INVALID_PARAMETER;
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_UNKNOWN_PLAYBACK_ORDER);
+        goto Finish;
+      }
+    }
+
+    ReturnCode = pNvmDimmPbrProtocol->PbrSetPlaybackOrder(PlaybackOrder);
+    if (EFI_ERROR(ReturnCode)) {
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_FAILED_TO_SET_PLAYBACK_ORDER,
+        (NULL != pOrderValue) ? pOrderValue : PBR_ORDER_SEQUENTIAL_VAL);
+      goto Finish;
+    }
+
     //only print if manual mode, otherwise obvious what mode was just executed.
     if (0 == StrICmp(pModeValue, PBR_PLAYBACK_MANUAL_MODE_VAL)) {
       PRINTER_PROMPT_MSG(pPrinterCtx, ReturnCode, ACTION_SETTING_MODE, pModeValue);
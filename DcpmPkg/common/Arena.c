@@ -0,0 +1,292 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "Arena.h"
+#include <Library/BaseMemoryLib.h>
+#include <Library/PrintLib.h>
+
+/*
+* Size rounded up to the arena alignment, zero sized requests still take a slot
+*/
+#define ARENA_ALIGN(Size)         ((((Size) ? (Size) : 1) + ARENA_ALIGNMENT - 1) & ~((UINTN)ARENA_ALIGNMENT - 1))
+
+/*
+* Characters reserved for a formatted string on the first try
+*/
+#define ARENA_PRINT_MIN_LEN       256
+
+/*
+* One block of arena memory, the data follows the header
+*/
+typedef struct _ARENA_CHUNK {
+  struct _ARENA_CHUNK *Next;  //previous, already filled chunk
+  UINTN Size;                 //bytes of data in the chunk
+  UINTN Used;                 //bytes of data handed out
+}ARENA_CHUNK;
+
+#define ARENA_CHUNK_HEADER_SIZE   ARENA_ALIGN(sizeof(ARENA_CHUNK))
+#define ARENA_CHUNK_DATA(Chunk)   ((UINT8 *)(Chunk) + ARENA_CHUNK_HEADER_SIZE)
+
+STATIC ARENA_CHUNK *mArenaChunks = NULL;  //newest chunk first
+STATIC UINT32 mArenaDepth = 0;            //number of open ArenaBegin scopes
+STATIC UINT8 *mArenaLast = NULL;          //most recent allocation, resized and freed in place
+STATIC UINT32 mArenaSuspended = 0;        //number of open ArenaSuspend scopes
+
+/*
+* New allocations come from the arena only inside an arena scope that is not suspended
+*/
+#define ARENA_IN_USE()            (0 < mArenaDepth && 0 == mArenaSuspended)
+
+/*
+* Start a new chunk with room for at least MinSize bytes
+*/
+STATIC ARENA_CHUNK *ArenaNewChunk(UINTN MinSize) {
+  ARENA_CHUNK *Chunk = NULL;
+  UINTN Size = ARENA_FIRST_CHUNK_SIZE;
+
+  if (NULL != mArenaChunks) {
+    Size = MIN(mArenaChunks->Size * 2, ARENA_MAX_CHUNK_SIZE);
+  }
+  if (Size < MinSize) {
+    Size = MinSize;
+  }
+  if (NULL == (Chunk = (ARENA_CHUNK *)AllocatePool(ARENA_CHUNK_HEADER_SIZE + Size))) {
+    return NULL;
+  }
+  Chunk->Next = mArenaChunks;
+  Chunk->Size = Size;
+  Chunk->Used = 0;
+  mArenaChunks = Chunk;
+  mArenaLast = NULL;
+  return Chunk;
+}
+
+VOID
+ArenaBegin(
+  )
+{
+  mArenaDepth++;
+}
+
+VOID
+ArenaEnd(
+  )
+{
+  ARENA_CHUNK *Chunk = NULL;
+
+  if (0 == mArenaDepth || 0 < --mArenaDepth) {
+    return;
+  }
+  while (NULL != mArenaChunks) {
+    Chunk = mArenaChunks;
+    mArenaChunks = Chunk->Next;
+    FreePool(Chunk);
+  }
+  mArenaLast = NULL;
+  mArenaSuspended = 0;
+}
+
+VOID
+ArenaSuspend(
+  )
+{
+  mArenaSuspended++;
+}
+
+VOID
+ArenaResume(
+  )
+{
+  if (0 < mArenaSuspended) {
+    mArenaSuspended--;
+  }
+}
+
+BOOLEAN
+ArenaOwns(
+  IN CONST VOID *pBuffer
+  )
+{
+  ARENA_CHUNK *Chunk = NULL;
+
+  if (NULL == pBuffer) {
+    return FALSE;
+  }
+  for (Chunk = mArenaChunks; NULL != Chunk; Chunk = Chunk->Next) {
+    if ((CONST UINT8 *)pBuffer >= ARENA_CHUNK_DATA(Chunk) &&
+        (CONST UINT8 *)pBuffer < ARENA_CHUNK_DATA(Chunk) + Chunk->Used) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+VOID *
+ArenaAllocatePool(
+  IN UINTN Size
+  )
+{
+  UINTN AlignedSize = ARENA_ALIGN(Size);
+
+  if (!ARENA_IN_USE()) {
+    return AllocatePool(Size);
+  }
+  if (AlignedSize < Size) {
+    return NULL;
+  }
+  if (NULL == mArenaChunks || mArenaChunks->Size - mArenaChunks->Used < AlignedSize) {
+    if (NULL == ArenaNewChunk(AlignedSize)) {
+      return NULL;
+    }
+  }
+  mArenaLast = ARENA_CHUNK_DATA(mArenaChunks) + mArenaChunks->Used;
+  mArenaChunks->Used += AlignedSize;
+  return mArenaLast;
+}
+
+VOID *
+ArenaAllocateZeroPool(
+  IN UINTN Size
+  )
+{
+  VOID *pBuffer = NULL;
+
+  if (!ARENA_IN_USE()) {
+    return AllocateZeroPool(Size);
+  }
+  if (NULL != (pBuffer = ArenaAllocatePool(Size))) {
+    ZeroMem(pBuffer, Size);
+  }
+  return pBuffer;
+}
+
+VOID *
+ArenaReallocatePool(
+  IN UINTN OldSize,
+  IN UINTN NewSize,
+  IN VOID *pOldBuffer OPTIONAL
+  )
+{
+  VOID *pNewBuffer = NULL;
+  UINTN Offset = 0;
+
+  if (NULL != pOldBuffer && !ArenaOwns(pOldBuffer)) {
+    return ReallocatePool(OldSize, NewSize, pOldBuffer);
+  }
+  if (NULL != pOldBuffer && (UINT8 *)pOldBuffer == mArenaLast) {
+    Offset = mArenaLast - ARENA_CHUNK_DATA(mArenaChunks);
+    if (ARENA_ALIGN(NewSize) >= NewSize && mArenaChunks->Size - Offset >= ARENA_ALIGN(NewSize)) {
+      if (NewSize > OldSize) {
+        ZeroMem((UINT8 *)pOldBuffer + OldSize, NewSize - OldSize);
+      }
+      mArenaChunks->Used = Offset + ARENA_ALIGN(NewSize);
+      return pOldBuffer;
+    }
+  }
+  if (NULL == (pNewBuffer = ArenaAllocateZeroPool(NewSize))) {
+    return NULL;
+  }
+  if (NULL != pOldBuffer) {
+    CopyMem(pNewBuffer, pOldBuffer, MIN(OldSize, NewSize));
+  }
+  return pNewBuffer;
+}
+
+VOID
+ArenaFreePool(
+  IN VOID *pBuffer
+  )
+{
+  if (NULL == pBuffer) {
+    return;
+  }
+  if (!ArenaOwns(pBuffer)) {
+    FreePool(pBuffer);
+    return;
+  }
+  if ((UINT8 *)pBuffer == mArenaLast) {
+    mArenaChunks->Used = mArenaLast - ARENA_CHUNK_DATA(mArenaChunks);
+    mArenaLast = NULL;
+  }
+}
+
+CHAR16 *
+ArenaCatVSPrint(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  IN VA_LIST Marker
+  )
+{
+  CHAR16 *pBuffer = NULL;
+  UINTN StrLength = 0;
+  UINTN Capacity = 0;
+  UINTN Printed = 0;
+  VA_LIST MarkerCopy;
+
+  if (!ARENA_IN_USE()) {
+    return CatVSPrint(pString, pFormat, Marker);
+  }
+  if (NULL != pString) {
+    StrLength = StrLen(pString);
+  }
+
+  // format straight into the free tail of the current chunk, retry with more room if it did not fit
+  Capacity = StrLength + ARENA_PRINT_MIN_LEN;
+  if (NULL != mArenaChunks && (mArenaChunks->Size - mArenaChunks->Used) / sizeof(CHAR16) > Capacity) {
+    Capacity = (mArenaChunks->Size - mArenaChunks->Used) / sizeof(CHAR16);
+  }
+  for (; Capacity <= MAX_UINT32; Capacity *= 2) {
+    if (NULL == (pBuffer = (CHAR16 *)ArenaAllocatePool(Capacity * sizeof(CHAR16)))) {
+      return NULL;
+    }
+    if (NULL != pString) {
+      CopyMem(pBuffer, pString, StrLength * sizeof(CHAR16));
+    }
+    VA_COPY(MarkerCopy, Marker);
+    Printed = UnicodeVSPrint(pBuffer + StrLength, (Capacity - StrLength) * sizeof(CHAR16), pFormat, MarkerCopy);
+    VA_END(MarkerCopy);
+    if (Printed < Capacity - StrLength - 1) {
+      return (CHAR16 *)ArenaReallocatePool(Capacity * sizeof(CHAR16), (StrLength + Printed + 1) * sizeof(CHAR16), pBuffer);
+    }
+    ArenaFreePool(pBuffer);
+  }
+  return NULL;
+}
+
+CHAR16 *
+EFIAPI
+ArenaCatSPrint(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  ...
+  )
+{
+  VA_LIST Marker;
+  CHAR16 *pNewString = NULL;
+
+  VA_START(Marker, pFormat);
+  pNewString = ArenaCatVSPrint(pString, pFormat, Marker);
+  VA_END(Marker);
+  return pNewString;
+}
+
+CHAR16 *
+EFIAPI
+ArenaCatSPrintClean(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  ...
+  )
+{
+  VA_LIST Marker;
+  CHAR16 *pNewString = NULL;
+
+  VA_START(Marker, pFormat);
+  pNewString = ArenaCatVSPrint(pString, pFormat, Marker);
+  VA_END(Marker);
+
+  ArenaFreePool(pString);
+  return pNewString;
+}
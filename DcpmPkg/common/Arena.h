@@ -0,0 +1,191 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <Uefi.h>
+#include <Debug.h>
+#include <Types.h>
+
+/*
+* The arena is a single set of process globals with no locking. It backs the
+* CLI command being executed and must only be used from the thread running it.
+*/
+
+#define ARENA_FIRST_CHUNK_SIZE  (64 * 1024)     //!< Size of the first chunk of an arena
+#define ARENA_MAX_CHUNK_SIZE    (1024 * 1024)   //!< Chunks double in size up to this limit
+#define ARENA_ALIGNMENT         16              //!< Alignment of every arena allocation
+
+/**
+  Free a buffer from ArenaAllocatePool, or from AllocatePool, and set the pointer to NULL
+**/
+#define ARENA_FREE_POOL_SAFE(pBuffer) { \
+  if (pBuffer != NULL) { \
+    ArenaFreePool((VOID *)pBuffer); \
+    pBuffer = NULL; \
+  } \
+};
+
+/**
+  Open an arena scope.
+
+  Until the matching ArenaEnd, the Arena allocation functions hand out memory
+  from a bump allocated arena instead of the pool. Scopes nest, the arena is
+  only released when the outermost scope ends.
+**/
+VOID
+ArenaBegin(
+  );
+
+/**
+  Close an arena scope opened by ArenaBegin.
+
+  When the outermost scope is closed every buffer allocated from the arena is
+  released in one shot and must not be used anymore.
+**/
+VOID
+ArenaEnd(
+  );
+
+/**
+  Suspend the arena.
+
+  Until the matching ArenaResume, the Arena allocation functions hand out pool
+  memory again, so buffers released with ArenaFreePool are given back at once.
+  Used for data that is produced and released repeatedly during one command,
+  such as streamed records. Buffers already in the arena stay valid.
+**/
+VOID
+ArenaSuspend(
+  );
+
+/**
+  Resume the arena suspended by ArenaSuspend.
+**/
+VOID
+ArenaResume(
+  );
+
+/**
+  Check if a buffer was allocated from the current arena
+
+  @param[in] pBuffer the buffer to check
+
+  @retval TRUE pBuffer lives in the arena
+  @retval FALSE pBuffer is NULL or was not allocated from the arena
+**/
+BOOLEAN
+ArenaOwns(
+  IN CONST VOID *pBuffer
+  );
+
+/**
+  Allocate a buffer from the arena, or from the pool when no arena scope is open
+
+  @param[in] Size number of bytes to allocate
+
+  @retval pointer to the buffer, NULL if out of memory
+**/
+VOID *
+ArenaAllocatePool(
+  IN UINTN Size
+  );
+
+/**
+  Allocate a zeroed buffer from the arena, or from the pool when no arena scope is open
+
+  @param[in] Size number of bytes to allocate
+
+  @retval pointer to the buffer, NULL if out of memory
+**/
+VOID *
+ArenaAllocateZeroPool(
+  IN UINTN Size
+  );
+
+/**
+  Grow or shrink a buffer from ArenaAllocatePool or AllocatePool.
+
+  The most recent arena allocation is resized in place when possible, other
+  arena buffers are copied. Pool buffers are reallocated with ReallocatePool.
+
+  @param[in] OldSize size of pOldBuffer in bytes
+  @param[in] NewSize requested size in bytes
+  @param[in] pOldBuffer buffer to resize, may be NULL
+
+  @retval pointer to the resized buffer, NULL if out of memory (pOldBuffer is then left intact)
+**/
+VOID *
+ArenaReallocatePool(
+  IN UINTN OldSize,
+  IN UINTN NewSize,
+  IN VOID *pOldBuffer OPTIONAL
+  );
+
+/**
+  Free a buffer from ArenaAllocatePool or AllocatePool.
+
+  Pool buffers are freed right away. Arena buffers are released with the
+  arena, except for the most recent allocation which is given back at once.
+
+  @param[in] pBuffer buffer to free
+**/
+VOID
+ArenaFreePool(
+  IN VOID *pBuffer
+  );
+
+/**
+  Arena counterpart of CatVSPrint
+
+  @param[in] pString string to append to, may be NULL. It is not freed.
+  @param[in] pFormat format string
+  @param[in] Marker format arguments
+
+  @retval the formatted string, NULL if out of memory
+**/
+CHAR16 *
+ArenaCatVSPrint(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  IN VA_LIST Marker
+  );
+
+/**
+  Arena counterpart of CatSPrint
+
+  @param[in] pString string to append to, may be NULL. It is not freed.
+  @param[in] pFormat format string
+  @param[in] ... format arguments
+
+  @retval the formatted string, NULL if out of memory
+**/
+CHAR16 *
+EFIAPI
+ArenaCatSPrint(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  ...
+  );
+
+/**
+  Arena counterpart of CatSPrintClean
+
+  @param[in] pString string to append to, may be NULL. It is freed with ArenaFreePool.
+  @param[in] pFormat format string
+  @param[in] ... format arguments
+
+  @retval the formatted string, NULL if out of memory
+**/
+CHAR16 *
+EFIAPI
+ArenaCatSPrintClean(
+  IN CHAR16 *pString OPTIONAL,
+  IN CONST CHAR16 *pFormat,
+  ...
+  );
+
+#endif /** _ARENA_H_ **/
@@ -4,18 +4,65 @@
 */
 
 #include "DataSet.h"
+#include "Arena.h"
 #include <Library/BaseMemoryLib.h>
 
 #define BOOL_TRUE_STR L"True"
 #define BOOL_FALSE_STR L"False"
 
+/*
+* Sizes of the hash tables, all powers of two
+*/
+#define INTERNED_STR_BUCKETS    512
+#define KEY_INDEX_MIN_BUCKETS   16
+#define CHILD_INDEX_BUCKETS     16
+#define CHILD_GROUP_MIN_SIZE    4
+
+/*
+* Longest rendered value of a numeric or boolean key, including the NULL terminator
+*/
+#define VALUE_STR_SCRATCH_LEN   32
+
+/*
+* A key or data set name shared by every node using it.  Lookups intern
+* the requested name once, after which nodes compare names by pointer.
+*/
+typedef struct _INTERNED_STR {
+  struct _INTERNED_STR *Next;   //next string in the same bucket
+  UINT32 Hash;                  //hash of Str
+  UINT32 RefCount;              //number of keys and data sets using Str
+  CHAR16 Str[1];                //the string, allocated to its full size
+}INTERNED_STR;
+
 typedef struct _KEY_VAL {
   LIST_ENTRY Link;
+  struct _KEY_VAL *HashNext;
   KEY_VAL_INFO KeyValInfo;
   VOID *Value;
-  CHAR16 *ValueToString;
+  TO_STRING_BASE Base;          //base numeric values are rendered in
 }KEY_VAL;
 
+/*
+* Children of a data set sharing one name, in list order
+*/
+typedef struct _CHILD_GROUP {
+  struct _CHILD_GROUP *Next;
+  CHAR16 *Name;
+  UINT32 Count;
+  UINT32 Capacity;
+  struct _DATA_SET **Children;
+}CHILD_GROUP;
+
+/*
+* Children of a data set sharing one name that were released by EvictChildDataSets.
+* Later children of that name keep their instance numbers by skipping Count of them.
+*/
+typedef struct _EVICTED_GROUP {
+  struct _EVICTED_GROUP *Next;
+  CHAR16 *Name;
+  UINT32 Count;
+}EVICTED_GROUP;
+
 typedef struct _DATA_SET {
   LIST_ENTRY Link;
   LIST_ENTRY KeyValueList;
@@ -24,6 +71,11 @@ typedef struct _DATA_SET {
   CHAR16 *Name;
   BOOLEAN Dirty;
   VOID *UserData;
+  KEY_VAL **KeyIndex;           //key/val pairs by interned key, chained through HashNext
+  UINT32 KeyIndexSize;
+  UINT32 KeyCount;
+  CHILD_GROUP **ChildIndex;     //children by interned name, built on first lookup
+  EVICTED_GROUP *Evicted;       //children released by EvictChildDataSets, by name
 }DATA_SET;
 
 typedef struct _DS_NAME_INFO {
@@ -31,6 +83,9 @@ typedef struct _DS_NAME_INFO {
   UINT32 InstanceNum;
 }DS_NAME_INFO;
 
+STATIC INTERNED_STR *mInternedStrs[INTERNED_STR_BUCKETS];
+STATIC CHAR16 mValueStrScratch[VALUE_STR_SCRATCH_LEN];
+
 #define DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, ListHead) \
   for(Entry = (ListHead)->ForwardLink, NextEntry = Entry->ForwardLink; \
       Entry != (ListHead); \
@@ -48,12 +103,279 @@ do { \
     *RetVal = EFI_OUT_OF_RESOURCES; \
     break; \
   } \
-  KeyVal->ValueToString = CatSPrint(NULL, FormatString(ValTypeEnum, Base), *((ValType*)Val)); \
   KeyVal->KeyValInfo.Type = ValTypeEnum; \
+  KeyVal->Base = Base; \
   *RetVal = EFI_SUCCESS; \
 }while(0)
 
 VOID FreeAllKeyValuePairs(DATA_SET *DataSet);
+KEY_VAL * SetKeyValue(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, VOID * Val, UINTN ValSize);
+
+/*
+* Hash a key or data set name
+*/
+STATIC UINT32 HashStr(const CHAR16 *Str) {
+  UINT32 Hash = FNV_OFFSET_BASIS_32;
+  while (*Str) {
+    Hash = (Hash ^ *Str++) * FNV_PRIME_32;
+  }
+  return Hash;
+}
+
+/*
+* Find the interned copy of a string without taking a reference.
+* Returns NULL if no key or data set uses the string.
+*/
+STATIC CHAR16 *FindInternedStr(const CHAR16 *Str) {
+  INTERNED_STR *Interned;
+  UINT32 Hash = HashStr(Str);
+
+  for (Interned = mInternedStrs[Hash & (INTERNED_STR_BUCKETS - 1)]; Interned; Interned = Interned->Next) {
+    if (Interned->Str == Str || (Interned->Hash == Hash && 0 == StrCmp(Interned->Str, Str))) {
+      return Interned->Str;
+    }
+  }
+  return NULL;
+}
+
+/*
+* Take a reference to the interned copy of a string, creating it if needed
+*/
+STATIC CHAR16 *InternStr(const CHAR16 *Str) {
+  INTERNED_STR *Interned;
+  CHAR16 *Existing;
+  UINT32 Hash;
+
+  if (NULL != (Existing = FindInternedStr(Str))) {
+    BASE_CR(Existing, INTERNED_STR, Str)->RefCount++;
+    return Existing;
+  }
+
+  if (NULL == (Interned = (INTERNED_STR*)AllocatePool(OFFSET_OF(INTERNED_STR, Str) + StrSize(Str)))) {
+    return NULL;
+  }
+  Hash = HashStr(Str);
+  CopyMem(Interned->Str, (VOID*)Str, StrSize(Str));
+  Interned->Hash = Hash;
+  Interned->RefCount = 1;
+  Interned->Next = mInternedStrs[Hash & (INTERNED_STR_BUCKETS - 1)];
+  mInternedStrs[Hash & (INTERNED_STR_BUCKETS - 1)] = Interned;
+  return Interned->Str;
+}
+
+/*
+* Drop a reference taken by InternStr, freeing the string with the last one
+*/
+STATIC VOID ReleaseInternedStr(CHAR16 *Str) {
+  INTERNED_STR *Interned;
+  INTERNED_STR **Prev;
+
+  if (NULL == Str) {
+    return;
+  }
+  Interned = BASE_CR(Str, INTERNED_STR, Str);
+  if (--Interned->RefCount > 0) {
+    return;
+  }
+  for (Prev = &mInternedStrs[Interned->Hash & (INTERNED_STR_BUCKETS - 1)]; *Prev; Prev = &(*Prev)->Next) {
+    if (*Prev == Interned) {
+      *Prev = Interned->Next;
+      break;
+    }
+  }
+  FreePool(Interned);
+}
+
+/*
+* Bucket of an interned key in a key index of Size buckets
+*/
+STATIC UINT32 KeyBucket(const CHAR16 *InternedKey, UINT32 Size) {
+  return BASE_CR(InternedKey, INTERNED_STR, Str)->Hash & (Size - 1);
+}
+
+/*
+* Add a key/val pair to the key index of a data set, growing the index to
+* keep chains short
+*/
+STATIC EFI_STATUS KeyIndexInsert(DATA_SET *DataSet, KEY_VAL *KeyVal) {
+  KEY_VAL **NewIndex;
+  KEY_VAL *Entry;
+  KEY_VAL *Next;
+  UINT32 NewSize;
+  UINT32 Index;
+
+  if (DataSet->KeyCount >= DataSet->KeyIndexSize) {
+    NewSize = DataSet->KeyIndexSize ? DataSet->KeyIndexSize * 2 : KEY_INDEX_MIN_BUCKETS;
+    if (NULL == (NewIndex = (KEY_VAL**)ArenaAllocateZeroPool(NewSize * sizeof(*NewIndex)))) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    for (Index = 0; Index < DataSet->KeyIndexSize; ++Index) {
+      for (Entry = DataSet->KeyIndex[Index]; Entry; Entry = Next) {
+        Next = Entry->HashNext;
+        Entry->HashNext = NewIndex[KeyBucket(Entry->KeyValInfo.Key, NewSize)];
+        NewIndex[KeyBucket(Entry->KeyValInfo.Key, NewSize)] = Entry;
+      }
+    }
+    ARENA_FREE_POOL_SAFE(DataSet->KeyIndex);
+    DataSet->KeyIndex = NewIndex;
+    DataSet->KeyIndexSize = NewSize;
+  }
+
+  Index = KeyBucket(KeyVal->KeyValInfo.Key, DataSet->KeyIndexSize);
+  KeyVal->HashNext = DataSet->KeyIndex[Index];
+  DataSet->KeyIndex[Index] = KeyVal;
+  DataSet->KeyCount++;
+  return EFI_SUCCESS;
+}
+
+/*
+* Free the child index of a data set.  It is rebuilt on the next lookup.
+*/
+STATIC VOID FreeChildIndex(DATA_SET *DataSet) {
+  CHILD_GROUP *Group;
+  CHILD_GROUP *Next;
+  UINT32 Index;
+
+  if (NULL == DataSet || NULL == DataSet->ChildIndex) {
+    return;
+  }
+  for (Index = 0; Index < CHILD_INDEX_BUCKETS; ++Index) {
+    for (Group = DataSet->ChildIndex[Index]; Group; Group = Next) {
+      Next = Group->Next;
+      ARENA_FREE_POOL_SAFE(Group->Children);
+      ArenaFreePool(Group);
+    }
+  }
+  ARENA_FREE_POOL_SAFE(DataSet->ChildIndex);
+}
+
+/*
+* Append a child to the group of its name in the parent's child index
+*/
+STATIC EFI_STATUS ChildIndexAppend(DATA_SET *Parent, DATA_SET *Child) {
+  CHILD_GROUP *Group;
+  CHILD_GROUP **Bucket;
+  DATA_SET **NewChildren;
+  UINT32 NewCapacity;
+
+  Bucket = &Parent->ChildIndex[KeyBucket(Child->Name, CHILD_INDEX_BUCKETS)];
+  for (Group = *Bucket; Group && Group->Name != Child->Name; Group = Group->Next);
+
+  if (NULL == Group) {
+    if (NULL == (Group = (CHILD_GROUP*)ArenaAllocateZeroPool(sizeof(*Group)))) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Group->Name = Child->Name;
+    Group->Next = *Bucket;
+    *Bucket = Group;
+  }
+
+  if (Group->Count == Group->Capacity) {
+    NewCapacity = Group->Capacity ? Group->Capacity * 2 : CHILD_GROUP_MIN_SIZE;
+    if (NULL == (NewChildren = (DATA_SET**)ArenaAllocatePool(NewCapacity * sizeof(*NewChildren)))) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    if (Group->Children) {
+      CopyMem(NewChildren, Group->Children, Group->Count * sizeof(*NewChildren));
+      ArenaFreePool(Group->Children);
+    }
+    Group->Children = NewChildren;
+    Group->Capacity = NewCapacity;
+  }
+  Group->Children[Group->Count++] = Child;
+  return EFI_SUCCESS;
+}
+
+/*
+* Record a child appended to the parent's list.  A failure drops the index,
+* which is rebuilt from the list on the next lookup.
+*/
+STATIC VOID ChildIndexAdd(DATA_SET *Parent, DATA_SET *Child) {
+  if (NULL != Parent->ChildIndex && EFI_ERROR(ChildIndexAppend(Parent, Child))) {
+    FreeChildIndex(Parent);
+  }
+}
+
+/*
+* Build the child index of a data set from its list of children
+*/
+STATIC EFI_STATUS BuildChildIndex(DATA_SET *Parent) {
+  LIST_ENTRY  *Entry;
+  LIST_ENTRY  *NextEntry;
+
+  if (NULL == (Parent->ChildIndex = (CHILD_GROUP**)ArenaAllocateZeroPool(CHILD_INDEX_BUCKETS * sizeof(CHILD_GROUP*)))) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, &Parent->DataSetList) {
+    if (EFI_ERROR(ChildIndexAppend(Parent, BASE_CR(Entry, DATA_SET, Link)))) {
+      FreeChildIndex(Parent);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+  return EFI_SUCCESS;
+}
+
+/*
+* Number of children with an interned name released from a data set by EvictChildDataSets
+*/
+STATIC UINT32 EvictedChildCount(DATA_SET *Parent, CHAR16 *InternedName) {
+  EVICTED_GROUP *Group;
+
+  for (Group = Parent->Evicted; Group; Group = Group->Next) {
+    if (Group->Name == InternedName) {
+      return Group->Count;
+    }
+  }
+  return 0;
+}
+
+/*
+* Count a child about to be released by EvictChildDataSets
+*/
+STATIC EFI_STATUS EvictedChildAdd(DATA_SET *Parent, DATA_SET *Child) {
+  EVICTED_GROUP *Group;
+
+  for (Group = Parent->Evicted; Group && Group->Name != Child->Name; Group = Group->Next);
+
+  if (NULL == Group) {
+    if (NULL == (Group = (EVICTED_GROUP*)ArenaAllocateZeroPool(sizeof(*Group)))) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    //the name outlives the child, keep a reference to it
+    Group->Name = InternStr(Child->Name);
+    Group->Next = Parent->Evicted;
+    Parent->Evicted = Group;
+  }
+  Group->Count++;
+  return EFI_SUCCESS;
+}
+
+/*
+* Free the evicted child counts of a data set
+*/
+STATIC VOID FreeEvictedChildren(DATA_SET *DataSet) {
+  EVICTED_GROUP *Group;
+  EVICTED_GROUP *Next;
+
+  for (Group = DataSet->Evicted; Group; Group = Next) {
+    Next = Group->Next;
+    ReleaseInternedStr(Group->Name);
+    ArenaFreePool(Group);
+  }
+  DataSet->Evicted = NULL;
+}
+
+/*
+* Was the Index instance of a child name released by EvictChildDataSets?
+*/
+STATIC BOOLEAN IsEvictedChild(DATA_SET *Parent, CHAR16 *Name, UINT32 Index) {
+  CHAR16 *InternedName;
+
+  if (NULL == Parent->Evicted || NULL == (InternedName = FindInternedStr(Name))) {
+    return FALSE;
+  }
+  return Index < EvictedChildCount(Parent, InternedName);
+}
 
 /*
 * Set all data sets in the ancestry path to dirty.
@@ -73,10 +395,37 @@ DATA_SET * FindChildDataSetByIndex(DATA_SET *Parent, CHAR16 *Name, UINT32 Index)
   LIST_ENTRY  *Entry;
   LIST_ENTRY  *NextEntry;
   DATA_SET    *DataSet;
+  CHILD_GROUP *Group;
+  CHAR16      *InternedName;
+  UINT32      Evicted;
 
+  //a name no data set uses cannot match any child
+  if (NULL == (InternedName = FindInternedStr(Name))) {
+    return NULL;
+  }
+
+  //instances released by EvictChildDataSets are no longer in the list
+  if (NULL != Parent->Evicted) {
+    Evicted = EvictedChildCount(Parent, InternedName);
+    if (Index < Evicted) {
+      return NULL;
+    }
+    Index -= Evicted;
+  }
+
+  if (NULL != Parent->ChildIndex || !EFI_ERROR(BuildChildIndex(Parent))) {
+    for (Group = Parent->ChildIndex[KeyBucket(InternedName, CHILD_INDEX_BUCKETS)]; Group; Group = Group->Next) {
+      if (Group->Name == InternedName) {
+        return (Index < Group->Count) ? Group->Children[Index] : NULL;
+      }
+    }
+    return NULL;
+  }
+
+  //out of memory for the index, fall back to walking the list
   DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, &Parent->DataSetList) {
     DataSet = BASE_CR(Entry, DATA_SET, Link);
-    if(0 == StrCmp(Name, DataSet->Name)) {
+    if (InternedName == DataSet->Name) {
       if (0 == Index) {
         return DataSet;
       }
@@ -96,12 +445,11 @@ VOID FreeDataSetMem(DATA_SET *DataSet) {
     }
 
     FreeAllKeyValuePairs(DataSet);
+    FreeChildIndex(DataSet);
+    FreeEvictedChildren(DataSet);
+    ReleaseInternedStr(DataSet->Name);
 
-    if(DataSet->Name) {
-      FreePool(DataSet->Name);
-    }
-
-    FreePool(DataSet);
+    ArenaFreePool(DataSet);
   }
 
 /*
@@ -122,10 +470,41 @@ VOID FreeAllDataSets(DATA_SET *DataSet) {
   }
   if(!IsListEmpty(&DataSet->Link)) {
     RemoveEntryList(&DataSet->Link);
+    FreeChildIndex(DataSet->DataSetParent);
   }
   FreeDataSetMem(DataSet);
 }
 
+/*
+* Free every child data set, counting them so children added later keep their
+* instance numbers.  A child that cannot be counted is emptied and kept instead.
+*/
+VOID EvictChildDataSets(DATA_SET_CONTEXT *DataSetCtx) {
+  LIST_ENTRY  *Entry;
+  LIST_ENTRY  *NextEntry;
+  LIST_ENTRY  *GrandChildEntry;
+  LIST_ENTRY  *NextGrandChildEntry;
+  DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
+  DATA_SET *ChildDataSet;
+
+  if (NULL == DataSet) {
+    return;
+  }
+
+  DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, &DataSet->DataSetList) {
+    ChildDataSet = BASE_CR(Entry, DATA_SET, Link);
+    if (!EFI_ERROR(EvictedChildAdd(DataSet, ChildDataSet))) {
+      FreeAllDataSets(ChildDataSet);
+      continue;
+    }
+    DATA_SET_LIST_FOR_EACH_SAFE(GrandChildEntry, NextGrandChildEntry, &ChildDataSet->DataSetList) {
+      FreeAllDataSets(BASE_CR(GrandChildEntry, DATA_SET, Link));
+    }
+    FreeAllKeyValuePairs(ChildDataSet);
+    ChildDataSet->Dirty = FALSE;
+  }
+}
+
 /*
 * Create a new data set structure
 */
@@ -141,12 +520,12 @@ DATA_SET_CONTEXT* CreateDataSet(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *Name, VOID
     return NULL;
   }*/
 
-  if (NULL == (NewDataSet = (DATA_SET*)AllocateZeroPool(sizeof(DATA_SET)))) {
+  if (NULL == (NewDataSet = (DATA_SET*)ArenaAllocateZeroPool(sizeof(DATA_SET)))) {
     return NULL;
   }
 
-  if (NULL == (NewDataSet->Name = CatSPrint(NULL, Name))) {
-    FreePool(NewDataSet);
+  if (NULL == (NewDataSet->Name = InternStr(Name))) {
+    ArenaFreePool(NewDataSet);
     return NULL;
   }
 
@@ -159,6 +538,7 @@ DATA_SET_CONTEXT* CreateDataSet(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *Name, VOID
   if (DataSetCtx) {
     InsertTailList(&ParentCtx->DataSetList, &NewDataSet->Link);
     NewDataSet->DataSetParent = (VOID*)ParentCtx;
+    ChildIndexAdd(ParentCtx, NewDataSet);
   }
   else {
     InitializeListHead(&NewDataSet->Link);
@@ -168,39 +548,40 @@ DATA_SET_CONTEXT* CreateDataSet(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *Name, VOID
 }
 
 /*
-* Helper for GetDataSet
+* Helper for GetDataSet.  Splits Name[Instance] in place, NameInfo->Name points into Name.
 */
 VOID GetDataSetNameInfo(CHAR16 *Name, DS_NAME_INFO *NameInfo) {
-  CHAR16 **Toks = NULL;
-  CHAR16 **ToksSecondHalf;
-  UINT32 NumToks = 0;
-  UINT32 NumToksSecondHalf = 0;
+  CHAR16 *Bracket;
 
-  if (NULL == (Toks = StrSplit(Name, L'[', &NumToks))) {
-    return;
-  }
+  NameInfo->Name = Name;
+  NameInfo->InstanceNum = 0;
 
-  if (1 == NumToks) {
-    NameInfo->Name = CatSPrint(NULL, Name);
-    NameInfo->InstanceNum = 0;
-  }
-  else {
-    NameInfo->Name = CatSPrint(NULL, Toks[0]);
-    if (NULL != (ToksSecondHalf = StrSplit(Toks[1], L']', &NumToksSecondHalf))) {
-      NameInfo->InstanceNum = (UINT32)StrDecimalToUint64(ToksSecondHalf[0]);
-      FreeStringArray(ToksSecondHalf, NumToksSecondHalf);
-    }
+  for (Bracket = Name; *Bracket && *Bracket != L'['; ++Bracket);
+  if (*Bracket) {
+    *Bracket = L'\0';
+    NameInfo->InstanceNum = (UINT32)StrDecimalToUint64(Bracket + 1);
   }
-  FreeStringArray(Toks, NumToks);
 }
 
 /*
-* Helper for GetDataSet.  Frees memory allocated by GetDataSetNameInfo.
+* Helper for GetDataSet.  Terminates the path segment at *Path and returns it,
+* advancing *Path to the next segment or NULL after the last one.
 */
-void FreeDataSetNameInfo(DS_NAME_INFO *NameInfo) {
-  if (NULL != NameInfo->Name) {
-    FreePool(NameInfo->Name);
+CHAR16 * NextDataSetPathSegment(CHAR16 **Path) {
+  CHAR16 *Segment = *Path;
+  CHAR16 *Delim;
+
+  for (Delim = Segment; *Delim && *Delim != L'/'; ++Delim);
+  if (*Delim && *(Delim + 1)) {
+    *Delim = L'\0';
+    *Path = Delim + 1;
+  }
+  else {
+    //a trailing delimiter does not start another segment
+    *Delim = L'\0';
+    *Path = NULL;
   }
+  return Segment;
 }
 
 /*
@@ -209,63 +590,57 @@ void FreeDataSetNameInfo(DS_NAME_INFO *NameInfo) {
 DATA_SET_CONTEXT *
 EFIAPI
 GetDataSet(DATA_SET_CONTEXT *Root, CHAR16 *NamePath, ...) {
-  CHAR16 **DataSetToks = NULL;
-  UINT32 NumDataSetToks = 0;
-  UINT32 Index = 0;
+  CHAR16 *Path = NULL;
   DATA_SET *TempDataSet = (DATA_SET*)Root;
   DATA_SET *TempCreateNewDataSet = NULL;
   DS_NAME_INFO NameInfo;
   CHAR16 *FormattedNamePath;
   VA_LIST Args;
-  UINT32 CreateIndex = 0;
 
   ++NamePath;
   VA_START(Args, NamePath);
-  FormattedNamePath = CatVSPrint(NULL, NamePath, Args);
+  FormattedNamePath = ArenaCatVSPrint(NULL, NamePath, Args);
   VA_END(Args);
 
   if (NULL == FormattedNamePath) {
     return NULL;
   }
-
-  //split path, result toks are data set names
-  if (NULL == (DataSetToks = StrSplit(FormattedNamePath, L'/', &NumDataSetToks))) {
-    FreePool(FormattedNamePath);
+  if (L'\0' == FormattedNamePath[0]) {
+    ArenaFreePool(FormattedNamePath);
     return NULL;
   }
-  FreePool(FormattedNamePath);
 
-  //Root data set must match first tok
-  //All other toks that don't exist will be created
-  GetDataSetNameInfo(DataSetToks[0], &NameInfo);
+  //Root data set must match first segment
+  //All other segments that don't exist will be created
+  Path = FormattedNamePath;
+  GetDataSetNameInfo(NextDataSetPathSegment(&Path), &NameInfo);
   if (StrCmp(NameInfo.Name, GetDataSetName(Root))) {
     TempDataSet = NULL;
-    FreeDataSetNameInfo(&NameInfo);
     goto Finish;
   }
-  FreeDataSetNameInfo(&NameInfo);
   //iterate through all data set names under the root
   //path: /sensorlist/dimm/sensor
-  //iterated toks: dimm, sensor
+  //iterated segments: dimm, sensor
   //create data sets that don't exist
-  for (Index = 1; Index < NumDataSetToks; ++Index) {
+  while (NULL != Path) {
     //get info about current data set
-    GetDataSetNameInfo(DataSetToks[Index], &NameInfo);
-    for (CreateIndex = 0; CreateIndex <= NameInfo.InstanceNum; ++CreateIndex) {
-      if (NULL == (TempCreateNewDataSet = FindChildDataSetByIndex(TempDataSet, NameInfo.Name, NameInfo.InstanceNum))) {
-        //create a new data set and add it to the end
-        if (NULL == (TempCreateNewDataSet = CreateDataSet(TempDataSet, NameInfo.Name, NULL))) {
-          TempDataSet = NULL;
-          FreeDataSetNameInfo(&NameInfo);
-          goto Finish;
-        }
+    GetDataSetNameInfo(NextDataSetPathSegment(&Path), &NameInfo);
+    //a streamed record that was already printed and released cannot be recreated
+    if (IsEvictedChild(TempDataSet, NameInfo.Name, NameInfo.InstanceNum)) {
+      TempDataSet = NULL;
+      goto Finish;
+    }
+    //create data sets and add them to the end until the requested instance exists
+    while (NULL == (TempCreateNewDataSet = FindChildDataSetByIndex(TempDataSet, NameInfo.Name, NameInfo.InstanceNum))) {
+      if (NULL == CreateDataSet(TempDataSet, NameInfo.Name, NULL)) {
+        TempDataSet = NULL;
+        goto Finish;
       }
     }
-    FreeDataSetNameInfo(&NameInfo);
     TempDataSet = TempCreateNewDataSet;
   }
 Finish:
-  FreeStringArray(DataSetToks, NumDataSetToks);
+  ArenaFreePool(FormattedNamePath);
   return TempDataSet;
 }
 
@@ -330,7 +705,7 @@ VOID RecurseDataSetInternal(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, DataS
     return;
   }
 
-  NewPath = CatSPrint(CurPath, L"/" FORMAT_STR, GetDataSetName(DataSetCtx));
+  NewPath = ArenaCatSPrint(CurPath, L"/" FORMAT_STR, GetDataSetName(DataSetCtx));
   TempCallBackRetVal = CallBackRoutine(DataSetCtx, NewPath, UserData, CallbackData);
 
   DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, &DataSet->DataSetList) {
@@ -343,11 +718,11 @@ VOID RecurseDataSetInternal(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, DataS
   }
 
   if (NewPath) {
-    FreePool(NewPath);
+    ArenaFreePool(NewPath);
   }
 
   if (TempCallBackRetVal) {
-    FreePool(TempCallBackRetVal);
+    ArenaFreePool(TempCallBackRetVal);
   }
 }
 
@@ -374,6 +749,8 @@ VOID AddChildDataSet(DATA_SET_CONTEXT *Root, DATA_SET_CONTEXT *Child) {
   DATA_SET *ChildDataSet = (DATA_SET*)Child;
   if (NULL != Root && NULL != Child) {
     InsertTailList(&RootDataSet->DataSetList, &ChildDataSet->Link);
+    ChildDataSet->DataSetParent = (VOID*)RootDataSet;
+    ChildIndexAdd(RootDataSet, ChildDataSet);
   }
 }
 
@@ -382,11 +759,12 @@ VOID AddChildDataSet(DATA_SET_CONTEXT *Root, DATA_SET_CONTEXT *Child) {
 */
 VOID SetDataSetName(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *Name) {
   DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
-  if (DataSet) {
-    if (DataSet->Name) {
-      FreePool(DataSet->Name);
-    }
-    DataSet->Name = CatSPrint(NULL, Name);
+  CHAR16 *NewName = NULL;
+  if (DataSet && NULL != (NewName = InternStr(Name))) {
+    ReleaseInternedStr(DataSet->Name);
+    DataSet->Name = NewName;
+    //the child's position among same named siblings changed
+    FreeChildIndex(DataSet->DataSetParent);
   }
 }
 
@@ -399,12 +777,12 @@ CHAR16 * GetDataSetName(DATA_SET_CONTEXT *DataSetCtx) {
 }
 
 /*
-* set the user's data to the corresponding data set (UserData must be allocated by AllocatePool)
+* set the user's data to the corresponding data set (UserData must be allocated by AllocatePool or ArenaAllocatePool)
 */
 VOID SetDataSetUserData(DATA_SET_CONTEXT *DataSetCtx, VOID *UserData) {
   DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
   if(DataSet->UserData) {
-    FreePool(DataSet->UserData);
+    ArenaFreePool(DataSet->UserData);
   }
   DataSet->UserData = UserData;
 }
@@ -417,6 +795,27 @@ VOID * GetDataSetUserData(DATA_SET_CONTEXT *DataSetCtx) {
   return DataSet->UserData;
 }
 
+/*
+* Copy a key/val pair into another data set keeping its type and base, so
+* numeric values are not rendered to strings and back.
+*/
+STATIC VOID CopyKeyValue(DATA_SET_CONTEXT *DataSetCtx, KEY_VAL_INFO *KvInfo) {
+  KEY_VAL *SrcKeyVal = BASE_CR(KvInfo, KEY_VAL, KeyValInfo);
+  KEY_VAL *KeyVal = NULL;
+  UINTN ValSize = KvInfo->ValueSize;
+
+  if (NULL == SrcKeyVal->Value) {
+    return;
+  }
+  if (KEY_W_STR == KvInfo->Type) {
+    ValSize = StrSize((CHAR16*)SrcKeyVal->Value);
+  }
+  if (NULL != (KeyVal = SetKeyValue(DataSetCtx, KvInfo->Key, SrcKeyVal->Value, ValSize))) {
+    KeyVal->KeyValInfo.Type = KvInfo->Type;
+    KeyVal->Base = SrcKeyVal->Base;
+  }
+}
+
 /*
 * Callback routine for squash operation
 */
@@ -424,34 +823,26 @@ VOID * SquashDataSetCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *User
   DATA_SET_CONTEXT *RootDataSet = (DATA_SET_CONTEXT*)UserData;
   DATA_SET_CONTEXT *NewDataSet = NULL;
   KEY_VAL_INFO *KvInfo = NULL;
-  CHAR16 *Val = NULL;
 
   if (NULL == UserData) {
     return NULL;
   }
 
   if (IsLeaf(DataSetCtx)) {
-    NewDataSet = CreateDataSet(RootDataSet, GetDataSetName(DataSetCtx), NULL);
+    if (NULL == (NewDataSet = CreateDataSet(RootDataSet, GetDataSetName(DataSetCtx), NULL))) {
+      return NULL;
+    }
     while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
-      GetKeyValueWideStr(DataSetCtx, KvInfo->Key, &Val, NULL);
-      if (Val) {
-        SetKeyValueWideStr(NewDataSet, KvInfo->Key, Val);
-      }
+      CopyKeyValue(NewDataSet, KvInfo);
     }
     KvInfo = NULL;
     while (NULL != (KvInfo = GetNextKey(RootDataSet, KvInfo))) {
-      GetKeyValueWideStr(RootDataSet, KvInfo->Key, &Val, NULL);
-      if (Val) {
-        SetKeyValueWideStr(NewDataSet, KvInfo->Key, Val);
-      }
+      CopyKeyValue(NewDataSet, KvInfo);
     }
   }
   else {
     while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
-      GetKeyValueWideStr(DataSetCtx, KvInfo->Key, &Val, NULL);
-      if (Val) {
-        SetKeyValueWideStr(RootDataSet, KvInfo->Key, Val);
-      }
+      CopyKeyValue(RootDataSet, KvInfo);
     }
   }
   return NULL;
@@ -517,16 +908,19 @@ CHAR16 * FormatString(KEY_TYPE KeyType, TO_STRING_BASE Base) {
 }
 
 /*
-* Helper to locate a child node with a particular name
+* Helper to locate a key/val pair with a particular key
 */
 KEY_VAL * FindKeyValuePair(DATA_SET *DataSet, const CHAR16 *Key) {
-  LIST_ENTRY  *Entry;
-  LIST_ENTRY  *NextEntry;
   KEY_VAL *KeyVal;
+  CHAR16 *InternedKey;
 
-  DATA_SET_LIST_FOR_EACH_SAFE(Entry, NextEntry, &DataSet->KeyValueList) {
-    KeyVal = BASE_CR(Entry, KEY_VAL, Link);
-    if (0 == StrCmp(Key, KeyVal->KeyValInfo.Key)) {
+  //a key no data set uses cannot be in this one
+  if (0 == DataSet->KeyCount || NULL == (InternedKey = FindInternedStr(Key))) {
+    return NULL;
+  }
+
+  for (KeyVal = DataSet->KeyIndex[KeyBucket(InternedKey, DataSet->KeyIndexSize)]; KeyVal; KeyVal = KeyVal->HashNext) {
+    if (InternedKey == KeyVal->KeyValInfo.Key) {
       return KeyVal;
     }
   }
@@ -540,19 +934,14 @@ VOID FreeKeyValMem(KEY_VAL *KeyVal) {
   if (NULL == KeyVal) {
     return;
   }
-  if (KeyVal->KeyValInfo.Key) {
-    FreePool(KeyVal->KeyValInfo.Key);
-  }
-  if ((KeyVal->ValueToString) && (KeyVal->ValueToString != KeyVal->Value)) {
-    FreePool(KeyVal->ValueToString);
-  }
+  ReleaseInternedStr(KeyVal->KeyValInfo.Key);
   if (KeyVal->Value) {
-    FreePool(KeyVal->Value);
+    ArenaFreePool(KeyVal->Value);
   }
   if (KeyVal->KeyValInfo.UserData) {
-    FreePool(KeyVal->KeyValInfo.UserData);
+    ArenaFreePool(KeyVal->KeyValInfo.UserData);
   }
-  FreePool(KeyVal);
+  ArenaFreePool(KeyVal);
 }
 
 /*
@@ -568,17 +957,29 @@ VOID FreeAllKeyValuePairs(DATA_SET *DataSet) {
     RemoveEntryList(&KeyVal->Link);
     FreeKeyValMem(KeyVal);
   }
+  ARENA_FREE_POOL_SAFE(DataSet->KeyIndex);
+  DataSet->KeyIndexSize = 0;
+  DataSet->KeyCount = 0;
 }
 
 /*
 * Create a new keyval struct
 */
-KEY_VAL * CreateKeyVal(DATA_SET_CONTEXT *DataSetCtx) {
+KEY_VAL * CreateKeyVal(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key) {
   DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
-  KEY_VAL *KeyVal = (KEY_VAL*)AllocateZeroPool(sizeof(KEY_VAL));
+  KEY_VAL *KeyVal = (KEY_VAL*)ArenaAllocateZeroPool(sizeof(KEY_VAL));
   if(NULL == KeyVal) {
     return NULL;
   }
+  if (NULL == (KeyVal->KeyValInfo.Key = InternStr(Key))) {
+    ArenaFreePool(KeyVal);
+    return NULL;
+  }
+  if (EFI_ERROR(KeyIndexInsert(DataSet, KeyVal))) {
+    ReleaseInternedStr(KeyVal->KeyValInfo.Key);
+    ArenaFreePool(KeyVal);
+    return NULL;
+  }
   InsertTailList(&DataSet->KeyValueList, &KeyVal->Link);
   return KeyVal;
 }
@@ -597,12 +998,12 @@ EFI_STATUS EFIAPI SetKeyValueWideStrFormat(DATA_SET_CONTEXT *DataSetCtx, const C
   }
 
   VA_START(Marker, Val);
-  TempMsg = CatVSPrint(NULL, Val, Marker);
+  TempMsg = ArenaCatVSPrint(NULL, Val, Marker);
   VA_END(Marker);
 
   RetCode = SetKeyValueWideStr(DataSetCtx, Key, TempMsg);
 
-  FREE_POOL_SAFE(TempMsg);
+  ARENA_FREE_POOL_SAFE(TempMsg);
   return RetCode;
 }
 
@@ -621,30 +1022,69 @@ EFI_STATUS SetKeyValueWideStr(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, c
   //first try to find the key, but if not found create a new key/value entry
   //and set the name of the key
   if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key))) {
-    if (NULL == (KeyVal = CreateKeyVal(DataSet))) {
+    if (NULL == (KeyVal = CreateKeyVal(DataSet, Key))) {
       return EFI_OUT_OF_RESOURCES;
     }
-    KeyVal->KeyValInfo.Key = CatSPrint(NULL, Key);
   }
-  //found the key, now free previous values (string and actual value)
+  //found the key, now free the previous value
   else {
-    if ((KeyVal->ValueToString) && (KeyVal->ValueToString != KeyVal->Value)) {
-      FreePool(KeyVal->ValueToString);
-    }
-
     if (KeyVal->Value) {
-      FreePool(KeyVal->Value);
+      ArenaFreePool(KeyVal->Value);
     }
   }
 
-  if (NULL == (KeyVal->Value = AllocatePool(StrSize(Val)))) {
+  if (NULL == (KeyVal->Value = ArenaAllocatePool(StrSize(Val)))) {
     return EFI_OUT_OF_RESOURCES;
   }
   CopyMem(KeyVal->Value, (VOID*)Val, StrSize(Val));
-  KeyVal->ValueToString = KeyVal->Value;
+  KeyVal->KeyValInfo.Type = KEY_W_STR;
   SetAncestorsDirty(DataSetCtx);
   return EFI_SUCCESS;
 }
+/*
+* Render the value of a key/val pair.  Strings are returned as stored, other
+* types are rendered into a scratch buffer reused by the next call.
+*/
+STATIC CHAR16 * KeyValToString(KEY_VAL *KeyVal) {
+  CHAR16 *Format = FormatString(KeyVal->KeyValInfo.Type, KeyVal->Base);
+  UINTN Size = sizeof(mValueStrScratch);
+
+  switch (KeyVal->KeyValInfo.Type) {
+  case KEY_W_STR:
+    return (CHAR16*)KeyVal->Value;
+  case KEY_BOOL:
+    UnicodeSPrint(mValueStrScratch, Size, FORMAT_STR, *((BOOLEAN*)KeyVal->Value) ? BOOL_TRUE_STR : BOOL_FALSE_STR);
+    break;
+  case KEY_UINT64:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((UINT64*)KeyVal->Value));
+    break;
+  case KEY_INT64:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((INT64*)KeyVal->Value));
+    break;
+  case KEY_UINT32:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((UINT32*)KeyVal->Value));
+    break;
+  case KEY_INT32:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((INT32*)KeyVal->Value));
+    break;
+  case KEY_UINT16:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((UINT16*)KeyVal->Value));
+    break;
+  case KEY_INT16:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((INT16*)KeyVal->Value));
+    break;
+  case KEY_UINT8:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((UINT8*)KeyVal->Value));
+    break;
+  case KEY_INT8:
+    UnicodeSPrint(mValueStrScratch, Size, Format, *((INT8*)KeyVal->Value));
+    break;
+  default:
+    return NULL;
+  }
+  return mValueStrScratch;
+}
+
 /*
 * Retrieve a unicode string from the data set.
 */
@@ -656,15 +1096,35 @@ EFI_STATUS GetKeyValueWideStr(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, C
     return EFI_INVALID_PARAMETER;
   }
 
-  if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key))) {
+  if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key)) || NULL == KeyVal->Value) {
     *Val = DefaultVal;
   }
   else {
-    *Val = KeyVal->ValueToString;
+    *Val = KeyValToString(KeyVal);
   }
   return EFI_SUCCESS;
 }
 
+/*
+* Retrieve the stored value of a key without rendering it to a string.
+* The value is owned by the data set and its type is the KEY_VAL_INFO Type.
+*/
+EFI_STATUS GetKeyValueRaw(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, VOID **Val, TO_STRING_BASE *Base) {
+  DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
+  KEY_VAL *KeyVal = NULL;
+
+  if (NULL == Key || NULL == Val || NULL == Base || NULL == DataSet) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key)) || NULL == KeyVal->Value) {
+    return EFI_NOT_FOUND;
+  }
+  *Val = KeyVal->Value;
+  *Base = KeyVal->Base;
+  return EFI_SUCCESS;
+}
+
 /*
 * Helper to set all primitive types
 */
@@ -677,21 +1137,16 @@ KEY_VAL * SetKeyValue(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, VOID * Va
   }
 
   if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key))) {
-    if (NULL == (KeyVal = CreateKeyVal(DataSet))) {
+    if (NULL == (KeyVal = CreateKeyVal(DataSet, Key))) {
       return NULL;
     }
-    KeyVal->KeyValInfo.Key = CatSPrint(NULL, Key);
   }
   else {
-    if ((KeyVal->ValueToString) && (KeyVal->ValueToString != KeyVal->Value)) {
-      FreePool(KeyVal->ValueToString);
-    }
-
     if (KeyVal->Value) {
-      FreePool(KeyVal->Value);
+      ArenaFreePool(KeyVal->Value);
     }
   }
-  KeyVal->Value = AllocatePool(ValSize);
+  KeyVal->Value = ArenaAllocatePool(ValSize);
   if(KeyVal->Value) {
     CopyMem(KeyVal->Value, Val, ValSize);
   }
@@ -732,32 +1187,27 @@ EFI_STATUS GetKeyValue(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, VOID *Va
 EFI_STATUS SetKeyValueBool(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, BOOLEAN Val) {
   DATA_SET *DataSet = (DATA_SET*)DataSetCtx;
   KEY_VAL *KeyVal = NULL;
-  const CHAR16 *BoolVal = Val ? BOOL_TRUE_STR : BOOL_FALSE_STR;
 
   if (NULL == Key || NULL == DataSet) {
     return EFI_INVALID_PARAMETER;
   }
 
   if (NULL == (KeyVal = FindKeyValuePair(DataSet, Key))) {
-    if (NULL == (KeyVal = CreateKeyVal(DataSet))) {
+    if (NULL == (KeyVal = CreateKeyVal(DataSet, Key))) {
       return EFI_OUT_OF_RESOURCES;
     }
-    KeyVal->KeyValInfo.Key = CatSPrint(NULL, Key);
   }
   else {
-    if ((KeyVal->ValueToString) && (KeyVal->ValueToString != KeyVal->Value)) {
-      FreePool(KeyVal->ValueToString);
-    }
-
     if (KeyVal->Value) {
-      FreePool(KeyVal->Value);
+      ArenaFreePool(KeyVal->Value);
     }
   }
-  if (NULL == (KeyVal->Value = AllocatePool(sizeof(BOOLEAN)))) {
+  if (NULL == (KeyVal->Value = ArenaAllocatePool(sizeof(BOOLEAN)))) {
     return EFI_OUT_OF_RESOURCES;
   }
   CopyMem(KeyVal->Value, (VOID*)&Val, sizeof(BOOLEAN));
-  KeyVal->ValueToString = CatSPrint(NULL, BoolVal);
+  KeyVal->KeyValInfo.ValueSize = sizeof(BOOLEAN);
+  KeyVal->KeyValInfo.Type = KEY_BOOL;
   SetAncestorsDirty(DataSetCtx);
   return EFI_SUCCESS;
 }
@@ -930,14 +1380,9 @@ KEY_VAL_INFO * GetNextKey(DATA_SET_CONTEXT *DataSetCtx, KEY_VAL_INFO *KeyInfo) {
 * Get the number of key/val pairs in a data set.
 */
 UINT32 GetKeyCount(DATA_SET_CONTEXT *DataSetCtx) {
-  KEY_VAL_INFO * pKeyInfo = NULL;
-  UINT32 Count = 0;
-
-  while (NULL != (pKeyInfo = GetNextKey(DataSetCtx, pKeyInfo))) {
-    ++Count;
-  }
+  DATA_SET *DataSet = (DATA_SET *)DataSetCtx;
 
-  return Count;
+  return DataSet->KeyCount;
 }
 
 /*
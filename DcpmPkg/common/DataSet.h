@@ -33,6 +33,12 @@
 #define CHANNEL_NODE_STR      L"Channel"
 #define SLOT_NODE_STR         L"Slot"
 
+/*
+* FNV-1a parameters used to hash key and data set names
+*/
+#define FNV_OFFSET_BASIS_32   0x811C9DC5
+#define FNV_PRIME_32          0x01000193
+
 /*
 * Types of values supported in DataSets.
 */
@@ -95,6 +101,11 @@ BOOLEAN IsLeaf(DATA_SET_CONTEXT *DataSetCtx);
 */
 VOID FreeDataSet(DATA_SET_CONTEXT *DataSetCtx);
 /*
+* Free all children of a streamed data set once they are printed.
+* Children added afterwards keep the instance numbers they would have had.
+*/
+VOID EvictChildDataSets(DATA_SET_CONTEXT *DataSetCtx);
+/*
 * Retrieve a data set by specifying a path in the form of /sensorlist/dimm[0]/sensor[1]
 */
 DATA_SET_CONTEXT * EFIAPI GetDataSet(DATA_SET_CONTEXT *Root, CHAR16 *NamePath, ...);
@@ -175,10 +186,16 @@ EFI_STATUS SetKeyValueUint8(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, UIN
 */
 EFI_STATUS SetKeyValueInt8(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key,  INT8 Val, TO_STRING_BASE Base);
 /*
-* Retrieve a unicode string from the data set.
+* Retrieve a unicode string from the data set.  Values of other types are rendered on
+* demand into a buffer that is only valid until the next call.
 */
 EFI_STATUS GetKeyValueWideStr(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, CHAR16 **Val, CHAR16 *DefaultVal);
 /*
+* Retrieve the stored value of a key without rendering it to a string.  The value is owned
+* by the data set; its type is given by the Type of the key's KEY_VAL_INFO.
+*/
+EFI_STATUS GetKeyValueRaw(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, VOID **Val, TO_STRING_BASE *Base);
+/*
 * Retrieve an unsigned 64 bit value from the data set.
 */
 EFI_STATUS GetKeyValueUint64(DATA_SET_CONTEXT *DataSetCtx, const CHAR16 *Key, UINT64 *Val, UINT64 *DefaultVal);
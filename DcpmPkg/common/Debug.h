@@ -25,6 +25,8 @@ extern CHAR16 gFnName[G_FN_NAME_SIZE];
 
 #ifdef OS_BUILD
 extern UINTN EFIAPI PrintNoBuffer(CHAR16* fmt, ...);
+extern UINTN EFIAPI PrintUtf8(CONST CHAR8 *Buffer, UINTN Size);
+extern VOID EFIAPI PrintFlush();
 #endif
 #ifndef OS_BUILD
 #define NVDIMM_BUFFER_CONTROLLED_MSG(Buffered, Format, ...) \
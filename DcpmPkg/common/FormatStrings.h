@@ -39,6 +39,8 @@
 #define FORMAT_SHOW_GOAL_SINGLE                 L"0x%04x     %-21s %-12s %-15s %-15s\n"
 #define FORMAT_SHOW_NS_HEADER                   L"%-11s   %-11s   %-8s\n"
 #define FORMAT_SHOW_NS_HEALTH                   L"0x%04x        %-11s   "
+#define FORMAT_SHOW_STARTUP_HEADER              L"%-14s %6s %12s\n"
+#define FORMAT_SHOW_STARTUP_PHASE               L"%-14s %6d %8lld.%03lld\n"
 #define FORMAT_SHOW_TOPO_HEADER                 L"%-21s %-12s %-10s %-11s %-13s\n"
 #define FORMAT_SHOW_SOCKET_HEADER               L"%-9s %-22s %-20s\n"
 #define FORMAT_SHOW_SOCKET                      L"0x%04x    %-22s %-20s\n"
@@ -107,6 +109,8 @@
 #define FORMAT_SHOW_GOAL_SINGLE                 L"0x%04x\t\t%ls\t%ls\t\t%ls\t%ls\n"
 #define FORMAT_SHOW_NS_HEADER                   L"%-11ls   %-11ls   %-8ls\n"
 #define FORMAT_SHOW_NS_HEALTH                   L"0x%04x        %-11ls   "
+#define FORMAT_SHOW_STARTUP_HEADER              L"%-14ls %6ls %12ls\n"
+#define FORMAT_SHOW_STARTUP_PHASE               L"%-14ls %6d %8lld.%03lld\n"
 #define FORMAT_SHOW_TOPO_HEADER                 L"%ls\t%ls\t%ls\t%ls\t%ls\n"
 #define FORMAT_SHOW_SOCKET_HEADER               L"%-9ls %-22ls %-20ls\n"
 #define FORMAT_SHOW_SOCKET                      L"0x%04x    %-22ls %-20ls\n"
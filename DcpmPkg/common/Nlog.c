@@ -4,72 +4,273 @@
 */
 
 #include "Nlog.h"
+#ifdef OS_BUILD
+#include <os.h>
+#endif
+
+#define NLOG_DICT_MIN_BUCKET_BITS 4
+#define NLOG_DICT_MAX_BUCKET_BITS 31
+#define NLOG_DICT_STRING_FIELDS 3
+//precompiled dictionaries store buckets, changing the hash requires a new NLOG_BIN_DICT_FORMAT_VERSION
+#define NLOG_DICT_HASH_MULTIPLIER 2654435761U
+#define NLOG_DICT_FNV_OFFSET_BASIS 2166136261U
+#define NLOG_DICT_FNV_PRIME 16777619U
+#define NLOG_TEXT_DICT_EXTENSION ".txt"
+#define NLOG_BIN_DICT_EXTENSION ".bin"
+
+#define NLOG_WORD_SIZE 4
+#define NLOG_SECTION_SIZE 256
+#define NLOG_V2_MAGIC_NUMBER 11928997
+#define NLOG_V1_EXTRA_ARGS 2
+#define NLOG_V1_FORMAT_PREFIX "V1 Log module: 0x%X, line: %d, args: "
+#define NLOG_V1_FORMAT_ARG "0x%X "
+#define NLOG_HASH_NOT_FOUND_FORMAT "Hash %d not found in dictionary"
+#define NLOG_SYSTEM_TIME_SET_LOG "System Time Set"
+#define NLOG_FIELD_SEPARATOR " :: "
+#define NLOG_TIMESTAMP_WIDTH 28
+#define NLOG_FILE_NAME_WIDTH 27
+#define NLOG_LOG_LEVEL_WIDTH 7
+#define NLOG_DECODE_HEADER "TIMESTAMP ::              FILE           ::   LEVEL :: LOG\n" \
+  "=====================================================================================\n"
+//sections each worker decodes per window, bounds the decoded text held in memory
+#define NLOG_DECODE_SECTIONS_PER_WORKER 32
+#define NLOG_DECODE_MAX_WORKERS 8
 
+/*
+Decoding works on the 256 byte sections the log is written in. Sections are
+decoded in parallel a window at a time into per section line buffers, then
+written in order, so memory does not grow with the size of the log.
+*/
+typedef enum {
+  NLOG_LINE_PLAIN,                                  //!< written as is
+  NLOG_LINE_TIMESTAMPED,                            //!< prefixed with the kernel time
+  NLOG_LINE_SYSTEM_TIME_SET                         //!< prefixed with the kernel time, which is now wall clock time
+} nlog_line_kind;
+
+typedef struct {
+  UINT32 KernelTime;
+  UINT32 Kind;                                      //!< nlog_line_kind
+  UINT64 Length;                                    //!< bytes of text following this header
+} nlog_line;
+
+typedef struct {
+  UINT64 Start;                                     //!< offset decoding starts at
+  UINT64 End;                                       //!< offset of the next section
+  BOOLEAN InV2Section;                              //!< v2 state at Start, then at Resume once decoded
+  UINT64 Resume;                                    //!< offset sequential decoding continues from
+  UINT64 RecordCount;                               //!< records decoded
+  EFI_STATUS Status;                                //!< EFI_END_OF_FILE when the log ends within a record
+  CHAR8* Lines;                                     //!< nlog_line headers, each followed by its text
+  UINT64 LinesSize;
+  UINT64 LinesCapacity;
+  UINT32* ArgValues;                                //!< argument scratch space
+  UINT32** ArgPointers;                             //!< points into ArgValues, as nlog_format takes them
+  UINT64 ArgCapacity;
+} nlog_section;
+
+typedef struct {
+  UINT8* NlogBytes;
+  UINT64 Size;
+  UINT32 DictVersion;
+  nlog_dict* Dict;
+  nlog_section* Sections;
+  UINT64 SectionCount;
+} nlog_decode_job;
+
+STATIC CONST CHAR8 nlog_padding[] = "                                ";
+
+/*
+Makes room for a number of bytes at the end of the line buffer
+*/
+STATIC
+EFI_STATUS
+nlog_section_reserve(
+  nlog_section* section,
+  UINT64 bytes
+)
+{
+  UINT64 capacity = (0 == section->LinesCapacity) ? NLOG_SECTION_SIZE : section->LinesCapacity;
+  CHAR8* lines = NULL;
+
+  if (section->LinesSize + bytes <= section->LinesCapacity)
+  {
+    return EFI_SUCCESS;
+  }
+
+  while (capacity < section->LinesSize + bytes)
+  {
+    capacity <<= 1;
+  }
+
+  lines = ReallocatePool((UINTN)section->LinesCapacity, (UINTN)capacity, section->Lines);
+  if (NULL == lines)
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  section->Lines = lines;
+  section->LinesCapacity = capacity;
+  return EFI_SUCCESS;
+}
+
+/*
+Appends text to the line buffer, left padded with spaces to width. NULL
+strings are left out entirely, as pad_left does.
+*/
+STATIC
+EFI_STATUS
+nlog_section_append(
+  nlog_section* section,
+  CONST CHAR8* str,
+  UINT64 width
+)
+{
+  UINT64 length = 0;
+  UINT64 padding = 0;
+
+  if (NULL == str)
+  {
+    return EFI_SUCCESS;
+  }
+
+  length = string_length((CHAR8*)str);
+  padding = (length < width) ? width - length : 0;
+  if (EFI_ERROR(nlog_section_reserve(section, padding + length)))
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  CopyMem(section->Lines + section->LinesSize, nlog_padding, (UINTN)padding);
+  CopyMem(section->Lines + section->LinesSize + padding, str, (UINTN)length);
+  section->LinesSize += padding + length;
+  return EFI_SUCCESS;
+}
+
+/*
+Appends a decoded line, the timestamp column is left to the writer since it
+depends on the lines before it
+*/
+STATIC
+EFI_STATUS
+nlog_section_add_line(
+  nlog_section* section,
+  nlog_line_kind kind,
+  UINT32 kernel_time,
+  CHAR8* file_name,
+  CHAR8* log_level,
+  CHAR8* formatted
+)
+{
+  nlog_line line;
+  UINT64 line_offset = section->LinesSize;
+  EFI_STATUS status = EFI_SUCCESS;
+
+  if (EFI_ERROR(nlog_section_reserve(section, sizeof(line))))
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  section->LinesSize += sizeof(line);
+  if (NLOG_LINE_PLAIN != kind)
+  {
+    status |= nlog_section_append(section, NLOG_FIELD_SEPARATOR, 0);
+    status |= nlog_section_append(section, file_name, NLOG_FILE_NAME_WIDTH);
+    status |= nlog_section_append(section, NLOG_FIELD_SEPARATOR, 0);
+    status |= nlog_section_append(section, log_level, NLOG_LOG_LEVEL_WIDTH);
+    status |= nlog_section_append(section, NLOG_FIELD_SEPARATOR, 0);
+  }
+  status |= nlog_section_append(section, formatted, 0);
+  status |= nlog_section_append(section, "\n", 0);
+  if (EFI_ERROR(status))
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  line.KernelTime = kernel_time;
+  line.Kind = kind;
+  line.Length = section->LinesSize - line_offset - sizeof(line);
+  CopyMem(section->Lines + line_offset, &line, sizeof(line));
+  return EFI_SUCCESS;
+}
+
+/*
+Makes room for a number of record arguments
+*/
+STATIC
+EFI_STATUS
+nlog_section_reserve_args(
+  nlog_section* section,
+  UINT64 count
+)
+{
+  UINT64 x = 0;
+
+  if (count <= section->ArgCapacity)
+  {
+    return EFI_SUCCESS;
+  }
+
+  FREE_POOL_SAFE(section->ArgValues);
+  FREE_POOL_SAFE(section->ArgPointers);
+  section->ArgCapacity = 0;
+  section->ArgValues = AllocateZeroPool(count * sizeof(UINT32));
+  section->ArgPointers = AllocateZeroPool(count * sizeof(UINT32*));
+  if (NULL == section->ArgValues || NULL == section->ArgPointers)
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (x = 0; x < count; x++)
+  {
+    section->ArgPointers[x] = &section->ArgValues[x];
+  }
+
+  section->ArgCapacity = count;
+  return EFI_SUCCESS;
+}
+
+/*
+Decodes the records starting within a section. A record may run past the end
+of the section, Resume is then the offset in a later section it ended at.
+*/
+STATIC
 VOID
-decode_nlog_binary(
-  struct Command *pCmd,
-  CHAR16* decoded_file_name,
-  UINT8* nlogbytes,
-  UINT64 size,
-  UINT32 dict_version,
-  nlog_dict_entry* dict_head
+nlog_decode_section(
+  nlog_decode_job* job,
+  nlog_section* section
 )
 {
-  EFI_STATUS status;
-  BOOLEAN inv2section = FALSE;
-  UINT32 expectedMagicNum = 11928997;
+  BOOLEAN inv2section = section->InV2Section;
   UINT64 x = 0;
   UINT64 y = 0;
-  UINT64 z = 0;
-  nlog_dict_entry* entry = NULL;
-  nlog_record* record = NULL;
-  nlog_record* head = NULL;
-  nlog_record* tail = NULL;
-  UINT64 total_formatted_string_size = 0;
-  CHAR8* total_formatted_string = NULL;
-  UINT64 elements = 0;
-  CHAR8** append_strs = NULL;
-  UINT32** old_args = NULL;
-  UINT64 old_arg_count = 0;
+  UINT64 args = 0;
+  UINT64 arg_base = 0;
+  UINT32 value = 0;
+  UINT32 kernel_time = 0;
   nlog_version_v1 v1;
   nlog_version_v2 v2;
-  CHAR16* kernel_str = NULL;
-  CHAR8* ascii_kernel_str = NULL;
-  CHAR8* system_time_set_log = "System Time Set";
-  UINTN ascii_kernel_str_size = 0;
-  UINT32 system_time_set = 0;
-  CHAR8* old_format_str = NULL;
-  CHAR8* decode_header = NULL;
-  UINT64 header_length = 0;
-  UINT32 value;
-  UINT64 node_count = 0;
-  CHAR8* formatted_string_head = NULL;
-  UINT64 bytes_needed = 0;
-  UINT64 appended_count = 0;
-  BOOLEAN dictionary_entry_was_allocated_here = FALSE;
-  BOOLEAN hash_not_found = FALSE;
-  nlog_record* next;
-  PRINT_CONTEXT *pPrinterCtx = NULL;
-  EFI_STATUS ReturnCode = EFI_SUCCESS;
-
-  if (pCmd != NULL) {
-    pPrinterCtx = pCmd->pPrintCtx;
-  }
-
-  node_count = 0;
-  for (x = 0; x < size; x += 4)
+  nlog_dict_entry* entry = NULL;
+  nlog_dict_entry lookup;
+  nlog_line_kind kind = NLOG_LINE_TIMESTAMPED;
+  CHAR8* format = NULL;
+  CHAR8* file_name = NULL;
+  CHAR8* log_level = NULL;
+  CHAR8* formatted = NULL;
+  CHAR8 v1_format[sizeof(NLOG_V1_FORMAT_PREFIX) + (MAX_UINT8 * (sizeof(NLOG_V1_FORMAT_ARG) - 1))];
+
+  section->LinesSize = 0;
+  section->RecordCount = 0;
+  section->Status = EFI_SUCCESS;
+
+  for (x = section->Start; x < section->End; x += NLOG_WORD_SIZE)
   {
-    record = NULL;
-    entry = NULL;
-    dictionary_entry_was_allocated_here = FALSE;
-    hash_not_found = FALSE;
-    value = bytes_to_u32(&nlogbytes[x]);
-    if (x % 256 == 0)
+    value = bytes_to_u32(&job->NlogBytes[x]);
+    if (x % NLOG_SECTION_SIZE == 0)
     {
       inv2section = FALSE;
       v2.rawData = value;
-      if (v2.data.magic_number == expectedMagicNum &&
-        v2.data.version == dict_version)
+      if (v2.data.magic_number == NLOG_V2_MAGIC_NUMBER &&
+        v2.data.version == job->DictVersion)
       {
         inv2section = TRUE;
         continue;
@@ -81,61 +282,37 @@ decode_nlog_binary(
       continue; //this is not a valid record
     }
 
-    /*
-    check for V2 dictionary entry if this is a V2 section. If there isn't one, create a fake one for logging purposes
-
-    If this is a V1 section and the value is valid for a V1 section, create a fake entry for logging purposes
-    */
     if (inv2section)
     {
-      entry = get_nlog_entry(value, dict_head);
-      if (entry == NULL)
+      entry = get_nlog_entry(value, job->Dict, &lookup);
+      if (NULL == entry)
       {
-        hash_not_found = TRUE;
-        entry = AllocateZeroPool(sizeof(nlog_dict_entry));
-        if (NULL == entry)
+        //no timestamp or arguments follow a hash missing from the dictionary
+        if (EFI_ERROR(nlog_section_reserve_args(section, 1)))
         {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+          section->Status = EFI_OUT_OF_RESOURCES;
           goto Finish;
         }
 
-        dictionary_entry_was_allocated_here = TRUE;
-
-        entry->Hash = value;
-        entry->Args = 1;
-        entry->LogLevel = string_copy("-");
-        entry->FileName = string_copy("-");
-        entry->LogString = string_copy("Hash %d not found in dictionary");
-        entry->next = NULL;
-        entry->prev = NULL;
-
-        record = AllocateZeroPool(sizeof(nlog_record));
-        if (NULL == record)
+        section->ArgValues[0] = value;
+        formatted = nlog_format(NLOG_HASH_NOT_FOUND_FORMAT, section->ArgPointers, 1);
+        if (NULL == formatted ||
+          EFI_ERROR(nlog_section_add_line(section, NLOG_LINE_PLAIN, 0, NULL, NULL, formatted)))
         {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+          section->Status = EFI_OUT_OF_RESOURCES;
           goto Finish;
         }
 
-        record->DictEntry = entry;
-        record->KernelTime = 0;
-        record->ArgValues = AllocateZeroPool(record->DictEntry->Args * sizeof(UINT32*));
-        if (NULL == record->ArgValues)
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
-        record->ArgValues[0] = AllocateZeroPool(sizeof(UINT32));
-        if (NULL == record->ArgValues[0])
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
-        *record->ArgValues[0] = entry->Hash;
-        record->KernelTime = 0;
-        record->FormattedString = NULL;
-        record->prev = NULL;
-        record->next = NULL;
+        FREE_POOL_SAFE(formatted);
+        section->RecordCount++;
+        continue;
       }
+
+      args = entry->Args;
+      arg_base = 0;
+      format = entry->LogString;
+      file_name = entry->FileName;
+      log_level = entry->LogLevel;
     }
     else
     {
@@ -145,296 +322,390 @@ decode_nlog_binary(
         continue;
       }
 
-      entry = AllocateZeroPool(sizeof(nlog_dict_entry));
-      if (NULL == entry)
+      //V1 records print the module and line ahead of their raw arguments
+      args = v1.data.args;
+      arg_base = NLOG_V1_EXTRA_ARGS;
+      CopyMem(v1_format, NLOG_V1_FORMAT_PREFIX, sizeof(NLOG_V1_FORMAT_PREFIX));
+      for (y = 0; y < args; y++)
       {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-        goto Finish;
+        CopyMem(v1_format + sizeof(NLOG_V1_FORMAT_PREFIX) - 1 + (y * (sizeof(NLOG_V1_FORMAT_ARG) - 1)),
+          NLOG_V1_FORMAT_ARG, sizeof(NLOG_V1_FORMAT_ARG));
       }
+      format = v1_format;
+      file_name = "-";
+      log_level = "-";
+    }
 
-      dictionary_entry_was_allocated_here = TRUE;
+    //get the timestamp
+    x += NLOG_WORD_SIZE;
+    if (x >= job->Size)
+    {
+      section->Status = EFI_END_OF_FILE;
+      goto Finish;
+    }
+    kernel_time = bytes_to_u32(&job->NlogBytes[x]);
 
-      entry->Args = v1.data.args;
-      entry->Hash = 0;
-      entry->LogLevel = string_copy("-");
-      entry->FileName = string_copy("-");
-      entry->LogString = NULL;
-      entry->next = NULL;
-      entry->prev = NULL;
+    if (EFI_ERROR(nlog_section_reserve_args(section, arg_base + args + 1)))
+    {
+      section->Status = EFI_OUT_OF_RESOURCES;
+      goto Finish;
     }
 
-    //Move the pointer index to the next U32 and allocate space for a record
-    if (record == NULL)
+    //gather the argument U32s according to the discovered count
+    for (y = 0; y < args; y++)
     {
-      record = AllocateZeroPool(sizeof(nlog_record));
-      if (NULL == record)
+      x += NLOG_WORD_SIZE;
+      if (x >= job->Size)
       {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+        section->Status = EFI_END_OF_FILE;
         goto Finish;
       }
-
-      record->id = node_count;
-      record->ArgValues = NULL;
-      record->FormattedString = NULL;
-      record->prev = NULL;
-      record->next = NULL;
-      record->KernelTime = 0;
+      section->ArgValues[arg_base + y] = bytes_to_u32(&job->NlogBytes[x]);
     }
 
-    if (record->DictEntry == NULL && entry != NULL) {
-      record->DictEntry = entry;
+    if (!inv2section)
+    {
+      section->ArgValues[0] = v1.data.module_id;
+      section->ArgValues[1] = v1.data.line_number;
     }
+    args += arg_base;
 
-    if (head == NULL) {
-      head = record;
-      tail = record;
-    }
-    else {
-      tail->next = record;
-      record->prev = tail;
-      tail = record;
+    formatted = nlog_format(format, (0 == args) ? NULL : section->ArgPointers, args);
+
+    // Look for log eg: \"System Time Set at boot. Time: 0x0_55bbb4a6\". From here on kernel time is real time.
+    kind = NLOG_LINE_TIMESTAMPED;
+    if (NULL != formatted && 0 != formatted[0] &&
+      AsciiStrnCmp(formatted + 1, NLOG_SYSTEM_TIME_SET_LOG, sizeof(NLOG_SYSTEM_TIME_SET_LOG) - 1) == 0)
+    {
+      kind = NLOG_LINE_SYSTEM_TIME_SET;
     }
 
-    //get the timestamp
-    if (FALSE == hash_not_found)
+    if (EFI_ERROR(nlog_section_add_line(section, kind, kernel_time, file_name, log_level, formatted)))
     {
-      x += 4;
-      if (x >= size)
-      {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Unexpected end of buffer. 1\n");
-        goto Finish;
-      }
-      record->KernelTime = bytes_to_u32(&nlogbytes[x]);
+      section->Status = EFI_OUT_OF_RESOURCES;
+      goto Finish;
+    }
 
-      /*
-      Gather the argument U32s according to the discovered count
-      */
-      if (record->DictEntry->Args > 0)
-      {
-        record->ArgValues = AllocateZeroPool(record->DictEntry->Args * sizeof(UINT32*));
-        if (NULL == record->ArgValues)
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
+    FREE_POOL_SAFE(formatted);
+    section->RecordCount++;
+  }
 
-        for (y = 0; y < record->DictEntry->Args && x < size; y++)
-        {
-          x += 4;
-          if (x >= size)
-          {
-            PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Unexpected end of buffer. 3\n");
-            goto Finish;
-          }
-          record->ArgValues[y] = AllocateZeroPool(sizeof(UINT32));
-          if (NULL == record->ArgValues[y])
-          {
-            PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-            goto Finish;
-          }
-
-          *record->ArgValues[y] = bytes_to_u32(&nlogbytes[x]);
-        }
-      }
+Finish:
+  FREE_POOL_SAFE(formatted);
+  section->Resume = x;
+  section->InV2Section = inv2section;
+}
 
+/*
+Thread entry, decodes the sections of one job
+*/
+STATIC
+VOID
+nlog_decode_worker(
+  VOID* arg
+)
+{
+  nlog_decode_job* job = (nlog_decode_job*)arg;
+  UINT64 x = 0;
 
-      if (FALSE == inv2section)
-      {
-        elements = 3 + record->DictEntry->Args;
-        append_strs = AllocateZeroPool(sizeof(CHAR8*) * elements);
-        if (NULL == append_strs)
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
+  for (x = 0; x < job->SectionCount; x++)
+  {
+    nlog_decode_section(job, &job->Sections[x]);
+  }
+}
 
-        append_strs[0] = string_copy("V1 Log module: 0x%X, ");
-        append_strs[1] = string_copy("line: %d, ");
-        append_strs[2] = string_copy("args: ");
-        for (z = 3; z < elements; z++)
-        {
-          append_strs[z] = string_copy("0x%X ");
-        }
+/*
+Splits a window of sections between the jobs and decodes them, job 0 runs on
+the calling thread. Without threads, or when one fails to start, its job is
+run inline.
+*/
+STATIC
+VOID
+nlog_decode_sections(
+  nlog_decode_job* jobs,
+  UINT64 job_count,
+  nlog_section* sections,
+  UINT64 section_count
+)
+{
+#ifdef OS_BUILD
+  OS_THREAD* threads[NLOG_DECODE_MAX_WORKERS];
+#endif
+  UINT64 per_job = (section_count + job_count - 1) / job_count;
+  UINT64 first = 0;
+  UINT64 x = 0;
 
-        old_args = record->ArgValues;
-        old_arg_count = record->DictEntry->Args;
+  for (x = 0; x < job_count; x++)
+  {
+    first = MIN(x * per_job, section_count);
+    jobs[x].Sections = sections + first;
+    jobs[x].SectionCount = MIN(per_job, section_count - first);
+  }
 
-        record->DictEntry->Args = old_arg_count + 2;
-        record->ArgValues = AllocateZeroPool(record->DictEntry->Args * sizeof(UINT32*));
-        if (NULL == record->ArgValues)
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
+#ifdef OS_BUILD
+  for (x = 1; x < job_count; x++)
+  {
+    threads[x] = os_thread_create(nlog_decode_worker, &jobs[x]);
+    if (NULL == threads[x])
+    {
+      nlog_decode_worker(&jobs[x]);
+    }
+  }
+#endif
 
-        record->ArgValues[0] = AllocateZeroPool(sizeof(UINT32));
-        if (NULL == record->ArgValues[0])
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
-        record->ArgValues[1] = AllocateZeroPool(sizeof(UINT32));
-        if (NULL == record->ArgValues[1])
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-          goto Finish;
-        }
-        *record->ArgValues[0] = v1.data.module_id;
-        *record->ArgValues[1] = v1.data.line_number;
+  nlog_decode_worker(&jobs[0]);
 
+#ifdef OS_BUILD
+  for (x = 1; x < job_count; x++)
+  {
+    if (NULL != threads[x])
+    {
+      os_thread_join(threads[x]);
+    }
+  }
+#endif
+}
 
-        for (z = 0; z < old_arg_count; z++)
-        {
-          record->ArgValues[z + 2] = AllocateZeroPool(sizeof(UINT32));
-          *record->ArgValues[z + 2] = *old_args[z];
-        }
+/*
+Writes text left padded with spaces to width
+*/
+STATIC
+EFI_STATUS
+nlog_write_padded(
+  DUMP_FILE* decoded_file,
+  CHAR8* str,
+  UINT64 length,
+  UINT64 width
+)
+{
+  EFI_STATUS status = EFI_SUCCESS;
 
-        for (z = 0; z < old_arg_count; z++)
-        {
-          FREE_POOL_SAFE(old_args[z]);
-        }
+  if (length < width)
+  {
+    status = WriteDumpFile(decoded_file, width - length, (VOID*)nlog_padding);
+  }
 
-        FREE_POOL_SAFE(old_args);
+  if (!EFI_ERROR(status))
+  {
+    status = WriteDumpFile(decoded_file, length, str);
+  }
 
-        record->DictEntry->LogString = string_array_concat(append_strs, elements, TRUE, &z);
-      }
-    }
+  return status;
+}
 
-    record->FormattedString = nlog_format(record->DictEntry->LogString, record->ArgValues, record->DictEntry->Args);
+/*
+Writes the decoded lines of a section, adding the timestamp column
 
-    if (TRUE == hash_not_found)
-    {
-      elements = 2;
-      old_format_str = record->FormattedString;
-      append_strs = AllocateZeroPool(sizeof(CHAR8*) * elements);
-      if (NULL == append_strs)
-      {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-        goto Finish;
-      }
-      append_strs[0] = old_format_str;
-      append_strs[1] = string_copy("\n");
-      record->FormattedString = string_array_concat(append_strs, elements, FALSE, &record->FormattedStringLen);
-    }
-    else
-    {
-      elements = 8;
-      old_format_str = record->FormattedString;
-      append_strs = AllocateZeroPool(sizeof(CHAR8*) * elements);
-      if (NULL == append_strs)
-      {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-        goto Finish;
-      }
+@param[in,out] system_time_set - kernel time of the last system time set, 0 if none yet
+*/
+STATIC
+EFI_STATUS
+nlog_write_section(
+  struct Command *pCmd,
+  DUMP_FILE* decoded_file,
+  nlog_section* section,
+  UINT32* system_time_set
+)
+{
+  EFI_STATUS status = EFI_SUCCESS;
+  nlog_line line;
+  UINT64 offset = 0;
+  CHAR16* kernel_str = NULL;
+  CHAR8* ascii_kernel_str = NULL;
+  UINTN ascii_kernel_str_size = 0;
+  CHAR8 decimal[11];
+  UINT64 decimal_length = 0;
+  UINT32 value = 0;
+  PRINT_CONTEXT *pPrinterCtx = NULL;
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
 
-      // Look for log eg: \"System Time Set at boot. Time: 0x0_55bbb4a6\". Convert to time format string only for real kernel time and not system ticks.
-      if (((system_time_set != 0) && (record->KernelTime >= system_time_set)) || (AsciiStrnCmp(record->FormattedString + 1, system_time_set_log, string_length(system_time_set_log)) == 0))
-      {
-        system_time_set = record->KernelTime;
-        kernel_str = GetTimeFormatString((UINT64)record->KernelTime, TRUE);
-        if (NULL == kernel_str)
-        {
-          PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to convert the timestamp into readable string format\n");
-          goto Finish;
-        }
-        ascii_kernel_str_size = StrLen(kernel_str) + 1;
-        ascii_kernel_str = AllocateZeroPool(sizeof(CHAR8) * ascii_kernel_str_size);
-        UnicodeStrToAsciiStrS(kernel_str, ascii_kernel_str, ascii_kernel_str_size);
-        append_strs[0] = pad_left(ascii_kernel_str, 28, ' ', TRUE);
-      }
-      else
-      {
-        ascii_kernel_str = u32_to_a(record->KernelTime, FALSE, 0, FALSE);
-        append_strs[0] = pad_left(ascii_kernel_str, 28, ' ', TRUE);
-      }
-      append_strs[1] = string_copy(" :: ");
-      append_strs[2] = pad_left(record->DictEntry->FileName, 27, ' ', FALSE);
-      append_strs[3] = string_copy(" :: ");
-      append_strs[4] = pad_left(record->DictEntry->LogLevel, 7, ' ', FALSE);
-      append_strs[5] = string_copy(" :: ");
-      append_strs[6] = record->FormattedString;
-      append_strs[7] = string_copy("\n");
-
-      record->FormattedString = string_array_concat(append_strs, elements, FALSE, &record->FormattedStringLen);
-    }
+  if (pCmd != NULL) {
+    pPrinterCtx = pCmd->pPrintCtx;
+  }
 
-    total_formatted_string_size += record->FormattedStringLen;
+  while (offset < section->LinesSize && !EFI_ERROR(status))
+  {
+    CopyMem(&line, section->Lines + offset, sizeof(line));
+    offset += sizeof(line);
 
-    FREE_POOL_SAFE(kernel_str);
-    if (append_strs)
+    // Convert to time format string only for real kernel time and not system ticks.
+    if (NLOG_LINE_SYSTEM_TIME_SET == line.Kind ||
+      (NLOG_LINE_TIMESTAMPED == line.Kind && 0 != *system_time_set && line.KernelTime >= *system_time_set))
     {
-      for (z = 0; z < elements; z++)
+      *system_time_set = line.KernelTime;
+      kernel_str = GetTimeFormatString((UINT64)line.KernelTime, TRUE);
+      if (NULL == kernel_str)
+      {
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to convert the timestamp into readable string format\n");
+        return EFI_OUT_OF_RESOURCES;
+      }
+      ascii_kernel_str_size = StrLen(kernel_str) + 1;
+      ascii_kernel_str = AllocateZeroPool(sizeof(CHAR8) * ascii_kernel_str_size);
+      if (NULL == ascii_kernel_str)
       {
-        FREE_POOL_SAFE(append_strs[z]);
+        FREE_POOL_SAFE(kernel_str);
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to convert the timestamp into readable string format\n");
+        return EFI_OUT_OF_RESOURCES;
       }
-      FREE_POOL_SAFE(append_strs);
+      UnicodeStrToAsciiStrS(kernel_str, ascii_kernel_str, ascii_kernel_str_size);
+      status = nlog_write_padded(decoded_file, ascii_kernel_str, ascii_kernel_str_size - 1, NLOG_TIMESTAMP_WIDTH);
+      FREE_POOL_SAFE(kernel_str);
+      FREE_POOL_SAFE(ascii_kernel_str);
     }
-
-    if (record->ArgValues)
+    else if (NLOG_LINE_TIMESTAMPED == line.Kind)
     {
-      for (z = 0; z < record->DictEntry->Args; z++)
+      value = line.KernelTime;
+      decimal_length = sizeof(decimal);
+      do
       {
-        FREE_POOL_SAFE(record->ArgValues[z]);
-      }
-
-      FREE_POOL_SAFE(record->ArgValues);
-      record->ArgValues = NULL;
+        decimal[--decimal_length] = (CHAR8)('0' + (value % 10));
+        value /= 10;
+      } while (value > 0);
+      status = nlog_write_padded(decoded_file, decimal + decimal_length, sizeof(decimal) - decimal_length, NLOG_TIMESTAMP_WIDTH);
     }
 
-    if (entry != NULL && dictionary_entry_was_allocated_here)
+    if (!EFI_ERROR(status))
     {
-      FREE_POOL_SAFE(entry->FileName);
-      FREE_POOL_SAFE(entry->LogLevel);
-      FREE_POOL_SAFE(entry->LogString);
-      FREE_POOL_SAFE(entry);
-      entry = NULL;
-      record->DictEntry = NULL;
+      status = WriteDumpFile(decoded_file, line.Length, section->Lines + offset);
     }
+    offset += line.Length;
+  }
 
-    node_count++;
+  if (EFI_ERROR(status))
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to write record to file %lu\n", status);
   }
 
-  /*
-  build the output string and dump it to the file
-  */
-  decode_header = string_copy("TIMESTAMP ::              FILE           ::   LEVEL :: LOG\n=====================================================================================\n");
-  header_length = string_length(decode_header);
-  total_formatted_string_size += header_length;
+  return status;
+}
+
+VOID
+decode_nlog_binary(
+  struct Command *pCmd,
+  CHAR16* decoded_file_name,
+  UINT8* nlogbytes,
+  UINT64 size,
+  UINT32 dict_version,
+  nlog_dict* dict
+)
+{
+  EFI_STATUS status = EFI_SUCCESS;
+  DUMP_FILE* decoded_file = NULL;
+  nlog_decode_job* jobs = NULL;
+  nlog_section* sections = NULL;
+  nlog_section* section = NULL;
+  UINT64 job_count = 1;
+  UINT64 window_capacity = 0;
+  UINT64 window_count = 0;
+  UINT64 window_start = 0;
+  UINT64 section_count = 0;
+  UINT64 offset = 0;
+  UINT64 node_count = 0;
+  UINT64 x = 0;
+  BOOLEAN inv2section = FALSE;
+  UINT32 system_time_set = 0;
+  PRINT_CONTEXT *pPrinterCtx = NULL;
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+
+  if (pCmd != NULL) {
+    pPrinterCtx = pCmd->pPrintCtx;
+  }
 
-  bytes_needed = (sizeof(CHAR8*) * total_formatted_string_size) + sizeof(CHAR8*);
+  //only whole words are decoded
+  size -= size % NLOG_WORD_SIZE;
+  section_count = (size + NLOG_SECTION_SIZE - 1) / NLOG_SECTION_SIZE;
+
+#ifdef OS_BUILD
+  job_count = (UINT64)os_get_cpu_count();
+  job_count = MIN(job_count, NLOG_DECODE_MAX_WORKERS);
+  job_count = MIN(job_count, (section_count + NLOG_DECODE_SECTIONS_PER_WORKER - 1) / NLOG_DECODE_SECTIONS_PER_WORKER);
+  job_count = MAX(job_count, 1);
+#endif
+  window_capacity = job_count * NLOG_DECODE_SECTIONS_PER_WORKER;
+
+  jobs = AllocateZeroPool(job_count * sizeof(nlog_decode_job));
+  sections = AllocateZeroPool(window_capacity * sizeof(nlog_section));
+  if (NULL == jobs || NULL == sections)
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+    goto Finish;
+  }
 
-  total_formatted_string = AllocateZeroPool(bytes_needed);
-  if (NULL == total_formatted_string)
+  for (x = 0; x < job_count; x++)
   {
-    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate %lu bytes to dump the decoded output\n", bytes_needed);
+    jobs[x].NlogBytes = nlogbytes;
+    jobs[x].Size = size;
+    jobs[x].DictVersion = dict_version;
+    jobs[x].Dict = dict;
+  }
+
+  status = OpenDumpFile(decoded_file_name, &decoded_file);
+  if (EFI_ERROR(status))
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to write record to file %lu\n", status);
     goto Finish;
   }
 
-  formatted_string_head = total_formatted_string;
-  appended_count = 0;
-  if (header_length > 0)
+  status = WriteDumpFile(decoded_file, sizeof(NLOG_DECODE_HEADER) - 1, NLOG_DECODE_HEADER);
+  if (EFI_ERROR(status))
   {
-    MyMemCopy(formatted_string_head, header_length, decode_header);
-    formatted_string_head = formatted_string_head + header_length;
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to write record to file %lu\n", status);
+    goto Finish;
   }
-  FREE_POOL_SAFE(decode_header);
 
-  record = head;
-  while (record)
+  for (window_start = 0; window_start < section_count; window_start += window_count)
   {
-    if (record->FormattedStringLen > 0)
+    window_count = MIN(window_capacity, section_count - window_start);
+    for (x = 0; x < window_count; x++)
     {
-      MyMemCopy(formatted_string_head, record->FormattedStringLen, record->FormattedString);
-      formatted_string_head = formatted_string_head + record->FormattedStringLen;
+      sections[x].Start = (window_start + x) * NLOG_SECTION_SIZE;
+      sections[x].End = MIN(sections[x].Start + NLOG_SECTION_SIZE, size);
+      sections[x].InV2Section = FALSE;
     }
 
-    FREE_POOL_SAFE(record->FormattedString);
-    record->FormattedString = NULL;
-    appended_count++;
-    record = record->next;
+    nlog_decode_sections(jobs, job_count, sections, window_count);
+
+    for (x = 0; x < window_count; x++)
+    {
+      section = &sections[x];
+      if (offset >= section->End)
+      {
+        continue; //consumed by a record of an earlier section
+      }
+
+      if (offset != section->Start)
+      {
+        //a record of the previous section ran into this one, decode from where it ended
+        section->Start = offset;
+        section->InV2Section = inv2section;
+        nlog_decode_section(&jobs[0], section);
+      }
+
+      if (EFI_OUT_OF_RESOURCES == section->Status)
+      {
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+        goto Finish;
+      }
+
+      if (EFI_ERROR(nlog_write_section(pCmd, decoded_file, section, &system_time_set)))
+      {
+        goto Finish;
+      }
+
+      node_count += section->RecordCount;
+      if (EFI_END_OF_FILE == section->Status)
+      {
+        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Unexpected end of buffer.\n");
+        goto Finish;
+      }
+
+      offset = section->Resume;
+      inv2section = section->InV2Section;
+    }
   }
 
-  status = DumpToFile(decoded_file_name, total_formatted_string_size, total_formatted_string, TRUE);
+  status = CloseDumpFile(decoded_file);
+  decoded_file = NULL;
   if (EFI_ERROR(status))
   {
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to write record to file %lu\n", status);
@@ -443,81 +714,224 @@ decode_nlog_binary(
   PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Decoded %lu records to file " FORMAT_STR "\n", node_count, decoded_file_name);
 
 Finish:
+  CloseDumpFile(decoded_file);
 
-  if (NULL != old_args)
+  if (NULL != sections)
   {
-    for (z = 0; z < old_arg_count; z++)
+    for (x = 0; x < window_capacity; x++)
     {
-      FREE_POOL_SAFE(old_args[z]);
+      FREE_POOL_SAFE(sections[x].Lines);
+      FREE_POOL_SAFE(sections[x].ArgValues);
+      FREE_POOL_SAFE(sections[x].ArgPointers);
     }
-    FREE_POOL_SAFE(old_args);
   }
 
-  if (NULL != total_formatted_string)
+  FREE_POOL_SAFE(sections);
+  FREE_POOL_SAFE(jobs);
+}
+
+/*
+Maps a string pool offset of a precompiled dictionary to a string
+*/
+STATIC
+CHAR8*
+nlog_dict_pool_to_string(
+  CHAR8* pool,
+  UINT32 offset
+)
+{
+  if (NLOG_BIN_DICT_NO_STRING == offset)
+  {
+    return NULL;
+  }
+
+  return pool + offset;
+}
+
+/*
+Returns the hash of the entry at an index, from either kind of dictionary
+*/
+STATIC
+UINT32
+nlog_dict_entry_hash(
+  nlog_dict* dict,
+  UINT64 index
+)
+{
+  return (NULL != dict->BinEntries) ? dict->BinEntries[index].Hash : dict->Entries[index].Hash;
+}
+
+/*
+Copies out the entry at an index. The entries of a precompiled image are
+resolved in place, their strings point into the image.
+*/
+STATIC
+VOID
+nlog_dict_entry_get(
+  nlog_dict* dict,
+  UINT64 index,
+  nlog_dict_entry* entry
+)
+{
+  nlog_bin_dict_entry* bin_entry = NULL;
+
+  if (NULL == dict->BinEntries)
   {
-    FREE_POOL_SAFE(total_formatted_string);
+    CopyMem(entry, &dict->Entries[index], sizeof(*entry));
+    return;
   }
 
-  if (NULL != append_strs)
+  bin_entry = &dict->BinEntries[index];
+  entry->Hash = bin_entry->Hash;
+  entry->Args = bin_entry->Args;
+  entry->LogLevel = nlog_dict_pool_to_string(dict->Pool, bin_entry->LogLevelOffset);
+  entry->FileName = nlog_dict_pool_to_string(dict->Pool, bin_entry->FileNameOffset);
+  entry->LogString = nlog_dict_pool_to_string(dict->Pool, bin_entry->LogStringOffset);
+}
+
+/*
+Maps a hash to its home bucket
+*/
+STATIC
+UINT64
+nlog_dict_bucket(
+  UINT32 hashVal,
+  nlog_dict* dict
+)
+{
+  return (UINT64)((hashVal * NLOG_DICT_HASH_MULTIPLIER) >> (32 - dict->BucketBits));
+}
+
+/*
+Sizes the bucket table for a number of entries
+
+@retval log2 of the number of buckets
+*/
+STATIC
+UINT32
+nlog_dict_bucket_bits(
+  UINT64 entry_count
+)
+{
+  UINT32 bucket_bits = NLOG_DICT_MIN_BUCKET_BITS;
+
+  //keep the table at most half full so probe sequences stay short
+  while ((1ULL << bucket_bits) < entry_count * 2)
   {
-    for (z = 0; z < elements; z++)
-    {
-      FREE_POOL_SAFE(append_strs[z]);
-    }
-    FREE_POOL_SAFE(append_strs);
+    bucket_bits++;
   }
 
-  while (head != NULL)
+  return bucket_bits;
+}
+
+/*
+Allocates a dictionary arena with room for the entries, buckets and strings
+
+@retval the dictionary with no entries, or NULL
+*/
+STATIC
+nlog_dict*
+nlog_dict_alloc(
+  UINT64 entry_count,
+  UINT32 bucket_bits,
+  UINT64 string_bytes
+)
+{
+  nlog_dict* dict = NULL;
+  UINT64 bucket_count = 1ULL << bucket_bits;
+
+  dict = AllocateZeroPool(sizeof(nlog_dict) + (entry_count * sizeof(nlog_dict_entry)) +
+    (bucket_count * sizeof(UINT32)) + string_bytes);
+  if (NULL == dict)
   {
-    next = head->next;
-    if (head->ArgValues)
-    {
-      for (z = 0; z < head->DictEntry->Args; z++)
-      {
-        FREE_POOL_SAFE(head->ArgValues[z]);
-      }
+    return NULL;
+  }
 
-      FREE_POOL_SAFE(head->ArgValues);
-    }
+  dict->Entries = (nlog_dict_entry*)(dict + 1);
+  dict->Buckets = (UINT32*)(dict->Entries + entry_count);
+  dict->BucketCount = bucket_count;
+  dict->BucketBits = bucket_bits;
+  return dict;
+}
 
-    if (head->FormattedString)
-    {
-      FREE_POOL_SAFE(head->FormattedString);
-    }
+/*
+Adds the next entry, already filled in at Entries[EntryCount], to the buckets.
+The first entry for a hash wins, as with the former in order search.
+*/
+STATIC
+VOID
+nlog_dict_insert(
+  nlog_dict* dict
+)
+{
+  nlog_dict_entry* entry = &dict->Entries[dict->EntryCount];
+  UINT64 bucket = nlog_dict_bucket(entry->Hash, dict);
 
-    FREE_POOL_SAFE(head);
-    head = next;
+  while (0 != dict->Buckets[bucket] && dict->Entries[dict->Buckets[bucket] - 1].Hash != entry->Hash)
+  {
+    bucket = (bucket + 1) & (dict->BucketCount - 1);
   }
 
-  if (entry != NULL && dictionary_entry_was_allocated_here)
+  if (0 == dict->Buckets[bucket])
   {
-    FREE_POOL_SAFE(entry->FileName);
-    FREE_POOL_SAFE(entry->LogLevel);
-    FREE_POOL_SAFE(entry->LogString);
-    FREE_POOL_SAFE(entry);
+    dict->Buckets[bucket] = (UINT32)(dict->EntryCount + 1);
   }
+
+  dict->EntryCount++;
 }
 
 nlog_dict_entry*
 get_nlog_entry(
   UINT32 hashVal,
-  nlog_dict_entry* head
+  nlog_dict* dict,
+  nlog_dict_entry* entry
 )
 {
-  nlog_dict_entry* ret = head;
-  while (NULL != ret)
+  UINT64 bucket = 0;
+  UINT32 slot = 0;
+
+  if (NULL == dict || NULL == entry || 0 == dict->BucketCount)
+  {
+    return NULL;
+  }
+
+  bucket = nlog_dict_bucket(hashVal, dict);
+  while (0 != (slot = dict->Buckets[bucket]))
   {
-    if (ret->Hash == hashVal)
+    if (nlog_dict_entry_hash(dict, slot - 1) == hashVal)
     {
-      return ret;
+      nlog_dict_entry_get(dict, slot - 1, entry);
+      return entry;
     }
 
-    ret = ret->next;
+    bucket = (bucket + 1) & (dict->BucketCount - 1);
   }
 
   return NULL;
 }
 
+VOID
+free_nlog_dict(
+  nlog_dict* dict
+)
+{
+  if (NULL == dict)
+  {
+    return;
+  }
+
+#ifdef OS_BUILD
+  if (dict->ImageMapped)
+  {
+    os_file_unmap(dict->Image, (size_t)dict->ImageSize);
+    dict->Image = NULL;
+  }
+#endif
+  FREE_POOL_SAFE(dict->Image);
+  //entries and strings of a text dictionary live in the same allocation as the dictionary
+  FREE_POOL_SAFE(dict);
+}
+
 /*
 Loads test binary dumps for the purpose of decoding them
 */
@@ -558,7 +972,111 @@ Finish:
   return buffer;
 }
 
-nlog_dict_entry*
+#ifdef OS_BUILD
+/*
+Maps a precompiled dictionary read only so it is looked up in place
+
+@retval the dictionary, or NULL if the file cannot be mapped or is not a valid precompiled dictionary
+*/
+STATIC
+nlog_dict*
+nlog_dict_map(
+  struct Command *pCmd,
+  CHAR8* path,
+  UINT32* version,
+  UINT64* node_count
+)
+{
+  nlog_dict* dict = NULL;
+  const VOID* image = NULL;
+  size_t image_size = 0;
+
+  image = os_file_map(path, &image_size);
+  if (NULL == image)
+  {
+    return NULL;
+  }
+
+  if (image_size >= sizeof(nlog_bin_dict_header) &&
+    NLOG_BIN_DICT_SIG == ((nlog_bin_dict_header*)image)->Signature)
+  {
+    dict = load_nlog_dict_bin(pCmd, (UINT8*)image, image_size, version, node_count);
+  }
+
+  if (NULL == dict)
+  {
+    os_file_unmap(image, image_size);
+    return NULL;
+  }
+
+  dict->Image = (VOID*)image;
+  dict->ImageSize = image_size;
+  dict->ImageMapped = TRUE;
+  return dict;
+}
+
+/*
+Maps the precompiled form of a dictionary: the file itself if it is
+precompiled, otherwise <dict>.bin next to it if that is at least as new.
+
+@retval the dictionary, or NULL to load the file as a text dictionary
+*/
+STATIC
+nlog_dict*
+nlog_dict_map_precompiled(
+  struct Command *pCmd,
+  CHAR16* pLoadUserPath,
+  UINT32* version,
+  UINT64* node_count
+)
+{
+  nlog_dict* dict = NULL;
+  CHAR8* path = NULL;
+  CHAR8* bin_path = NULL;
+  UINTN path_length = 0;
+  UINTN bin_path_length = 0;
+  UINT64 bin_mtime = 0;
+
+  path_length = StrLen(pLoadUserPath) + 1;
+  path = AllocateZeroPool(path_length);
+  bin_path = AllocateZeroPool(path_length + sizeof(NLOG_BIN_DICT_EXTENSION));
+  if (NULL == path || NULL == bin_path ||
+    EFI_ERROR(UnicodeStrToAsciiStrS(pLoadUserPath, path, path_length)))
+  {
+    goto Finish;
+  }
+
+  dict = nlog_dict_map(pCmd, path, version, node_count);
+  if (NULL != dict)
+  {
+    goto Finish;
+  }
+
+  //nlog_dict.X.X.X.XXXX.txt is compiled to nlog_dict.X.X.X.XXXX.bin
+  CopyMem(bin_path, path, path_length);
+  bin_path_length = path_length - 1;
+  if (bin_path_length >= sizeof(NLOG_TEXT_DICT_EXTENSION) - 1 &&
+    0 == AsciiStrCmp(bin_path + bin_path_length - (sizeof(NLOG_TEXT_DICT_EXTENSION) - 1), NLOG_TEXT_DICT_EXTENSION))
+  {
+    bin_path_length -= sizeof(NLOG_TEXT_DICT_EXTENSION) - 1;
+  }
+  CopyMem(bin_path + bin_path_length, NLOG_BIN_DICT_EXTENSION, sizeof(NLOG_BIN_DICT_EXTENSION));
+
+  //a precompiled dictionary older than the text one is stale
+  bin_mtime = os_get_file_mtime(bin_path);
+  if (0 != bin_mtime && bin_mtime >= os_get_file_mtime(path))
+  {
+    dict = nlog_dict_map(pCmd, bin_path, version, node_count);
+  }
+
+Finish:
+  FREE_POOL_SAFE(path);
+  FREE_POOL_SAFE(bin_path);
+  return dict;
+}
+#endif
+
+nlog_dict*
 load_nlog_dict(
   struct Command *pCmd,
   CHAR16 * pLoadUserPath,
@@ -566,7 +1084,7 @@ load_nlog_dict(
   UINT64 * node_count
 )
 {
-  nlog_dict_entry* head = NULL;
+  nlog_dict* dict = NULL;
   CHAR8** string_splits = NULL;
   CHAR8** file_lines = NULL;
   CHAR8* file_buffer = NULL;
@@ -585,6 +1103,15 @@ load_nlog_dict(
 
   *node_count = 0;
 
+#ifdef OS_BUILD
+  //a precompiled dictionary needs neither reading nor parsing
+  dict = nlog_dict_map_precompiled(pCmd, pLoadUserPath, version, node_count);
+  if (NULL != dict)
+  {
+    return dict;
+  }
+#endif
+
   CHAR16 * pDictPath = AllocateZeroPool(OPTION_VALUE_LEN * sizeof(*pDictPath));
   if (pDictPath == NULL) {
     PRINTER_SET_MSG(pPrinterCtx, ReturnCode, FORMAT_STR_NL, CLI_ERR_OUT_OF_MEMORY);
@@ -605,6 +1132,21 @@ load_nlog_dict(
     goto Finish;
   }
 
+  //prefer a precompiled dictionary, it needs no parsing
+  if (bytes_read >= sizeof(nlog_bin_dict_header) &&
+    NLOG_BIN_DICT_SIG == ((nlog_bin_dict_header*)file_buffer)->Signature)
+  {
+    dict = load_nlog_dict_bin(pCmd, (UINT8*)file_buffer, bytes_read, version, node_count);
+    if (NULL != dict)
+    {
+      //looked up in place, the dictionary releases the buffer
+      dict->Image = file_buffer;
+      dict->ImageSize = bytes_read;
+      file_buffer = NULL;
+    }
+    goto Finish;
+  }
+
   while (bytes_read > 0 &&
     (file_buffer[bytes_read - 1] == '\n' ||
       file_buffer[bytes_read - 1] == '\r' ||
@@ -642,7 +1184,7 @@ load_nlog_dict(
     goto Finish;
   }
 
-  head = load_nlog_dict_v2(pCmd, &file_lines[1], (line_count - 1), node_count);
+  dict = load_nlog_dict_v2(pCmd, &file_lines[1], (line_count - 1), node_count);
 
 Finish:
 
@@ -667,10 +1209,94 @@ Finish:
   }
 
   FREE_POOL_SAFE(file_buffer);
-  return head;
+  return dict;
 }
 
-nlog_dict_entry*
+/*
+Locates the fields of a dictionary line without copying them. Splits like
+string_split does, the last field holds the remainder of the line.
+
+@retval the number of fields found
+*/
+STATIC
+UINT64
+nlog_dict_line_fields(
+  CHAR8* line,
+  CHAR8** field_heads,
+  UINT64* field_lengths
+)
+{
+  UINT64 fields = 1;
+
+  field_heads[0] = line;
+  field_lengths[0] = 0;
+  while (*line)
+  {
+    if (*line == NLOG_DICT_SPLIT_CHAR && fields < NLOG_DICT_FIELDCOUNT)
+    {
+      field_heads[fields] = line + 1;
+      field_lengths[fields] = 0;
+      fields++;
+    }
+    else
+    {
+      field_lengths[fields - 1]++;
+    }
+
+    line++;
+  }
+
+  return fields;
+}
+
+/*
+Converts a field that is not NULL terminated, same as a_to_u32
+*/
+STATIC
+UINT32
+nlog_dict_field_to_u32(
+  CHAR8* field,
+  UINT64 length
+)
+{
+  UINT32 retval = 0;
+  UINT64 x = 0;
+
+  for (x = 0; x < length; x++)
+  {
+    retval = retval * 10;
+    retval += ((0x7f & field[x]) - 48);
+  }
+
+  return retval;
+}
+
+/*
+Copies a field into the string arena, empty fields are NULL as with string_split
+*/
+STATIC
+CHAR8*
+nlog_dict_field_to_arena(
+  CHAR8* field,
+  UINT64 length,
+  CHAR8** arena_head
+)
+{
+  CHAR8* retval = NULL;
+
+  if (0 == length)
+  {
+    return NULL;
+  }
+
+  retval = *arena_head;
+  CopyMem(retval, field, length);
+  retval[length] = 0;
+  *arena_head += length + 1;
+  return retval;
+}
+
+nlog_dict*
 load_nlog_dict_v2(
   struct Command *pCmd,
   CHAR8 ** lines,
@@ -678,12 +1304,16 @@ load_nlog_dict_v2(
   UINT64 * node_count
 )
 {
-  UINT32 x = 0;
-  nlog_dict_entry* head = NULL;
-  nlog_dict_entry* tail = NULL;
-  CHAR8* line = NULL;
+  UINT64 x = 0;
+  UINT64 y = 0;
+  nlog_dict* dict = NULL;
+  nlog_dict_entry* entry = NULL;
+  CHAR8* field_heads[NLOG_DICT_FIELDCOUNT];
+  UINT64 field_lengths[NLOG_DICT_FIELDCOUNT];
   UINT64 found_elements = 0;
-  CHAR8** parts = NULL;
+  UINT64 entry_count = 0;
+  UINT64 string_bytes = 0;
+  CHAR8* arena_head = NULL;
   PRINT_CONTEXT *pPrinterCtx = NULL;
   EFI_STATUS ReturnCode = EFI_SUCCESS;
 
@@ -693,6 +1323,10 @@ load_nlog_dict_v2(
 
   *node_count = 0;
 
+  /*
+  First pass validates the lines and sizes the arena. Entries before a malformed
+  line are still loaded.
+  */
   for (x = 0; x < line_count; x++)
   {
     if (!lines[x])
@@ -700,65 +1334,336 @@ load_nlog_dict_v2(
       break;
     }
 
-    line = lines[x];
-    parts = string_split(line, NLOG_DICT_SPLIT_CHAR, NLOG_DICT_FIELDCOUNT, &found_elements);
-    if (NULL == parts)
-    {
-      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Error in dict on line %lu - Found NULL elements, expected %lu.\n", x + 1, NLOG_DICT_FIELDCOUNT);
-      goto Finish;
-    }
-
+    found_elements = nlog_dict_line_fields(lines[x], field_heads, field_lengths);
     if (found_elements != NLOG_DICT_FIELDCOUNT)
     {
       PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Error in dict on line %lu - Found %lu elements, expected %lu.\n", x + 1, found_elements, NLOG_DICT_FIELDCOUNT);
-      goto Finish;
+      break;
     }
 
-    *node_count = *node_count + 1;
-
-    if (head == NULL)
+    for (y = 2; y < NLOG_DICT_FIELDCOUNT; y++)
     {
-      head = AllocateZeroPool(sizeof(nlog_dict_entry));
-      if (NULL == head)
+      if (field_lengths[y] > 0)
       {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-        goto Finish;
+        string_bytes += field_lengths[y] + 1;
       }
-      tail = head;
-      tail->prev = NULL;
-      tail->next = NULL;
     }
-    else
+    entry_count++;
+  }
+
+  if (0 == entry_count)
+  {
+    return NULL;
+  }
+
+  dict = nlog_dict_alloc(entry_count, nlog_dict_bucket_bits(entry_count), string_bytes);
+  if (NULL == dict)
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+    return NULL;
+  }
+
+  arena_head = (CHAR8*)(dict->Buckets + dict->BucketCount);
+
+  for (x = 0; x < entry_count; x++)
+  {
+    nlog_dict_line_fields(lines[x], field_heads, field_lengths);
+
+    entry = &dict->Entries[dict->EntryCount];
+    entry->Hash = nlog_dict_field_to_u32(field_heads[0], field_lengths[0]);
+    entry->Args = nlog_dict_field_to_u32(field_heads[1], field_lengths[1]);
+    entry->LogLevel = nlog_dict_field_to_arena(field_heads[2], field_lengths[2], &arena_head);
+    entry->FileName = nlog_dict_field_to_arena(field_heads[3], field_lengths[3], &arena_head);
+    entry->LogString = nlog_dict_field_to_arena(field_heads[4], field_lengths[4], &arena_head);
+    nlog_dict_insert(dict);
+  }
+
+  *node_count = dict->EntryCount;
+  return dict;
+}
+
+/*
+Checks that a string pool offset of a precompiled dictionary is in range
+*/
+STATIC
+BOOLEAN
+nlog_dict_pool_offset_valid(
+  UINT32 offset,
+  UINT64 pool_size
+)
+{
+  return NLOG_BIN_DICT_NO_STRING == offset || offset < pool_size;
+}
+
+nlog_dict*
+load_nlog_dict_bin(
+  struct Command *pCmd,
+  UINT8 * image,
+  UINT64 image_size,
+  UINT32 * version,
+  UINT64 * node_count
+)
+{
+  nlog_bin_dict_header* header = (nlog_bin_dict_header*)image;
+  nlog_bin_dict_entry* bin_entries = NULL;
+  UINT32* buckets = NULL;
+  CHAR8* pool = NULL;
+  nlog_dict* dict = NULL;
+  UINT64 bucket_count = 0;
+  UINT64 used_buckets = 0;
+  UINT64 x = 0;
+  PRINT_CONTEXT *pPrinterCtx = NULL;
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+
+  if (pCmd != NULL) {
+    pPrinterCtx = pCmd->pPrintCtx;
+  }
+
+  *node_count = 0;
+
+  if (NULL == image || image_size < sizeof(nlog_bin_dict_header) || NLOG_BIN_DICT_SIG != header->Signature)
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Dictionary passed is not a precompiled dictionary.\n");
+    return NULL;
+  }
+
+  if (NLOG_BIN_DICT_FORMAT_VERSION != header->FormatVersion)
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Unsupported precompiled dictionary format version %d.\n", header->FormatVersion);
+    return NULL;
+  }
+
+  //the table must keep an empty bucket so lookups terminate
+  if (header->BucketBits < NLOG_DICT_MIN_BUCKET_BITS || header->BucketBits > NLOG_DICT_MAX_BUCKET_BITS ||
+    0 == header->EntryCount || header->EntryCount >= (1ULL << header->BucketBits) ||
+    header->StringPoolSize > image_size)
+  {
+    goto Malformed;
+  }
+
+  bucket_count = 1ULL << header->BucketBits;
+  if (image_size != sizeof(nlog_bin_dict_header) + (header->EntryCount * sizeof(nlog_bin_dict_entry)) +
+    (bucket_count * sizeof(UINT32)) + header->StringPoolSize)
+  {
+    goto Malformed;
+  }
+
+  bin_entries = (nlog_bin_dict_entry*)(header + 1);
+  buckets = (UINT32*)(bin_entries + header->EntryCount);
+  pool = (CHAR8*)(buckets + bucket_count);
+
+  if (header->StringPoolSize > 0 && 0 != pool[header->StringPoolSize - 1])
+  {
+    goto Malformed;
+  }
+
+  for (x = 0; x < bucket_count; x++)
+  {
+    if (buckets[x] > header->EntryCount)
     {
-      tail->next = AllocateZeroPool(sizeof(nlog_dict_entry));
-      if (NULL == tail->next)
-      {
-        PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
-        goto Finish;
-      }
-      ((nlog_dict_entry*)tail->next)->prev = tail;
-      tail = tail->next;
+      goto Malformed;
+    }
+
+    if (0 != buckets[x])
+    {
+      used_buckets++;
+    }
+  }
+
+  if (used_buckets > header->EntryCount)
+  {
+    goto Malformed;
+  }
+
+  for (x = 0; x < header->EntryCount; x++)
+  {
+    if (!nlog_dict_pool_offset_valid(bin_entries[x].LogLevelOffset, header->StringPoolSize) ||
+      !nlog_dict_pool_offset_valid(bin_entries[x].FileNameOffset, header->StringPoolSize) ||
+      !nlog_dict_pool_offset_valid(bin_entries[x].LogStringOffset, header->StringPoolSize))
+    {
+      goto Malformed;
     }
+  }
+
+  dict = AllocateZeroPool(sizeof(nlog_dict));
+  if (NULL == dict)
+  {
+    PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Failed to allocate space for decoded records\n");
+    return NULL;
+  }
 
-    tail->Hash = a_to_u32(parts[0]);
-    tail->Args = a_to_u32(parts[1]);
+  //entries, buckets and strings are looked up in place, entries are resolved on lookup
+  dict->BinEntries = bin_entries;
+  dict->Buckets = buckets;
+  dict->Pool = pool;
+  dict->BucketCount = bucket_count;
+  dict->BucketBits = header->BucketBits;
+  dict->EntryCount = header->EntryCount;
+  *version = header->DictVersion;
+  *node_count = dict->EntryCount;
+  return dict;
+
+Malformed:
+  PRINTER_SET_MSG(pPrinterCtx, ReturnCode, L"Precompiled dictionary is malformed.\n");
+  return NULL;
+}
 
-    FREE_POOL_SAFE(parts[0]);
-    FREE_POOL_SAFE(parts[1]);
+/*
+Hashes a string for string pool deduplication, FNV-1a
+*/
+STATIC
+UINT32
+nlog_dict_string_hash(
+  CHAR8* str
+)
+{
+  UINT32 hash = NLOG_DICT_FNV_OFFSET_BASIS;
 
-    tail->LogLevel = parts[2];
-    tail->FileName = parts[3];
-    tail->LogString = parts[4];
-    tail->next = NULL;
-    FREE_POOL_SAFE(parts);
+  while (*str)
+  {
+    hash ^= (UINT8)*str;
+    hash *= NLOG_DICT_FNV_PRIME;
+    str++;
   }
 
-Finish:
-  if (parts != NULL) {
-    FREE_POOL_SAFE(parts[0]);
-    FREE_POOL_SAFE(parts[1]);
-    FREE_POOL_SAFE(parts);
+  return hash;
+}
+
+/*
+Appends a string to the pool of a dictionary image being compiled. Log levels
+and file names repeat across most entries, so identical strings are stored once.
+
+@param[in] str - the string to add, may be NULL
+@param[in] pool - the string pool
+@param[in,out] pool_size - the number of bytes used in the pool
+@param[in] slots - open addressing table of pool offset + 1, 0 when empty
+@param[in] slot_count - the number of slots, a power of 2
+
+@retval the pool offset of the string, or NLOG_BIN_DICT_NO_STRING for NULL
+*/
+STATIC
+UINT32
+nlog_dict_pool_add(
+  CHAR8* str,
+  CHAR8* pool,
+  UINT64* pool_size,
+  UINT32* slots,
+  UINT64 slot_count
+)
+{
+  UINT64 slot = 0;
+  UINT64 offset = 0;
+  UINT64 length = 0;
+
+  if (NULL == str)
+  {
+    return NLOG_BIN_DICT_NO_STRING;
+  }
+
+  slot = nlog_dict_string_hash(str) & (slot_count - 1);
+  while (0 != slots[slot])
+  {
+    if (0 == AsciiStrCmp(pool + slots[slot] - 1, str))
+    {
+      return slots[slot] - 1;
+    }
+
+    slot = (slot + 1) & (slot_count - 1);
   }
-  return head;
+
+  offset = *pool_size;
+  length = AsciiStrLen(str) + 1;
+  CopyMem(pool + offset, str, length);
+  *pool_size += length;
+  slots[slot] = (UINT32)(offset + 1);
+  return (UINT32)offset;
 }
 
+EFI_STATUS
+compile_nlog_dict(
+  nlog_dict* dict,
+  UINT32 version,
+  VOID ** image,
+  UINT64 * image_size
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  nlog_bin_dict_header* header = NULL;
+  nlog_bin_dict_entry* bin_entries = NULL;
+  nlog_dict_entry entry;
+  CHAR8* pool = NULL;
+  UINT64 pool_size = 0;
+  UINT64 string_bytes = 0;
+  UINT32* slots = NULL;
+  UINT64 slot_count = 1ULL << NLOG_DICT_MIN_BUCKET_BITS;
+  UINT64 x = 0;
+
+  if (NULL == dict || NULL == image || NULL == image_size || 0 == dict->EntryCount)
+  {
+    goto Finish;
+  }
+
+  *image = NULL;
+  *image_size = 0;
+
+  for (x = 0; x < dict->EntryCount; x++)
+  {
+    nlog_dict_entry_get(dict, x, &entry);
+    string_bytes += (NULL == entry.LogLevel) ? 0 : AsciiStrLen(entry.LogLevel) + 1;
+    string_bytes += (NULL == entry.FileName) ? 0 : AsciiStrLen(entry.FileName) + 1;
+    string_bytes += (NULL == entry.LogString) ? 0 : AsciiStrLen(entry.LogString) + 1;
+  }
+
+  //pool offsets are 32 bit with the top value reserved for NULL strings
+  if (string_bytes >= NLOG_BIN_DICT_NO_STRING)
+  {
+    ReturnCode = EFI_BAD_BUFFER_SIZE;
+    goto Finish;
+  }
+
+  while (slot_count < dict->EntryCount * NLOG_DICT_STRING_FIELDS * 2)
+  {
+    slot_count <<= 1;
+  }
+
+  slots = AllocateZeroPool(slot_count * sizeof(UINT32));
+  //sized for the worst case, the image ends where the deduplicated pool ends
+  header = AllocateZeroPool(sizeof(nlog_bin_dict_header) + (dict->EntryCount * sizeof(nlog_bin_dict_entry)) +
+    (dict->BucketCount * sizeof(UINT32)) + string_bytes);
+  if (NULL == slots || NULL == header)
+  {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  bin_entries = (nlog_bin_dict_entry*)(header + 1);
+  CopyMem(bin_entries + dict->EntryCount, dict->Buckets, dict->BucketCount * sizeof(UINT32));
+  pool = (CHAR8*)((UINT32*)(bin_entries + dict->EntryCount) + dict->BucketCount);
+
+  for (x = 0; x < dict->EntryCount; x++)
+  {
+    nlog_dict_entry_get(dict, x, &entry);
+    bin_entries[x].Hash = entry.Hash;
+    bin_entries[x].Args = (UINT32)entry.Args;
+    bin_entries[x].LogLevelOffset = nlog_dict_pool_add(entry.LogLevel, pool, &pool_size, slots, slot_count);
+    bin_entries[x].FileNameOffset = nlog_dict_pool_add(entry.FileName, pool, &pool_size, slots, slot_count);
+    bin_entries[x].LogStringOffset = nlog_dict_pool_add(entry.LogString, pool, &pool_size, slots, slot_count);
+  }
+
+  header->Signature = NLOG_BIN_DICT_SIG;
+  header->FormatVersion = NLOG_BIN_DICT_FORMAT_VERSION;
+  header->DictVersion = version;
+  header->BucketBits = dict->BucketBits;
+  header->EntryCount = dict->EntryCount;
+  header->StringPoolSize = pool_size;
+
+  *image = header;
+  *image_size = (UINT64)(pool - (CHAR8*)header) + pool_size;
+  header = NULL;
+  ReturnCode = EFI_SUCCESS;
+
+Finish:
+  FREE_POOL_SAFE(slots);
+  FREE_POOL_SAFE(header);
+  return ReturnCode;
+}
@@ -12,6 +12,10 @@
 #define NLOG_DICT_SPLIT_CHAR ','
 #define NLOG_DICT_VERSION_SPLIT_CHAR '='
 
+#define NLOG_BIN_DICT_SIG SIGNATURE_32('N', 'L', 'B', 'D')
+#define NLOG_BIN_DICT_FORMAT_VERSION 1
+#define NLOG_BIN_DICT_NO_STRING MAX_UINT32
+
 typedef union {
   struct {
     UINT32 magic_number : 24;
@@ -36,30 +40,64 @@ typedef struct {
   CHAR8* LogLevel;
   CHAR8* FileName;
   CHAR8* LogString;
-  VOID* next;
-  VOID* prev;
 } nlog_dict_entry;
 
+/*
+Dictionary of nlog entries. A text dictionary is allocated as a single arena
+laid out as [nlog_dict][entries][buckets][strings]. A precompiled dictionary
+is looked up in place in its image, which BinEntries, Buckets and Pool point
+into. Buckets are an open addressing table keyed on Hash, holding the entry
+index + 1, or 0 when empty.
+*/
 typedef struct {
-  UINT64 id;
-  UINT32 KernelTime;
-  UINT32** ArgValues;
-  nlog_dict_entry* DictEntry;
-  CHAR8* FormattedString;
-  UINT64 FormattedStringLen;
-  VOID* next;
-  VOID* prev;
-} nlog_record;
+  UINT64 EntryCount;
+  UINT64 BucketCount;
+  UINT32 BucketBits;
+  nlog_dict_entry* Entries;                         //!< entries of a text dictionary, NULL for an image
+  UINT32* Buckets;
+  struct _nlog_bin_dict_entry* BinEntries;          //!< entries of a precompiled image, NULL for text
+  CHAR8* Pool;                                      //!< string pool of a precompiled image
+  VOID* Image;                                      //!< precompiled image released with the dictionary
+  UINT64 ImageSize;
+  BOOLEAN ImageMapped;                              //!< Image is a read only file mapping, not pool memory
+} nlog_dict;
+
+/*
+Precompiled dictionary image, laid out as [header][entries][buckets][string pool].
+Buckets are stored exactly as in nlog_dict so the image can be adopted without
+parsing or rehashing. Strings are NUL terminated and shared between entries.
+*/
+#pragma pack(push)
+#pragma pack(1)
+typedef struct {
+  UINT32 Signature;                                 //!< NLOG_BIN_DICT_SIG
+  UINT32 FormatVersion;                             //!< NLOG_BIN_DICT_FORMAT_VERSION
+  UINT32 DictVersion;                               //!< version of the source text dictionary
+  UINT32 BucketBits;                                //!< log2 of the number of buckets
+  UINT64 EntryCount;                                //!< number of nlog_bin_dict_entry
+  UINT64 StringPoolSize;                            //!< size in bytes of the string pool
+} nlog_bin_dict_header;
+
+typedef struct _nlog_bin_dict_entry {
+  UINT32 Hash;
+  UINT32 Args;
+  UINT32 LogLevelOffset;                            //!< string pool offset or NLOG_BIN_DICT_NO_STRING
+  UINT32 FileNameOffset;                            //!< string pool offset or NLOG_BIN_DICT_NO_STRING
+  UINT32 LogStringOffset;                           //!< string pool offset or NLOG_BIN_DICT_NO_STRING
+} nlog_bin_dict_entry;
+#pragma pack(pop)
 
 /*
 decode_nlog_binary command
 
-@param[in] decoded_file_name - the file to append records to
+Decodes the log a window of 256 byte sections at a time, in parallel where
+threads are available, and streams the records to the file in order.
+
+@param[in] decoded_file_name - the file to write records to, it is overwritten
 @param[in] nlogbytes - the blob returned from the dump command
 @param[in] size - the number of bytes in the blob
 @param[in] dict_version - the version of the loaded dictionary
-@param[in] dict_head - the head to the dictionary linked list
-@param[out] node_count - the number of decoded entries
+@param[in] dict - the loaded dictionary
 */
 VOID
 decode_nlog_binary(
@@ -68,33 +106,50 @@ decode_nlog_binary(
   UINT8* nlogbytes,
   UINT64 size,
   UINT32 dict_version,
-  nlog_dict_entry* dict_head
+  nlog_dict* dict
 );
 
 /*
 get_nlog_entry command
 
 @param[in] hashVal - the hash to locate
-@param[in] head - the head to the dictionary linked list
+@param[in] dict - the dictionary to search
+@param[out] entry - filled in with the discovered entry, its strings point into the dictionary
 
-@retval the discovered node, or NULL
+@retval entry, or NULL if the hash is not in the dictionary
 */
 nlog_dict_entry*
 get_nlog_entry(
   IN UINT32 hashVal,
-  IN nlog_dict_entry* head
+  IN nlog_dict* dict,
+  OUT nlog_dict_entry* entry
+);
+
+/*
+free_nlog_dict command
+
+@param[in] dict - the dictionary to free, may be NULL
+*/
+VOID
+free_nlog_dict(
+  IN nlog_dict* dict
 );
 
 /*
 load_nlog_dict command
 
+Loads either a text dictionary or a precompiled one, detected by signature.
+In the OS build a precompiled image is mapped and looked up in place, and a
+text dictionary is replaced by the precompiled <dict>.bin next to it (the
+.txt extension replaced, or .bin appended) when that one is at least as new.
+
 @param[in] pDictPath - the path to the dictionary file
 @param[out] version - the version of the dictionary as detected
-@param[out] node_count - the number of nodes in the linked list
+@param[out] node_count - the number of entries in the dictionary
 
-@retval the head to the dictionary linked list
+@retval the dictionary, to be freed with free_nlog_dict, or NULL
 */
-nlog_dict_entry*
+nlog_dict*
 load_nlog_dict(
   struct Command *pCmd,
   IN CHAR16 * pDictPath,
@@ -102,16 +157,59 @@ load_nlog_dict(
   OUT UINT64 * node_count
 );
 
+/*
+load_nlog_dict_bin command
+
+The dictionary is looked up in place, the image must stay valid until
+free_nlog_dict and is not released by it.
+
+@param[in] image - the precompiled dictionary image
+@param[in] image_size - the size in bytes of the image
+@param[out] version - the version of the source dictionary
+@param[out] node_count - the number of entries in the dictionary
+
+@retval the dictionary, to be freed with free_nlog_dict, or NULL if the image is malformed
+*/
+nlog_dict*
+load_nlog_dict_bin(
+  struct Command *pCmd,
+  IN UINT8 * image,
+  IN UINT64 image_size,
+  OUT UINT32 * version,
+  OUT UINT64 * node_count
+);
+
+/*
+compile_nlog_dict command
+
+@param[in] dict - the dictionary to compile
+@param[in] version - the version of the dictionary
+@param[out] image - newly allocated precompiled dictionary image, caller must free
+@param[out] image_size - the size in bytes of the image
+
+@retval EFI_SUCCESS if the image was created
+@retval EFI_INVALID_PARAMETER if a parameter is NULL or the dictionary is empty
+@retval EFI_BAD_BUFFER_SIZE if the strings do not fit 32 bit offsets
+@retval EFI_OUT_OF_RESOURCES if memory allocation failed
+*/
+EFI_STATUS
+compile_nlog_dict(
+  IN nlog_dict* dict,
+  IN UINT32 version,
+  OUT VOID ** image,
+  OUT UINT64 * image_size
+);
+
 /*
 load_nlog_dict_v2 command
 
 @param[in] lines - the array of strings to convert to structs
 @param[in] line_count - the length of the array of strings to convert to structs
-@param[out] node_count - the number of nodes in the linked list
+@param[out] node_count - the number of entries in the dictionary
 
-@retval the head to the dictionary linked list
+@retval the dictionary, to be freed with free_nlog_dict, or NULL
 */
-nlog_dict_entry*
+nlog_dict*
 load_nlog_dict_v2(
   struct Command *pCmd,
   IN CHAR8 ** lines,
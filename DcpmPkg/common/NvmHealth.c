@@ -270,8 +270,8 @@ ConvertHealthBitmask(
 }
 
 /**
-  Convert dimm or sensor health state to a string. The caller is responsible for
-  freeing the returned string
+  Convert dimm or sensor health state to a string. The returned string is
+  borrowed from the string table and must not be freed
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Health State - Numeric Value of the Health State.
@@ -279,7 +279,7 @@ ConvertHealthBitmask(
 
   @retval String Representation of the health state
 **/
-EFI_STRING
+CONST CHAR16 *
 HealthToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 HealthState
@@ -287,19 +287,19 @@ HealthToString(
 {
   switch (HealthState) {
     case HEALTH_HEALTHY:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_HEALTHY), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_HEALTHY));
     case HEALTH_NON_CRITICAL_FAILURE:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_NON_CRITICAL_FAILURE), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_NON_CRITICAL_FAILURE));
     case HEALTH_CRITICAL_FAILURE:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_CRITICAL_FAILURE), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_CRITICAL_FAILURE));
     case HEALTH_FATAL_FAILURE:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_FATAL_FAILURE), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_FATAL_FAILURE));
     case HEALTH_UNMANAGEABLE:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_UNMANAGEABLE), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_UNMANAGEABLE));
     case HEALTH_NON_FUNCTIONAL:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_NON_FUNCTIONAL), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_NON_FUNCTIONAL));
     case HEALTH_UNKNOWN:
     default:
-      return HiiGetString(HiiHandle, STRING_TOKEN(STR_UNKNOWN), NULL);
+      return HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_UNKNOWN));
   }
 }
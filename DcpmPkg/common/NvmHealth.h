@@ -213,8 +213,8 @@ ConvertHealthBitmask(
   );
 
 /**
-  Convert PMem module or sensor health state to a string. The caller is responsible for
-  freeing the returned string
+  Convert PMem module or sensor health state to a string. The returned string is
+  borrowed from the string table and must not be freed
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] HealthState - Numeric Value of the Health State.
@@ -222,7 +222,7 @@ ConvertHealthBitmask(
 
   @retval String Representation of the health state
 **/
-EFI_STRING
+CONST CHAR16 *
 HealthToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 HealthState
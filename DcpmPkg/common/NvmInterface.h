@@ -171,6 +171,25 @@ EFI_STATUS
   IN     DIMM_INFO_CATEGORIES dimmInfoCategories,
      OUT DIMM_INFO *pDimmInfo
 );
+
+/**
+  Retrieve the identity of the PMem modules found in NFIT, in the order of
+  GetDimms() and without the cost and size of DIMM_INFO
+
+  @param[in] pThis A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] DimmCount The size of pDimmCores.
+  @param[out] pDimmCores The PMem module identities found in NFIT.
+
+  @retval EFI_SUCCESS  The PMem module list was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL or invalid.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EFI_DCPMM_CONFIG_GET_DIMM_CORES) (
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+  IN     UINT32 DimmCount,
+     OUT DIMM_INFO_CORE *pDimmCores
+);
 #ifdef OS_BUILD
 /**
   Get the PMON registers
@@ -543,6 +562,30 @@ EFI_STATUS
     OUT DIMM_PERFORMANCE_DATA **pDimmsPerformanceData
     );
 
+/**
+Read the lifetime performance counters of one PMem module
+
+Only memory info page 1 is read, the current boot counters of
+pDimmPerformanceData are left zeroed.
+
+@param[in] pThis a pointer to EFI_DCPMM_CONFIG2_PROTOCOL instance
+@param[in] DimmId PMem module to read
+@param[out] pDimmPerformanceData performance data of the PMem module
+
+@retval EFI_INVALID_PARAMETER passed NULL argument
+@retval EFI_NOT_FOUND no PMem module with DimmId
+@retval EFI_UNSUPPORTED the PMem module is not manageable
+@retval EFI_DEVICE_ERROR failure of the FW command
+@retval EFI_SUCCESS Success
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EFI_DCPMM_CONFIG_GET_DIMM_PERFORMANCE_COUNTERS) (
+    IN  EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+    IN  UINT16 DimmId,
+    OUT DIMM_PERFORMANCE_DATA *pDimmPerformanceData
+    );
+
 /**
   Get System Capabilities information from PCAT tables
   Pointer to variable length pInterleaveFormatsSupported is allocated here and must be freed by
@@ -1455,6 +1498,34 @@ EFI_STATUS
   OUT     UINT32 *pPbrMode
 );
 
+/**
+  Sets the order in which recorded pass thru requests are played back
+
+  @param[in] PbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was set.
+  @retval EFI_INVALID_PARAMETER if PbrPlaybackOrder is unknown.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EFI_DCPMM_PBR_SET_PLAYBACK_ORDER) (
+  IN     UINT32 PbrPlaybackOrder
+);
+
+/**
+  Gets the order in which recorded pass thru requests are played back
+
+  @param[out] pPbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was returned.
+  @retval EFI_INVALID_PARAMETER if one or more parameters equal NULL.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EFI_DCPMM_PBR_GET_PLAYBACK_ORDER) (
+  OUT    UINT32 *pPbrPlaybackOrder
+);
+
 /**
   Set the PBR Buffer to use
 
@@ -1474,6 +1545,7 @@ EFI_STATUS
 /**
   Get the PBR Buffer that is current being used
 
+  @param[in] Compress: TRUE to store partitions block compressed, FALSE for an uncompressed image
   @param[out] ppBufferAddress: address to the pbr buffer
   @param[out] pBufferSize: size in bytes of the buffer
 
@@ -1482,6 +1554,7 @@ EFI_STATUS
 typedef
 EFI_STATUS
 (EFIAPI *EFI_DCPMM_PBR_GET_SESSION) (
+  IN     BOOLEAN Compress,
   IN     VOID **ppBufferAddress,
   IN     UINT32 *pBufferSize
 );
@@ -1758,6 +1831,8 @@ struct _EFI_DCPMM_CONFIG2_PROTOCOL {
   EFI_DCPMM_PBR_SET_DRIVER_DEBUG_PRINT_ERROR_LEVEL SetDriverDebugPrintErrorLevel;
 #endif //OS_BUILD
   EFI_DCPMM_GET_FIPS_MODE GetFIPSMode;
+  EFI_DCPMM_CONFIG_GET_DIMM_PERFORMANCE_COUNTERS GetDimmPerformanceCounters;
+  EFI_DCPMM_CONFIG_GET_DIMM_CORES GetDimmCores;
 
 };
 
@@ -1777,5 +1852,7 @@ struct _EFI_DCPMM_PBR_PROTOCOL {
   EFI_DCPMM_PBR_GET_PB_INFO PbrGetDataPlaybackInfo;
   EFI_DCPMM_PBR_GET_DATA PbrGetData;
   EFI_DCPMM_PBR_SET_DATA PbrSetData;
+  EFI_DCPMM_PBR_SET_PLAYBACK_ORDER PbrSetPlaybackOrder;
+  EFI_DCPMM_PBR_GET_PLAYBACK_ORDER PbrGetPlaybackOrder;
 };
 #endif /** _NVM_INTERFACE_H_ **/
@@ -525,6 +525,24 @@ typedef struct _DIMM_INFO {
 
   } DIMM_INFO;
 
+// Identity of a PMem module, the part of DIMM_INFO needed to find, address and
+// name it. Taken from the global dimm struct only, without the SMBIOS lookups
+// and the strings of DIMM_INFO, for lists that no category is requested for or
+// that are kept around.
+typedef struct _DIMM_INFO_CORE {
+  UINT16 DimmID;                            //!< SMBIOS Type 17 handle
+  UINT32 DimmHandle;                        //!< The PMem module handle
+  CHAR16 DimmUid[MAX_DIMM_UID_LENGTH];      //!< Globally unique NVDIMM ID (in hexadecimal format representation)
+  UINT16 SocketId;                          //!< socket id
+  UINT16 ImcId;                             //!< Memory controller ID
+  UINT16 ChannelId;                         //!< Memory channel within an iMC
+  UINT16 ChannelPos;                        //!< Position in the channel within an iMC
+  UINT16 NodeControllerID;                  //!< The node controller identifier
+  UINT8 ManageabilityState;                 //!< If the PMem module is manageable by this SW
+  BOOLEAN IsInPopulationViolation;          //!< The PMem module population falls outside of the supported config option
+  UINT32 ErrorMask;                         //!< DIMM_INFO_ERROR_UID if the UID could not be read
+} DIMM_INFO_CORE;
+
 typedef struct _TOPOLOGY_DIMM_INFO {
   UINT8 PmttVersion;                //!< PMTT Version
   UINT8 MemoryType;                         //!< memory type
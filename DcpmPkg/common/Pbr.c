@@ -10,6 +10,7 @@
 #include <Convert.h>
 #include "Pbr.h"
 #include "PbrDcpmm.h"
+#include "PbrCompress.h"
 #ifdef OS_BUILD
 #include "PbrOs.h"
 #else
@@ -20,7 +21,7 @@ STATIC EFI_STATUS PbrDeserializeCtx(PbrContext * ctx);
 #endif
 //local helper function prototypes
 STATIC EFI_STATUS PbrCheckBufferIntegrity(PbrContext *ctx);
-STATIC EFI_STATUS PbrComposeSession(PbrContext *pContext, VOID **ppBufferAddress, UINT32 *pBufferSize);
+STATIC EFI_STATUS PbrComposeSession(PbrContext *pContext, BOOLEAN Compress, VOID **ppBufferAddress, UINT32 *pBufferSize);
 STATIC EFI_STATUS PbrDecomposeSession(PbrContext *pContext, VOID *pPbrImg, UINT32 PbrImgSize);
 STATIC EFI_STATUS PbrCreateSessionContext(PbrContext * ctx);
 STATIC UINT32 PbrPartitionCount();
@@ -393,6 +394,64 @@ PbrGetMode(
   return EFI_SUCCESS;
 }
 
+/**
+  Sets the order in which recorded pass thru requests are played back
+
+  @param[in] PbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was set.
+  @retval EFI_INVALID_PARAMETER if PbrPlaybackOrder is unknown.
+**/
+EFI_STATUS
+EFIAPI
+PbrSetPlaybackOrder(
+  IN     UINT32 PbrPlaybackOrder
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrContext *pContext = PBR_CTX();
+
+  if (PBR_PLAYBACK_ORDER_SEQUENTIAL != PbrPlaybackOrder &&
+      PBR_PLAYBACK_ORDER_KEYED != PbrPlaybackOrder) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //any previously built keyed index no longer applies
+  PbrDcpmmFreePassThruIndex();
+  PBR_SET_PLAYBACK_ORDER(pContext, PbrPlaybackOrder);
+
+  //order has changed, ensure the context gets serialized
+#ifndef OS_BUILD
+  ReturnCode = PbrSerializeCtx(pContext, TRUE);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_DBG("Failed to set PBR playback order variable!\n");
+  }
+#endif
+  return ReturnCode;
+}
+
+/**
+  Gets the order in which recorded pass thru requests are played back
+
+  @param[out] pPbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was returned.
+  @retval EFI_INVALID_PARAMETER if one or more parameters equal NULL.
+**/
+EFI_STATUS
+EFIAPI
+PbrGetPlaybackOrder(
+  OUT     UINT32 *pPbrPlaybackOrder
+)
+{
+  PbrContext *pContext = PBR_CTX();
+  if (NULL == pPbrPlaybackOrder) {
+    return EFI_INVALID_PARAMETER;
+  }
+  *pPbrPlaybackOrder = PBR_GET_PLAYBACK_ORDER(pContext);
+  return EFI_SUCCESS;
+}
+
 /**
   Set the PBR session buffer to use
 
@@ -460,6 +519,7 @@ Finish:
 /**
   Get the PBR Buffer that is current being used
 
+  @param[in] Compress: TRUE to store partitions block compressed, FALSE for an uncompressed image
   @param[out] ppBufferAddress: address to the pbr buffer
   @param[out] pBufferSize: size in bytes of the buffer
 
@@ -468,6 +528,7 @@ Finish:
 EFI_STATUS
 EFIAPI
 PbrGetSession(
+  IN     BOOLEAN Compress,
   IN     VOID **ppBufferAddress,
   IN     UINT32 *pBufferSize
 )
@@ -482,7 +543,7 @@ PbrGetSession(
   //the session at this point is just a bunch of buffers,
   //PbrComposeSession stitches all of the buffers into a contiguous format...
   //something that can be loaded and decomposed in the future
-  ReturnCode = PbrComposeSession(pContext, ppBufferAddress, pBufferSize);
+  ReturnCode = PbrComposeSession(pContext, Compress, ppBufferAddress, pBufferSize);
   if (EFI_ERROR(ReturnCode)) {
     NVDIMM_DBG("Failed to stitch image\n");
     goto Finish;
@@ -506,6 +567,8 @@ PbrFreeSession(
   UINT32 CtxIndex = 0;
   PbrContext *pContext = PBR_CTX();
 
+  PbrDcpmmFreePassThruIndex();
+
   for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
     if (PBR_INVALID_SIG != pContext->PartitionContexts[CtxIndex].PartitionSig) {
       if (pContext->PartitionContexts[CtxIndex].PartitionData) {
@@ -531,12 +594,18 @@ PbrResetSession(
 )
 {
   Tag *pTag = NULL;
+  Tag *pNextTag = NULL;
   UINT32 DataSize = 0;
   PbrContext *pContext = PBR_CTX();
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   TagPartitionInfo *pTagPartitions = NULL;
+  TagPartitionInfo *pNextTagPartitions = NULL;
   UINT32 CtxIndex = 0;
   UINT32 TagPartIndex = 0;
+  UINT32 TagCount = 0;
+
+  //keyed playback queues are scoped to a tag, rebuild them on next use
+  PbrDcpmmFreePassThruIndex();
 
   //get the actual tag data item
   //this will contain offsets for all data partitions that existed when the tag was set/created
@@ -556,6 +625,14 @@ PbrResetSession(
   //where each object describes one data partition
   pTagPartitions = (TagPartitionInfo*)((UINTN)pTag + sizeof(Tag));
 
+  //the following tag (if any) marks where the data recorded for this tag ends,
+  //there is none after the last tag and reading one would run off the partition
+  PbrGetTagCount(&TagCount);
+  if (TagId + 1 < TagCount &&
+      EFI_SUCCESS == PbrGetData(PBR_TAG_SIG, TagId + 1, (VOID**)&pNextTag, &DataSize, NULL)) {
+    pNextTagPartitions = (TagPartitionInfo*)((UINTN)pNextTag + sizeof(Tag));
+  }
+
   //need to reset each data partition to the offset specified in the tag
   for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
     //found a partition
@@ -569,10 +646,19 @@ PbrResetSession(
           break;
         }
       }
+      //default is an unbounded playback range
+      pContext->PartitionContexts[CtxIndex].PartitionEndOffset = 0;
+      for (TagPartIndex = 0; NULL != pNextTagPartitions && TagPartIndex < pNextTag->PartitionInfoCnt; ++TagPartIndex) {
+        if (pNextTagPartitions[TagPartIndex].PartitionSignature == pContext->PartitionContexts[CtxIndex].PartitionSig) {
+          pContext->PartitionContexts[CtxIndex].PartitionEndOffset = pNextTagPartitions[TagPartIndex].PartitionCurrentOffset;
+          break;
+        }
+      }
     }
   }
 Finish:
   FREE_POOL_SAFE(pTag);
+  FREE_POOL_SAFE(pNextTag);
   return ReturnCode;
 }
 
@@ -895,7 +981,7 @@ Finish:
 }
 #endif
 /**
-  Helper that decomposes/unstitches a PBR session
+  Helper that decomposes/unstitches a PBR session, compressed partitions are expanded
 **/
 STATIC
 EFI_STATUS
@@ -907,12 +993,20 @@ PbrDecomposeSession(
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   PbrPartitionTable *pPartitionTable = NULL;
+  PbrPartitionTableEntry *pEntry = NULL;
   PbrHeader *pPbrHeader = NULL;
+  VOID *pPartition = NULL;
   UINT32 PartitionIndex = 0;
 
 
   ZeroMem(pContext->PartitionContexts, sizeof(pContext->PartitionContexts));
 
+  if (PbrImgSize < sizeof(PbrHeader)) {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    NVDIMM_DBG("Invalid buffer size, smaller than the PBR master header!\n");
+    goto Finish;
+  }
+
   //update context's file header
   pContext->PbrMainHeader = (PbrHeader*)AllocateZeroPool(sizeof(PbrHeader));
   if (NULL == pContext->PbrMainHeader) {
@@ -930,22 +1024,41 @@ PbrDecomposeSession(
   pPartitionTable = (PbrPartitionTable *)&(pPbrHeader->PartitionTable);
 
   for (PartitionIndex = 0; PartitionIndex < MAX_PARTITIONS; ++PartitionIndex) {
-    if (PBR_INVALID_SIG != pPartitionTable->Partitions[PartitionIndex].Signature) {
-      pContext->PartitionContexts[PartitionIndex].PartitionSig = pPartitionTable->Partitions[PartitionIndex].Signature;
-      pContext->PartitionContexts[PartitionIndex].PartitionSize = pPartitionTable->Partitions[PartitionIndex].Size;
-      pContext->PartitionContexts[PartitionIndex].PartitionLogicalDataCnt = pPartitionTable->Partitions[PartitionIndex].LogicalDataCnt;
+    pEntry = &pPartitionTable->Partitions[PartitionIndex];
+    if (PBR_INVALID_SIG != pEntry->Signature) {
+      if ((UINT64)pEntry->Offset + pEntry->Size > PbrImgSize) {
+        ReturnCode = EFI_INVALID_PARAMETER;
+        NVDIMM_DBG("Partition 0x%x is outside of the buffer\n", pEntry->Signature);
+        goto Finish;
+      }
+      pPartition = (VOID*)((UINTN)pPbrImg + pEntry->Offset);
+      pContext->PartitionContexts[PartitionIndex].PartitionSig = pEntry->Signature;
+      pContext->PartitionContexts[PartitionIndex].PartitionLogicalDataCnt = pEntry->LogicalDataCnt;
       pContext->PartitionContexts[PartitionIndex].PartitionCurrentOffset = 0;
       pContext->PartitionContexts[PartitionIndex].PartitionEndOffset = 0;
-      pContext->PartitionContexts[PartitionIndex].PartitionData = AllocateZeroPool(pPartitionTable->Partitions[PartitionIndex].Size);
+
+      if (PbrIsCompressedPartition(pPartition, pEntry->Size)) {
+        ReturnCode = PbrDecompressPartition(pPartition, pEntry->Size,
+          &pContext->PartitionContexts[PartitionIndex].PartitionData,
+          &pContext->PartitionContexts[PartitionIndex].PartitionSize);
+        if (EFI_ERROR(ReturnCode)) {
+          NVDIMM_DBG("Failed to decompress partition 0x%x\n", pEntry->Signature);
+          goto Finish;
+        }
+        continue;
+      }
+
+      pContext->PartitionContexts[PartitionIndex].PartitionSize = pEntry->Size;
+      pContext->PartitionContexts[PartitionIndex].PartitionData = AllocateZeroPool(pEntry->Size);
       if (NULL == pContext->PartitionContexts[PartitionIndex].PartitionData) {
         ReturnCode = EFI_OUT_OF_RESOURCES;
         NVDIMM_DBG("Failed to allocate memory for partition buffer\n");
         goto Finish;
       }
       PbrCopyChunks(pContext->PartitionContexts[PartitionIndex].PartitionData,
-        pPartitionTable->Partitions[PartitionIndex].Size,
-        (VOID*)((UINTN)pPbrImg + pPartitionTable->Partitions[PartitionIndex].Offset),
-        pPartitionTable->Partitions[PartitionIndex].Size);
+        pEntry->Size,
+        pPartition,
+        pEntry->Size);
     }
   }
 
@@ -955,17 +1068,27 @@ Finish:
 
 /**
   Helper that stitches together all buffers to make a full PBR image
+
+  When Compress is TRUE each partition is stored block compressed, unless compression
+  does not make it smaller. PbrDecomposeSession detects compressed partitions by the
+  PBR_COMPRESSED_PARTITION_SIG signature, so both kinds may be mixed within an image.
 **/
 STATIC
 EFI_STATUS
 PbrComposeSession(
   IN     PbrContext *pContext,
+  IN     BOOLEAN Compress,
   OUT    VOID **ppBufferAddress,
   OUT    UINT32 *pBufferSize
 )
 {
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
   PbrHeader *pPbrMainHeader = NULL;
-  UINT32 BufferSize = 0;
+  VOID **ppCompressed = NULL;
+  UINT32 *pCompressedSizes = NULL;
+  VOID *pPartition = NULL;
+  UINT32 PartitionSize = 0;
+  UINT64 BufferSize = 0;
   UINT8 *pTemp = NULL;
   UINT32 CtxIndex = 0;
 
@@ -982,41 +1105,84 @@ PbrComposeSession(
   if (pPbrMainHeader == NULL) {
     return EFI_NOT_FOUND;
   }
+
+  if (Compress) {
+    ppCompressed = AllocateZeroPool(MAX_PARTITIONS * sizeof(*ppCompressed));
+    pCompressedSizes = AllocateZeroPool(MAX_PARTITIONS * sizeof(*pCompressedSizes));
+    if (NULL == ppCompressed || NULL == pCompressedSizes) {
+      ReturnCode = EFI_OUT_OF_RESOURCES;
+      goto Finish;
+    }
+  }
+
   ZeroMem(&pPbrMainHeader->PartitionTable, sizeof(PbrPartitionTable));
   BufferSize = sizeof(PbrHeader);
 
   for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
     if (PBR_INVALID_SIG != pContext->PartitionContexts[CtxIndex].PartitionSig) {
+      PartitionSize = pContext->PartitionContexts[CtxIndex].PartitionSize;
+      if (Compress && PartitionSize > 0) {
+        ReturnCode = PbrCompressPartition(pContext->PartitionContexts[CtxIndex].PartitionData, PartitionSize,
+          &ppCompressed[CtxIndex], &pCompressedSizes[CtxIndex]);
+        if (EFI_ERROR(ReturnCode)) {
+          NVDIMM_DBG("Failed to compress partition 0x%x\n", pContext->PartitionContexts[CtxIndex].PartitionSig);
+          goto Finish;
+        }
+        if (pCompressedSizes[CtxIndex] < PartitionSize) {
+          PartitionSize = pCompressedSizes[CtxIndex];
+        }
+        else {
+          FREE_POOL_SAFE(ppCompressed[CtxIndex]);
+        }
+      }
       pPbrMainHeader->PartitionTable.Partitions[CtxIndex].Signature = pContext->PartitionContexts[CtxIndex].PartitionSig;
-      pPbrMainHeader->PartitionTable.Partitions[CtxIndex].Size = pContext->PartitionContexts[CtxIndex].PartitionSize;
+      pPbrMainHeader->PartitionTable.Partitions[CtxIndex].Size = PartitionSize;
       pPbrMainHeader->PartitionTable.Partitions[CtxIndex].LogicalDataCnt = pContext->PartitionContexts[CtxIndex].PartitionLogicalDataCnt;
-      pPbrMainHeader->PartitionTable.Partitions[CtxIndex].Offset = BufferSize;
-      BufferSize += pContext->PartitionContexts[CtxIndex].PartitionSize;
+      pPbrMainHeader->PartitionTable.Partitions[CtxIndex].Offset = (UINT32)BufferSize;
+      BufferSize += PartitionSize;
+      if (BufferSize > MAX_UINT32) {
+        NVDIMM_DBG("PBR image exceeds the maximum size\n");
+        ReturnCode = EFI_BAD_BUFFER_SIZE;
+        goto Finish;
+      }
     }
   }
 
-  *ppBufferAddress = AllocateZeroPool(BufferSize);
-  NVDIMM_DBG("StitchImg: buffersize = %d bytes\n", BufferSize);
-  if (NULL != *ppBufferAddress) {
-    pPbrMainHeader = (PbrHeader*)*ppBufferAddress;
-    //copy the main pbr header to the buffer
-    PbrCopyChunks(*ppBufferAddress, BufferSize, pContext->PbrMainHeader, sizeof(PbrHeader));
-    //advance past the main header, this will be copied at the end
-    pTemp = (VOID*)((UINTN)(*ppBufferAddress) + (UINTN)sizeof(PbrHeader));
-    NVDIMM_DBG("Copying main header: %d bytes\n", sizeof(PbrHeader));
+  *ppBufferAddress = AllocateZeroPool((UINTN)BufferSize);
+  NVDIMM_DBG("StitchImg: buffersize = %d bytes\n", (UINT32)BufferSize);
+  if (NULL == *ppBufferAddress) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+  //copy the main pbr header to the buffer
+  PbrCopyChunks(*ppBufferAddress, (UINT32)BufferSize, pContext->PbrMainHeader, sizeof(PbrHeader));
+  //advance past the main header, this will be copied at the end
+  pTemp = (VOID*)((UINTN)(*ppBufferAddress) + (UINTN)sizeof(PbrHeader));
+  NVDIMM_DBG("Copying main header: %d bytes\n", sizeof(PbrHeader));
 
-    for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
-      if (PBR_INVALID_SIG != pContext->PartitionContexts[CtxIndex].PartitionSig) {
-        PbrCopyChunks(pTemp, BufferSize, pContext->PartitionContexts[CtxIndex].PartitionData, pContext->PartitionContexts[CtxIndex].PartitionSize);
-        pTemp += pContext->PartitionContexts[CtxIndex].PartitionSize;
+  for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
+    if (PBR_INVALID_SIG != pContext->PartitionContexts[CtxIndex].PartitionSig) {
+      pPartition = pContext->PartitionContexts[CtxIndex].PartitionData;
+      PartitionSize = pContext->PartitionContexts[CtxIndex].PartitionSize;
+      if (NULL != ppCompressed && NULL != ppCompressed[CtxIndex]) {
+        pPartition = ppCompressed[CtxIndex];
+        PartitionSize = pCompressedSizes[CtxIndex];
       }
+      PbrCopyChunks(pTemp, (UINT32)BufferSize, pPartition, PartitionSize);
+      pTemp += PartitionSize;
     }
-    *pBufferSize = BufferSize;
   }
-  else {
-    return EFI_OUT_OF_RESOURCES;
+  *pBufferSize = (UINT32)BufferSize;
+
+Finish:
+  if (NULL != ppCompressed) {
+    for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
+      FREE_POOL_SAFE(ppCompressed[CtxIndex]);
+    }
   }
-  return EFI_SUCCESS;
+  FREE_POOL_SAFE(ppCompressed);
+  FREE_POOL_SAFE(pCompressedSizes);
+  return ReturnCode;
 }
 
 /**
@@ -109,6 +109,34 @@ PbrGetMode(
   OUT     UINT32 *pPbrMode
 );
 
+/**
+  Sets the order in which recorded pass thru requests are played back
+
+  @param[in] PbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was set.
+  @retval EFI_INVALID_PARAMETER if PbrPlaybackOrder is unknown.
+**/
+EFI_STATUS
+EFIAPI
+PbrSetPlaybackOrder(
+  IN     UINT32 PbrPlaybackOrder
+  );
+
+/**
+  Gets the order in which recorded pass thru requests are played back
+
+  @param[out] pPbrPlaybackOrder: 0x0 - Sequential, 0x1 - Keyed
+
+  @retval EFI_SUCCESS if the order was returned.
+  @retval EFI_INVALID_PARAMETER if one or more parameters equal NULL.
+**/
+EFI_STATUS
+EFIAPI
+PbrGetPlaybackOrder(
+  OUT     UINT32 *pPbrPlaybackOrder
+);
+
 /**
   Set the PBR session buffer to use
 
@@ -128,6 +156,7 @@ PbrSetSession(
 /**
   Get the PBR Buffer that is current being used
 
+  @param[in] Compress: TRUE to store partitions block compressed, FALSE for an uncompressed image
   @param[out] ppBufferAddress: address to the pbr buffer
   @param[out] pBufferSize: size in bytes of the buffer
 
@@ -137,6 +166,7 @@ PbrSetSession(
 EFI_STATUS
 EFIAPI
 PbrGetSession(
+  IN     BOOLEAN Compress,
   IN     VOID **ppBufferAddress,
   IN     UINT32 *pBufferSize
 );
@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Debug.h>
+#include <Types.h>
+#include <Utility.h>
+#include "PbrCompress.h"
+
+/**
+  Block codec is a byte oriented LZ77 variant. Each block is a series of sequences:
+    token: high nibble literal count, low nibble match length - PBR_LZ_MIN_MATCH
+    [literal count extension bytes] literals
+    [2 byte little endian match offset] [match length extension bytes]
+  A nibble of 0xF is followed by extension bytes, each adding up to 0xFF, terminated
+  by a byte < 0xFF. The last sequence of a block only holds literals.
+**/
+#define PBR_LZ_MIN_MATCH                  4
+#define PBR_LZ_MAX_OFFSET                 0xFFFF
+#define PBR_LZ_NIBBLE_MAX                 0xF
+#define PBR_LZ_EXT_BYTE_MAX               0xFF
+#define PBR_LZ_HASH_BITS                  12
+#define PBR_LZ_HASH_ENTRIES               (1 << PBR_LZ_HASH_BITS)
+#define PBR_LZ_HASH_MULTIPLIER            2654435761U
+
+/**
+  Helper that reads 4 bytes regardless of alignment
+**/
+STATIC
+UINT32
+PbrLzRead32(
+  IN     CONST UINT8 *pSrc
+)
+{
+  return (UINT32)pSrc[0] | ((UINT32)pSrc[1] << 8) | ((UINT32)pSrc[2] << 16) | ((UINT32)pSrc[3] << 24);
+}
+
+/**
+  Helper that hashes 4 bytes into a match table slot
+**/
+STATIC
+UINT32
+PbrLzHash(
+  IN     UINT32 Sequence
+)
+{
+  return (UINT32)(Sequence * PBR_LZ_HASH_MULTIPLIER) >> (32 - PBR_LZ_HASH_BITS);
+}
+
+/**
+  Helper that writes a length extension
+**/
+STATIC
+VOID
+PbrLzWriteLength(
+  IN     UINT8 *pDst,
+  IN OUT UINT32 *pDstOffset,
+  IN     UINT32 Length
+)
+{
+  while (Length >= PBR_LZ_EXT_BYTE_MAX) {
+    pDst[(*pDstOffset)++] = PBR_LZ_EXT_BYTE_MAX;
+    Length -= PBR_LZ_EXT_BYTE_MAX;
+  }
+  pDst[(*pDstOffset)++] = (UINT8)Length;
+}
+
+/**
+  Helper that reads a length extension
+
+  @retval EFI_VOLUME_CORRUPTED if the extension runs past the end of the block
+**/
+STATIC
+EFI_STATUS
+PbrLzReadLength(
+  IN     CONST UINT8 *pSrc,
+  IN     UINT32 SrcSize,
+  IN OUT UINT32 *pSrcOffset,
+  IN OUT UINT32 *pLength
+)
+{
+  UINT8 Byte = 0;
+
+  do {
+    if (*pSrcOffset >= SrcSize) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    Byte = pSrc[(*pSrcOffset)++];
+    *pLength += Byte;
+  } while (Byte == PBR_LZ_EXT_BYTE_MAX);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Helper that emits one sequence, MatchLen of 0 emits the trailing literals
+
+  @retval EFI_BUFFER_TOO_SMALL if the sequence does not fit in the destination
+**/
+STATIC
+EFI_STATUS
+PbrLzWriteSequence(
+  IN     UINT8 *pDst,
+  IN     UINT32 DstCapacity,
+  IN OUT UINT32 *pDstOffset,
+  IN     CONST UINT8 *pLiterals,
+  IN     UINT32 LiteralCnt,
+  IN     UINT32 MatchOffset,
+  IN     UINT32 MatchLen
+)
+{
+  UINT64 WorstCase = 0;
+  UINT8 Token = 0;
+
+  WorstCase = (UINT64)*pDstOffset + 1 + LiteralCnt / PBR_LZ_EXT_BYTE_MAX + 1 + LiteralCnt +
+    sizeof(UINT16) + MatchLen / PBR_LZ_EXT_BYTE_MAX + 1;
+  if (WorstCase > DstCapacity) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  Token = (UINT8)(MIN(LiteralCnt, PBR_LZ_NIBBLE_MAX) << 4);
+  if (MatchLen > 0) {
+    Token |= (UINT8)MIN(MatchLen - PBR_LZ_MIN_MATCH, PBR_LZ_NIBBLE_MAX);
+  }
+  pDst[(*pDstOffset)++] = Token;
+
+  if (LiteralCnt >= PBR_LZ_NIBBLE_MAX) {
+    PbrLzWriteLength(pDst, pDstOffset, LiteralCnt - PBR_LZ_NIBBLE_MAX);
+  }
+  CopyMem(pDst + *pDstOffset, pLiterals, LiteralCnt);
+  *pDstOffset += LiteralCnt;
+
+  if (MatchLen > 0) {
+    pDst[(*pDstOffset)++] = (UINT8)(MatchOffset & 0xFF);
+    pDst[(*pDstOffset)++] = (UINT8)(MatchOffset >> 8);
+    if (MatchLen - PBR_LZ_MIN_MATCH >= PBR_LZ_NIBBLE_MAX) {
+      PbrLzWriteLength(pDst, pDstOffset, MatchLen - PBR_LZ_MIN_MATCH - PBR_LZ_NIBBLE_MAX);
+    }
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Compress a single block
+
+  @param[in] pSrc: uncompressed block
+  @param[in] SrcSize: size in bytes of the uncompressed block
+  @param[in] pHashTable: scratch match table of PBR_LZ_HASH_ENTRIES entries
+  @param[out] pDst: destination buffer
+  @param[in] DstCapacity: size in bytes of the destination buffer
+  @param[out] pDstSize: size in bytes of the compressed block
+
+  @retval EFI_SUCCESS if the block was compressed
+  @retval EFI_BUFFER_TOO_SMALL if the compressed block would not fit in DstCapacity
+**/
+STATIC
+EFI_STATUS
+PbrLzCompressBlock(
+  IN     CONST UINT8 *pSrc,
+  IN     UINT32 SrcSize,
+  IN     UINT32 *pHashTable,
+  OUT    UINT8 *pDst,
+  IN     UINT32 DstCapacity,
+  OUT    UINT32 *pDstSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  UINT32 SrcOffset = 0;
+  UINT32 Anchor = 0;
+  UINT32 DstOffset = 0;
+  UINT32 Sequence = 0;
+  UINT32 HashIndex = 0;
+  UINT32 Candidate = 0;
+  UINT32 MatchLen = 0;
+
+  //table holds position + 1 of the last occurrence of a hash, 0 when empty
+  ZeroMem(pHashTable, PBR_LZ_HASH_ENTRIES * sizeof(UINT32));
+
+  while (SrcOffset + PBR_LZ_MIN_MATCH <= SrcSize) {
+    Sequence = PbrLzRead32(pSrc + SrcOffset);
+    HashIndex = PbrLzHash(Sequence);
+    Candidate = pHashTable[HashIndex];
+    pHashTable[HashIndex] = SrcOffset + 1;
+
+    if (Candidate == 0 || SrcOffset - (Candidate - 1) > PBR_LZ_MAX_OFFSET ||
+      PbrLzRead32(pSrc + Candidate - 1) != Sequence) {
+      SrcOffset++;
+      continue;
+    }
+    Candidate--;
+
+    MatchLen = PBR_LZ_MIN_MATCH;
+    while (SrcOffset + MatchLen < SrcSize && pSrc[Candidate + MatchLen] == pSrc[SrcOffset + MatchLen]) {
+      MatchLen++;
+    }
+
+    ReturnCode = PbrLzWriteSequence(pDst, DstCapacity, &DstOffset, pSrc + Anchor, SrcOffset - Anchor,
+      SrcOffset - Candidate, MatchLen);
+    if (EFI_ERROR(ReturnCode)) {
+      goto Finish;
+    }
+    SrcOffset += MatchLen;
+    Anchor = SrcOffset;
+  }
+
+  ReturnCode = PbrLzWriteSequence(pDst, DstCapacity, &DstOffset, pSrc + Anchor, SrcSize - Anchor, 0, 0);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+  *pDstSize = DstOffset;
+
+Finish:
+  return ReturnCode;
+}
+
+/**
+  Decompress a single block, every read and write is bounds checked
+
+  @retval EFI_SUCCESS if the block decompressed to exactly DstSize bytes
+  @retval EFI_VOLUME_CORRUPTED if the block is malformed
+**/
+STATIC
+EFI_STATUS
+PbrLzDecompressBlock(
+  IN     CONST UINT8 *pSrc,
+  IN     UINT32 SrcSize,
+  OUT    UINT8 *pDst,
+  IN     UINT32 DstSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  UINT32 SrcOffset = 0;
+  UINT32 DstOffset = 0;
+  UINT32 LiteralCnt = 0;
+  UINT32 MatchOffset = 0;
+  UINT32 MatchLen = 0;
+  UINT32 Index = 0;
+  UINT8 Token = 0;
+
+  while (SrcOffset < SrcSize) {
+    Token = pSrc[SrcOffset++];
+
+    LiteralCnt = Token >> 4;
+    if (LiteralCnt == PBR_LZ_NIBBLE_MAX) {
+      ReturnCode = PbrLzReadLength(pSrc, SrcSize, &SrcOffset, &LiteralCnt);
+      if (EFI_ERROR(ReturnCode)) {
+        goto Finish;
+      }
+    }
+    if (LiteralCnt > SrcSize - SrcOffset || LiteralCnt > DstSize - DstOffset) {
+      ReturnCode = EFI_VOLUME_CORRUPTED;
+      goto Finish;
+    }
+    CopyMem(pDst + DstOffset, pSrc + SrcOffset, LiteralCnt);
+    SrcOffset += LiteralCnt;
+    DstOffset += LiteralCnt;
+
+    //trailing literals
+    if (SrcOffset == SrcSize) {
+      break;
+    }
+
+    if (SrcSize - SrcOffset < sizeof(UINT16)) {
+      ReturnCode = EFI_VOLUME_CORRUPTED;
+      goto Finish;
+    }
+    MatchOffset = (UINT32)pSrc[SrcOffset] | ((UINT32)pSrc[SrcOffset + 1] << 8);
+    SrcOffset += sizeof(UINT16);
+
+    MatchLen = Token & PBR_LZ_NIBBLE_MAX;
+    if (MatchLen == PBR_LZ_NIBBLE_MAX) {
+      ReturnCode = PbrLzReadLength(pSrc, SrcSize, &SrcOffset, &MatchLen);
+      if (EFI_ERROR(ReturnCode)) {
+        goto Finish;
+      }
+    }
+    MatchLen += PBR_LZ_MIN_MATCH;
+
+    if (MatchOffset == 0 || MatchOffset > DstOffset || MatchLen > DstSize - DstOffset) {
+      ReturnCode = EFI_VOLUME_CORRUPTED;
+      goto Finish;
+    }
+    //matches may overlap the bytes being produced, copy one byte at a time
+    for (Index = 0; Index < MatchLen; ++Index) {
+      pDst[DstOffset + Index] = pDst[DstOffset - MatchOffset + Index];
+    }
+    DstOffset += MatchLen;
+  }
+
+  if (DstOffset != DstSize) {
+    ReturnCode = EFI_VOLUME_CORRUPTED;
+  }
+
+Finish:
+  return ReturnCode;
+}
+
+/**
+  Helper that validates a compressed partition header and its block table
+**/
+STATIC
+EFI_STATUS
+PbrGetCompressedHeader(
+  IN     VOID *pCompressed,
+  IN     UINT32 CompressedSize,
+  OUT    PbrCompressedPartitionHeader **ppHeader
+)
+{
+  PbrCompressedPartitionHeader *pHeader = NULL;
+  UINT64 ExpectedBlockCnt = 0;
+  UINT32 Index = 0;
+
+  if (!PbrIsCompressedPartition(pCompressed, CompressedSize)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  pHeader = (PbrCompressedPartitionHeader *)pCompressed;
+
+  if (pHeader->Codec != PBR_CODEC_LZ || pHeader->BlockSize == 0) {
+    NVDIMM_DBG("Unsupported compressed partition codec %d\n", pHeader->Codec);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  ExpectedBlockCnt = ((UINT64)pHeader->UncompressedSize + pHeader->BlockSize - 1) / pHeader->BlockSize;
+  if (pHeader->BlockCnt != ExpectedBlockCnt ||
+    sizeof(PbrCompressedPartitionHeader) + (UINT64)pHeader->BlockCnt * sizeof(PbrCompressedBlock) > CompressedSize) {
+    NVDIMM_DBG("Compressed partition block table is invalid\n");
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  for (Index = 0; Index < pHeader->BlockCnt; ++Index) {
+    if ((UINT64)pHeader->Blocks[Index].Offset + pHeader->Blocks[Index].Size > CompressedSize) {
+      NVDIMM_DBG("Compressed block %d is out of bounds\n", Index);
+      return EFI_VOLUME_CORRUPTED;
+    }
+  }
+
+  *ppHeader = pHeader;
+  return EFI_SUCCESS;
+}
+
+/**
+  Helper that decodes one block of an already validated compressed partition
+**/
+STATIC
+EFI_STATUS
+PbrDecodeBlock(
+  IN     PbrCompressedPartitionHeader *pHeader,
+  IN     UINT32 BlockIndex,
+  OUT    UINT8 *pBlock,
+  IN     UINT32 BlockSize
+)
+{
+  PbrCompressedBlock *pBlockEntry = NULL;
+  UINT64 BlockStart = 0;
+
+  BlockStart = (UINT64)BlockIndex * pHeader->BlockSize;
+  if (BlockIndex >= pHeader->BlockCnt ||
+    BlockSize != MIN(pHeader->BlockSize, pHeader->UncompressedSize - BlockStart)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  pBlockEntry = &pHeader->Blocks[BlockIndex];
+  if (pBlockEntry->Flags & PBR_BLOCK_FLAG_STORED) {
+    if (pBlockEntry->Size != BlockSize) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    CopyMem(pBlock, (UINT8 *)pHeader + pBlockEntry->Offset, BlockSize);
+    return EFI_SUCCESS;
+  }
+  return PbrLzDecompressBlock((UINT8 *)pHeader + pBlockEntry->Offset, pBlockEntry->Size, pBlock, BlockSize);
+}
+
+/**
+  Check if a partition within a pbr image was stored compressed
+
+  @param[in] pPartition: pointer to the partition contents as stored in the image
+  @param[in] PartitionSize: size in bytes of the stored partition
+
+  @retval TRUE if the partition starts with a compressed partition header
+**/
+BOOLEAN
+PbrIsCompressedPartition(
+  IN     VOID *pPartition,
+  IN     UINT32 PartitionSize
+)
+{
+  if (NULL == pPartition || PartitionSize < sizeof(PbrCompressedPartitionHeader)) {
+    return FALSE;
+  }
+  return ((PbrCompressedPartitionHeader *)pPartition)->Signature == PBR_COMPRESSED_PARTITION_SIG;
+}
+
+/**
+  Compress a partition into independently decodable blocks
+
+  @param[in] pPartition: pointer to the raw partition contents
+  @param[in] PartitionSize: size in bytes of the raw partition
+  @param[out] ppCompressed: newly allocated compressed partition, caller must free
+  @param[out] pCompressedSize: size in bytes of the compressed partition
+
+  @retval EFI_SUCCESS if the partition was compressed
+  @retval EFI_INVALID_PARAMETER if a parameter is NULL
+  @retval EFI_OUT_OF_RESOURCES if memory allocation failed
+**/
+EFI_STATUS
+PbrCompressPartition(
+  IN     VOID *pPartition,
+  IN     UINT32 PartitionSize,
+  OUT    VOID **ppCompressed,
+  OUT    UINT32 *pCompressedSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrCompressedPartitionHeader *pHeader = NULL;
+  UINT32 *pHashTable = NULL;
+  UINT8 *pSrc = NULL;
+  UINT8 *pDst = NULL;
+  UINT64 WorstCaseSize = 0;
+  UINT32 BlockCnt = 0;
+  UINT32 BlockIndex = 0;
+  UINT32 BlockSize = 0;
+  UINT32 StoredSize = 0;
+  UINT32 DstOffset = 0;
+
+  if (NULL == pPartition || NULL == ppCompressed || NULL == pCompressedSize) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  BlockCnt = (UINT32)(((UINT64)PartitionSize + PBR_COMPRESSION_BLOCK_SZ - 1) / PBR_COMPRESSION_BLOCK_SZ);
+  DstOffset = sizeof(PbrCompressedPartitionHeader) + BlockCnt * sizeof(PbrCompressedBlock);
+  //a block that does not compress is stored as is, so the output never exceeds the input plus the block table
+  WorstCaseSize = (UINT64)DstOffset + PartitionSize;
+  if (WorstCaseSize > MAX_UINT32) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  pDst = AllocateZeroPool((UINTN)WorstCaseSize);
+  pHashTable = AllocateZeroPool(PBR_LZ_HASH_ENTRIES * sizeof(UINT32));
+  if (NULL == pDst || NULL == pHashTable) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  pHeader = (PbrCompressedPartitionHeader *)pDst;
+  pHeader->Signature = PBR_COMPRESSED_PARTITION_SIG;
+  pHeader->Codec = PBR_CODEC_LZ;
+  pHeader->UncompressedSize = PartitionSize;
+  pHeader->BlockSize = PBR_COMPRESSION_BLOCK_SZ;
+  pHeader->BlockCnt = BlockCnt;
+
+  pSrc = (UINT8 *)pPartition;
+  for (BlockIndex = 0; BlockIndex < BlockCnt; ++BlockIndex) {
+    BlockSize = MIN(PBR_COMPRESSION_BLOCK_SZ, PartitionSize - BlockIndex * PBR_COMPRESSION_BLOCK_SZ);
+    pHeader->Blocks[BlockIndex].Offset = DstOffset;
+    pHeader->Blocks[BlockIndex].Flags = 0;
+
+    //only keep the compressed form if it saves space
+    ReturnCode = PbrLzCompressBlock(pSrc, BlockSize, pHashTable, pDst + DstOffset, BlockSize - 1, &StoredSize);
+    if (EFI_ERROR(ReturnCode)) {
+      CopyMem(pDst + DstOffset, pSrc, BlockSize);
+      StoredSize = BlockSize;
+      pHeader->Blocks[BlockIndex].Flags = PBR_BLOCK_FLAG_STORED;
+      ReturnCode = EFI_SUCCESS;
+    }
+    pHeader->Blocks[BlockIndex].Size = StoredSize;
+    DstOffset += StoredSize;
+    pSrc += BlockSize;
+  }
+
+  NVDIMM_DBG("Compressed partition from %d to %d bytes\n", PartitionSize, DstOffset);
+  *ppCompressed = pDst;
+  *pCompressedSize = DstOffset;
+  pDst = NULL;
+
+Finish:
+  FREE_POOL_SAFE(pDst);
+  FREE_POOL_SAFE(pHashTable);
+  return ReturnCode;
+}
+
+/**
+  Decompress a single block of a compressed partition
+
+  @param[in] pCompressed: pointer to the compressed partition
+  @param[in] CompressedSize: size in bytes of the compressed partition
+  @param[in] BlockIndex: index of the block to decompress
+  @param[out] pBlock: buffer receiving the uncompressed block
+  @param[in] BlockSize: size in bytes of pBlock, must equal the uncompressed size of the block
+
+  @retval EFI_SUCCESS if the block was decompressed
+  @retval EFI_INVALID_PARAMETER if a parameter is invalid
+  @retval EFI_VOLUME_CORRUPTED if the block contents are malformed
+**/
+EFI_STATUS
+PbrDecompressBlock(
+  IN     VOID *pCompressed,
+  IN     UINT32 CompressedSize,
+  IN     UINT32 BlockIndex,
+  OUT    VOID *pBlock,
+  IN     UINT32 BlockSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrCompressedPartitionHeader *pHeader = NULL;
+
+  if (NULL == pBlock) {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    goto Finish;
+  }
+
+  ReturnCode = PbrGetCompressedHeader(pCompressed, CompressedSize, &pHeader);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+
+  ReturnCode = PbrDecodeBlock(pHeader, BlockIndex, pBlock, BlockSize);
+
+Finish:
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_DBG("Failed to decompress block %d\n", BlockIndex);
+  }
+  return ReturnCode;
+}
+
+/**
+  Decompress a whole partition
+
+  @param[in] pCompressed: pointer to the compressed partition
+  @param[in] CompressedSize: size in bytes of the compressed partition
+  @param[out] ppPartition: newly allocated raw partition, caller must free
+  @param[out] pPartitionSize: size in bytes of the raw partition
+
+  @retval EFI_SUCCESS if the partition was decompressed
+  @retval EFI_INVALID_PARAMETER if a parameter is NULL
+  @retval EFI_OUT_OF_RESOURCES if memory allocation failed
+  @retval EFI_VOLUME_CORRUPTED if the partition contents are malformed
+**/
+EFI_STATUS
+PbrDecompressPartition(
+  IN     VOID *pCompressed,
+  IN     UINT32 CompressedSize,
+  OUT    VOID **ppPartition,
+  OUT    UINT32 *pPartitionSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrCompressedPartitionHeader *pHeader = NULL;
+  UINT8 *pDst = NULL;
+  UINT32 BlockIndex = 0;
+  UINT32 BlockSize = 0;
+  UINT32 DstOffset = 0;
+
+  if (NULL == ppPartition || NULL == pPartitionSize) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ReturnCode = PbrGetCompressedHeader(pCompressed, CompressedSize, &pHeader);
+  if (EFI_ERROR(ReturnCode)) {
+    goto Finish;
+  }
+
+  pDst = AllocateZeroPool(pHeader->UncompressedSize);
+  if (NULL == pDst) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  for (BlockIndex = 0; BlockIndex < pHeader->BlockCnt; ++BlockIndex) {
+    BlockSize = MIN(pHeader->BlockSize, pHeader->UncompressedSize - DstOffset);
+    ReturnCode = PbrDecodeBlock(pHeader, BlockIndex, pDst + DstOffset, BlockSize);
+    if (EFI_ERROR(ReturnCode)) {
+      NVDIMM_DBG("Failed to decompress block %d\n", BlockIndex);
+      goto Finish;
+    }
+    DstOffset += BlockSize;
+  }
+
+  *ppPartition = pDst;
+  *pPartitionSize = pHeader->UncompressedSize;
+  pDst = NULL;
+
+Finish:
+  FREE_POOL_SAFE(pDst);
+  return ReturnCode;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PBR_COMPRESS_H_
+#define _PBR_COMPRESS_H_
+
+#include <Types.h>
+#include <PbrTypes.h>
+
+/**
+  Check if a partition within a pbr image was stored compressed
+
+  @param[in] pPartition: pointer to the partition contents as stored in the image
+  @param[in] PartitionSize: size in bytes of the stored partition
+
+  @retval TRUE if the partition starts with a compressed partition header
+**/
+BOOLEAN
+PbrIsCompressedPartition(
+  IN     VOID *pPartition,
+  IN     UINT32 PartitionSize
+);
+
+/**
+  Compress a partition into independently decodable blocks
+
+  @param[in] pPartition: pointer to the raw partition contents
+  @param[in] PartitionSize: size in bytes of the raw partition
+  @param[out] ppCompressed: newly allocated compressed partition, caller must free
+  @param[out] pCompressedSize: size in bytes of the compressed partition
+
+  @retval EFI_SUCCESS if the partition was compressed
+  @retval EFI_INVALID_PARAMETER if a parameter is NULL
+  @retval EFI_OUT_OF_RESOURCES if memory allocation failed
+**/
+EFI_STATUS
+PbrCompressPartition(
+  IN     VOID *pPartition,
+  IN     UINT32 PartitionSize,
+  OUT    VOID **ppCompressed,
+  OUT    UINT32 *pCompressedSize
+);
+
+/**
+  Decompress a single block of a compressed partition
+
+  @param[in] pCompressed: pointer to the compressed partition
+  @param[in] CompressedSize: size in bytes of the compressed partition
+  @param[in] BlockIndex: index of the block to decompress
+  @param[out] pBlock: buffer receiving the uncompressed block
+  @param[in] BlockSize: size in bytes of pBlock, must equal the uncompressed size of the block
+
+  @retval EFI_SUCCESS if the block was decompressed
+  @retval EFI_INVALID_PARAMETER if a parameter is invalid
+  @retval EFI_VOLUME_CORRUPTED if the block contents are malformed
+**/
+EFI_STATUS
+PbrDecompressBlock(
+  IN     VOID *pCompressed,
+  IN     UINT32 CompressedSize,
+  IN     UINT32 BlockIndex,
+  OUT    VOID *pBlock,
+  IN     UINT32 BlockSize
+);
+
+/**
+  Decompress a whole partition
+
+  @param[in] pCompressed: pointer to the compressed partition
+  @param[in] CompressedSize: size in bytes of the compressed partition
+  @param[out] ppPartition: newly allocated raw partition, caller must free
+  @param[out] pPartitionSize: size in bytes of the raw partition
+
+  @retval EFI_SUCCESS if the partition was decompressed
+  @retval EFI_INVALID_PARAMETER if a parameter is NULL
+  @retval EFI_OUT_OF_RESOURCES if memory allocation failed
+  @retval EFI_VOLUME_CORRUPTED if the partition contents are malformed
+**/
+EFI_STATUS
+PbrDecompressPartition(
+  IN     VOID *pCompressed,
+  IN     UINT32 CompressedSize,
+  OUT    VOID **ppPartition,
+  OUT    UINT32 *pPartitionSize
+);
+
+#endif //_PBR_COMPRESS_H_
@@ -13,99 +13,346 @@
 
 
 
+#define PBR_INDEX_END                     0xFFFFFFFF
+#define PBR_INDEX_MIN_BUCKETS             16
+#define PBR_FNV1A_64_OFFSET_BASIS         0xCBF29CE484222325ULL
+#define PBR_FNV1A_64_PRIME                0x100000001B3ULL
+
+/**key used to match pass thru requests in keyed playback order**/
+typedef struct _PbrPassThruKey {
+  UINT64  InputDigest;                                        //!< Digest of the small and large input payloads
+  UINT32  DimmId;                                             //!< Target DIMM ID
+  UINT8   Opcode;                                             //!< FIS Opcode
+  UINT8   SubOpcode;                                          //!< FIS SubOpcode
+}PbrPassThruKey;
+
+/**a recorded pass thru request referenced by the keyed index**/
+typedef struct _PbrPassThruIndexRecord {
+  UINT32  Offset;                                             //!< Offset of the logical data item within the pass thru partition
+  UINT32  NextRecord;                                         //!< Next record with the same key, PBR_INDEX_END if none
+}PbrPassThruIndexRecord;
+
+/**FIFO of recorded pass thru requests that share the same key**/
+typedef struct _PbrPassThruQueue {
+  PbrPassThruKey Key;
+  UINT32  Head;                                               //!< Oldest unconsumed record, PBR_INDEX_END if drained
+  UINT32  Tail;                                               //!< Most recently recorded record
+  UINT32  NextQueue;                                          //!< Next queue within the same hash bucket
+}PbrPassThruQueue;
+
+/**keyed index over the pass thru requests recorded for the current tag**/
+typedef struct _PbrPassThruIndex {
+  UINT32  BucketCnt;                                          //!< Power of two number of hash buckets
+  UINT32  *pBuckets;                                          //!< First queue of each bucket
+  UINT32  QueueCnt;                                           //!< Number of distinct keys
+  PbrPassThruQueue *pQueues;
+  UINT32  RecordCnt;                                          //!< Number of indexed requests
+  PbrPassThruIndexRecord *pRecords;
+}PbrPassThruIndex;
+
+STATIC PbrPassThruIndex gPbrPassThruIndex;
+
 /**
-  Return the current FW_CMD from the playback buffer
+  Helper that continues a FNV-1a digest over a buffer
+**/
+STATIC
+UINT64
+PbrDigest(
+  IN     UINT64 Digest,
+  IN     CONST UINT8 *pData,
+  IN     UINT32 Size
+)
+{
+  UINT32 Index = 0;
 
-  @param[in] pContext: Pbr context
-  @param[in] pCmd: current FW_CMD from the playback buffer
+  for (Index = 0; Index < Size; ++Index) {
+    Digest ^= pData[Index];
+    Digest *= PBR_FNV1A_64_PRIME;
+  }
+  return Digest;
+}
 
-  @retval EFI_SUCCESS if the table was found and is properly returned.
+/**
+  Helper that maps a pass thru key to a hash bucket
+**/
+STATIC
+UINT32
+PbrPassThruKeyBucket(
+  IN     PbrPassThruKey *pKey,
+  IN     UINT32 BucketCnt
+)
+{
+  UINT64 Hash = pKey->InputDigest;
+
+  Hash ^= ((UINT64)pKey->DimmId << 16) | ((UINT64)pKey->Opcode << 8) | pKey->SubOpcode;
+  Hash *= PBR_FNV1A_64_PRIME;
+  return (UINT32)(Hash ^ (Hash >> 32)) & (BucketCnt - 1);
+}
+
+/**
+  Helper that finds the queue associated with a pass thru key
+**/
+STATIC
+UINT32
+PbrFindPassThruQueue(
+  IN     PbrPassThruIndex *pIndex,
+  IN     PbrPassThruKey *pKey
+)
+{
+  UINT32 QueueIndex = pIndex->pBuckets[PbrPassThruKeyBucket(pKey, pIndex->BucketCnt)];
+
+  while (PBR_INDEX_END != QueueIndex) {
+    if (0 == CompareMem(&pIndex->pQueues[QueueIndex].Key, pKey, sizeof(*pKey))) {
+      break;
+    }
+    QueueIndex = pIndex->pQueues[QueueIndex].NextQueue;
+  }
+  return QueueIndex;
+}
+
+/**
+  Free the index used for keyed playback of pass thru requests.
+  The index is rebuilt on the next keyed lookup.
 **/
+VOID
+PbrDcpmmFreePassThruIndex(
+)
+{
+  FREE_POOL_SAFE(gPbrPassThruIndex.pBuckets);
+  FREE_POOL_SAFE(gPbrPassThruIndex.pQueues);
+  FREE_POOL_SAFE(gPbrPassThruIndex.pRecords);
+  ZeroMem(&gPbrPassThruIndex, sizeof(gPbrPassThruIndex));
+}
+
+/**
+  Helper that indexes the pass thru requests between the current playback offset
+  and the end of the current tag by (DimmId, Opcode, SubOpcode, input digest).
+  Requests sharing a key are chained in recorded order.
+**/
+STATIC
 EFI_STATUS
-PbrGetPassThruRecord(
-  IN    PbrContext *pContext,
-  OUT   NVM_FW_CMD *pCmd,
-  OUT   EFI_STATUS *pPassThruRc
+PbrBuildPassThruIndex(
+  IN     PbrContext *pContext
 )
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
-  PbrPassThruReq *ptReq;
-  PbrPassThruResp *ptResp;
-  VOID *pData = NULL;
-  UINT32 DataSize = 0;
-  UINT32 CurDataPos = 0;
+  PbrPassThruIndex *pIndex = &gPbrPassThruIndex;
+  PbrPartitionContext *pPartition = NULL;
+  PbrPartitionLogicalDataItem *pDataItem = NULL;
+  PbrPassThruReq *ptReq = NULL;
+  PbrPassThruKey Key;
+  UINT32 CtxIndex = 0;
+  UINT32 Offset = 0;
+  UINT32 EndOffset = 0;
+  UINT32 RecordCnt = 0;
+  UINT32 Bucket = 0;
+  UINT32 QueueIndex = 0;
+  UINT32 Index = 0;
+
+  PbrDcpmmFreePassThruIndex();
+
+  for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
+    if (PBR_PASS_THRU_SIG == pContext->PartitionContexts[CtxIndex].PartitionSig) {
+      pPartition = &pContext->PartitionContexts[CtxIndex];
+      break;
+    }
+  }
 
-  if (PBR_PLAYBACK_MODE != pContext->PbrMode) {
-    return EFI_SUCCESS;
+  if (NULL == pPartition || NULL == pPartition->PartitionData) {
+    return EFI_NOT_FOUND;
   }
 
-  ReturnCode = PbrGetData(
-                PBR_PASS_THRU_SIG,
-                GET_NEXT_DATA_INDEX,
-                &pData,
-                &DataSize,
-                NULL);
+  EndOffset = pPartition->PartitionSize;
+  if (0 != pPartition->PartitionEndOffset && pPartition->PartitionEndOffset < EndOffset) {
+    EndOffset = pPartition->PartitionEndOffset;
+  }
 
-  if (EFI_SUCCESS != ReturnCode) {
-    Print(L"Failed to get data!!!!\n");
-    return ReturnCode;
+  //first pass, count the requests recorded for the current tag
+  Offset = pPartition->PartitionCurrentOffset;
+  while (Offset + sizeof(PbrPartitionLogicalDataItem) <= EndOffset) {
+    pDataItem = (PbrPartitionLogicalDataItem *)((UINTN)pPartition->PartitionData + Offset);
+    if (PBR_LOGICAL_DATA_SIG != pDataItem->Signature ||
+        pDataItem->Size > EndOffset - Offset - sizeof(PbrPartitionLogicalDataItem)) {
+      break;
+    }
+    ++RecordCnt;
+    Offset += (sizeof(PbrPartitionLogicalDataItem) + pDataItem->Size);
   }
 
-  ptReq = (PbrPassThruReq *)pData;
-  if (pCmd->Opcode != ptReq->Opcode) {
-    NVDIMM_ERR("Get Passthru Opcode mismatch, expected 0x%x, received 0x%x\n", pCmd->Opcode, ptReq->Opcode);
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+  pIndex->BucketCnt = PBR_INDEX_MIN_BUCKETS;
+  while (pIndex->BucketCnt < RecordCnt * 2) {
+    pIndex->BucketCnt <<= 1;
   }
 
-  if (pCmd->SubOpcode != ptReq->SubOpcode) {
-    NVDIMM_ERR("Get Passthru SubOpcode mismatch, expected 0x%x, received 0x%x\n", pCmd->SubOpcode, ptReq->SubOpcode);
-    ReturnCode = EFI_LOAD_ERROR;
+  pIndex->pBuckets = AllocatePool(pIndex->BucketCnt * sizeof(*pIndex->pBuckets));
+  pIndex->pQueues = AllocateZeroPool((RecordCnt + 1) * sizeof(*pIndex->pQueues));
+  pIndex->pRecords = AllocateZeroPool((RecordCnt + 1) * sizeof(*pIndex->pRecords));
+  if (NULL == pIndex->pBuckets || NULL == pIndex->pQueues || NULL == pIndex->pRecords) {
+    NVDIMM_DBG("Failed to allocate memory for the pass thru index\n");
+    ReturnCode = EFI_OUT_OF_RESOURCES;
     goto Finish;
   }
+  for (Index = 0; Index < pIndex->BucketCnt; ++Index) {
+    pIndex->pBuckets[Index] = PBR_INDEX_END;
+  }
+
+  //second pass, chain each request onto the queue of its key
+  Offset = pPartition->PartitionCurrentOffset;
+  for (Index = 0; Index < RecordCnt; ++Index) {
+    pDataItem = (PbrPartitionLogicalDataItem *)((UINTN)pPartition->PartitionData + Offset);
+    ptReq = (PbrPassThruReq *)pDataItem->Data;
+
+    if (pDataItem->Size >= sizeof(PbrPassThruReq) &&
+        (UINT64)ptReq->InputPayloadSize + ptReq->InputLargePayloadSize <= pDataItem->Size - sizeof(PbrPassThruReq)) {
+      ZeroMem(&Key, sizeof(Key));
+      Key.DimmId = ptReq->DimmId;
+      Key.Opcode = ptReq->Opcode;
+      Key.SubOpcode = ptReq->SubOpcode;
+      //small and large input payloads are recorded back to back
+      Key.InputDigest = PbrDigest(PBR_FNV1A_64_OFFSET_BASIS, ptReq->Input,
+        ptReq->InputPayloadSize + ptReq->InputLargePayloadSize);
+
+      pIndex->pRecords[pIndex->RecordCnt].Offset = Offset;
+      pIndex->pRecords[pIndex->RecordCnt].NextRecord = PBR_INDEX_END;
+
+      QueueIndex = PbrFindPassThruQueue(pIndex, &Key);
+      if (PBR_INDEX_END == QueueIndex) {
+        Bucket = PbrPassThruKeyBucket(&Key, pIndex->BucketCnt);
+        QueueIndex = pIndex->QueueCnt++;
+        CopyMem_S(&pIndex->pQueues[QueueIndex].Key, sizeof(Key), &Key, sizeof(Key));
+        pIndex->pQueues[QueueIndex].Head = pIndex->RecordCnt;
+        pIndex->pQueues[QueueIndex].NextQueue = pIndex->pBuckets[Bucket];
+        pIndex->pBuckets[Bucket] = QueueIndex;
+      }
+      else {
+        pIndex->pRecords[pIndex->pQueues[QueueIndex].Tail].NextRecord = pIndex->RecordCnt;
+      }
+      pIndex->pQueues[QueueIndex].Tail = pIndex->RecordCnt;
+      ++pIndex->RecordCnt;
+    }
+    else {
+      NVDIMM_WARN("Skipping malformed pass thru record at offset %d\n", Offset);
+    }
+    Offset += (sizeof(PbrPartitionLogicalDataItem) + pDataItem->Size);
+  }
+
+  NVDIMM_DBG("Indexed %d pass thru requests under %d keys\n", pIndex->RecordCnt, pIndex->QueueCnt);
+
+Finish:
+  if (EFI_ERROR(ReturnCode)) {
+    PbrDcpmmFreePassThruIndex();
+  }
+  return ReturnCode;
+}
+
+/**
+  Helper that dequeues the oldest recorded request matching pCmd from the keyed index.
+  ppData points into the pass thru partition and must not be freed.
+**/
+STATIC
+EFI_STATUS
+PbrGetKeyedPassThruData(
+  IN     PbrContext *pContext,
+  IN     NVM_FW_CMD *pCmd,
+  OUT    VOID **ppData,
+  OUT    UINT32 *pDataSize
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrPassThruIndex *pIndex = &gPbrPassThruIndex;
+  PbrPassThruIndexRecord *pRecord = NULL;
+  PbrPartitionLogicalDataItem *pDataItem = NULL;
+  PbrPassThruKey Key;
+  UINT32 CtxIndex = 0;
+  UINT32 QueueIndex = 0;
+
+  if (NULL == pIndex->pBuckets) {
+    ReturnCode = PbrBuildPassThruIndex(pContext);
+    if (EFI_ERROR(ReturnCode)) {
+      return ReturnCode;
+    }
+  }
+
+  ZeroMem(&Key, sizeof(Key));
+  Key.DimmId = pCmd->DimmID;
+  Key.Opcode = pCmd->Opcode;
+  Key.SubOpcode = pCmd->SubOpcode;
+  Key.InputDigest = PbrDigest(PBR_FNV1A_64_OFFSET_BASIS, pCmd->InputPayload, pCmd->InputPayloadSize);
+  Key.InputDigest = PbrDigest(Key.InputDigest, pCmd->LargeInputPayload, pCmd->LargeInputPayloadSize);
+
+  QueueIndex = PbrFindPassThruQueue(pIndex, &Key);
+  if (PBR_INDEX_END == QueueIndex || PBR_INDEX_END == pIndex->pQueues[QueueIndex].Head) {
+    return EFI_NOT_FOUND;
+  }
+
+  pRecord = &pIndex->pRecords[pIndex->pQueues[QueueIndex].Head];
+  pIndex->pQueues[QueueIndex].Head = pRecord->NextRecord;
+
+  for (CtxIndex = 0; CtxIndex < MAX_PARTITIONS; ++CtxIndex) {
+    if (PBR_PASS_THRU_SIG == pContext->PartitionContexts[CtxIndex].PartitionSig) {
+      pDataItem = (PbrPartitionLogicalDataItem *)((UINTN)pContext->PartitionContexts[CtxIndex].PartitionData + pRecord->Offset);
+      *ppData = pDataItem->Data;
+      *pDataSize = pDataItem->Size;
+      return EFI_SUCCESS;
+    }
+  }
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Helper that copies a recorded pass thru response into pCmd
+**/
+STATIC
+EFI_STATUS
+PbrFillPassThruResponse(
+  IN     VOID *pData,
+  IN     UINT32 DataSize,
+  OUT    NVM_FW_CMD *pCmd,
+  OUT    EFI_STATUS *pPassThruRc
+)
+{
+  PbrPassThruReq *ptReq = (PbrPassThruReq *)pData;
+  PbrPassThruResp *ptResp = NULL;
+  UINT32 CurDataPos = 0;
 
   //skip past the pass through request header
   CurDataPos += sizeof(PbrPassThruReq);
   //verify we didn't run out of data
   if (CurDataPos > DataSize) {
     NVDIMM_ERR("Failed to skip past the pass through request\n");
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+    return EFI_LOAD_ERROR;
   }
 
   CurDataPos += ptReq->InputPayloadSize;
   //verify we didn't run out of data
   if (CurDataPos > DataSize) {
     NVDIMM_ERR("Failed to skip past the InputPayload\n");
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+    return EFI_LOAD_ERROR;
   }
 
   CurDataPos += ptReq->InputLargePayloadSize;
   //verify we didn't run out of data
   if (CurDataPos > DataSize) {
     NVDIMM_ERR("Failed to skip past the InputLargePayload\n");
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+    return EFI_LOAD_ERROR;
   }
 
   //should be pointing to the response header
   ptResp = (PbrPassThruResp *)((UINTN)pData + (UINTN)CurDataPos);
 
-  pCmd->Status = ptResp->Status;
-  pCmd->OutputPayloadSize = ptResp->OutputPayloadSize;
-  pCmd->LargeOutputPayloadSize = ptResp->OutputLargePayloadSize;
-  *pPassThruRc = ptResp->PassthruReturnCode;
-
   //skip past the response header
   CurDataPos += sizeof(PbrPassThruResp);
   //verify we didn't run out of data
   if (CurDataPos > DataSize) {
     NVDIMM_ERR("Failed to skip past the PbrPassThruResp\n");
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+    return EFI_LOAD_ERROR;
   }
 
+  pCmd->Status = ptResp->Status;
+  pCmd->OutputPayloadSize = ptResp->OutputPayloadSize;
+  pCmd->LargeOutputPayloadSize = ptResp->OutputLargePayloadSize;
+  *pPassThruRc = ptResp->PassthruReturnCode;
+
   //there is an output payload
   if (ptResp->OutputPayloadSize) {
     CopyMem_S(pCmd->OutPayload,
@@ -118,8 +365,7 @@ PbrGetPassThruRecord(
   //verify we didn't run out of data
   if (CurDataPos > DataSize) {
     NVDIMM_ERR("Failed to skip past the OutputPayload\n");
-    ReturnCode = EFI_LOAD_ERROR;
-    goto Finish;
+    return EFI_LOAD_ERROR;
   }
 
   //there is a large output payload
@@ -130,6 +376,73 @@ PbrGetPassThruRecord(
       ptResp->OutputLargePayloadSize);
   }
 
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the FW_CMD response from the playback buffer
+
+  @param[in] pContext: Pbr context
+  @param[in] pCmd: current FW_CMD from the playback buffer
+
+  @retval EFI_SUCCESS if the table was found and is properly returned.
+  @retval EFI_LOAD_ERROR if no matching request was recorded.
+**/
+EFI_STATUS
+PbrGetPassThruRecord(
+  IN    PbrContext *pContext,
+  OUT   NVM_FW_CMD *pCmd,
+  OUT   EFI_STATUS *pPassThruRc
+)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  PbrPassThruReq *ptReq;
+  VOID *pData = NULL;
+  UINT32 DataSize = 0;
+
+  if (PBR_PLAYBACK_MODE != pContext->PbrMode) {
+    return EFI_SUCCESS;
+  }
+
+  //keyed playback, requests may be issued in any order
+  if (PBR_PLAYBACK_ORDER_KEYED == PBR_GET_PLAYBACK_ORDER(pContext)) {
+    ReturnCode = PbrGetKeyedPassThruData(pContext, pCmd, &pData, &DataSize);
+    if (EFI_ERROR(ReturnCode)) {
+      NVDIMM_ERR("Get Passthru no recorded request for DimmId 0x%x, Opcode 0x%x, SubOpcode 0x%x\n",
+        pCmd->DimmID, pCmd->Opcode, pCmd->SubOpcode);
+      return EFI_LOAD_ERROR;
+    }
+    //pData points into the playback buffer, do not free it
+    return PbrFillPassThruResponse(pData, DataSize, pCmd, pPassThruRc);
+  }
+
+  ReturnCode = PbrGetData(
+                PBR_PASS_THRU_SIG,
+                GET_NEXT_DATA_INDEX,
+                &pData,
+                &DataSize,
+                NULL);
+
+  if (EFI_SUCCESS != ReturnCode) {
+    Print(L"Failed to get data!!!!\n");
+    return ReturnCode;
+  }
+
+  ptReq = (PbrPassThruReq *)pData;
+  if (pCmd->Opcode != ptReq->Opcode) {
+    NVDIMM_ERR("Get Passthru Opcode mismatch, expected 0x%x, received 0x%x\n", pCmd->Opcode, ptReq->Opcode);
+    ReturnCode = EFI_LOAD_ERROR;
+    goto Finish;
+  }
+
+  if (pCmd->SubOpcode != ptReq->SubOpcode) {
+    NVDIMM_ERR("Get Passthru SubOpcode mismatch, expected 0x%x, received 0x%x\n", pCmd->SubOpcode, ptReq->SubOpcode);
+    ReturnCode = EFI_LOAD_ERROR;
+    goto Finish;
+  }
+
+  ReturnCode = PbrFillPassThruResponse(pData, DataSize, pCmd, pPassThruRc);
+
 Finish:
   FREE_POOL_SAFE(pData);
   return ReturnCode;
@@ -59,13 +59,19 @@ typedef struct _PbrSmbiosTableRecord
 }PbrSmbiosTableRecord;
 
 /**
-  Return the current FW_CMD from the playback buffer
+  Return the FW_CMD response from the playback buffer
+
+  In sequential playback order the next recorded request is returned and must
+  match the Opcode/SubOpcode of pCmd.  In keyed playback order the oldest
+  unconsumed request recorded for the current tag with the same DimmId, Opcode,
+  SubOpcode and input payload is returned, regardless of the order of requests.
 
   @param[in] pContext: Pbr context
   @param[in] pCmd: current FW_CMD from the playback buffer
 
   @retval EFI_SUCCESS if the table was found and is properly returned.
   @retval EFI_INVALID_PARAMETER if one or more parameters equal NULL.
+  @retval EFI_LOAD_ERROR if no matching request was recorded.
 **/
 EFI_STATUS
 PbrGetPassThruRecord(
@@ -192,4 +198,12 @@ PbrSetTableRecord(
   IN    UINT32 TableSize
 );
 
+/**
+  Free the index used for keyed playback of pass thru requests.
+  The index is rebuilt on the next keyed lookup.
+**/
+VOID
+PbrDcpmmFreePassThruIndex(
+);
+
 #endif //_PBR_DCPMM_H_
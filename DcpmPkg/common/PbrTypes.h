@@ -11,6 +11,9 @@
 #define PBR_RECORD_MODE                       0x1
 #define PBR_PLAYBACK_MODE                     0x2
 
+#define PBR_PLAYBACK_ORDER_SEQUENTIAL         0x0
+#define PBR_PLAYBACK_ORDER_KEYED              0x1
+
 #define GET_NEXT_DATA_INDEX                   -1
 #define MAX_PARTITIONS                        100
 #define MAX_TAG_NAME                          256
@@ -27,6 +30,11 @@
 #define PBR_HEADER_SIG                        SIGNATURE_32('P', 'B', 'R', 'H')
 #define PBR_TAG_HEADER_SIG                    SIGNATURE_32('P', 'B', 'T', 'H')
 #define PBR_TAG_SIG                           SIGNATURE_32('P', 'B', 'T', 'I')
+#define PBR_COMPRESSED_PARTITION_SIG          SIGNATURE_32('P', 'B', 'C', 'P')
+
+#define PBR_CODEC_LZ                          0x1
+#define PBR_COMPRESSION_BLOCK_SZ              (64 * 1024)
+#define PBR_BLOCK_FLAG_STORED                 0x1
 
 
 /**set playback/record/normal mode**/
@@ -37,6 +45,14 @@
 #define PBR_GET_MODE(ctx) \
   (ctx)->PbrMode
 
+/**set sequential/keyed playback order**/
+#define PBR_SET_PLAYBACK_ORDER(ctx, order) \
+  (ctx)->PbrPlaybackOrder = order
+
+/**get current sequential/keyed playback order**/
+#define PBR_GET_PLAYBACK_ORDER(ctx) \
+  (ctx)->PbrPlaybackOrder
+
 /**obtain pointer to the playback/recording module context**/
 #define PBR_CTX() \
   &gPbrContext
@@ -49,13 +65,14 @@ typedef struct _PbrPartitionContext {
   UINT32 PartitionSize;                                       //!< Size in bytes of the partition
   UINT32 PartitionLogicalDataCnt;                             //!< How many logical data items exist in the partition
   UINT32 PartitionCurrentOffset;                              //!< Offset used to keep track of current position when in record or playback mode
-  UINT32 PartitionEndOffset;                                  //!< Placeholder
+  UINT32 PartitionEndOffset;                                  //!< End of the playback range of the current tag, 0 if unbounded
   VOID  *PartitionData;                                       //!< Pointer to actual data item
 }PbrPartitionContext;
 
 /**the main pbr context that contains pointers to various data structures**/
 typedef struct _PbrContext {
   UINT32 PbrMode;                                             //!< PBR_NORMAL_MODE, PBR_RECORD_MODE, PBR_PLAYBACK_MODE
+  UINT32 PbrPlaybackOrder;                                    //!< PBR_PLAYBACK_ORDER_SEQUENTIAL, PBR_PLAYBACK_ORDER_KEYED
   VOID  *PbrMainHeader;                                       //!< Main PBR buffer header, includes partition table
   PbrPartitionContext PartitionContexts[MAX_PARTITIONS];
 }PbrContext;
@@ -104,6 +121,23 @@ typedef struct _TagPartitionInfo {
   UINT32 PartitionCurrentOffset;                              //!< Playback or Recording offset of the partition
 }TagPartitionInfo;
 
+/**entry in the block table of a compressed partition**/
+typedef struct _PbrCompressedBlock {
+  UINT32 Offset;                                              //!< Offset of the block from the start of the compressed partition header
+  UINT32 Size;                                                //!< Size in bytes of the block as stored
+  UINT32 Flags;                                               //!< PBR_BLOCK_FLAG_STORED if the block was not compressed
+}PbrCompressedBlock;
+
+/**header that replaces the raw contents of a partition within a compressed pbr image**/
+typedef struct _PbrCompressedPartitionHeader {
+  UINT32 Signature;                                           //!< PBR_COMPRESSED_PARTITION_SIG
+  UINT32 Codec;                                               //!< PBR_CODEC_LZ
+  UINT32 UncompressedSize;                                    //!< Size in bytes of the partition once decompressed
+  UINT32 BlockSize;                                           //!< Size in bytes of each uncompressed block, the last one may be shorter
+  UINT32 BlockCnt;                                            //!< Number of entries in the block table that follows this struct
+  PbrCompressedBlock Blocks[];                                //!< Block table, followed by the block data
+}PbrCompressedPartitionHeader;
+
 extern PbrContext gPbrContext;                                //!< extern global context
 #pragma pack(pop)
 #endif //_PBR_TYPES_H_
@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "PerformanceSampler.h"
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#ifdef OS_BUILD
+#include <os.h>
+#endif
+
+/*
+* Share of the PMem modules of a sample read by one thread
+*/
+typedef struct _PERFORMANCE_SAMPLER_WORKER {
+  PERFORMANCE_SAMPLER *pSampler;
+  PERFORMANCE_COUNTERS *pRow;   //row of the ring being filled
+  UINT32 First;                 //first PMem module index read by the worker
+  UINT32 Step;                  //distance between the indexes it reads
+  VOID *pThread;                //reading thread, NULL when read inline
+} PERFORMANCE_SAMPLER_WORKER;
+
+/*
+* Read the PMem modules of one worker
+*/
+STATIC VOID ReadSamplerCounters(IN OUT VOID *pArg) {
+  PERFORMANCE_SAMPLER_WORKER *pWorker = (PERFORMANCE_SAMPLER_WORKER *)pArg;
+  PERFORMANCE_SAMPLER *pSampler = pWorker->pSampler;
+  PERFORMANCE_COUNTERS *pCounters = NULL;
+  DIMM_PERFORMANCE_DATA PerformanceData;
+  UINT32 Index = 0;
+
+  for (Index = pWorker->First; Index < pSampler->DimmCount; Index += pWorker->Step) {
+    pCounters = &pWorker->pRow[Index];
+    ZeroMem(pCounters, sizeof(*pCounters));
+    pCounters->ReturnCode = pSampler->pNvmDimmConfigProtocol->GetDimmPerformanceCounters(
+        pSampler->pNvmDimmConfigProtocol, pSampler->pDimmIds[Index], &PerformanceData);
+    if (EFI_ERROR(pCounters->ReturnCode)) {
+      continue;
+    }
+    pCounters->MediaReads = PerformanceData.TotalMediaReads.Uint64;
+    pCounters->MediaWrites = PerformanceData.TotalMediaWrites.Uint64;
+    pCounters->ReadRequests = PerformanceData.TotalReadRequests.Uint64;
+    pCounters->WriteRequests = PerformanceData.TotalWriteRequests.Uint64;
+  }
+}
+
+/*
+* Time of a sample taken now. Without a clock the UEFI build uses the schedule itself.
+*/
+STATIC UINT64 SamplerNowMs(IN PERFORMANCE_SAMPLER *pSampler) {
+#ifdef OS_BUILD
+  return os_get_monotonic_ms();
+#else
+  return pSampler->NextMs;
+#endif
+}
+
+/*
+* Increments per second of a counter, without overflowing on huge increments
+*/
+STATIC UINT64 CounterRate(UINT64 Delta, UINT64 IntervalMs) {
+  if (0 == IntervalMs) {
+    return 0;
+  }
+  if (Delta > MAX_UINT64 / PERFORMANCE_SAMPLER_MS_PER_SEC) {
+    return Delta / IntervalMs * PERFORMANCE_SAMPLER_MS_PER_SEC;
+  }
+  return Delta * PERFORMANCE_SAMPLER_MS_PER_SEC / IntervalMs;
+}
+
+EFI_STATUS
+PerformanceSamplerCreate(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     UINT16 *pDimmIds,
+  IN     UINT32 DimmCount,
+  IN     UINT32 IntervalMs,
+  IN     UINT32 Depth,
+  IN     BOOLEAN Concurrent,
+     OUT PERFORMANCE_SAMPLER **ppSampler
+  )
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  PERFORMANCE_SAMPLER *pSampler = NULL;
+
+  NVDIMM_ENTRY();
+
+  if (NULL == pNvmDimmConfigProtocol || NULL == pDimmIds || NULL == ppSampler ||
+      0 == DimmCount || 0 == IntervalMs || Depth < PERFORMANCE_SAMPLER_MIN_DEPTH ||
+      (UINT64)Depth * DimmCount > MAX_UINTN / sizeof(PERFORMANCE_COUNTERS)) {
+    goto Finish;
+  }
+
+  ReturnCode = EFI_OUT_OF_RESOURCES;
+  if (NULL == (pSampler = AllocateZeroPool(sizeof(*pSampler))) ||
+      NULL == (pSampler->pDimmIds = AllocateCopyPool(sizeof(*pDimmIds) * DimmCount, pDimmIds)) ||
+      NULL == (pSampler->pTimesMs = AllocateZeroPool(sizeof(*pSampler->pTimesMs) * Depth)) ||
+      NULL == (pSampler->pSamples = AllocateZeroPool(sizeof(*pSampler->pSamples) * Depth * DimmCount))) {
+    NVDIMM_ERR("Memory allocation failure");
+    PerformanceSamplerFree(&pSampler);
+    goto Finish;
+  }
+  pSampler->pNvmDimmConfigProtocol = pNvmDimmConfigProtocol;
+  pSampler->DimmCount = DimmCount;
+  pSampler->IntervalMs = IntervalMs;
+  pSampler->Depth = Depth;
+  pSampler->Concurrent = Concurrent;
+  *ppSampler = pSampler;
+  ReturnCode = EFI_SUCCESS;
+
+Finish:
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+VOID
+PerformanceSamplerFree(
+  IN OUT PERFORMANCE_SAMPLER **ppSampler
+  )
+{
+  if (NULL == ppSampler || NULL == *ppSampler) {
+    return;
+  }
+  FREE_POOL_SAFE((*ppSampler)->pDimmIds);
+  FREE_POOL_SAFE((*ppSampler)->pTimesMs);
+  FREE_POOL_SAFE((*ppSampler)->pSamples);
+  FREE_POOL_SAFE(*ppSampler);
+}
+
+VOID
+PerformanceSamplerWait(
+  IN     PERFORMANCE_SAMPLER *pSampler
+  )
+{
+#ifdef OS_BUILD
+  UINT64 NowMs = 0;
+#endif
+
+  if (NULL == pSampler || 0 == pSampler->SampleCount) {
+    return;
+  }
+#ifdef OS_BUILD
+  NowMs = os_get_monotonic_ms();
+  if (pSampler->NextMs > NowMs) {
+    gBS->Stall((UINTN)(pSampler->NextMs - NowMs) * 1000);
+  }
+#else
+  gBS->Stall((UINTN)pSampler->IntervalMs * 1000);
+#endif
+}
+
+EFI_STATUS
+PerformanceSamplerTake(
+  IN OUT PERFORMANCE_SAMPLER *pSampler
+  )
+{
+  PERFORMANCE_SAMPLER_WORKER Workers[PERFORMANCE_SAMPLER_MAX_THREADS];
+  UINT32 WorkerCount = 1;
+  UINT32 Index = 0;
+  UINT64 Row = 0;
+  UINT64 TimeMs = 0;
+#ifdef OS_BUILD
+  UINT64 NowMs = 0;
+#endif
+
+  if (NULL == pSampler) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Row = pSampler->SampleCount % pSampler->Depth;
+  TimeMs = SamplerNowMs(pSampler);
+#ifdef OS_BUILD
+  if (pSampler->Concurrent) {
+    WorkerCount = MIN(pSampler->DimmCount, PERFORMANCE_SAMPLER_MAX_THREADS);
+  }
+#endif
+
+  // the calling thread reads the share of the first worker itself
+  ZeroMem(Workers, sizeof(Workers));
+  for (Index = 0; Index < WorkerCount; Index++) {
+    Workers[Index].pSampler = pSampler;
+    Workers[Index].pRow = &pSampler->pSamples[Row * pSampler->DimmCount];
+    Workers[Index].First = Index;
+    Workers[Index].Step = WorkerCount;
+#ifdef OS_BUILD
+    if (0 < Index) {
+      Workers[Index].pThread = os_thread_create(ReadSamplerCounters, &Workers[Index]);
+    }
+#endif
+  }
+  for (Index = 0; Index < WorkerCount; Index++) {
+    if (NULL == Workers[Index].pThread) {
+      ReadSamplerCounters(&Workers[Index]);
+    }
+  }
+#ifdef OS_BUILD
+  for (Index = 1; Index < WorkerCount; Index++) {
+    if (NULL != Workers[Index].pThread) {
+      os_thread_join(Workers[Index].pThread);
+    }
+  }
+#endif
+
+  pSampler->pTimesMs[Row] = TimeMs;
+  pSampler->SampleCount++;
+  if (1 == pSampler->SampleCount) {
+    pSampler->NextMs = TimeMs;
+  }
+  pSampler->NextMs += pSampler->IntervalMs;
+#ifdef OS_BUILD
+  NowMs = os_get_monotonic_ms();
+  if (pSampler->NextMs <= NowMs) {
+    pSampler->NextMs += ((NowMs - pSampler->NextMs) / pSampler->IntervalMs + 1) * pSampler->IntervalMs;
+  }
+#endif
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+PerformanceSamplerGetDeltas(
+  IN     PERFORMANCE_SAMPLER *pSampler,
+  IN     UINT32 Age,
+     OUT PERFORMANCE_DELTA *pDeltas
+  )
+{
+  PERFORMANCE_COUNTERS *pNew = NULL;
+  PERFORMANCE_COUNTERS *pOld = NULL;
+  PERFORMANCE_DELTA *pDelta = NULL;
+  UINT64 NewRow = 0;
+  UINT64 OldRow = 0;
+  UINT64 IntervalMs = 0;
+  UINT32 Index = 0;
+
+  if (NULL == pSampler || NULL == pDeltas) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((UINT64)Age + PERFORMANCE_SAMPLER_MIN_DEPTH > MIN(pSampler->SampleCount, pSampler->Depth)) {
+    return EFI_NOT_FOUND;
+  }
+
+  NewRow = (pSampler->SampleCount - 1 - Age) % pSampler->Depth;
+  OldRow = (pSampler->SampleCount - 2 - Age) % pSampler->Depth;
+  IntervalMs = pSampler->pTimesMs[NewRow] - pSampler->pTimesMs[OldRow];
+
+  for (Index = 0; Index < pSampler->DimmCount; Index++) {
+    pNew = &pSampler->pSamples[NewRow * pSampler->DimmCount + Index];
+    pOld = &pSampler->pSamples[OldRow * pSampler->DimmCount + Index];
+    pDelta = &pDeltas[Index];
+
+    ZeroMem(pDelta, sizeof(*pDelta));
+    pDelta->DimmId = pSampler->pDimmIds[Index];
+    pDelta->IntervalMs = IntervalMs;
+    pDelta->ReturnCode = EFI_ERROR(pNew->ReturnCode) ? pNew->ReturnCode : pOld->ReturnCode;
+    if (EFI_ERROR(pDelta->ReturnCode)) {
+      continue;
+    }
+
+    // unsigned subtraction is modulo 2^64, a counter wrapping in between still yields its increment
+    pDelta->Delta.MediaReads = pNew->MediaReads - pOld->MediaReads;
+    pDelta->Delta.MediaWrites = pNew->MediaWrites - pOld->MediaWrites;
+    pDelta->Delta.ReadRequests = pNew->ReadRequests - pOld->ReadRequests;
+    pDelta->Delta.WriteRequests = pNew->WriteRequests - pOld->WriteRequests;
+
+    pDelta->Rate.MediaReads = CounterRate(pDelta->Delta.MediaReads, IntervalMs);
+    pDelta->Rate.MediaWrites = CounterRate(pDelta->Delta.MediaWrites, IntervalMs);
+    pDelta->Rate.ReadRequests = CounterRate(pDelta->Delta.ReadRequests, IntervalMs);
+    pDelta->Rate.WriteRequests = CounterRate(pDelta->Delta.WriteRequests, IntervalMs);
+  }
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _PERFORMANCE_SAMPLER_H_
+#define _PERFORMANCE_SAMPLER_H_
+
+#include <Uefi.h>
+#include <Debug.h>
+#include <Types.h>
+#include <NvmInterface.h>
+
+#define PERFORMANCE_SAMPLER_MIN_DEPTH     2     //!< A delta needs two samples
+#define PERFORMANCE_SAMPLER_MAX_THREADS   8     //!< PMem modules read at the same time, OS builds only
+#define PERFORMANCE_SAMPLER_MS_PER_SEC    1000
+
+/**
+  Lifetime performance counters of one PMem module in one sample.
+  Only the low 64 bits of the FW counters are kept, deltas are taken modulo 2^64.
+**/
+typedef struct _PERFORMANCE_COUNTERS {
+  EFI_STATUS ReturnCode;      //!< Result of the read, the counters are only valid on success
+  UINT64 MediaReads;          //!< 64-byte reads from media
+  UINT64 MediaWrites;         //!< 64-byte writes to media
+  UINT64 ReadRequests;        //!< DDRT read transactions serviced
+  UINT64 WriteRequests;       //!< DDRT write transactions serviced
+} PERFORMANCE_COUNTERS;
+
+/**
+  Change of the performance counters of one PMem module between two samples
+**/
+typedef struct _PERFORMANCE_DELTA {
+  UINT16 DimmId;              //!< PMem module the delta belongs to
+  EFI_STATUS ReturnCode;      //!< Error reading either sample, the rest is only valid on success
+  UINT64 IntervalMs;          //!< Time between the two samples
+  PERFORMANCE_COUNTERS Delta; //!< Counter increments over the interval
+  PERFORMANCE_COUNTERS Rate;  //!< Counter increments per second over the interval
+} PERFORMANCE_DELTA;
+
+/**
+  Samples the performance counters of a set of PMem modules on a fixed
+  schedule and keeps the last Depth samples in a ring.
+**/
+typedef struct _PERFORMANCE_SAMPLER {
+  EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol; //!< Config protocol used for the reads
+  UINT16 *pDimmIds;                                   //!< PMem modules sampled
+  UINT32 DimmCount;                                   //!< Number of entries in pDimmIds
+  UINT32 IntervalMs;                                  //!< Period of the schedule
+  UINT32 Depth;                                       //!< Samples kept in the ring
+  BOOLEAN Concurrent;                                 //!< Whether the PMem modules may be read in parallel
+  UINT64 SampleCount;                                 //!< Samples taken, the newest is in row (SampleCount - 1) % Depth
+  UINT64 NextMs;                                      //!< Scheduled time of the next sample
+  UINT64 *pTimesMs;                                   //!< Time of each sample in the ring
+  PERFORMANCE_COUNTERS *pSamples;                     //!< Ring of Depth rows of DimmCount entries
+} PERFORMANCE_SAMPLER;
+
+/**
+  Create a sampler. No sample is taken yet.
+
+  @param[in] pNvmDimmConfigProtocol config protocol used for the reads
+  @param[in] pDimmIds PMem modules to sample, copied
+  @param[in] DimmCount number of entries in pDimmIds
+  @param[in] IntervalMs period of the schedule in milliseconds
+  @param[in] Depth samples kept in the ring, at least PERFORMANCE_SAMPLER_MIN_DEPTH
+  @param[in] Concurrent whether the PMem modules may be read in parallel
+  @param[out] ppSampler the new sampler, released with PerformanceSamplerFree
+
+  @retval EFI_SUCCESS Success
+  @retval EFI_INVALID_PARAMETER NULL argument, no PMem module, zero interval or depth too small
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+**/
+EFI_STATUS
+PerformanceSamplerCreate(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pNvmDimmConfigProtocol,
+  IN     UINT16 *pDimmIds,
+  IN     UINT32 DimmCount,
+  IN     UINT32 IntervalMs,
+  IN     UINT32 Depth,
+  IN     BOOLEAN Concurrent,
+     OUT PERFORMANCE_SAMPLER **ppSampler
+  );
+
+/**
+  Release a sampler and set the pointer to NULL
+
+  @param[in,out] ppSampler sampler to release, may point to NULL
+**/
+VOID
+PerformanceSamplerFree(
+  IN OUT PERFORMANCE_SAMPLER **ppSampler
+  );
+
+/**
+  Sleep until the next sample is due. Returns at once before the first sample.
+
+  OS builds follow a monotonic clock, so the period does not drift with the
+  time a sample takes. The UEFI build has no clock to follow and sleeps one
+  full interval.
+
+  @param[in] pSampler sampler to wait for
+**/
+VOID
+PerformanceSamplerWait(
+  IN     PERFORMANCE_SAMPLER *pSampler
+  );
+
+/**
+  Read the counters of every PMem module into the next row of the ring,
+  overwriting the oldest sample once the ring is full.
+
+  Due times missed by a slow read are skipped rather than bunched up.
+  A PMem module that fails to read only invalidates its own entry.
+
+  @param[in,out] pSampler sampler to take the sample with
+
+  @retval EFI_SUCCESS the sample was taken, entries may still carry errors
+  @retval EFI_INVALID_PARAMETER pSampler is NULL
+**/
+EFI_STATUS
+PerformanceSamplerTake(
+  IN OUT PERFORMANCE_SAMPLER *pSampler
+  );
+
+/**
+  Compute the deltas and rates of one interval of the ring
+
+  @param[in] pSampler sampler holding the samples
+  @param[in] Age interval to compute, 0 for the one ending at the newest sample
+  @param[out] pDeltas one entry per sampled PMem module, in pDimmIds order
+
+  @retval EFI_SUCCESS Success, entries may still carry errors
+  @retval EFI_INVALID_PARAMETER NULL argument
+  @retval EFI_NOT_FOUND the ring does not hold both ends of the interval
+**/
+EFI_STATUS
+PerformanceSamplerGetDeltas(
+  IN     PERFORMANCE_SAMPLER *pSampler,
+  IN     UINT32 Age,
+     OUT PERFORMANCE_DELTA *pDeltas
+  );
+
+#endif /** _PERFORMANCE_SAMPLER_H_ **/
@@ -7,6 +7,7 @@
 #include <Debug.h>
 #include <NvmDimmCli.h>
 #include <Library/BaseMemoryLib.h>
+#include <Arena.h>
 #include <Common.h>
 
 #define EXPAND_STR_MAX                    1024
@@ -35,10 +36,15 @@
 #define TEXT_LIST_HEADER                  L"---"
 #define TEXT_LIST_KEY_VAL_DELIM           L"="
 
+#define TEXT_LINE_FIELD_DELIM             L"\t"
+#define TEXT_LINE_KEY_VAL_DELIM           L"="
+
 #define CHAR_NULL_TERM                    L'\0'
 #define CHAR_PATH_DELIM                   L'/'
 #define CHAR_WHITE_SPACE                  L' '
 #define CELL_EXTRA_CHARS                  2 //1 for leading whitespace and 1 for terminating pipe
+#define UTF8_WRITER_BUFFER_SIZE           4096
+#define UTF8_REPLACEMENT_CHAR             0xFFFD
 
 BOOLEAN gDisplayNulls = FALSE;
 UINT32 gNullValuesEncounteredForDisplay = 0;
@@ -47,9 +53,32 @@ CHAR16* gNullValueToDisplay = L"NULL";
 typedef enum {
   PRINT_TEXT,
   PRINT_BASIC_XML,
-  PRINT_XML
+  PRINT_XML,
+  PRINT_JSON,
+  PRINT_CSV
 }PRINT_MODE;
 
+typedef enum {
+  UTF8_ESCAPE_JSON,
+  UTF8_ESCAPE_CSV
+}UTF8_ESCAPE;
+
+/*
+* Output buffer of the machine formats (-o json, -o csv).  Keys and values are
+* encoded straight from the data set into UTF-8 and written out when the buffer
+* fills up, instead of formatting every fragment through Print().
+*/
+typedef struct _UTF8_WRITER {
+  CHAR8 Buf[UTF8_WRITER_BUFFER_SIZE];
+  UINTN Len;
+  UINTN MemberCnt;          //JSON members written in the current document
+  UINTN RecordCnt;          //records written in the current data set
+  UINTN MsgCnt;             //messages written in the current JSON message member
+  UINT32 CsvHeaderHash;     //hash of the key names in the last CSV header written
+}UTF8_WRITER;
+
+static UTF8_WRITER mUtf8Writer;
+
 typedef struct _PRV_TABLE_INFO {
   PRINTER_TABLE_ATTRIB *AllTableAttribs;
   PRINTER_TABLE_ATTRIB *ModifiedTableAttribs;
@@ -105,7 +134,7 @@ Example: ---Dimm=$(DimmId)--- Expands to: ---Dimm=0x0001---
 **/
 static CHAR16 *TextListExpandStr(IN DATA_SET_CONTEXT *DataSetCtx, IN const CHAR16 *Str) {
   CHAR16 *Val = NULL;
-  CHAR16 *ExpandedStr = AllocateZeroPool(EXPAND_STR_MAX);
+  CHAR16 *ExpandedStr = ArenaAllocateZeroPool(EXPAND_STR_MAX);
   const CHAR16 *OriginalStrTmpBegin = Str;
   const CHAR16 *OriginalStrTmpEnd = OriginalStrTmpBegin;
   CHAR16 *ExpandedStrTmp = ExpandedStr;
@@ -130,7 +159,7 @@ static CHAR16 *TextListExpandStr(IN DATA_SET_CONTEXT *DataSetCtx, IN const CHAR1
       //OriginalStrTmpBegin points to beginning of $(key) identifier, OriginalStrTmpEnd points to the end
       //allocate enough memory to copy the string that sits between pointers
       //plus 1 char worth of mem for NULL term to make it a string
-      MacroKeyName = AllocateZeroPool(((UINTN)OriginalStrTmpEnd - (UINTN)OriginalStrTmpBegin) + sizeof(CHAR16));
+      MacroKeyName = ArenaAllocateZeroPool(((UINTN)OriginalStrTmpEnd - (UINTN)OriginalStrTmpBegin) + sizeof(CHAR16));
       if (NULL == MacroKeyName) {
         NVDIMM_CRIT("AllocateZeroPool returned NULL\n");
         goto Finish;
@@ -158,7 +187,7 @@ static CHAR16 *TextListExpandStr(IN DATA_SET_CONTEXT *DataSetCtx, IN const CHAR1
         CopyMem(ExpandedStrTmp, MacroKeyName, AppendSize);
         ExpandedStrTmp += StrLen(MacroKeyName);
       }
-      FREE_POOL_SAFE(MacroKeyName);
+      ARENA_FREE_POOL_SAFE(MacroKeyName);
       //Advance OriginalStrTmpEnd past the last part of the $(key) identifier
       if(*OriginalStrTmpEnd == L')') {
         ++OriginalStrTmpEnd;
@@ -180,7 +209,7 @@ static CHAR16 *TextListExpandStr(IN DATA_SET_CONTEXT *DataSetCtx, IN const CHAR1
     FreeSize -= AppendSize;
   }
  Finish:
-  FREE_POOL_SAFE(MacroKeyName);
+  ARENA_FREE_POOL_SAFE(MacroKeyName);
   return ExpandedStr;
 }
 
@@ -294,7 +323,7 @@ static VOID * TextListCb(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16 *CurPath, IN
         TextListPrintIdent(IdentCount);
         Print(FORMAT_STR_NL, Header);
         //free the expanded header
-        FreePool(Header);
+        ArenaFreePool(Header);
         ListHeaderPrinted = TRUE;
       }
     }
@@ -363,7 +392,7 @@ This is a helper to determine if a particular node is the "printer node".
 @retval BOOLEAN TRUE if CurPath points to the designated "printer node" else FALSE
 **/
 static BOOLEAN TextTableIsPrinterNode(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16 *CurPath, IN PRV_TABLE_INFO *PrvTableInfo) {
-  CHAR16 *TmpStr = CatSPrint(CurPath,L".");
+  CHAR16 *TmpStr = ArenaCatSPrint(CurPath,L".");
   BOOLEAN IsPrinter = FALSE;
 
   if (NULL == TmpStr) {
@@ -378,7 +407,7 @@ static BOOLEAN TextTableIsPrinterNode(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16
   IsPrinter = (0 == StrnCmp(TmpStr, PrvTableInfo->PrinterNode, StrLen(TmpStr)));
 
 Finish:
-  FREE_POOL_SAFE(TmpStr);
+  ARENA_FREE_POOL_SAFE(TmpStr);
   return IsPrinter;
 }
 
@@ -440,11 +469,11 @@ Callback routine for printing out text tables.
 static VOID * TextTableCb(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16 *CurPath, IN VOID *UserData, IN VOID *ParentUserData) {
   PRV_TABLE_INFO *PrvTableInfo = (PRV_TABLE_INFO *)UserData;
   PRINTER_TABLE_ATTRIB *Attribs;
-  CHAR16 *TempCurPath = CatSPrint(CurPath, L".");
+  CHAR16 *TempCurPath = ArenaCatSPrint(CurPath, L".");
   UINT32 ColumnIndex = 0;
   UINT32 CellValueIndex = 0;
   CHAR16 *KeyVal;
-  CHAR16 *CurRowText = CatSPrint(ParentUserData, L"");
+  CHAR16 *CurRowText = ArenaCatSPrint(ParentUserData, L"");
   CHAR16 *EndOfRowText;
   UINTN RowSizeInBytes;
   UINTN NumColumns = 0;
@@ -487,7 +516,7 @@ static VOID * TextTableCb(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16 *CurPath, I
         RowSizeInBytes = StrSize(CurRowText) + ((MaxCellChars + CELL_EXTRA_CHARS) * sizeof(CHAR16));
       }
 
-      if (NULL == (CurRowText = ReallocatePool(StrSize(CurRowText), RowSizeInBytes, CurRowText))) {
+      if (NULL == (CurRowText = ArenaReallocatePool(StrSize(CurRowText), RowSizeInBytes, CurRowText))) {
         goto Finish;
       }
       //Make EndOfRowText point to end of the already processed row
@@ -527,7 +556,7 @@ static VOID * TextTableCb(IN DATA_SET_CONTEXT *DataSetCtx, IN CHAR16 *CurPath, I
   }
 
 Finish:
-  FREE_POOL_SAFE(TempCurPath);
+  ARENA_FREE_POOL_SAFE(TempCurPath);
   //return a string that represents the current row.
   return CurRowText;
 }
@@ -548,7 +577,7 @@ static VOID * CalculateTextTableDimensionCb(IN DATA_SET_CONTEXT *DataSetCtx, IN
   PRV_TABLE_INFO *PrvTableInfo = (PRV_TABLE_INFO *)UserData;
   PRINTER_TABLE_ATTRIB *Attribs;
   PRINTER_TABLE_ATTRIB *ModifiedAttribs;
-  CHAR16 *TempCurPath = CatSPrint(CurPath, L".");
+  CHAR16 *TempCurPath = ArenaCatSPrint(CurPath, L".");
   UINT32 ColumnIndex = 0;
   UINTN NumColumns = 0;
   UINTN MaxCellChars = 0;
@@ -589,7 +618,7 @@ static VOID * CalculateTextTableDimensionCb(IN DATA_SET_CONTEXT *DataSetCtx, IN
   }
 
 Finish:
-  FREE_POOL_SAFE(TempCurPath);
+  ARENA_FREE_POOL_SAFE(TempCurPath);
   return NULL;
 }
 
@@ -628,35 +657,29 @@ static CHAR16 * TextTableGetPrinterNodePath(PRINTER_TABLE_ATTRIB * TableAttribs)
 }
 
 /*
-* Main entry point for displaying a hierarchical data set as a table
+* Print the header of a text table followed by the header/body separator
 */
-VOID PrintDataSetAsTextTable(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_ATTRIB * Attribs) {
+static BOOLEAN PrintTextTableHeader(PRINTER_TABLE_ATTRIB * Attribs) {
 
   UINT32 Index = 0;
   UINT32 Index2 = 0;
-  PRV_TABLE_INFO PrvTableInfo;
   CHAR16 *TableHeaderStart = NULL;
   CHAR16 *TableHeaderEnd = NULL;
   UINTN RowSizeInBytes = 0;
   UINTN RowSizeInChars = 0;
   UINTN NumColumns = NumTableColumns(Attribs);
 
-  if (NULL == Attribs) {
-    NVDIMM_CRIT("CMDs must specify a PRINTER_TABLE_ATTRIB when displaying text tables\n");
-    return;
-  }
-
-  TableHeaderStart = CatSPrint(NULL, L"");
+  TableHeaderStart = ArenaCatSPrint(NULL, L"");
   if (NULL == TableHeaderStart) {
-    return;
+    return FALSE;
   }
 
   //Loop generates a string that represents the table's header
   for (Index = 0; Index < NumColumns; ++Index) {
     //TableRowStart contains cells in a row already processed, now add more memory for the next cell in the row
     RowSizeInBytes = StrSize(TableHeaderStart) + ((Attribs->ColumnAttribs[Index].ColumnMaxStrLen + CELL_EXTRA_CHARS) * sizeof(CHAR16)); //+CELL_EXTRA_CHARS on ColumnWidth to accommodate whitespace and pipe
-    if (NULL == (TableHeaderStart = ReallocatePool(StrSize(TableHeaderStart), RowSizeInBytes, TableHeaderStart))) {
-      return;
+    if (NULL == (TableHeaderStart = ArenaReallocatePool(StrSize(TableHeaderStart), RowSizeInBytes, TableHeaderStart))) {
+      return FALSE;
     }
     //TableHeaderEnd points to end of the already processed row cells
     TableHeaderEnd = &TableHeaderStart[StrLen(TableHeaderStart)];
@@ -684,7 +707,7 @@ VOID PrintDataSetAsTextTable(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_ATTRIB
     ++RowSizeInChars;
   }
 
-  FreePool(TableHeaderStart);
+  ArenaFreePool(TableHeaderStart);
   Print(TEXT_NEW_LINE);
 
   //Print the header/body separator
@@ -692,13 +715,36 @@ VOID PrintDataSetAsTextTable(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_ATTRIB
     Print(TEXT_TABLE_HEADER_SEP);
   }
   Print(TEXT_NEW_LINE);
+  return TRUE;
+}
+
+/*
+* Print the rows of a text table, one per "printer node" in the data set
+*/
+static VOID PrintTextTableBody(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_ATTRIB * Attribs) {
+  PRV_TABLE_INFO PrvTableInfo;
 
   PrvTableInfo.AllTableAttribs = Attribs;
   PrvTableInfo.PrinterNode = TextTableGetPrinterNodePath(Attribs);
-  //Print the body of the table
   RecurseDataSet(DataSetCtx, TextTableCb, NULL, (VOID*)&PrvTableInfo, TRUE);
 }
 
+/*
+* Main entry point for displaying a hierarchical data set as a table
+*/
+VOID PrintDataSetAsTextTable(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_ATTRIB * Attribs) {
+
+  if (NULL == Attribs) {
+    NVDIMM_CRIT("CMDs must specify a PRINTER_TABLE_ATTRIB when displaying text tables\n");
+    return;
+  }
+
+  if (PrintTextTableHeader(Attribs)) {
+    //Print the body of the table
+    PrintTextTableBody(DataSetCtx, Attribs);
+  }
+}
+
 /*
 * Determine column widths of a text table
 */
@@ -732,6 +778,7 @@ VOID CalculateTextTableDimensions(DATA_SET_CONTEXT *DataSetCtx, PRINTER_TABLE_AT
 /*
 * Callback routine for printing out NVM XML.
 * -Start by printing indentation whitespace based on depth of node in tree.
+*  UserData optionally points to a UINT32 number of levels the tree is nested in.
 * -Print beginning tag: <DataSetName>
 * -ForEach KeyValue Pair:
 * -  Print indentation whitespace
@@ -746,6 +793,9 @@ static VOID * NvmlXmlCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *Use
   UINT32 Ident = 0;
 
   Ident = NvmXmlGetNvmXmlIdent(CurPath);
+  if (NULL != UserData) {
+    Ident += *(UINT32 *)UserData;
+  }
   for(Index = 0; Index < Ident; ++Index) {
     Print(NVM_XML_WHITESPACE_IDENT);
   }
@@ -757,12 +807,12 @@ static VOID * NvmlXmlCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *Use
       Print(NVM_XML_WHITESPACE_IDENT);
     }
 
-    Key = CatSPrint(NULL, KvInfo->Key);
+    Key = ArenaCatSPrint(NULL, KvInfo->Key);
     RemoveAllWhiteSpace(Key);
     TrimString(Val);
     Print(NVM_XML_KEY_VAL_TAG, Key, Val, Key);
 
-    FREE_POOL_SAFE(Key);
+    ARENA_FREE_POOL_SAFE(Key);
   }
   return NULL;
 }
@@ -777,6 +827,9 @@ static VOID * NvmlXmlChildrenDoneCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPat
   UINT32 Index = 0;
   UINT32 Ident = 0;
   Ident = NvmXmlGetNvmXmlIdent(CurPath);
+  if (NULL != UserData) {
+    Ident += *(UINT32 *)UserData;
+  }
   for (Index = 0; Index < Ident; ++Index) {
     Print(NVM_XML_WHITESPACE_IDENT);
   }
@@ -812,13 +865,13 @@ static VOID * EsxXmlCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *User
   while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
     GetKeyValueWideStr(DataSetCtx, KvInfo->Key, &Val, NULL);
 
-    Key = CatSPrint(NULL, KvInfo->Key);
+    Key = ArenaCatSPrint(NULL, KvInfo->Key);
     RemoveAllWhiteSpace(Key);
     TrimString(Val);
 
     Print(L"  <field name=\"" FORMAT_STR L"\"><string>" FORMAT_STR L"</string></field>\n", Key, Val);
 
-    FREE_POOL_SAFE(Key);
+    ARENA_FREE_POOL_SAFE(Key);
   }
   Print(L"</structure>\n");
   return NULL;
@@ -854,7 +907,7 @@ static VOID * EsxKeyValXmlCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID
   while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
     GetKeyValueWideStr(DataSetCtx, KvInfo->Key, &Val, NULL);
 
-    Key = CatSPrint(NULL, KvInfo->Key);
+    Key = ArenaCatSPrint(NULL, KvInfo->Key);
     RemoveAllWhiteSpace(Key);
     TrimString(Val);
 
@@ -862,7 +915,7 @@ static VOID * EsxKeyValXmlCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID
     Print(L"  <field name=\"Attribute Name\"><string>" FORMAT_STR L"</string></field><field name=\"Value\"><string>" FORMAT_STR L"</string></field>\n", Key, Val);
     Print(L"</structure>\n");
 
-    FREE_POOL_SAFE(Key);
+    ARENA_FREE_POOL_SAFE(Key);
   }
   return NULL;
 }
@@ -878,22 +931,581 @@ static VOID PrintEsxKeyValXml(DATA_SET_CONTEXT *DataSetCtx) {
   Print(ESX_XML_FILE_END);
 }
 
+/*
+* Callback routine for printing out one line per record.
+* -Print the data set name
+* -ForEach KeyValue Pair:
+* -   Print a tab followed by Key=Value
+* Whitespace is removed from keys so every field can be split on the first '='.
+*/
+static VOID * TextLineCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *UserData, VOID *ParentUserData) {
+  KEY_VAL_INFO *KvInfo = NULL;
+  CHAR16 *Val = NULL;
+  CHAR16 *Key = NULL;
+
+  if (0 == GetKeyCount(DataSetCtx)) {
+    return NULL;
+  }
+
+  Print(FORMAT_STR, GetDataSetName(DataSetCtx));
+  while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
+    GetKeyValueWideStr(DataSetCtx, KvInfo->Key, &Val, NULL);
+
+    Key = ArenaCatSPrint(NULL, KvInfo->Key);
+    RemoveAllWhiteSpace(Key);
+    //the value belongs to the data set, trim a copy
+    Val = ArenaCatSPrint(NULL, FORMAT_STR, (NULL != Val) ? Val : L"");
+    TrimString(Val);
+
+    Print(TEXT_LINE_FIELD_DELIM FORMAT_STR TEXT_LINE_KEY_VAL_DELIM FORMAT_STR, Key, Val);
+
+    ARENA_FREE_POOL_SAFE(Key);
+    ARENA_FREE_POOL_SAFE(Val);
+  }
+  Print(TEXT_NEW_LINE);
+  return NULL;
+}
+
+/*
+* Main entry point for displaying a hierarchical data set as one line per record.
+* The data set is squashed first so every record carries the keys of its parents.
+*/
+static VOID PrintTextLines(DATA_SET_CONTEXT *DataSetCtx) {
+  DATA_SET_CONTEXT *SquashedDataSet;
+  SquashedDataSet = SquashDataSet(DataSetCtx);
+
+  if (NULL == SquashedDataSet) {
+    return;
+  }
+
+  RecurseDataSet(SquashedDataSet, TextLineCb, NULL, NULL, TRUE);
+  //SquashDataSet will return original Data set if it has no children
+  if (SquashedDataSet != DataSetCtx) {
+    FreeDataSet(SquashedDataSet);
+  }
+}
+
+/*
+* Write out the buffered UTF-8 output.
+* The UEFI console only takes UCS-2, so there the output is widened back in chunks.
+*/
+static VOID Utf8Flush() {
+#ifdef OS_BUILD
+  if (0 != mUtf8Writer.Len) {
+    PrintUtf8(mUtf8Writer.Buf, mUtf8Writer.Len);
+  }
+#else
+  CHAR16 Chunk[EXPAND_STR_MAX];
+  UINTN ChunkLen = 0;
+  UINTN Index = 0;
+  UINT32 CodePoint = 0;
+  UINT8 Byte = 0;
+  UINT32 TrailBytes = 0;
+
+  while (Index < mUtf8Writer.Len) {
+    Byte = (UINT8)mUtf8Writer.Buf[Index++];
+    if (Byte < 0x80) {
+      CodePoint = Byte;
+      TrailBytes = 0;
+    }
+    else if (Byte >= 0xF0) {
+      CodePoint = Byte & 0x07;
+      TrailBytes = 3;
+    }
+    else if (Byte >= 0xE0) {
+      CodePoint = Byte & 0x0F;
+      TrailBytes = 2;
+    }
+    else {
+      CodePoint = Byte & 0x1F;
+      TrailBytes = 1;
+    }
+    for (; TrailBytes > 0 && Index < mUtf8Writer.Len; --TrailBytes) {
+      CodePoint = (CodePoint << 6) | (mUtf8Writer.Buf[Index++] & 0x3F);
+    }
+    Chunk[ChunkLen++] = (CodePoint > MAX_UINT16) ? UTF8_REPLACEMENT_CHAR : (CHAR16)CodePoint;
+    if (EXPAND_STR_MAX - 1 == ChunkLen || Index == mUtf8Writer.Len) {
+      Chunk[ChunkLen] = CHAR_NULL_TERM;
+      Print(FORMAT_STR, Chunk);
+      ChunkLen = 0;
+    }
+  }
+#endif
+  mUtf8Writer.Len = 0;
+}
+
+/*
+* Append a single byte to the UTF-8 output
+*/
+static VOID Utf8PutChar(CHAR8 Char) {
+  if (UTF8_WRITER_BUFFER_SIZE == mUtf8Writer.Len) {
+    Utf8Flush();
+  }
+  mUtf8Writer.Buf[mUtf8Writer.Len++] = Char;
+}
+
+/*
+* Append an ASCII string to the UTF-8 output
+*/
+static VOID Utf8PutAscii(CONST CHAR8 *Str) {
+  while (*Str) {
+    Utf8PutChar(*Str++);
+  }
+}
+
+/*
+* Append a unicode code point to the UTF-8 output
+*/
+static VOID Utf8PutCodePoint(UINT32 CodePoint) {
+  if (CodePoint < 0x80) {
+    Utf8PutChar((CHAR8)CodePoint);
+  }
+  else if (CodePoint < 0x800) {
+    Utf8PutChar((CHAR8)(0xC0 | (CodePoint >> 6)));
+    Utf8PutChar((CHAR8)(0x80 | (CodePoint & 0x3F)));
+  }
+  else if (CodePoint < 0x10000) {
+    Utf8PutChar((CHAR8)(0xE0 | (CodePoint >> 12)));
+    Utf8PutChar((CHAR8)(0x80 | ((CodePoint >> 6) & 0x3F)));
+    Utf8PutChar((CHAR8)(0x80 | (CodePoint & 0x3F)));
+  }
+  else if (CodePoint <= 0x10FFFF) {
+    Utf8PutChar((CHAR8)(0xF0 | (CodePoint >> 18)));
+    Utf8PutChar((CHAR8)(0x80 | ((CodePoint >> 12) & 0x3F)));
+    Utf8PutChar((CHAR8)(0x80 | ((CodePoint >> 6) & 0x3F)));
+    Utf8PutChar((CHAR8)(0x80 | (CodePoint & 0x3F)));
+  }
+  else {
+    Utf8PutCodePoint(UTF8_REPLACEMENT_CHAR);
+  }
+}
+
+/*
+* Append a string to the UTF-8 output, escaped for a quoted JSON or CSV field.
+* Surrounding whitespace is trimmed as it is in the other formats and keys drop
+* all of their whitespace, without copying the string.
+*/
+static VOID Utf8PutWideStr(CONST CHAR16 *Str, UTF8_ESCAPE Escape, BOOLEAN IsKey) {
+  CONST CHAR8 HexDigits[] = "0123456789abcdef";
+  CONST CHAR16 *End = NULL;
+  UINT32 CodePoint = 0;
+
+  while (IS_WHITE_UNICODE(*Str)) {
+    Str++;
+  }
+  End = Str + StrLen(Str);
+  while (End > Str && IS_WHITE_UNICODE(End[-1])) {
+    End--;
+  }
+
+  for (; Str < End; ++Str) {
+    CodePoint = (UINT32)*Str;
+    if (IsKey && IS_WHITE_UNICODE(CodePoint)) {
+      continue;
+    }
+    //combine UTF-16 surrogate pairs, lone surrogates can't be encoded
+    if (IS_IN_RANGE(CodePoint, 0xD800, 0xDBFF) && Str + 1 < End && IS_IN_RANGE((UINT32)Str[1], 0xDC00, 0xDFFF)) {
+      CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + ((UINT32)Str[1] - 0xDC00);
+      Str++;
+    }
+    else if (IS_IN_RANGE(CodePoint, 0xD800, 0xDFFF)) {
+      CodePoint = UTF8_REPLACEMENT_CHAR;
+    }
+
+    if (UTF8_ESCAPE_CSV == Escape) {
+      if ('"' == CodePoint) {
+        Utf8PutChar('"');
+      }
+    }
+    else if ('"' == CodePoint || '\\' == CodePoint) {
+      Utf8PutChar('\\');
+    }
+    else if (CodePoint < 0x20) {
+      Utf8PutChar('\\');
+      if ('\n' == CodePoint) {
+        Utf8PutChar('n');
+      }
+      else if ('\r' == CodePoint) {
+        Utf8PutChar('r');
+      }
+      else if ('\t' == CodePoint) {
+        Utf8PutChar('t');
+      }
+      else {
+        Utf8PutAscii("u00");
+        Utf8PutChar(HexDigits[CodePoint >> 4]);
+        Utf8PutChar(HexDigits[CodePoint & 0xF]);
+      }
+      continue;
+    }
+    Utf8PutCodePoint(CodePoint);
+  }
+}
+
+/*
+* Append an unsigned number to the UTF-8 output.
+* HexDigits of 0 writes it in decimal, otherwise as zero padded hex with a 0x prefix.
+*/
+static VOID Utf8PutUint64(UINT64 Val, UINT32 HexDigits) {
+  CONST CHAR8 Digits[] = "0123456789abcdef";
+  CHAR8 Reversed[sizeof("18446744073709551615")];
+  UINT32 Count = 0;
+
+  if (0 != HexDigits) {
+    Utf8PutAscii("0x");
+    for (Count = 0; Count < HexDigits; ++Count) {
+      Reversed[Count] = Digits[Val & 0xF];
+      Val >>= 4;
+    }
+  }
+  else {
+    do {
+      Reversed[Count++] = Digits[Val % 10];
+      Val /= 10;
+    } while (0 != Val);
+  }
+  while (Count > 0) {
+    Utf8PutChar(Reversed[--Count]);
+  }
+}
+
+/*
+* Append a signed decimal number to the UTF-8 output
+*/
+static VOID Utf8PutInt64(INT64 Val) {
+  if (Val < 0) {
+    Utf8PutChar('-');
+    Utf8PutUint64(0 - (UINT64)Val, 0);
+  }
+  else {
+    Utf8PutUint64((UINT64)Val, 0);
+  }
+}
+
+/*
+* Append the value of a key to the UTF-8 output without rendering it to a string first.
+* Decimal numbers and booleans are written as JSON literals.  Hex values keep the
+* padding used by the text formats and are quoted like strings in JSON.
+*/
+static VOID Utf8PutValue(DATA_SET_CONTEXT *DataSetCtx, KEY_VAL_INFO *KvInfo, UTF8_ESCAPE Escape) {
+  VOID *Val = NULL;
+  TO_STRING_BASE Base = DECIMAL;
+  INT64 SignedVal = 0;
+  UINT64 UnsignedVal = 0;
+  UINT32 ValSize = 0;
+  BOOLEAN Signed = FALSE;
+
+  if (EFI_ERROR(GetKeyValueRaw(DataSetCtx, KvInfo->Key, &Val, &Base))) {
+    if (UTF8_ESCAPE_JSON == Escape) {
+      Utf8PutAscii("null");
+    }
+    return;
+  }
+
+  switch (KvInfo->Type) {
+  case KEY_W_STR:
+    Utf8PutChar('"');
+    Utf8PutWideStr((CHAR16 *)Val, Escape, FALSE);
+    Utf8PutChar('"');
+    return;
+  case KEY_BOOL:
+    Utf8PutAscii(*(BOOLEAN *)Val ? "true" : "false");
+    return;
+  case KEY_UINT64:
+    UnsignedVal = *(UINT64 *)Val;
+    ValSize = sizeof(UINT64);
+    break;
+  case KEY_INT64:
+    SignedVal = *(INT64 *)Val;
+    ValSize = sizeof(INT64);
+    Signed = TRUE;
+    break;
+  case KEY_UINT32:
+    UnsignedVal = *(UINT32 *)Val;
+    ValSize = sizeof(UINT32);
+    break;
+  case KEY_INT32:
+    SignedVal = *(INT32 *)Val;
+    ValSize = sizeof(INT32);
+    Signed = TRUE;
+    break;
+  case KEY_UINT16:
+    UnsignedVal = *(UINT16 *)Val;
+    ValSize = sizeof(UINT16);
+    break;
+  case KEY_INT16:
+    SignedVal = *(INT16 *)Val;
+    ValSize = sizeof(INT16);
+    Signed = TRUE;
+    break;
+  case KEY_UINT8:
+    UnsignedVal = *(UINT8 *)Val;
+    ValSize = sizeof(UINT8);
+    break;
+  case KEY_INT8:
+    SignedVal = *(INT8 *)Val;
+    ValSize = sizeof(INT8);
+    Signed = TRUE;
+    break;
+  default:
+    return;
+  }
+
+  if (HEX == Base) {
+    //negative values are shown as the two's complement of their own width
+    if (Signed) {
+      UnsignedVal = (UINT64)SignedVal;
+      if (ValSize < sizeof(UINT64)) {
+        UnsignedVal &= (1ULL << (ValSize * 8)) - 1;
+      }
+    }
+    if (UTF8_ESCAPE_JSON == Escape) {
+      Utf8PutChar('"');
+    }
+    Utf8PutUint64(UnsignedVal, ValSize * 2);
+    if (UTF8_ESCAPE_JSON == Escape) {
+      Utf8PutChar('"');
+    }
+  }
+  else if (Signed) {
+    Utf8PutInt64(SignedVal);
+  }
+  else {
+    Utf8PutUint64(UnsignedVal, 0);
+  }
+}
+
+/*
+* Start a new JSON document or CSV output
+*/
+static VOID Utf8WriterReset() {
+  mUtf8Writer.MemberCnt = 0;
+  mUtf8Writer.RecordCnt = 0;
+  mUtf8Writer.MsgCnt = 0;
+}
+
+/*
+* Start a JSON member holding the records of a data set: "DataSetName":[
+*/
+static VOID JsonBeginDataSet(DATA_SET_CONTEXT *DataSetCtx) {
+  if (0 != mUtf8Writer.MemberCnt) {
+    Utf8PutAscii(",\n");
+  }
+  Utf8PutChar('"');
+  Utf8PutWideStr(GetDataSetName(DataSetCtx), UTF8_ESCAPE_JSON, TRUE);
+  Utf8PutAscii("\":[\n");
+  mUtf8Writer.MemberCnt++;
+  mUtf8Writer.RecordCnt = 0;
+}
+
+/*
+* Close the JSON member started by JsonBeginDataSet
+*/
+static VOID JsonEndDataSet() {
+  Utf8PutChar(']');
+}
+
+/*
+* Callback routine for printing out JSON.
+* -Print each record as an object on its own line: {"Key":Value,...}
+* The comma separating records starts the next line, so every line written is
+* complete when streamed records are flushed.
+* Records are the leaves of a squashed data set, so they carry the keys of their parents.
+*/
+static VOID * JsonRecordCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *UserData, VOID *ParentUserData) {
+  KEY_VAL_INFO *KvInfo = NULL;
+  BOOLEAN FirstKey = TRUE;
+
+  if (0 == GetKeyCount(DataSetCtx)) {
+    return NULL;
+  }
+
+  if (0 != mUtf8Writer.RecordCnt) {
+    Utf8PutChar(',');
+  }
+  Utf8PutChar('{');
+  while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
+    if (!FirstKey) {
+      Utf8PutChar(',');
+    }
+    FirstKey = FALSE;
+    Utf8PutChar('"');
+    Utf8PutWideStr(KvInfo->Key, UTF8_ESCAPE_JSON, TRUE);
+    Utf8PutAscii("\":");
+    Utf8PutValue(DataSetCtx, KvInfo, UTF8_ESCAPE_JSON);
+  }
+  Utf8PutAscii("}\n");
+  mUtf8Writer.RecordCnt++;
+  return NULL;
+}
+
+/*
+* Start the JSON member holding the command's messages.
+* Failures are reported as "Error":{"Type":N,"Message":"..."}, anything else as "Result":"..."
+*/
+static VOID JsonBeginMessages(EFI_STATUS CmdExitCode) {
+  if (0 != mUtf8Writer.MemberCnt) {
+    Utf8PutAscii(",\n");
+  }
+  if (EFI_ERROR(CmdExitCode)) {
+#ifdef OS_BUILD
+    CmdExitCode = UefiToOsReturnCode(CmdExitCode);
+#endif
+    Utf8PutAscii("\"Error\":{\"Type\":");
+    Utf8PutInt64((INT32)CmdExitCode);
+    Utf8PutAscii(",\"Message\":\"");
+  }
+  else {
+    Utf8PutAscii("\"Result\":\"");
+  }
+  mUtf8Writer.MemberCnt++;
+  mUtf8Writer.MsgCnt = 0;
+}
+
+/*
+* Append a message to the JSON member started by JsonBeginMessages, one line per message
+*/
+static VOID JsonPutMessage(CHAR16 *Msg) {
+  if (NULL == Msg) {
+    return;
+  }
+  if (0 != mUtf8Writer.MsgCnt) {
+    Utf8PutAscii("\\n");
+  }
+  Utf8PutWideStr(Msg, UTF8_ESCAPE_JSON, FALSE);
+  mUtf8Writer.MsgCnt++;
+}
+
+/*
+* Close the JSON member started by JsonBeginMessages
+*/
+static VOID JsonEndMessages(EFI_STATUS CmdExitCode) {
+  Utf8PutAscii(EFI_ERROR(CmdExitCode) ? "\"}" : "\"");
+}
+
+/*
+* Main entry point for displaying a hierarchical data set as JSON.
+*/
+static VOID PrintAsJson(DATA_SET_CONTEXT *DataSetCtx) {
+  DATA_SET_CONTEXT *SquashedDataSet;
+  SquashedDataSet = SquashDataSet(DataSetCtx);
+
+  if (NULL == SquashedDataSet) {
+    return;
+  }
+
+  JsonBeginDataSet(DataSetCtx);
+  RecurseDataSet(SquashedDataSet, JsonRecordCb, NULL, NULL, TRUE);
+  JsonEndDataSet();
+  //SquashDataSet will return original Data set if it has no children
+  if (SquashedDataSet != DataSetCtx) {
+    FreeDataSet(SquashedDataSet);
+  }
+}
+
+/*
+* Callback routine for printing out CSV.
+* -Print a header line of key names when they differ from the last header printed
+* -Print the values of the record as a line of comma separated fields
+* Strings are always quoted, so a field is split on commas outside of quotes only.
+*/
+static VOID * CsvRecordCb(DATA_SET_CONTEXT *DataSetCtx, CHAR16 *CurPath, VOID *UserData, VOID *ParentUserData) {
+  KEY_VAL_INFO *KvInfo = NULL;
+  CHAR16 *Key = NULL;
+  UINT32 HeaderHash = FNV_OFFSET_BASIS_32;
+  BOOLEAN FirstKey = TRUE;
+
+  if (0 == GetKeyCount(DataSetCtx)) {
+    return NULL;
+  }
+
+  while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
+    for (Key = KvInfo->Key; CHAR_NULL_TERM != *Key; ++Key) {
+      HeaderHash = (HeaderHash ^ (UINT32)*Key) * FNV_PRIME_32;
+    }
+    HeaderHash = (HeaderHash ^ (UINT32)',') * FNV_PRIME_32;
+  }
+
+  if (0 == mUtf8Writer.RecordCnt || HeaderHash != mUtf8Writer.CsvHeaderHash) {
+    //a blank line separates records with a different set of keys
+    if (0 != mUtf8Writer.RecordCnt) {
+      Utf8PutChar('\n');
+    }
+    while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
+      if (!FirstKey) {
+        Utf8PutChar(',');
+      }
+      FirstKey = FALSE;
+      Utf8PutChar('"');
+      Utf8PutWideStr(KvInfo->Key, UTF8_ESCAPE_CSV, TRUE);
+      Utf8PutChar('"');
+    }
+    Utf8PutChar('\n');
+    mUtf8Writer.CsvHeaderHash = HeaderHash;
+  }
+
+  FirstKey = TRUE;
+  while (NULL != (KvInfo = GetNextKey(DataSetCtx, KvInfo))) {
+    if (!FirstKey) {
+      Utf8PutChar(',');
+    }
+    FirstKey = FALSE;
+    Utf8PutValue(DataSetCtx, KvInfo, UTF8_ESCAPE_CSV);
+  }
+  Utf8PutChar('\n');
+  mUtf8Writer.RecordCnt++;
+  return NULL;
+}
+
+/*
+* Start the CSV records of a data set, separated from the previous data set by a blank line
+*/
+static VOID CsvBeginDataSet() {
+  if (0 != mUtf8Writer.MemberCnt) {
+    Utf8PutChar('\n');
+  }
+  mUtf8Writer.MemberCnt++;
+  mUtf8Writer.RecordCnt = 0;
+}
+
+/*
+* Main entry point for displaying a hierarchical data set as CSV.
+*/
+static VOID PrintAsCsv(DATA_SET_CONTEXT *DataSetCtx) {
+  DATA_SET_CONTEXT *SquashedDataSet;
+  SquashedDataSet = SquashDataSet(DataSetCtx);
+
+  if (NULL == SquashedDataSet) {
+    return;
+  }
+
+  CsvBeginDataSet();
+  RecurseDataSet(SquashedDataSet, CsvRecordCb, NULL, NULL, TRUE);
+  //SquashDataSet will return original Data set if it has no children
+  if (SquashedDataSet != DataSetCtx) {
+    FreeDataSet(SquashedDataSet);
+  }
+}
+
 /*
 * Main entry point for displaying a hierarchical data set as text.
-* Function determines if format is a list or table.
+* Function determines if format is a line, list or table.
 */
 static VOID PrintAsText(DATA_SET_CONTEXT *DataSetCtx, PRINT_CONTEXT *PrintCtx) {
   PRINTER_DATA_SET_ATTRIBS *Attribs = (PRINTER_DATA_SET_ATTRIBS *)GetDataSetUserData(DataSetCtx);
   PRINTER_LIST_ATTRIB *ListAttribs = NULL;
   PRINTER_TABLE_ATTRIB *TableAttribs = NULL;
-  PRINTER_TABLE_ATTRIB *ModifiedTableAttribs = (PRINTER_TABLE_ATTRIB *)AllocateZeroPool(sizeof(PRINTER_TABLE_ATTRIB));
+  PRINTER_TABLE_ATTRIB *ModifiedTableAttribs = (PRINTER_TABLE_ATTRIB *)ArenaAllocateZeroPool(sizeof(PRINTER_TABLE_ATTRIB));
 
   if (NULL == ModifiedTableAttribs) {
     NVDIMM_CRIT("AllocateZeroPool returned NULL\n");
     return;
   }
 
-  if (PrintCtx->FormatTypeFlags.Flags.List) {
+  if (PrintCtx->FormatTypeFlags.Flags.Line) {
+    PrintTextLines(DataSetCtx);
+  }
+  else if (PrintCtx->FormatTypeFlags.Flags.List) {
     if (Attribs) {
       ListAttribs = Attribs->pListAttribs;
     }
@@ -915,7 +1527,7 @@ static VOID PrintAsText(DATA_SET_CONTEXT *DataSetCtx, PRINT_CONTEXT *PrintCtx) {
     PrintDataSetAsTextTable(DataSetCtx, ModifiedTableAttribs);
   }
 Finish:
-  FREE_POOL_SAFE(ModifiedTableAttribs);
+  ARENA_FREE_POOL_SAFE(ModifiedTableAttribs);
 }
 
 /*
@@ -942,6 +1554,80 @@ static VOID PrintAsXml(DATA_SET_CONTEXT *DataSetCtx, PRINT_CONTEXT *PrintCtx) {
   }
 }
 
+/*
+* Print what precedes the first record of a streamed data set.
+* Rows are not known up front, so tables keep the column widths from their attributes.
+*/
+static VOID PrintStreamHeader(DATA_SET_CONTEXT *DataSetCtx, PRINT_CONTEXT *PrintCtx) {
+  PRINTER_DATA_SET_ATTRIBS *Attribs = (PRINTER_DATA_SET_ATTRIBS *)GetDataSetUserData(DataSetCtx);
+
+  if (XML == PrintCtx->FormatType) {
+    Print(XML_FILE_BEGIN);
+    Print(NVM_XML_WHITESPACE_IDENT);
+    Print(NVM_XML_DATA_SET_TAG_START, GetDataSetName(DataSetCtx));
+  }
+  else if (JSON == PrintCtx->FormatType) {
+    Utf8WriterReset();
+    Utf8PutChar('{');
+    JsonBeginDataSet(DataSetCtx);
+  }
+  else if (CSV == PrintCtx->FormatType) {
+    Utf8WriterReset();
+    CsvBeginDataSet();
+  }
+  else if (!PrintCtx->FormatTypeFlags.Flags.Line && !PrintCtx->FormatTypeFlags.Flags.List &&
+    PrintCtx->FormatTypeFlags.Flags.Table) {
+    if (NULL == Attribs || NULL == Attribs->pTableAttribs) {
+      NVDIMM_CRIT("CMDs must specify a PRINTER_TABLE_ATTRIB when displaying text tables\n");
+      return;
+    }
+    PrintTextTableHeader(Attribs->pTableAttribs);
+  }
+}
+
+/*
+* Print the records of a streamed data set that have not been printed yet.
+* Records already printed have been evicted and are skipped as they are no longer dirty.
+*/
+static VOID PrintStreamRecords(DATA_SET_CONTEXT *DataSetCtx, PRINT_CONTEXT *PrintCtx) {
+  PRINTER_DATA_SET_ATTRIBS *Attribs = (PRINTER_DATA_SET_ATTRIBS *)GetDataSetUserData(DataSetCtx);
+  DATA_SET_CONTEXT *SquashedDataSet = NULL;
+  DATA_SET_CONTEXT *ChildDataSet = NULL;
+  UINT32 RootIdent = 1;
+
+  if (XML == PrintCtx->FormatType) {
+    SquashedDataSet = SquashDataSet(DataSetCtx);
+    //SquashDataSet will return original Data set if it has no records
+    if (NULL == SquashedDataSet || SquashedDataSet == DataSetCtx) {
+      return;
+    }
+    //records are nested in the root tag printed by PrintStreamHeader
+    while (NULL != (ChildDataSet = GetNextChildDataSet(SquashedDataSet, ChildDataSet))) {
+      RecurseDataSet(ChildDataSet, NvmlXmlCb, NvmlXmlChildrenDoneCb, (VOID*)&RootIdent, TRUE);
+    }
+    FreeDataSet(SquashedDataSet);
+  }
+  else if (JSON == PrintCtx->FormatType || CSV == PrintCtx->FormatType) {
+    SquashedDataSet = SquashDataSet(DataSetCtx);
+    if (NULL == SquashedDataSet || SquashedDataSet == DataSetCtx) {
+      return;
+    }
+    RecurseDataSet(SquashedDataSet, (JSON == PrintCtx->FormatType) ? JsonRecordCb : CsvRecordCb, NULL, NULL, TRUE);
+    FreeDataSet(SquashedDataSet);
+    //hand the records of this flush to the reader right away
+    Utf8Flush();
+  }
+  else if (!PrintCtx->FormatTypeFlags.Flags.Line && !PrintCtx->FormatTypeFlags.Flags.List &&
+    PrintCtx->FormatTypeFlags.Flags.Table) {
+    if (NULL != Attribs && NULL != Attribs->pTableAttribs) {
+      PrintTextTableBody(DataSetCtx, Attribs->pTableAttribs);
+    }
+  }
+  else {
+    PrintAsText(DataSetCtx, PrintCtx);
+  }
+}
+
 /*
 * Print to stdout with each line starting with ERROR
 */
@@ -956,7 +1642,7 @@ static VOID PrintTextAsEsxError(CHAR16 *Msg) {
   }
 
   while (NULL != (SearchResult = StrStr(BeginStr, FORMAT_NL))) {
-    tmpStr = (CHAR16 *)AllocateZeroPool((1 + SearchResult - BeginStr) * sizeof(Msg[0]));
+    tmpStr = (CHAR16 *)ArenaAllocateZeroPool((1 + SearchResult - BeginStr) * sizeof(Msg[0]));
     if (NULL != tmpStr) {
       // replace StrnCpy since it is not available in all environments
       for (Index = 0; Index < (SearchResult - BeginStr); ++Index) {
@@ -964,7 +1650,7 @@ static VOID PrintTextAsEsxError(CHAR16 *Msg) {
       }
       Print(ESX_ERROR_LINE_HEADER);
       Print(FORMAT_STR FORMAT_NL, tmpStr);
-      FREE_POOL_SAFE(tmpStr);
+      ARENA_FREE_POOL_SAFE(tmpStr);
       BeginStr = SearchResult + 1;
     }
     else {
@@ -1079,7 +1765,7 @@ EFI_STATUS PrinterCreateCtx(
     return EFI_INVALID_PARAMETER;
   }
 
-  if (NULL == (*ppPrintCtx = (PRINT_CONTEXT*)AllocateZeroPool(sizeof(PRINT_CONTEXT)))) {
+  if (NULL == (*ppPrintCtx = (PRINT_CONTEXT*)ArenaAllocateZeroPool(sizeof(PRINT_CONTEXT)))) {
     ReturnCode = EFI_OUT_OF_RESOURCES;
     goto Finish;
   }
@@ -1092,6 +1778,25 @@ Finish:
   return ReturnCode;
 }
 
+/*
+* Helper to free the cached paths in the "lookup list", the data sets are kept
+*/
+static VOID CleanDataSetLookupCache(
+  IN    PRINT_CONTEXT *pPrintCtx
+)
+{
+  LIST_ENTRY *Entry;
+  LIST_ENTRY *NextEntry;
+  DATA_SET_LOOKUP_ITEM *DataSetLookupItem = NULL;
+
+  BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->DataSetLookup) {
+    DataSetLookupItem = BASE_CR(Entry, DATA_SET_LOOKUP_ITEM, Link);
+    RemoveEntryList(&DataSetLookupItem->Link);
+    ARENA_FREE_POOL_SAFE(DataSetLookupItem->DsPath);
+    ARENA_FREE_POOL_SAFE(DataSetLookupItem);
+  }
+}
+
 /*
 * Helper to free all items in the "lookup list"
 */
@@ -1107,19 +1812,14 @@ static VOID CleanDataSetLookupItems(
     return;
   }
 
-  BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->DataSetLookup) {
-    DataSetLookupItem = BASE_CR(Entry, DATA_SET_LOOKUP_ITEM, Link);
-    RemoveEntryList(&DataSetLookupItem->Link);
-    FREE_POOL_SAFE(DataSetLookupItem->DsPath);
-    FREE_POOL_SAFE(DataSetLookupItem);
-  }
+  CleanDataSetLookupCache(pPrintCtx);
 
   BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->DataSetRootLookup) {
     DataSetLookupItem = BASE_CR(Entry, DATA_SET_LOOKUP_ITEM, Link);
     RemoveEntryList(&DataSetLookupItem->Link);
     FREE_DATASET_RECURSIVE_SAFE(DataSetLookupItem->pDataSet); //recursive free, no need to free children data sets.
-    FREE_POOL_SAFE(DataSetLookupItem->DsPath);
-    FREE_POOL_SAFE(DataSetLookupItem);
+    ARENA_FREE_POOL_SAFE(DataSetLookupItem->DsPath);
+    ARENA_FREE_POOL_SAFE(DataSetLookupItem);
   }
 }
 
@@ -1144,21 +1844,25 @@ EFI_STATUS PrinterDestroyCtx(
     RemoveEntryList(&BufferedObject->Link);
     if (BUFF_STR_TYPE == BufferedObject->Type) {
       BUFFERED_STR *pTempBs = (BUFFERED_STR *)BufferedObject->Obj;
-      FREE_POOL_SAFE(pTempBs->pStr);
+      ARENA_FREE_POOL_SAFE(pTempBs->pStr);
     }
    else if (BUFF_COMMAND_STATUS_TYPE == BufferedObject->Type) {
       BUFFERED_COMMAND_STATUS *pTempCs = (BUFFERED_COMMAND_STATUS *)BufferedObject->Obj;
       FreeCommandStatus(&pTempCs->pCommandStatus);
-      FREE_POOL_SAFE(pTempCs->pStatusMessage);
-      FREE_POOL_SAFE(pTempCs->pStatusPreposition);
+      ARENA_FREE_POOL_SAFE(pTempCs->pStatusMessage);
+      ARENA_FREE_POOL_SAFE(pTempCs->pStatusPreposition);
     }
-    FREE_POOL_SAFE(BufferedObject->Obj);
-    FREE_POOL_SAFE(BufferedObject);
+    ARENA_FREE_POOL_SAFE(BufferedObject->Obj);
+    ARENA_FREE_POOL_SAFE(BufferedObject);
   }
 
   CleanDataSetLookupItems(pPrintCtx);
+  //a stream that was never processed still holds the arena suspended
+  if (pPrintCtx->StreamStarted) {
+    ArenaResume();
+  }
 
-  FREE_POOL_SAFE(pPrintCtx);
+  ARENA_FREE_POOL_SAFE(pPrintCtx);
   return ReturnCode;
 }
 
@@ -1170,11 +1874,11 @@ static EFI_STATUS CreateBufferedStrObj(BUFFERED_PRINTER_OBJECT **ppBufferedObj,
   if (NULL == ppBufferedObj) {
     return EFI_INVALID_PARAMETER;
   }
-  pTempBuffStr = (BUFFERED_STR*)AllocateZeroPool(sizeof(BUFFERED_STR));
-  *ppBufferedObj = (BUFFERED_PRINTER_OBJECT*)AllocateZeroPool(sizeof(BUFFERED_PRINTER_OBJECT));
+  pTempBuffStr = (BUFFERED_STR*)ArenaAllocateZeroPool(sizeof(BUFFERED_STR));
+  *ppBufferedObj = (BUFFERED_PRINTER_OBJECT*)ArenaAllocateZeroPool(sizeof(BUFFERED_PRINTER_OBJECT));
   if (*ppBufferedObj == NULL || pTempBuffStr == NULL) {
-    FREE_POOL_SAFE(*ppBufferedObj);
-    FREE_POOL_SAFE(pTempBuffStr);
+    ARENA_FREE_POOL_SAFE(*ppBufferedObj);
+    ARENA_FREE_POOL_SAFE(pTempBuffStr);
     return EFI_OUT_OF_RESOURCES;
   }
   (*ppBufferedObj)->Type = BUFF_STR_TYPE;
@@ -1193,11 +1897,11 @@ static EFI_STATUS CreateBufferedDataSetObj(BUFFERED_PRINTER_OBJECT **ppBufferedO
   if (NULL == ppBufferedObj) {
     return EFI_INVALID_PARAMETER;
   }
-  pTempBuffStr = (BUFFERED_DATA_SET*)AllocateZeroPool(sizeof(BUFFERED_DATA_SET));
-  *ppBufferedObj = (BUFFERED_PRINTER_OBJECT*)AllocateZeroPool(sizeof(BUFFERED_PRINTER_OBJECT));
+  pTempBuffStr = (BUFFERED_DATA_SET*)ArenaAllocateZeroPool(sizeof(BUFFERED_DATA_SET));
+  *ppBufferedObj = (BUFFERED_PRINTER_OBJECT*)ArenaAllocateZeroPool(sizeof(BUFFERED_PRINTER_OBJECT));
   if (*ppBufferedObj == NULL || pTempBuffStr == NULL) {
-    FREE_POOL_SAFE(*ppBufferedObj);
-    FREE_POOL_SAFE(pTempBuffStr);
+    ARENA_FREE_POOL_SAFE(*ppBufferedObj);
+    ARENA_FREE_POOL_SAFE(pTempBuffStr);
     return EFI_OUT_OF_RESOURCES;
   }
   (*ppBufferedObj)->Type = BUFF_DATA_SET_TYPE;
@@ -1214,12 +1918,12 @@ static EFI_STATUS CreateDataSetLookupItem(DATA_SET_LOOKUP_ITEM **ppDataSetLookup
   if (NULL == ppDataSetLookupItem) {
     return EFI_INVALID_PARAMETER;
   }
-  *ppDataSetLookupItem = (DATA_SET_LOOKUP_ITEM*)AllocateZeroPool(sizeof(DATA_SET_LOOKUP_ITEM));
+  *ppDataSetLookupItem = (DATA_SET_LOOKUP_ITEM*)ArenaAllocateZeroPool(sizeof(DATA_SET_LOOKUP_ITEM));
   if (*ppDataSetLookupItem == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
   (*ppDataSetLookupItem)->pDataSet = pDataSetCtx;
-  (*ppDataSetLookupItem)->DsPath = CatSPrint(NULL, FORMAT_STR, pPath);
+  (*ppDataSetLookupItem)->DsPath = ArenaCatSPrint(NULL, FORMAT_STR, pPath);
   return EFI_SUCCESS;
 }
 
@@ -1243,13 +1947,13 @@ EFI_STATUS EFIAPI PrinterSetMsg(
   }
 
   VA_START(Marker, pMsg);
-  FullMsg = CatVSPrint(NULL, pMsg, Marker);
+  FullMsg = ArenaCatVSPrint(NULL, pMsg, Marker);
   VA_END(Marker);
 
   //here for backwards compatibility
-  if (NULL == pPrintCtx || (!pPrintCtx->FormatTypeFlags.Flags.Buffered && XML != pPrintCtx->FormatType)) {
+  if (NULL == pPrintCtx || (!pPrintCtx->FormatTypeFlags.Flags.Buffered && TEXT == pPrintCtx->FormatType)) {
     PrintTextWithNewLine(FullMsg);
-    FREE_POOL_SAFE(FullMsg);
+    ARENA_FREE_POOL_SAFE(FullMsg);
     return EFI_SUCCESS;
   }
 
@@ -1265,8 +1969,8 @@ EFI_STATUS EFIAPI PrinterSetMsg(
     pPrintCtx->BufferedMsgCnt++;
   }
   else {
-    //here to handle the case where printer is unbuffered and XML == pPrintCtx->FormatType
-    FREE_POOL_SAFE(FullMsg);
+    //here to handle the case where printer is unbuffered and the format is XML, JSON or CSV
+    ARENA_FREE_POOL_SAFE(FullMsg);
   }
   ReturnCode = EFI_SUCCESS;
 Finish:
@@ -1339,7 +2043,7 @@ EFI_STATUS PrinterSetCommandStatus(
   }
   ReturnCode = EFI_SUCCESS;
 Finish:
-  FREE_POOL_SAFE(FullMsg);
+  ARENA_FREE_POOL_SAFE(FullMsg);
   return ReturnCode;
 }
 
@@ -1360,9 +2064,191 @@ static PRINT_MODE PrintMode(
   else if (XML == pPrintCtx->FormatType) {
     return PRINT_BASIC_XML;
   }
+  else if (JSON == pPrintCtx->FormatType) {
+    return PRINT_JSON;
+  }
+  else if (CSV == pPrintCtx->FormatType) {
+    return PRINT_CSV;
+  }
   else return PRINT_TEXT;
 }
 
+/*
+* Transform a single object from the "set buffer", print it to stdout and free it
+*/
+static VOID ProcessBufferedObject(
+  IN     PRINT_CONTEXT *pPrintCtx,
+  IN     BUFFERED_PRINTER_OBJECT *BufferedObject,
+  IN     PRINT_MODE PrinterMode
+)
+{
+  CHAR16 *FullMsg = NULL;
+
+  RemoveEntryList(&BufferedObject->Link);
+  if (BUFF_STR_TYPE == BufferedObject->Type) {
+    BUFFERED_STR *pTempBs = (BUFFERED_STR *)BufferedObject->Obj;
+
+    // check if needs to be printed as error for Esx
+    if ((pPrintCtx->BufferedDataSetCnt == 0) &&
+      (EFI_SUCCESS != pPrintCtx->BufferedObjectLastError) &&
+      (pPrintCtx->FormatTypeFlags.Flags.EsxCustom || pPrintCtx->FormatTypeFlags.Flags.EsxKeyVal))
+    {
+      PrintTextAsEsxError(pTempBs->pStr);
+    }
+    else if (PRINT_JSON == PrinterMode) {
+      JsonPutMessage(pTempBs->pStr);
+    }
+    else
+    {
+      if (PRINT_XML != PrinterMode) {
+        PrintTextWithNewLine(pTempBs->pStr);
+      }
+    }
+    ARENA_FREE_POOL_SAFE(pTempBs->pStr);
+    pPrintCtx->BufferedMsgCnt--;
+  }
+  else if (BUFF_DATA_SET_TYPE == BufferedObject->Type) {
+    BUFFERED_DATA_SET *pTempDs = (BUFFERED_DATA_SET *)BufferedObject->Obj;
+    if (pPrintCtx->StreamStarted) {
+      PrintStreamRecords(pTempDs->pDataSet, pPrintCtx);
+    }
+    else if (PRINT_XML == PrinterMode) {
+      PrintAsXml(pTempDs->pDataSet, pPrintCtx);
+    }
+    else if (PRINT_JSON == PrinterMode) {
+      PrintAsJson(pTempDs->pDataSet);
+    }
+    else if (PRINT_CSV == PrinterMode) {
+      PrintAsCsv(pTempDs->pDataSet);
+    }
+    else {
+      PrintAsText(pTempDs->pDataSet, pPrintCtx);
+    }
+    pPrintCtx->BufferedDataSetCnt--;
+  }
+  else if (BUFF_COMMAND_STATUS_TYPE == BufferedObject->Type) {
+    BUFFERED_COMMAND_STATUS *pTempCs = (BUFFERED_COMMAND_STATUS *)BufferedObject->Obj;
+    CreateCmdStatusMsg(&FullMsg, pTempCs->pStatusMessage, pTempCs->pStatusPreposition,
+        pPrintCtx->DoNotPrintGeneralStatusSuccessCode, pTempCs->pCommandStatus);
+    if (PRINT_JSON == PrinterMode) {
+      JsonPutMessage(FullMsg);
+    }
+    else if (PRINT_XML != PrinterMode) {
+      PrintTextWithNewLine(FullMsg);
+    }
+    FreeCommandStatus(&pTempCs->pCommandStatus);
+    ARENA_FREE_POOL_SAFE(pTempCs->pStatusMessage);
+    ARENA_FREE_POOL_SAFE(pTempCs->pStatusPreposition);
+    ARENA_FREE_POOL_SAFE(FullMsg);
+    pPrintCtx->BufferedCmdStatusCnt--;
+  }
+  ARENA_FREE_POOL_SAFE(BufferedObject->Obj);
+  ARENA_FREE_POOL_SAFE(BufferedObject);
+}
+
+/*
+* Print the records left in a streamed XML data set and close its root tag.
+* An error reported after the first record can no longer replace the results,
+* so the messages are reported in an error element nested in the root tag.
+*/
+static VOID FinishXmlStream(
+  IN     PRINT_CONTEXT *pPrintCtx
+)
+{
+  LIST_ENTRY *Entry;
+  LIST_ENTRY *NextEntry;
+  BUFFERED_PRINTER_OBJECT *BufferedObject;
+  CHAR16 *RootName = NULL;
+
+  BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+    BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+    if (BUFF_DATA_SET_TYPE == BufferedObject->Type) {
+      //the data set itself is freed with the lookup items
+      RootName = GetDataSetName(((BUFFERED_DATA_SET *)BufferedObject->Obj)->pDataSet);
+      ProcessBufferedObject(pPrintCtx, BufferedObject, PRINT_XML);
+    }
+  }
+
+  if (EFI_SUCCESS != pPrintCtx->BufferedObjectLastError) {
+    PrintXmlStartErrorTag(pPrintCtx, pPrintCtx->BufferedObjectLastError);
+    BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+      BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+      ProcessBufferedObject(pPrintCtx, BufferedObject, PRINT_TEXT);
+    }
+    PrintXmlEndErrorTag(pPrintCtx, pPrintCtx->BufferedObjectLastError);
+  }
+
+  if (NULL != RootName) {
+    Print(NVM_XML_WHITESPACE_IDENT);
+    Print(NVM_XML_DATA_SET_TAG_END, RootName);
+  }
+}
+
+/*
+* Serialize all objects in the "set buffer" as JSON or CSV.
+* Data sets are written first.  Like nvmxml, messages are dropped when the command
+* succeeded with data to show; otherwise JSON reports them in a Result or Error
+* member while CSV, having no place for them, prints them as text after the records.
+*/
+static VOID PrintSetBufferAsData(
+  IN     PRINT_CONTEXT *pPrintCtx,
+  IN     PRINT_MODE PrinterMode
+)
+{
+  LIST_ENTRY *Entry;
+  LIST_ENTRY *NextEntry;
+  BUFFERED_PRINTER_OBJECT *BufferedObject;
+  EFI_STATUS CmdExitCode = pPrintCtx->BufferedObjectLastError;
+  BOOLEAN DataSetPrinted = pPrintCtx->StreamStarted;
+
+  if (!pPrintCtx->StreamStarted) {
+    Utf8WriterReset();
+    if (PRINT_JSON == PrinterMode) {
+      Utf8PutChar('{');
+    }
+  }
+
+  BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+    BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+    if (BUFF_DATA_SET_TYPE == BufferedObject->Type) {
+      ProcessBufferedObject(pPrintCtx, BufferedObject, PrinterMode);
+      DataSetPrinted = TRUE;
+    }
+  }
+  //a streamed data set is closed once its last records are printed
+  if (pPrintCtx->StreamStarted && PRINT_JSON == PrinterMode) {
+    JsonEndDataSet();
+  }
+
+  if (!DataSetPrinted || EFI_SUCCESS != CmdExitCode) {
+    if (PRINT_JSON == PrinterMode) {
+      JsonBeginMessages(CmdExitCode);
+    }
+    else {
+      Utf8Flush();
+    }
+    BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+      BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+      ProcessBufferedObject(pPrintCtx, BufferedObject, (PRINT_JSON == PrinterMode) ? PRINT_JSON : PRINT_TEXT);
+    }
+    if (PRINT_JSON == PrinterMode) {
+      JsonEndMessages(CmdExitCode);
+    }
+  }
+  else {
+    //PRINT_XML releases the remaining messages without printing them
+    BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+      BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+      ProcessBufferedObject(pPrintCtx, BufferedObject, PRINT_XML);
+    }
+  }
+
+  if (PRINT_JSON == PrinterMode) {
+    Utf8PutAscii("}\n");
+  }
+  Utf8Flush();
+}
+
 /*
 * Process all objects in the "set buffer"
 */
@@ -1374,7 +2260,6 @@ EFI_STATUS PrinterProcessSetBuffer(
   LIST_ENTRY *NextEntry;
   BUFFERED_PRINTER_OBJECT *BufferedObject;
   EFI_STATUS ReturnCode = EFI_SUCCESS;
-  CHAR16 *FullMsg = NULL;
   PRINT_MODE PrinterMode = PRINT_TEXT;
   BOOLEAN startXmlSuccessPrinted = FALSE;
   BOOLEAN startXmlErrorPrinted = FALSE;
@@ -1386,8 +2271,20 @@ EFI_STATUS PrinterProcessSetBuffer(
 
   PrinterMode = PrintMode(pPrintCtx);
 
+  if (PRINT_JSON == PrinterMode || PRINT_CSV == PrinterMode) {
+    PrintSetBufferAsData(pPrintCtx, PrinterMode);
+    goto Finish;
+  }
+
+  //a streamed data set already printed its start tag along with its first record
+  if (pPrintCtx->StreamStarted) {
+    if (XML == pPrintCtx->FormatType) {
+      PrinterMode = PRINT_XML;
+      FinishXmlStream(pPrintCtx);
+    }
+  }
   //if XML mode print the appropriate start tag
-  if (PRINT_XML == PrinterMode || PRINT_BASIC_XML == PrinterMode) {
+  else if (PRINT_XML == PrinterMode || PRINT_BASIC_XML == PrinterMode) {
     if ((pPrintCtx->BufferedDataSetCnt != 0) ||
       (EFI_SUCCESS == pPrintCtx->BufferedObjectLastError) ||
       (!pPrintCtx->FormatTypeFlags.Flags.EsxCustom && !pPrintCtx->FormatTypeFlags.Flags.EsxKeyVal))
@@ -1409,51 +2306,7 @@ EFI_STATUS PrinterProcessSetBuffer(
   //all items found should be transformed to text and printed directly to stdout
   BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
     BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
-    RemoveEntryList(&BufferedObject->Link);
-    if (BUFF_STR_TYPE == BufferedObject->Type) {
-      BUFFERED_STR *pTempBs = (BUFFERED_STR *)BufferedObject->Obj;
-
-      // check if needs to be printed as error for Esx
-      if ((pPrintCtx->BufferedDataSetCnt == 0) &&
-        (EFI_SUCCESS != pPrintCtx->BufferedObjectLastError) &&
-        (pPrintCtx->FormatTypeFlags.Flags.EsxCustom || pPrintCtx->FormatTypeFlags.Flags.EsxKeyVal))
-      {
-        PrintTextAsEsxError(pTempBs->pStr);
-      }
-      else
-      {
-        if (PRINT_XML != PrinterMode) {
-          PrintTextWithNewLine(pTempBs->pStr);
-        }
-      }
-      FREE_POOL_SAFE(pTempBs->pStr);
-      pPrintCtx->BufferedMsgCnt--;
-    }
-    else if (BUFF_DATA_SET_TYPE == BufferedObject->Type) {
-      BUFFERED_DATA_SET *pTempDs = (BUFFERED_DATA_SET *)BufferedObject->Obj;
-      if (PRINT_XML == PrinterMode) {
-        PrintAsXml(pTempDs->pDataSet, pPrintCtx);
-      }
-      else {
-        PrintAsText(pTempDs->pDataSet, pPrintCtx);
-      }
-      pPrintCtx->BufferedDataSetCnt--;
-    }
-    else if (BUFF_COMMAND_STATUS_TYPE == BufferedObject->Type) {
-      BUFFERED_COMMAND_STATUS *pTempCs = (BUFFERED_COMMAND_STATUS *)BufferedObject->Obj;
-      CreateCmdStatusMsg(&FullMsg, pTempCs->pStatusMessage, pTempCs->pStatusPreposition,
-          pPrintCtx->DoNotPrintGeneralStatusSuccessCode, pTempCs->pCommandStatus);
-      if (PRINT_XML != PrinterMode) {
-        PrintTextWithNewLine(FullMsg);
-      }
-      FreeCommandStatus(&pTempCs->pCommandStatus);
-      FREE_POOL_SAFE(pTempCs->pStatusMessage);
-      FREE_POOL_SAFE(pTempCs->pStatusPreposition);
-      FREE_POOL_SAFE(FullMsg);
-      pPrintCtx->BufferedCmdStatusCnt--;
-    }
-    FREE_POOL_SAFE(BufferedObject->Obj);
-    FREE_POOL_SAFE(BufferedObject);
+    ProcessBufferedObject(pPrintCtx, BufferedObject, PrinterMode);
   }
 
   if (TRUE == startXmlErrorPrinted) {
@@ -1463,46 +2316,44 @@ EFI_STATUS PrinterProcessSetBuffer(
     PrintXmlEndSuccessTag(pPrintCtx, pPrintCtx->BufferedObjectLastError);
   }
 
+Finish:
   CleanDataSetLookupItems(pPrintCtx);
   pPrintCtx->BufferedObjectLastError = EFI_SUCCESS;
+  if (pPrintCtx->StreamStarted) {
+    ArenaResume();
+  }
+  pPrintCtx->StreamStarted = FALSE;
   return ReturnCode;
 }
 
 /*
-* Helper that associates a table/list of attributes with a dataset
+* Helper to find the root dataset of a path in the "root lookup list"
 */
-EFI_STATUS SetDataSetPrinterAttribs(
+static EFI_STATUS FindDataSetRoot(
   IN     PRINT_CONTEXT *pPrintCtx,
   IN     CHAR16 *pKeyPath,
-  IN     PRINTER_DATA_SET_ATTRIBS *pAttribs
+  OUT    DATA_SET_CONTEXT **ppRoot
 )
 {
-  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  EFI_STATUS ReturnCode = EFI_NOT_FOUND;
   CHAR16 **DataSetToks = NULL;
   UINT32 NumDataSetToks = 0;
   LIST_ENTRY *Entry;
   LIST_ENTRY *NextEntry;
   DATA_SET_LOOKUP_ITEM *DataSetLookupItem = NULL;
 
-  if (NULL == pPrintCtx || NULL == pKeyPath) {
-    goto Finish;
-  }
-
   // split path, result toks are data set names
   if (NULL == (DataSetToks = StrSplit(pKeyPath, L'/', &NumDataSetToks))) {
-    ReturnCode = EFI_NOT_FOUND;
     goto Finish;
   }
   else if (NumDataSetToks < 2) {
-    ReturnCode = EFI_NOT_FOUND;
     goto Finish;
   }
 
-  ReturnCode = EFI_NOT_FOUND;
   BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->DataSetRootLookup) {
     DataSetLookupItem = BASE_CR(Entry, DATA_SET_LOOKUP_ITEM, Link);
     if (0 == StrCmp(DataSetToks[1], DataSetLookupItem->DsPath)) {
-      SetDataSetUserData(DataSetLookupItem->pDataSet, (VOID *)pAttribs);
+      *ppRoot = DataSetLookupItem->pDataSet;
       ReturnCode = EFI_SUCCESS;
       break;
     }
@@ -1512,6 +2363,102 @@ Finish:
   return ReturnCode;
 }
 
+/*
+* Helper that associates a table/list of attributes with a dataset
+*/
+EFI_STATUS SetDataSetPrinterAttribs(
+  IN     PRINT_CONTEXT *pPrintCtx,
+  IN     CHAR16 *pKeyPath,
+  IN     PRINTER_DATA_SET_ATTRIBS *pAttribs
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  DATA_SET_CONTEXT *pRoot = NULL;
+
+  if (NULL == pPrintCtx || NULL == pKeyPath) {
+    goto Finish;
+  }
+
+  if (EFI_SUCCESS != (ReturnCode = FindDataSetRoot(pPrintCtx, pKeyPath, &pRoot))) {
+    goto Finish;
+  }
+
+  //SetDataSetUserData frees the previous user data, which is fine only if it is not being set again
+  if (GetDataSetUserData(pRoot) != (VOID *)pAttribs) {
+    SetDataSetUserData(pRoot, (VOID *)pAttribs);
+  }
+Finish:
+  return ReturnCode;
+}
+
+/*
+* Print and release the records of a streamed dataset.
+* The first flush commits the output format, so a dataset that cannot be
+* streamed (ESX formats, multiple datasets, XML after an error) stays buffered.
+*/
+EFI_STATUS PrinterStreamFlush(
+  IN     PRINT_CONTEXT *pPrintCtx,
+  IN     CHAR16 *pRootPath,
+  IN     PRINTER_DATA_SET_ATTRIBS *pAttribs
+)
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  LIST_ENTRY *Entry;
+  LIST_ENTRY *NextEntry;
+  BUFFERED_PRINTER_OBJECT *BufferedObject;
+  DATA_SET_CONTEXT *pRoot = NULL;
+
+  if (NULL == pPrintCtx || NULL == pRootPath) {
+    goto Finish;
+  }
+
+  ReturnCode = EFI_SUCCESS;
+  if (!pPrintCtx->FormatTypeFlags.Flags.Stream) {
+    goto Finish;
+  }
+
+  //no record has been set yet
+  if (EFI_SUCCESS != FindDataSetRoot(pPrintCtx, pRootPath, &pRoot)) {
+    goto Finish;
+  }
+
+  if (NULL != pAttribs) {
+    SetDataSetPrinterAttribs(pPrintCtx, pRootPath, pAttribs);
+  }
+
+  if (!pPrintCtx->StreamStarted) {
+    if (1 != pPrintCtx->BufferedDataSetCnt || PRINTER_ESX_FORMAT_ENABLED(pPrintCtx) ||
+      (XML == pPrintCtx->FormatType && EFI_SUCCESS != pPrintCtx->BufferedObjectLastError)) {
+      goto Finish;
+    }
+
+    //messages buffered ahead of the dataset keep their place in text output
+    if (TEXT == pPrintCtx->FormatType) {
+      BUFFERED_OBJECT_LIST_FOR_EACH_SAFE(Entry, NextEntry, &pPrintCtx->BufferedObjectList) {
+        BufferedObject = BASE_CR(Entry, BUFFERED_PRINTER_OBJECT, Link);
+        if (BUFF_DATA_SET_TYPE == BufferedObject->Type) {
+          break;
+        }
+        ProcessBufferedObject(pPrintCtx, BufferedObject, PRINT_TEXT);
+      }
+    }
+
+    PrintStreamHeader(pRoot, pPrintCtx);
+    pPrintCtx->StreamStarted = TRUE;
+    //arena buffers are only reclaimed at the end of the command, keep the
+    //records built between flushes in the pool so the eviction releases them
+    ArenaSuspend();
+  }
+
+  PrintStreamRecords(pRoot, pPrintCtx);
+  EvictChildDataSets(pRoot);
+  //cached paths may point to data sets released by the eviction
+  CleanDataSetLookupCache(pPrintCtx);
+
+Finish:
+  return ReturnCode;
+}
+
 /*
 * Helper to lookup a dataset described by a path
 */
@@ -1581,7 +2528,8 @@ Finish:
 }
 
 /*
-* Helper that builds a path to a dataset node
+* Helper that builds a path to a dataset node.
+* Paths are rebuilt for every record, so they come from the arena rather than the pool.
 */
 CHAR16 *
 EFIAPI
@@ -1594,7 +2542,7 @@ BuildPath(CHAR16 *Format, ...) {
   }
 
   VA_START(Marker, Format);
-  NewPath = CatVSPrint(NULL, Format, Marker);
+  NewPath = ArenaCatVSPrint(NULL, Format, Marker);
   VA_END(Marker);
   return NewPath;
 }
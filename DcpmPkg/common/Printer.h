@@ -10,6 +10,7 @@
 #include <Debug.h>
 #include <Types.h>
 #include <DataSet.h>
+#include <Arena.h>
 
 #define MAX_HEADER_NAME_SZ            100
 #define MAX_LIST_LEVELS               10
@@ -60,7 +61,9 @@ extern CHAR16* gNullValueToDisplay;
 
 typedef enum {
   TEXT,
-  XML
+  XML,
+  JSON,
+  CSV
 }PRINT_FORMAT_TYPE;
 
 typedef enum {
@@ -81,6 +84,8 @@ typedef struct _FLAGS {
   UINTN EsxKeyVal : 1;
   UINTN EsxCustom : 1;
   UINTN Verbose   : 1;
+  UINTN Stream    : 1;
+  UINTN Line      : 1;
 }FLAGS;
 
 typedef union _PRINT_FORMAT_TYPE_FLAGS {
@@ -129,6 +134,7 @@ typedef struct _PRINT_CONTEXT {
   LIST_ENTRY DataSetLookup;
   LIST_ENTRY DataSetRootLookup;
   BOOLEAN DoNotPrintGeneralStatusSuccessCode;
+  BOOLEAN StreamStarted;
 }PRINT_CONTEXT;
 
 typedef struct _LIST_LEVEL_ATTRIB {
@@ -190,6 +196,18 @@ if(NULL != Ctx) { \
   Ctx->FormatTypeFlags.Flags.EsxCustom = 1; \
 } \
 
+/**Display dataset records as they are flushed rather than when the set buffer is processed (-o stream)**/
+#define PRINTER_ENABLE_STREAM_FORMAT(Ctx) \
+if(NULL != Ctx) { \
+  Ctx->FormatTypeFlags.Flags.Stream = 1; \
+} \
+
+/**Display dataset as one line of key/val pairs per record (-o line)**/
+#define PRINTER_ENABLE_LINE_FORMAT(Ctx) \
+if(NULL != Ctx) { \
+  Ctx->FormatTypeFlags.Flags.Line = 1; \
+} \
+
 /**Set printer format attributes directly to a dataset obj**/
 #define PRINTER_CONFIGURE_DATA_SET_ATTRIBS(DataSet, Attributes) \
 if(NULL != DataSet && NULL != Attributes) { \
@@ -271,6 +289,17 @@ do { \
   } \
 } while(0)
 
+/* Print the records completed so far under root_path and release their memory.
+*  Only has an effect in stream mode, otherwise the records stay in the set buffer.
+*/
+#define PRINTER_STREAM_FLUSH(ctx, root_path, attribs) \
+do { \
+  EFI_STATUS rc; \
+  if(EFI_SUCCESS != (rc = PrinterStreamFlush(ctx, root_path, (VOID *)(attribs)))) { \
+    NVDIMM_CRIT("Failed to flush printer records! (" FORMAT_EFI_STATUS ")", rc); \
+  } \
+} while (0)
+
 /**Transform all objects in the "set buffer" and print the result to stdout**/
 #define PRINTER_PROCESS_SET_BUFFER(ctx) \
 do { \
@@ -303,7 +332,7 @@ do { \
 */
 #define PRINTER_BUILD_KEY_PATH(path, fmt, ...) \
 do { \
-  FREE_POOL_SAFE(path); \
+  ARENA_FREE_POOL_SAFE(path); \
   path = BuildPath(fmt,  ## __VA_ARGS__); \
 } while (0)
 
@@ -444,7 +473,8 @@ EFI_STATUS SetDataSetPrinterAttribs(
 );
 
 /*
-* Helper that builds a path to a dataset node
+* Helper that builds a path to a dataset node.
+* The path is allocated from the arena, free it with ARENA_FREE_POOL_SAFE.
 */
 CHAR16 *
 EFIAPI
@@ -499,6 +529,15 @@ EFI_STATUS PrinterSetCommandStatus(
   IN     COMMAND_STATUS *pCommandStatus
 );
 
+/*
+* Print and release the records of a streamed dataset
+*/
+EFI_STATUS PrinterStreamFlush(
+  IN     PRINT_CONTEXT *pPrintCtx,
+  IN     CHAR16 *pRootPath,
+  IN     PRINTER_DATA_SET_ATTRIBS *pAttribs
+);
+
 /*
 * Process all objects int the "set buffer"
 */
@@ -748,8 +748,8 @@ PrintPcat(
       PrintPcatTable((PCAT_TABLE_HEADER *)pPcat->pPcatVersion.Pcat3Tables.ppDieSkuInfoTable[Index], pPrinterCtx);
     }
   }
-  FREE_POOL_SAFE(pPath);
-  FREE_POOL_SAFE(pTypePath);
+  ARENA_FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pTypePath);
 }
 
 /**
@@ -1047,8 +1047,8 @@ PrintNFit(
   for (Index = 0; Index < pHeader->PlatformCapabilitiesTblesNum; Index++) {
     PrintFitTable((SubTableHeader *)pHeader->ppPlatformCapabilitiesTbles[Index], pPrinterCtx);
   }
-  FREE_POOL_SAFE(pPath);
-  FREE_POOL_SAFE(pTypePath);
+  ARENA_FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pTypePath);
 }
 
 /**
@@ -1294,6 +1294,6 @@ PrintPmtt(
     PrintPmttRev2((VOID *)pTable, pPrinterCtx);
   }
 
-  FREE_POOL_SAFE(pPath);
-  FREE_POOL_SAFE(pTypePath);
+  ARENA_FREE_POOL_SAFE(pPath);
+  ARENA_FREE_POOL_SAFE(pTypePath);
 }
@@ -0,0 +1,137 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "StartupProfile.h"
+#include <Library/BaseMemoryLib.h>
+#ifdef OS_BUILD
+#include <os.h>
+#endif
+
+STATIC STARTUP_PROFILE mStartupProfile;
+
+#ifdef OS_BUILD
+STATIC OS_ONCE mStartupProfileLockOnce = OS_ONCE_INIT;
+STATIC OS_MUTEX *mpStartupProfileLock = NULL;
+STATIC OS_THREAD_LOCAL UINT64 mPhaseStartUs[StartupPhaseMax];  //runs in progress on this thread
+
+STATIC VOID StartupProfileLockCreate(VOID) {
+  mpStartupProfileLock = os_mutex_init(NULL);
+}
+
+/*
+* Without the lock (out of memory) the profile is still updated, unsynchronized
+*/
+STATIC VOID StartupProfileLock() {
+  os_once(&mStartupProfileLockOnce, StartupProfileLockCreate);
+  if (NULL != mpStartupProfileLock) {
+    os_mutex_lock(mpStartupProfileLock);
+  }
+}
+
+STATIC VOID StartupProfileUnlock() {
+  if (NULL != mpStartupProfileLock) {
+    os_mutex_unlock(mpStartupProfileLock);
+  }
+}
+#else
+STATIC UINT64 mPhaseStartUs[StartupPhaseMax];
+#define StartupProfileLock()
+#define StartupProfileUnlock()
+#endif
+
+STATIC CONST CHAR16 *mStartupPhaseNames[StartupPhaseMax] = {
+  L"Preferences",
+  L"AcpiSmbios",
+  L"Dimms",
+  L"Pcd",
+  L"Regions",
+  L"Namespaces",
+  L"Ars",
+  L"BindingStart"
+};
+
+/*
+* Time the phases are measured with, the UEFI build has no clock to measure them
+*/
+STATIC UINT64 StartupNowUs() {
+#ifdef OS_BUILD
+  return os_get_monotonic_us();
+#else
+  return 0;
+#endif
+}
+
+VOID
+StartupPhaseBegin(
+  IN     STARTUP_PHASE Phase
+  )
+{
+  if (Phase >= StartupPhaseMax) {
+    return;
+  }
+  mPhaseStartUs[Phase] = StartupNowUs();
+}
+
+VOID
+StartupPhaseEnd(
+  IN     STARTUP_PHASE Phase
+  )
+{
+  UINT64 NowUs = 0;
+
+  if (Phase >= StartupPhaseMax) {
+    return;
+  }
+  NowUs = StartupNowUs();
+  StartupProfileLock();
+  if (NowUs > mPhaseStartUs[Phase]) {
+    mStartupProfile.Phases[Phase].TimeUs += NowUs - mPhaseStartUs[Phase];
+  }
+  mStartupProfile.Phases[Phase].Runs++;
+  StartupProfileUnlock();
+}
+
+VOID
+StartupProfileSetDimmCount(
+  IN     UINT32 DimmCount
+  )
+{
+  StartupProfileLock();
+  mStartupProfile.DimmCount = DimmCount;
+  StartupProfileUnlock();
+}
+
+VOID
+StartupProfileGet(
+     OUT STARTUP_PROFILE *pProfile
+  )
+{
+  if (NULL == pProfile) {
+    return;
+  }
+  StartupProfileLock();
+  CopyMem(pProfile, &mStartupProfile, sizeof(*pProfile));
+  StartupProfileUnlock();
+}
+
+VOID
+StartupProfileReset(
+  )
+{
+  StartupProfileLock();
+  ZeroMem(&mStartupProfile, sizeof(mStartupProfile));
+  StartupProfileUnlock();
+}
+
+CONST CHAR16 *
+GetStartupPhaseName(
+  IN     STARTUP_PHASE Phase
+  )
+{
+  if (Phase >= StartupPhaseMax) {
+    return L"Unknown";
+  }
+  return mStartupPhaseNames[Phase];
+}
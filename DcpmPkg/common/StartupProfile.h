@@ -0,0 +1,108 @@
+/*
+* Copyright (c) 2018, Intel Corporation.
+* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _STARTUP_PROFILE_H_
+#define _STARTUP_PROFILE_H_
+
+#include <Uefi.h>
+#include <Types.h>
+
+/**
+  Phases of bringing up the library and the driver. Regions, namespaces and
+  the ARS list are built on first use, so they are timed whenever that happens.
+  The PCD phase is a part of the regions phase and is counted in both.
+**/
+typedef enum _STARTUP_PHASE {
+  StartupPhasePreferences = 0,  //!< Loading the preferences, OS builds only
+  StartupPhaseAcpi,             //!< Loading and parsing the ACPI and SMBIOS tables, checking the memory map
+  StartupPhaseDimms,            //!< Initializing the PMem modules, one run for all of them
+  StartupPhasePcd,              //!< Reading the PCD of a PMem module to build the regions, one run per module
+  StartupPhaseRegions,          //!< Building the regions from the PCD or the NFIT
+  StartupPhaseNamespaces,       //!< Reading the LSA and enumerating the namespaces
+  StartupPhaseArs,              //!< Loading the ARS bad address list, UEFI builds only
+  StartupPhaseBindingStart,     //!< The whole driver binding start
+  StartupPhaseMax
+} STARTUP_PHASE;
+
+/**
+  Time spent in one phase since the last reset
+**/
+typedef struct _STARTUP_PHASE_TIME {
+  UINT64 TimeUs;              //!< Sum of the time of all runs
+  UINT32 Runs;                //!< Times the phase ran
+} STARTUP_PHASE_TIME;
+
+/**
+  Startup profile of the process. Lazy phases may run on several threads at
+  once, so it is only accessed through the functions below, which lock it in
+  OS builds. The start of a run in progress is kept per thread.
+**/
+typedef struct _STARTUP_PROFILE {
+  STARTUP_PHASE_TIME Phases[StartupPhaseMax];
+  UINT32 DimmCount;           //!< PMem modules found by the last StartupPhaseDimms
+} STARTUP_PROFILE;
+
+
+/**
+  Mark the start of a run of a phase. Without a clock (UEFI builds) only the
+  runs are counted.
+
+  @param[in] Phase Phase starting
+**/
+VOID
+StartupPhaseBegin(
+  IN     STARTUP_PHASE Phase
+  );
+
+/**
+  Mark the end of the run of a phase started with StartupPhaseBegin()
+
+  @param[in] Phase Phase ending
+**/
+VOID
+StartupPhaseEnd(
+  IN     STARTUP_PHASE Phase
+  );
+
+/**
+  Record the number of PMem modules found by StartupPhaseDimms
+
+  @param[in] DimmCount Number of PMem modules
+**/
+VOID
+StartupProfileSetDimmCount(
+  IN     UINT32 DimmCount
+  );
+
+/**
+  Copy the profile recorded so far
+
+  @param[out] pProfile Buffer for the copy
+**/
+VOID
+StartupProfileGet(
+     OUT STARTUP_PROFILE *pProfile
+  );
+
+/**
+  Forget the phases recorded so far
+**/
+VOID
+StartupProfileReset(
+  );
+
+/**
+  Name of a phase as reported
+
+  @param[in] Phase Phase to name
+
+  @retval Name of the phase, L"Unknown" if Phase is out of range
+**/
+CONST CHAR16 *
+GetStartupPhaseName(
+  IN     STARTUP_PHASE Phase
+  );
+
+#endif /** _STARTUP_PROFILE_H_ **/
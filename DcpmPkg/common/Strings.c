@@ -367,6 +367,18 @@ nlog_format(
       }
     }
 
+    if (current_value_index >= values_length)
+    {
+      //more specifiers than values, leave the specifier out
+      if (*format_head)
+      {
+        format_head++;
+      }
+      format_start = format_head;
+      str_len = 0;
+      continue;
+    }
+
     current_value = *values[current_value_index];
     current_value_index++;
     if (*format_head == 'X')
@@ -437,6 +449,7 @@ CHAR8* u32_to_a(
   UINT64 trim = 0;
   UINT32 base = 10;
   UINT64 len = 0;
+  UINT64 digits = 0;
   UINT32 cntr = 0;
   UINT32 current_val;
 
@@ -469,7 +482,7 @@ CHAR8* u32_to_a(
   while (val > 0)
   {
     current_val = (val % base);
-    len++;
+    digits++;
     if (current_val <= 9)
     {
       *int_str_ptr = (CHAR8)(current_val + (UINT32)'0');
@@ -490,10 +503,10 @@ CHAR8* u32_to_a(
     val = val / base;
   }
 
+  //only the digits written, not the whole scratch string
   int_str_ptr++;
-  len--;
-  retval = get_empty_string(len);
-  MyMemCopy(retval, len, int_str_ptr);
+  retval = get_empty_string(digits);
+  MyMemCopy(retval, digits, int_str_ptr);
   FREE_POOL_SAFE(int_str);
 
   if (0 < max_len)
@@ -1478,7 +1478,7 @@ ConvertHealthStateReasonToHiiStr(
 
   EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
   UINT16 mask = BIT0;
-  CHAR16 *NextSubString = NULL;
+  CONST CHAR16 *NextSubString = NULL;
   NVDIMM_ENTRY();
 
   if (ppHealthStatusReasonStr == NULL) {
@@ -1488,49 +1488,48 @@ ConvertHealthStateReasonToHiiStr(
   while (mask <= BIT9) {
     switch (HealthStatusReason & mask) {
     case HEALTH_REASON_PERCENTAGE_REMAINING_LOW:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERCENTAGE_REMAINING), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERCENTAGE_REMAINING));
       break;
     case HEALTH_REASON_PACKAGE_SPARING_HAS_HAPPENED:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_PACKAGE_SPARING_HAPPENED), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_PACKAGE_SPARING_HAPPENED));
       break;
     case HEALTH_REASON_CAP_SELF_TEST_WARNING:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_WARNING), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_WARNING));
       break;
     case HEALTH_REASON_PERC_REMAINING_EQUALS_ZERO:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERCENTAGE_REMAINING_ZERO), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERCENTAGE_REMAINING_ZERO));
       break;
     case HEALTH_REASON_DIE_FAILURE:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_DIE_FAILURE), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_DIE_FAILURE));
       break;
     case HEALTH_REASON_AIT_DRAM_DISABLED:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_AIT_DRAM_DISABLED), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_AIT_DRAM_DISABLED));
       break;
     case HEALTH_REASON_CAP_SELF_TEST_FAILURE:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_FAIL), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_FAIL));
       break;
     case HEALTH_REASON_CRITICAL_INTERNAL_STATE_FAILURE:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CRITICAL_INTERNAL_FAILURE), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CRITICAL_INTERNAL_FAILURE));
       break;
     case HEALTH_REASON_PERFORMANCE_DEGRADED:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERFORMANCE_DEGRADED), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_PERFORMANCE_DEGRADED));
       break;
     case HEALTH_REASON_CAP_SELF_TEST_COMM_FAILURE:
-      NextSubString = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_COMM_FAILURE), NULL);
+      NextSubString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_CAP_SELF_TEST_COMM_FAILURE));
       break;
     }
 
     if (HealthStatusReason & mask) {
       *ppHealthStatusReasonStr = CatSPrintClean(*ppHealthStatusReasonStr,
         ((*ppHealthStatusReasonStr == NULL) ? FORMAT_STR : FORMAT_STR_WITH_COMMA), NextSubString);
-      FREE_POOL_SAFE(NextSubString);
     }
 
     mask = mask << 1;
   }
 
   if (*ppHealthStatusReasonStr == NULL) {
-    *ppHealthStatusReasonStr = HiiGetString(HiiHandle,
-      STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_NONE), NULL);
+    *ppHealthStatusReasonStr = CatSPrint(NULL, FORMAT_STR,
+      HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_VIEW_DCPMM_FORM_NONE)));
   }
 
   if (*ppHealthStatusReasonStr == NULL) {
@@ -1762,63 +1761,105 @@ SecurityCapabilitiesToStr(
   return pCapabilitiesStr;
 }
 
+#ifndef OS_BUILD
+#define HII_STRING_CACHE_BUCKETS  64  //!< Buckets of the borrowed HII string cache, power of two
+
+/**
+  A string retrieved with HiiGetString and kept for HiiGetStringConst
+**/
+typedef struct _HII_STRING_CACHE_ENTRY {
+  struct _HII_STRING_CACHE_ENTRY *pNext;  //!< Next entry in the same bucket
+  EFI_HII_HANDLE HiiHandle;               //!< Handle the string was retrieved from
+  EFI_STRING_ID StringId;                 //!< Id of the string
+  CHAR16 *pString;                        //!< The string
+} HII_STRING_CACHE_ENTRY;
+
+STATIC HII_STRING_CACHE_ENTRY *mHiiStringCache[HII_STRING_CACHE_BUCKETS];
+
+/**
+  Borrow an i18n string without copying it.
+
+  The HII database only hands out copies, so the first lookup of a string is
+  kept in a cache and returned by every later lookup of the same string.
+
+  @param[in] HiiHandle handle to the HII database that contains i18n strings
+  @param[in] StringId id of the string, STRING_TOKEN(...)
+
+  @retval the string, NULL if it does not exist or out of memory
+**/
+CONST CHAR16 *
+EFIAPI
+HiiGetStringConst(
+  IN     EFI_HII_HANDLE HiiHandle,
+  IN     EFI_STRING_ID StringId
+  )
+{
+  HII_STRING_CACHE_ENTRY *pEntry = NULL;
+  UINTN Bucket = StringId & (HII_STRING_CACHE_BUCKETS - 1);
+
+  for (pEntry = mHiiStringCache[Bucket]; pEntry != NULL; pEntry = pEntry->pNext) {
+    if (pEntry->StringId == StringId && pEntry->HiiHandle == HiiHandle) {
+      return pEntry->pString;
+    }
+  }
+
+  pEntry = AllocateZeroPool(sizeof(*pEntry));
+  if (pEntry == NULL) {
+    return NULL;
+  }
+  pEntry->pString = HiiGetString(HiiHandle, StringId, NULL);
+  if (pEntry->pString == NULL) {
+    FREE_POOL_SAFE(pEntry);
+    return NULL;
+  }
+  pEntry->HiiHandle = HiiHandle;
+  pEntry->StringId = StringId;
+  pEntry->pNext = mHiiStringCache[Bucket];
+  mHiiStringCache[Bucket] = pEntry;
+  return pEntry->pString;
+}
+#endif // !OS_BUILD
+
 /**
   Convert Dimm security state to its respective string
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Dimm security state
 
-  @retval String representation of Dimm's security state
+  @retval String representation of Dimm's security state, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SecurityToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 SecurityState
   )
 {
-  CHAR16 *pSecurityString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pSecurityString = NULL;
 
   switch (SecurityState) {
   case SECURITY_DISABLED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_DISABLED), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_DISABLED));
     break;
   case SECURITY_LOCKED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_LOCKED), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_LOCKED));
     break;
   case SECURITY_UNLOCKED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNLOCKED), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNLOCKED));
     break;
   case SECURITY_PW_MAX:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_PW_MAX), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_PW_MAX));
     break;
   case SECURITY_MASTER_PW_MAX:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_MASTER_PW_MAX), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_MASTER_PW_MAX));
     break;
   case SECURITY_FROZEN:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_FROZEN), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_FROZEN));
     break;
   case SECURITY_NOT_SUPPORTED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_NOT_SUPPORTED), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_NOT_SUPPORTED));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNKNOWN), NULL);
-    pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pSecurityString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNKNOWN));
     break;
   }
 
@@ -1840,46 +1881,39 @@ SecurityStateBitmaskToString(
 )
 {
   CHAR16 *pSecurityString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pTempStr = NULL;
 
   if (SecurityStateBitmask & SECURITY_MASK_NOT_SUPPORTED) {
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_NOT_SUPPORTED), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_NOT_SUPPORTED));
     pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
     goto Finish;
   }
 
   if (SecurityStateBitmask & SECURITY_MASK_ENABLED) {
     if (SecurityStateBitmask & SECURITY_MASK_LOCKED) { // Security State = Locked
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_LOCKED), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_LOCKED));
       pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     else { // Security State = Unlocked
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNLOCKED), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_UNLOCKED));
       pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
   } else { // Security State = Disabled
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_DISABLED), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_DISABLED));
     pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
   }
 
   if (SecurityStateBitmask & SECURITY_MASK_COUNTEXPIRED) {
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_PW_MAX), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_PW_MAX));
     pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR FORMAT_STR, L", ", pTempStr);
-    FREE_POOL_SAFE(pTempStr);
   }
   if (SecurityStateBitmask & SECURITY_MASK_MASTER_COUNTEXPIRED) {
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_MASTER_PW_MAX), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_MASTER_PW_MAX));
     pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR FORMAT_STR, L", ", pTempStr);
-    FREE_POOL_SAFE(pTempStr);
   }
   if (SecurityStateBitmask & SECURITY_MASK_FROZEN) {
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_FROZEN), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SECSTATE_FROZEN));
     pSecurityString = CatSPrintClean(pSecurityString, FORMAT_STR FORMAT_STR, L", ", pTempStr);
-    FREE_POOL_SAFE(pTempStr);
   }
 
 Finish:
@@ -1892,31 +1926,24 @@ Finish:
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's SVN Downgrade opt-in
+  @retval String representation of Dimm's SVN Downgrade opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SVNDowngradeOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
 )
 {
-  CHAR16 *pOptIntString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pOptIntString = NULL;
   switch (OptInValue) {
   case SVN_DOWNGRADE_DISABLE:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SVN_DOWNGRADE_DISABLED), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SVN_DOWNGRADE_DISABLED));
     break;
   case SVN_DOWNGRADE_ENABLE:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SVN_DOWNGRADE_ENABLED), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SVN_DOWNGRADE_ENABLED));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN));
     break;
   }
 
@@ -1928,31 +1955,24 @@ SVNDowngradeOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's Secure Erase Policy opt-in
+  @retval String representation of Dimm's Secure Erase Policy opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SecureErasePolicyOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
 )
 {
-  CHAR16 *pOptIntString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pOptIntString = NULL;
   switch (OptInValue) {
   case SECURE_ERASE_NOT_OPTED_IN:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_ERASE_NO_MASTER_PASSPHRASE), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_ERASE_NO_MASTER_PASSPHRASE));
     break;
   case SECURE_ERASE_OPTED_IN:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_ERASE_MASTER_PASSPHRASE_ENABLED), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_ERASE_MASTER_PASSPHRASE_ENABLED));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN));
     break;
   }
 
@@ -1964,31 +1984,24 @@ SecureErasePolicyOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's S3 Resume opt-in
+  @retval String representation of Dimm's S3 Resume opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 S3ResumeOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
 )
 {
-  CHAR16 *pOptIntString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pOptIntString = NULL;
   switch (OptInValue) {
     case S3_RESUME_SECURE_S3:
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_S3), NULL);
-      pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_SECURE_S3));
       break;
     case S3_RESUME_UNSECURE_S3:
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNSECURE_S3), NULL);
-      pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNSECURE_S3));
       break;
     default:
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN), NULL);
-      pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN));
       break;
   }
 
@@ -2000,31 +2013,24 @@ S3ResumeOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's Fw Activate opt-in
+  @retval String representation of Dimm's Fw Activate opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 FwActivateOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
 )
 {
-  CHAR16 *pOptIntString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pOptIntString = NULL;
   switch (OptInValue) {
   case FW_ACTIVATE_DISABLED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_FW_ACTIVATE_DISABLED), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_FW_ACTIVATE_DISABLED));
     break;
   case FW_ACTIVATE_ENABLED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_FW_ACTIVATE_ENABLED), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_FW_ACTIVATE_ENABLED));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN), NULL);
-    pOptIntString = CatSPrintClean(pOptIntString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pOptIntString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_SEC_OPTIN_UNKNOWN));
     break;
   }
 
@@ -2037,37 +2043,37 @@ FwActivateOptInToString(
   @param[in] HiiHandle Pointer to HII handle
   @param[in] LongOpStatus status value
 
-  @retval CLI string representation of long op status
+  @retval CLI string representation of long op status, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 LongOpStatusToStr(
   IN EFI_HANDLE HiiHandle,
   IN UINT8 LongOpStatus
   )
 {
-  CHAR16 *pLongOpStatusStr = NULL;
+  CONST CHAR16 *pLongOpStatusStr = NULL;
 
   NVDIMM_ENTRY();
 
   switch (LongOpStatus) {
     case LONG_OP_STATUS_NOT_STARTED:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_NOT_STARTED), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_NOT_STARTED));
       break;
     case LONG_OP_STATUS_IN_PROGRESS:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_IN_PROGRESS), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_IN_PROGRESS));
       break;
     case LONG_OP_STATUS_COMPLETED:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_COMPLETED), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_COMPLETED));
       break;
     case LONG_OP_STATUS_ABORTED:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_ABORTED), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_ABORTED));
       break;
     case LONG_OP_STATUS_UNKNOWN:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_UNKNOWN), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_UNKNOWN));
       break;
     case LONG_OP_STATUS_ERROR:
     default:
-      pLongOpStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_ERROR), NULL);
+      pLongOpStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_LONG_OP_STATUS_ERROR));
       break;
   }
 
@@ -2091,67 +2097,57 @@ BootStatusBitmaskToStr(
 {
 
   CHAR16 *pBootStatusStr = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pTempStr = NULL;
 
   NVDIMM_ENTRY();
 
   if (DIMM_BOOT_STATUS_NORMAL == BootStatusBitmask) {
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_SUCCESS), NULL);
+    pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_SUCCESS));
     pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
   } else if (BootStatusBitmask & DIMM_BOOT_STATUS_UNKNOWN) {
     if (BootStatusBitmask & DIMM_BOOT_STATUS_INTERFACE_UNKNOWN) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_INTERFACE_UNKNOWN), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_INTERFACE_UNKNOWN));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_BSR_UNKNOWN) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_BSR_UNKNOWN), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_BSR_UNKNOWN));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
   } else {
     if (BootStatusBitmask & DIMM_BOOT_STATUS_MEDIA_NOT_READY) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_NOT_READY), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_NOT_READY));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_MEDIA_ERROR) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_ERROR), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_ERROR));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_MEDIA_DISABLED) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_DISABLED), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MEDIA_DISABLED));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_DDRT_NOT_READY) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_DDRT_NOT_READY), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_DDRT_NOT_READY));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_SMBUS_NOT_READY) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_SMBUS_NOT_READY), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_SMBUS_NOT_READY));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_MAILBOX_NOT_READY) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MAILBOX_NOT_READY), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_MAILBOX_NOT_READY));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
     if (BootStatusBitmask & DIMM_BOOT_STATUS_REBOOT_REQUIRED) {
-      pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_RR), NULL);
+      pTempStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_BOOT_STATUS_RR));
       pBootStatusStr = CatSPrintClean(pBootStatusStr, FORMAT_STR FORMAT_STR,
         pBootStatusStr == NULL ? L"" : L", ", pTempStr);
-      FREE_POOL_SAFE(pTempStr);
     }
   }
 
@@ -2185,7 +2181,7 @@ StringToDouble(
   BOOLEAN Valid = 0;
   double Decimal = 0.0;
   double Fractional = 0.0;
-  CHAR16 *pDecimalMarkStr = NULL;
+  CONST CHAR16 *pDecimalMarkStr = NULL;
 
   NVDIMM_ENTRY();
 
@@ -2193,7 +2189,7 @@ StringToDouble(
     goto Finish;
   }
 
-  pDecimalMarkStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_DECIMAL_MARK), NULL);
+  pDecimalMarkStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_DECIMAL_MARK));
 
   if (pDecimalMarkStr == NULL) {
     ReturnCode = EFI_NOT_FOUND;
@@ -2238,7 +2234,6 @@ StringToDouble(
   ReturnCode = EFI_SUCCESS;
 
 Finish:
-  FREE_POOL_SAFE(pDecimalMarkStr);
   FreeStringArray(ppStringElements, ElementsCount);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
@@ -2549,42 +2544,32 @@ Finish:
 
 /**
   Convert last firmware update status to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Last Firmware update status value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 LastFwUpdateStatusToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 LastFwUpdateStatus
   )
 {
-  CHAR16 *pLastFwUpdateStatusString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pLastFwUpdateStatusString = NULL;
 
   switch (LastFwUpdateStatus) {
   case FW_UPDATE_STATUS_STAGED_SUCCESS:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_STAGED), NULL);
-    pLastFwUpdateStatusString = CatSPrintClean(pLastFwUpdateStatusString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pLastFwUpdateStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_STAGED));
     break;
   case FW_UPDATE_STATUS_LOAD_SUCCESS:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_SUCCESS), NULL);
-    pLastFwUpdateStatusString = CatSPrintClean(pLastFwUpdateStatusString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pLastFwUpdateStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_SUCCESS));
     break;
   case FW_UPDATE_STATUS_FAILED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_FAIL), NULL);
-    pLastFwUpdateStatusString = CatSPrintClean(pLastFwUpdateStatusString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pLastFwUpdateStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_FAIL));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_UNKNOWN), NULL);
-    pLastFwUpdateStatusString = CatSPrintClean(pLastFwUpdateStatusString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pLastFwUpdateStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FW_UPDATE_STATUS_UNKNOWN));
     break;
   }
 
@@ -2592,37 +2577,29 @@ LastFwUpdateStatusToString(
 }
 /**
   Convert Quiesce required to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Quiesce required value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 QuiesceRequiredToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 QuiesceRequired
 )
 {
-  CHAR16 *pQuiesceRequiredString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pQuiesceRequiredString = NULL;
 
   switch (QuiesceRequired) {
   case QUIESCE_NOT_REQUIRED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_QUIESCE_NOT_REQUIRED), NULL);
-    pQuiesceRequiredString = CatSPrintClean(pQuiesceRequiredString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pQuiesceRequiredString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_QUIESCE_NOT_REQUIRED));
     break;
   case QUIESCE_REQUIRED:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_QUIESCE_REQUIRED), NULL);
-    pQuiesceRequiredString = CatSPrintClean(pQuiesceRequiredString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pQuiesceRequiredString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_QUIESCE_REQUIRED));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_UNKNOWN), NULL);
-    pQuiesceRequiredString = CatSPrintClean(pQuiesceRequiredString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pQuiesceRequiredString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_UNKNOWN));
     break;
   }
 
@@ -2630,37 +2607,29 @@ QuiesceRequiredToString(
 }
 /**
   Convert StagedFwActivatable to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Staged Fw activatable value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 StagedFwActivatableToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 StagedFwActivatable
 )
 {
-  CHAR16 *pStagedFwActivatableString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pStagedFwActivatableString = NULL;
 
   switch (StagedFwActivatable) {
   case STAGED_FW_NOT_ACTIVATABLE:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_STAGED_FW_NOT_ACTIVATABLE), NULL);
-    pStagedFwActivatableString = CatSPrintClean(pStagedFwActivatableString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pStagedFwActivatableString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_STAGED_FW_NOT_ACTIVATABLE));
     break;
   case STAGED_FW_ACTIVATABLE:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_STAGED_FW_ACTIVATABLE), NULL);
-    pStagedFwActivatableString = CatSPrintClean(pStagedFwActivatableString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pStagedFwActivatableString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_STAGED_FW_ACTIVATABLE));
     break;
   default:
-    pTempStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_UNKNOWN), NULL);
-    pStagedFwActivatableString = CatSPrintClean(pStagedFwActivatableString, FORMAT_STR, pTempStr);
-    FREE_POOL_SAFE(pTempStr);
+    pStagedFwActivatableString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_UNKNOWN));
     break;
   }
 
@@ -2856,16 +2825,15 @@ return pTimeFormatString;
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Status bits that define the goal status
 
-  @retval CLI/HII string representation of goal status
+  @retval CLI/HII string representation of goal status, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 GoalStatusToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 Status
   )
 {
-  CHAR16 *pGoalStatusString = NULL;
-  CHAR16 *pTempStr = NULL;
+  CONST CHAR16 *pGoalStatusString = NULL;
 
   if (HiiHandle == NULL) {
     return NULL;
@@ -2873,45 +2841,27 @@ GoalStatusToString(
 
   switch (Status) {
     case GOAL_CONFIG_STATUS_UNKNOWN:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_UNKNOWN), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_UNKNOWN));
       break;
 
     case GOAL_CONFIG_STATUS_NEW:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_REBOOT_REQUIRED), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_REBOOT_REQUIRED));
       break;
 
     case GOAL_CONFIG_STATUS_BAD_REQUEST:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_INVALID_GOAL), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_INVALID_GOAL));
       break;
 
     case GOAL_CONFIG_STATUS_NOT_ENOUGH_RESOURCES:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_NOT_ENOUGH_RESOURCES), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_NOT_ENOUGH_RESOURCES));
       break;
 
     case GOAL_CONFIG_STATUS_FIRMWARE_ERROR:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_FIRMWARE_ERROR), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_FIRMWARE_ERROR));
       break;
 
     default:
-      pTempStr = HiiGetString(HiiHandle,
-        STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_UNKNOWN_ERROR), NULL);
-      pGoalStatusString = CatSPrintClean(pGoalStatusString, FORMAT_STR, pTempStr);
-      FREE_POOL_SAFE(pTempStr);
+      pGoalStatusString = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_PROVISIONING_FORM_GOAL_STATUS_UNKNOWN_ERROR));
       break;
    }
 
@@ -3150,9 +3100,9 @@ ControllerRidToStr(
   @param[in] ReturnCodeGetFIPSMode ReturnCode from GetFIPSMode API call,
                                    used to provide clearer error message
 
-  @retval String representation of the FIPS mode status
+  @retval String representation of the FIPS mode status, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 ConvertFIPSModeToString(
   IN EFI_HANDLE HiiHandle,
   IN FIPS_MODE FIPSMode,
@@ -3160,36 +3110,36 @@ ConvertFIPSModeToString(
   IN EFI_STATUS ReturnCodeGetFIPSMode
 )
 {
-  CHAR16 *pFIPSModeStatusStr = NULL;
+  CONST CHAR16 *pFIPSModeStatusStr = NULL;
 
   if((FwVer.FwApiMajor < 3 ) ||
      (FwVer.FwApiMajor == 3 && FwVer.FwApiMinor < 5)) {
     // FIPS is only supported with >= 3.5. Return N/A
-    pFIPSModeStatusStr = CatSPrint(NULL, FORMAT_STR, NOT_APPLICABLE_SHORT_STR);
+    pFIPSModeStatusStr = NOT_APPLICABLE_SHORT_STR;
     goto Finish;
   }
 
   if (EFI_ERROR(ReturnCodeGetFIPSMode)) {
     // If for some reason the FIPS call failed on a newer firmware, let's put unknown
     // instead of N/A
-    pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_STATUS_ERR_UNKNOWN), NULL);
+    pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_STATUS_ERR_UNKNOWN));
   }
 
   switch (FIPSMode.Status) {
     case FIPSModeStatusNonFIPSMode:
-      pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_NON_FIPS_MODE), NULL);
+      pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_NON_FIPS_MODE));
       break;
     case FIPSModeStatusNonFIPSModeUntilNextBoot:
-      pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_NON_FIPS_MODE_UNTIL_NEXT_BOOT), NULL);
+      pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_NON_FIPS_MODE_UNTIL_NEXT_BOOT));
       break;
     case FIPSModeStatusInitializationNotDone:
-      pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_INITIALIZATION_NOT_DONE), NULL);
+      pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_INITIALIZATION_NOT_DONE));
       break;
     case FIPSModeStatusInitializationDone:
-      pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_INITIALIZATION_DONE), NULL);
+      pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_FIPS_MODE_STATUS_INITIALIZATION_DONE));
       break;
     default:
-      pFIPSModeStatusStr = HiiGetString(HiiHandle, STRING_TOKEN(STR_DCPMM_STATUS_ERR_UNKNOWN), NULL);
+      pFIPSModeStatusStr = HiiGetStringConst(HiiHandle, STRING_TOKEN(STR_DCPMM_STATUS_ERR_UNKNOWN));
       break;
   }
 
@@ -1397,15 +1397,35 @@ SecurityCapabilitiesToStr(
   IN     UINT8 SecurityCapabilities
   );
 
+/**
+  Borrow an i18n string without copying it.
+
+  Unlike HiiGetString the string is owned by the string table (OS build) or
+  by a per HII handle cache that lives as long as the module (UEFI build), so
+  enum to string conversions can hand it out without allocating.
+  The returned string must not be freed or modified.
+
+  @param[in] HiiHandle handle to the HII database that contains i18n strings
+  @param[in] StringId id of the string, STRING_TOKEN(...)
+
+  @retval the string, NULL if it does not exist or out of memory
+**/
+CONST CHAR16 *
+EFIAPI
+HiiGetStringConst(
+  IN     EFI_HII_HANDLE HiiHandle,
+  IN     EFI_STRING_ID StringId
+  );
+
 /**
   Convert Dimm security state to its respective string
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Dimm security state
 
-  @retval String representation of Dimm's security state
+  @retval String representation of Dimm's security state, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SecurityToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 SecurityState
@@ -1453,9 +1473,9 @@ SecurityStateBitmaskToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's SVN Downgrade opt-in
+  @retval String representation of Dimm's SVN Downgrade opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SVNDowngradeOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
@@ -1466,9 +1486,9 @@ SVNDowngradeOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's Secure erase policy opt-in
+  @retval String representation of Dimm's Secure erase policy opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 SecureErasePolicyOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
@@ -1480,9 +1500,9 @@ SecureErasePolicyOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's S3 Resume opt-in
+  @retval String representation of Dimm's S3 Resume opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 S3ResumeOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
@@ -1493,9 +1513,9 @@ S3ResumeOptInToString(
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] SecurityOptIn, bits define dimm's security opt-in value
 
-  @retval String representation of Dimm's Fw Activate opt-in
+  @retval String representation of Dimm's Fw Activate opt-in, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 FwActivateOptInToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT32 OptInValue
@@ -1507,9 +1527,9 @@ FwActivateOptInToString(
   @param[in] HiiHandle Pointer to HII handle
   @param[in] LongOpStatus status value
 
-  @retval CLI string representation of long op status
+  @retval CLI string representation of long op status, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 LongOpStatusToStr(
   IN EFI_HANDLE HiiHandle,
   IN     UINT8 LongOpStatus
@@ -1653,14 +1673,13 @@ UnitsToStr (
 
 /**
   Convert last firmware update status to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Last Firmware update status value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 LastFwUpdateStatusToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 LastFwUpdateStatus
@@ -1668,28 +1687,26 @@ LastFwUpdateStatusToString(
 
 /**
   Convert quiesce required value to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Quiesce required value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 QuiesceRequiredToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 QuiesceRequired
 );
 /**
   Convert StagedFwActivatable to string.
-  The caller function is obligated to free memory of the returned string.
 
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Staged Fw activatable value to convert
 
-  @retval output string or NULL if memory allocation failed
+  @retval output string or NULL if the string was not found, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 StagedFwActivatableToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 StagedFwActivatable
@@ -1751,9 +1768,9 @@ CHAR16 *GetTimeFormatString (
   @param[in] HiiHandle handle to the HII database that contains i18n strings
   @param[in] Status bits that define the goal status
 
-  @retval CLI/HII string representation of goal status
+  @retval CLI/HII string representation of goal status, must not be freed
 **/
-CHAR16*
+CONST CHAR16 *
 GoalStatusToString(
   IN     EFI_HANDLE HiiHandle,
   IN     UINT8 Status
@@ -1922,9 +1939,9 @@ ControllerRidToStr(
   @param[in] ReturnCodeGetFIPSMode ReturnCode from GetFIPSMode API call,
                                    used to provide clearer error message
 
-  @retval String representation of the FIPS mode status
+  @retval String representation of the FIPS mode status, must not be freed
 **/
-CHAR16 *
+CONST CHAR16 *
 ConvertFIPSModeToString(
   IN EFI_HANDLE HiiHandle,
   IN FIPS_MODE FIPSMode,
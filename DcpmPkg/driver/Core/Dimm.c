@@ -23,6 +23,7 @@
 #include <NvmDimmDriver.h>
 #ifdef OS_BUILD
 #include <os_types.h>
+#include <os.h>
 #include <Common.h>
 #endif
 
@@ -1231,6 +1232,14 @@ InitializeDimmInventory(
 
     // Create a new dimm struct for every NVDIMM, functional or not
     CHECK_RESULT_MALLOC(pNewDimm,(DIMM *) AllocateZeroPool(sizeof(*pNewDimm)), Finish);
+#ifdef OS_BUILD
+    // Process private, passthroughs to this DIMM are serialized on it
+    if (NULL == (pNewDimm->pMailboxLock = os_mutex_init(NULL))) {
+      FREE_POOL_SAFE(pNewDimm);
+      ReturnCode = EFI_OUT_OF_RESOURCES;
+      goto Finish;
+    }
+#endif
 
     // Assume dimm is functional
     pNewDimm->NonFunctional = FALSE;
@@ -2069,6 +2078,9 @@ FwCmdGetPlatformConfigData(
   UINT32 Offset = 0;
   UINT32 PcdSize = 0;
   BOOLEAN LargePayloadAvailable = FALSE;
+#ifdef OS_BUILD
+  BOOLEAN MailboxLocked = FALSE;
+#endif
 
   NVDIMM_ENTRY();
 
@@ -2086,6 +2098,11 @@ FwCmdGetPlatformConfigData(
     goto Finish;
   }
 
+#ifdef OS_BUILD
+  // The LSA cache is filled and read under the mailbox lock
+  MailboxLocked = (BOOLEAN)os_mutex_lock(pDimm->pMailboxLock);
+#endif
+
   if (PartitionId == PCD_LSA_PARTITION_ID) {
     PcdSize = pDimm->PcdLsaPartitionSize;
   } else {
@@ -2226,6 +2243,11 @@ FwCmdGetPlatformConfigData(
     CopyMem_S(*ppRawData, PcdSize, pFwCmd->LargeOutputPayload, PcdSize);
   }
 Finish:
+#ifdef OS_BUILD
+  if (MailboxLocked) {
+    os_mutex_unlock(pDimm->pMailboxLock);
+  }
+#endif
   FREE_POOL_SAFE(pFwCmd);
   FREE_POOL_SAFE(pBuffer);
   NVDIMM_EXIT_I64(ReturnCode);
@@ -2529,6 +2551,9 @@ GetPcdOemConfigDataUsingSmallPayload(
   UINT8 *pBuffer = NULL;
   UINT32 Offset = 0;
   UINT8 TmpBuf[PCD_GET_SMALL_PAYLOAD_DATA_SIZE];
+#ifdef OS_BUILD
+  BOOLEAN MailboxLocked = FALSE;
+#endif
   NVDIMM_ENTRY();
 
   if (pDimm == NULL || ppRawData == NULL || pRawDataSize == NULL) {
@@ -2536,6 +2561,11 @@ GetPcdOemConfigDataUsingSmallPayload(
     goto Finish;
   }
 
+#ifdef OS_BUILD
+  // The OEM cache is filled, read and cleared under the mailbox lock
+  MailboxLocked = (BOOLEAN)os_mutex_lock(pDimm->pMailboxLock);
+#endif
+
 // Disable the cache when media is disabled or when the fw is busy
   if (gPCDCacheEnabled && pDimm->PcdOemPartitionSize == 0) {
     gPCDCacheEnabled = 0;
@@ -2622,6 +2652,11 @@ GetPcdOemConfigDataUsingSmallPayload(
   *pRawDataSize = OemDataSize;
 
 Finish:
+#ifdef OS_BUILD
+  if (MailboxLocked) {
+    os_mutex_unlock(pDimm->pMailboxLock);
+  }
+#endif
   if (EFI_ERROR(ReturnCode)) {
     // If error, free the buffer
     FREE_POOL_SAFE(pBuffer);
@@ -5487,6 +5522,9 @@ FreeDimm(
   }
   FreeBlockWindow(pDimm->pBw);
   FREE_POOL_SAFE(pDimm->pPcdOem);
+#ifdef OS_BUILD
+  os_mutex_delete(pDimm->pMailboxLock, NULL);
+#endif
   FREE_POOL_SAFE(pDimm);
   NVDIMM_EXIT();
 }
@@ -7390,8 +7428,14 @@ EFI_STATUS ClearPcdCacheOnDimmList(VOID)
       }
       pDimm = DIMM_FROM_NODE(pDimmNode);
       if (NULL != pDimm) {
+#ifdef OS_BUILD
+        os_mutex_lock(pDimm->pMailboxLock);
+#endif
         // Free memory and set to NULL so won't be used by Get PCD calls
         FREE_POOL_SAFE(pDimm->pPcdOem);
+#ifdef OS_BUILD
+        os_mutex_unlock(pDimm->pMailboxLock);
+#endif
       }
     }
   }
@@ -307,6 +307,11 @@ typedef struct _DIMM {
     have been initialized using PCD in OS.
   **/
   BOOLEAN PcdMappedMemInfoRead;
+  /**
+    Recursive lock serializing the mailbox and the per DIMM caches (PCD)
+    between library threads. Commands to different DIMMs run in parallel.
+  **/
+  VOID *pMailboxLock;
 #endif
   UINT8 FwActiveApiVersionMajor;               //!< Specifies the FW Active Api major version
   UINT8 FwActiveApiVersionMinor;               //!< Specifies the FW Active Api minor version
@@ -5195,7 +5195,7 @@ IsAddressRangeInArsList(
   NVDIMM_ENTRY();
 
   if (gArsBadRecordsCount < 0) {
-    ReturnCode = LoadArsList();
+    ReturnCode = InitializeDriverStage(DriverInitArs);
     if (EFI_PROTOCOL_ERROR == ReturnCode)
     {
       ReturnCode = EFI_SUCCESS;
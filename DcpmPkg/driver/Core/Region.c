@@ -12,6 +12,7 @@
 #include <NvmWorkarounds.h>
 #include <NvmSecurity.h>
 #include <Convert.h>
+#include <StartupProfile.h>
 
 extern NVMDIMMDRIVER_DATA *gNvmDimmData;
 
@@ -296,22 +297,8 @@ GetRegionList(
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
 
-  if (UseNfit ? !gNvmDimmData->PMEMDev.RegionsNfitInitialized :
-    !gNvmDimmData->PMEMDev.RegionsAndNsInitialized) {
-    ReturnCode = InitializeISs(gNvmDimmData->PMEMDev.pFitHead, &gNvmDimmData->PMEMDev.Dimms,
-      UseNfit, (UseNfit ? &gNvmDimmData->PMEMDev.ISsNfit : &gNvmDimmData->PMEMDev.ISs));
-    if (EFI_ERROR(ReturnCode)) {
-      NVDIMM_WARN("Failed to retrieve the REGION list, error = " FORMAT_EFI_STATUS ".", ReturnCode);
-    }
-    else {
-      if (!UseNfit) {
-        gNvmDimmData->PMEMDev.RegionsAndNsInitialized = TRUE;
-      }
-      else {
-        gNvmDimmData->PMEMDev.RegionsNfitInitialized = TRUE;
-      }
-    }
-  }
+  // Built once through the driver stages, concurrent callers wait for it
+  ReturnCode = InitializeDriverStage(UseNfit ? DriverInitRegionsNfit : DriverInitRegions);
 
   if (NULL != ppRegionList) {
     if (!UseNfit) {
@@ -868,12 +855,14 @@ RetrieveISsFromPlatformConfigData(
 
     // Free previous use of pcd header if needed
     FREE_POOL_SAFE(pPcdConfHeader);
+    StartupPhaseBegin(StartupPhasePcd);
     ReturnCode = GetPlatformConfigDataOemPartition(pDimm, FALSE, &pPcdConfHeader);
 #ifdef MEMORY_CORRUPTION_WA
     if (ReturnCode == EFI_DEVICE_ERROR) {
       ReturnCode = GetPlatformConfigDataOemPartition(pDimm, FALSE, &pPcdConfHeader);
     }
 #endif // MEMORY_CORRUPTIO_WA
+    StartupPhaseEnd(StartupPhasePcd);
     if (EFI_ERROR(ReturnCode)) {
       // Ignore all errors except for PMem module busy with sanitize operation
       if (EFI_NO_RESPONSE == ReturnCode) {
@@ -21,6 +21,7 @@
 #include <Protocol/NvdimmLabel.h>
 #include <ProcessorAndTopologyInfo.h>
 #include <PbrDcpmm.h>
+#include <StartupProfile.h>
 #ifndef OS_BUILD
 #include <Smbus.h>
 #endif
@@ -48,12 +49,33 @@ EFI_GUID gIntelDimmPbrTagIdVariableguid = INTEL_DIMM_PBR_TAGID_VARIABLE_GUID;
 
 #ifndef OS_BUILD
 EFI_GUID gDcpmmProtocolGuid = EFI_DCPMM_GUID;
+extern INT32 gArsBadRecordsCount;
 #endif // !OS_BUILD
 
 #ifdef OS_BUILD
+#include <os.h>
 extern UINT8* gSmbiosTable;
+
+/**
+  Lazy stages are built by the first API query that needs them, concurrent
+  queries wait for the one building a stage instead of building it twice.
+**/
+STATIC OS_ONCE mDriverStageLockOnce = OS_ONCE_INIT;
+STATIC OS_MUTEX *mpDriverStageLock = NULL;
+
+STATIC VOID DriverStageLockCreate(VOID)
+{
+  mpDriverStageLock = os_mutex_init(NULL);
+}
 #endif // OS_BUILD
 
+/**
+  Generation of the namespaces, InvalidateNamespacesStage() moves it on and
+  the namespaces stage is read again when it was built for an older one.
+**/
+STATIC volatile UINT64 mNamespacesGeneration = 0;
+STATIC UINT64 mNamespacesBuiltGeneration = 0;
+
 /**
   Array of dimms UEFI-related data structures.
 **/
@@ -234,6 +256,7 @@ CleanNamespacesAndISs(
   **/
   CleanISLists(&gNvmDimmData->PMEMDev.Dimms, &gNvmDimmData->PMEMDev.ISs);
   gNvmDimmData->PMEMDev.RegionsAndNsInitialized = FALSE;
+  gNvmDimmData->PMEMDev.NamespacesInitialized = FALSE;
 
   CleanISLists(&gNvmDimmData->PMEMDev.Dimms, &gNvmDimmData->PMEMDev.ISsNfit);
   gNvmDimmData->PMEMDev.RegionsNfitInitialized = FALSE;
@@ -242,6 +265,150 @@ Finish:
   return ReturnCode;
 }
 
+/**
+  Build a part of the driver state if it has not been built yet, together
+  with the parts it depends on.
+
+  @param[in] Stage Part of the driver state needed
+
+  @retval EFI_SUCCESS the part is built
+  @retval EFI_INVALID_PARAMETER unknown Stage
+  Other return codes from building the part, it is retried on the next call then
+**/
+EFI_STATUS
+InitializeDriverStage(
+  IN     DRIVER_INIT_STAGE Stage
+  )
+{
+  EFI_STATUS ReturnCode = EFI_INVALID_PARAMETER;
+  UINT64 Generation = 0;
+
+  NVDIMM_ENTRY();
+
+#ifdef OS_BUILD
+  // Recursive, the namespaces stage builds the regions stage under it
+  os_once(&mDriverStageLockOnce, DriverStageLockCreate);
+  if (NULL == mpDriverStageLock) {
+    ReturnCode = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+#endif
+  LockDriverStages();
+
+  switch (Stage) {
+  case DriverInitRegions:
+  case DriverInitRegionsNfit:
+    if (Stage == DriverInitRegions ? gNvmDimmData->PMEMDev.RegionsAndNsInitialized :
+        gNvmDimmData->PMEMDev.RegionsNfitInitialized) {
+      ReturnCode = EFI_SUCCESS;
+      break;
+    }
+    StartupPhaseBegin(StartupPhaseRegions);
+    ReturnCode = InitializeInterleaveSets(Stage == DriverInitRegionsNfit);
+    StartupPhaseEnd(StartupPhaseRegions);
+    break;
+  case DriverInitNamespaces:
+#ifdef OS_BUILD
+    Generation = os_atomic_add64(&mNamespacesGeneration, 0);
+#else
+    Generation = mNamespacesGeneration;
+#endif
+    if (gNvmDimmData->PMEMDev.NamespacesInitialized) {
+      if (mNamespacesBuiltGeneration == Generation) {
+        ReturnCode = EFI_SUCCESS;
+        break;
+      }
+      // Stale, nobody walks them while the stages are locked
+      CleanNamespacesList(&gNvmDimmData->PMEMDev.Namespaces);
+      gNvmDimmData->PMEMDev.NamespacesInitialized = FALSE;
+    }
+    // Namespaces are matched against the interleave sets of the PCD
+    ReturnCode = InitializeDriverStage(DriverInitRegions);
+    if (EFI_ERROR(ReturnCode)) {
+      break;
+    }
+    StartupPhaseBegin(StartupPhaseNamespaces);
+    ReturnCode = InitializeNamespaces();
+    StartupPhaseEnd(StartupPhaseNamespaces);
+    if (!EFI_ERROR(ReturnCode)) {
+      gNvmDimmData->PMEMDev.NamespacesInitialized = TRUE;
+      mNamespacesBuiltGeneration = Generation;
+    }
+    break;
+  case DriverInitArs:
+#ifndef OS_BUILD
+    if (gArsBadRecordsCount >= 0) {
+      ReturnCode = EFI_SUCCESS;
+      break;
+    }
+    StartupPhaseBegin(StartupPhaseArs);
+    ReturnCode = LoadArsList();
+    StartupPhaseEnd(StartupPhaseArs);
+#else
+    // The OS keeps the bad address list, the driver never reads it
+    ReturnCode = EFI_UNSUPPORTED;
+#endif
+    break;
+  default:
+    break;
+  }
+
+  UnlockDriverStages();
+
+#ifdef OS_BUILD
+Finish:
+#endif
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
+/**
+  Mark the namespaces read from the LSA as stale, the next
+  InitializeDriverStage(DriverInitNamespaces) reads them again. Only for
+  namespaces without protocols installed on them. Callers walking them hold
+  the stages with LockDriverStages(), so this is safe from any caller.
+**/
+VOID
+InvalidateNamespacesStage(
+  )
+{
+#ifdef OS_BUILD
+  os_atomic_add64(&mNamespacesGeneration, 1);
+#else
+  mNamespacesGeneration++;
+#endif
+}
+
+/**
+  Keep the built driver stages from being read again by concurrent callers
+  until UnlockDriverStages(), for callers walking a stage. Calls nest.
+**/
+VOID
+LockDriverStages(
+  )
+{
+#ifdef OS_BUILD
+  os_once(&mDriverStageLockOnce, DriverStageLockCreate);
+  if (NULL != mpDriverStageLock) {
+    os_mutex_lock(mpDriverStageLock);
+  }
+#endif
+}
+
+/**
+  Release the driver stages held with LockDriverStages()
+**/
+VOID
+UnlockDriverStages(
+  )
+{
+#ifdef OS_BUILD
+  if (NULL != mpDriverStageLock) {
+    os_mutex_unlock(mpDriverStageLock);
+  }
+#endif
+}
+
 /**
   Function that allows to "refresh" the existing DIMMs.
   If a DIMM is inaccessible, all of the ISs and namespaces
@@ -295,6 +462,7 @@ ReenumerateNamespacesAndISs(
     NVDIMM_WARN("Failed to re-initialize namespaces, error = " FORMAT_EFI_STATUS ".", ReturnCode);
     goto Finish;
   }
+  gNvmDimmData->PMEMDev.NamespacesInitialized = TRUE;
 
   /** Install block and device path protocols on Namespaces **/
   ReturnCode = InstallProtocolsOnNamespaces();
@@ -1181,23 +1349,23 @@ InitializeDimms()
     **/
 
     // Initialize Interleave Sets using PCD
-    ReturnCode = InitializeInterleaveSets(FALSE);
+    ReturnCode = InitializeDriverStage(DriverInitRegions);
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_WARN("Failed to retrieve the REGION/IS list from PCD, error = " FORMAT_EFI_STATUS ".", ReturnCode);
     }
 
-    // Initialize Interleave Sets using NFIT table
-    ReturnCode = InitializeInterleaveSets(TRUE);
-    if (EFI_ERROR(ReturnCode)) {
-      NVDIMM_WARN("Failed to retrieve the REGION/IS list from NFIT, error = " FORMAT_EFI_STATUS ".", ReturnCode);
-    }
+    // The NFIT Interleave Sets are only read by region queries and goal
+    // creation, they build them through InitializeDriverStage()
 
     /**
-      Initialize Namespaces
+      Initialize Namespaces. They are built here rather than on first use as
+      the Block IO protocols installed on them are used outside of the driver.
     **/
     ReturnCode = InitializeNamespaces();
     if (EFI_ERROR(ReturnCode)) {
       NVDIMM_WARN("Failed to initialize Namespaces, error = " FORMAT_EFI_STATUS ".", ReturnCode);
+    } else {
+      gNvmDimmData->PMEMDev.NamespacesInitialized = TRUE;
     }
    }
 #endif // !OS_BUILD
@@ -1349,6 +1517,7 @@ NvmDimmDriverDriverBindingStart(
 {
    EFI_STATUS ReturnCode = EFI_SUCCESS;
    UINT32 Index = 0;
+   UINT32 DimmCount = 0;
    DIMM *pDimm = NULL;
    DIMM *pDimm2 = NULL;
    LIST_ENTRY *pDimmNode = NULL;
@@ -1359,6 +1528,8 @@ NvmDimmDriverDriverBindingStart(
 
    NVDIMM_ENTRY();
 
+   StartupPhaseBegin(StartupPhaseBindingStart);
+
    /**
    Remember the Controller handle that we were started with.
    **/
@@ -1368,9 +1539,11 @@ NvmDimmDriverDriverBindingStart(
    /**
    load the ACPI Tables (NFIT, PCAT, PMTT)
    **/
+   StartupPhaseBegin(StartupPhaseAcpi);
    ReturnCode = initAcpiTables();
    if (EFI_ERROR(ReturnCode)) {
       NVDIMM_WARN("Failed to initialize the ACPI tables, error = " FORMAT_EFI_STATUS ".", ReturnCode);
+      StartupPhaseEnd(StartupPhaseAcpi);
       goto Finish;
    }
 
@@ -1378,6 +1551,7 @@ NvmDimmDriverDriverBindingStart(
    check the NFIT SPA range map against the memory map
    **/
    ReturnCode = CheckMemoryMap();
+   StartupPhaseEnd(StartupPhaseAcpi);
    if (EFI_ERROR(ReturnCode)) {
       NVDIMM_ERR("Failed while checking memory map, error = " FORMAT_EFI_STATUS ".", ReturnCode);
       goto Finish;
@@ -1386,10 +1560,17 @@ NvmDimmDriverDriverBindingStart(
    /**
    enumerate DCPMMs
    **/
+   StartupPhaseBegin(StartupPhaseDimms);
    ReturnCode = FillDimmList();
+   StartupPhaseEnd(StartupPhaseDimms);
    if (EFI_ERROR(ReturnCode)) {
       NVDIMM_WARN("Failed to initialize Dimms, error = " FORMAT_EFI_STATUS ".", ReturnCode);
    }
+   DimmCount = 0;
+   LIST_FOR_EACH(pDimmNode, &gNvmDimmData->PMEMDev.Dimms) {
+      DimmCount++;
+   }
+   StartupProfileSetDimmCount(DimmCount);
 
    /**
    Verify that all manageable NVM-DIMMs have unique identifier. Otherwise, print a critical error and
@@ -1464,6 +1645,7 @@ NvmDimmDriverDriverBindingStart(
        CHECK_RESULT_CONTINUE(NvmDimmDriverDriverBindingStop(pThis, ControllerHandle, 0, NULL));
    }
 
+   StartupPhaseEnd(StartupPhaseBindingStart);
    NVDIMM_DBG("Exiting DriverBindingStart, error = " FORMAT_EFI_STATUS ".\n", ReturnCode);
    NVDIMM_EXIT_I64(ReturnCode);
    return ReturnCode;
@@ -1591,12 +1773,9 @@ NvmDimmDriverDriverBindingStart(
    }
 
    /**
-     load the ARS list
+     The ARS list is only needed to check namespace I/O against bad addresses,
+     IsAddressRangeInArsList() loads it on the first I/O
    **/
-   ReturnCode = LoadArsList();
-   if (EFI_ERROR(ReturnCode)) {
-     NVDIMM_WARN("Failed to load the ARS list, error = " FORMAT_EFI_STATUS ".", ReturnCode);
-   }
 
    // Ignore return code as we don't want to block the ability to work
    // with functional dimms
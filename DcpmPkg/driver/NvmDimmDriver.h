@@ -98,6 +98,20 @@ extern EFI_BLOCK_IO_PROTOCOL gNvmDimmDriverBlockIo;
 extern EFI_NVDIMM_LABEL_PROTOCOL gNvdimmLabelProtocol;
 extern EFI_DCPMM_PBR_PROTOCOL gNvmDimmDriverNvmDimmPbr;
 
+/**
+  Parts of the driver state that are built on first use instead of at binding start.
+  The PMem module inventory itself is always built at binding start, every
+  protocol the driver installs is per PMem module. The UEFI driver also builds
+  the PCD regions and the namespaces at binding start, the Block IO protocols
+  on namespaces are used outside of the driver.
+**/
+typedef enum _DRIVER_INIT_STAGE {
+  DriverInitRegions,        ///< Interleave sets from the PCD
+  DriverInitRegionsNfit,    ///< Interleave sets from the NFIT
+  DriverInitNamespaces,     ///< Namespaces from the LSA, needs DriverInitRegions
+  DriverInitArs             ///< ARS bad address list from the BIOS
+} DRIVER_INIT_STAGE;
+
 typedef struct _PMEM_DEV {
   LIST_ENTRY Dimms;
   LIST_ENTRY ISs;
@@ -293,6 +307,48 @@ ReenumerateNamespacesAndISs(
   IN BOOLEAN DoDriverCleanup
   );
 
+/**
+  Build a part of the driver state if it has not been built yet, together
+  with the parts it depends on. Commands call it for what they touch, so
+  they do not pay for reading what they never use. Concurrent callers are
+  serialized, a part is built once.
+
+  @param[in] Stage Part of the driver state needed
+
+  @retval EFI_SUCCESS the part is built
+  @retval EFI_INVALID_PARAMETER unknown Stage
+  Other return codes from building the part, it is retried on the next call then
+**/
+EFI_STATUS
+InitializeDriverStage(
+  IN     DRIVER_INIT_STAGE Stage
+  );
+
+/**
+  Mark the namespaces read from the LSA as stale, the next
+  InitializeDriverStage(DriverInitNamespaces) reads them again. Only for
+  namespaces without protocols installed on them. Callers walking them hold
+  the stages with LockDriverStages(), so this is safe from any caller.
+**/
+VOID
+InvalidateNamespacesStage(
+  );
+
+/**
+  Keep the built driver stages from being read again by concurrent callers
+  until UnlockDriverStages(), for callers walking a stage. Calls nest.
+**/
+VOID
+LockDriverStages(
+  );
+
+/**
+  Release the driver stages held with LockDriverStages()
+**/
+VOID
+UnlockDriverStages(
+  );
+
 /**
   Function tries to remove all of the block namespaces protocols, then it
   removes all of the enumerated namespaces from the LSA and also the ISs.
@@ -167,6 +167,8 @@ EFI_DCPMM_CONFIG2_PROTOCOL gNvmDimmDriverNvmDimmConfig =
   SetDriverDebugPrintErrorLevel,
 #endif //OS_BUILD
   GetFIPSMode,
+  GetDimmPerformanceCounters,
+  GetDimmCores,
 };
 
 
@@ -184,6 +186,8 @@ EFI_DCPMM_PBR_PROTOCOL gNvmDimmDriverNvmDimmPbr =
   PbrGetDataPlaybackInfo,
   PbrGetData,
   PbrSetData,
+  PbrSetPlaybackOrder,
+  PbrGetPlaybackOrder,
 };
 
 /**
@@ -1895,6 +1899,74 @@ Finish:
   return ReturnCode;
 }
 
+/**
+  Retrieve the identity of the functional DCPMMs found in NFIT, in the order
+  of GetDimms(). Only the global dimm struct is read.
+
+  @param[in] pThis A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] DimmCount The size of pDimmCores.
+  @param[out] pDimmCores The dimm identities found in NFIT.
+
+  @retval EFI_SUCCESS  The dimm list was returned properly
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL or invalid.
+**/
+EFI_STATUS
+EFIAPI
+GetDimmCores(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+  IN     UINT32 DimmCount,
+     OUT DIMM_INFO_CORE *pDimmCores
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  UINT32 Index = 0;
+  LIST_ENTRY *pNode = NULL;
+  DIMM *pCurDimm = NULL;
+  DIMM_INFO_CORE *pCore = NULL;
+
+  NVDIMM_ENTRY();
+
+  if (pThis == NULL || pDimmCores == NULL) {
+    NVDIMM_DBG("pDimmCores is NULL");
+    ReturnCode = EFI_INVALID_PARAMETER;
+    goto Finish;
+  }
+
+  SetMem(pDimmCores, sizeof(*pDimmCores) * DimmCount, 0);
+
+  LIST_FOR_EACH(pNode, &gNvmDimmData->PMEMDev.Dimms) {
+    pCurDimm = DIMM_FROM_NODE(pNode);
+    if (pCurDimm->NonFunctional == TRUE) {
+      continue;
+    }
+
+    if (DimmCount <= Index) {
+      NVDIMM_DBG("Array is too small to hold entire DIMM list");
+      ReturnCode = EFI_INVALID_PARAMETER;
+      goto Finish;
+    }
+
+    pCore = &pDimmCores[Index];
+    pCore->DimmID = pCurDimm->DimmID;
+    pCore->DimmHandle = pCurDimm->DeviceHandle.AsUint32;
+    pCore->SocketId = pCurDimm->SocketId;
+    pCore->ImcId = pCurDimm->ImcId;
+    pCore->ChannelId = pCurDimm->ChannelId;
+    pCore->ChannelPos = pCurDimm->ChannelPos;
+    pCore->NodeControllerID = pCurDimm->NodeControllerID;
+    pCore->ManageabilityState = IsDimmManageable(pCurDimm) ? MANAGEMENT_VALID_CONFIG : MANAGEMENT_INVALID_CONFIG;
+    pCore->IsInPopulationViolation = IsDimmInPopulationViolation(pCurDimm);
+    if (EFI_ERROR(GetDimmUid(pCurDimm, pCore->DimmUid, MAX_DIMM_UID_LENGTH)) || StrLen(pCore->DimmUid) == 0) {
+      pCore->ErrorMask |= DIMM_INFO_ERROR_UID;
+    }
+    Index++;
+  }
+
+Finish:
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
 
 /**
   Retrieve the list of non-functional PMem modules found in NFIT
@@ -4177,6 +4249,7 @@ GetRegions(
   NVM_IS *pCurRegion = NULL;
   LIST_ENTRY *pCurRegionNode = NULL;
   LIST_ENTRY *pRegionList = NULL;
+  BOOLEAN StagesLocked = FALSE;
 
   NVDIMM_ENTRY();
 
@@ -4206,7 +4279,10 @@ GetRegions(
   }
 
 #ifdef OS_BUILD
-  Rc = InitializeNamespaces();
+  // The free capacity walks the namespaces, keep concurrent callers from reading them again meanwhile
+  LockDriverStages();
+  StagesLocked = TRUE;
+  Rc = InitializeDriverStage(DriverInitNamespaces);
   if (EFI_ERROR(Rc)) {
     NVDIMM_WARN("Failed to initialize Namespaces, error = " FORMAT_EFI_STATUS ".", Rc);
     Rc = EFI_SUCCESS; // we don't want to fail the GetRegions function in case the Namespace Initialization error
@@ -4235,6 +4311,9 @@ GetRegions(
   BubbleSort(pRegions, Count, sizeof(*pRegions), SortRegionInfoById);
 
 Finish:
+  if (StagesLocked) {
+    UnlockDriverStages();
+  }
   NVDIMM_EXIT_I64(Rc);
   return Rc;
 }
@@ -4458,6 +4537,74 @@ Finish:
     return ReturnCode;
 }
 
+/**
+Read the lifetime performance counters of one PMem module
+
+Only memory info page 1 is read, so a caller sampling the counters pays one
+FW command per PMem module. The current boot counters of pDimmPerformanceData
+are left zeroed.
+
+@param[in] pThis a pointer to EFI_DCPMM_CONFIG2_PROTOCOL instance
+@param[in] DimmId PMem module to read
+@param[out] pDimmPerformanceData performance data of the PMem module
+
+@retval EFI_INVALID_PARAMETER passed NULL argument
+@retval EFI_NOT_FOUND no PMem module with DimmId
+@retval EFI_UNSUPPORTED the PMem module is not manageable
+@retval EFI_DEVICE_ERROR failure of the FW command
+@retval EFI_SUCCESS Success
+**/
+EFI_STATUS
+EFIAPI
+GetDimmPerformanceCounters(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+  IN     UINT16 DimmId,
+     OUT DIMM_PERFORMANCE_DATA *pDimmPerformanceData
+  )
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  DIMM *pDimm = NULL;
+  PT_OUTPUT_PAYLOAD_MEMORY_INFO_PAGE1 *pPayloadMemInfoPage1 = NULL;
+
+  NVDIMM_ENTRY();
+
+  if ((NULL == pThis) || (NULL == pDimmPerformanceData)) {
+    ReturnCode = EFI_INVALID_PARAMETER;
+    goto Finish;
+  }
+
+  pDimm = GetDimmByPid(DimmId, &gNvmDimmData->PMEMDev.Dimms);
+  if (NULL == pDimm) {
+    ReturnCode = EFI_NOT_FOUND;
+    goto Finish;
+  }
+  if (!IsDimmManageable(pDimm)) {
+    NVDIMM_WARN("Dimm 0x%x is not manageable", pDimm->DeviceHandle.AsUint32);
+    ReturnCode = EFI_UNSUPPORTED;
+    goto Finish;
+  }
+
+  ReturnCode = FwCmdGetMemoryInfoPage(pDimm, MEMORY_INFO_PAGE_1,
+      sizeof(PT_OUTPUT_PAYLOAD_MEMORY_INFO_PAGE1), (VOID **)&pPayloadMemInfoPage1);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_ERR("Could not read the memory info page 1; Return code 0x%08x", ReturnCode);
+    ReturnCode = EFI_DEVICE_ERROR;
+    goto Finish;
+  }
+
+  ZeroMem(pDimmPerformanceData, sizeof(*pDimmPerformanceData));
+  pDimmPerformanceData->DimmId = pDimm->DimmID;
+  pDimmPerformanceData->TotalMediaReads = pPayloadMemInfoPage1->TotalMediaReads;
+  pDimmPerformanceData->TotalMediaWrites = pPayloadMemInfoPage1->TotalMediaWrites;
+  pDimmPerformanceData->TotalReadRequests = pPayloadMemInfoPage1->TotalReadRequests;
+  pDimmPerformanceData->TotalWriteRequests = pPayloadMemInfoPage1->TotalWriteRequests;
+
+Finish:
+  FREE_POOL_SAFE(pPayloadMemInfoPage1);
+  NVDIMM_EXIT_I64(ReturnCode);
+  return ReturnCode;
+}
+
 /**
   Parse EFI_ACPI_DESCRIPTION_HEADER (DSDT) and fetch NFIT & PCAT pointers to table
   Also, parse PMTT table to check if MM can be configured
@@ -5985,6 +6132,9 @@ GetActualRegionsGoalCapacities(
     *pNumOfDimmsTargeted = DimmsNum;
   }
 
+  // The NFIT regions of the unspecified PMem modules count towards the limits
+  InitializeDriverStage(DriverInitRegionsNfit);
+
   ReturnCode = RetrieveGoalConfigsFromPlatformConfigData(&gNvmDimmData->PMEMDev.Dimms, FALSE);
   if (EFI_ERROR(ReturnCode)) {
     if (EFI_NO_RESPONSE == ReturnCode) {
@@ -6391,23 +6541,21 @@ CreateGoalConfig(
 
   }
 
-#ifdef OS_BUILD
-  // TODO: Optimize the number of LSA reads happening when interleave sets
-  // are initialized using NFIT & PCD both and namespaces are initialized.
-
-  // Trigger Interleave Set initialization from PCD
-  InitializeInterleaveSets(FALSE);
-
-  // Trigger Interleave Set initialization from NFIT
-  InitializeInterleaveSets(TRUE);
+  // Only the stages not built by an earlier call are read, the LSA at most once
+  InitializeDriverStage(DriverInitRegionsNfit);
 
-  ReturnCode = InitializeNamespaces();
+#ifdef OS_BUILD
+  LockDriverStages();
+  ReturnCode = InitializeDriverStage(DriverInitNamespaces);
   if (EFI_ERROR(ReturnCode)) {
     NVDIMM_WARN("Failed to initialize Namespaces, error = " FORMAT_EFI_STATUS ".", ReturnCode);
   }
 #endif
 
   ReturnCode = IsNamespaceOnDimms(ppDimms, DimmsNum, &Found);
+#ifdef OS_BUILD
+  UnlockDriverStages();
+#endif
   if (EFI_ERROR(ReturnCode)) {
     goto Finish;
   }
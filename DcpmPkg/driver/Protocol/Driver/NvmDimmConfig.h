@@ -212,6 +212,25 @@ GetDimms(
      OUT DIMM_INFO *pDimms
   );
 
+/**
+  Retrieve the identity of the PMem modules found in NFIT, in the order of
+  GetDimms(). Only the global dimm struct is read.
+
+  @param[in] pThis A pointer to the EFI_DCPMM_CONFIG2_PROTOCOL instance.
+  @param[in] DimmCount The size of pDimmCores.
+  @param[out] pDimmCores The PMem module identities found in NFIT.
+
+  @retval EFI_SUCCESS Success
+  @retval EFI_INVALID_PARAMETER one or more parameters are NULL or invalid.
+**/
+EFI_STATUS
+EFIAPI
+GetDimmCores(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+  IN     UINT32 DimmCount,
+     OUT DIMM_INFO_CORE *pDimmCores
+  );
+
 /**
   Retrieve the list of non-functional PMem modules found in NFIT
 
@@ -662,6 +681,24 @@ GetDimmsPerformanceData(
     OUT DIMM_PERFORMANCE_DATA **pDimmsPerformanceData
 );
 
+/**
+  Read the lifetime performance counters of one PMem module
+
+  @param[in] pThis a pointer to EFI_DCPMM_CONFIG2_PROTOCOL instance
+  @param[in] DimmId PMem module to read
+  @param[out] pDimmPerformanceData performance data of the PMem module, only the Total counters are set
+
+  @retval EFI_SUCCESS Success
+  @retval ERROR any non-zero value is an error (more details in Base.h)
+**/
+EFI_STATUS
+EFIAPI
+GetDimmPerformanceCounters(
+  IN     EFI_DCPMM_CONFIG2_PROTOCOL *pThis,
+  IN     UINT16 DimmId,
+     OUT DIMM_PERFORMANCE_DATA *pDimmPerformanceData
+  );
+
 /**
   Get System Capabilities information from PCAT tables
   Pointer to variable length pInterleaveFormatsSupported is allocated here and must be freed by
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+  Replay driven CLI benchmark.
+
+  Runs the main CLI commands in-process against recorded (PBR) sessions, so
+  command latency can be tracked without PMem hardware. A session for the
+  corpus is produced on a real platform with:
+    ipmctl_bench -record <session.pbr>
+  which records each benchmarked command once, in the order they are replayed.
+  The corpus is then replayed with:
+    ipmctl_bench [-n <iterations>] [-order sequential|keyed] <session.pbr> [<session.pbr> ...]
+
+  Library startup is benchmarked with:
+    ipmctl_bench -startup [-n <iterations>] [-csv] [<session.pbr>]
+  which brings the library up and down again for each iteration, against the
+  session if one is given and against the PMem modules otherwise, and reports
+  where the time went per startup phase. Regions and namespaces are built on
+  first use, so every iteration also reads the regions once.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <nvm_management.h>
+
+extern NVM_API int nvm_run_cli(int argc, char *argv[]);
+
+#define MAX_BENCH_ARGS               12
+#define DEFAULT_ITERATIONS           10
+#define WORK_DIR_TEMPLATE            "/tmp/ipmctl_bench.XXXXXX"
+#define SUPPORT_FILE_PREFIX          "support"
+#define SUPPORT_FILE_SUFFIX          "_platform_support_info.txt"   ///< Appended by dump -support to the destination
+#define PROMPT_ANSWER_FILE_NAME      "answer.txt"
+#define NS_PER_MS                    1000000.0
+
+/**
+  A benchmarked CLI command
+**/
+typedef struct _BENCH_CMD
+{
+  const char *name;                     ///< Name used in the report
+  char *argv[MAX_BENCH_ARGS];           ///< Command line, NULL terminated
+  const char *prompt_answer;            ///< Reply fed to a confirmation prompt, NULL if none
+} BENCH_CMD;
+
+/**
+  Statistics gathered for a benchmarked command
+**/
+typedef struct _BENCH_STATS
+{
+  unsigned int runs;                    ///< Number of runs
+  unsigned int failures;                ///< Number of runs with a non zero return code
+  double wall_ms_min;                   ///< Fastest run
+  double wall_ms_max;                   ///< Slowest run
+  double wall_ms_total;                 ///< Sum of all runs
+  unsigned long long allocations;       ///< Sum of allocations of all runs
+  unsigned long long allocated_bytes;   ///< Sum of allocated bytes of all runs
+  unsigned long long fw_commands;       ///< Sum of FW commands of all runs
+  long peak_rss_kb;                     ///< Peak resident set size of the whole process so far, not of the command
+} BENCH_STATS;
+
+//private directory for the files the commands write, so that no other user can plant them
+static char g_work_dir[] = WORK_DIR_TEMPLATE;
+static char g_support_prefix[sizeof(WORK_DIR_TEMPLATE) + sizeof(SUPPORT_FILE_PREFIX)];
+static char g_support_path[sizeof(g_support_prefix) + sizeof(SUPPORT_FILE_SUFFIX)];
+static char g_prompt_answer_path[sizeof(WORK_DIR_TEMPLATE) + sizeof(PROMPT_ANSWER_FILE_NAME)];
+
+static BENCH_CMD g_bench_cmds[] = {
+  {"show -dimm -a", {"ipmctl", "show", "-dimm", "-a", NULL}, NULL},
+  {"show -region", {"ipmctl", "show", "-region", NULL}, NULL},
+  {"show -sensor", {"ipmctl", "show", "-sensor", NULL}, NULL},
+  {"show -topology", {"ipmctl", "show", "-topology", NULL}, NULL},
+  {"create -goal (dry run)", {"ipmctl", "create", "-goal", "PersistentMemoryType=AppDirect", NULL}, "n\n"},
+  {"dump -support", {"ipmctl", "dump", "-destination", g_support_prefix, "-support", NULL}, NULL},
+};
+
+#define BENCH_CMD_COUNT (sizeof(g_bench_cmds) / sizeof(g_bench_cmds[0]))
+
+/**
+  Statistics gathered for a startup phase
+**/
+typedef struct _STARTUP_STATS
+{
+  unsigned long long runs;              ///< Sum of the runs of the phase over all iterations
+  double ms_min;                        ///< Shortest iteration
+  double ms_max;                        ///< Longest iteration
+  double ms_total;                      ///< Sum of all iterations
+} STARTUP_STATS;
+
+static const char *g_startup_phase_names[STARTUP_PHASE_COUNT] = {
+  "Preferences", "AcpiSmbios", "Dimms", "Pcd", "Regions", "Namespaces", "Ars", "BindingStart"
+};
+
+#define STARTUP_INIT_ROW              STARTUP_PHASE_COUNT        ///< Report row of the nvm_init() wall time
+#define STARTUP_FIRST_USE_ROW         (STARTUP_PHASE_COUNT + 1)  ///< Report row of the first region read
+#define STARTUP_ROW_COUNT             (STARTUP_PHASE_COUNT + 2)
+
+static FILE *g_report = NULL;
+static int g_saved_stdout = -1;
+static int g_null_fd = -1;
+
+/**
+  Count the arguments of a NULL terminated command line
+**/
+static int get_argc(char *argv[])
+{
+  int argc = 0;
+  while (argc < MAX_BENCH_ARGS && argv[argc] != NULL) {
+    argc++;
+  }
+  return argc;
+}
+
+/**
+  Get a monotonic timestamp in milliseconds
+**/
+static double get_time_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / NS_PER_MS;
+}
+
+/**
+  Get the peak resident set size of the process in KiB
+**/
+static long get_peak_rss_kb(void)
+{
+  struct rusage usage;
+  if (0 != getrusage(RUSAGE_SELF, &usage)) {
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+/**
+  Feed a reply to the next confirmation prompt, or close stdin if there is none
+**/
+static int set_prompt_answer(const char *answer)
+{
+  FILE *p_file = NULL;
+
+  if (NULL == answer) {
+    return (NULL == freopen("/dev/null", "r", stdin)) ? -1 : 0;
+  }
+  if (NULL == (p_file = fopen(g_prompt_answer_path, "w"))) {
+    return -1;
+  }
+  fputs(answer, p_file);
+  fclose(p_file);
+  return (NULL == freopen(g_prompt_answer_path, "r", stdin)) ? -1 : 0;
+}
+
+/**
+  Run a CLI command in-process with its console output discarded
+
+  @retval the CLI return code
+**/
+static int run_cli_quiet(char *argv[], const char *prompt_answer)
+{
+  int rc = 0;
+
+  set_prompt_answer(prompt_answer);
+  fflush(stdout);
+  dup2(g_null_fd, STDOUT_FILENO);
+  rc = nvm_run_cli(get_argc(argv), argv);
+  fflush(stdout);
+  dup2(g_saved_stdout, STDOUT_FILENO);
+  return rc;
+}
+
+/**
+  Run a benchmarked command once and accumulate its statistics
+**/
+static void run_bench_cmd(BENCH_CMD *p_cmd, BENCH_STATS *p_stats)
+{
+  struct nvm_usage_counters counters;
+  double start_ms = 0;
+  double wall_ms = 0;
+  long peak_rss_kb = 0;
+  int rc = 0;
+
+  nvm_reset_usage_counters();
+  start_ms = get_time_ms();
+  rc = run_cli_quiet(p_cmd->argv, p_cmd->prompt_answer);
+  wall_ms = get_time_ms() - start_ms;
+  nvm_get_usage_counters(&counters);
+  peak_rss_kb = get_peak_rss_kb();
+
+  if (p_stats->runs == 0 || wall_ms < p_stats->wall_ms_min) {
+    p_stats->wall_ms_min = wall_ms;
+  }
+  if (wall_ms > p_stats->wall_ms_max) {
+    p_stats->wall_ms_max = wall_ms;
+  }
+  if (peak_rss_kb > p_stats->peak_rss_kb) {
+    p_stats->peak_rss_kb = peak_rss_kb;
+  }
+  p_stats->wall_ms_total += wall_ms;
+  p_stats->allocations += counters.allocations;
+  p_stats->allocated_bytes += counters.allocated_bytes;
+  p_stats->fw_commands += counters.fw_commands;
+  p_stats->runs++;
+  if (rc != 0) {
+    p_stats->failures++;
+  }
+  unlink(g_support_path);
+}
+
+/**
+  Print the statistics of every benchmarked command of a session
+**/
+static void print_report(const char *session, BENCH_STATS *p_stats)
+{
+  unsigned int index = 0;
+
+  fprintf(g_report, "Session: %s\n", session);
+  fprintf(g_report, "%-24s %5s %5s %10s %10s %10s %12s %14s %10s %12s\n",
+    "Command", "Runs", "Fails", "Min(ms)", "Avg(ms)", "Max(ms)", "Allocs", "AllocBytes", "FwCmds", "ProcRSS(KiB)");
+  for (index = 0; index < BENCH_CMD_COUNT; index++) {
+    if (p_stats[index].runs == 0) {
+      continue;
+    }
+    fprintf(g_report, "%-24s %5u %5u %10.3f %10.3f %10.3f %12llu %14llu %10llu %12ld\n",
+      g_bench_cmds[index].name,
+      p_stats[index].runs,
+      p_stats[index].failures,
+      p_stats[index].wall_ms_min,
+      p_stats[index].wall_ms_total / p_stats[index].runs,
+      p_stats[index].wall_ms_max,
+      p_stats[index].allocations / p_stats[index].runs,
+      p_stats[index].allocated_bytes / p_stats[index].runs,
+      p_stats[index].fw_commands / p_stats[index].runs,
+      p_stats[index].peak_rss_kb);
+  }
+  fprintf(g_report, "ProcRSS is the peak resident set size of the process up to the last run of the command.\n\n");
+  fflush(g_report);
+}
+
+/**
+  Record the benchmarked commands into a new session file
+
+  @retval 0 on success
+**/
+static int record_session(char *session)
+{
+  char *start_argv[] = {"ipmctl", "start", "-session", "-mode", "record", "-f", NULL};
+  char *dump_argv[] = {"ipmctl", "dump", "-destination", session, "-session", NULL};
+  char *stop_argv[] = {"ipmctl", "stop", "-session", "-f", NULL};
+  unsigned int index = 0;
+  int rc = 0;
+
+  if (0 != (rc = run_cli_quiet(start_argv, NULL))) {
+    fprintf(g_report, "Failed to start a recording session: %d\n", rc);
+    return rc;
+  }
+  for (index = 0; index < BENCH_CMD_COUNT; index++) {
+    if (0 != (rc = run_cli_quiet(g_bench_cmds[index].argv, g_bench_cmds[index].prompt_answer))) {
+      fprintf(g_report, "Warning: '%s' returned %d while recording\n", g_bench_cmds[index].name, rc);
+    }
+    unlink(g_support_path);
+  }
+  if (0 != (rc = run_cli_quiet(dump_argv, NULL))) {
+    fprintf(g_report, "Failed to dump the recording session to %s: %d\n", session, rc);
+  }
+  run_cli_quiet(stop_argv, NULL);
+  return rc;
+}
+
+/**
+  Replay a session file a number of times and report the statistics
+
+  @retval 0 on success
+**/
+static int replay_session(char *session, unsigned int iterations, char *order)
+{
+  char *load_argv[] = {"ipmctl", "load", "-source", session, "-session", NULL};
+  char *start_argv[] = {"ipmctl", "start", "-session", "-mode", "playback_manual", "-order", order, "-tag", "0", "-f", NULL};
+  char *stop_argv[] = {"ipmctl", "stop", "-session", "-f", NULL};
+  BENCH_STATS stats[BENCH_CMD_COUNT];
+  unsigned int iteration = 0;
+  unsigned int index = 0;
+  int rc = 0;
+
+  memset(stats, 0, sizeof(stats));
+  run_cli_quiet(stop_argv, NULL);
+
+  if (0 != (rc = run_cli_quiet(load_argv, NULL))) {
+    fprintf(g_report, "Failed to load session %s: %d\n", session, rc);
+    return rc;
+  }
+  for (iteration = 0; iteration < iterations; iteration++) {
+    //manual playback does not replay the whole buffer on start, it only
+    //rewinds to the first tag so the commands below get the recorded responses
+    if (0 != (rc = run_cli_quiet(start_argv, NULL))) {
+      fprintf(g_report, "Failed to start playback of session %s: %d\n", session, rc);
+      break;
+    }
+    for (index = 0; index < BENCH_CMD_COUNT; index++) {
+      run_bench_cmd(&g_bench_cmds[index], &stats[index]);
+    }
+  }
+  run_cli_quiet(stop_argv, NULL);
+  if (0 != rc) {
+    return rc;
+  }
+
+  print_report(session, stats);
+  return 0;
+}
+
+/**
+  Add one iteration of a startup phase to its statistics
+**/
+static void add_startup_sample(STARTUP_STATS *p_stats, unsigned int iteration, double ms, unsigned long long runs)
+{
+  if (iteration == 0 || ms < p_stats->ms_min) {
+    p_stats->ms_min = ms;
+  }
+  if (ms > p_stats->ms_max) {
+    p_stats->ms_max = ms;
+  }
+  p_stats->ms_total += ms;
+  p_stats->runs += runs;
+}
+
+/**
+  Bring the library up and down a number of times and report the startup phases
+
+  @retval 0 on success
+**/
+static int bench_startup(char *session, unsigned int iterations, int csv)
+{
+  char *load_argv[] = {"ipmctl", "load", "-source", session, "-session", NULL};
+  char *start_argv[] = {"ipmctl", "start", "-session", "-mode", "playback_manual", "-order", "keyed", "-tag", "0", "-f", NULL};
+  char *stop_argv[] = {"ipmctl", "stop", "-session", "-f", NULL};
+  STARTUP_STATS stats[STARTUP_ROW_COUNT];
+  struct nvm_startup_profile profile;
+  struct region *p_regions = NULL;
+  NVM_UINT8 region_count = 0;
+  double start_ms = 0;
+  double init_ms = 0;
+  double first_use_ms = 0;
+  unsigned int iteration = 0;
+  unsigned int index = 0;
+  int rc = 0;
+
+  memset(stats, 0, sizeof(stats));
+  if (NULL != session) {
+    run_cli_quiet(stop_argv, NULL);
+    if (0 != (rc = run_cli_quiet(load_argv, NULL))) {
+      fprintf(g_report, "Failed to load session %s: %d\n", session, rc);
+      return rc;
+    }
+  }
+
+  if (csv) {
+    fprintf(g_report, "Iteration,Init(ms),FirstUse(ms),Dimms");
+    for (index = 0; index < STARTUP_PHASE_COUNT; index++) {
+      fprintf(g_report, ",%s(ms),%s(runs)", g_startup_phase_names[index], g_startup_phase_names[index]);
+    }
+    fprintf(g_report, "\n");
+  }
+
+  for (iteration = 0; iteration < iterations && 0 == rc; iteration++) {
+    //every iteration starts over from the first tag, where the recorded startup is
+    if (NULL != session && 0 != (rc = run_cli_quiet(start_argv, NULL))) {
+      fprintf(g_report, "Failed to start playback of session %s: %d\n", session, rc);
+      break;
+    }
+    nvm_reset_startup_profile();
+    start_ms = get_time_ms();
+    rc = nvm_init();
+    init_ms = get_time_ms() - start_ms;
+    if (0 != rc) {
+      fprintf(g_report, "nvm_init failed: %d\n", rc);
+      break;
+    }
+
+    start_ms = get_time_ms();
+    if (0 == nvm_get_number_of_regions(&region_count) && 0 < region_count &&
+        NULL != (p_regions = calloc(region_count, sizeof(*p_regions)))) {
+      nvm_get_regions(p_regions, &region_count);
+      free(p_regions);
+      p_regions = NULL;
+    }
+    first_use_ms = get_time_ms() - start_ms;
+
+    nvm_get_startup_profile(&profile);
+    nvm_uninit();
+
+    add_startup_sample(&stats[STARTUP_INIT_ROW], iteration, init_ms, 1);
+    add_startup_sample(&stats[STARTUP_FIRST_USE_ROW], iteration, first_use_ms, 1);
+    for (index = 0; index < STARTUP_PHASE_COUNT; index++) {
+      add_startup_sample(&stats[index], iteration, profile.phases[index].time_us / 1000.0, profile.phases[index].runs);
+    }
+
+    if (csv) {
+      fprintf(g_report, "%u,%.3f,%.3f,%u", iteration, init_ms, first_use_ms, profile.dimm_count);
+      for (index = 0; index < STARTUP_PHASE_COUNT; index++) {
+        fprintf(g_report, ",%.3f,%u", profile.phases[index].time_us / 1000.0, profile.phases[index].runs);
+      }
+      fprintf(g_report, "\n");
+    }
+  }
+
+  if (NULL != session) {
+    run_cli_quiet(stop_argv, NULL);
+  }
+  if (csv || 0 == iteration) {
+    fflush(g_report);
+    return rc;
+  }
+
+  fprintf(g_report, "Startup: %s, %u PMem modules\n", (NULL != session) ? session : "no session", profile.dimm_count);
+  fprintf(g_report, "%-14s %10s %10s %10s %10s\n", "Phase", "Runs", "Min(ms)", "Avg(ms)", "Max(ms)");
+  for (index = 0; index < STARTUP_ROW_COUNT; index++) {
+    if (0 == stats[index].runs) {
+      continue;
+    }
+    fprintf(g_report, "%-14s %10.1f %10.3f %10.3f %10.3f\n",
+      (STARTUP_INIT_ROW == index) ? "nvm_init" : (STARTUP_FIRST_USE_ROW == index) ? "FirstUse" : g_startup_phase_names[index],
+      (double)stats[index].runs / iteration,
+      stats[index].ms_min,
+      stats[index].ms_total / iteration,
+      stats[index].ms_max);
+  }
+  fprintf(g_report, "\n");
+  fflush(g_report);
+  return rc;
+}
+
+/**
+  Print usage
+**/
+static void print_help(void)
+{
+  fprintf(g_report, "Usage:\n");
+  fprintf(g_report, "  ipmctl_bench [-n <iterations>] [-order sequential|keyed] <session.pbr> [<session.pbr> ...]\n");
+  fprintf(g_report, "  ipmctl_bench -record <session.pbr>\n");
+  fprintf(g_report, "  ipmctl_bench -startup [-n <iterations>] [-csv] [<session.pbr>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int iterations = DEFAULT_ITERATIONS;
+  char *order = "keyed";
+  char *record_path = NULL;
+  char *session = NULL;
+  int startup = 0;
+  int csv = 0;
+  int sessions = 0;
+  int index = 0;
+  int rc = 0;
+
+  //the CLI writes wide characters to stdout, keep the report on its own stream
+  g_saved_stdout = dup(STDOUT_FILENO);
+  g_null_fd = open("/dev/null", O_WRONLY);
+  if (g_saved_stdout < 0 || g_null_fd < 0 || NULL == (g_report = fdopen(dup(g_saved_stdout), "w"))) {
+    fprintf(stderr, "Failed to set up output redirection.\n");
+    return 1;
+  }
+
+  for (index = 1; index < argc; index++) {
+    if (0 == strcmp(argv[index], "-n") && index + 1 < argc) {
+      iterations = (unsigned int)strtoul(argv[++index], NULL, 10);
+    }
+    else if (0 == strcmp(argv[index], "-order") && index + 1 < argc) {
+      order = argv[++index];
+    }
+    else if (0 == strcmp(argv[index], "-record") && index + 1 < argc) {
+      record_path = argv[++index];
+    }
+    else if (0 == strcmp(argv[index], "-startup")) {
+      startup = 1;
+    }
+    else if (0 == strcmp(argv[index], "-csv")) {
+      csv = 1;
+    }
+    else if (argv[index][0] == '-') {
+      print_help();
+      return 1;
+    }
+    else {
+      session = argv[index];
+      sessions++;
+    }
+  }
+
+  if (NULL == mkdtemp(g_work_dir)) {
+    fprintf(stderr, "Failed to create a work directory.\n");
+    return 1;
+  }
+  snprintf(g_support_prefix, sizeof(g_support_prefix), "%s/%s", g_work_dir, SUPPORT_FILE_PREFIX);
+  snprintf(g_support_path, sizeof(g_support_path), "%s%s", g_support_prefix, SUPPORT_FILE_SUFFIX);
+  snprintf(g_prompt_answer_path, sizeof(g_prompt_answer_path), "%s/%s", g_work_dir, PROMPT_ANSWER_FILE_NAME);
+
+  if (NULL != record_path) {
+    rc = record_session(record_path);
+  }
+  else if (startup) {
+    if (sessions > 1 || iterations == 0) {
+      print_help();
+      rc = 1;
+    }
+    else {
+      rc = bench_startup(session, iterations, csv);
+    }
+  }
+  else if (sessions == 0 || iterations == 0) {
+    print_help();
+    rc = 1;
+  }
+  else {
+    for (index = 1; index < argc; index++) {
+      if (0 == strcmp(argv[index], "-n") || 0 == strcmp(argv[index], "-order")) {
+        index++;
+        continue;
+      }
+      if (0 == strcmp(argv[index], "-csv")) {
+        continue;
+      }
+      if (0 != replay_session(argv[index], iterations, order)) {
+        rc = 1;
+      }
+    }
+  }
+
+  unlink(g_prompt_answer_path);
+  unlink(g_support_path);
+  rmdir(g_work_dir);
+  fclose(g_report);
+  close(g_null_fd);
+  close(g_saved_stdout);
+  return rc;
+}
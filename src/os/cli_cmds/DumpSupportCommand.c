@@ -50,9 +50,10 @@ typedef struct _DUMP_SUPPORT_CMD
 #define MAX_DIMM_SPECIFIC_CMDS 5
 #define APPEND_TO_FILE_NAME L"platform_support_info"
 #define PLATFORM_INFO_STR L"Platform information"
-#define DIMM_SPECIFIC_INFO L"Dimm Specific information - UUID: "
-#define WITH_DIC_OPTION  DICTIONARY_OPTION SPACE_FORMAT_STR_SPACE DEBUG_TARGET L" " DIMM_TARGET SPACE_FORMAT_HEX
-#define WITHOUT_DICT_OPTION DEBUG_TARGET L" " DIMM_TARGET SPACE_FORMAT_HEX
+#define DIMM_SPECIFIC_INFO L"Dimm Specific information"
+#define DIMM_UID_INFO L"UUID: " FORMAT_STR L" - DimmHandle: 0x%04x\n"
+#define WITH_DIC_OPTION  DICTIONARY_OPTION SPACE_FORMAT_STR_SPACE DEBUG_TARGET L" " DIMM_TARGET L" " FORMAT_STR
+#define WITHOUT_DICT_OPTION DEBUG_TARGET L" " DIMM_TARGET L" " FORMAT_STR
 #define STR_DUMP_DEST L"dump -destination %ls "
 
 DUMP_SUPPORT_CMD DumpPlatformLevelCmds[MAX_PLAFORM_SUPPORT_CMDS] = {
@@ -64,12 +65,17 @@ DUMP_SUPPORT_CMD DumpPlatformLevelCmds[MAX_PLAFORM_SUPPORT_CMDS] = {
 {L"show -system"},
 };
 
+/*
+* Each command is run once for the whole list of PMem modules, so the
+* inventory is read once per command and dump -debug fetches the logs of
+* all PMem modules concurrently
+*/
 DUMP_SUPPORT_CMD DumpCmdsPerDimm[MAX_DIMM_SPECIFIC_CMDS] = {
-  {L"show -a -dimm 0x%04x"},
-  {L"show -a -sensor -dimm 0x%04x"},
-  {L"show -pcd -dimm 0x%04x"},
-  {L"show -error Media -dimm 0x%04x"},
-  {L"show -error Thermal -dimm 0x%04x"},
+  {L"show -a -dimm %ls"},
+  {L"show -a -sensor -dimm %ls"},
+  {L"show -pcd -dimm %ls"},
+  {L"show -error Media -dimm %ls"},
+  {L"show -error Thermal -dimm %ls"},
 };
 
 #define NEW_DUMP_ENTRY_HEADER L"/*\n* %ls\n*/\n"
@@ -134,11 +140,11 @@ DumpSupportCommand(
   COMMAND_STATUS *pCommandStatus = NULL;
   CHAR16 *pDumpUserPath = NULL;
   CHAR16 *pPlatformSupportFileName = NULL;
-  CHAR16 *pPrintDIMMHeaderInfo = NULL;
+  CHAR16 *pDimmHandles = NULL;
   UINT32 Index = 0;
   UINT32 DimmIndex = 0;
 
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT32 DimmCount = 0;
   CHAR8 *pPlatformSupportFilenameAscii = NULL;
   UINTN pPlatformSupportFilenameAsciiLength = 0;
@@ -165,7 +171,7 @@ DumpSupportCommand(
     goto Finish;
   }
 
-  ReturnCode = GetDimmList(pNvmDimmConfigProtocol, pCmd, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  ReturnCode = GetDimmCoreList(pNvmDimmConfigProtocol, pCmd, &pDimms, &DimmCount);
   if (EFI_ERROR(ReturnCode)) {
     if(ReturnCode == EFI_NOT_FOUND) {
         PRINTER_SET_MSG(pCmd->pPrintCtx, ReturnCode, CLI_INFO_NO_FUNCTIONAL_DIMMS);
@@ -221,6 +227,18 @@ DumpSupportCommand(
   {
     goto Finish;
   }
+
+  /* -dimm list shared by the PMem module specific commands */
+  for (DimmIndex = 0; DimmIndex < DimmCount; ++DimmIndex) {
+    pDimmHandles = CatSPrintClean(pDimmHandles, (0 == DimmIndex) ? L"0x%04x" : L",0x%04x",
+      pDimms[DimmIndex].DimmHandle);
+    if (NULL == pDimmHandles) {
+      ReturnCode = EFI_OUT_OF_RESOURCES;
+      PRINTER_SET_MSG(pPrinterCtx, ReturnCode, CLI_ERR_OUT_OF_MEMORY);
+      goto Finish;
+    }
+  }
+
   if(NULL == (hFile = fopen(pPlatformSupportFilenameAscii, "w+")))
   {
     ReturnCode = EFI_OUT_OF_RESOURCES;
@@ -233,25 +251,28 @@ DumpSupportCommand(
 	PrintAndExecuteCommand(DumpPlatformLevelCmds[Index].cmd);
   }
 
+  PrintHeaderInfo(DIMM_SPECIFIC_INFO);
   for (DimmIndex = 0; DimmIndex < DimmCount; ++DimmIndex) {
-    pPrintDIMMHeaderInfo = CatSPrint(NULL, DIMM_SPECIFIC_INFO FORMAT_STR, pDimms[DimmIndex].DimmUid);
-    PrintHeaderInfo(pPrintDIMMHeaderInfo);
-    FREE_POOL_SAFE(pPrintDIMMHeaderInfo);
+    Print(DIMM_UID_INFO, pDimms[DimmIndex].DimmUid, pDimms[DimmIndex].DimmHandle);
+  }
+
+  if (NULL != pDimmHandles) {
     for (Index = 0; Index < MAX_DIMM_SPECIFIC_CMDS; ++Index) {
-      pCmdInputWithDimmId = CatSPrint(NULL, DumpCmdsPerDimm[Index].cmd, pDimms[DimmIndex].DimmHandle);
+      pCmdInputWithDimmId = CatSPrint(NULL, DumpCmdsPerDimm[Index].cmd, pDimmHandles);
       PrintAndExecuteCommand(pCmdInputWithDimmId);
+      FREE_POOL_SAFE(pCmdInputWithDimmId);
     }
+    pCmdInputWithDimmId = CatSPrintClean(NULL, STR_DUMP_DEST, pDumpUserPath);
     if (pDictUserPath != NULL) {
-      pCmdInputWithDimmId = CatSPrintClean(NULL, STR_DUMP_DEST, pDumpUserPath);
-      pCmdInputWithDimmId = CatSPrintClean(pCmdInputWithDimmId, WITH_DIC_OPTION, pDictUserPath, pDimms[DimmIndex].DimmHandle);
+      pCmdInputWithDimmId = CatSPrintClean(pCmdInputWithDimmId, WITH_DIC_OPTION, pDictUserPath, pDimmHandles);
     } else {
-      pCmdInputWithDimmId = CatSPrintClean(NULL, STR_DUMP_DEST, pDumpUserPath);
-      pCmdInputWithDimmId = CatSPrintClean(pCmdInputWithDimmId, WITHOUT_DICT_OPTION, pDimms[DimmIndex].DimmHandle);
+      pCmdInputWithDimmId = CatSPrintClean(pCmdInputWithDimmId, WITHOUT_DICT_OPTION, pDimmHandles);
     }
     PrintAndExecuteCommand(pCmdInputWithDimmId);
     FREE_POOL_SAFE(pCmdInputWithDimmId);
-  } //end for dimmIndex
+  }
 
+  PrintFlush();
   fclose(gOsShellParametersProtocol.StdOut);
   gOsShellParametersProtocol.StdOut = stdout;
 
@@ -264,6 +285,8 @@ Finish:
   FREE_POOL_SAFE(pPlatformSupportFilenameAscii);
   FREE_POOL_SAFE(pDumpUserPath);
   FREE_POOL_SAFE(pDictUserPath);
+  FREE_POOL_SAFE(pDimmHandles);
+  FREE_POOL_SAFE(pDimms);
   NVDIMM_EXIT_I64(ReturnCode);
   return ReturnCode;
 }
@@ -38,6 +38,8 @@ EFI_SYSTEM_TABLE *gST;
 EFI_SHELL_INTERFACE *mEfiShellInterface;
 EFI_RUNTIME_SERVICES *gRT;
 EFI_HANDLE gImageHandle;
+OS_USAGE_COUNTERS gOsUsageCounters;
+BOOLEAN gOsUsageCountersEnabled = FALSE;
 
 #define CLI_VERSION_MAX 25
 #define FILE_DESCRIPTION_MAX 1024
@@ -333,14 +335,47 @@ HiiGetString(
   IN CONST CHAR8     *Language  OPTIONAL
 )
 {
-  UINTN str_size = StrSize(gHiiStrings[StringId]);
-  CHAR16 * str = (CHAR16*)AllocatePool(str_size);
+  CONST CHAR16 *pConstStr = HiiGetStringConst(HiiHandle, StringId);
+  UINTN str_size = 0;
+  CHAR16 * str = NULL;
+
+  if (NULL == pConstStr) {
+    return NULL;
+  }
+  str_size = StrSize(pConstStr);
+  str = (CHAR16*)AllocatePool(str_size);
   if (NULL != str) {
-    CopyMem_S(str, str_size, gHiiStrings[StringId], str_size);
+    CopyMem_S(str, str_size, pConstStr, str_size);
   }
   return str;
 }
 
+/**
+Borrow a string of the string table without copying it.
+
+The OS build has a single static string table generated from the .uni files
+(os_efi_hii_auto_gen_strings.py) and indexed by the STRING_TOKEN ids, so the
+HII handle is not used. The returned string must not be freed or modified.
+
+@param[in]  HiiHandle  A handle that was previously registered in the HII Database.
+@param[in]  StringId   The identifier of the string to borrow.
+
+@retval NULL   StringId is out of range
+@retval Other  The string was returned.
+**/
+CONST CHAR16 *
+EFIAPI
+HiiGetStringConst(
+  IN EFI_HII_HANDLE  HiiHandle,
+  IN EFI_STRING_ID   StringId
+)
+{
+  if (StringId >= STR_DCPMM_MAX_STRING_ID) {
+    return NULL;
+  }
+  return gHiiStrings[StringId];
+}
+
 /**
 Tests whether a controller handle is being managed by a specific driver.
 
@@ -499,6 +534,8 @@ AllocatePool(
   IN UINTN  AllocationSize
 )
 {
+  OS_USAGE_COUNT(Allocations, 1);
+  OS_USAGE_COUNT(AllocatedBytes, AllocationSize);
   return malloc((size_t)AllocationSize);
 }
 
@@ -521,6 +558,8 @@ AllocateZeroPool(
   IN UINTN  AllocationSize
 )
 {
+  OS_USAGE_COUNT(Allocations, 1);
+  OS_USAGE_COUNT(AllocatedBytes, AllocationSize);
   return calloc((size_t)AllocationSize, 1);
 }
 
@@ -548,7 +587,10 @@ AllocateCopyPool(
   IN CONST VOID  *Buffer
 )
 {
-  void * ptr = calloc((size_t)AllocationSize, 1);
+  void * ptr = NULL;
+  OS_USAGE_COUNT(Allocations, 1);
+  OS_USAGE_COUNT(AllocatedBytes, AllocationSize);
+  ptr = calloc((size_t)AllocationSize, 1);
   if (NULL != ptr) {
     os_memcpy(ptr, AllocationSize, Buffer, AllocationSize);
   }
@@ -584,6 +626,8 @@ ReallocatePool(
   IN VOID   *OldBuffer  OPTIONAL
 )
 {
+  OS_USAGE_COUNT(Allocations, 1);
+  OS_USAGE_COUNT(AllocatedBytes, NewSize);
   return realloc(OldBuffer, (size_t)NewSize);
 }
 
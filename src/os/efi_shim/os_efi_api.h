@@ -45,6 +45,30 @@ typedef struct _pass_thru_record_resp
   UINT8 Output[];
 }pass_thru_record_resp;
 
+/**
+  Counters of the work done by the shim since the last reset, used to benchmark commands.
+  Counters are updated atomically with OS_USAGE_COUNT(), as library callers run concurrently,
+  and only once gOsUsageCountersEnabled is set, processes that never read them skip the updates.
+**/
+typedef struct _OS_USAGE_COUNTERS {
+  UINT64 Allocations;                                         //!< Number of pool allocations
+  UINT64 AllocatedBytes;                                      //!< Bytes requested by pool allocations
+  UINT64 FwCommands;                                          //!< Number of FW passthru commands issued or played back
+} OS_USAGE_COUNTERS;
+
+extern OS_USAGE_COUNTERS gOsUsageCounters;
+extern BOOLEAN gOsUsageCountersEnabled;
+
+#define OS_USAGE_COUNT(Field, Add) \
+  do { \
+    if (gOsUsageCountersEnabled) { \
+      os_atomic_add64((volatile unsigned long long *)&gOsUsageCounters.Field, (unsigned long long)(Add)); \
+    } \
+  } while (0)
+
+#define OS_USAGE_READ(Field) \
+  os_atomic_add64((volatile unsigned long long *)&gOsUsageCounters.Field, 0)
+
 EFI_STATUS ConvertAsciiStrToUnicode(const CHAR8 * AsciiStr, CHAR16 * UnicodeStr, UINTN UnicodeStrMaxLength);
 
 /**
@@ -28,6 +28,7 @@
 #ifdef OS_BUILD
 #include <os_efi_preferences.h>
 #include <os_str.h>
+#include <os.h>
 #endif
 
 extern NVMDIMMDRIVER_DATA *gNvmDimmData;
@@ -196,6 +197,151 @@ Finish:
 
 extern EFI_SHELL_PARAMETERS_PROTOCOL gOsShellParametersProtocol;
 
+#define OUTPUT_BUFFER_SIZE      (64 * 1024)         //!< Bytes of UTF-8 console output held before they are written
+#define OUTPUT_FORMAT_MAX       MAX_STRING_LENGTH   //!< Longest Print() result formatted into the scratch buffer
+#define UTF8_REPLACEMENT_CHAR   0xFFFD              //!< Written in place of characters that can't be encoded
+
+#ifdef _MSC_VER
+#define OUTPUT_LOCK()           _lock_file(stdout)
+#define OUTPUT_UNLOCK()         _unlock_file(stdout)
+#define OUTPUT_WRITE(Stream, Buffer, Size) _write(_fileno(Stream), Buffer, (unsigned int)(Size))
+#else
+#define OUTPUT_LOCK()           flockfile(stdout)
+#define OUTPUT_UNLOCK()         funlockfile(stdout)
+#define OUTPUT_WRITE(Stream, Buffer, Size) write(fileno(Stream), Buffer, Size)
+#endif
+
+/**
+  Console output held as UTF-8 until a command completes, the buffer fills up
+  or input is read, so printing costs neither a syscall nor a locale conversion
+  per Print() call.  Access is serialized by the stdio lock of stdout.
+**/
+typedef struct _OUTPUT_BUFFER {
+  FILE *pStream;                                  //!< Stream the buffered bytes are destined for
+  size_t Len;                                     //!< Bytes buffered
+  BOOLEAN AtExitRegistered;                       //!< Flush registered to run at exit
+  char Buf[OUTPUT_BUFFER_SIZE];                   //!< UTF-8 encoded output
+  wchar_t FormatBuf[OUTPUT_FORMAT_MAX];           //!< Scratch buffer Print() formats into
+} OUTPUT_BUFFER;
+
+static OUTPUT_BUFFER gOutput;
+
+/**
+  Write the buffered output to its stream. The caller holds the output lock.
+**/
+static VOID
+FlushOutputLocked(
+)
+{
+  size_t Written = 0;
+  int Rc = 0;
+
+  if (0 == gOutput.Len || NULL == gOutput.pStream) {
+    gOutput.Len = 0;
+    return;
+  }
+
+  //keep the order with whatever was written to the stream through stdio
+  fflush(gOutput.pStream);
+  while (Written < gOutput.Len) {
+    Rc = (int)OUTPUT_WRITE(gOutput.pStream, gOutput.Buf + Written, gOutput.Len - Written);
+    if (Rc <= 0) {
+      break;
+    }
+    Written += Rc;
+  }
+  gOutput.Len = 0;
+}
+
+/**
+  Write the buffered console output out.
+
+  Called at command boundaries and before input is read, and must be called
+  before the stream Print() writes to is closed.
+**/
+VOID
+EFIAPI
+PrintFlush(
+)
+{
+  OUTPUT_LOCK();
+  FlushOutputLocked();
+  OUTPUT_UNLOCK();
+}
+
+/**
+  Prepare the buffer for output to the current console stream. The caller holds the output lock.
+
+  @param[in] Size Number of bytes about to be appended
+**/
+static VOID
+ReserveOutputLocked(
+  IN     size_t Size
+)
+{
+  FILE *pStream = (NULL != gOsShellParametersProtocol.StdOut) ? gOsShellParametersProtocol.StdOut : stdout;
+
+  if (pStream != gOutput.pStream) {
+    FlushOutputLocked();
+    gOutput.pStream = pStream;
+  }
+  if (!gOutput.AtExitRegistered) {
+    gOutput.AtExitRegistered = TRUE;
+    atexit(PrintFlush);
+  }
+  if (gOutput.Len + Size > OUTPUT_BUFFER_SIZE) {
+    FlushOutputLocked();
+  }
+}
+
+/**
+  Append a wide string to the buffer as UTF-8. The caller holds the output lock.
+
+  @param[in] pStr Characters to append
+  @param[in] Count Number of characters in pStr
+**/
+static VOID
+AppendWideOutputLocked(
+  IN     CONST wchar_t *pStr,
+  IN     size_t Count
+)
+{
+  size_t Index = 0;
+  UINT32 CodePoint = 0;
+
+  for (Index = 0; Index < Count; ++Index) {
+    CodePoint = (UINT32)pStr[Index];
+    //combine UTF-16 surrogate pairs, lone surrogates can't be encoded
+    if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && Index + 1 < Count &&
+      (UINT32)pStr[Index + 1] >= 0xDC00 && (UINT32)pStr[Index + 1] <= 0xDFFF) {
+      CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + ((UINT32)pStr[++Index] - 0xDC00);
+    }
+    else if ((CodePoint >= 0xD800 && CodePoint <= 0xDFFF) || CodePoint > 0x10FFFF) {
+      CodePoint = UTF8_REPLACEMENT_CHAR;
+    }
+
+    ReserveOutputLocked(4);
+    if (CodePoint < 0x80) {
+      gOutput.Buf[gOutput.Len++] = (char)CodePoint;
+    }
+    else if (CodePoint < 0x800) {
+      gOutput.Buf[gOutput.Len++] = (char)(0xC0 | (CodePoint >> 6));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | (CodePoint & 0x3F));
+    }
+    else if (CodePoint < 0x10000) {
+      gOutput.Buf[gOutput.Len++] = (char)(0xE0 | (CodePoint >> 12));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | ((CodePoint >> 6) & 0x3F));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | (CodePoint & 0x3F));
+    }
+    else {
+      gOutput.Buf[gOutput.Len++] = (char)(0xF0 | (CodePoint >> 18));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | ((CodePoint >> 12) & 0x3F));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | ((CodePoint >> 6) & 0x3F));
+      gOutput.Buf[gOutput.Len++] = (char)(0x80 | (CodePoint & 0x3F));
+    }
+  }
+}
+
 /**
 Prints a formatted Unicode string to the console output device specified by
 ConOut defined in the EFI_SYSTEM_TABLE.
@@ -209,6 +355,8 @@ If Format is NULL, then ASSERT().
 If Format is not aligned on a 16-bit boundary, then ASSERT().
 If gST->ConOut is NULL, then ASSERT().
 
+The output is encoded as UTF-8 into the console output buffer, see PrintFlush().
+
 @param Format   A null-terminated Unicode format string.
 @param ...      The variable argument list whose contents are accessed based
 on the format string specified by Format.
@@ -224,11 +372,44 @@ Print(
 )
 {
   va_list argptr;
+  va_list argcopy;
+  int Count = 0;
+  size_t LongLen = OUTPUT_FORMAT_MAX;
+  wchar_t *pLongBuf = NULL;
+
+  OUTPUT_LOCK();
   va_start(argptr, Format);
-  vfwprintf(gOsShellParametersProtocol.StdOut, Format, argptr);
+  va_copy(argcopy, argptr);
+  Count = os_vswprintf(gOutput.FormatBuf, OUTPUT_FORMAT_MAX, Format, argcopy);
+  va_end(argcopy);
+  if (Count >= 0 && Count < OUTPUT_FORMAT_MAX) {
+    AppendWideOutputLocked(gOutput.FormatBuf, (size_t)Count);
+  }
+  else {
+    //too long for the scratch buffer, format it on the heap
+#ifdef _MSC_VER
+    va_copy(argcopy, argptr);
+    Count = _vscwprintf(Format, argcopy);
+    va_end(argcopy);
+    LongLen = (Count >= 0) ? (size_t)Count + 1 : 0;
+#endif
+    for (Count = -1; Count < 0 && LongLen > 0 && LongLen <= MAX_UINT32; LongLen *= 2) {
+      FREE_POOL_SAFE(pLongBuf);
+      if (NULL == (pLongBuf = AllocatePool(LongLen * sizeof(wchar_t)))) {
+        break;
+      }
+      va_copy(argcopy, argptr);
+      Count = os_vswprintf(pLongBuf, LongLen, Format, argcopy);
+      va_end(argcopy);
+    }
+    if (Count > 0) {
+      AppendWideOutputLocked(pLongBuf, (size_t)Count);
+    }
+    FREE_POOL_SAFE(pLongBuf);
+  }
   va_end(argptr);
-  fflush(gOsShellParametersProtocol.StdOut);
-  return 0;
+  OUTPUT_UNLOCK();
+  return (Count > 0) ? (UINTN)Count : 0;
 }
 
 UINTN
@@ -236,6 +417,7 @@ EFIAPI
 PrintNoBuffer(CHAR16* Format, ...)
 {
   va_list argptr;
+  PrintFlush();
   va_start(argptr, Format);
   vfwprintf(stdout, Format, argptr);
   va_end(argptr);
@@ -243,6 +425,43 @@ PrintNoBuffer(CHAR16* Format, ...)
   return 0;
 }
 
+/**
+Appends UTF-8 encoded bytes to the console output buffer as they are.
+
+@param Buffer   UTF-8 encoded bytes, not necessarily null-terminated.
+@param Size     Number of bytes in Buffer.
+
+@return Number of bytes appended.
+**/
+UINTN
+EFIAPI
+PrintUtf8(
+  IN CONST CHAR8 *Buffer,
+  IN UINTN Size
+)
+{
+  UINTN Appended = 0;
+  size_t Chunk = 0;
+
+  if (NULL == Buffer) {
+    return 0;
+  }
+
+  OUTPUT_LOCK();
+  while (Appended < Size) {
+    ReserveOutputLocked(1);
+    Chunk = OUTPUT_BUFFER_SIZE - gOutput.Len;
+    if (Chunk > Size - Appended) {
+      Chunk = Size - Appended;
+    }
+    CopyMem(gOutput.Buf + gOutput.Len, Buffer + Appended, Chunk);
+    gOutput.Len += Chunk;
+    Appended += Chunk;
+  }
+  OUTPUT_UNLOCK();
+  return Appended;
+}
+
 /**
 Prints a debug message to the debug output device if the specified error level is enabled.
 
@@ -281,6 +500,8 @@ DebugPrint(
     AsciiVSPrint(event_message, size, Format, args);
     VA_END(args);
     write_system_event_to_stdout(NVM_DEBUG_LOGGER_SOURCE, event_message);
+    //exit handlers don't run on an assert
+    PrintFlush();
 #ifdef NDEBUG
     rel_assert ();
 #else // NDEBUG
@@ -340,6 +561,7 @@ PromptedInput(
   }
 
   Print(L"%ls", pPrompt);
+  PrintFlush();
   char buff[MAX_PROMT_INPUT_SZ];
   memset(buff, 0, MAX_PROMT_INPUT_SZ);
 
@@ -438,6 +660,14 @@ Finish:
   return ReturnCode;
 }
 
+static OS_ONCE g_pbr_lock_once = OS_ONCE_INIT;
+static OS_MUTEX *g_pbr_lock;  // the session is shared by all DIMMs
+
+static void pbr_lock_create(void)
+{
+  g_pbr_lock = os_mutex_init(NULL);
+}
+
 EFI_STATUS
 EFIAPI
 DefaultPassThru(
@@ -450,24 +680,40 @@ DefaultPassThru(
   EFI_STATUS PbrRc = EFI_SUCCESS;
   UINT32 DimmID;
   PbrContext *pContext = PBR_CTX();
+  UINT32 PbrMode = PBR_GET_MODE(pContext);
 
   if (!pDimm || !pCmd)
     return EFI_INVALID_PARAMETER;
 
-  if (PBR_PLAYBACK_MODE == PBR_GET_MODE(pContext))
+  OS_USAGE_COUNT(FwCommands, 1);
+
+  DimmID = pCmd->DimmID;
+  pCmd->DimmID = pDimm->DeviceHandle.AsUint32;
+
+  // one command at a time per mailbox, other DIMMs are not held up.
+  // The mailbox lock is always taken before the session lock, callers
+  // such as the PCD readers already hold it around their passthrus.
+  os_mutex_lock(pDimm->pMailboxLock);
+  if (PBR_NORMAL_MODE != PbrMode)
   {
+    os_once(&g_pbr_lock_once, pbr_lock_create);
+    os_mutex_lock(g_pbr_lock);
+  }
+
+  if (PBR_PLAYBACK_MODE == PbrMode)
+  {
+    //requests are recorded against the device handle, keep it for keyed lookups
     Rc = PbrGetPassThruRecord(pContext, pCmd, &PbrRc);
     if (EFI_SUCCESS == Rc) {
       Rc = PbrRc;
     }
-    return Rc;
+  }
+  else
+  {
+    Rc = passthru_os(pDimm, pCmd, (long)Timeout);
   }
 
-  DimmID = pCmd->DimmID;
-  pCmd->DimmID = pDimm->DeviceHandle.AsUint32;
-  Rc = passthru_os(pDimm, pCmd, (long)Timeout);
-
-  if (PBR_RECORD_MODE == PBR_GET_MODE(pContext))
+  if (PBR_RECORD_MODE == PbrMode)
   {
       PbrRc = PbrSetPassThruRecord(pContext, pCmd, Rc);
 
@@ -476,6 +722,12 @@ DefaultPassThru(
         NVDIMM_ERR("PBR failed to record transaction. RC: 0x%x", PbrRc);
       }
   }
+
+  if (PBR_NORMAL_MODE != PbrMode)
+  {
+    os_mutex_unlock(g_pbr_lock);
+  }
+  os_mutex_unlock(pDimm->pMailboxLock);
   pCmd->DimmID = DimmID;
 
   return Rc;
@@ -112,7 +112,7 @@ if __name__ == '__main__':
 	with open(outputStringsFileName, 'w') as file:
 		# Enumerate outputs [i, data[i]] on each iteration, handy when you want to use i
 		file.write('/**\nDO NOT EDIT\nFILE auto-generated from os_efi_hii_auto_gen_strings.py\n**/\n'
-		'#ifndef _AUTO_HII_STRINGS_OS_BUILD\n#define _AUTO_HII_STRINGS_OS_BUILD\n\nCONST CHAR16* gHiiStrings[] = {\n')
+		'#ifndef _AUTO_HII_STRINGS_OS_BUILD\n#define _AUTO_HII_STRINGS_OS_BUILD\n\nSTATIC CONST CHAR16 * CONST gHiiStrings[STR_DCPMM_MAX_STRING_ID] = {\n')
 		for i, key in enumerate(dict.keys()):
 			file.write('L"{0}", // {1} = {2}\n'.format(dict[key], key, i))
 		file.write('};\n\n#endif //// _AUTO_HII_STRINGS_OS_BUILD')
@@ -65,6 +65,14 @@ RecordingDirMode g_rec_file_creation_mode = DefaultMode;
 #define STR_DASH_VERBOSE_LONG   "-verbose"
 #define STR_DASH_VERBOSE_SHORT  "-v"
 #define STR_DASH_FAST_LONG      "-fast"
+#define STR_DASH_FILE_SHORT     "-f"
+#define STR_STDIN_FILE          "-"
+
+#define MAX_BATCH_LINE_LEN      MAX_INPUT_PARAM_LEN
+#define BATCH_COMMENT_CHAR      '#'
+
+static const char *g_batch_file_path = NULL;
+static FILE *g_batch_file = NULL;
 
 
 EFI_STATUS init_protocol_shell_parameters_protocol(int argc, char *argv[])
@@ -111,6 +119,15 @@ EFI_STATUS init_protocol_shell_parameters_protocol(int argc, char *argv[])
       g_fast_path = 1;
       stripped_args = 1;
     }
+    else if (1 == new_argv_index &&
+      0 == s_strncmpi(argv[Index], STR_DASH_FILE_SHORT, strlen(STR_DASH_FILE_SHORT) + 1) &&
+      Index + 1 != argc)
+    {
+      // batch mode, -f in place of the verb, the commands are read from the file
+      gOsShellParametersProtocol.Argc -= 2;
+      g_batch_file_path = argv[++Index];
+      continue;
+    }
     if (0 == s_strncmpi(argv[Index], STR_DASH_VERBOSE_LONG, strlen(STR_DASH_VERBOSE_LONG) + 1)
       || 0 == s_strncmpi(argv[Index], STR_DASH_VERBOSE_SHORT, strlen(STR_DASH_VERBOSE_SHORT) + 1))
     {
@@ -163,4 +180,71 @@ BOOLEAN is_verbose_debug_print_enabled()
 BOOLEAN is_ESX_output_requested()
 {
   return g_ESX_output_requested;
+}
+
+BOOLEAN is_batch_mode_requested()
+{
+  return NULL != g_batch_file_path;
+}
+
+EFI_STATUS batch_input_open()
+{
+  if (NULL == g_batch_file_path) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (0 == strcmp(g_batch_file_path, STR_STDIN_FILE)) {
+    g_batch_file = stdin;
+  }
+  else if (NULL == (g_batch_file = fopen(g_batch_file_path, "r"))) {
+    return EFI_NOT_FOUND;
+  }
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS batch_input_read_line(CHAR16 **pp_line)
+{
+  char line[MAX_BATCH_LINE_LEN];
+  char *p_start = line;
+  size_t len = 0;
+
+  if (NULL == pp_line || NULL == g_batch_file) {
+    return EFI_INVALID_PARAMETER;
+  }
+  *pp_line = NULL;
+
+  if (NULL == fgets(line, sizeof(line), g_batch_file)) {
+    return ferror(g_batch_file) ? EFI_DEVICE_ERROR : EFI_END_OF_FILE;
+  }
+
+  len = strlen(line);
+  if (len > 0 && '\n' != line[len - 1] && !feof(g_batch_file)) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  while (len > 0 && ('\n' == line[len - 1] || '\r' == line[len - 1])) {
+    line[--len] = '\0';
+  }
+
+  // blank lines and comments come back as empty lines, so line numbers stay meaningful
+  while (' ' == *p_start || '\t' == *p_start) {
+    ++p_start;
+  }
+  if (BATCH_COMMENT_CHAR == *p_start) {
+    *p_start = '\0';
+  }
+
+  len = strlen(p_start) + 1;
+  if (NULL == (*pp_line = AllocateZeroPool(len * sizeof(CHAR16)))) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  AsciiStrToUnicodeStrS(p_start, *pp_line, len);
+  return EFI_SUCCESS;
+}
+
+void batch_input_close()
+{
+  if (NULL != g_batch_file && stdin != g_batch_file) {
+    fclose(g_batch_file);
+  }
+  g_batch_file = NULL;
 }
\ No newline at end of file
@@ -18,5 +18,40 @@ int uninit_protocol_shell_parameters_protocol();
 BOOLEAN is_verbose_debug_print_enabled();
 BOOLEAN is_ESX_output_requested();
 
+/**
+  Check if the commands are to be read from a batch file (ipmctl -f <file>)
+
+  @retval TRUE batch mode was requested on the command line
+**/
+BOOLEAN is_batch_mode_requested();
+
+/**
+  Open the batch file given with -f, "-" stands for the standard input
+
+  @retval EFI_SUCCESS the batch file is open
+  @retval EFI_INVALID_PARAMETER batch mode was not requested
+  @retval EFI_NOT_FOUND the batch file could not be opened
+**/
+EFI_STATUS batch_input_open();
+
+/**
+  Read the next command line from the batch file.
+  Comment lines (starting with #) are returned as empty lines.
+
+  @param[out] pp_line the line, must be freed by the caller
+
+  @retval EFI_SUCCESS a line was read
+  @retval EFI_END_OF_FILE there are no more lines
+  @retval EFI_BUFFER_TOO_SMALL the line is too long
+  @retval EFI_OUT_OF_RESOURCES memory allocation failure
+  @retval EFI_DEVICE_ERROR the batch file could not be read
+**/
+EFI_STATUS batch_input_read_line(CHAR16 **pp_line);
+
+/**
+  Close the batch file, the standard input is left open
+**/
+void batch_input_close();
+
 
 #endif //_OS_SHELL_PARAM_PROTOCOL_H_
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+  OpenMetrics endpoint of the daemon, see exporter.h
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <os.h>
+#include "exporter.h"
+
+#define EXPORTER_POLL_MS          500   ///< The serving thread checks for a stop this often
+#define EXPORTER_MIN_CAPACITY     4096
+
+static OS_MUTEX *g_exposition_mutex = NULL;   ///< Guards g_exposition
+static METRICS_TEXT g_exposition;             ///< Last exposition published
+static OS_THREAD *g_thread = NULL;
+static volatile int g_stop = 0;
+static int g_listen_fd = -1;
+static char g_unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+void metrics_printf(METRICS_TEXT *p_metrics, const char *p_format, ...)
+{
+  va_list args;
+  size_t capacity = 0;
+  char *p_text = NULL;
+  int length = 0;
+
+  if (p_metrics->failed) {
+    return;
+  }
+  for (;;) {
+    if (NULL != p_metrics->p_text) {
+      va_start(args, p_format);
+      length = vsnprintf(p_metrics->p_text + p_metrics->length, p_metrics->capacity - p_metrics->length,
+        p_format, args);
+      va_end(args);
+      if (0 > length) {
+        p_metrics->failed = 1;
+        return;
+      }
+      if ((size_t)length < p_metrics->capacity - p_metrics->length) {
+        p_metrics->length += length;
+        return;
+      }
+    }
+    capacity = p_metrics->capacity ? p_metrics->capacity * 2 : EXPORTER_MIN_CAPACITY;
+    while (capacity - p_metrics->length <= (size_t)length) {
+      capacity *= 2;
+    }
+    if (NULL == (p_text = realloc(p_metrics->p_text, capacity))) {
+      p_metrics->failed = 1;
+      return;
+    }
+    p_metrics->p_text = p_text;
+    p_metrics->capacity = capacity;
+  }
+}
+
+void metrics_free(METRICS_TEXT *p_metrics)
+{
+  free(p_metrics->p_text);
+  memset(p_metrics, 0, sizeof(*p_metrics));
+}
+
+const char *metrics_escape(const char *p_value, char *p_escaped, size_t size)
+{
+  size_t length = 0;
+  const char *p_replace = NULL;
+
+  if (0 == size) {
+    return "";
+  }
+  for (; NULL != p_value && '\0' != *p_value; p_value++) {
+    switch (*p_value) {
+    case '\\':
+      p_replace = "\\\\";
+      break;
+    case '"':
+      p_replace = "\\\"";
+      break;
+    case '\n':
+      p_replace = "\\n";
+      break;
+    default:
+      p_replace = NULL;
+      break;
+    }
+    // a value too long is cut, never in the middle of an escape
+    if (length + (NULL != p_replace ? 2 : 1) >= size) {
+      break;
+    }
+    if (NULL != p_replace) {
+      p_escaped[length++] = p_replace[0];
+      p_escaped[length++] = p_replace[1];
+    } else {
+      p_escaped[length++] = *p_value;
+    }
+  }
+  p_escaped[length] = '\0';
+  return p_escaped;
+}
+
+/**
+  Limit the next send or receive on fd to what is left until deadline_ms,
+  -1 once the connection ran out of time
+**/
+static int set_io_deadline(int fd, unsigned long long deadline_ms)
+{
+  struct timeval timeout;
+  unsigned long long now_ms = os_get_monotonic_ms();
+
+  if (now_ms >= deadline_ms) {
+    return -1;
+  }
+  timeout.tv_sec = (time_t)((deadline_ms - now_ms) / 1000);
+  timeout.tv_usec = (suseconds_t)((deadline_ms - now_ms) % 1000 * 1000);
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  return 0;
+}
+
+/**
+  Send all of p_data before deadline_ms, 0 on success
+**/
+static int send_all(int fd, const char *p_data, size_t length, unsigned long long deadline_ms)
+{
+  ssize_t sent = 0;
+
+  while (0 < length) {
+    if (0 != set_io_deadline(fd, deadline_ms)) {
+      return -1;
+    }
+    sent = send(fd, p_data, length, MSG_NOSIGNAL);
+    if (0 > sent && EINTR == errno) {
+      continue;
+    }
+    if (0 >= sent) {
+      return -1;
+    }
+    p_data += sent;
+    length -= (size_t)sent;
+  }
+  return 0;
+}
+
+/**
+  Send a response without an exposition
+**/
+static void send_status(int fd, const char *p_status, unsigned long long deadline_ms)
+{
+  char response[256];
+
+  snprintf(response, sizeof(response),
+    "HTTP/1.1 %s\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s\n",
+    p_status, strlen(p_status) + 1, p_status);
+  send_all(fd, response, strlen(response), deadline_ms);
+}
+
+/**
+  Answer one scrape from the last exposition published. The whole exchange
+  has EXPORTER_IO_TIMEOUT_S, a scraper trickling its request or reading the
+  response slowly holds up the others no longer than that.
+**/
+static void serve(int fd, METRICS_TEXT *p_copy)
+{
+  char request[EXPORTER_REQUEST_MAX + 1];
+  char header[256];
+  unsigned long long deadline_ms = os_get_monotonic_ms() + EXPORTER_IO_TIMEOUT_S * 1000ULL;
+  size_t length = 0;
+  ssize_t received = 0;
+  char *p_path = NULL;
+  char *p_end = NULL;
+
+  // only the request line matters, the rest of the header is read and dropped
+  while (length < EXPORTER_REQUEST_MAX) {
+    if (0 != set_io_deadline(fd, deadline_ms)) {
+      return;
+    }
+    received = recv(fd, request + length, EXPORTER_REQUEST_MAX - length, 0);
+    if (0 > received && EINTR == errno) {
+      continue;
+    }
+    if (0 >= received) {
+      return;
+    }
+    length += (size_t)received;
+    request[length] = '\0';
+    if (NULL != strstr(request, "\r\n\r\n") || NULL != strstr(request, "\n\n")) {
+      break;
+    }
+  }
+  request[length] = '\0';
+
+  if (0 != strncmp(request, "GET ", 4)) {
+    send_status(fd, "405 Method Not Allowed", deadline_ms);
+    return;
+  }
+  p_path = request + 4;
+  p_end = p_path + strcspn(p_path, " ?\r\n");
+  if ((size_t)(p_end - p_path) != strlen(EXPORTER_PATH) || 0 != strncmp(p_path, EXPORTER_PATH, p_end - p_path)) {
+    send_status(fd, "404 Not Found", deadline_ms);
+    return;
+  }
+
+  // copied out so that a slow scraper does not hold up the collector
+  p_copy->length = 0;
+  os_mutex_lock(g_exposition_mutex);
+  if (NULL != g_exposition.p_text) {
+    metrics_printf(p_copy, "%s", g_exposition.p_text);
+  }
+  os_mutex_unlock(g_exposition_mutex);
+  if (0 == p_copy->length || p_copy->failed) {
+    p_copy->failed = 0;
+    send_status(fd, "503 Service Unavailable", deadline_ms);
+    return;
+  }
+
+  snprintf(header, sizeof(header),
+    "HTTP/1.1 200 OK\r\nContent-Type: " EXPORTER_CONTENT_TYPE "\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+    p_copy->length);
+  if (0 == send_all(fd, header, strlen(header), deadline_ms)) {
+    send_all(fd, p_copy->p_text, p_copy->length, deadline_ms);
+  }
+}
+
+/**
+  Serving thread, answers the scrapes one after the other
+**/
+static void exporter_thread(void *p_arg)
+{
+  METRICS_TEXT copy;
+  struct pollfd listener;
+  int fd = -1;
+
+  memset(&copy, 0, sizeof(copy));
+  while (!g_stop) {
+    listener.fd = g_listen_fd;
+    listener.events = POLLIN;
+    listener.revents = 0;
+    if (0 >= poll(&listener, 1, EXPORTER_POLL_MS)) {
+      continue;
+    }
+    if (0 > (fd = accept(g_listen_fd, NULL, NULL))) {
+      continue;
+    }
+    serve(fd, &copy);
+    close(fd);
+  }
+  metrics_free(&copy);
+}
+
+/**
+  Open the listening socket described by p_listen
+**/
+static int open_listener(const char *p_listen)
+{
+  struct sockaddr_un unix_addr;
+  struct addrinfo hints;
+  struct addrinfo *p_addrs = NULL;
+  struct addrinfo *p_addr = NULL;
+  char host[256];
+  const char *p_port = NULL;
+  const char *p_colon = NULL;
+  int fd = -1;
+  int on = 1;
+
+  if ('/' == p_listen[0]) {
+    if (strlen(p_listen) >= sizeof(unix_addr.sun_path) ||
+        0 > (fd = socket(AF_UNIX, SOCK_STREAM, 0))) {
+      return -1;
+    }
+    memset(&unix_addr, 0, sizeof(unix_addr));
+    unix_addr.sun_family = AF_UNIX;
+    strncpy(unix_addr.sun_path, p_listen, sizeof(unix_addr.sun_path) - 1);
+    // a socket left behind by a previous run is in the way
+    unlink(p_listen);
+    if (0 != bind(fd, (struct sockaddr *)&unix_addr, sizeof(unix_addr)) || 0 != listen(fd, SOMAXCONN)) {
+      close(fd);
+      return -1;
+    }
+    strncpy(g_unix_path, p_listen, sizeof(g_unix_path) - 1);
+    return fd;
+  }
+
+  snprintf(host, sizeof(host), "%s", EXPORTER_DEFAULT_HOST);
+  p_port = p_listen;
+  if (NULL != (p_colon = strrchr(p_listen, ':'))) {
+    snprintf(host, sizeof(host), "%.*s", (int)(p_colon - p_listen), p_listen);
+    p_port = p_colon + 1;
+  }
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  if (0 != getaddrinfo(host[0] ? host : NULL, p_port, &hints, &p_addrs)) {
+    return -1;
+  }
+  for (p_addr = p_addrs; NULL != p_addr; p_addr = p_addr->ai_next) {
+    if (0 > (fd = socket(p_addr->ai_family, p_addr->ai_socktype, p_addr->ai_protocol))) {
+      continue;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (0 == bind(fd, p_addr->ai_addr, p_addr->ai_addrlen) && 0 == listen(fd, SOMAXCONN)) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(p_addrs);
+  return fd;
+}
+
+int exporter_start(const char *p_listen)
+{
+  if (NULL == p_listen || NULL != g_thread) {
+    return -1;
+  }
+  if (NULL == g_exposition_mutex && NULL == (g_exposition_mutex = os_mutex_init(NULL))) {
+    return -1;
+  }
+  if (0 > (g_listen_fd = open_listener(p_listen))) {
+    return -1;
+  }
+  g_stop = 0;
+  if (NULL == (g_thread = os_thread_create(exporter_thread, NULL))) {
+    close(g_listen_fd);
+    g_listen_fd = -1;
+    return -1;
+  }
+  return 0;
+}
+
+void exporter_publish(METRICS_TEXT *p_metrics)
+{
+  METRICS_TEXT old;
+
+  if (NULL == g_exposition_mutex) {
+    metrics_free(p_metrics);
+    return;
+  }
+  // an incomplete exposition would read as metrics gone missing
+  if (p_metrics->failed) {
+    metrics_free(p_metrics);
+    return;
+  }
+  os_mutex_lock(g_exposition_mutex);
+  old = g_exposition;
+  g_exposition = *p_metrics;
+  os_mutex_unlock(g_exposition_mutex);
+  memset(p_metrics, 0, sizeof(*p_metrics));
+  metrics_free(&old);
+}
+
+void exporter_stop(void)
+{
+  if (NULL != g_thread) {
+    g_stop = 1;
+    os_thread_join(g_thread);
+    g_thread = NULL;
+  }
+  if (0 <= g_listen_fd) {
+    close(g_listen_fd);
+    g_listen_fd = -1;
+  }
+  if (g_unix_path[0]) {
+    unlink(g_unix_path);
+    g_unix_path[0] = '\0';
+  }
+  if (NULL != g_exposition_mutex) {
+    os_mutex_lock(g_exposition_mutex);
+    metrics_free(&g_exposition);
+    os_mutex_unlock(g_exposition_mutex);
+  }
+}
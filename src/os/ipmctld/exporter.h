@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+  OpenMetrics endpoint of the daemon.
+
+  The collector renders the exposition whenever it publishes new results and
+  hands it over with exporter_publish(). A thread of its own answers every
+  scrape from the last exposition handed over, so scrapes never wait for a
+  poll and never cause FW commands, however many scrapers there are.
+**/
+
+#ifndef EXPORTER_H_
+#define EXPORTER_H_
+
+#include <stddef.h>
+
+#define EXPORTER_CONTENT_TYPE     "application/openmetrics-text; version=1.0.0; charset=utf-8"
+#define EXPORTER_PATH             "/metrics"
+#define EXPORTER_DEFAULT_HOST     "127.0.0.1"
+#define EXPORTER_REQUEST_MAX      4096  ///< Longest request header read
+#define EXPORTER_IO_TIMEOUT_S     2     ///< Time a scrape may take from accept to the last byte sent
+
+/**
+  Growing text buffer the exposition is rendered into
+**/
+typedef struct _METRICS_TEXT
+{
+  char *p_text;                         ///< NUL terminated text, NULL until something is appended
+  size_t length;                        ///< Characters in p_text
+  size_t capacity;                      ///< Bytes allocated for p_text
+  int failed;                           ///< An append ran out of memory, the text is incomplete
+} METRICS_TEXT;
+
+/**
+  Append formatted text to p_metrics
+**/
+void metrics_printf(METRICS_TEXT *p_metrics, const char *p_format, ...)
+#ifdef __GNUC__
+  __attribute__((format(printf, 2, 3)))
+#endif
+  ;
+
+/**
+  Release the buffer of p_metrics and empty it
+**/
+void metrics_free(METRICS_TEXT *p_metrics);
+
+/**
+  Escape a label value for the exposition: backslash, double quote and line
+  feed are written as \\, \" and \n. A value that does not fit is cut.
+  @param p_value the value, NULL reads as empty
+  @param p_escaped buffer for the escaped value
+  @param size bytes in p_escaped
+  @retval p_escaped
+**/
+const char *metrics_escape(const char *p_value, char *p_escaped, size_t size);
+
+/**
+  Start serving scrapes.
+
+  @param p_listen a path for a Unix socket, otherwise [host:]port of a TCP
+    socket, on EXPORTER_DEFAULT_HOST if the host is left out
+
+  @retval 0 on success
+**/
+int exporter_start(const char *p_listen);
+
+/**
+  Serve p_metrics to the next scrapes. Takes over its buffer and empties it.
+**/
+void exporter_publish(METRICS_TEXT *p_metrics);
+
+/**
+  Stop serving scrapes and release the exposition
+**/
+void exporter_stop(void);
+
+#endif /* EXPORTER_H_ */
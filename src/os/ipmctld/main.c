@@ -0,0 +1,580 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+  Management daemon.
+
+  Owns the FW traffic of the monitoring reads: it polls the sensors and
+  status, the performance counters and the long operation status of every
+  PMem module on their own intervals and publishes the results in shared
+  memory (see nvm_telemetry.h). Library users then get nvm_get_sensors(),
+  nvm_get_sensor(), nvm_get_device_status(), nvm_get_device_performance()
+  and nvm_get_jobs() from there without a FW command, and read the PMem
+  modules themselves again when the daemon is stopped. It runs in the
+  foreground, as root:
+    ipmctld [-inventory <seconds>] [-health <seconds>] [-performance <seconds>]
+            [-jobs <seconds>] [-history <seconds>] [-listen <path|[host:]port>]
+  Served data is at most one interval old, changes made through the library
+  in the same process are never hidden by it.
+
+  The inventory poll picks up added and removed PMem modules, their FW
+  versions and the capacities of the system. With -listen the daemon also
+  serves all of it as OpenMetrics at /metrics (see exporter.h), rendered
+  after every poll, so scrapers never cause FW commands of their own.
+
+  The history poll appends the latest sensors and performance counters of
+  every PMem module to NVM_HISTORY_FILE (see nvm_history.h), read back by
+  show -sensor -history and show -performance -history.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <nvm_management.h>
+#include <nvm_telemetry.h>
+#include <nvm_history.h>
+#include <os.h>
+#include "exporter.h"
+
+#define DEFAULT_INVENTORY_INTERVAL_S    60
+#define DEFAULT_HEALTH_INTERVAL_S       30
+#define DEFAULT_PERFORMANCE_INTERVAL_S  10
+#define DEFAULT_JOBS_INTERVAL_S         5
+#define DEFAULT_HISTORY_INTERVAL_S      300
+#define MS_PER_S                        1000
+
+/**
+  A group of data polled on its own interval
+**/
+typedef struct _POLL_GROUP
+{
+  const char *option;                   ///< Command line option setting the interval
+  unsigned int interval_s;              ///< Seconds between polls
+  NVM_UINT32 families;                  ///< TELEMETRY_FAMILY_BIT of the families it fills
+  void (*p_poll)(struct telemetry_dimm *p_dimms, NVM_UINT32 count);
+  NVM_UINT64 next_ms;                   ///< Time of the next poll
+  time_t polled;                        ///< Wall clock time the last poll started, 0 before
+} POLL_GROUP;
+
+/**
+  A sensor exported as a metric of its own
+**/
+typedef struct _SENSOR_METRIC
+{
+  enum sensor_type type;
+  const char *name;                     ///< Metric family name
+  const char *metric_type;              ///< OpenMetrics type, counters get the _total suffix
+  const char *unit;                     ///< OpenMetrics unit, NULL for none
+  int is_signed;                        ///< Reading holds a signed value
+  const char *help;
+} SENSOR_METRIC;
+
+static const SENSOR_METRIC g_sensor_metrics[] = {
+  {SENSOR_MEDIA_TEMPERATURE, "ipmctl_dimm_media_temperature_celsius", "gauge", "celsius", 1,
+    "Media temperature."},
+  {SENSOR_CONTROLLER_TEMPERATURE, "ipmctl_dimm_controller_temperature_celsius", "gauge", "celsius", 1,
+    "Controller temperature."},
+  {SENSOR_PERCENTAGE_REMAINING, "ipmctl_dimm_percentage_remaining", "gauge", NULL, 0,
+    "Remaining spare capacity as a percentage of the factory configured spare capacity."},
+  {SENSOR_POWERONTIME, "ipmctl_dimm_power_on_time_seconds", "counter", "seconds", 0,
+    "Power-on time over the lifetime of the PMem module."},
+  {SENSOR_UPTIME, "ipmctl_dimm_uptime_seconds", "gauge", "seconds", 0,
+    "Power-on time since the last power cycle."},
+  {SENSOR_POWERCYCLES, "ipmctl_dimm_power_cycles", "counter", NULL, 0,
+    "Power cycles over the lifetime of the PMem module."},
+  {SENSOR_LATCHED_DIRTY_SHUTDOWN_COUNT, "ipmctl_dimm_latched_dirty_shutdowns", "counter", NULL, 0,
+    "Shutdowns without notification, latched."},
+  {SENSOR_UNLATCHED_DIRTY_SHUTDOWN_COUNT, "ipmctl_dimm_unlatched_dirty_shutdowns", "counter", NULL, 0,
+    "Shutdowns without notification, unlatched."},
+  {SENSOR_FWERRORLOGCOUNT, "ipmctl_dimm_fw_error_log_entries", "gauge", NULL, 0,
+    "Entries in the FW error logs."},
+};
+
+#define SENSOR_METRIC_COUNT (sizeof(g_sensor_metrics) / sizeof(g_sensor_metrics[0]))
+
+static volatile sig_atomic_t g_stop = 0;
+static struct telemetry_region *g_region = NULL;
+static struct telemetry_dimm g_dimms[NVM_TELEMETRY_MAX_DIMMS];  ///< Results being gathered
+static NVM_UINT32 g_dimm_count = 0;
+static struct device_discovery g_devices[NVM_TELEMETRY_MAX_DIMMS];  ///< Inventory of g_dimms, same order
+static struct device_capacities g_capacities;
+static int g_capacities_valid = 0;
+static const char *g_listen = NULL;     ///< -listen value, NULL when not exporting
+static struct history_writer *g_history = NULL;   ///< NULL when the history cannot be written
+
+/**
+  Ask the main loop to stop
+**/
+static void on_stop_signal(int signum)
+{
+  g_stop = 1;
+}
+
+/**
+  Tell readers the daemon is alive, also in the middle of a long poll
+**/
+static void beat(void)
+{
+  telemetry_write_begin(g_region);
+  g_region->heartbeat_ms = os_get_monotonic_ms();
+  telemetry_write_end(g_region);
+}
+
+/**
+  Set a family bit of an entry according to the result of its poll
+**/
+static void set_valid(struct telemetry_dimm *p_dimm, enum telemetry_family family, int rc)
+{
+  if (NVM_SUCCESS == rc) {
+    p_dimm->valid |= TELEMETRY_FAMILY_BIT(family);
+  } else {
+    p_dimm->valid &= ~TELEMETRY_FAMILY_BIT(family);
+  }
+}
+
+/**
+  Poll the capacities of the system. The PMem modules themselves are taken
+  stock of by refresh_dimms() right before.
+**/
+static void poll_inventory(struct telemetry_dimm *p_dimms, NVM_UINT32 count)
+{
+  g_capacities_valid = (NVM_SUCCESS == nvm_get_nvm_capacities(&g_capacities));
+  beat();
+}
+
+/**
+  Poll the sensors and the status of every PMem module
+**/
+static void poll_health(struct telemetry_dimm *p_dimms, NVM_UINT32 count)
+{
+  NVM_UINT32 index = 0;
+
+  for (index = 0; index < count && !g_stop; index++) {
+    set_valid(&p_dimms[index], TELEMETRY_SENSORS,
+      nvm_get_sensors(p_dimms[index].uid, p_dimms[index].sensors, SENSOR_COUNT));
+    set_valid(&p_dimms[index], TELEMETRY_STATUS,
+      nvm_get_device_status(p_dimms[index].uid, &p_dimms[index].status));
+    beat();
+  }
+}
+
+/**
+  Poll the performance counters of every PMem module
+**/
+static void poll_performance(struct telemetry_dimm *p_dimms, NVM_UINT32 count)
+{
+  NVM_UINT32 index = 0;
+
+  for (index = 0; index < count && !g_stop; index++) {
+    set_valid(&p_dimms[index], TELEMETRY_PERFORMANCE,
+      nvm_get_device_performance(p_dimms[index].uid, &p_dimms[index].performance));
+    beat();
+  }
+}
+
+/**
+  Poll the long operation status of every PMem module
+**/
+static void poll_jobs(struct telemetry_dimm *p_dimms, NVM_UINT32 count)
+{
+  struct job jobs[NVM_TELEMETRY_MAX_DIMMS];
+  NVM_UINT32 index = 0;
+  NVM_UINT32 job = 0;
+  int rc = 0;
+
+  memset(jobs, 0, sizeof(jobs));
+  rc = nvm_get_jobs(jobs, count);
+  for (index = 0; index < count; index++) {
+    set_valid(&p_dimms[index], TELEMETRY_JOB, NVM_ERR_OPERATION_FAILED);
+    for (job = 0; NVM_SUCCESS == rc && job < count; job++) {
+      if (0 == strncmp(jobs[job].uid, p_dimms[index].uid, NVM_MAX_UID_LEN)) {
+        p_dimms[index].job = jobs[job];
+        set_valid(&p_dimms[index], TELEMETRY_JOB, NVM_SUCCESS);
+        break;
+      }
+    }
+  }
+}
+
+/**
+  Append the latest results of every PMem module to the history. Nothing is
+  read from the PMem modules, the health and performance polls run first.
+**/
+static void poll_history(struct telemetry_dimm *p_dimms, NVM_UINT32 count)
+{
+  unsigned long long values[HISTORY_FIELD_COUNT];
+  struct sensor *p_sensors = NULL;
+  NVM_UINT32 index = 0;
+
+  if (NULL == g_history) {
+    return;
+  }
+  for (index = 0; index < count; index++) {
+    memset(values, 0, sizeof(values));
+    values[HISTORY_TIME] = history_now();
+    if (p_dimms[index].valid & TELEMETRY_FAMILY_BIT(TELEMETRY_SENSORS)) {
+      p_sensors = p_dimms[index].sensors;
+      values[HISTORY_VALID] |= HISTORY_VALID_SENSORS;
+      values[HISTORY_HEALTH] = p_sensors[SENSOR_HEALTH].reading;
+      values[HISTORY_MEDIA_TEMPERATURE] = p_sensors[SENSOR_MEDIA_TEMPERATURE].reading;
+      values[HISTORY_CONTROLLER_TEMPERATURE] = p_sensors[SENSOR_CONTROLLER_TEMPERATURE].reading;
+      values[HISTORY_PERCENTAGE_REMAINING] = p_sensors[SENSOR_PERCENTAGE_REMAINING].reading;
+      values[HISTORY_POWER_ON_TIME] = p_sensors[SENSOR_POWERONTIME].reading;
+      values[HISTORY_UPTIME] = p_sensors[SENSOR_UPTIME].reading;
+      values[HISTORY_POWER_CYCLES] = p_sensors[SENSOR_POWERCYCLES].reading;
+      values[HISTORY_LATCHED_DIRTY_SHUTDOWNS] = p_sensors[SENSOR_LATCHED_DIRTY_SHUTDOWN_COUNT].reading;
+      values[HISTORY_UNLATCHED_DIRTY_SHUTDOWNS] = p_sensors[SENSOR_UNLATCHED_DIRTY_SHUTDOWN_COUNT].reading;
+      values[HISTORY_FW_ERROR_LOG_ENTRIES] = p_sensors[SENSOR_FWERRORLOGCOUNT].reading;
+    }
+    if (p_dimms[index].valid & TELEMETRY_FAMILY_BIT(TELEMETRY_PERFORMANCE)) {
+      values[HISTORY_VALID] |= HISTORY_VALID_PERFORMANCE;
+      values[HISTORY_MEDIA_READS] = p_dimms[index].performance.bytes_read;
+      values[HISTORY_MEDIA_WRITES] = p_dimms[index].performance.bytes_written;
+      values[HISTORY_READ_REQUESTS] = p_dimms[index].performance.host_reads;
+      values[HISTORY_WRITE_REQUESTS] = p_dimms[index].performance.host_writes;
+    }
+    if (0 != history_append(g_history, p_dimms[index].uid, values)) {
+      fprintf(stderr, "Failed to append to " NVM_HISTORY_FILE ".\n");
+    }
+  }
+}
+
+static POLL_GROUP g_poll_groups[] = {
+  {"-inventory", DEFAULT_INVENTORY_INTERVAL_S, 0, poll_inventory, 0, 0},
+  {"-health", DEFAULT_HEALTH_INTERVAL_S,
+    TELEMETRY_FAMILY_BIT(TELEMETRY_SENSORS) | TELEMETRY_FAMILY_BIT(TELEMETRY_STATUS), poll_health, 0, 0},
+  {"-performance", DEFAULT_PERFORMANCE_INTERVAL_S,
+    TELEMETRY_FAMILY_BIT(TELEMETRY_PERFORMANCE), poll_performance, 0, 0},
+  {"-jobs", DEFAULT_JOBS_INTERVAL_S,
+    TELEMETRY_FAMILY_BIT(TELEMETRY_JOB), poll_jobs, 0, 0},
+  // last, so that it records the polls above when they are due at the same time
+  {"-history", DEFAULT_HISTORY_INTERVAL_S, 0, poll_history, 0, 0},
+};
+
+#define POLL_GROUP_COUNT (sizeof(g_poll_groups) / sizeof(g_poll_groups[0]))
+
+/**
+  Refresh the list of PMem modules. Entries of modules that are still there
+  keep their results.
+
+  @retval 1 if the list changed
+**/
+static int refresh_dimms(void)
+{
+  static struct telemetry_dimm dimms[NVM_TELEMETRY_MAX_DIMMS];
+  static struct device_discovery devices[NVM_TELEMETRY_MAX_DIMMS];
+  struct device_discovery *p_devices = NULL;
+  unsigned int count = 0;
+  unsigned int index = 0;
+  unsigned int old = 0;
+  int changed = 0;
+
+  if (NVM_SUCCESS != nvm_get_number_of_devices(&count) || count > NVM_TELEMETRY_MAX_DIMMS) {
+    fprintf(stderr, "Failed to get the number of PMem modules.\n");
+    count = 0;
+  }
+  if (0 < count && (NULL == (p_devices = calloc(count, sizeof(*p_devices))) ||
+      NVM_SUCCESS != nvm_get_devices(p_devices, (NVM_UINT8)count))) {
+    fprintf(stderr, "Failed to get the PMem modules.\n");
+    count = 0;
+  }
+
+  memset(dimms, 0, sizeof(dimms));
+  memset(devices, 0, sizeof(devices));
+  changed = (count != g_dimm_count);
+  for (index = 0; index < count; index++) {
+    devices[index] = p_devices[index];
+    memcpy(dimms[index].uid, p_devices[index].uid, sizeof(dimms[index].uid));
+    for (old = 0; old < g_dimm_count; old++) {
+      if (0 == strncmp(g_dimms[old].uid, dimms[index].uid, NVM_MAX_UID_LEN)) {
+        dimms[index] = g_dimms[old];
+        break;
+      }
+    }
+    changed |= (old != index);
+  }
+  memcpy(g_dimms, dimms, sizeof(g_dimms));
+  memcpy(g_devices, devices, sizeof(g_devices));
+  g_dimm_count = count;
+  free(p_devices);
+  return changed;
+}
+
+/**
+  Publish the gathered results of families, polled from start_ms on
+**/
+static void publish(NVM_UINT32 families, NVM_UINT64 start_ms)
+{
+  int family = 0;
+
+  telemetry_write_begin(g_region);
+  memcpy(g_region->dimms, g_dimms, g_dimm_count * sizeof(g_dimms[0]));
+  g_region->dimm_count = g_dimm_count;
+  for (family = 0; family < TELEMETRY_FAMILY_COUNT; family++) {
+    if (families & TELEMETRY_FAMILY_BIT(family)) {
+      g_region->updated_ms[family] = start_ms;
+    }
+  }
+  g_region->heartbeat_ms = os_get_monotonic_ms();
+  telemetry_write_end(g_region);
+}
+
+/**
+  Start a metric family of the exposition
+**/
+static void render_family(METRICS_TEXT *p_metrics, const char *p_name, const char *p_type,
+  const char *p_unit, const char *p_help)
+{
+  metrics_printf(p_metrics, "# TYPE %s %s\n", p_name, p_type);
+  if (NULL != p_unit) {
+    metrics_printf(p_metrics, "# UNIT %s %s\n", p_name, p_unit);
+  }
+  metrics_printf(p_metrics, "# HELP %s %s\n", p_name, p_help);
+}
+
+/**
+  Render one value of a family for every PMem module with a valid family
+**/
+static void render_dimms(METRICS_TEXT *p_metrics, const char *p_name, const char *p_suffix,
+  enum telemetry_family family, size_t offset)
+{
+  char uid[sizeof(g_dimms[0].uid) * 2];
+  NVM_UINT32 index = 0;
+
+  for (index = 0; index < g_dimm_count; index++) {
+    if (g_dimms[index].valid & TELEMETRY_FAMILY_BIT(family)) {
+      metrics_printf(p_metrics, "%s%s{dimm_uid=\"%s\"} %llu\n", p_name, p_suffix,
+        metrics_escape(g_dimms[index].uid, uid, sizeof(uid)),
+        *(const unsigned long long *)((const char *)&g_dimms[index] + offset));
+    }
+  }
+}
+
+/**
+  Render everything gathered so far as OpenMetrics and hand it to the exporter
+**/
+static void render_metrics(void)
+{
+  static const struct {
+    const char *name;
+    size_t offset;
+    const char *help;
+  } performance[] = {
+    {"ipmctl_dimm_media_reads", offsetof(struct telemetry_dimm, performance.bytes_read),
+      "64 byte reads from media over the lifetime of the PMem module."},
+    {"ipmctl_dimm_media_writes", offsetof(struct telemetry_dimm, performance.bytes_written),
+      "64 byte writes to media over the lifetime of the PMem module."},
+    {"ipmctl_dimm_read_requests", offsetof(struct telemetry_dimm, performance.host_reads),
+      "DDRT read transactions serviced over the lifetime of the PMem module."},
+    {"ipmctl_dimm_write_requests", offsetof(struct telemetry_dimm, performance.host_writes),
+      "DDRT write transactions serviced over the lifetime of the PMem module."},
+  };
+  METRICS_TEXT metrics;
+  // label values are escaped, the FW reports them
+  char uid[sizeof(g_dimms[0].uid) * 2];
+  char fw_revision[sizeof(g_devices[0].fw_revision) * 2];
+  char fw_api_version[sizeof(g_devices[0].fw_api_version) * 2];
+  const SENSOR_METRIC *p_sensor = NULL;
+  const char *p_suffix = NULL;
+  NVM_UINT64 reading = 0;
+  NVM_UINT32 index = 0;
+  unsigned int metric = 0;
+  unsigned int group = 0;
+
+  memset(&metrics, 0, sizeof(metrics));
+
+  render_family(&metrics, "ipmctl_dimm", "info", NULL, "PMem module and its active FW.");
+  for (index = 0; index < g_dimm_count; index++) {
+    metrics_printf(&metrics, "ipmctl_dimm_info{dimm_uid=\"%s\",fw_revision=\"%s\",fw_api_version=\"%s\"} 1\n",
+      metrics_escape(g_dimms[index].uid, uid, sizeof(uid)),
+      metrics_escape(g_devices[index].fw_revision, fw_revision, sizeof(fw_revision)),
+      metrics_escape(g_devices[index].fw_api_version, fw_api_version, sizeof(fw_api_version)));
+  }
+  render_family(&metrics, "ipmctl_dimm_capacity_bytes", "gauge", "bytes", "Raw capacity of the PMem module.");
+  for (index = 0; index < g_dimm_count; index++) {
+    metrics_printf(&metrics, "ipmctl_dimm_capacity_bytes{dimm_uid=\"%s\"} %llu\n",
+      metrics_escape(g_dimms[index].uid, uid, sizeof(uid)), (unsigned long long)g_devices[index].capacity);
+  }
+
+  render_family(&metrics, "ipmctl_dimm_health", "gauge", NULL,
+    "Health state: 0 unknown, 1 healthy, 2 non-critical, 3 critical, 4 fatal, 5 unmanageable, 6 non-functional.");
+  for (index = 0; index < g_dimm_count; index++) {
+    if (g_dimms[index].valid & TELEMETRY_FAMILY_BIT(TELEMETRY_STATUS)) {
+      metrics_printf(&metrics, "ipmctl_dimm_health{dimm_uid=\"%s\"} %u\n",
+        metrics_escape(g_dimms[index].uid, uid, sizeof(uid)), (unsigned int)g_dimms[index].status.health);
+    }
+  }
+
+  for (metric = 0; metric < SENSOR_METRIC_COUNT; metric++) {
+    p_sensor = &g_sensor_metrics[metric];
+    p_suffix = (0 == strcmp(p_sensor->metric_type, "counter")) ? "_total" : "";
+    render_family(&metrics, p_sensor->name, p_sensor->metric_type, p_sensor->unit, p_sensor->help);
+    for (index = 0; index < g_dimm_count; index++) {
+      if (0 == (g_dimms[index].valid & TELEMETRY_FAMILY_BIT(TELEMETRY_SENSORS))) {
+        continue;
+      }
+      reading = g_dimms[index].sensors[p_sensor->type].reading;
+      if (p_sensor->is_signed) {
+        // a negative reading is kept sign extended in the 64 bits
+        metrics_printf(&metrics, "%s%s{dimm_uid=\"%s\"} %lld\n", p_sensor->name, p_suffix,
+          metrics_escape(g_dimms[index].uid, uid, sizeof(uid)), (long long)(NVM_INT64)reading);
+      } else {
+        metrics_printf(&metrics, "%s%s{dimm_uid=\"%s\"} %llu\n", p_sensor->name, p_suffix,
+          metrics_escape(g_dimms[index].uid, uid, sizeof(uid)), (unsigned long long)reading);
+      }
+    }
+  }
+
+  for (metric = 0; metric < sizeof(performance) / sizeof(performance[0]); metric++) {
+    render_family(&metrics, performance[metric].name, "counter", NULL, performance[metric].help);
+    render_dimms(&metrics, performance[metric].name, "_total", TELEMETRY_PERFORMANCE, performance[metric].offset);
+  }
+
+  if (g_capacities_valid) {
+    render_family(&metrics, "ipmctl_capacity_bytes", "gauge", "bytes", "PMem capacity of the system by use.");
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"total\"} %llu\n",
+      (unsigned long long)g_capacities.capacity);
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"memory\"} %llu\n",
+      (unsigned long long)g_capacities.memory_capacity);
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"app_direct\"} %llu\n",
+      (unsigned long long)g_capacities.app_direct_capacity);
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"unconfigured\"} %llu\n",
+      (unsigned long long)g_capacities.unconfigured_capacity);
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"inaccessible\"} %llu\n",
+      (unsigned long long)g_capacities.inaccessible_capacity);
+    metrics_printf(&metrics, "ipmctl_capacity_bytes{type=\"reserved\"} %llu\n",
+      (unsigned long long)g_capacities.reserved_capacity);
+  }
+
+  render_family(&metrics, "ipmctl_collector_interval_seconds", "gauge", "seconds",
+    "Time between two polls of a group.");
+  for (group = 0; group < POLL_GROUP_COUNT; group++) {
+    metrics_printf(&metrics, "ipmctl_collector_interval_seconds{group=\"%s\"} %u\n",
+      g_poll_groups[group].option + 1, g_poll_groups[group].interval_s);
+  }
+  render_family(&metrics, "ipmctl_collector_last_poll_timestamp_seconds", "gauge", "seconds",
+    "Time the last poll of a group started.");
+  for (group = 0; group < POLL_GROUP_COUNT; group++) {
+    if (0 != g_poll_groups[group].polled) {
+      metrics_printf(&metrics, "ipmctl_collector_last_poll_timestamp_seconds{group=\"%s\"} %lld\n",
+        g_poll_groups[group].option + 1, (long long)g_poll_groups[group].polled);
+    }
+  }
+
+  metrics_printf(&metrics, "# EOF\n");
+  exporter_publish(&metrics);
+}
+
+/**
+  Print usage
+**/
+static void print_help(void)
+{
+  fprintf(stderr, "Usage:\n");
+  fprintf(stderr, "  ipmctld [-inventory <seconds>] [-health <seconds>] [-performance <seconds>]\n");
+  fprintf(stderr, "          [-jobs <seconds>] [-history <seconds>] [-listen <path|[host:]port>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+  struct sigaction action;
+  NVM_UINT64 now_ms = 0;
+  unsigned int group = 0;
+  int family = 0;
+  int index = 0;
+
+  for (index = 1; index < argc; index++) {
+    if (0 == strcmp(argv[index], "-listen") && index + 1 < argc) {
+      g_listen = argv[++index];
+      continue;
+    }
+    for (group = 0; group < POLL_GROUP_COUNT; group++) {
+      if (0 == strcmp(argv[index], g_poll_groups[group].option) && index + 1 < argc) {
+        g_poll_groups[group].interval_s = (unsigned int)strtoul(argv[++index], NULL, 10);
+        break;
+      }
+    }
+    if (group == POLL_GROUP_COUNT || 0 == g_poll_groups[group].interval_s) {
+      print_help();
+      return 1;
+    }
+  }
+
+  // no SA_RESTART, a signal cuts the sleep short
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = on_stop_signal;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  if (NVM_SUCCESS != nvm_init()) {
+    fprintf(stderr, "Failed to initialize the management library.\n");
+    return 1;
+  }
+  if (NULL == (g_region = telemetry_create())) {
+    // e.g. EPERM when another user holds the name, readers would not trust it anyway
+    fprintf(stderr, "Failed to create the shared memory " NVM_TELEMETRY_SHM_NAME ": %s.\n", strerror(errno));
+    nvm_uninit();
+    return 1;
+  }
+  if (NULL != g_listen && 0 != exporter_start(g_listen)) {
+    fprintf(stderr, "Failed to listen on %s.\n", g_listen);
+    telemetry_destroy(g_region);
+    nvm_uninit();
+    return 1;
+  }
+
+  // the daemon keeps serving without a history, e.g. on a read-only /var/log
+  if (NULL == (g_history = history_open(NVM_HISTORY_FILE))) {
+    fprintf(stderr, "Failed to open the history " NVM_HISTORY_FILE ", not recording it.\n");
+  }
+
+  // a poll a little late still counts, one missed is stale
+  telemetry_write_begin(g_region);
+  for (group = 0; group < POLL_GROUP_COUNT; group++) {
+    for (family = 0; family < TELEMETRY_FAMILY_COUNT; family++) {
+      if (g_poll_groups[group].families & TELEMETRY_FAMILY_BIT(family)) {
+        g_region->max_age_ms[family] =
+          (NVM_UINT64)g_poll_groups[group].interval_s * MS_PER_S + NVM_TELEMETRY_HEARTBEAT_TIMEOUT_MS;
+      }
+    }
+  }
+  telemetry_write_end(g_region);
+
+  while (!g_stop) {
+    now_ms = os_get_monotonic_ms();
+    for (group = 0; group < POLL_GROUP_COUNT && !g_stop; group++) {
+      if (now_ms < g_poll_groups[group].next_ms) {
+        continue;
+      }
+      // the inventory poll picks up added and removed PMem modules, the others follow
+      if (g_poll_groups[group].p_poll == poll_inventory && refresh_dimms()) {
+        for (index = 0; index < (int)POLL_GROUP_COUNT; index++) {
+          g_poll_groups[index].next_ms = now_ms;
+        }
+      }
+      g_poll_groups[group].next_ms = now_ms + (NVM_UINT64)g_poll_groups[group].interval_s * MS_PER_S;
+      g_poll_groups[group].polled = time(NULL);
+      g_poll_groups[group].p_poll(g_dimms, g_dimm_count);
+      if (!g_stop) {
+        publish(g_poll_groups[group].families, now_ms);
+        if (NULL != g_listen) {
+          render_metrics();
+        }
+      }
+    }
+    beat();
+    sleep(NVM_TELEMETRY_HEARTBEAT_MS / MS_PER_S);
+  }
+
+  exporter_stop();
+  history_close(g_history);
+  telemetry_destroy(g_region);
+  nvm_uninit();
+  return 0;
+}
@@ -17,13 +17,18 @@
 #include <sys/stat.h>
 #include <syslog.h>
 #include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <errno.h>
 #include <dlfcn.h>
 #include <stdio.h>
 #include <libgen.h>
 #include <cpuid.h>
-#include <sys/shm.h>
 #include <sys/types.h>
-#include <sys/ipc.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
 #include <Base.h>
 #include <lnx_adapter.h>
 #include <string.h>
@@ -33,10 +38,10 @@
 #include <stdbool.h>
 
 #define	LOCALE_DIR	"/usr/share/locale"
-#define FTOK_PROJ_ID 'R' // Today proj_id is an int, but still only 8 bits are used.
-                        // Typical usage has an ASCII character proj_id,
-                        // that is why the behavior is said to be undefined when proj_id is zero.
-#define SHM_PERM_FLG 0666 // permissions granted to the owner, group, and others.
+#define	LOCK_DIR	"/var/lock/"
+#define	LOCK_FILE_EXT	".lock"
+#define	LOCK_FILE_PERM	0600 // flock(..) only needs read access, other users must not hold the lock
+#define	SHM_PERM	0644 // only the creator writes shared memory, any user may read it
 
 #ifndef ACCESSPERMS
 #define ACCESSPERMS (S_IRWXU|S_IRWXG|S_IRWXO)
@@ -75,6 +80,8 @@ int os_get_filesize(const char *filename, size_t *filesize)
 
 /*
  * Initializes a mutex.
+ * The mutex is process private, the name is not used. Processes exclude
+ * each other with os_process_rwlock_open(..).
  */
 OS_MUTEX * os_mutex_init(const char *name)
 {
@@ -87,23 +94,6 @@ OS_MUTEX * os_mutex_init(const char *name)
 		pthread_mutexattr_init(&attr);
 		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
 
-		// if named make it cross-process safe
-		if (name)
-		{
-			pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
-			// create a shared memory id
-			int shmid = shmget(ftok(name, FTOK_PROJ_ID), sizeof (pthread_mutex_t), IPC_CREAT | SHM_PERM_FLG);
-			if (shmid != -1)
-			{
-				// attach to the shared memory
-				pthread_mutex_t *p_tmp = (pthread_mutex_t *)shmat(shmid, NULL, 0);
-				if (p_tmp)
-				{
-					memmove(mutex, p_tmp, sizeof (pthread_mutex_t));
-				}
-			}
-		}
-
 		// failure when pthread_mutex_init(..) != 0
 		rc = pthread_mutex_init((pthread_mutex_t *)mutex, &attr);
 		if (rc != 0) {
@@ -154,32 +144,28 @@ int os_mutex_delete(OS_MUTEX *p_mutex, const char *name)
   {
     // failure when pthread_mutex_destroy(..) != 0
     rc = (pthread_mutex_destroy((pthread_mutex_t *)p_mutex) == 0);
-
-    // detach and remove the shared memory
-    if (name)
-    {
-      shmdt(p_mutex);
-      // remove the shared memory
-      int shmid = shmget(ftok(name, FTOK_PROJ_ID), sizeof(pthread_mutex_t), SHM_PERM_FLG);
-      if (shmid != -1)
-      {
-        shmctl(shmid, IPC_RMID, NULL);
-      }
-    }
     free(p_mutex);
   }
   return rc;
 }
 
 /*
- * Initializes a rwlock
+ * Creates a process private rwlock, returns NULL on failure
  */
-int os_rwlock_init(OS_RWLOCK *p_rwlock)
+OS_RWLOCK *os_rwlock_create()
 {
-	pthread_rwlock_t *p_handle = (pthread_rwlock_t *)p_rwlock;
+	pthread_rwlock_t *p_handle = (pthread_rwlock_t *)malloc(sizeof(pthread_rwlock_t));
 
-	// failure when pthread_rwlock_init(..) != 0
-	return ((pthread_rwlock_init(p_handle, NULL)) == 0);
+	if (p_handle)
+	{
+		// failure when pthread_rwlock_init(..) != 0
+		if (pthread_rwlock_init(p_handle, NULL) != 0)
+		{
+			free(p_handle);
+			p_handle = NULL;
+		}
+	}
+	return (OS_RWLOCK *)p_handle;
 }
 
 /*
@@ -230,10 +216,520 @@ int os_rwlock_w_unlock(OS_RWLOCK *p_rwlock)
  */
 int os_rwlock_delete(OS_RWLOCK *p_rwlock)
 {
-	pthread_rwlock_t *p_handle = (pthread_rwlock_t *)p_rwlock;
+	int rc = 1;
+	if (p_rwlock)
+	{
+		// failure when pthread_rwlock_destroy(..) != 0
+		rc = (pthread_rwlock_destroy((pthread_rwlock_t *)p_rwlock) == 0);
+		free(p_rwlock);
+	}
+	return rc;
+}
+
+/*
+ * Opens a lock file and checks it belongs to the caller alone, returns the
+ * descriptor or -1 with errno set to EPERM when it belongs to someone else
+ * (ELOOP when it is a symbolic link).
+ */
+static int lnx_lock_file_open(const char *path)
+{
+	struct stat st;
+	int fd;
+
+	// flock(..) works on read only descriptors
+	fd = open(path, O_RDONLY | O_CREAT | O_CLOEXEC | O_NOFOLLOW, LOCK_FILE_PERM);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+		st.st_uid != geteuid() || (st.st_mode & (S_IRWXG | S_IRWXO)))
+	{
+		close(fd);
+		errno = EPERM;
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * Opens the cross-process rwlock called name, returns NULL on failure.
+ * It is a lock file, the kernel drops the lock when its holder exits.
+ * Any user able to open the file could hold the lock, so it is private to
+ * its owner. A file left in the way by another user is replaced by root
+ * and refused otherwise.
+ */
+OS_PROCESS_RWLOCK *os_process_rwlock_open(const char *name)
+{
+	char path[OS_PATH_LEN];
+	int *p_fd = NULL;
+
+	if (snprintf(path, sizeof(path), "%s%s%s", LOCK_DIR, name, LOCK_FILE_EXT) >= (int)sizeof(path))
+	{
+		return NULL;
+	}
+
+	p_fd = (int *)malloc(sizeof(int));
+	if (p_fd)
+	{
+		*p_fd = lnx_lock_file_open(path);
+		if (*p_fd < 0 && (errno == EPERM || errno == ELOOP) && geteuid() == 0 && unlink(path) == 0)
+		{
+			*p_fd = lnx_lock_file_open(path);
+		}
+		if (*p_fd < 0)
+		{
+			free(p_fd);
+			p_fd = NULL;
+		}
+	}
+	return (OS_PROCESS_RWLOCK *)p_fd;
+}
+
+static int lnx_flock(OS_PROCESS_RWLOCK *p_rwlock, int operation)
+{
+	int rc;
+
+	if (!p_rwlock)
+	{
+		return 0;
+	}
+	// retry when interrupted by a signal handler
+	do
+	{
+		rc = flock(*(int *)p_rwlock, operation);
+	} while (rc != 0 && errno == EINTR);
+	return (rc == 0);
+}
+
+/*
+ * Applies a shared read-lock for the calling process
+ */
+int os_process_rwlock_r_lock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	return lnx_flock(p_rwlock, LOCK_SH);
+}
+
+/*
+ * Applies an exclusive write-lock for the calling process
+ */
+int os_process_rwlock_w_lock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	return lnx_flock(p_rwlock, LOCK_EX);
+}
+
+/*
+ * Releases the read or write lock of the calling process
+ */
+int os_process_rwlock_unlock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	return lnx_flock(p_rwlock, LOCK_UN);
+}
+
+/*
+ * Closes the rwlock, a lock still held is released. The lock file is kept,
+ * removing it would let processes lock different files under one name.
+ */
+int os_process_rwlock_close(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	int rc = 1;
+	if (p_rwlock)
+	{
+		rc = (close(*(int *)p_rwlock) == 0);
+		free(p_rwlock);
+	}
+	return rc;
+}
+
+/*
+ * Builds the POSIX shared memory object name, returns 0 if it does not fit
+ */
+static int lnx_shm_name(const char *name, char *shm_name, size_t shm_name_len)
+{
+	return (snprintf(shm_name, shm_name_len, "/%s", name) < (int)shm_name_len);
+}
+
+/*
+ * Creates the named shared memory of size zeroed bytes and maps it read-write,
+ * returns NULL on failure. An object left under the name is replaced, not
+ * reused, so processes still mapping it are not cut short.
+ */
+void *os_shm_create(const char *name, size_t size)
+{
+	char shm_name[NAME_MAX];
+	void *p_addr = NULL;
+	int fd;
+
+	if (!lnx_shm_name(name, shm_name, sizeof(shm_name)))
+	{
+		return NULL;
+	}
+	// an object left by a previous creator is replaced, one that cannot be
+	// removed (another user's) is refused, errno tells which
+	if (shm_unlink(shm_name) != 0 && errno != ENOENT)
+	{
+		return NULL;
+	}
+	fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, SHM_PERM);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	// the umask may have cut the read permissions
+	if (fchmod(fd, SHM_PERM) == 0 && ftruncate(fd, (off_t)size) == 0)
+	{
+		p_addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (p_addr == MAP_FAILED)
+		{
+			p_addr = NULL;
+		}
+	}
+	// the mapping keeps the object referenced
+	close(fd);
+	return p_addr;
+}
 
-	// failure when pthread_rwlock_destroy(..) != 0
-	return (pthread_rwlock_destroy(p_handle) == 0);
+/*
+ * Maps existing named shared memory of at least size bytes read only,
+ * returns NULL if it does not exist or is smaller. Only memory created by
+ * root or the caller and writable by its owner alone is trusted.
+ */
+const void *os_shm_open(const char *name, size_t size)
+{
+	char shm_name[NAME_MAX];
+	struct stat st;
+	void *p_addr = NULL;
+	int fd;
+
+	if (!lnx_shm_name(name, shm_name, sizeof(shm_name)))
+	{
+		return NULL;
+	}
+	fd = shm_open(shm_name, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)size &&
+		(st.st_uid == 0 || st.st_uid == geteuid()) && !(st.st_mode & (S_IWGRP | S_IWOTH)))
+	{
+		p_addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p_addr == MAP_FAILED)
+		{
+			p_addr = NULL;
+		}
+	}
+	close(fd);
+	return p_addr;
+}
+
+/*
+ * Unmaps shared memory returned by os_shm_create(..) or os_shm_open(..)
+ */
+int os_shm_close(const void *p_addr, size_t size)
+{
+	int rc = 1;
+	if (p_addr)
+	{
+		rc = (munmap((void *)p_addr, size) == 0);
+	}
+	return rc;
+}
+
+/*
+ * Maps a file read only, returns NULL if it cannot be opened or is empty
+ */
+const void *os_file_map(const char *path, size_t *p_size)
+{
+	struct stat st;
+	void *p_addr = NULL;
+	int fd;
+
+	if (!path || !p_size)
+	{
+		return NULL;
+	}
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+	{
+		p_addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p_addr == MAP_FAILED)
+		{
+			p_addr = NULL;
+		}
+		else
+		{
+			*p_size = (size_t)st.st_size;
+		}
+	}
+	// the mapping keeps the file referenced
+	close(fd);
+	return p_addr;
+}
+
+/*
+ * Unmaps a file mapped by os_file_map(..)
+ */
+int os_file_unmap(const void *p_addr, size_t size)
+{
+	int rc = 1;
+	if (p_addr)
+	{
+		rc = (munmap((void *)p_addr, size) == 0);
+	}
+	return rc;
+}
+
+/*
+ * Last modification time of a file in seconds, 0 if it does not exist
+ */
+unsigned long long os_get_file_mtime(const char *path)
+{
+	struct stat st;
+
+	if (!path || stat(path, &st) != 0)
+	{
+		return 0;
+	}
+	return (unsigned long long)st.st_mtime;
+}
+
+/*
+ * Removes the named shared memory, existing mappings stay valid
+ */
+int os_shm_remove(const char *name)
+{
+	char shm_name[NAME_MAX];
+
+	if (!lnx_shm_name(name, shm_name, sizeof(shm_name)))
+	{
+		return 0;
+	}
+	return (shm_unlink(shm_name) == 0 || errno == ENOENT);
+}
+
+/*
+ * Full memory barrier, for data shared with other processes without a lock
+ */
+void os_memory_barrier()
+{
+	__sync_synchronize();
+}
+
+struct lnx_thread
+{
+	pthread_t handle;
+	OS_THREAD_FUNC p_func;
+	void *p_arg;
+};
+
+static void *lnx_thread_start(void *p_arg)
+{
+	struct lnx_thread *p_thread = (struct lnx_thread *)p_arg;
+
+	p_thread->p_func(p_thread->p_arg);
+	return NULL;
+}
+
+/*
+ * Starts a thread running p_func(p_arg), returns NULL on failure
+ */
+OS_THREAD *os_thread_create(OS_THREAD_FUNC p_func, void *p_arg)
+{
+	struct lnx_thread *p_thread = (struct lnx_thread *)malloc(sizeof(struct lnx_thread));
+
+	if (p_thread)
+	{
+		p_thread->p_func = p_func;
+		p_thread->p_arg = p_arg;
+		// failure when pthread_create(..) != 0
+		if (pthread_create(&p_thread->handle, NULL, lnx_thread_start, p_thread) != 0)
+		{
+			free(p_thread);
+			p_thread = NULL;
+		}
+	}
+	return (OS_THREAD *)p_thread;
+}
+
+/*
+ * Waits for a thread to finish and releases it
+ */
+int os_thread_join(OS_THREAD *p_thread)
+{
+	int rc = 0;
+	if (p_thread)
+	{
+		// failure when pthread_join(..) != 0
+		rc = (pthread_join(((struct lnx_thread *)p_thread)->handle, NULL) == 0);
+		free(p_thread);
+	}
+	return rc;
+}
+
+/*
+ * Returns the number of online processors, at least 1
+ */
+int os_get_cpu_count()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (count > 0) ? (int)count : 1;
+}
+
+#define	ONCE_RUNNING	1
+#define	ONCE_DONE	2
+
+/*
+ * Runs p_func exactly once per once control, concurrent callers return after it has completed
+ */
+void os_once(OS_ONCE *p_once, OS_ONCE_FUNC p_func)
+{
+	if (__sync_bool_compare_and_swap(p_once, OS_ONCE_INIT, ONCE_RUNNING))
+	{
+		p_func();
+		// full barrier, everything p_func wrote is visible before the done state
+		__sync_synchronize();
+		*p_once = ONCE_DONE;
+		return;
+	}
+	while (__sync_fetch_and_add(p_once, 0) != ONCE_DONE)
+	{
+		sched_yield();
+	}
+}
+
+/*
+ * Returns the id of the calling process
+ */
+unsigned int os_get_pid()
+{
+	return (unsigned int)getpid();
+}
+
+/*
+ * Returns milliseconds of a clock that only moves forward and is the same for
+ * every process of the system, 0 on failure
+ */
+unsigned long long os_get_monotonic_ms()
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+	{
+		return 0;
+	}
+	return (unsigned long long)ts.tv_sec * 1000 + (unsigned long long)ts.tv_nsec / 1000000;
+}
+
+/*
+ * Returns microseconds of the clock of os_get_monotonic_ms(..)
+ */
+unsigned long long os_get_monotonic_us()
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+	{
+		return 0;
+	}
+	return (unsigned long long)ts.tv_sec * 1000000 + (unsigned long long)ts.tv_nsec / 1000;
+}
+
+/*
+ * Adds add to *p_value atomically and returns the new value, an add of 0 reads it
+ */
+unsigned long long os_atomic_add64(volatile unsigned long long *p_value, unsigned long long add)
+{
+	return __sync_add_and_fetch(p_value, add);
+}
+
+/*
+ * Creates a process private counting semaphore, returns NULL on failure
+ */
+OS_SEMAPHORE *os_sem_create(unsigned int count)
+{
+	sem_t *p_sem = (sem_t *)malloc(sizeof(sem_t));
+
+	if (p_sem)
+	{
+		// failure when sem_init(..) != 0
+		if (sem_init(p_sem, 0, count) != 0)
+		{
+			free(p_sem);
+			p_sem = NULL;
+		}
+	}
+	return (OS_SEMAPHORE *)p_sem;
+}
+
+/*
+ * Decrements the semaphore, blocking while it is zero
+ */
+int os_sem_wait(OS_SEMAPHORE *p_sem)
+{
+	int rc;
+
+	// retry when interrupted by a signal handler
+	do
+	{
+		rc = sem_wait((sem_t *)p_sem);
+	} while (rc != 0 && errno == EINTR);
+	return (rc == 0);
+}
+
+/*
+ * Decrements the semaphore, blocking while it is zero for at most timeout_ms.
+ * Returns 0 on timeout.
+ */
+int os_sem_timed_wait(OS_SEMAPHORE *p_sem, unsigned long long timeout_ms)
+{
+	struct timespec ts;
+	int rc;
+
+	// sem_timedwait(..) only takes a deadline on the realtime clock
+	if (clock_gettime(CLOCK_REALTIME, &ts) != 0)
+	{
+		return 0;
+	}
+	ts.tv_sec += (time_t)(timeout_ms / 1000);
+	ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+	do
+	{
+		rc = sem_timedwait((sem_t *)p_sem, &ts);
+	} while (rc != 0 && errno == EINTR);
+	return (rc == 0);
+}
+
+/*
+ * Increments the semaphore, waking one waiter
+ */
+int os_sem_post(OS_SEMAPHORE *p_sem)
+{
+	return (sem_post((sem_t *)p_sem) == 0);
+}
+
+/*
+ * Destroys a semaphore no thread is waiting on
+ */
+int os_sem_delete(OS_SEMAPHORE *p_sem)
+{
+	int rc = 0;
+	if (p_sem)
+	{
+		rc = (sem_destroy((sem_t *)p_sem) == 0);
+		free(p_sem);
+	}
+	return rc;
 }
 
 /*
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Writer and reader of the on-disk health history, see nvm_history.h.
+ *
+ * Every number in the file is little endian. Block layouts:
+ *
+ * file header (block 0)
+ *   0  magic, version, block size, index stride, field count (5 x u32)
+ *
+ * data block
+ *   0  magic (u32), rows (u16), field count (u8), reserved (u8)
+ *   8  uid (NVM_HISTORY_UID_LEN bytes, NUL padded), 2 bytes padding
+ *  32  width of each column in bytes (u8 x HISTORY_FIELD_COUNT)
+ *  48  values of the first row (u64 x HISTORY_FIELD_COUNT)
+ * 176  time of the last row (u64)
+ * 184  the columns, each holding capacity signed deltas of its width
+ *
+ * index block
+ *   0  magic (u32), entries (u32)
+ *   8  per preceding data block: uid (NVM_HISTORY_UID_LEN bytes), 2 bytes
+ *      padding, time of the first row (u64), 8 bytes reserved
+ */
+
+#include "nvm_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HISTORY_DATA_MAGIC      0x41544448  // "HDTA"
+#define HISTORY_INDEX_MAGIC     0x58444948  // "HIDX"
+#define HISTORY_FILE_HEADER     20
+#define HISTORY_ROWS            4
+#define HISTORY_FIELDS          6
+#define HISTORY_UID             8
+#define HISTORY_WIDTHS          32
+#define HISTORY_BASE            (HISTORY_WIDTHS + HISTORY_FIELD_COUNT)
+#define HISTORY_LAST_TIME       (HISTORY_BASE + 8 * HISTORY_FIELD_COUNT)
+#define HISTORY_COLUMNS         (HISTORY_LAST_TIME + 8)
+#define HISTORY_INDEX_ENTRIES   8
+#define HISTORY_INDEX_ENTRY     32
+#define HISTORY_INDEX_TIME      24
+#define HISTORY_MAX_WIDTH       8
+
+// an index block has to hold an entry for every data block it covers
+typedef char history_index_fits[(HISTORY_INDEX_ENTRIES + NVM_HISTORY_INDEX_STRIDE * HISTORY_INDEX_ENTRY
+  <= NVM_HISTORY_BLOCK_SIZE) ? 1 : -1];
+
+/*
+ * Widths of the first block of a PMem module, before any delta was seen
+ */
+static const unsigned char g_default_widths[HISTORY_FIELD_COUNT] = {
+  2, 1, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 4, 4, 4, 4
+};
+
+/*
+ * Block being filled for one PMem module
+ */
+struct history_block {
+  char uid[NVM_HISTORY_UID_LEN + 1];
+  long number;                                      // position in the file
+  unsigned int rows;                                // rows stored, the first one in full
+  unsigned int capacity;                            // deltas each column holds
+  unsigned int offsets[HISTORY_FIELD_COUNT];        // column offsets from HISTORY_COLUMNS
+  unsigned char needed[HISTORY_FIELD_COUNT];        // widths the deltas so far needed
+  unsigned long long last[HISTORY_FIELD_COUNT];     // values of the last row
+  unsigned char data[NVM_HISTORY_BLOCK_SIZE];
+};
+
+struct history_writer {
+  FILE *p_file;
+  long blocks;                                      // blocks in the file
+  unsigned int count;                               // entries used in p_blocks
+  struct history_block *p_blocks[NVM_HISTORY_MAX_DIMMS];
+};
+
+static void put_le(unsigned char *p_data, unsigned long long value, unsigned int width)
+{
+  unsigned int i;
+
+  for (i = 0; i < width; i++) {
+    p_data[i] = (unsigned char)(value >> (8 * i));
+  }
+}
+
+static unsigned long long get_le(const unsigned char *p_data, unsigned int width)
+{
+  unsigned long long value = 0;
+  unsigned int i;
+
+  for (i = 0; i < width; i++) {
+    value |= (unsigned long long)p_data[i] << (8 * i);
+  }
+  return value;
+}
+
+/*
+ * Reads a delta of width bytes, sign extended
+ */
+static unsigned long long get_delta(const unsigned char *p_data, unsigned int width)
+{
+  unsigned long long value = get_le(p_data, width);
+  unsigned long long sign = 1ULL << (8 * width - 1);
+
+  return (value ^ sign) - sign;
+}
+
+/*
+ * Returns the smallest column width holding the signed delta
+ */
+static unsigned char delta_width(unsigned long long delta)
+{
+  long long signed_delta = (long long)delta;
+
+  if (signed_delta >= -0x80LL && signed_delta < 0x80LL) {
+    return 1;
+  }
+  if (signed_delta >= -0x8000LL && signed_delta < 0x8000LL) {
+    return 2;
+  }
+  if (signed_delta >= -0x80000000LL && signed_delta < 0x80000000LL) {
+    return 4;
+  }
+  return 8;
+}
+
+/*
+ * Lays out the columns of a data block from its widths and returns how many
+ * deltas each column holds
+ */
+static unsigned int block_layout(const unsigned char *p_widths, unsigned int *p_offsets)
+{
+  unsigned int row_size = 0;
+  unsigned int capacity = 0;
+  int field;
+
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    if (1 != p_widths[field] && 2 != p_widths[field] && 4 != p_widths[field] &&
+        HISTORY_MAX_WIDTH != p_widths[field]) {
+      return 0;
+    }
+    row_size += p_widths[field];
+  }
+  capacity = (NVM_HISTORY_BLOCK_SIZE - HISTORY_COLUMNS) / row_size;
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    p_offsets[field] = (0 == field) ? 0 : p_offsets[field - 1] + capacity * p_widths[field - 1];
+  }
+  return capacity;
+}
+
+static int read_block(FILE *p_file, long number, unsigned char *p_data, size_t size)
+{
+  if (0 != fseek(p_file, number * NVM_HISTORY_BLOCK_SIZE, SEEK_SET) ||
+      size != fread(p_data, 1, size, p_file)) {
+    return -1;
+  }
+  return 0;
+}
+
+static int write_block(FILE *p_file, long number, const unsigned char *p_data)
+{
+  if (0 != fseek(p_file, number * NVM_HISTORY_BLOCK_SIZE, SEEK_SET) ||
+      NVM_HISTORY_BLOCK_SIZE != fwrite(p_data, 1, NVM_HISTORY_BLOCK_SIZE, p_file) ||
+      0 != fflush(p_file)) {
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * Checks the file header and returns the number of whole blocks in the file,
+ * -1 if it is not a history of this version
+ */
+static long check_file(FILE *p_file)
+{
+  unsigned char header[HISTORY_FILE_HEADER];
+  long size;
+
+  if (0 != read_block(p_file, 0, header, sizeof(header)) ||
+      NVM_HISTORY_MAGIC != get_le(header, 4) ||
+      NVM_HISTORY_VERSION != get_le(header + 4, 4) ||
+      NVM_HISTORY_BLOCK_SIZE != get_le(header + 8, 4) ||
+      NVM_HISTORY_INDEX_STRIDE != get_le(header + 12, 4) ||
+      HISTORY_FIELD_COUNT != get_le(header + 16, 4) ||
+      0 != fseek(p_file, 0, SEEK_END) || 0 > (size = ftell(p_file))) {
+    return -1;
+  }
+  // a block cut short by a crash is overwritten by the next one
+  return size / NVM_HISTORY_BLOCK_SIZE;
+}
+
+static int is_index_block(long number)
+{
+  return 0 < number && 0 == number % (NVM_HISTORY_INDEX_STRIDE + 1);
+}
+
+/*
+ * Writes the index block at number from the headers of the data blocks before it
+ */
+static int write_index(FILE *p_file, long number)
+{
+  unsigned char index[NVM_HISTORY_BLOCK_SIZE];
+  unsigned char header[HISTORY_COLUMNS];
+  unsigned char *p_entry = NULL;
+  int i;
+
+  memset(index, 0, sizeof(index));
+  put_le(index, HISTORY_INDEX_MAGIC, 4);
+  put_le(index + 4, NVM_HISTORY_INDEX_STRIDE, 4);
+  for (i = 0; i < NVM_HISTORY_INDEX_STRIDE; i++) {
+    p_entry = index + HISTORY_INDEX_ENTRIES + i * HISTORY_INDEX_ENTRY;
+    // an unreadable block keeps an empty uid and is never a candidate
+    if (0 == read_block(p_file, number - NVM_HISTORY_INDEX_STRIDE + i, header, sizeof(header)) &&
+        HISTORY_DATA_MAGIC == get_le(header, 4)) {
+      memcpy(p_entry, header + HISTORY_UID, NVM_HISTORY_UID_LEN);
+      memcpy(p_entry + HISTORY_INDEX_TIME, header + HISTORY_BASE + 8 * HISTORY_TIME, 8);
+    }
+  }
+  return write_block(p_file, number, index);
+}
+
+unsigned long long history_now(void)
+{
+  return (unsigned long long)time(NULL);
+}
+
+struct history_writer *history_open(const char *path)
+{
+  struct history_writer *p_writer = NULL;
+  unsigned char header[NVM_HISTORY_BLOCK_SIZE];
+
+  if (NULL == path || NULL == (p_writer = (struct history_writer *)calloc(1, sizeof(*p_writer)))) {
+    return NULL;
+  }
+  if (NULL == (p_writer->p_file = fopen(path, "r+b")) && NULL == (p_writer->p_file = fopen(path, "w+b"))) {
+    free(p_writer);
+    return NULL;
+  }
+  if (0 == fseek(p_writer->p_file, 0, SEEK_END) && 0 == ftell(p_writer->p_file)) {
+    memset(header, 0, sizeof(header));
+    put_le(header, NVM_HISTORY_MAGIC, 4);
+    put_le(header + 4, NVM_HISTORY_VERSION, 4);
+    put_le(header + 8, NVM_HISTORY_BLOCK_SIZE, 4);
+    put_le(header + 12, NVM_HISTORY_INDEX_STRIDE, 4);
+    put_le(header + 16, HISTORY_FIELD_COUNT, 4);
+    if (0 != write_block(p_writer->p_file, 0, header)) {
+      history_close(p_writer);
+      return NULL;
+    }
+  }
+  // a history written by another version is left alone rather than mixed with
+  if (0 >= (p_writer->blocks = check_file(p_writer->p_file))) {
+    history_close(p_writer);
+    return NULL;
+  }
+  return p_writer;
+}
+
+/*
+ * Returns the open block of uid, a new one without rows if it has none yet
+ */
+static struct history_block *find_block(struct history_writer *p_writer, const char *uid)
+{
+  struct history_block *p_block = NULL;
+  unsigned int i;
+
+  for (i = 0; i < p_writer->count; i++) {
+    if (0 == strncmp(p_writer->p_blocks[i]->uid, uid, NVM_HISTORY_UID_LEN)) {
+      return p_writer->p_blocks[i];
+    }
+  }
+  if (NVM_HISTORY_MAX_DIMMS <= p_writer->count ||
+      NULL == (p_block = (struct history_block *)calloc(1, sizeof(*p_block)))) {
+    return NULL;
+  }
+  // rows written before a restart stay in their blocks, the PMem module starts a new one
+  strncpy(p_block->uid, uid, NVM_HISTORY_UID_LEN);
+  memcpy(p_block->needed, g_default_widths, sizeof(p_block->needed));
+  p_writer->p_blocks[p_writer->count++] = p_block;
+  return p_block;
+}
+
+/*
+ * Starts a new block for p_block holding p_values as its first row. The
+ * columns are as wide as the deltas of the previous block needed.
+ */
+static int start_block(struct history_writer *p_writer, struct history_block *p_block,
+  const unsigned long long *p_values)
+{
+  unsigned char *p_widths = p_block->data + HISTORY_WIDTHS;
+  int field;
+
+  if (is_index_block(p_writer->blocks)) {
+    if (0 != write_index(p_writer->p_file, p_writer->blocks)) {
+      return -1;
+    }
+    p_writer->blocks++;
+  }
+
+  memset(p_block->data, 0, sizeof(p_block->data));
+  put_le(p_block->data, HISTORY_DATA_MAGIC, 4);
+  put_le(p_block->data + HISTORY_ROWS, 1, 2);
+  p_block->data[HISTORY_FIELDS] = HISTORY_FIELD_COUNT;
+  memcpy(p_block->data + HISTORY_UID, p_block->uid, strlen(p_block->uid));
+  memcpy(p_widths, p_block->needed, HISTORY_FIELD_COUNT);
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    put_le(p_block->data + HISTORY_BASE + 8 * field, p_values[field], 8);
+    p_block->needed[field] = 1;
+  }
+  put_le(p_block->data + HISTORY_LAST_TIME, p_values[HISTORY_TIME], 8);
+  p_block->capacity = block_layout(p_widths, p_block->offsets);
+  p_block->number = p_writer->blocks++;
+  p_block->rows = 1;
+  memcpy(p_block->last, p_values, sizeof(p_block->last));
+  return write_block(p_writer->p_file, p_block->number, p_block->data);
+}
+
+int history_append(struct history_writer *p_writer, const char *uid, const unsigned long long *p_values)
+{
+  struct history_block *p_block = NULL;
+  const unsigned char *p_widths = NULL;
+  unsigned long long deltas[HISTORY_FIELD_COUNT];
+  unsigned char widths[HISTORY_FIELD_COUNT];
+  unsigned char *p_cell = NULL;
+  int fits = 1;
+  int field;
+
+  if (NULL == p_writer || NULL == uid || NULL == p_values ||
+      NULL == (p_block = find_block(p_writer, uid))) {
+    return -1;
+  }
+  if (0 == p_block->rows) {
+    return start_block(p_writer, p_block, p_values);
+  }
+
+  p_widths = p_block->data + HISTORY_WIDTHS;
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    deltas[field] = p_values[field] - p_block->last[field];
+    widths[field] = delta_width(deltas[field]);
+    if (widths[field] > p_widths[field]) {
+      fits = 0;
+    }
+  }
+  // the next block sizes its columns for the deltas that did not fit either
+  if (!fits || p_block->rows > p_block->capacity) {
+    for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+      if (widths[field] > p_block->needed[field]) {
+        p_block->needed[field] = widths[field];
+      }
+    }
+    return start_block(p_writer, p_block, p_values);
+  }
+
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    p_cell = p_block->data + HISTORY_COLUMNS + p_block->offsets[field] + (p_block->rows - 1) * p_widths[field];
+    put_le(p_cell, deltas[field], p_widths[field]);
+    if (widths[field] > p_block->needed[field]) {
+      p_block->needed[field] = widths[field];
+    }
+  }
+  p_block->rows++;
+  put_le(p_block->data + HISTORY_ROWS, p_block->rows, 2);
+  put_le(p_block->data + HISTORY_LAST_TIME, p_values[HISTORY_TIME], 8);
+  memcpy(p_block->last, p_values, sizeof(p_block->last));
+  return write_block(p_writer->p_file, p_block->number, p_block->data);
+}
+
+void history_close(struct history_writer *p_writer)
+{
+  unsigned int i;
+
+  if (NULL == p_writer) {
+    return;
+  }
+  for (i = 0; i < p_writer->count; i++) {
+    free(p_writer->p_blocks[i]);
+  }
+  if (NULL != p_writer->p_file) {
+    fclose(p_writer->p_file);
+  }
+  free(p_writer);
+}
+
+/*
+ * State of a query
+ */
+struct history_scan {
+  FILE *p_file;
+  const char *uid;
+  unsigned long long from;
+  unsigned long long to;
+  NVM_HISTORY_VISIT p_visit;
+  void *p_ctx;
+  long pending;                 // candidate block not decoded yet, 0 if none
+  int done;                     // nothing more to visit
+  unsigned char index[NVM_HISTORY_BLOCK_SIZE];
+  unsigned char data[NVM_HISTORY_BLOCK_SIZE];
+};
+
+/*
+ * Visits the rows of a data block within the time range
+ */
+static void decode_block(struct history_scan *p_scan, long number)
+{
+  unsigned char *p_data = p_scan->data;
+  unsigned long long values[HISTORY_FIELD_COUNT];
+  unsigned int offsets[HISTORY_FIELD_COUNT];
+  char uid[NVM_HISTORY_UID_LEN + 1];
+  unsigned int capacity;
+  unsigned int rows;
+  unsigned int row;
+  int field;
+
+  if (0 != read_block(p_scan->p_file, number, p_data, NVM_HISTORY_BLOCK_SIZE) ||
+      HISTORY_DATA_MAGIC != get_le(p_data, 4) || HISTORY_FIELD_COUNT != p_data[HISTORY_FIELDS] ||
+      0 == (capacity = block_layout(p_data + HISTORY_WIDTHS, offsets))) {
+    return;
+  }
+  rows = (unsigned int)get_le(p_data + HISTORY_ROWS, 2);
+  if (rows > capacity + 1) {
+    rows = capacity + 1;
+  }
+  memset(uid, 0, sizeof(uid));
+  memcpy(uid, p_data + HISTORY_UID, NVM_HISTORY_UID_LEN);
+  for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+    values[field] = get_le(p_data + HISTORY_BASE + 8 * field, 8);
+  }
+
+  for (row = 0; row < rows; row++) {
+    if (0 < row) {
+      for (field = 0; field < HISTORY_FIELD_COUNT; field++) {
+        values[field] += get_delta(p_data + HISTORY_COLUMNS + offsets[field] +
+          (row - 1) * p_data[HISTORY_WIDTHS + field], p_data[HISTORY_WIDTHS + field]);
+      }
+    }
+    if (values[HISTORY_TIME] > p_scan->to) {
+      break;
+    }
+    if (values[HISTORY_TIME] >= p_scan->from && 0 == p_scan->p_visit(uid, values, p_scan->p_ctx)) {
+      p_scan->done = 1;
+      return;
+    }
+  }
+}
+
+/*
+ * Takes in a data block in file order. Rows of a PMem module never go back
+ * in time across its blocks, so a candidate is only decoded once the next
+ * block of the same PMem module shows it may reach into the range.
+ */
+static void consider_block(struct history_scan *p_scan, long number, const char *p_uid,
+  unsigned long long first_time)
+{
+  if (NULL != p_scan->uid && 0 != strncmp(p_uid, p_scan->uid, NVM_HISTORY_UID_LEN)) {
+    return;
+  }
+  if ('\0' == p_uid[0] || p_scan->done) {
+    return;
+  }
+  if (0 != p_scan->pending && (NULL == p_scan->uid || first_time >= p_scan->from)) {
+    decode_block(p_scan, p_scan->pending);
+  }
+  p_scan->pending = 0;
+  if (first_time > p_scan->to) {
+    // every later block of the PMem module is later still
+    p_scan->done = (NULL != p_scan->uid);
+    return;
+  }
+  p_scan->pending = number;
+}
+
+int history_query(const char *path, const char *uid, unsigned long long from, unsigned long long to,
+  NVM_HISTORY_VISIT p_visit, void *p_ctx)
+{
+  struct history_scan *p_scan = NULL;
+  unsigned char header[HISTORY_COLUMNS];
+  char entry_uid[NVM_HISTORY_UID_LEN + 1];
+  const unsigned char *p_entry = NULL;
+  unsigned int entries;
+  unsigned int i;
+  long blocks;
+  long first;
+  long number;
+  int rc = -1;
+
+  if (NULL == path || NULL == p_visit ||
+      NULL == (p_scan = (struct history_scan *)calloc(1, sizeof(*p_scan)))) {
+    return -1;
+  }
+  if (NULL == (p_scan->p_file = fopen(path, "rb")) || 0 > (blocks = check_file(p_scan->p_file))) {
+    goto Finish;
+  }
+  p_scan->uid = uid;
+  p_scan->from = from;
+  p_scan->to = to;
+  p_scan->p_visit = p_visit;
+  p_scan->p_ctx = p_ctx;
+  memset(entry_uid, 0, sizeof(entry_uid));
+
+  for (first = 1; first < blocks && !p_scan->done; first += NVM_HISTORY_INDEX_STRIDE + 1) {
+    number = first + NVM_HISTORY_INDEX_STRIDE;
+    if (number < blocks && 0 == read_block(p_scan->p_file, number, p_scan->index, NVM_HISTORY_BLOCK_SIZE) &&
+        HISTORY_INDEX_MAGIC == get_le(p_scan->index, 4) &&
+        NVM_HISTORY_INDEX_STRIDE >= (entries = (unsigned int)get_le(p_scan->index + 4, 4))) {
+      for (i = 0; i < entries && !p_scan->done; i++) {
+        p_entry = p_scan->index + HISTORY_INDEX_ENTRIES + i * HISTORY_INDEX_ENTRY;
+        memcpy(entry_uid, p_entry, NVM_HISTORY_UID_LEN);
+        consider_block(p_scan, first + i, entry_uid, get_le(p_entry + HISTORY_INDEX_TIME, 8));
+      }
+      continue;
+    }
+    // the blocks past the last index block are looked at one header at a time
+    for (number = first; number < blocks && number < first + NVM_HISTORY_INDEX_STRIDE && !p_scan->done;
+        number++) {
+      if (0 == read_block(p_scan->p_file, number, header, sizeof(header)) &&
+          HISTORY_DATA_MAGIC == get_le(header, 4)) {
+        memcpy(entry_uid, header + HISTORY_UID, NVM_HISTORY_UID_LEN);
+        consider_block(p_scan, number, entry_uid, get_le(header + HISTORY_BASE + 8 * HISTORY_TIME, 8));
+      }
+    }
+  }
+  if (0 != p_scan->pending && !p_scan->done) {
+    decode_block(p_scan, p_scan->pending);
+  }
+  rc = 0;
+
+Finish:
+  if (NULL != p_scan->p_file) {
+    fclose(p_scan->p_file);
+  }
+  free(p_scan);
+  return rc;
+}
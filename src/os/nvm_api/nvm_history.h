@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * On-disk health history of the PMem modules, appended by the ipmctld daemon.
+ *
+ * The file is a sequence of fixed-size blocks. Block 0 holds the file header.
+ * Every other block either holds rows of one PMem module or, every
+ * NVM_HISTORY_INDEX_STRIDE + 1 blocks, indexes the data blocks before it.
+ * A data block stores the full values of its first row, then one column per
+ * field holding each following row as a delta from the row before it. The
+ * column widths are chosen per block from the deltas seen in the previous
+ * block of the same PMem module, so slowly moving fields cost a byte a row.
+ *
+ * Queries read the index blocks and only the data blocks of the requested
+ * PMem module that overlap the requested time range, never the whole file.
+ * The writer only ever rewrites the last open block of each PMem module, so
+ * the rest of the file is stable for readers while the daemon runs.
+ */
+
+#ifndef NVM_HISTORY_H_
+#define NVM_HISTORY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __linux__
+#define NVM_HISTORY_FILE            "/var/log/ipmctl/ipmctl_history.dat"
+#else
+#define NVM_HISTORY_FILE            "ipmctl_history.dat"
+#endif
+#define NVM_HISTORY_MAGIC           0x54534948  // "HIST"
+#define NVM_HISTORY_VERSION         1           // bump on any layout change
+#define NVM_HISTORY_BLOCK_SIZE      4096
+#define NVM_HISTORY_INDEX_STRIDE    64          // data blocks indexed by one index block
+#define NVM_HISTORY_UID_LEN         22          // same as NVM_MAX_UID_LEN
+#define NVM_HISTORY_MAX_DIMMS       128         // PMem modules with a block open in the writer
+
+/*
+ * Columns of a history row
+ */
+enum history_field {
+  HISTORY_TIME = 0,                     ///< Seconds since the epoch
+  HISTORY_VALID,                        ///< HISTORY_VALID_* bits of the groups read successfully
+  HISTORY_HEALTH,                       ///< Reading of SENSOR_HEALTH
+  HISTORY_MEDIA_TEMPERATURE,            ///< Celsius, signed
+  HISTORY_CONTROLLER_TEMPERATURE,       ///< Celsius, signed
+  HISTORY_PERCENTAGE_REMAINING,
+  HISTORY_POWER_ON_TIME,                ///< Seconds
+  HISTORY_UPTIME,                       ///< Seconds
+  HISTORY_POWER_CYCLES,
+  HISTORY_LATCHED_DIRTY_SHUTDOWNS,
+  HISTORY_UNLATCHED_DIRTY_SHUTDOWNS,
+  HISTORY_FW_ERROR_LOG_ENTRIES,
+  HISTORY_MEDIA_READS,                  ///< Lifetime 64-byte media reads
+  HISTORY_MEDIA_WRITES,                 ///< Lifetime 64-byte media writes
+  HISTORY_READ_REQUESTS,                ///< Lifetime DDRT read transactions
+  HISTORY_WRITE_REQUESTS,               ///< Lifetime DDRT write transactions
+  HISTORY_FIELD_COUNT
+};
+
+#define HISTORY_VALID_SENSORS       0x1   ///< HISTORY_HEALTH to HISTORY_FW_ERROR_LOG_ENTRIES are set
+#define HISTORY_VALID_PERFORMANCE   0x2   ///< HISTORY_MEDIA_READS to HISTORY_WRITE_REQUESTS are set
+
+/*
+ * Called for every row a query finds, in time order for each PMem module.
+ * Returns 0 to stop the query.
+ */
+typedef int (*NVM_HISTORY_VISIT)(const char *uid, const unsigned long long *p_values, void *p_ctx);
+
+struct history_writer;
+
+/*
+ * Returns the current time as recorded in HISTORY_TIME
+ */
+unsigned long long history_now(void);
+
+/*
+ * Opens the history at path for appending, creating it if needed.
+ * Returns NULL if the file cannot be opened or is not a history of this version.
+ */
+struct history_writer *history_open(const char *path);
+
+/*
+ * Appends a row of HISTORY_FIELD_COUNT values for the PMem module uid and
+ * flushes it to the file. Rows of a PMem module are expected in time order.
+ * Returns 0 on success.
+ */
+int history_append(struct history_writer *p_writer, const char *uid, const unsigned long long *p_values);
+
+/*
+ * Closes a history opened with history_open(), p_writer may be NULL
+ */
+void history_close(struct history_writer *p_writer);
+
+/*
+ * Calls p_visit for each row of the history at path taken from time from to
+ * time to, both included. Only the rows of uid are visited unless it is NULL.
+ * Returns 0 on success, -1 if there is no readable history at path.
+ */
+int history_query(const char *path, const char *uid, unsigned long long from, unsigned long long to,
+  NVM_HISTORY_VISIT p_visit, void *p_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVM_HISTORY_H_ */
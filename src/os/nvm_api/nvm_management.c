@@ -9,6 +9,7 @@
 
 #include "nvm_management.h"
 #include "nvm_output_parsing.h"
+#include "nvm_telemetry.h"
 #include <Uefi.h>
 #include <Library/UefiApplicationEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
@@ -35,29 +36,58 @@
 #include <os.h>
 #include <Dimm.h>
 #include <NvmDimmDriver.h>
+#include <StartupProfile.h>
 #include <s_str.h>
 #include <wchar.h>
 #include <CommandParser.h>
 #include <ShellParameters.h>
 #include "LoadCommand.h"
+#include <PerformanceSampler.h>
 #include <os_str.h>
 
 #define STRINGIZE2(s) #s
 #define STRINGIZE(s) STRINGIZE2(s)
 #define VERSION_STR STRINGIZE(__VERSION_NUMBER__)
-#define NVM_API_MUTEX "nvm_api"
+#define NVM_API_LOCK_NAME "ipmctl_api"  // lock file shared by all library users
 
 #define INVALID_DIMM_HANDLE     0
-OS_MUTEX *g_api_mutex;
-unsigned int g_dimm_cnt;
+
+// API lock modes, see api_lock()
+#define API_LOCK_SHARED         0
+#define API_LOCK_EXCLUSIVE      1
+
+/*
+ * Immutable DIMM inventory shared by concurrent API callers. A snapshot is
+ * published by swapping g_inventory, readers hold a reference for as long
+ * as they use it, so replacing it never pulls the data from under them.
+ */
+typedef struct _NVM_INVENTORY {
+  unsigned int refs;            //!< references, guarded by g_inventory_mutex
+  unsigned int dimm_cnt;        //!< number of entries in p_dimms
+  DIMM_INFO_CORE *p_dimms;      //!< identity of every DIMM
+} NVM_INVENTORY;
+
 int g_basic_commands = 0;
-DIMM_INFO *g_dimms;
+static OS_ONCE g_api_locks_once = OS_ONCE_INIT;
+static OS_RWLOCK *g_api_rwlock;         // shared for queries, exclusive for config changes
+static OS_PROCESS_RWLOCK *g_api_process_rwlock; // the same split between processes, NULL if unavailable
+static OS_MUTEX *g_api_readers_mutex;   // guards g_api_readers
+static unsigned int g_api_readers;      // threads holding the process lock shared
+static OS_MUTEX *g_init_mutex;          // serializes library init and uninit
+static OS_MUTEX *g_inventory_mutex;     // guards g_inventory and the snapshot refs
+static NVM_INVENTORY *g_inventory;
+static OS_THREAD_LOCAL int g_api_lock_depth;  // nested API calls run under the outer lock
+static OS_THREAD_LOCAL int g_api_lock_mode;
+static OS_THREAD_LOCAL int g_api_process_lock_mode;
 int get_dimm_id(const char *uid, UINT16 *dimm_id, unsigned int *dimm_handle);
+static void inventory_invalidate();
 void dimm_info_to_device_discovery(DIMM_INFO *p_dimm, struct device_discovery *p_device);
 int g_nvm_initialized = 0;
 int get_fw_err_log_stats(const unsigned int dimm_id, const unsigned char log_level, const unsigned char log_type, LOG_INFO_DATA_RETURN *log_info);
 static int nvm_internal_init(BOOLEAN binding_start);
 static void nvm_internal_uninit(BOOLEAN binding_stop);
+static int nvm_internal_get_sensors(const NVM_UID device_uid, struct sensor *p_sensors, const NVM_UINT16 count);
+static int nvm_internal_get_jobs(struct job *p_jobs, const NVM_UINT32 count);
 
 extern EFI_SHELL_PARAMETERS_PROTOCOL gOsShellParametersProtocol;
 extern NVMDIMMDRIVER_DATA *gNvmDimmData;
@@ -79,10 +109,273 @@ ParseSourceDumpFile(IN CHAR16 *pFilePath, IN EFI_DEVICE_PATH_PROTOCOL *pDevicePa
 extern EFI_STATUS RegisterCommands();
 extern int g_fast_path;
 
+/*
+ * Creates the process private locks of the API, once per process
+ */
+static void api_locks_create(void)
+{
+  g_api_rwlock = os_rwlock_create();
+  g_api_readers_mutex = os_mutex_init(NULL);
+  g_init_mutex = os_mutex_init(NULL);
+  g_inventory_mutex = os_mutex_init(NULL);
+
+  // Without the lock file (e.g. no permission to create it) only the threads
+  // of this process are coordinated
+  if (NULL == (g_api_process_rwlock = os_process_rwlock_open(NVM_API_LOCK_NAME))) {
+    NVDIMM_WARN("Failed to open the " NVM_API_LOCK_NAME " lock, other processes are not excluded\n");
+  }
+}
+
+/*
+ * Takes the process lock once the thread holds the API lock. Processes hold
+ * it shared while any of their threads does, exclusive while one thread owns
+ * the API lock.
+ */
+static void api_process_lock(int mode)
+{
+  if (NULL == g_api_process_rwlock) {
+    return;
+  }
+
+  if (API_LOCK_EXCLUSIVE == mode) {
+    os_process_rwlock_w_lock(g_api_process_rwlock);
+    return;
+  }
+
+  os_mutex_lock(g_api_readers_mutex);
+  if (0 == g_api_readers++) {
+    os_process_rwlock_r_lock(g_api_process_rwlock);
+  }
+  os_mutex_unlock(g_api_readers_mutex);
+}
+
+static void api_process_unlock(int mode)
+{
+  if (NULL == g_api_process_rwlock) {
+    return;
+  }
+
+  if (API_LOCK_EXCLUSIVE == mode) {
+    os_process_rwlock_unlock(g_api_process_rwlock);
+    return;
+  }
+
+  os_mutex_lock(g_api_readers_mutex);
+  if (0 == --g_api_readers) {
+    os_process_rwlock_unlock(g_api_process_rwlock);
+  }
+  os_mutex_unlock(g_api_readers_mutex);
+}
+
+/*
+ * Takes the API lock for the calling thread, in mode among the threads of
+ * this process and in process_mode among processes. A nested API call runs
+ * under the locks its outermost caller took, an exclusive call cannot run
+ * under a shared one and fails.
+ */
+static int api_lock_modes(int mode, int process_mode)
+{
+  os_once(&g_api_locks_once, api_locks_create);
+  if (NULL == g_api_rwlock || NULL == g_api_readers_mutex || NULL == g_init_mutex || NULL == g_inventory_mutex) {
+    NVDIMM_ERR("Failed to intialize NVM API locks\n");
+    return NVM_ERR_UNKNOWN;
+  }
+
+  if (0 < g_api_lock_depth) {
+    if (API_LOCK_EXCLUSIVE == mode && API_LOCK_SHARED == g_api_lock_mode) {
+      NVDIMM_ERR("Exclusive API call nested in a shared one\n");
+      return NVM_ERR_OPERATION_NOT_SUPPORTED;
+    }
+    g_api_lock_depth++;
+    return NVM_SUCCESS;
+  }
+
+  g_api_lock_depth++;
+
+  g_api_lock_mode = mode;
+  g_api_process_lock_mode = process_mode;
+  if (API_LOCK_EXCLUSIVE == mode) {
+    os_rwlock_w_lock(g_api_rwlock);
+  } else {
+    os_rwlock_r_lock(g_api_rwlock);
+  }
+  api_process_lock(process_mode);
+  return NVM_SUCCESS;
+}
+
+/*
+ * Takes the API lock for the calling thread. Queries share the lock, calls
+ * that change the configuration, the FW or the driver state own it, among
+ * threads and among processes alike.
+ */
+static int api_lock(int mode)
+{
+  return api_lock_modes(mode, mode);
+}
+
+/*
+ * Releases the API lock taken by api_lock(). Leaving an exclusive section
+ * drops the inventory snapshot, the next reader publishes a fresh one. After
+ * a change the daemon telemetry is only served once a poll has seen it.
+ */
+static void api_unlock()
+{
+  if (0 < --g_api_lock_depth) {
+    return;
+  }
+
+  if (API_LOCK_EXCLUSIVE == g_api_process_lock_mode) {
+    telemetry_invalidate();
+  }
+  api_process_unlock(g_api_process_lock_mode);
+  if (API_LOCK_EXCLUSIVE == g_api_lock_mode) {
+    inventory_invalidate();
+    os_rwlock_w_unlock(g_api_rwlock);
+  } else {
+    os_rwlock_r_unlock(g_api_rwlock);
+  }
+}
+
+/*
+ * Defines the API entry point nvm_<name>, which runs nvm_internal_<name>
+ * under the API lock taken in mode. params and args are the parenthesized
+ * parameter and argument lists of the entry point.
+ */
+#define NVM_API_LOCKED(mode, name, params, args) \
+  NVM_API int nvm_##name params \
+  { \
+    int rc; \
+    if (NVM_SUCCESS != (rc = api_lock(mode))) { \
+      return rc; \
+    } \
+    rc = nvm_internal_##name args; \
+    api_unlock(); \
+    return rc; \
+  }
+
+/*
+ * Reads the ipmctld telemetry of a DIMM, returns 1 if it was served. Not
+ * within exclusive sections, the telemetry may not show their changes yet.
+ */
+static int telemetry_lookup(const NVM_UID uid, NVM_UINT32 families, struct telemetry_dimm *p_dimm)
+{
+  if (API_LOCK_EXCLUSIVE == g_api_lock_mode) {
+    return 0;
+  }
+  return telemetry_get_dimm(uid, families, p_dimm);
+}
+
+/*
+ * Returns a reference to the current inventory snapshot, publishing one
+ * first when there is none. Release it with inventory_release().
+ */
+static int inventory_acquire(NVM_INVENTORY **pp_inventory)
+{
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  NVM_INVENTORY *p_inventory = NULL;
+  UINT32 dimm_cnt = 0;
+
+  os_mutex_lock(g_inventory_mutex);
+  if (NULL != (p_inventory = g_inventory)) {
+    p_inventory->refs++;
+  }
+  os_mutex_unlock(g_inventory_mutex);
+  if (NULL != p_inventory) {
+    *pp_inventory = p_inventory;
+    return NVM_SUCCESS;
+  }
+
+  // built outside of the inventory lock, concurrent readers may race to publish
+  ReturnCode = gNvmDimmDriverNvmDimmConfig.GetDimmCount(&gNvmDimmDriverNvmDimmConfig, &dimm_cnt);
+  if (EFI_ERROR(ReturnCode)) {
+    NVDIMM_ERR_W(FORMAT_STR_NL, CLI_ERR_INTERNAL_ERROR);
+    return NVM_ERR_UNKNOWN;
+  }
+
+  if (NULL == (p_inventory = (NVM_INVENTORY *)AllocateZeroPool(sizeof(NVM_INVENTORY))) ||
+      (0 < dimm_cnt && NULL == (p_inventory->p_dimms = (DIMM_INFO_CORE *)AllocatePool(sizeof(DIMM_INFO_CORE) * dimm_cnt)))) {
+    NVDIMM_ERR("Failed to allocate memory\n");
+    FREE_POOL_SAFE(p_inventory);
+    return NVM_ERR_NOT_ENOUGH_FREE_SPACE;
+  }
+  p_inventory->dimm_cnt = dimm_cnt;
+
+  if (0 < dimm_cnt) {
+    ReturnCode = gNvmDimmDriverNvmDimmConfig.GetDimmCores(&gNvmDimmDriverNvmDimmConfig, dimm_cnt, p_inventory->p_dimms);
+    if (EFI_ERROR(ReturnCode)) {
+      NVDIMM_ERR("GetDimmCores failed (%d)\n", ReturnCode);
+      FREE_POOL_SAFE(p_inventory->p_dimms);
+      FREE_POOL_SAFE(p_inventory);
+      return NVM_ERR_UNKNOWN;
+    }
+  }
+
+  os_mutex_lock(g_inventory_mutex);
+  if (NULL == g_inventory) {
+    // the published pointer holds a reference of its own
+    p_inventory->refs = 1;
+    g_inventory = p_inventory;
+  } else {
+    FREE_POOL_SAFE(p_inventory->p_dimms);
+    FREE_POOL_SAFE(p_inventory);
+    p_inventory = g_inventory;
+  }
+  p_inventory->refs++;
+  os_mutex_unlock(g_inventory_mutex);
+
+  *pp_inventory = p_inventory;
+  return NVM_SUCCESS;
+}
+
+/*
+ * Drops a reference from inventory_acquire(), the last one frees the snapshot
+ */
+static void inventory_release(NVM_INVENTORY *p_inventory)
+{
+  unsigned int refs;
+
+  if (NULL == p_inventory) {
+    return;
+  }
+
+  os_mutex_lock(g_inventory_mutex);
+  refs = --p_inventory->refs;
+  os_mutex_unlock(g_inventory_mutex);
+  if (0 == refs) {
+    FREE_POOL_SAFE(p_inventory->p_dimms);
+    FREE_POOL_SAFE(p_inventory);
+  }
+}
+
+/*
+ * Unpublishes the inventory snapshot, readers still holding it are not affected
+ */
+static void inventory_invalidate()
+{
+  NVM_INVENTORY *p_inventory;
+
+  os_mutex_lock(g_inventory_mutex);
+  p_inventory = g_inventory;
+  g_inventory = NULL;
+  os_mutex_unlock(g_inventory_mutex);
+  inventory_release(p_inventory);
+}
+
 //todo: add error checking
 NVM_API int nvm_init()
 {
-  return nvm_internal_init(TRUE);
+  int rc;
+
+  os_once(&g_api_locks_once, api_locks_create);
+  if (NULL == g_init_mutex) {
+    NVDIMM_ERR("Failed to intialize NVM API locks\n");
+    return NVM_ERR_UNKNOWN;
+  }
+
+  os_mutex_lock(g_init_mutex);
+  rc = nvm_internal_init(TRUE);
+  os_mutex_unlock(g_init_mutex);
+  return rc;
 }
 
 //todo: add error checking
@@ -93,9 +386,14 @@ static int nvm_internal_init(BOOLEAN binding_start)
 
   if (g_nvm_initialized) {
 
-    // Clear PCD cache on any API entry point
+    // Clear PCD cache on any API entry point, each DIMM under its mailbox lock
     ClearPcdCacheOnDimmList();
 
+    // Namespaces change under the library, they are read again on first use
+    if (!g_fast_path && !g_basic_commands) {
+      InvalidateNamespacesStage();
+    }
+
     return rc;
   }
 
@@ -119,29 +417,26 @@ static int nvm_internal_init(BOOLEAN binding_start)
 
   NVDIMM_DBG("Nvm Init");
 
-  if (NULL == (g_api_mutex = os_mutex_init(NVM_API_MUTEX)))
-  {
-    NVDIMM_ERR("Failed to intialize NVM API mutex\n");
-    return NVM_ERR_UNKNOWN;
-  }
-
   EFI_HANDLE FakeBindHandle = (EFI_HANDLE)0x1;
   init_protocol_bs();
   init_protocol_simple_file_system_protocol();
 
   // Initialize Preferences
+  StartupPhaseBegin(StartupPhasePreferences);
   if (EFI_SUCCESS != preferences_init(NULL))
   {
+    StartupPhaseEnd(StartupPhasePreferences);
     NVDIMM_ERR("Failed to intialize preferences\n");
     rc = NVM_ERR_UNKNOWN;
-    goto cleanup_mutex;
+    return rc;
   }
+  StartupPhaseEnd(StartupPhasePreferences);
 
   if (EFI_SUCCESS != NvmDimmDriverDriverEntryPoint(0, NULL))
   {
     NVDIMM_ERR("Nvm Dimm driver entry point failed.\n");
     rc = NVM_ERR_UNKNOWN;
-    goto cleanup_mutex;
+    return rc;
   }
 
   rc = os_check_admin_permissions();
@@ -161,15 +456,17 @@ static int nvm_internal_init(BOOLEAN binding_start)
 
   g_nvm_initialized = 1;
   return rc;
-cleanup_mutex:
-  os_mutex_delete(g_api_mutex, NVM_API_MUTEX);
-  g_api_mutex = NULL;
-  return rc;
 }
 
 NVM_API void nvm_uninit()
 {
+  if (NVM_SUCCESS != api_lock(API_LOCK_EXCLUSIVE)) {
+    return;
+  }
+  os_mutex_lock(g_init_mutex);
   nvm_internal_uninit(TRUE);
+  os_mutex_unlock(g_init_mutex);
+  api_unlock();
 }
 
 static void nvm_internal_uninit(BOOLEAN binding_stop)
@@ -183,10 +480,7 @@ static void nvm_internal_uninit(BOOLEAN binding_stop)
   uninit_protocol_shell_parameters_protocol();
   preferences_uninit();
 
-  if (g_api_mutex) {
-    os_mutex_delete(g_api_mutex, NVM_API_MUTEX);
-    g_api_mutex = NULL;
-  }
+  inventory_invalidate();
   g_nvm_initialized = 0;
 }
 
@@ -201,7 +495,11 @@ static void nvm_internal_uninit(BOOLEAN binding_stop)
 */
 NVM_API void nvm_conf_file_init(const char *p_ini_file_name)
 {
+  if (NVM_SUCCESS != api_lock(API_LOCK_EXCLUSIVE)) {
+    return;
+  }
   preferences_init(p_ini_file_name);
+  api_unlock();
 }
 
 /**
@@ -213,19 +511,27 @@ NVM_API void nvm_conf_file_init(const char *p_ini_file_name)
 */
 NVM_API void nvm_conf_file_flush()
 {
+  if (NVM_SUCCESS != api_lock(API_LOCK_EXCLUSIVE)) {
+    return;
+  }
   preferences_flush_the_file();
+  api_unlock();
 }
 
+/*
+ * Runs a sequence of API calls of this thread alone, with other threads and
+ * other processes kept out until nvm_sync_unlock_api()
+ */
 NVM_API void nvm_sync_lock_api()
 {
-  if (g_api_mutex)
-    os_mutex_lock(g_api_mutex);
+  api_lock(API_LOCK_EXCLUSIVE);
 }
 
 NVM_API void nvm_sync_unlock_api()
 {
-  if (g_api_mutex)
-    os_mutex_unlock(g_api_mutex);
+  if (0 < g_api_lock_depth) {
+    api_unlock();
+  }
 }
 
 struct Command g_cur_command;
@@ -236,7 +542,7 @@ void nvm_current_cmd(struct Command Command)
 
 
 
-NVM_API int nvm_run_cli(int argc, char *argv[])
+static int nvm_internal_run_cli(int argc, char *argv[])
 {
   EFI_STATUS rc;
   int nvm_status;
@@ -253,7 +559,9 @@ NVM_API int nvm_run_cli(int argc, char *argv[])
     wprintf(L"");
   }
 
+  os_mutex_lock(g_init_mutex);
   nvm_status = nvm_internal_init(FALSE);
+  os_mutex_unlock(g_init_mutex);
   if (NVM_ERR_INVALID_PERMISSIONS != nvm_status && NVM_SUCCESS != nvm_status) {
     CHAR16* ErrStr = GetSingleNvmStatusCodeMessage(NULL, nvm_status);
     wprintf(L"Failed to intialize nvm library (%d): %ls.\n", nvm_status, ErrStr);
@@ -262,13 +570,111 @@ NVM_API int nvm_run_cli(int argc, char *argv[])
   }
   rc = UefiToOsReturnCode(UefiMain(0, NULL));
 
+  os_mutex_lock(g_init_mutex);
   nvm_internal_uninit(FALSE);
+  os_mutex_unlock(g_init_mutex);
   return (int)rc;
 }
 
+#define CLI_VERB_MAX_LEN  16
+
+/*
+ * Tells if the command line runs a command that leaves the configuration
+ * alone, see IsReadOnlyCommand() of the CLI. Batch files may hold anything.
+ */
+static BOOLEAN is_read_only_cli(int argc, char *argv[])
+{
+  CHAR16 arg[CLI_VERB_MAX_LEN];
+  int i;
 
+  if (2 > argc || EFI_ERROR(AsciiStrToUnicodeStrS(argv[1], arg, CLI_VERB_MAX_LEN))) {
+    return FALSE;
+  }
+
+  if (0 == StrICmp(arg, SHOW_VERB) || 0 == StrICmp(arg, HELP_VERB) ||
+      0 == StrICmp(arg, VERSION_VERB) || 0 == StrICmp(arg, DUMP_VERB)) {
+    return TRUE;
+  }
+
+  if (0 != StrICmp(arg, START_VERB)) {
+    return FALSE;
+  }
+  for (i = 2; i < argc; i++) {
+    if (!EFI_ERROR(AsciiStrToUnicodeStrS(argv[i], arg, CLI_VERB_MAX_LEN)) &&
+        0 == StrICmp(arg, DIAGNOSTIC_TARGET)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
 
-NVM_API int nvm_get_host_name(char *host_name, const NVM_SIZE host_name_len)
+NVM_API int nvm_run_cli(int argc, char *argv[])
+{
+  int rc;
+
+  // The CLI brings the whole stack up and down, no other thread may run
+  // meanwhile. Other processes only need to wait when it changes things.
+  if (NVM_SUCCESS != (rc = api_lock_modes(API_LOCK_EXCLUSIVE,
+      is_read_only_cli(argc, argv) ? API_LOCK_SHARED : API_LOCK_EXCLUSIVE))) {
+    return rc;
+  }
+  rc = nvm_internal_run_cli(argc, argv);
+  api_unlock();
+  return rc;
+}
+
+
+
+NVM_API int nvm_get_usage_counters(struct nvm_usage_counters *p_counters)
+{
+  if (NULL == p_counters) {
+    NVDIMM_ERR("NULL input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+
+  p_counters->allocations = OS_USAGE_READ(Allocations);
+  p_counters->allocated_bytes = OS_USAGE_READ(AllocatedBytes);
+  p_counters->fw_commands = OS_USAGE_READ(FwCommands);
+  return NVM_SUCCESS;
+}
+
+NVM_API int nvm_reset_usage_counters()
+{
+  ZeroMem(&gOsUsageCounters, sizeof(gOsUsageCounters));
+  // counting starts with the first reset
+  gOsUsageCountersEnabled = TRUE;
+  return NVM_SUCCESS;
+}
+
+NVM_API int nvm_get_startup_profile(struct nvm_startup_profile *p_profile)
+{
+  STARTUP_PROFILE profile;
+  int index = 0;
+
+  if (NULL == p_profile) {
+    NVDIMM_ERR("NULL input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  // The profile has its own lock, a read must not wait for another
+  // process' exclusive operation
+  StartupProfileGet(&profile);
+
+  // the phases of the library and the driver are listed in the same order
+  for (index = 0; index < STARTUP_PHASE_COUNT; index++) {
+    p_profile->phases[index].time_us = profile.Phases[index].TimeUs;
+    p_profile->phases[index].runs = profile.Phases[index].Runs;
+  }
+  p_profile->dimm_count = profile.DimmCount;
+  return NVM_SUCCESS;
+}
+
+NVM_API int nvm_reset_startup_profile()
+{
+  StartupProfileReset();
+  return NVM_SUCCESS;
+}
+
+static int nvm_internal_get_host_name(char *host_name, const NVM_SIZE host_name_len)
 {
   int nvm_status;
 
@@ -287,7 +693,11 @@ NVM_API int nvm_get_host_name(char *host_name, const NVM_SIZE host_name_len)
   return NVM_ERR_UNKNOWN;
 }
 
-NVM_API int nvm_get_host(struct host *p_host)
+NVM_API_LOCKED(API_LOCK_SHARED, get_host_name,
+  (char *host_name, const NVM_SIZE host_name_len),
+  (host_name, host_name_len))
+
+static int nvm_internal_get_host(struct host *p_host)
 {
   int nvm_status;
 
@@ -313,7 +723,9 @@ NVM_API int nvm_get_host(struct host *p_host)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_sw_inventory(struct sw_inventory *p_inventory)
+NVM_API_LOCKED(API_LOCK_SHARED, get_host, (struct host *p_host), (p_host))
+
+static int nvm_internal_get_sw_inventory(struct sw_inventory *p_inventory)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   CHAR16 Version[FW_API_VERSION_LEN];
@@ -341,6 +753,8 @@ NVM_API int nvm_get_sw_inventory(struct sw_inventory *p_inventory)
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_sw_inventory, (struct sw_inventory *p_inventory), (p_inventory))
+
 NVM_API int nvm_get_version(NVM_VERSION version_str, const NVM_SIZE str_len)
 {
   if (NULL == version_str) {
@@ -351,7 +765,7 @@ NVM_API int nvm_get_version(NVM_VERSION version_str, const NVM_SIZE str_len)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_number_of_sockets(int *count)
+static int nvm_internal_get_number_of_sockets(int *count)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   int SocketCount = 0;
@@ -380,7 +794,9 @@ NVM_API int nvm_get_number_of_sockets(int *count)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_sockets(struct socket *p_sockets, const NVM_UINT16 count)
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_sockets, (int *count), (count))
+
+static int nvm_internal_get_sockets(struct socket *p_sockets, const NVM_UINT16 count)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   int socket_count = 0;
@@ -418,7 +834,9 @@ NVM_API int nvm_get_sockets(struct socket *p_sockets, const NVM_UINT16 count)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_socket(const NVM_UINT16 socket_id, struct socket *p_socket)
+NVM_API_LOCKED(API_LOCK_SHARED, get_sockets, (struct socket *p_sockets, const NVM_UINT16 count), (p_sockets, count))
+
+static int nvm_internal_get_socket(const NVM_UINT16 socket_id, struct socket *p_socket)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   int socket_count = 0;
@@ -453,7 +871,11 @@ NVM_API int nvm_get_socket(const NVM_UINT16 socket_id, struct socket *p_socket)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_number_of_memory_topology_devices(unsigned int *count)
+NVM_API_LOCKED(API_LOCK_SHARED, get_socket,
+  (const NVM_UINT16 socket_id, struct socket *p_socket),
+  (socket_id, p_socket))
+
+static int nvm_internal_get_number_of_memory_topology_devices(unsigned int *count)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   TOPOLOGY_DIMM_INFO *pDimmTopology = NULL;
@@ -492,7 +914,9 @@ NVM_API int nvm_get_number_of_memory_topology_devices(unsigned int *count)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_memory_topology(struct memory_topology *  p_devices,
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_memory_topology_devices, (unsigned int *count), (count))
+
+static int nvm_internal_get_memory_topology(struct memory_topology *  p_devices,
             const NVM_UINT8   count)
 {
   EFI_STATUS efi_status = EFI_SUCCESS;
@@ -573,10 +997,13 @@ Finish:
   return nvm_status;
 }
 
-NVM_API int nvm_get_number_of_devices(unsigned int *count)
+NVM_API_LOCKED(API_LOCK_SHARED, get_memory_topology,
+  (struct memory_topology * p_devices, const NVM_UINT8 count),
+  (p_devices, count))
+
+static int nvm_internal_get_number_of_devices(unsigned int *count)
 {
-  EFI_STATUS ReturnCode = EFI_SUCCESS;
-  unsigned int dimm_cnt;
+  NVM_INVENTORY *p_inventory = NULL;
   int nvm_status;
 
   if (NVM_SUCCESS != (nvm_status = nvm_init())) {
@@ -589,22 +1016,17 @@ NVM_API int nvm_get_number_of_devices(unsigned int *count)
     return NVM_ERR_INVALID_PARAMETER;
   }
 
-  if (0 != g_dimm_cnt)
-    goto Finish;
-
-  ReturnCode = gNvmDimmDriverNvmDimmConfig.GetDimmCount(&gNvmDimmDriverNvmDimmConfig, (UINT32 *)&dimm_cnt);
-  if (EFI_ERROR(ReturnCode)) {
-    NVDIMM_ERR_W(FORMAT_STR_NL, CLI_ERR_INTERNAL_ERROR);
-    return NVM_ERR_UNKNOWN;
+  if (NVM_SUCCESS != (nvm_status = inventory_acquire(&p_inventory))) {
+    return nvm_status;
   }
-  g_dimm_cnt = dimm_cnt;
-
-Finish:
-  *count = g_dimm_cnt;
+  *count = p_inventory->dimm_cnt;
+  inventory_release(p_inventory);
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_devices(struct device_discovery *p_devices, const NVM_UINT8 count)
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_devices, (unsigned int *count), (count))
+
+static int nvm_internal_get_devices(struct device_discovery *p_devices, const NVM_UINT8 count)
 {
   int nvm_status;
   unsigned int i;
@@ -650,6 +1072,10 @@ NVM_API int nvm_get_devices(struct device_discovery *p_devices, const NVM_UINT8
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_devices,
+  (struct device_discovery *p_devices, const NVM_UINT8 count),
+  (p_devices, count))
+
 NVM_API int nvm_get_devices_nfit(struct device_discovery *p_devices, const NVM_UINT8 count)
 {
   int rc = nvm_get_devices(p_devices, count);
@@ -657,7 +1083,7 @@ NVM_API int nvm_get_devices_nfit(struct device_discovery *p_devices, const NVM_U
   return rc;
 }
 
-NVM_API int nvm_get_device_discovery(const NVM_UID    device_uid,
+static int nvm_internal_get_device_discovery(const NVM_UID    device_uid,
              struct device_discovery *  p_discovery)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -690,6 +1116,10 @@ NVM_API int nvm_get_device_discovery(const NVM_UID    device_uid,
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_discovery,
+  (const NVM_UID device_uid, struct device_discovery * p_discovery),
+  (device_uid, p_discovery))
+
 static void dimm_info_to_device_status(DIMM_INFO *p_dimm, struct device_status *p_status)
 {
    //DIMM_INFO_CATEGORY_PACKAGE_SPARING
@@ -736,7 +1166,7 @@ static void dimm_info_to_device_status(DIMM_INFO *p_dimm, struct device_status *
    p_status->injected_non_media_errors = p_dimm->PoisonErrorInjectionsCounter;     // The number of injected non-media errors on DIMM
 }
 
-NVM_API int nvm_get_device_status(const NVM_UID   device_uid,
+static int nvm_internal_get_device_status(const NVM_UID   device_uid,
           struct device_status *p_status)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -744,10 +1174,15 @@ NVM_API int nvm_get_device_status(const NVM_UID   device_uid,
   UINT16 dimm_id;
   int nvm_status;
   UINT16 BootstatusBitmask;
+  struct telemetry_dimm telemetry;
   if (NULL == p_status) {
     NVDIMM_ERR("NULL input parameter\n");
     return NVM_ERR_INVALID_PARAMETER;
   }
+  if (telemetry_lookup(device_uid, TELEMETRY_FAMILY_BIT(TELEMETRY_STATUS), &telemetry)) {
+    *p_status = telemetry.status;
+    return NVM_SUCCESS;
+  }
   if (NVM_SUCCESS != (nvm_status = nvm_init())) {
     NVDIMM_ERR("Failed to intialize nvm library %d\n", nvm_status);
     return nvm_status;
@@ -776,7 +1211,11 @@ NVM_API int nvm_get_device_status(const NVM_UID   device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_pmon_registers(const NVM_UID   device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_status,
+  (const NVM_UID device_uid, struct device_status *p_status),
+  (device_uid, p_status))
+
+static int nvm_internal_get_pmon_registers(const NVM_UID   device_uid,
           const NVM_UINT8 SmartDataMask, PMON_REGISTERS *p_output_payload)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -803,7 +1242,12 @@ NVM_API int nvm_get_pmon_registers(const NVM_UID   device_uid,
   }
   return NVM_SUCCESS;
 }
-NVM_API int nvm_set_pmon_registers(const NVM_UID   device_uid,
+
+NVM_API_LOCKED(API_LOCK_SHARED, get_pmon_registers,
+  (const NVM_UID device_uid, const NVM_UINT8 SmartDataMask, PMON_REGISTERS *p_output_payload),
+  (device_uid, SmartDataMask, p_output_payload))
+
+static int nvm_internal_set_pmon_registers(const NVM_UID   device_uid,
           NVM_UINT8 PMONGroupEnable)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -827,7 +1271,11 @@ NVM_API int nvm_set_pmon_registers(const NVM_UID   device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_device_settings(const NVM_UID   device_uid,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, set_pmon_registers,
+  (const NVM_UID device_uid, NVM_UINT8 PMONGroupEnable),
+  (device_uid, PMONGroupEnable))
+
+static int nvm_internal_get_device_settings(const NVM_UID   device_uid,
             struct device_settings *  p_settings)
 {
   EFI_STATUS ReturnCode;
@@ -872,7 +1320,11 @@ NVM_API int nvm_get_device_settings(const NVM_UID   device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_device_details(const NVM_UID    device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_settings,
+  (const NVM_UID device_uid, struct device_settings * p_settings),
+  (device_uid, p_settings))
+
+static int nvm_internal_get_device_details(const NVM_UID    device_uid,
            struct device_details *  p_details)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -953,12 +1405,17 @@ NVM_API int nvm_get_device_details(const NVM_UID    device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_device_performance(const NVM_UID      device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_details,
+  (const NVM_UID device_uid, struct device_details * p_details),
+  (device_uid, p_details))
+
+static int nvm_internal_get_device_performance(const NVM_UID      device_uid,
                struct device_performance *  p_performance)
 {
   NVM_FW_CMD *cmd = NULL;
   PT_OUTPUT_PAYLOAD_MEMORY_INFO_PAGE1 *pmem_info_output;
   PT_INPUT_PAYLOAD_MEMORY_INFO mem_info_input;
+  struct telemetry_dimm telemetry;
   int rc = NVM_ERR_UNKNOWN;
 
   if (NULL == p_performance) {
@@ -966,6 +1423,12 @@ NVM_API int nvm_get_device_performance(const NVM_UID      device_uid,
     return NVM_ERR_INVALID_PARAMETER;
   }
 
+  // time keeps the moment the daemon gathered the counters
+  if (telemetry_lookup(device_uid, TELEMETRY_FAMILY_BIT(TELEMETRY_PERFORMANCE), &telemetry)) {
+    *p_performance = telemetry.performance;
+    return NVM_SUCCESS;
+  }
+
   if (NVM_SUCCESS != (rc = nvm_init())) {
     NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
     return rc;
@@ -1010,6 +1473,550 @@ finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_performance,
+  (const NVM_UID device_uid, struct device_performance * p_performance),
+  (device_uid, p_performance))
+
+/*
+ * Sampler behind the opaque handle of the API
+ */
+struct nvm_performance_sampler {
+  PERFORMANCE_SAMPLER *p_sampler;  // samples, PMem modules in inventory order
+  NVM_UID *p_uids;                 // uid of each sampled PMem module
+};
+
+/*
+ * Fills p_rates from the deltas of an interval of the sampler
+ */
+static int performance_sampler_rates(const struct nvm_performance_sampler *p_sampler, NVM_UINT32 age,
+  struct device_performance_rate *p_rates, NVM_UINT8 count)
+{
+  PERFORMANCE_DELTA *p_deltas = NULL;
+  EFI_STATUS ReturnCode = EFI_SUCCESS;
+  NVM_UINT32 i;
+  int rc = NVM_SUCCESS;
+
+  if (NULL == p_sampler || NULL == p_rates) {
+    NVDIMM_ERR("NULL input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  if (count != p_sampler->p_sampler->DimmCount) {
+    return NVM_ERR_BAD_SIZE;
+  }
+  if (NULL == (p_deltas = (PERFORMANCE_DELTA *)AllocatePool(sizeof(*p_deltas) * count))) {
+    NVDIMM_ERR("Failed to allocate memory\n");
+    return NVM_ERR_NO_MEM;
+  }
+
+  ReturnCode = PerformanceSamplerGetDeltas(p_sampler->p_sampler, age, p_deltas);
+  if (EFI_ERROR(ReturnCode)) {
+    rc = NVM_ERR_INVALID_PARAMETER;
+    goto finish;
+  }
+  ZeroMem(p_rates, sizeof(*p_rates) * count);
+  for (i = 0; i < count; i++) {
+    CopyMem_S(p_rates[i].uid, sizeof(p_rates[i].uid), p_sampler->p_uids[i], sizeof(p_sampler->p_uids[i]));
+    p_rates[i].interval_ms = p_deltas[i].IntervalMs;
+    if (EFI_ERROR(p_deltas[i].ReturnCode)) {
+      p_rates[i].rc = NVM_ERR_OPERATION_FAILED;
+      continue;
+    }
+    p_rates[i].rc = NVM_SUCCESS;
+    p_rates[i].bytes_read = p_deltas[i].Delta.MediaReads;
+    p_rates[i].host_reads = p_deltas[i].Delta.ReadRequests;
+    p_rates[i].bytes_written = p_deltas[i].Delta.MediaWrites;
+    p_rates[i].host_writes = p_deltas[i].Delta.WriteRequests;
+    p_rates[i].bytes_read_per_sec = p_deltas[i].Rate.MediaReads;
+    p_rates[i].host_reads_per_sec = p_deltas[i].Rate.ReadRequests;
+    p_rates[i].bytes_written_per_sec = p_deltas[i].Rate.MediaWrites;
+    p_rates[i].host_writes_per_sec = p_deltas[i].Rate.WriteRequests;
+  }
+
+finish:
+  FREE_POOL_SAFE(p_deltas);
+  return rc;
+}
+
+static int nvm_internal_create_performance_sampler(const NVM_UINT32 interval_ms, const NVM_UINT32 history,
+  struct nvm_performance_sampler **pp_sampler)
+{
+  struct nvm_performance_sampler *p_sampler = NULL;
+  NVM_INVENTORY *p_inventory = NULL;
+  UINT16 *p_dimm_ids = NULL;
+  UINT32 dimm_cnt = 0;
+  UINT32 i;
+  int rc = NVM_SUCCESS;
+
+  if (NULL == pp_sampler || 0 == interval_ms || 0 == history || MAX_UINT32 == history) {
+    NVDIMM_ERR("Invalid input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  *pp_sampler = NULL;
+
+  if (NVM_SUCCESS != (rc = nvm_init())) {
+    NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
+    return rc;
+  }
+  if (NVM_SUCCESS != (rc = inventory_acquire(&p_inventory))) {
+    return rc;
+  }
+
+  if (NULL == (p_sampler = (struct nvm_performance_sampler *)AllocateZeroPool(sizeof(*p_sampler))) ||
+      (0 < p_inventory->dimm_cnt &&
+       (NULL == (p_dimm_ids = (UINT16 *)AllocateZeroPool(sizeof(*p_dimm_ids) * p_inventory->dimm_cnt)) ||
+        NULL == (p_sampler->p_uids = (NVM_UID *)AllocateZeroPool(sizeof(*p_sampler->p_uids) * p_inventory->dimm_cnt))))) {
+    NVDIMM_ERR("Failed to allocate memory\n");
+    rc = NVM_ERR_NO_MEM;
+    goto finish;
+  }
+  for (i = 0; i < p_inventory->dimm_cnt && dimm_cnt < MAX_UINT8; i++) {
+    if (MANAGEMENT_VALID_CONFIG != p_inventory->p_dimms[i].ManageabilityState) {
+      continue;
+    }
+    p_dimm_ids[dimm_cnt] = p_inventory->p_dimms[i].DimmID;
+    UnicodeStrToAsciiStrS(p_inventory->p_dimms[i].DimmUid, p_sampler->p_uids[dimm_cnt], NVM_MAX_UID_LEN);
+    dimm_cnt++;
+  }
+  if (0 == dimm_cnt) {
+    rc = NVM_ERR_MANAGEABLE_DIMM_NOT_FOUND;
+    goto finish;
+  }
+
+  if (EFI_ERROR(PerformanceSamplerCreate(&gNvmDimmDriverNvmDimmConfig, p_dimm_ids, dimm_cnt, interval_ms,
+      history + 1, IsConcurrentFetchAllowed(), &p_sampler->p_sampler))) {
+    rc = NVM_ERR_NO_MEM;
+    goto finish;
+  }
+  PerformanceSamplerTake(p_sampler->p_sampler);
+  *pp_sampler = p_sampler;
+  p_sampler = NULL;
+
+finish:
+  inventory_release(p_inventory);
+  FREE_POOL_SAFE(p_dimm_ids);
+  nvm_free_performance_sampler(p_sampler);
+  return rc;
+}
+
+NVM_API_LOCKED(API_LOCK_SHARED, create_performance_sampler,
+  (const NVM_UINT32 interval_ms, const NVM_UINT32 history, struct nvm_performance_sampler **pp_sampler),
+  (interval_ms, history, pp_sampler))
+
+NVM_API int nvm_get_performance_sampler_device_count(const struct nvm_performance_sampler *p_sampler,
+  NVM_UINT8 *p_count)
+{
+  if (NULL == p_sampler || NULL == p_count) {
+    NVDIMM_ERR("NULL input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  *p_count = (NVM_UINT8)p_sampler->p_sampler->DimmCount;
+  return NVM_SUCCESS;
+}
+
+NVM_API int nvm_sample_device_performance(struct nvm_performance_sampler *p_sampler,
+  struct device_performance_rate *p_rates, const NVM_UINT8 count)
+{
+  int rc;
+
+  if (NULL == p_sampler || NULL == p_rates) {
+    NVDIMM_ERR("NULL input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  if (count != p_sampler->p_sampler->DimmCount) {
+    return NVM_ERR_BAD_SIZE;
+  }
+
+  // only the reads hold the API lock, not the wait for them
+  PerformanceSamplerWait(p_sampler->p_sampler);
+  if (NVM_SUCCESS != (rc = api_lock(API_LOCK_SHARED))) {
+    return rc;
+  }
+  // the library may have been uninitialized since the sampler was created
+  if (NVM_SUCCESS != (rc = nvm_init())) {
+    NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
+    api_unlock();
+    return rc;
+  }
+  PerformanceSamplerTake(p_sampler->p_sampler);
+  api_unlock();
+  return performance_sampler_rates(p_sampler, 0, p_rates, count);
+}
+
+NVM_API int nvm_get_device_performance_history(const struct nvm_performance_sampler *p_sampler,
+  const NVM_UINT32 age, struct device_performance_rate *p_rates, const NVM_UINT8 count)
+{
+  return performance_sampler_rates(p_sampler, age, p_rates, count);
+}
+
+NVM_API void nvm_free_performance_sampler(struct nvm_performance_sampler *p_sampler)
+{
+  if (NULL == p_sampler) {
+    return;
+  }
+  PerformanceSamplerFree(&p_sampler->p_sampler);
+  FREE_POOL_SAFE(p_sampler->p_uids);
+  FREE_POOL_SAFE(p_sampler);
+}
+
+/*
+ * Transitions one poll of a device can report: readable, health, error log, job and
+ * the range, alarm threshold and alarm enabling of each sensor
+ */
+#define EVENT_SUBSCRIPTION_EVENTS_PER_DIMM  (4 + 3 * SENSOR_COUNT)
+
+/*
+ * Last state seen of a device watched by an event subscription
+ */
+struct event_subscription_dimm {
+  NVM_UID uid;
+  NVM_BOOL readable;
+  NVM_BOOL seen;           // sensors and ranges hold a successful read
+  NVM_BOOL job_valid;
+  struct sensor sensors[SENSOR_COUNT];
+  enum sensor_status ranges[SENSOR_COUNT];
+  enum nvm_job_status job_status;
+  NVM_UINT64 interval_ms;  // current interval between polls
+  NVM_UINT64 next_ms;      // time of the next poll
+};
+
+/*
+ * Subscription behind the opaque handle of the API
+ */
+struct nvm_event_subscription {
+  NVM_DEVICE_STATE_CALLBACK callback;
+  void *p_context;
+  NVM_UINT64 min_interval_ms;
+  NVM_UINT64 max_interval_ms;
+  struct event_subscription_dimm *p_dimms;  // watched PMem modules, in inventory order
+  NVM_UINT32 dimm_cnt;
+  struct job *p_jobs;                       // long operations of all PMem modules
+  NVM_UINT32 device_cnt;                    // all PMem modules, manageable or not
+  NVM_UINT64 jobs_interval_ms;
+  NVM_UINT64 jobs_next_ms;
+  struct device_state_event *p_events;      // transitions of the last poll, not yet reported
+  NVM_UINT32 event_cnt;
+  OS_SEMAPHORE *p_wake;                     // posted to end the subscription
+  OS_THREAD *p_thread;
+  volatile int stop;
+};
+
+/*
+ * Range of the thresholds the reading of a sensor is in. The FW leaves the state
+ * of the sensors to software, see fill_sensor_info().
+ */
+static enum sensor_status sensor_range(const struct sensor *p_sensor)
+{
+  NVM_INT64 reading = (NVM_INT64)p_sensor->reading;
+  const struct sensor_settings *p_settings = &p_sensor->settings;
+
+  switch (p_sensor->type) {
+  case SENSOR_MEDIA_TEMPERATURE:
+  case SENSOR_CONTROLLER_TEMPERATURE:
+    if (0 != p_settings->upper_fatal_threshold && reading >= (NVM_INT64)p_settings->upper_fatal_threshold) {
+      return SENSOR_FATAL;
+    }
+    if (0 != p_settings->upper_critical_threshold && reading >= (NVM_INT64)p_settings->upper_critical_threshold) {
+      return SENSOR_CRITICAL;
+    }
+    if (SENSOR_ENABLED == p_settings->enabled && reading >= (NVM_INT64)p_settings->upper_noncritical_threshold) {
+      return SENSOR_NONCRITICAL;
+    }
+    return SENSOR_NORMAL;
+  case SENSOR_PERCENTAGE_REMAINING:
+    // spare capacity degrades downwards, the alarm fires at or below the threshold
+    if (SENSOR_ENABLED == p_settings->enabled && reading <= (NVM_INT64)p_settings->upper_noncritical_threshold) {
+      return SENSOR_NONCRITICAL;
+    }
+    return SENSOR_NORMAL;
+  default:
+    return SENSOR_NORMAL;
+  }
+}
+
+/*
+ * Queues a transition of a device if the value changed, returns whether it did
+ */
+static BOOLEAN event_subscription_queue(struct nvm_event_subscription *p_subscription,
+  const struct event_subscription_dimm *p_dimm, enum device_state_change change, enum sensor_type sensor,
+  NVM_UINT64 old_value, NVM_UINT64 new_value)
+{
+  struct device_state_event *p_event = NULL;
+
+  if (old_value == new_value) {
+    return FALSE;
+  }
+  p_event = &p_subscription->p_events[p_subscription->event_cnt++];
+  ZeroMem(p_event, sizeof(*p_event));
+  CopyMem_S(p_event->uid, sizeof(p_event->uid), p_dimm->uid, sizeof(p_dimm->uid));
+  p_event->change = change;
+  p_event->sensor = sensor;
+  p_event->old_value = old_value;
+  p_event->new_value = new_value;
+  p_event->time = time(NULL);
+  return TRUE;
+}
+
+/*
+ * Polls the health, the sensors and the FW error log of one device. Returns whether
+ * the device is degraded or changed, to be polled again soon.
+ */
+static BOOLEAN event_subscription_poll_dimm(struct nvm_event_subscription *p_subscription,
+  struct event_subscription_dimm *p_dimm)
+{
+  struct sensor sensors[SENSOR_COUNT];
+  enum sensor_status range;
+  BOOLEAN readable = FALSE;
+  BOOLEAN changed = FALSE;
+  BOOLEAN degraded = FALSE;
+  int type;
+
+  // one SMART and health read plus the alarm thresholds, served by ipmctld when it runs
+  ZeroMem(sensors, sizeof(sensors));
+  readable = (NVM_SUCCESS == nvm_internal_get_sensors(p_dimm->uid, sensors, SENSOR_COUNT));
+  changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_READABLE, SENSOR_HEALTH,
+    p_dimm->readable, readable);
+  p_dimm->readable = readable;
+  if (!readable) {
+    return TRUE;
+  }
+  // the first successful read is the baseline, a device back from being unreadable
+  // is compared to its state before
+  if (!p_dimm->seen) {
+    CopyMem(p_dimm->sensors, sensors, sizeof(sensors));
+    for (type = 0; type < SENSOR_COUNT; type++) {
+      p_dimm->ranges[type] = sensor_range(&sensors[type]);
+    }
+    p_dimm->seen = TRUE;
+  }
+
+  changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_HEALTH, SENSOR_HEALTH,
+    p_dimm->sensors[SENSOR_HEALTH].reading, sensors[SENSOR_HEALTH].reading);
+  changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_ERROR_LOG, SENSOR_FWERRORLOGCOUNT,
+    p_dimm->sensors[SENSOR_FWERRORLOGCOUNT].reading, sensors[SENSOR_FWERRORLOGCOUNT].reading);
+  degraded |= (HEALTH_STATUS_HEALTHY != sensors[SENSOR_HEALTH].reading);
+
+  for (type = 0; type < SENSOR_COUNT; type++) {
+    range = sensor_range(&sensors[type]);
+    changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_SENSOR_STATE,
+      (enum sensor_type)type, p_dimm->ranges[type], range);
+    changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_ALARM_THRESHOLD,
+      (enum sensor_type)type, p_dimm->sensors[type].settings.upper_noncritical_threshold,
+      sensors[type].settings.upper_noncritical_threshold);
+    changed |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_ALARM_ENABLED,
+      (enum sensor_type)type, SENSOR_ENABLED == p_dimm->sensors[type].settings.enabled,
+      SENSOR_ENABLED == sensors[type].settings.enabled);
+    degraded |= (SENSOR_NORMAL != range);
+    p_dimm->ranges[type] = range;
+  }
+  CopyMem(p_dimm->sensors, sensors, sizeof(sensors));
+  return changed || degraded;
+}
+
+/*
+ * Polls the long operation status of every device. Returns whether one runs or
+ * changed, to be polled again soon.
+ */
+static BOOLEAN event_subscription_poll_jobs(struct nvm_event_subscription *p_subscription)
+{
+  struct event_subscription_dimm *p_dimm = NULL;
+  struct job *p_job = NULL;
+  BOOLEAN busy = FALSE;
+  NVM_UINT32 i;
+  NVM_UINT32 j;
+
+  ZeroMem(p_subscription->p_jobs, sizeof(*p_subscription->p_jobs) * p_subscription->device_cnt);
+  if (NVM_SUCCESS != nvm_internal_get_jobs(p_subscription->p_jobs, p_subscription->device_cnt)) {
+    return FALSE;
+  }
+  for (i = 0; i < p_subscription->dimm_cnt; i++) {
+    p_dimm = &p_subscription->p_dimms[i];
+    for (j = 0; j < p_subscription->device_cnt; j++) {
+      p_job = &p_subscription->p_jobs[j];
+      if (0 != strncmp(p_job->uid, p_dimm->uid, NVM_MAX_UID_LEN)) {
+        continue;
+      }
+      if (p_dimm->job_valid) {
+        busy |= event_subscription_queue(p_subscription, p_dimm, DEVICE_STATE_CHANGE_JOB, SENSOR_HEALTH,
+          p_dimm->job_status, p_job->status);
+      }
+      busy |= (NVM_JOB_STATUS_RUNNING == p_job->status);
+      p_dimm->job_status = p_job->status;
+      p_dimm->job_valid = TRUE;
+      break;
+    }
+  }
+  return busy;
+}
+
+/*
+ * Interval until the next poll: the shortest while busy, doubling up to the longest while stable
+ */
+static NVM_UINT64 event_subscription_interval(const struct nvm_event_subscription *p_subscription,
+  NVM_UINT64 interval_ms, BOOLEAN busy)
+{
+  if (busy || 0 == interval_ms) {
+    return p_subscription->min_interval_ms;
+  }
+  return MIN(interval_ms * 2, p_subscription->max_interval_ms);
+}
+
+/*
+ * Polls whatever is due at now_ms, queueing the transitions in p_events.
+ * Called with the API lock held shared.
+ */
+static void event_subscription_poll(struct nvm_event_subscription *p_subscription, NVM_UINT64 now_ms)
+{
+  struct event_subscription_dimm *p_dimm = NULL;
+  BOOLEAN busy;
+  NVM_UINT32 i;
+
+  for (i = 0; i < p_subscription->dimm_cnt && !p_subscription->stop; i++) {
+    p_dimm = &p_subscription->p_dimms[i];
+    if (now_ms < p_dimm->next_ms) {
+      continue;
+    }
+    busy = event_subscription_poll_dimm(p_subscription, p_dimm);
+    p_dimm->interval_ms = event_subscription_interval(p_subscription, p_dimm->interval_ms, busy);
+    p_dimm->next_ms = now_ms + p_dimm->interval_ms;
+  }
+  if (now_ms >= p_subscription->jobs_next_ms && !p_subscription->stop) {
+    busy = event_subscription_poll_jobs(p_subscription);
+    p_subscription->jobs_interval_ms = event_subscription_interval(p_subscription,
+      p_subscription->jobs_interval_ms, busy);
+    p_subscription->jobs_next_ms = now_ms + p_subscription->jobs_interval_ms;
+  }
+}
+
+/*
+ * Thread of a subscription: sleeps until the next poll is due, polls and reports
+ */
+static void event_subscription_thread(void *p_arg)
+{
+  struct nvm_event_subscription *p_subscription = (struct nvm_event_subscription *)p_arg;
+  NVM_UINT64 now_ms;
+  NVM_UINT64 next_ms;
+  NVM_UINT32 i;
+
+  while (!p_subscription->stop) {
+    now_ms = os_get_monotonic_ms();
+    next_ms = p_subscription->jobs_next_ms;
+    for (i = 0; i < p_subscription->dimm_cnt; i++) {
+      next_ms = MIN(next_ms, p_subscription->p_dimms[i].next_ms);
+    }
+    if (now_ms < next_ms) {
+      os_sem_timed_wait(p_subscription->p_wake, next_ms - now_ms);
+      continue;
+    }
+
+    if (NVM_SUCCESS != api_lock(API_LOCK_SHARED)) {
+      os_sem_timed_wait(p_subscription->p_wake, p_subscription->min_interval_ms);
+      continue;
+    }
+    event_subscription_poll(p_subscription, now_ms);
+    api_unlock();
+
+    // reported without the lock, the callback may call the library
+    for (i = 0; i < p_subscription->event_cnt && !p_subscription->stop; i++) {
+      p_subscription->callback(&p_subscription->p_events[i], p_subscription->p_context);
+    }
+    p_subscription->event_cnt = 0;
+  }
+}
+
+static int nvm_internal_subscribe_events(const NVM_UINT32 min_interval_ms, const NVM_UINT32 max_interval_ms,
+  NVM_DEVICE_STATE_CALLBACK callback, void *p_context, struct nvm_event_subscription **pp_subscription)
+{
+  struct nvm_event_subscription *p_subscription = NULL;
+  NVM_INVENTORY *p_inventory = NULL;
+  UINT32 i;
+  int rc = NVM_SUCCESS;
+
+  if (NULL == pp_subscription || NULL == callback || 0 == min_interval_ms || max_interval_ms < min_interval_ms) {
+    NVDIMM_ERR("Invalid input parameter\n");
+    return NVM_ERR_INVALID_PARAMETER;
+  }
+  *pp_subscription = NULL;
+
+  if (NVM_SUCCESS != (rc = nvm_init())) {
+    NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
+    return rc;
+  }
+  if (NVM_SUCCESS != (rc = inventory_acquire(&p_inventory))) {
+    return rc;
+  }
+
+  if (NULL == (p_subscription = (struct nvm_event_subscription *)AllocateZeroPool(sizeof(*p_subscription))) ||
+      (0 < p_inventory->dimm_cnt &&
+       (NULL == (p_subscription->p_dimms = (struct event_subscription_dimm *)AllocateZeroPool(
+          sizeof(*p_subscription->p_dimms) * p_inventory->dimm_cnt)) ||
+        NULL == (p_subscription->p_jobs = (struct job *)AllocateZeroPool(
+          sizeof(*p_subscription->p_jobs) * p_inventory->dimm_cnt)) ||
+        NULL == (p_subscription->p_events = (struct device_state_event *)AllocateZeroPool(
+          sizeof(*p_subscription->p_events) * p_inventory->dimm_cnt * EVENT_SUBSCRIPTION_EVENTS_PER_DIMM)))) ||
+      NULL == (p_subscription->p_wake = os_sem_create(0))) {
+    NVDIMM_ERR("Failed to allocate memory\n");
+    rc = NVM_ERR_NO_MEM;
+    goto finish;
+  }
+  p_subscription->callback = callback;
+  p_subscription->p_context = p_context;
+  p_subscription->min_interval_ms = min_interval_ms;
+  p_subscription->max_interval_ms = max_interval_ms;
+  p_subscription->device_cnt = p_inventory->dimm_cnt;
+  for (i = 0; i < p_inventory->dimm_cnt; i++) {
+    if (MANAGEMENT_VALID_CONFIG != p_inventory->p_dimms[i].ManageabilityState) {
+      continue;
+    }
+    UnicodeStrToAsciiStrS(p_inventory->p_dimms[i].DimmUid, p_subscription->p_dimms[p_subscription->dimm_cnt].uid,
+      NVM_MAX_UID_LEN);
+    p_subscription->dimm_cnt++;
+  }
+  if (0 == p_subscription->dimm_cnt) {
+    rc = NVM_ERR_MANAGEABLE_DIMM_NOT_FOUND;
+    goto finish;
+  }
+
+  // the first poll is the baseline, only changes from it are reported
+  event_subscription_poll(p_subscription, os_get_monotonic_ms());
+  p_subscription->event_cnt = 0;
+
+  if (NULL == (p_subscription->p_thread = os_thread_create(event_subscription_thread, p_subscription))) {
+    NVDIMM_ERR("Failed to create the subscription thread\n");
+    rc = NVM_ERR_UNKNOWN;
+    goto finish;
+  }
+  *pp_subscription = p_subscription;
+  p_subscription = NULL;
+
+finish:
+  inventory_release(p_inventory);
+  nvm_unsubscribe_events(p_subscription);
+  return rc;
+}
+
+NVM_API_LOCKED(API_LOCK_SHARED, subscribe_events,
+  (const NVM_UINT32 min_interval_ms, const NVM_UINT32 max_interval_ms, NVM_DEVICE_STATE_CALLBACK callback, void *p_context, struct nvm_event_subscription **pp_subscription),
+  (min_interval_ms, max_interval_ms, callback, p_context, pp_subscription))
+
+NVM_API void nvm_unsubscribe_events(struct nvm_event_subscription *p_subscription)
+{
+  if (NULL == p_subscription) {
+    return;
+  }
+  if (NULL != p_subscription->p_thread) {
+    p_subscription->stop = 1;
+    os_sem_post(p_subscription->p_wake);
+    os_thread_join(p_subscription->p_thread);
+  }
+  if (NULL != p_subscription->p_wake) {
+    os_sem_delete(p_subscription->p_wake);
+  }
+  FREE_POOL_SAFE(p_subscription->p_dimms);
+  FREE_POOL_SAFE(p_subscription->p_jobs);
+  FREE_POOL_SAFE(p_subscription->p_events);
+  FREE_POOL_SAFE(p_subscription);
+}
+
 
 /*!
  * Number of characters allowed for Major revision portion of the revision string
@@ -1126,7 +2133,7 @@ enum fw_update_status firmware_update_status_to_enum(unsigned char last_fw_updat
   return fw_update_status;
 }
 
-NVM_API int nvm_get_device_fw_image_info(const NVM_UID    device_uid,
+static int nvm_internal_get_device_fw_image_info(const NVM_UID    device_uid,
            struct device_fw_info *p_fw_info)
 {
   EFI_STATUS ReturnCode;
@@ -1176,7 +2183,11 @@ NVM_API int nvm_get_device_fw_image_info(const NVM_UID    device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_update_device_fw(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_device_fw_image_info,
+  (const NVM_UID device_uid, struct device_fw_info *p_fw_info),
+  (device_uid, p_fw_info))
+
+static int nvm_internal_update_device_fw(const NVM_UID device_uid,
          const NVM_PATH path, const NVM_SIZE path_len, const NVM_BOOL force)
 {
   int rc = NVM_SUCCESS;
@@ -1218,7 +2229,11 @@ NVM_API int nvm_update_device_fw(const NVM_UID device_uid,
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_examine_device_fw(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, update_device_fw,
+  (const NVM_UID device_uid, const NVM_PATH path, const NVM_SIZE path_len, const NVM_BOOL force),
+  (device_uid, path, path_len, force))
+
+static int nvm_internal_examine_device_fw(const NVM_UID device_uid,
           const NVM_PATH path, const NVM_SIZE path_len,
           NVM_VERSION image_version, const NVM_SIZE image_version_len)
 {
@@ -1273,6 +2288,10 @@ NVM_API int nvm_examine_device_fw(const NVM_UID device_uid,
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, examine_device_fw,
+  (const NVM_UID device_uid, const NVM_PATH path, const NVM_SIZE path_len, NVM_VERSION image_version, const NVM_SIZE image_version_len),
+  (device_uid, path, path_len, image_version, image_version_len))
+
 int driver_features_to_nvm_features(
   const struct driver_feature_flags * p_driver_features,
   struct nvm_features *     p_nvm_features)
@@ -1358,7 +2377,7 @@ int driver_features_to_nvm_features(
   return rc;
 }
 
-NVM_API int nvm_get_nvm_capabilities(struct nvm_capabilities *p_capabilties)
+static int nvm_internal_get_nvm_capabilities(struct nvm_capabilities *p_capabilties)
 {
   int nvm_status;
 
@@ -1393,7 +2412,9 @@ NVM_API int nvm_get_nvm_capabilities(struct nvm_capabilities *p_capabilties)
     return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_nvm_capacities(struct device_capacities *p_capacities)
+NVM_API_LOCKED(API_LOCK_SHARED, get_nvm_capabilities, (struct nvm_capabilities *p_capabilties), (p_capabilties))
+
+static int nvm_internal_get_nvm_capacities(struct device_capacities *p_capacities)
 {
   UINT64 RawCapacity;
   UINT64 VolatileCapacity;
@@ -1452,6 +2473,8 @@ Finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_nvm_capacities, (struct device_capacities *p_capacities), (p_capacities))
+
 static void get_sensor_units(const enum sensor_type type, struct sensor *psensor)
 {
   switch (type) {
@@ -1511,12 +2534,13 @@ int fill_sensor_info(DIMM_SENSOR    DimmSensorsSet[SENSOR_TYPE_COUNT],
   }
 }
 
-NVM_API int nvm_get_sensors(const NVM_UID device_uid, struct sensor *p_sensors,
+static int nvm_internal_get_sensors(const NVM_UID device_uid, struct sensor *p_sensors,
           const NVM_UINT16 count)
 {
   EFI_STATUS ReturnCode;
   UINT16 dimm_id;
   DIMM_SENSOR DimmSensorsSet[SENSOR_TYPE_COUNT];
+  struct telemetry_dimm telemetry;
   int rc = NVM_SUCCESS;
   int i;
 
@@ -1526,6 +2550,11 @@ NVM_API int nvm_get_sensors(const NVM_UID device_uid, struct sensor *p_sensors,
     goto Finish;
   }
 
+  if (telemetry_lookup(device_uid, TELEMETRY_FAMILY_BIT(TELEMETRY_SENSORS), &telemetry)) {
+    CopyMem(p_sensors, telemetry.sensors, sizeof(telemetry.sensors));
+    goto Finish;
+  }
+
   if (NVM_SUCCESS != (rc = nvm_init())) {
     NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
     return rc;
@@ -1554,12 +2583,17 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_get_sensor(const NVM_UID device_uid, const enum sensor_type type,
+NVM_API_LOCKED(API_LOCK_SHARED, get_sensors,
+  (const NVM_UID device_uid, struct sensor *p_sensors, const NVM_UINT16 count),
+  (device_uid, p_sensors, count))
+
+static int nvm_internal_get_sensor(const NVM_UID device_uid, const enum sensor_type type,
          struct sensor *p_sensor)
 {
   EFI_STATUS EFIReturnCode = EFI_INVALID_PARAMETER;
   UINT16 dimm_id;
   DIMM_SENSOR DimmSensorsSet[SENSOR_TYPE_COUNT];
+  struct telemetry_dimm telemetry;
   int rc = NVM_SUCCESS;
 
   if (NULL == p_sensor) {
@@ -1568,6 +2602,12 @@ NVM_API int nvm_get_sensor(const NVM_UID device_uid, const enum sensor_type type
     goto Finish;
   }
 
+  if (type < SENSOR_COUNT &&
+      telemetry_lookup(device_uid, TELEMETRY_FAMILY_BIT(TELEMETRY_SENSORS), &telemetry)) {
+    *p_sensor = telemetry.sensors[type];
+    goto Finish;
+  }
+
   if (NVM_SUCCESS != (rc = nvm_init())) {
     NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
     goto Finish;
@@ -1594,7 +2634,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_set_sensor_settings(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_sensor,
+  (const NVM_UID device_uid, const enum sensor_type type, struct sensor *p_sensor),
+  (device_uid, type, p_sensor))
+
+static int nvm_internal_set_sensor_settings(const NVM_UID device_uid,
             const enum sensor_type type, const struct sensor_settings *p_settings)
 {
   EFI_STATUS ReturnCode;
@@ -1641,12 +2685,16 @@ Finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, set_sensor_settings,
+  (const NVM_UID device_uid, const enum sensor_type type, const struct sensor_settings *p_settings),
+  (device_uid, type, p_settings))
+
 NVM_API int nvm_get_number_of_regions( NVM_UINT8 *count)
 {
 	return nvm_get_number_of_regions_ex(FALSE, count);
 }
 
-NVM_API int nvm_get_number_of_regions_ex(const NVM_BOOL use_nfit, NVM_UINT8 *count)
+static int nvm_internal_get_number_of_regions_ex(const NVM_BOOL use_nfit, NVM_UINT8 *count)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   COMMAND_STATUS *pCommandStatus = NULL;
@@ -1682,11 +2730,15 @@ Finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_regions_ex,
+  (const NVM_BOOL use_nfit, NVM_UINT8 *count),
+  (use_nfit, count))
+
 NVM_API int nvm_get_regions( struct region *p_regions, NVM_UINT8 *count) {
 	return nvm_get_regions_ex(FALSE, p_regions, count);
 }
 
-NVM_API int nvm_get_regions_ex(const NVM_BOOL use_nfit, struct region *p_regions, NVM_UINT8 *count)
+static int nvm_internal_get_regions_ex(const NVM_BOOL use_nfit, struct region *p_regions, NVM_UINT8 *count)
 {
   COMMAND_STATUS *pCommandStatus = NULL;
   NVM_UINT8 RegionCount, Index, DimmIndex;
@@ -1749,7 +2801,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_create_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count,
+NVM_API_LOCKED(API_LOCK_SHARED, get_regions_ex,
+  (const NVM_BOOL use_nfit, struct region *p_regions, NVM_UINT8 *count),
+  (use_nfit, p_regions, count))
+
+static int nvm_internal_create_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count,
            struct config_goal_input *p_goal_input)
 {
   COMMAND_STATUS *pCommandStatus = NULL;
@@ -1808,7 +2864,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_get_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, create_config_goal,
+  (NVM_UID *p_device_uids, NVM_UINT32 device_uids_count, struct config_goal_input *p_goal_input),
+  (p_device_uids, device_uids_count, p_goal_input))
+
+static int nvm_internal_get_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count,
         struct config_goal *p_goal)
 {
   COMMAND_STATUS *pCommandStatus = NULL;
@@ -1901,7 +2961,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_delete_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count)
+NVM_API_LOCKED(API_LOCK_SHARED, get_config_goal,
+  (NVM_UID *p_device_uids, NVM_UINT32 device_uids_count, struct config_goal *p_goal),
+  (p_device_uids, device_uids_count, p_goal))
+
+static int nvm_internal_delete_config_goal(NVM_UID *p_device_uids, NVM_UINT32 device_uids_count)
 {
   COMMAND_STATUS *pCommandStatus = NULL;
   UINT16 *p_dimm_ids = NULL;
@@ -1951,9 +3015,13 @@ Finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, delete_config_goal,
+  (NVM_UID *p_device_uids, NVM_UINT32 device_uids_count),
+  (p_device_uids, device_uids_count))
+
 
 
-NVM_API int nvm_dump_goal_config(const NVM_PATH file,
+static int nvm_internal_dump_goal_config(const NVM_PATH file,
          const NVM_SIZE file_len)
 {
   int rc = NVM_SUCCESS;
@@ -1985,8 +3053,12 @@ NVM_API int nvm_dump_goal_config(const NVM_PATH file,
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, dump_goal_config,
+  (const NVM_PATH file, const NVM_SIZE file_len),
+  (file, file_len))
 
-NVM_API int nvm_load_goal_config(const NVM_PATH file,
+
+static int nvm_internal_load_goal_config(const NVM_PATH file,
          const NVM_SIZE file_len)
 {
   int rc = NVM_SUCCESS;
@@ -2080,6 +3152,10 @@ Finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, load_goal_config,
+  (const NVM_PATH file, const NVM_SIZE file_len),
+  (file, file_len))
+
 void get_version_numbers(int *major, int *minor, int *hotfix, int *build)
 {
   int first = 0;
@@ -2162,7 +3238,7 @@ EFI_STATUS execute_cli_cmd(wchar_t * CmdLine)
   return ReturnCode;
 }
 
-NVM_API int nvm_gather_support(const NVM_PATH support_file, const NVM_SIZE support_file_len)
+static int nvm_internal_gather_support(const NVM_PATH support_file, const NVM_SIZE support_file_len)
 {
   int rc = NVM_SUCCESS;
   unsigned int Index;
@@ -2197,14 +3273,19 @@ NVM_API int nvm_gather_support(const NVM_PATH support_file, const NVM_SIZE suppo
     execute_cli_cmd(exec_commands[Index]);
   }
 
+  PrintFlush();
   fclose(gOsShellParametersProtocol.StdOut);
   gOsShellParametersProtocol.StdOut = stdout;
 
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, gather_support,
+  (const NVM_PATH support_file, const NVM_SIZE support_file_len),
+  (support_file, support_file_len))
 
-NVM_API int nvm_inject_device_error(const NVM_UID		device_uid,
+
+static int nvm_internal_inject_device_error(const NVM_UID		device_uid,
             const struct device_error * p_error)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -2243,7 +3324,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_clear_injected_device_error(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, inject_device_error,
+  (const NVM_UID device_uid, const struct device_error * p_error),
+  (device_uid, p_error))
+
+static int nvm_internal_clear_injected_device_error(const NVM_UID device_uid,
               const struct device_error *p_error)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -2282,7 +3367,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_run_diagnostic(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, clear_injected_device_error,
+  (const NVM_UID device_uid, const struct device_error *p_error),
+  (device_uid, p_error))
+
+static int nvm_internal_run_diagnostic(const NVM_UID device_uid,
              const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
@@ -2347,7 +3436,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_set_user_preference(const NVM_PREFERENCE_KEY  key,
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, run_diagnostic,
+  (const NVM_UID device_uid, const struct diagnostic *p_diagnostic, NVM_UINT32 *p_results),
+  (device_uid, p_diagnostic, p_results))
+
+static int nvm_internal_set_user_preference(const NVM_PREFERENCE_KEY  key,
             const NVM_PREFERENCE_VALUE  value)
 {
   int nvm_status;
@@ -2387,6 +3480,10 @@ NVM_API int nvm_set_user_preference(const NVM_PREFERENCE_KEY  key,
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, set_user_preference,
+  (const NVM_PREFERENCE_KEY key, const NVM_PREFERENCE_VALUE value),
+  (key, value))
+
 /*
  * Function enables disables the debug logger
  */
@@ -2396,7 +3493,7 @@ extern int EFIAPI DebugLoggerEnable(IN BOOLEAN EnableDbgLogger);
 */
 extern BOOLEAN EFIAPI IsDebugLoggerEnabled();
 
-NVM_API int nvm_debug_logging_enabled()
+static int nvm_internal_debug_logging_enabled()
 {
   int rc = NVM_SUCCESS;
 
@@ -2407,7 +3504,9 @@ NVM_API int nvm_debug_logging_enabled()
   return IsDebugLoggerEnabled();
 }
 
-NVM_API int nvm_toggle_debug_logging(const NVM_BOOL enabled)
+NVM_API_LOCKED(API_LOCK_SHARED, debug_logging_enabled, (), ())
+
+static int nvm_internal_toggle_debug_logging(const NVM_BOOL enabled)
 {
   int rc = NVM_SUCCESS;
 
@@ -2418,12 +3517,14 @@ NVM_API int nvm_toggle_debug_logging(const NVM_BOOL enabled)
   return DebugLoggerEnable(enabled);
 }
 
-NVM_API int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, toggle_debug_logging, (const NVM_BOOL enabled), (enabled))
+
+static int nvm_internal_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
 {
   EFI_STATUS ReturnCode = EFI_SUCCESS;
   int rc = NVM_SUCCESS;
   NVM_FW_CMD *cmd;
-  DIMM_INFO *pDimms = NULL;
+  DIMM_INFO_CORE *pDimms = NULL;
   UINT32 DimmCount = 0;
   PT_OUTPUT_PAYLOAD_FW_LONG_OP_STATUS *pLongOpStatus;
   int job_index = 0;
@@ -2434,6 +3535,10 @@ NVM_API int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
   if (NULL == p_jobs)
     return NVM_ERR_INVALID_PARAMETER;
 
+  if (API_LOCK_EXCLUSIVE != g_api_lock_mode && telemetry_get_jobs(p_jobs, count)) {
+    return NVM_SUCCESS;
+  }
+
   if (NVM_SUCCESS != (rc = nvm_init())) {
     NVDIMM_ERR("Failed to intialize nvm library %d\n", rc);
     return rc;
@@ -2458,9 +3563,9 @@ NVM_API int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
 
   ZeroMem(cmd, sizeof(NVM_FW_CMD));
   pLongOpStatus = (PT_OUTPUT_PAYLOAD_FW_LONG_OP_STATUS *)cmd->OutPayload;
-  // Populate the list of DIMM_INFO structures with relevant information
+  // Only the DimmID and the UID of each DIMM are needed
   CmdStub.pPrintCtx = NULL;
-  ReturnCode = GetDimmList(&gNvmDimmDriverNvmDimmConfig, &CmdStub, DIMM_INFO_CATEGORY_NONE, &pDimms, &DimmCount);
+  ReturnCode = GetDimmCoreList(&gNvmDimmDriverNvmDimmConfig, &CmdStub, &pDimms, &DimmCount);
   if (EFI_ERROR(ReturnCode)) {
     NVDIMM_ERR("Failed to get dimm list %d\n", (int)ReturnCode);
     FreePool(cmd);
@@ -2518,10 +3623,13 @@ NVM_API int nvm_get_jobs(struct job *p_jobs, const NVM_UINT32 count)
     p_jobs[i].result = NULL;
     job_index++;
   }
+  FREE_POOL_SAFE(pDimms);
   FreePool(cmd);
   return NVM_SUCCESS;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_jobs, (struct job *p_jobs, const NVM_UINT32 count), (p_jobs, count))
+
 NVM_API int nvm_create_context()
 {
   return NVM_SUCCESS;
@@ -2532,7 +3640,7 @@ NVM_API int nvm_free_context(const NVM_BOOL force)
   return NVM_SUCCESS;
 }
 
-NVM_API int nvm_get_fw_error_log_entry_cmd(
+static int nvm_internal_get_fw_error_log_entry_cmd(
   const NVM_UID   device_uid,
   const unsigned short  seq_num,
   const unsigned char log_level,
@@ -2606,7 +3714,11 @@ Finish:
   return rc;
 }
 
-NVM_API int nvm_get_config_int(const char *param_name, int default_val)
+NVM_API_LOCKED(API_LOCK_SHARED, get_fw_error_log_entry_cmd,
+  (const NVM_UID device_uid, const unsigned short seq_num, const unsigned char log_level, const unsigned char log_type, ERROR_LOG * error_entry),
+  (device_uid, seq_num, log_level, log_type, error_entry))
+
+static int nvm_internal_get_config_int(const char *param_name, int default_val)
 {
   int val = default_val;
   unsigned long long size = sizeof(val);
@@ -2621,7 +3733,9 @@ NVM_API int nvm_get_config_int(const char *param_name, int default_val)
   return val;
 }
 
-NVM_API int nvm_get_fw_err_log_stats(const NVM_UID      device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_config_int, (const char *param_name, int default_val), (param_name, default_val))
+
+static int nvm_internal_get_fw_err_log_stats(const NVM_UID      device_uid,
              struct device_error_log_status * error_log_stats)
 {
   UINT16 dimm_id;
@@ -2671,7 +3785,11 @@ NVM_API int nvm_get_fw_err_log_stats(const NVM_UID      device_uid,
   return rc;
 }
 
-NVM_API int nvm_get_dimm_id(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_fw_err_log_stats,
+  (const NVM_UID device_uid, struct device_error_log_status * error_log_stats),
+  (device_uid, error_log_stats))
+
+static int nvm_internal_get_dimm_id(const NVM_UID device_uid,
           unsigned int *  dimm_id,
           unsigned int *  dimm_handle)
 {
@@ -2685,48 +3803,40 @@ NVM_API int nvm_get_dimm_id(const NVM_UID device_uid,
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_SHARED, get_dimm_id,
+  (const NVM_UID device_uid, unsigned int * dimm_id, unsigned int * dimm_handle),
+  (device_uid, dimm_id, dimm_handle))
+
 int get_dimm_id(const char *uid, UINT16 *dimm_id, unsigned int *dimm_handle)
 {
   EFI_STATUS rc;
   CHAR16 uid_wide[MAX_DIMM_UID_LENGTH];
+  NVM_INVENTORY *p_inventory = NULL;
+  int nvm_status = NVM_ERR_UNKNOWN;
   unsigned int i;
 
-  if (NULL == g_dimms) {
-    if (NVM_SUCCESS != nvm_get_number_of_devices(&g_dimm_cnt)) {
-      NVDIMM_ERR("Failed to get number of devices\n");
-      return NVM_ERR_UNKNOWN;
-    }
-
-    g_dimms = (DIMM_INFO *)AllocatePool(sizeof(DIMM_INFO) * g_dimm_cnt);
-    if (NULL == g_dimms) {
-      NVDIMM_ERR("Failed to allocate memory\n");
-      return NVM_ERR_UNKNOWN;
-    }
-
-    rc = gNvmDimmDriverNvmDimmConfig.GetDimms(&gNvmDimmDriverNvmDimmConfig, (UINT32)g_dimm_cnt, DIMM_INFO_CATEGORY_NONE, g_dimms);
-    if (EFI_ERROR(rc)) {
-      FreePool(g_dimms);
-      g_dimms = NULL;
-      NVDIMM_ERR("GetDimms failed (%d)\n", rc);
-      return NVM_ERR_UNKNOWN;
-    }
-  }
-
   rc = AsciiStrToUnicodeStrS(uid, uid_wide, MAX_DIMM_UID_LENGTH);
   if (EFI_ERROR(rc)) {
     NVDIMM_ERR("Failed while converting uid (%s) to UniCode. (%d)\n", uid, rc);
     return NVM_ERR_UNKNOWN;
   }
-  for (i = 0; i < g_dimm_cnt; ++i) {
-    if (0 == StrCmp(uid_wide, g_dimms[i].DimmUid)) {
+
+  if (NVM_SUCCESS != inventory_acquire(&p_inventory)) {
+    NVDIMM_ERR("Failed to get the DIMM inventory\n");
+    return NVM_ERR_UNKNOWN;
+  }
+  for (i = 0; i < p_inventory->dimm_cnt; ++i) {
+    if (0 == StrCmp(uid_wide, p_inventory->p_dimms[i].DimmUid)) {
       if (dimm_id)
-        *dimm_id = g_dimms[i].DimmID;
+        *dimm_id = p_inventory->p_dimms[i].DimmID;
       if (dimm_handle)
-        *dimm_handle = g_dimms[i].DimmHandle;
-      return NVM_SUCCESS;
+        *dimm_handle = p_inventory->p_dimms[i].DimmHandle;
+      nvm_status = NVM_SUCCESS;
+      break;
     }
   }
-  return NVM_ERR_UNKNOWN;
+  inventory_release(p_inventory);
+  return nvm_status;
 }
 
 void dimm_info_to_device_discovery(DIMM_INFO *p_dimm, struct device_discovery *p_device)
@@ -2808,7 +3918,7 @@ finish:
   return rc;
 }
 
-NVM_API int nvm_send_device_passthrough_cmd(const NVM_UID   device_uid,
+static int nvm_internal_send_device_passthrough_cmd(const NVM_UID   device_uid,
               struct device_pt_cmd *  p_cmd)
 {
   NVM_FW_CMD *cmd = NULL;
@@ -2901,6 +4011,10 @@ finish:
   return rc;
 }
 
+NVM_API_LOCKED(API_LOCK_EXCLUSIVE, send_device_passthrough_cmd,
+  (const NVM_UID device_uid, struct device_pt_cmd * p_cmd),
+  (device_uid, p_cmd))
+
 static int nvm_get_command_effect_log_helper(const NVM_UID device_uid,
   NVM_UINT32 *p_cel_count,
   struct command_effect_log **pp_cel)
@@ -2931,7 +4045,7 @@ static int nvm_get_command_effect_log_helper(const NVM_UID device_uid,
   return rc;
 }
 
-NVM_API int nvm_get_number_of_command_effect_log_entries(const NVM_UID device_uid,
+static int nvm_internal_get_number_of_command_effect_log_entries(const NVM_UID device_uid,
   NVM_UINT32 *p_count)
 {
   int rc = NVM_SUCCESS;
@@ -2961,7 +4075,11 @@ finish:
   return rc;
 }
 
-NVM_API int nvm_get_command_effect_log(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_command_effect_log_entries,
+  (const NVM_UID device_uid, NVM_UINT32 *p_count),
+  (device_uid, p_count))
+
+static int nvm_internal_get_command_effect_log(const NVM_UID device_uid,
   struct command_effect_log *p_cel,
   const NVM_UINT32 count)
 {
@@ -3001,7 +4119,11 @@ finish:
   return rc;
 }
 
-NVM_API int nvm_get_command_access_policy(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_command_effect_log,
+  (const NVM_UID device_uid, struct command_effect_log *p_cel, const NVM_UINT32 count),
+  (device_uid, p_cel, count))
+
+static int nvm_internal_get_command_access_policy(const NVM_UID device_uid,
           NVM_UINT32 *p_cap_count,
           struct command_access_policy *p_cap)
 {
@@ -3071,7 +4193,11 @@ finish:
   return rc;
 }
 
-NVM_API int nvm_get_number_of_cap_entries(const NVM_UID device_uid,
+NVM_API_LOCKED(API_LOCK_SHARED, get_command_access_policy,
+  (const NVM_UID device_uid, NVM_UINT32 *p_cap_count, struct command_access_policy *p_cap),
+  (device_uid, p_cap_count, p_cap))
+
+static int nvm_internal_get_number_of_cap_entries(const NVM_UID device_uid,
   NVM_UINT32 *p_count)
 {
   UINT16 dimm_id;
@@ -3104,3 +4230,8 @@ NVM_API int nvm_get_number_of_cap_entries(const NVM_UID device_uid,
 
   return rc;
 }
+
+NVM_API_LOCKED(API_LOCK_SHARED, get_number_of_cap_entries,
+  (const NVM_UID device_uid, NVM_UINT32 *p_count),
+  (device_uid, p_count))
+
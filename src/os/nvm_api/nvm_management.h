@@ -41,7 +41,22 @@
  * The following C macros and interfaces are provided to retrieve the native API version information.
  *
  * @subsection Concurrency
- * The management library is not thread-safe.
+ * The management library can be called from several threads of one process. Queries run in
+ * parallel, FW commands to one PMem module are serialized while commands to different modules
+ * are not. Calls that change the configuration or the FW (goals, FW update, sensor settings,
+ * error injection, preferences, passthrough commands, running the CLI) wait for the calls in
+ * progress and run alone. The same split holds between processes using the library, through
+ * a lock file (/var/lock/ipmctl_api.lock on Linux, %ProgramData%\ipmctl_api.lock on Windows):
+ * queries of several processes run in parallel while a change excludes every other process.
+ * On Linux the lock file is private to root, processes of other users are not coordinated.
+ * Use nvm_sync_lock_api() and nvm_sync_unlock_api() to run a sequence of calls alone.
+ *
+ * @subsection Telemetry
+ * When the optional ipmctld daemon runs, nvm_get_sensors(), nvm_get_sensor(),
+ * nvm_get_device_status(), nvm_get_device_performance() and nvm_get_jobs() return what it last
+ * polled, read from shared memory without FW commands. The results are at most one daemon poll
+ * interval old, except after a change made by the calling process, which is never hidden. Without
+ * the daemon, or when its results are stale, the PMem modules are read directly.
  *
  * <table>
  * <tr><td>Synopsis</td><td><strong>int nvm_get_major_version</strong>();</td></tr>
@@ -749,6 +764,76 @@ struct device_performance {
   NVM_UINT8     reserved[8];   ///< reserved
 };
 
+/**
+ * Change of the performance metrics of a specific device over one sampling interval.
+ * @remarks Deltas are taken modulo 2^64 from the lifetime counters, so a counter
+ * wrapping during the interval still yields its increment.
+ */
+struct device_performance_rate {
+  NVM_UID	uid;                    ///< The device the metrics belong to
+  int		rc;                     ///< ::NVM_SUCCESS, or the error sampling the device. The metrics are only valid on success.
+  NVM_UINT64	interval_ms;            ///< Milliseconds between the two samples
+  NVM_UINT64	bytes_read;             ///< Number of 64 byte reads from media during the interval
+  NVM_UINT64	host_reads;             ///< Number of DDRT read transactions serviced during the interval
+  NVM_UINT64	bytes_written;          ///< Number of 64 byte writes to media during the interval
+  NVM_UINT64	host_writes;            ///< Number of DDRT write transactions serviced during the interval
+  NVM_UINT64	bytes_read_per_sec;     ///< bytes_read per second of the interval
+  NVM_UINT64	host_reads_per_sec;     ///< host_reads per second of the interval
+  NVM_UINT64	bytes_written_per_sec;  ///< bytes_written per second of the interval
+  NVM_UINT64	host_writes_per_sec;    ///< host_writes per second of the interval
+  NVM_UINT8	reserved[16];           ///< reserved
+};
+
+/**
+ * Samples the performance metrics of every manageable device on a fixed schedule,
+ * see #nvm_create_performance_sampler. Opaque to the caller.
+ */
+struct nvm_performance_sampler;
+
+/**
+ * Counters of the work done by the library since the last reset.
+ * @remarks Intended for benchmarking, counters are approximate when the library is used from
+ * several threads at once. The library only counts after the first #nvm_reset_usage_counters.
+ */
+struct nvm_usage_counters {
+  NVM_UINT64	allocations;     ///< Number of memory allocations made by the library
+  NVM_UINT64	allocated_bytes; ///< Total bytes requested by those allocations
+  NVM_UINT64	fw_commands;     ///< Number of FW commands issued, including commands served by session playback
+};
+
+/**
+ * Phases of bringing up the library, see #nvm_get_startup_profile
+ */
+enum startup_phase {
+  STARTUP_PHASE_PREFERENCES = 0,  ///< Loading the preferences
+  STARTUP_PHASE_ACPI = 1,         ///< Loading and parsing the ACPI and SMBIOS tables
+  STARTUP_PHASE_DIMMS = 2,        ///< Initializing the PMem modules, one run for all of them
+  STARTUP_PHASE_PCD = 3,          ///< Reading the PCD of a PMem module, one run per module, part of STARTUP_PHASE_REGIONS
+  STARTUP_PHASE_REGIONS = 4,      ///< Building the regions, on first use
+  STARTUP_PHASE_NAMESPACES = 5,   ///< Enumerating the namespaces in the LSA, on first use
+  STARTUP_PHASE_ARS = 6,          ///< Loading the ARS bad address list, not done by the library
+  STARTUP_PHASE_BINDING = 7,      ///< The whole driver initialization
+  STARTUP_PHASE_COUNT = 8
+};
+
+/**
+ * Time spent in one phase of bringing up the library
+ */
+struct nvm_startup_phase_time {
+  NVM_UINT64	time_us;   ///< Sum of the time of all runs in microseconds
+  NVM_UINT32	runs;      ///< Times the phase ran
+};
+
+/**
+ * Where bringing up the library spent its time since the last reset.
+ * @remarks Regions and namespaces are only built when first used, their phases
+ * show up after a call that needs them.
+ */
+struct nvm_startup_profile {
+  struct nvm_startup_phase_time	phases[STARTUP_PHASE_COUNT]; ///< Indexed by ::startup_phase
+  NVM_UINT32	dimm_count;                                   ///< PMem modules initialized by the last STARTUP_PHASE_DIMMS
+};
+
 /**
  * The threshold settings for a particular sensor
  */
@@ -1141,6 +1226,42 @@ struct job {
   NVM_UINT8		reserved[64];		///< reserved
 };
 
+/**
+ * Kind of state transition reported by an event subscription, see #nvm_subscribe_events.
+ */
+enum device_state_change {
+  DEVICE_STATE_CHANGE_READABLE = 0,         ///< The device stopped or resumed answering, values are 0 unreadable, 1 readable
+  DEVICE_STATE_CHANGE_HEALTH = 1,           ///< The health changed, values are #health_status
+  DEVICE_STATE_CHANGE_SENSOR_STATE = 2,     ///< A sensor reading moved to another range of its thresholds, values are #sensor_status
+  DEVICE_STATE_CHANGE_ALARM_THRESHOLD = 3,  ///< The alarm threshold of a sensor changed, values are thresholds
+  DEVICE_STATE_CHANGE_ALARM_ENABLED = 4,    ///< The alarm of a sensor was enabled or disabled, values are 0 disabled, 1 enabled
+  DEVICE_STATE_CHANGE_ERROR_LOG = 5,        ///< New FW error log entries, values are entry counts
+  DEVICE_STATE_CHANGE_JOB = 6               ///< The long operation status changed, values are #nvm_job_status
+};
+
+/**
+ * A state transition of a device, see #nvm_subscribe_events.
+ */
+struct device_state_event {
+  NVM_UID			uid;          ///< The device that changed
+  enum device_state_change	change;       ///< What changed
+  enum sensor_type		sensor;       ///< The sensor that changed, for the sensor and alarm changes
+  NVM_UINT64			old_value;    ///< Value before the change, see #device_state_change
+  NVM_UINT64			new_value;    ///< Value after the change, see #device_state_change
+  time_t			time;         ///< The time the change was noticed
+  NVM_UINT8			reserved[16]; ///< reserved
+};
+
+/**
+ * Called by an event subscription with each state transition, see #nvm_subscribe_events.
+ */
+typedef void (*NVM_DEVICE_STATE_CALLBACK)(const struct device_state_event *p_event, void *p_context);
+
+/**
+ * Watches the state of every manageable device, see #nvm_subscribe_events. Opaque to the caller.
+ */
+struct nvm_event_subscription;
+
 /**
  * Describes a command effect log entry.
  */
@@ -1510,6 +1631,88 @@ NVM_API int nvm_get_device_details(const NVM_UID device_uid, struct device_detai
  */
 NVM_API int nvm_get_device_performance(const NVM_UID device_uid, struct device_performance *p_performance);
 
+/**
+ * @brief Start sampling the performance metrics of every manageable device.
+ * The first sample is taken right away, the following ones are due every interval_ms
+ * from then on. Due times missed by a late caller are skipped rather than bunched up.
+ * The library stays initialized while the sampler exists, so samples cost one
+ * firmware command per device and the devices are read in parallel when possible.
+ * @param[in] interval_ms
+ *              Milliseconds between samples, at least 1.
+ * @param[in] history
+ *              Number of past intervals kept for #nvm_get_device_performance_history, at least 1.
+ * @param[out] pp_sampler
+ *              The new sampler, release it with #nvm_free_performance_sampler.
+ * @pre The caller must have administrative privileges.
+ * @remarks A sampler is not meant to be shared between threads.
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ *            ::NVM_ERR_MANAGEABLE_DIMM_NOT_FOUND @n
+ *            ::NVM_ERR_NO_MEM @n
+ *            ::NVM_ERR_UNKNOWN @n
+ */
+NVM_API int nvm_create_performance_sampler(const NVM_UINT32 interval_ms, const NVM_UINT32 history,
+  struct nvm_performance_sampler **pp_sampler);
+
+/**
+ * @brief Retrieve the number of devices sampled by a sampler.
+ * @param[in] p_sampler
+ *              Sampler from #nvm_create_performance_sampler.
+ * @param[out] p_count
+ *              Number of #device_performance_rate entries filled by the sampler.
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ */
+NVM_API int nvm_get_performance_sampler_device_count(const struct nvm_performance_sampler *p_sampler,
+  NVM_UINT8 *p_count);
+
+/**
+ * @brief Wait until the next sample is due, take it and retrieve the change of
+ * the performance metrics of each sampled device since the previous sample.
+ * @param[in] p_sampler
+ *              Sampler from #nvm_create_performance_sampler.
+ * @param[in,out] p_rates
+ *              Array of #device_performance_rate structures allocated by the caller.
+ * @param[in] count
+ *              The number of elements in the array, see #nvm_get_performance_sampler_device_count.
+ * @remarks Other library calls are not held up while the sampler waits.
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ *            ::NVM_ERR_BAD_SIZE @n
+ */
+NVM_API int nvm_sample_device_performance(struct nvm_performance_sampler *p_sampler,
+  struct device_performance_rate *p_rates, const NVM_UINT8 count);
+
+/**
+ * @brief Retrieve the change of the performance metrics of each sampled device
+ * over a past interval, without taking a sample.
+ * @param[in] p_sampler
+ *              Sampler from #nvm_create_performance_sampler.
+ * @param[in] age
+ *              0 for the interval ending at the latest sample, 1 for the one before and so on.
+ *              Intervals older than the history of the sampler are an invalid parameter.
+ * @param[in,out] p_rates
+ *              Array of #device_performance_rate structures allocated by the caller.
+ * @param[in] count
+ *              The number of elements in the array, see #nvm_get_performance_sampler_device_count.
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ *            ::NVM_ERR_BAD_SIZE @n
+ */
+NVM_API int nvm_get_device_performance_history(const struct nvm_performance_sampler *p_sampler,
+  const NVM_UINT32 age, struct device_performance_rate *p_rates, const NVM_UINT8 count);
+
+/**
+ * @brief Release a sampler from #nvm_create_performance_sampler.
+ * @param[in] p_sampler
+ *              Sampler to release, may be NULL.
+ */
+NVM_API void nvm_free_performance_sampler(struct nvm_performance_sampler *p_sampler);
+
 /**
  * @brief Retrieve the firmware image log information from the device specified.
  * @param[in] device_uid
@@ -1756,6 +1959,43 @@ NVM_API int nvm_purge_events(const struct event_filter *p_filter);
  */
 NVM_API int nvm_acknowledge_event(NVM_UINT32 event_id);
 
+/**
+ * @brief Watch the health, the sensors, the alarm thresholds, the FW error log and the
+ * long operation status of every manageable device, and report each state transition.
+ * The state at subscription is the baseline and is not reported.
+ * @param[in] min_interval_ms
+ *              Milliseconds between two polls of a device while it is degraded or changing, at least 1.
+ * @param[in] max_interval_ms
+ *              Milliseconds between two polls of a device while it is stable, at least min_interval_ms.
+ *              The interval doubles from min_interval_ms up to it for as long as nothing changes.
+ * @param[in] callback
+ *              Called with each transition from a thread of the subscription, one call at a time.
+ *              Other library functions may be called from it, except #nvm_unsubscribe_events.
+ * @param[in] p_context
+ *              Passed to the callback as is.
+ * @param[out] pp_subscription
+ *              The new subscription, end it with #nvm_unsubscribe_events.
+ * @pre The caller must have administrative privileges.
+ * @remarks A device is degraded while it is not healthy, a sensor is out of its normal
+ * range or a long operation runs on it. Stable devices cost few firmware commands.
+ * @remarks The library stays initialized while the subscription exists.
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ *            ::NVM_ERR_MANAGEABLE_DIMM_NOT_FOUND @n
+ *            ::NVM_ERR_NO_MEM @n
+ *            ::NVM_ERR_UNKNOWN @n
+ */
+NVM_API int nvm_subscribe_events(const NVM_UINT32 min_interval_ms, const NVM_UINT32 max_interval_ms,
+  NVM_DEVICE_STATE_CALLBACK callback, void *p_context, struct nvm_event_subscription **pp_subscription);
+
+/**
+ * @brief End a subscription from #nvm_subscribe_events. No callback runs once it returns.
+ * @param[in] p_subscription
+ *              Subscription to end, may be NULL.
+ */
+NVM_API void nvm_unsubscribe_events(struct nvm_event_subscription *p_subscription);
+
 /**
  * @brief Retrieve the number of configured PMem regions in the host server.
  * @pre The caller has administrative privileges.
@@ -2291,12 +2531,48 @@ NVM_API int nvm_get_number_of_cap_entries(const NVM_UID   device_uid, NVM_UINT32
 
 
 /**
-* @brief Lock API
+ * @brief Retrieve the library usage counters accumulated since the last reset.
+ * @param[out] p_counters
+ *              A caller supplied buffer to hold the counters
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ */
+NVM_API int nvm_get_usage_counters(struct nvm_usage_counters *p_counters);
+
+/**
+ * @brief Reset the library usage counters to zero. The first reset turns counting on, until
+ * then the counters stay zero and cost nothing.
+ * @return
+ *            ::NVM_SUCCESS @n
+ */
+NVM_API int nvm_reset_usage_counters();
+
+/**
+ * @brief Retrieve the startup profile of the library accumulated since the last reset.
+ * @param[out] p_profile
+ *              A caller supplied buffer to hold the profile
+ * @return
+ *            ::NVM_SUCCESS @n
+ *            ::NVM_ERR_INVALID_PARAMETER @n
+ */
+NVM_API int nvm_get_startup_profile(struct nvm_startup_profile *p_profile);
+
+/**
+ * @brief Reset the startup profile of the library.
+ * @return
+ *            ::NVM_SUCCESS @n
+ */
+NVM_API int nvm_reset_startup_profile();
+
+/**
+* @brief Run the following API calls of the calling thread alone, other threads and
+* processes wait until nvm_sync_unlock_api(). Not needed around single calls.
 */
 NVM_API void nvm_sync_lock_api();
 
 /**
-* @brief Unlock API
+* @brief Release the lock taken by nvm_sync_lock_api() on the same thread
 */
 NVM_API void nvm_sync_unlock_api();
 
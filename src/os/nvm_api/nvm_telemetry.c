@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Reader and writer of the ipmctld telemetry snapshot, see nvm_telemetry.h.
+ */
+
+#include "nvm_telemetry.h"
+#include <string.h>
+#include <os.h>
+
+typedef int (*TELEMETRY_COPY)(const struct telemetry_region *p_region, NVM_UINT64 now_ms, void *p_ctx);
+
+static OS_ONCE g_telemetry_once = OS_ONCE_INIT;
+static OS_MUTEX *g_telemetry_mutex;                 // guards the reader state below
+static const struct telemetry_region *g_telemetry;  // mapped region, NULL if none
+static NVM_UINT64 g_telemetry_retry_ms;             // no attempt to map the region before
+static NVM_UINT64 g_telemetry_changed_ms;           // polls started up to then are not served
+
+static void telemetry_init_once()
+{
+  g_telemetry_mutex = os_mutex_init(NULL);
+}
+
+/*
+ * Returns how long before now_ms the daemon took time_ms, 0 if it was after
+ */
+static NVM_UINT64 telemetry_age_ms(NVM_UINT64 time_ms, NVM_UINT64 now_ms)
+{
+  return (now_ms > time_ms) ? now_ms - time_ms : 0;
+}
+
+/*
+ * Checks that the daemon behind the region is still running and is not the caller,
+ * which reads the PMem modules to fill it
+ */
+static int telemetry_alive(const struct telemetry_region *p_region, NVM_UINT64 now_ms)
+{
+  return NVM_TELEMETRY_MAGIC == p_region->magic &&
+    os_get_pid() != p_region->pid &&
+    telemetry_age_ms(p_region->heartbeat_ms, now_ms) <= NVM_TELEMETRY_HEARTBEAT_TIMEOUT_MS;
+}
+
+/*
+ * Returns the region of a running daemon, mapping it first if needed.
+ * Called with g_telemetry_mutex held.
+ */
+static const struct telemetry_region *telemetry_map(NVM_UINT64 now_ms)
+{
+  const struct telemetry_region *p_region = g_telemetry;
+
+  if (NULL != p_region && !telemetry_alive(p_region, now_ms)) {
+    // a restarted daemon publishes a new region, let go of the old one
+    os_shm_close(p_region, sizeof(*p_region));
+    p_region = g_telemetry = NULL;
+  }
+  // without a daemon the attempts are spaced out, the common case stays one clock read
+  if (NULL == p_region && now_ms >= g_telemetry_retry_ms) {
+    g_telemetry_retry_ms = now_ms + NVM_TELEMETRY_HEARTBEAT_MS;
+    p_region = (const struct telemetry_region *)os_shm_open(NVM_TELEMETRY_SHM_NAME, sizeof(*p_region));
+    if (NULL != p_region &&
+        (NVM_TELEMETRY_VERSION != p_region->version || sizeof(*p_region) != p_region->size ||
+         !telemetry_alive(p_region, now_ms))) {
+      os_shm_close(p_region, sizeof(*p_region));
+      p_region = NULL;
+    }
+    g_telemetry = p_region;
+  }
+  return p_region;
+}
+
+/*
+ * Checks that the last polls of families are recent enough to be served
+ */
+static int telemetry_fresh(const struct telemetry_region *p_region, NVM_UINT32 families,
+  NVM_UINT64 now_ms)
+{
+  NVM_UINT64 updated_ms;
+  int family;
+
+  for (family = 0; family < TELEMETRY_FAMILY_COUNT; family++) {
+    if (0 == (families & TELEMETRY_FAMILY_BIT(family))) {
+      continue;
+    }
+    updated_ms = p_region->updated_ms[family];
+    if (0 == updated_ms || updated_ms <= g_telemetry_changed_ms ||
+        telemetry_age_ms(updated_ms, now_ms) > p_region->max_age_ms[family]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Runs p_copy on a consistent view of the region. What p_copy reads may be
+ * torn while the daemon writes, its result only counts when the sequence did
+ * not move meanwhile. Returns the result of p_copy, 0 if there is no daemon or
+ * it kept writing through every retry.
+ */
+static int telemetry_read(TELEMETRY_COPY p_copy, void *p_ctx)
+{
+  const struct telemetry_region *p_region = NULL;
+  NVM_UINT64 now_ms = os_get_monotonic_ms();
+  NVM_UINT64 seq;
+  int rc = 0;
+  int retry;
+
+  os_once(&g_telemetry_once, telemetry_init_once);
+  if (NULL == g_telemetry_mutex) {
+    return 0;
+  }
+
+  os_mutex_lock(g_telemetry_mutex);
+  if (NULL == (p_region = telemetry_map(now_ms))) {
+    goto Finish;
+  }
+  for (retry = 0; retry < NVM_TELEMETRY_READ_RETRIES; retry++) {
+    seq = p_region->seq;
+    if (seq & 1) {
+      continue;
+    }
+    os_memory_barrier();
+    rc = p_copy(p_region, now_ms, p_ctx);
+    os_memory_barrier();
+    if (seq == p_region->seq) {
+      goto Finish;
+    }
+  }
+  rc = 0;
+
+Finish:
+  os_mutex_unlock(g_telemetry_mutex);
+  return rc;
+}
+
+struct telemetry_dimm_ctx {
+  const char *uid;
+  NVM_UINT32 families;
+  struct telemetry_dimm *p_dimm;
+};
+
+static int telemetry_copy_dimm(const struct telemetry_region *p_region, NVM_UINT64 now_ms, void *p_ctx)
+{
+  struct telemetry_dimm_ctx *p_dimm_ctx = (struct telemetry_dimm_ctx *)p_ctx;
+  NVM_UINT32 count = p_region->dimm_count;
+  NVM_UINT32 i;
+
+  if (count > NVM_TELEMETRY_MAX_DIMMS) {
+    return 0;
+  }
+  for (i = 0; i < count; i++) {
+    if (0 == strncmp(p_region->dimms[i].uid, p_dimm_ctx->uid, NVM_MAX_UID_LEN)) {
+      memcpy(p_dimm_ctx->p_dimm, &p_region->dimms[i], sizeof(*p_dimm_ctx->p_dimm));
+      return p_dimm_ctx->families == (p_dimm_ctx->p_dimm->valid & p_dimm_ctx->families) &&
+        telemetry_fresh(p_region, p_dimm_ctx->families, now_ms);
+    }
+  }
+  return 0;
+}
+
+int telemetry_get_dimm(const NVM_UID uid, NVM_UINT32 families, struct telemetry_dimm *p_dimm)
+{
+  struct telemetry_dimm_ctx dimm_ctx;
+
+  if (NULL == uid || NULL == p_dimm) {
+    return 0;
+  }
+  dimm_ctx.uid = uid;
+  dimm_ctx.families = families;
+  dimm_ctx.p_dimm = p_dimm;
+  return telemetry_read(telemetry_copy_dimm, &dimm_ctx);
+}
+
+struct telemetry_jobs_ctx {
+  struct job *p_jobs;
+  NVM_UINT32 count;
+};
+
+static int telemetry_copy_jobs(const struct telemetry_region *p_region, NVM_UINT64 now_ms, void *p_ctx)
+{
+  struct telemetry_jobs_ctx *p_jobs_ctx = (struct telemetry_jobs_ctx *)p_ctx;
+  NVM_UINT32 i;
+
+  if (p_jobs_ctx->count != p_region->dimm_count || p_jobs_ctx->count > NVM_TELEMETRY_MAX_DIMMS ||
+      !telemetry_fresh(p_region, TELEMETRY_FAMILY_BIT(TELEMETRY_JOB), now_ms)) {
+    return 0;
+  }
+  for (i = 0; i < p_jobs_ctx->count; i++) {
+    if (0 == (p_region->dimms[i].valid & TELEMETRY_FAMILY_BIT(TELEMETRY_JOB))) {
+      return 0;
+    }
+    memcpy(&p_jobs_ctx->p_jobs[i], &p_region->dimms[i].job, sizeof(p_jobs_ctx->p_jobs[i]));
+  }
+  return 1;
+}
+
+int telemetry_get_jobs(struct job *p_jobs, NVM_UINT32 count)
+{
+  struct telemetry_jobs_ctx jobs_ctx;
+
+  if (NULL == p_jobs) {
+    return 0;
+  }
+  jobs_ctx.p_jobs = p_jobs;
+  jobs_ctx.count = count;
+  return telemetry_read(telemetry_copy_jobs, &jobs_ctx);
+}
+
+void telemetry_invalidate()
+{
+  os_once(&g_telemetry_once, telemetry_init_once);
+  if (NULL == g_telemetry_mutex) {
+    return;
+  }
+  os_mutex_lock(g_telemetry_mutex);
+  g_telemetry_changed_ms = os_get_monotonic_ms();
+  os_mutex_unlock(g_telemetry_mutex);
+}
+
+struct telemetry_region *telemetry_create()
+{
+  struct telemetry_region *p_region = NULL;
+
+  p_region = (struct telemetry_region *)os_shm_create(NVM_TELEMETRY_SHM_NAME, sizeof(*p_region));
+  if (NULL == p_region) {
+    return NULL;
+  }
+  telemetry_write_begin(p_region);
+  p_region->version = NVM_TELEMETRY_VERSION;
+  p_region->size = sizeof(*p_region);
+  p_region->pid = os_get_pid();
+  p_region->heartbeat_ms = os_get_monotonic_ms();
+  telemetry_write_end(p_region);
+  // readers only look at a region with the magic in place
+  p_region->magic = NVM_TELEMETRY_MAGIC;
+  return p_region;
+}
+
+void telemetry_write_begin(struct telemetry_region *p_region)
+{
+  // single writer, the increments need no atomics
+  p_region->seq++;
+  os_memory_barrier();
+}
+
+void telemetry_write_end(struct telemetry_region *p_region)
+{
+  os_memory_barrier();
+  p_region->seq++;
+}
+
+void telemetry_destroy(struct telemetry_region *p_region)
+{
+  if (NULL == p_region) {
+    return;
+  }
+  // readers still mapping the region let go of it at their next read
+  p_region->magic = 0;
+  os_memory_barrier();
+  os_shm_close(p_region, sizeof(*p_region));
+  os_shm_remove(NVM_TELEMETRY_SHM_NAME);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018, Intel Corporation.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Telemetry snapshot published by the ipmctld daemon in shared memory.
+ *
+ * The daemon polls the PMem modules and writes the latest results into a
+ * region guarded by a sequence lock: the sequence is odd while it writes and
+ * changes with every update, so readers copy what they need without taking
+ * any lock and retry if the sequence moved under them. Readers never block
+ * the daemon and the daemon never waits for readers.
+ */
+
+#ifndef NVM_TELEMETRY_H_
+#define NVM_TELEMETRY_H_
+
+#include "nvm_management.h"
+
+#define NVM_TELEMETRY_SHM_NAME              "ipmctl_telemetry"
+#define NVM_TELEMETRY_MAGIC                 0x4C4D4C54  // "TLML"
+#define NVM_TELEMETRY_VERSION               1           // bump on any layout change
+#define NVM_TELEMETRY_MAX_DIMMS             NVM_MAX_DEVICES_PER_POOL
+#define NVM_TELEMETRY_HEARTBEAT_MS          1000        // the daemon beats at least this often
+#define NVM_TELEMETRY_HEARTBEAT_TIMEOUT_MS  5000        // a daemon silent for longer is gone
+#define NVM_TELEMETRY_READ_RETRIES          64          // reads racing the daemon this often give up
+
+/*
+ * Groups of data polled together, also the bits of telemetry_dimm.valid
+ */
+enum telemetry_family {
+  TELEMETRY_SENSORS = 0,        ///< nvm_get_sensors()
+  TELEMETRY_STATUS = 1,         ///< nvm_get_device_status()
+  TELEMETRY_PERFORMANCE = 2,    ///< nvm_get_device_performance()
+  TELEMETRY_JOB = 3,            ///< nvm_get_jobs()
+  TELEMETRY_FAMILY_COUNT
+};
+
+#define TELEMETRY_FAMILY_BIT(Family)  (1u << (Family))
+
+/*
+ * Latest results of one PMem module
+ */
+struct telemetry_dimm {
+  NVM_UID                   uid;                    ///< PMem module the entry belongs to
+  NVM_UINT32                valid;                  ///< TELEMETRY_FAMILY_BIT of the families whose last poll succeeded
+  struct sensor             sensors[SENSOR_COUNT];  ///< Indexed by enum sensor_type
+  struct device_status      status;
+  struct device_performance performance;
+  struct job                job;
+};
+
+/*
+ * The shared memory region. Everything but magic, version, size and pid is
+ * written under the sequence lock.
+ */
+struct telemetry_region {
+  NVM_UINT32            magic;                                  ///< NVM_TELEMETRY_MAGIC once initialized
+  NVM_UINT32            version;                                ///< NVM_TELEMETRY_VERSION of the writer
+  NVM_UINT32            size;                                   ///< sizeof(struct telemetry_region) of the writer
+  NVM_UINT32            pid;                                    ///< Process id of the daemon
+  volatile NVM_UINT64   seq;                                    ///< Odd while the daemon writes
+  NVM_UINT64            heartbeat_ms;                           ///< os_get_monotonic_ms() of the last beat
+  NVM_UINT64            updated_ms[TELEMETRY_FAMILY_COUNT];     ///< Start of the last published poll, 0 if none
+  NVM_UINT64            max_age_ms[TELEMETRY_FAMILY_COUNT];     ///< Older polls are not served
+  NVM_UINT32            dimm_count;                             ///< Entries used in dimms
+  NVM_UINT32            reserved;
+  struct telemetry_dimm dimms[NVM_TELEMETRY_MAX_DIMMS];
+};
+
+/*
+ * Reader side, used by the library
+ */
+
+/*
+ * Copies the entry of the PMem module uid if the daemon is running and every
+ * family in families is valid and fresh. Returns 1 on success, 0 if the
+ * caller has to read the PMem module itself.
+ */
+int telemetry_get_dimm(const NVM_UID uid, NVM_UINT32 families, struct telemetry_dimm *p_dimm);
+
+/*
+ * Copies the job of every PMem module in snapshot order if there are exactly
+ * count of them and all are valid and fresh. Returns 1 on success, 0 otherwise.
+ */
+int telemetry_get_jobs(struct job *p_jobs, NVM_UINT32 count);
+
+/*
+ * Stops serving the polls started before now, they may miss a change this
+ * process just made
+ */
+void telemetry_invalidate();
+
+/*
+ * Writer side, used by the daemon
+ */
+
+/*
+ * Creates the shared region, empty and owned by the calling process. Returns
+ * NULL on failure.
+ */
+struct telemetry_region *telemetry_create();
+
+/*
+ * Brackets changes to the region, readers retry while they are under way
+ */
+void telemetry_write_begin(struct telemetry_region *p_region);
+void telemetry_write_end(struct telemetry_region *p_region);
+
+/*
+ * Removes the region, readers fall back to direct access
+ */
+void telemetry_destroy(struct telemetry_region *p_region);
+
+#endif /* NVM_TELEMETRY_H_ */
@@ -7,6 +7,7 @@
 #define OS_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef	_MSC_VER
 #include <stdlib.h>
@@ -31,6 +32,20 @@ typedef wchar_t OS_WPATH[OS_PATH_LEN];
 typedef char OS_PATH[OS_PATH_LEN];
 typedef void OS_MUTEX;
 typedef void OS_RWLOCK;
+typedef void OS_PROCESS_RWLOCK;
+typedef void OS_THREAD;
+typedef void OS_SEMAPHORE;
+typedef void (*OS_THREAD_FUNC)(void *p_arg);
+typedef volatile long OS_ONCE;
+typedef void (*OS_ONCE_FUNC)(void);
+
+#define	OS_ONCE_INIT	0 // initial value of an OS_ONCE
+
+#ifdef	_MSC_VER
+#define	OS_THREAD_LOCAL	__declspec(thread)
+#else
+#define	OS_THREAD_LOCAL	__thread
+#endif
 
 
 
@@ -79,13 +94,53 @@ extern int os_mutex_lock(OS_MUTEX *p_mutex);
 extern int os_mutex_unlock(OS_MUTEX *p_mutex);
 extern int os_mutex_delete(OS_MUTEX *p_mutex, const char *name);
 
-extern int os_rwlock_init(OS_RWLOCK *p_rwlock);
+extern OS_RWLOCK *os_rwlock_create();
 extern int os_rwlock_r_lock(OS_RWLOCK *p_rwlock);
 extern int os_rwlock_r_unlock(OS_RWLOCK *p_rwlock);
 extern int os_rwlock_w_lock(OS_RWLOCK *p_rwlock);
 extern int os_rwlock_w_unlock(OS_RWLOCK *p_rwlock);
 extern int os_rwlock_delete(OS_RWLOCK *p_rwlock);
 
+// Locks between processes. The lock is held by the process, not by the
+// calling thread, threads must agree on the mode among themselves.
+extern OS_PROCESS_RWLOCK *os_process_rwlock_open(const char *name);
+extern int os_process_rwlock_r_lock(OS_PROCESS_RWLOCK *p_rwlock);
+extern int os_process_rwlock_w_lock(OS_PROCESS_RWLOCK *p_rwlock);
+extern int os_process_rwlock_unlock(OS_PROCESS_RWLOCK *p_rwlock);
+extern int os_process_rwlock_close(OS_PROCESS_RWLOCK *p_rwlock);
+
+// Memory shared between processes by name. The creator maps it read-write,
+// others read only. The object lives until os_shm_remove(..), mappings of a
+// removed object stay valid but are not seen by later opens. Opens only trust
+// memory that no user other than root or the caller can have written.
+extern void *os_shm_create(const char *name, size_t size);
+extern const void *os_shm_open(const char *name, size_t size);
+extern int os_shm_close(const void *p_addr, size_t size);
+extern int os_shm_remove(const char *name);
+extern void os_memory_barrier();
+
+// Files mapped read only. The mapping stays valid after the file changes name
+// or is removed, os_file_unmap(..) releases it.
+extern const void *os_file_map(const char *path, size_t *p_size);
+extern int os_file_unmap(const void *p_addr, size_t size);
+// Last modification time of a file in seconds, 0 if it does not exist
+extern unsigned long long os_get_file_mtime(const char *path);
+
+extern OS_THREAD *os_thread_create(OS_THREAD_FUNC p_func, void *p_arg);
+extern int os_thread_join(OS_THREAD *p_thread);
+extern int os_get_cpu_count();
+extern void os_once(OS_ONCE *p_once, OS_ONCE_FUNC p_func);
+extern unsigned int os_get_pid();
+extern unsigned long long os_get_monotonic_ms();
+extern unsigned long long os_get_monotonic_us();
+extern unsigned long long os_atomic_add64(volatile unsigned long long *p_value, unsigned long long add);
+
+extern OS_SEMAPHORE *os_sem_create(unsigned int count);
+extern int os_sem_wait(OS_SEMAPHORE *p_sem);
+extern int os_sem_timed_wait(OS_SEMAPHORE *p_sem, unsigned long long timeout_ms);
+extern int os_sem_post(OS_SEMAPHORE *p_sem);
+extern int os_sem_delete(OS_SEMAPHORE *p_sem);
+
 extern int os_get_host_name(char *name, const unsigned int name_len);
 extern int os_get_os_name(char *os_name, const unsigned int os_name_len);
 extern int os_get_os_version(char *os_version, const unsigned int os_version_len);
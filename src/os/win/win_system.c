@@ -148,15 +148,18 @@ int os_mutex_delete(OS_MUTEX *p_mutex, const char *name)
 }
 
 /*
- * Initializes a rwlock
+ * Creates a process private rwlock, returns NULL on failure
  */
-int os_rwlock_init(OS_RWLOCK *p_rwlock)
+OS_RWLOCK *os_rwlock_create()
 {
-	SRWLOCK *p_handle = (SRWLOCK *)p_rwlock;
+	SRWLOCK *p_handle = (SRWLOCK *)malloc(sizeof(SRWLOCK));
 
-	// Win32 API provides no indication of success for this function
-	InitializeSRWLock(p_handle);
-	return 1;
+	if (p_handle)
+	{
+		// Win32 API provides no indication of success for this function
+		InitializeSRWLock(p_handle);
+	}
+	return (OS_RWLOCK *)p_handle;
 }
 
 /*
@@ -212,11 +215,427 @@ int os_rwlock_w_unlock(OS_RWLOCK *p_rwlock)
  */
 int os_rwlock_delete(OS_RWLOCK *p_rwlock)
 {
-	// SRW Locks do not need to be explicitly destroyed
+	// SRW Locks do not need to be explicitly destroyed, only the storage is released
 	// see: http:// msdn.microsoft.com/en-us/library/windows/desktop/ms683483%28v=vs.85%29.aspx
+	free(p_rwlock);
+	return 1;
+}
+
+#define	LOCK_DIR_ENV	"ProgramData"	// shared by all users, unlike the temp directory
+#define	LOCK_FILE_EXT	".lock"
+
+/*
+ * Opens the cross-process rwlock called name, returns NULL on failure.
+ * It is a lock file, the system drops the lock when its holder exits.
+ */
+OS_PROCESS_RWLOCK *os_process_rwlock_open(const char *name)
+{
+	char path[OS_PATH_LEN];
+	const char *p_dir = getenv(LOCK_DIR_ENV);
+	HANDLE handle;
+
+	if (!p_dir ||
+		snprintf(path, sizeof(path), "%s\\%s%s", p_dir, name, LOCK_FILE_EXT) >= (int)sizeof(path))
+	{
+		return NULL;
+	}
+
+	handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	return (handle == INVALID_HANDLE_VALUE) ? NULL : (OS_PROCESS_RWLOCK *)handle;
+}
+
+static int win_lock_file(OS_PROCESS_RWLOCK *p_rwlock, DWORD flags)
+{
+	OVERLAPPED overlapped = { 0 };
+
+	// lock the first byte, the file does not need to be that long
+	return p_rwlock && (LockFileEx((HANDLE)p_rwlock, flags, 0, 1, 0, &overlapped) != 0);
+}
+
+/*
+ * Applies a shared read-lock for the calling process
+ */
+int os_process_rwlock_r_lock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	return win_lock_file(p_rwlock, 0);
+}
+
+/*
+ * Applies an exclusive write-lock for the calling process
+ */
+int os_process_rwlock_w_lock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	return win_lock_file(p_rwlock, LOCKFILE_EXCLUSIVE_LOCK);
+}
+
+/*
+ * Releases the read or write lock of the calling process
+ */
+int os_process_rwlock_unlock(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	OVERLAPPED overlapped = { 0 };
+
+	return p_rwlock && (UnlockFileEx((HANDLE)p_rwlock, 0, 1, 0, &overlapped) != 0);
+}
+
+/*
+ * Closes the rwlock, a lock still held is released
+ */
+int os_process_rwlock_close(OS_PROCESS_RWLOCK *p_rwlock)
+{
+	int rc = 1;
+	if (p_rwlock)
+	{
+		rc = (CloseHandle((HANDLE)p_rwlock) != 0);
+	}
+	return rc;
+}
+
+#define	SHM_NAME_PREFIX	"Global\\"	// visible from every session, the service one included
+
+/*
+ * Builds the file mapping name, returns 0 if it does not fit
+ */
+static int win_shm_name(const char *name, char *shm_name, size_t shm_name_len)
+{
+	return (snprintf(shm_name, shm_name_len, "%s%s", SHM_NAME_PREFIX, name) < (int)shm_name_len);
+}
+
+/*
+ * Creates the named shared memory of size zeroed bytes and maps it read-write,
+ * returns NULL on failure
+ */
+void *os_shm_create(const char *name, size_t size)
+{
+	char shm_name[MAX_PATH];
+	unsigned long long size64 = size;
+	void *p_addr = NULL;
+	HANDLE mapping;
+	BOOL existed;
+
+	if (!win_shm_name(name, shm_name, sizeof(shm_name)))
+	{
+		return NULL;
+	}
+	mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		(DWORD)(size64 >> 32), (DWORD)size64, shm_name);
+	if (!mapping)
+	{
+		return NULL;
+	}
+	existed = (GetLastError() == ERROR_ALREADY_EXISTS);
+	p_addr = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+	// a mapping of a previous creator still open elsewhere is reused, reset it
+	if (p_addr && existed)
+	{
+		memset(p_addr, 0, size);
+	}
+	// the view keeps the mapping alive
+	CloseHandle(mapping);
+	return p_addr;
+}
+
+/*
+ * Maps existing named shared memory of at least size bytes read only,
+ * returns NULL if it does not exist or is smaller
+ */
+const void *os_shm_open(const char *name, size_t size)
+{
+	char shm_name[MAX_PATH];
+	MEMORY_BASIC_INFORMATION info;
+	void *p_addr = NULL;
+	HANDLE mapping;
+
+	if (!win_shm_name(name, shm_name, sizeof(shm_name)))
+	{
+		return NULL;
+	}
+	mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, shm_name);
+	if (!mapping)
+	{
+		return NULL;
+	}
+	p_addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (p_addr && (VirtualQuery(p_addr, &info, sizeof(info)) != sizeof(info) || info.RegionSize < size))
+	{
+		UnmapViewOfFile(p_addr);
+		p_addr = NULL;
+	}
+	return p_addr;
+}
+
+/*
+ * Unmaps shared memory returned by os_shm_create(..) or os_shm_open(..)
+ */
+int os_shm_close(const void *p_addr, size_t size)
+{
+	int rc = 1;
+	if (p_addr)
+	{
+		rc = (UnmapViewOfFile(p_addr) != 0);
+	}
+	return rc;
+}
+
+/*
+ * Removes the named shared memory. Windows drops the mapping with its last
+ * view, so there is nothing left to do.
+ */
+int os_shm_remove(const char *name)
+{
 	return 1;
 }
 
+/*
+ * Maps a file read only, returns NULL if it cannot be opened or is empty
+ */
+const void *os_file_map(const char *path, size_t *p_size)
+{
+	LARGE_INTEGER size;
+	void *p_addr = NULL;
+	HANDLE file;
+	HANDLE mapping;
+
+	if (!path || !p_size)
+	{
+		return NULL;
+	}
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (unsigned long long)size.QuadPart <= (size_t)~0)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping)
+		{
+			p_addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (p_addr)
+			{
+				*p_size = (size_t)size.QuadPart;
+			}
+			// the view keeps the mapping and the file alive
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	return p_addr;
+}
+
+/*
+ * Unmaps a file mapped by os_file_map(..)
+ */
+int os_file_unmap(const void *p_addr, size_t size)
+{
+	int rc = 1;
+	if (p_addr)
+	{
+		rc = (UnmapViewOfFile(p_addr) != 0);
+	}
+	return rc;
+}
+
+/*
+ * Last modification time of a file in seconds, 0 if it does not exist
+ */
+unsigned long long os_get_file_mtime(const char *path)
+{
+	struct _stat64 st;
+
+	if (!path || _stat64(path, &st) != 0)
+	{
+		return 0;
+	}
+	return (unsigned long long)st.st_mtime;
+}
+
+/*
+ * Full memory barrier, for data shared with other processes without a lock
+ */
+void os_memory_barrier()
+{
+	MemoryBarrier();
+}
+
+struct win_thread
+{
+	HANDLE handle;
+	OS_THREAD_FUNC p_func;
+	void *p_arg;
+};
+
+static DWORD WINAPI win_thread_start(LPVOID p_arg)
+{
+	struct win_thread *p_thread = (struct win_thread *)p_arg;
+
+	p_thread->p_func(p_thread->p_arg);
+	return 0;
+}
+
+/*
+ * Starts a thread running p_func(p_arg), returns NULL on failure
+ */
+OS_THREAD *os_thread_create(OS_THREAD_FUNC p_func, void *p_arg)
+{
+	struct win_thread *p_thread = (struct win_thread *)malloc(sizeof(struct win_thread));
+
+	if (p_thread)
+	{
+		p_thread->p_func = p_func;
+		p_thread->p_arg = p_arg;
+		p_thread->handle = CreateThread(NULL, 0, win_thread_start, p_thread, 0, NULL);
+		if (NULL == p_thread->handle)
+		{
+			free(p_thread);
+			p_thread = NULL;
+		}
+	}
+	return (OS_THREAD *)p_thread;
+}
+
+/*
+ * Waits for a thread to finish and releases it
+ */
+int os_thread_join(OS_THREAD *p_thread)
+{
+	int rc = 0;
+	if (p_thread)
+	{
+		HANDLE handle = ((struct win_thread *)p_thread)->handle;
+
+		rc = (WaitForSingleObject(handle, INFINITE) == WAIT_OBJECT_0);
+		CloseHandle(handle);
+		free(p_thread);
+	}
+	return rc;
+}
+
+/*
+ * Returns the number of online processors, at least 1
+ */
+int os_get_cpu_count()
+{
+	SYSTEM_INFO system_info;
+
+	GetSystemInfo(&system_info);
+	return (system_info.dwNumberOfProcessors > 0) ? (int)system_info.dwNumberOfProcessors : 1;
+}
+
+#define	ONCE_RUNNING	1
+#define	ONCE_DONE	2
+
+/*
+ * Runs p_func exactly once per once control, concurrent callers return after it has completed
+ */
+void os_once(OS_ONCE *p_once, OS_ONCE_FUNC p_func)
+{
+	if (InterlockedCompareExchange(p_once, ONCE_RUNNING, OS_ONCE_INIT) == OS_ONCE_INIT)
+	{
+		p_func();
+		// interlocked operations are full barriers, everything p_func wrote is visible before the done state
+		InterlockedExchange(p_once, ONCE_DONE);
+		return;
+	}
+	while (InterlockedCompareExchange(p_once, ONCE_DONE, ONCE_DONE) != ONCE_DONE)
+	{
+		SwitchToThread();
+	}
+}
+
+/*
+ * Returns the id of the calling process
+ */
+unsigned int os_get_pid()
+{
+	return (unsigned int)GetCurrentProcessId();
+}
+
+/*
+ * Returns milliseconds of a clock that only moves forward and is the same for
+ * every process of the system
+ */
+unsigned long long os_get_monotonic_ms()
+{
+	return (unsigned long long)GetTickCount64();
+}
+
+/*
+ * Returns microseconds of a clock that only moves forward, finer grained than
+ * os_get_monotonic_ms(..) but not comparable with it
+ */
+unsigned long long os_get_monotonic_us()
+{
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (!QueryPerformanceFrequency(&frequency) || !QueryPerformanceCounter(&counter))
+	{
+		return 0;
+	}
+	return (unsigned long long)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+		(unsigned long long)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+}
+
+/*
+ * Adds add to *p_value atomically and returns the new value, an add of 0 reads it
+ */
+unsigned long long os_atomic_add64(volatile unsigned long long *p_value, unsigned long long add)
+{
+	return (unsigned long long)InterlockedAdd64((volatile LONG64 *)p_value, (LONG64)add);
+}
+
+/*
+ * Creates a process private counting semaphore, returns NULL on failure
+ */
+OS_SEMAPHORE *os_sem_create(unsigned int count)
+{
+	return (OS_SEMAPHORE *)CreateSemaphore(NULL, (LONG)count, MAXLONG, NULL);
+}
+
+/*
+ * Decrements the semaphore, blocking while it is zero
+ */
+int os_sem_wait(OS_SEMAPHORE *p_sem)
+{
+	return (WaitForSingleObject((HANDLE)p_sem, INFINITE) == WAIT_OBJECT_0);
+}
+
+/*
+ * Decrements the semaphore, blocking while it is zero for at most timeout_ms.
+ * Returns 0 on timeout.
+ */
+int os_sem_timed_wait(OS_SEMAPHORE *p_sem, unsigned long long timeout_ms)
+{
+	DWORD timeout = (timeout_ms >= INFINITE) ? INFINITE - 1 : (DWORD)timeout_ms;
+
+	return (WaitForSingleObject((HANDLE)p_sem, timeout) == WAIT_OBJECT_0);
+}
+
+/*
+ * Increments the semaphore, waking one waiter
+ */
+int os_sem_post(OS_SEMAPHORE *p_sem)
+{
+	return (ReleaseSemaphore((HANDLE)p_sem, 1, NULL) != 0);
+}
+
+/*
+ * Destroys a semaphore no thread is waiting on
+ */
+int os_sem_delete(OS_SEMAPHORE *p_sem)
+{
+	int rc = 0;
+	if (p_sem)
+	{
+		rc = (CloseHandle((HANDLE)p_sem) != 0);
+	}
+	return rc;
+}
+
 /*
  * Retrieve the name of the host server.
  */